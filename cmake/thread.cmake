@@ -96,5 +96,18 @@ function (do_pthread_checks)
             (void)pthread_get_stackaddr_np(pthread_self());
             return 0;
         }" HAVE_PTHREAD_GET_STACKADDR_NP)
+    # pthread_setaffinity_np - Linux
+    check_c_source_compiles("
+        #include <pthread.h>
+        #include <sched.h>
+        ${INCLUDE_MISC_PTHREAD_HEADERS}
+
+        int main(void)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            return 0;
+        }" HAVE_PTHREAD_SETAFFINITY_NP)
 endfunction (do_pthread_checks)
 do_pthread_checks()
@@ -0,0 +1,187 @@
+#include <cstdio>
+#include <vector>
+
+#include "memory.h"
+#include "fiber.h"
+#include "cbus.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * This suite contains benchmarks for the inter-cord bus: the latency
+ * of a round trip of a message to another cord and back, and the
+ * throughput of delivering messages from many producer cords to
+ * a single consumer, like iproto threads and relays feed tx.
+ */
+
+/** Number of messages sent by each producer per iteration. */
+static constexpr size_t msg_count = 1 << 14;
+
+/** Initializes the subsystems cbus depends on, runs the consumer. */
+class CbusEnv {
+public:
+	static CbusEnv &instance()
+	{
+		static CbusEnv instance;
+		return instance;
+	}
+	/** Run the event loop until the counter reaches the value. */
+	void wait(const size_t &counter, size_t value)
+	{
+		while (counter < value)
+			ev_run(loop(), EVRUN_NOWAIT);
+	}
+private:
+	static void process_cb(ev_loop *, ev_watcher *watcher, int)
+	{
+		cbus_process((struct cbus_endpoint *)watcher->data);
+	}
+	CbusEnv()
+	{
+		memory_init();
+		fiber_init(fiber_c_invoke);
+		cbus_init();
+		if (cbus_endpoint_create(&endpoint, "main", process_cb,
+					 &endpoint) != 0)
+			abort();
+	}
+
+	struct cbus_endpoint endpoint;
+};
+
+/** A cord running the cbus loop with a pipe to it and back. */
+class Worker {
+public:
+	Worker(size_t id)
+	{
+		snprintf(name, sizeof(name), "worker%zu", id);
+		if (cord_costart(&cord, name, worker_f, this) != 0)
+			abort();
+		cpipe_create(&pipe_to_worker, name);
+	}
+	~Worker()
+	{
+		cbus_stop_loop(&pipe_to_worker);
+		cpipe_destroy(&pipe_to_worker);
+		if (cord_join(&cord) != 0)
+			abort();
+	}
+
+	char name[FIBER_NAME_MAX];
+	struct cord cord;
+	/** Pipe from the main cord to the worker. */
+	struct cpipe pipe_to_worker;
+	/** Pipe from the worker to the main cord. */
+	struct cpipe pipe_to_main;
+private:
+	static int worker_f(va_list ap)
+	{
+		Worker *worker = va_arg(ap, Worker *);
+		struct cbus_endpoint endpoint;
+		cpipe_create(&worker->pipe_to_main, "main");
+		if (cbus_endpoint_create(&endpoint, worker->name,
+					 fiber_schedule_cb, fiber()) != 0)
+			abort();
+		cbus_loop(&endpoint);
+		cbus_endpoint_destroy(&endpoint, cbus_process);
+		cpipe_destroy(&worker->pipe_to_main);
+		return 0;
+	}
+};
+
+/** Number of messages delivered to the main cord. */
+static size_t delivered_count;
+
+static void
+deliver_f(struct cmsg *)
+{
+	delivered_count++;
+}
+
+static void
+nop_f(struct cmsg *)
+{
+}
+
+/** Round trip of a message to another cord benchmark. */
+static void
+bench_cbus_round_trip(benchmark::State &state)
+{
+	CbusEnv &env = CbusEnv::instance();
+	Worker worker(0);
+	const struct cmsg_hop route[] = {
+		{nop_f, &worker.pipe_to_main},
+		{deliver_f, NULL},
+	};
+	struct cmsg msg;
+	delivered_count = 0;
+	for (auto _ : state) {
+		cmsg_init(&msg, route);
+		cpipe_push(&worker.pipe_to_worker, &msg);
+		cpipe_deliver_now(&worker.pipe_to_worker);
+		env.wait(delivered_count, delivered_count + 1);
+	}
+	state.SetItemsProcessed(delivered_count);
+}
+
+BENCHMARK(bench_cbus_round_trip);
+
+/** A message telling a worker to send messages to the main cord. */
+struct flood_msg {
+	struct cmsg base;
+	Worker *worker;
+	std::vector<struct cmsg> *msgs;
+};
+
+static void
+flood_f(struct cmsg *base)
+{
+	struct flood_msg *msg = (struct flood_msg *)base;
+	static const struct cmsg_hop route[] = {{deliver_f, NULL}};
+	for (struct cmsg &m : *msg->msgs) {
+		cmsg_init(&m, route);
+		cpipe_push_input(&msg->worker->pipe_to_main, &m);
+		/* Flush in small batches like iproto does. */
+		if (msg->worker->pipe_to_main.n_input >= 16)
+			cpipe_deliver_now(&msg->worker->pipe_to_main);
+	}
+	cpipe_deliver_now(&msg->worker->pipe_to_main);
+}
+
+/** Delivery of messages from many cords to one cord benchmark. */
+static void
+bench_cbus_many_producers(benchmark::State &state)
+{
+	CbusEnv &env = CbusEnv::instance();
+	size_t producer_count = state.range(0);
+	std::vector<Worker *> workers;
+	std::vector<std::vector<struct cmsg>> msgs(producer_count);
+	std::vector<struct flood_msg> flood(producer_count);
+	static const struct cmsg_hop route[] = {{flood_f, NULL}};
+	for (size_t i = 0; i < producer_count; i++) {
+		workers.push_back(new Worker(i));
+		msgs[i].resize(msg_count);
+	}
+	delivered_count = 0;
+	for (auto _ : state) {
+		size_t expected = delivered_count + producer_count * msg_count;
+		for (size_t i = 0; i < producer_count; i++) {
+			cmsg_init(&flood[i].base, route);
+			flood[i].worker = workers[i];
+			flood[i].msgs = &msgs[i];
+			cpipe_push(&workers[i]->pipe_to_worker, &flood[i].base);
+			cpipe_deliver_now(&workers[i]->pipe_to_worker);
+		}
+		env.wait(delivered_count, expected);
+	}
+	state.SetItemsProcessed(delivered_count);
+	for (Worker *worker : workers)
+		delete worker;
+}
+
+BENCHMARK(bench_cbus_many_producers)
+	->ArgNames({"producers"})
+	->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)
+	->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,697 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/**
+ * IPROTO load generator. Opens the given number of connections to
+ * a running server, each served by its own thread, and keeps the given
+ * number of requests in flight on each of them for the given time.
+ * Every response received is immediately replaced with a new request,
+ * so the load is closed-loop. Reports the throughput and the latency
+ * distribution as text or JSON.
+ *
+ * The server is expected to have a space with an unsigned primary key
+ * (for SELECT and REPLACE) and a function (for CALL) accessible by
+ * guest. See perf/lua/iproto_load.lua that sets up servers with
+ * different configurations and runs the load generator against them.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <msgpuck.h>
+
+#include "histogram.h"
+#include "iproto_constants.h"
+#include "trivia/util.h"
+
+/** Kinds of generated requests. */
+enum load_request {
+	LOAD_PING,
+	LOAD_SELECT,
+	LOAD_REPLACE,
+	LOAD_CALL,
+	load_request_MAX,
+};
+
+static const char *load_request_strs[] = {
+	"ping", "select", "replace", "call",
+};
+
+static struct {
+	/** Server URI: host:port or unix/:path. */
+	const char *uri;
+	/** Number of connections, each served by a thread. */
+	int connections;
+	/** Number of requests in flight per connection. */
+	int pipeline;
+	/** Test duration, in seconds. */
+	double duration;
+	/** Warmup time excluded from the results, in seconds. */
+	double warmup;
+	/** Weights of request kinds in the mix. */
+	int mix[load_request_MAX];
+	/** Sum of the mix weights. */
+	int mix_total;
+	/** Size of the string field of replaced tuples. */
+	int payload;
+	/** Space used by SELECT and REPLACE. */
+	uint32_t space_id;
+	/** Keys are chosen randomly in [0, key_count). */
+	uint64_t key_count;
+	/** Function used by CALL. */
+	const char *function;
+	/** Print the results in JSON. */
+	bool json;
+} opts = {
+	.uri = "localhost:3301",
+	.connections = 4,
+	.pipeline = 16,
+	.duration = 10,
+	.warmup = 1,
+	.mix = {0, 100, 0, 0},
+	.mix_total = 100,
+	.payload = 100,
+	.space_id = 512,
+	.key_count = 100000,
+	.function = "echo",
+	.json = false,
+};
+
+/** Load generator connection. */
+struct load_conn {
+	/** Thread serving the connection. */
+	pthread_t thread;
+	/** Socket, -1 if not connected. */
+	int fd;
+	/** Random generator state. */
+	uint64_t seed;
+	/** Send time of each request in flight, indexed by sync. */
+	double *send_time;
+	/** Output buffer. */
+	char *wbuf;
+	size_t wbuf_size;
+	size_t wbuf_used;
+	/** Input buffer. */
+	char *rbuf;
+	size_t rbuf_size;
+	size_t rbuf_used;
+	/** Latency histogram, in microseconds. */
+	struct histogram *hist;
+	/** Number of completed requests by kind. */
+	uint64_t count[load_request_MAX];
+	/** Number of requests that failed. */
+	uint64_t errors;
+	/** Set if the thread failed, the message is printed. */
+	bool failed;
+};
+
+/** Payload of replaced tuples. */
+static char *payload;
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t
+load_rand(struct load_conn *conn)
+{
+	/* xorshift64 */
+	uint64_t x = conn->seed;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	conn->seed = x;
+	return x;
+}
+
+/**
+ * Create a histogram with two significant digits of precision
+ * from 1 microsecond to 1000 seconds.
+ */
+static struct histogram *
+load_histogram_new(void)
+{
+	int64_t buckets[9 + 8 * 90];
+	int n = 0;
+	for (int64_t v = 1; v < 10; v++)
+		buckets[n++] = v;
+	for (int64_t scale = 1; scale <= 10000000; scale *= 10) {
+		for (int64_t v = 10; v < 100; v++)
+			buckets[n++] = v * scale;
+	}
+	assert((size_t)n == lengthof(buckets));
+	return histogram_new(buckets, n);
+}
+
+static int
+load_connect(const char *uri)
+{
+	const char *unix_prefix = "unix/:";
+	if (strncmp(uri, unix_prefix, strlen(unix_prefix)) == 0) {
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strlcpy(addr.sun_path, uri + strlen(unix_prefix),
+			sizeof(addr.sun_path));
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			return -1;
+		if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+	char host[256];
+	const char *port = strrchr(uri, ':');
+	if (port == NULL || (size_t)(port - uri) >= sizeof(host)) {
+		errno = EINVAL;
+		return -1;
+	}
+	memcpy(host, uri, port - uri);
+	host[port - uri] = '\0';
+	port++;
+	struct addrinfo hints, *res;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(host, port, &hints, &res) != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	int fd = -1;
+	for (struct addrinfo *ai = res; ai != NULL; ai = ai->ai_next) {
+		fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (fd < 0)
+			continue;
+		if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+			break;
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(res);
+	return fd;
+}
+
+static int
+load_write_all(int fd, const char *buf, size_t size)
+{
+	while (size > 0) {
+		ssize_t n = write(fd, buf, size);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		buf += n;
+		size -= n;
+	}
+	return 0;
+}
+
+static int
+load_read_all(int fd, char *buf, size_t size)
+{
+	while (size > 0) {
+		ssize_t n = read(fd, buf, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		buf += n;
+		size -= n;
+	}
+	return 0;
+}
+
+/** Choose a random request kind according to the mix. */
+static enum load_request
+load_choose_request(struct load_conn *conn)
+{
+	int r = load_rand(conn) % opts.mix_total;
+	for (int i = 0; i < load_request_MAX; i++) {
+		if (r < opts.mix[i])
+			return i;
+		r -= opts.mix[i];
+	}
+	unreachable();
+	return LOAD_PING;
+}
+
+/**
+ * Append a random request with the given sync to the output buffer.
+ * The request kind is encoded in the sync so that the response can be
+ * accounted without a lookup.
+ */
+static void
+load_encode_request(struct load_conn *conn, uint64_t slot)
+{
+	enum load_request kind = load_choose_request(conn);
+	uint64_t sync = slot * load_request_MAX + kind;
+	uint64_t key = load_rand(conn) % opts.key_count;
+	size_t size_max = 64 + strlen(opts.function) + opts.payload;
+	if (conn->wbuf_used + size_max > conn->wbuf_size) {
+		conn->wbuf_size = (conn->wbuf_used + size_max) * 2;
+		conn->wbuf = xrealloc(conn->wbuf, conn->wbuf_size);
+	}
+	char *begin = conn->wbuf + conn->wbuf_used;
+	/* The length is patched below. */
+	char *d = begin + 5;
+	d = mp_encode_map(d, 2);
+	d = mp_encode_uint(d, IPROTO_REQUEST_TYPE);
+	switch (kind) {
+	case LOAD_PING:
+		d = mp_encode_uint(d, IPROTO_PING);
+		break;
+	case LOAD_SELECT:
+		d = mp_encode_uint(d, IPROTO_SELECT);
+		break;
+	case LOAD_REPLACE:
+		d = mp_encode_uint(d, IPROTO_REPLACE);
+		break;
+	case LOAD_CALL:
+		d = mp_encode_uint(d, IPROTO_CALL);
+		break;
+	default:
+		unreachable();
+	}
+	d = mp_encode_uint(d, IPROTO_SYNC);
+	d = mp_encode_uint(d, sync);
+	switch (kind) {
+	case LOAD_PING:
+		d = mp_encode_map(d, 0);
+		break;
+	case LOAD_SELECT:
+		d = mp_encode_map(d, 5);
+		d = mp_encode_uint(d, IPROTO_SPACE_ID);
+		d = mp_encode_uint(d, opts.space_id);
+		d = mp_encode_uint(d, IPROTO_INDEX_ID);
+		d = mp_encode_uint(d, 0);
+		d = mp_encode_uint(d, IPROTO_LIMIT);
+		d = mp_encode_uint(d, 1);
+		d = mp_encode_uint(d, IPROTO_ITERATOR);
+		d = mp_encode_uint(d, 0);
+		d = mp_encode_uint(d, IPROTO_KEY);
+		d = mp_encode_array(d, 1);
+		d = mp_encode_uint(d, key);
+		break;
+	case LOAD_REPLACE:
+		d = mp_encode_map(d, 2);
+		d = mp_encode_uint(d, IPROTO_SPACE_ID);
+		d = mp_encode_uint(d, opts.space_id);
+		d = mp_encode_uint(d, IPROTO_TUPLE);
+		d = mp_encode_array(d, 2);
+		d = mp_encode_uint(d, key);
+		d = mp_encode_str(d, payload, opts.payload);
+		break;
+	case LOAD_CALL:
+		d = mp_encode_map(d, 2);
+		d = mp_encode_uint(d, IPROTO_FUNCTION_NAME);
+		d = mp_encode_str0(d, opts.function);
+		d = mp_encode_uint(d, IPROTO_TUPLE);
+		d = mp_encode_array(d, 1);
+		d = mp_encode_uint(d, key);
+		break;
+	default:
+		unreachable();
+	}
+	*begin = 0xce;
+	mp_store_u32(begin + 1, d - begin - 5);
+	conn->wbuf_used += d - begin;
+	conn->send_time[slot] = now();
+}
+
+/**
+ * Account all complete responses in the input buffer and encode
+ * a new request for each of them. Returns -1 on protocol error.
+ */
+static int
+load_process_responses(struct load_conn *conn, double warmup_end)
+{
+	const char *pos = conn->rbuf;
+	const char *end = conn->rbuf + conn->rbuf_used;
+	while (pos < end) {
+		const char *p = pos;
+		if (mp_typeof(*p) != MP_UINT)
+			return -1;
+		if (mp_check_uint(p, end) > 0)
+			break;
+		uint64_t len = mp_decode_uint(&p);
+		if ((uint64_t)(end - p) < len)
+			break;
+		const char *packet_end = p + len;
+		if (mp_typeof(*p) != MP_MAP)
+			return -1;
+		uint32_t size = mp_decode_map(&p);
+		uint64_t type = 0;
+		uint64_t sync = UINT64_MAX;
+		for (uint32_t i = 0; i < size; i++) {
+			if (mp_typeof(*p) != MP_UINT)
+				return -1;
+			uint64_t k = mp_decode_uint(&p);
+			if (k == IPROTO_REQUEST_TYPE &&
+			    mp_typeof(*p) == MP_UINT)
+				type = mp_decode_uint(&p);
+			else if (k == IPROTO_SYNC && mp_typeof(*p) == MP_UINT)
+				sync = mp_decode_uint(&p);
+			else
+				mp_next(&p);
+		}
+		uint64_t slot = sync / load_request_MAX;
+		if (slot >= (uint64_t)opts.pipeline)
+			return -1;
+		double t = now();
+		if (t > warmup_end) {
+			int64_t latency = (t - conn->send_time[slot]) * 1e6;
+			histogram_collect(conn->hist, latency);
+			conn->count[sync % load_request_MAX]++;
+			if ((type & IPROTO_TYPE_ERROR) != 0)
+				conn->errors++;
+		}
+		load_encode_request(conn, slot);
+		pos = packet_end;
+	}
+	conn->rbuf_used = end - pos;
+	memmove(conn->rbuf, pos, conn->rbuf_used);
+	return 0;
+}
+
+static void *
+load_conn_f(void *arg)
+{
+	struct load_conn *conn = arg;
+	char greeting[IPROTO_GREETING_SIZE];
+	if (load_read_all(conn->fd, greeting, sizeof(greeting)) != 0) {
+		fprintf(stderr, "failed to read greeting: %s\n",
+			strerror(errno));
+		goto fail;
+	}
+	double start = now();
+	double warmup_end = start + opts.warmup;
+	double deadline = warmup_end + opts.duration;
+	for (int i = 0; i < opts.pipeline; i++)
+		load_encode_request(conn, i);
+	while (true) {
+		if (load_write_all(conn->fd, conn->wbuf,
+				   conn->wbuf_used) != 0) {
+			fprintf(stderr, "write failed: %s\n", strerror(errno));
+			goto fail;
+		}
+		conn->wbuf_used = 0;
+		if (now() > deadline)
+			break;
+		if (conn->rbuf_size - conn->rbuf_used < 4096) {
+			conn->rbuf_size *= 2;
+			conn->rbuf = xrealloc(conn->rbuf, conn->rbuf_size);
+		}
+		ssize_t n = read(conn->fd, conn->rbuf + conn->rbuf_used,
+				 conn->rbuf_size - conn->rbuf_used);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0) {
+			fprintf(stderr, "read failed: %s\n",
+				n == 0 ? "connection closed" :
+				strerror(errno));
+			goto fail;
+		}
+		conn->rbuf_used += n;
+		if (load_process_responses(conn, warmup_end) != 0) {
+			fprintf(stderr, "invalid response\n");
+			goto fail;
+		}
+	}
+	return NULL;
+fail:
+	conn->failed = true;
+	return NULL;
+}
+
+static void
+load_report(struct load_conn *conns)
+{
+	struct histogram *hist = conns[0].hist;
+	uint64_t count[load_request_MAX] = {0};
+	uint64_t errors = 0;
+	for (int i = 0; i < opts.connections; i++) {
+		struct load_conn *conn = &conns[i];
+		for (int j = 0; j < load_request_MAX; j++)
+			count[j] += conn->count[j];
+		errors += conn->errors;
+		if (i == 0)
+			continue;
+		for (size_t j = 0; j < hist->n_buckets; j++)
+			hist->buckets[j].count += conn->hist->buckets[j].count;
+		hist->total += conn->hist->total;
+	}
+	uint64_t total = 0;
+	for (int j = 0; j < load_request_MAX; j++)
+		total += count[j];
+	double rps = total / opts.duration;
+	int pct[] = {50, 90, 99};
+	int64_t lat[lengthof(pct)];
+	for (size_t i = 0; i < lengthof(pct); i++)
+		lat[i] = total > 0 ? histogram_percentile(hist, pct[i]) : 0;
+	int64_t lat_max = 0;
+	for (size_t j = hist->n_buckets; j > 0; j--) {
+		if (hist->buckets[j - 1].count > 0) {
+			lat_max = hist->buckets[j - 1].max;
+			break;
+		}
+	}
+	if (opts.json) {
+		printf("{\"connections\": %d, \"pipeline\": %d, "
+		       "\"duration\": %g, \"payload\": %d, "
+		       "\"requests\": %llu, \"errors\": %llu, \"rps\": %.0f, "
+		       "\"latency_us\": {\"p50\": %lld, \"p90\": %lld, "
+		       "\"p99\": %lld, \"max\": %lld}, \"mix\": {",
+		       opts.connections, opts.pipeline, opts.duration,
+		       opts.payload, (unsigned long long)total,
+		       (unsigned long long)errors, rps, (long long)lat[0],
+		       (long long)lat[1], (long long)lat[2],
+		       (long long)lat_max);
+		const char *sep = "";
+		for (int j = 0; j < load_request_MAX; j++) {
+			if (opts.mix[j] == 0)
+				continue;
+			printf("%s\"%s\": %llu", sep, load_request_strs[j],
+			       (unsigned long long)count[j]);
+			sep = ", ";
+		}
+		printf("}}\n");
+		return;
+	}
+	printf("connections: %d, pipeline: %d, duration: %g sec\n",
+	       opts.connections, opts.pipeline, opts.duration);
+	for (int j = 0; j < load_request_MAX; j++) {
+		if (opts.mix[j] == 0)
+			continue;
+		printf("%s: %llu\n", load_request_strs[j],
+		       (unsigned long long)count[j]);
+	}
+	printf("requests: %llu, errors: %llu, rps: %.0f\n",
+	       (unsigned long long)total, (unsigned long long)errors, rps);
+	printf("latency, us: p50 %lld, p90 %lld, p99 %lld, max %lld\n",
+	       (long long)lat[0], (long long)lat[1], (long long)lat[2],
+	       (long long)lat_max);
+}
+
+/** Parse a request mix like "select=80,replace=20". */
+static int
+load_parse_mix(const char *str)
+{
+	memset(opts.mix, 0, sizeof(opts.mix));
+	opts.mix_total = 0;
+	char *copy = xstrdup(str);
+	char *saveptr;
+	for (char *tok = strtok_r(copy, ",", &saveptr); tok != NULL;
+	     tok = strtok_r(NULL, ",", &saveptr)) {
+		char *eq = strchr(tok, '=');
+		int weight = 1;
+		if (eq != NULL) {
+			*eq = '\0';
+			weight = atoi(eq + 1);
+		}
+		int i;
+		for (i = 0; i < load_request_MAX; i++) {
+			if (strcmp(tok, load_request_strs[i]) == 0)
+				break;
+		}
+		if (i == load_request_MAX || weight < 0) {
+			free(copy);
+			return -1;
+		}
+		opts.mix[i] += weight;
+		opts.mix_total += weight;
+	}
+	free(copy);
+	return opts.mix_total > 0 ? 0 : -1;
+}
+
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s [options]\n"
+	       "  --uri <host:port|unix/:path>  server URI (%s)\n"
+	       "  --connections <n>  number of connections (%d)\n"
+	       "  --pipeline <n>     requests in flight per connection (%d)\n"
+	       "  --duration <sec>   measurement time (%g)\n"
+	       "  --warmup <sec>     time excluded from results (%g)\n"
+	       "  --mix <mix>        request mix, e.g. select=80,replace=20\n"
+	       "                     kinds: ping, select, replace, call\n"
+	       "  --payload <bytes>  size of replaced tuples payload (%d)\n"
+	       "  --space <id>       space id for select and replace (%u)\n"
+	       "  --keys <n>         number of distinct keys (%llu)\n"
+	       "  --function <name>  function for call (%s)\n"
+	       "  --json             print results in JSON\n",
+	       prog, opts.uri, opts.connections, opts.pipeline,
+	       opts.duration, opts.warmup, opts.payload, opts.space_id,
+	       (unsigned long long)opts.key_count, opts.function);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option longopts[] = {
+		{"uri", required_argument, NULL, 'u'},
+		{"connections", required_argument, NULL, 'c'},
+		{"pipeline", required_argument, NULL, 'p'},
+		{"duration", required_argument, NULL, 'd'},
+		{"warmup", required_argument, NULL, 'w'},
+		{"mix", required_argument, NULL, 'm'},
+		{"payload", required_argument, NULL, 's'},
+		{"space", required_argument, NULL, 'S'},
+		{"keys", required_argument, NULL, 'k'},
+		{"function", required_argument, NULL, 'f'},
+		{"json", no_argument, NULL, 'j'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	int ch;
+	while ((ch = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+		switch (ch) {
+		case 'u':
+			opts.uri = optarg;
+			break;
+		case 'c':
+			opts.connections = atoi(optarg);
+			break;
+		case 'p':
+			opts.pipeline = atoi(optarg);
+			break;
+		case 'd':
+			opts.duration = atof(optarg);
+			break;
+		case 'w':
+			opts.warmup = atof(optarg);
+			break;
+		case 'm':
+			if (load_parse_mix(optarg) != 0) {
+				fprintf(stderr, "invalid mix: %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 's':
+			opts.payload = atoi(optarg);
+			break;
+		case 'S':
+			opts.space_id = atoi(optarg);
+			break;
+		case 'k':
+			opts.key_count = strtoull(optarg, NULL, 10);
+			break;
+		case 'f':
+			opts.function = optarg;
+			break;
+		case 'j':
+			opts.json = true;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (opts.connections <= 0 || opts.pipeline <= 0 ||
+	    opts.duration <= 0 || opts.warmup < 0 || opts.payload < 0 ||
+	    opts.key_count == 0) {
+		fprintf(stderr, "invalid options\n");
+		return EXIT_FAILURE;
+	}
+	payload = xmalloc(opts.payload + 1);
+	memset(payload, 'x', opts.payload);
+
+	struct load_conn *conns = xcalloc(opts.connections, sizeof(*conns));
+	for (int i = 0; i < opts.connections; i++)
+		conns[i].fd = -1;
+	int rc = EXIT_SUCCESS;
+	for (int i = 0; i < opts.connections; i++) {
+		struct load_conn *conn = &conns[i];
+		conn->fd = load_connect(opts.uri);
+		if (conn->fd < 0) {
+			fprintf(stderr, "failed to connect to %s: %s\n",
+				opts.uri, strerror(errno));
+			rc = EXIT_FAILURE;
+			goto out;
+		}
+		conn->seed = 0x9e3779b97f4a7c15ULL * (i + 1);
+		conn->send_time = xcalloc(opts.pipeline,
+					  sizeof(*conn->send_time));
+		conn->rbuf_size = 64 * 1024;
+		conn->rbuf = xmalloc(conn->rbuf_size);
+		conn->hist = load_histogram_new();
+		if (conn->hist == NULL) {
+			fprintf(stderr, "failed to allocate histogram\n");
+			rc = EXIT_FAILURE;
+			goto out;
+		}
+	}
+	for (int i = 0; i < opts.connections; i++) {
+		if (pthread_create(&conns[i].thread, NULL, load_conn_f,
+				   &conns[i]) != 0) {
+			fprintf(stderr, "failed to create thread\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (int i = 0; i < opts.connections; i++) {
+		pthread_join(conns[i].thread, NULL);
+		if (conns[i].failed)
+			rc = EXIT_FAILURE;
+	}
+	if (rc == EXIT_SUCCESS)
+		load_report(conns);
+out:
+	for (int i = 0; i < opts.connections; i++) {
+		struct load_conn *conn = &conns[i];
+		if (conn->fd >= 0)
+			close(conn->fd);
+		if (conn->hist != NULL)
+			histogram_delete(conn->hist);
+		free(conn->send_time);
+		free(conn->rbuf);
+		free(conn->wbuf);
+	}
+	free(conns);
+	free(payload);
+	return rc;
+}
@@ -0,0 +1,140 @@
+--
+-- The test runs the IPROTO load generator (perf/iproto_load.c) against
+-- servers started with each combination of the given iproto_threads and
+-- wal_mode values.
+--
+-- Output format: JSON array with an object per server configuration,
+-- see iproto_load --help for the fields.
+--
+-- Options:
+-- --loader <path>          path to the iproto_load binary (mandatory)
+-- --iproto_threads <list>  comma separated iproto_threads values
+--                          (default '1,2,4')
+-- --wal_mode <list>        comma separated wal_mode values
+--                          (default 'write,none')
+-- --connections <number>   number of connections (default 16)
+-- --pipeline <number>      requests in flight per connection (default 16)
+-- --duration <number>      measurement time per configuration, in seconds
+--                          (default 10)
+-- --mix <string>           request mix (default 'select=80,replace=20')
+-- --payload <number>       size of replaced tuples payload (default 100)
+-- --keys <number>          number of keys in the space (default 100000)
+--
+
+local fiber = require('fiber')
+local fio = require('fio')
+local json = require('json')
+local popen = require('popen')
+
+local params = require('internal.argparse').parse(arg, {
+    {'loader', 'string'},
+    {'iproto_threads', 'string'},
+    {'wal_mode', 'string'},
+    {'connections', 'number'},
+    {'pipeline', 'number'},
+    {'duration', 'number'},
+    {'mix', 'string'},
+    {'payload', 'number'},
+    {'keys', 'number'},
+})
+if params.loader == nil then
+    error('--loader is mandatory')
+end
+local iproto_threads = string.split(params.iproto_threads or '1,2,4', ',')
+local wal_modes = string.split(params.wal_mode or 'write,none', ',')
+local key_count = params.keys or 100000
+
+local SERVER_SCRIPT = [[
+local fio = require('fio')
+local iproto_threads, wal_mode, key_count, dir = arg[1], arg[2], arg[3],
+                                                 arg[4]
+box.cfg({
+    work_dir = dir,
+    listen = 'unix/:' .. fio.pathjoin(dir, 'tarantool.sock'),
+    iproto_threads = tonumber(iproto_threads),
+    wal_mode = wal_mode,
+    log = fio.pathjoin(dir, 'tarantool.log'),
+    log_level = 'error',
+})
+local s = box.schema.space.create('test', {id = 512})
+s:create_index('pk')
+local payload = string.rep('x', 100)
+for i = 0, tonumber(key_count) - 1, 1000 do
+    box.atomic(function()
+        for k = i, math.min(i + 999, tonumber(key_count) - 1) do
+            s:replace({k, payload})
+        end
+    end)
+end
+rawset(_G, 'echo', function(...) return ... end)
+box.schema.func.create('echo')
+box.schema.user.grant('guest', 'read,write', 'space', 'test')
+box.schema.user.grant('guest', 'execute', 'function', 'echo')
+local f = fio.open(fio.pathjoin(dir, 'ready'), {'O_CREAT', 'O_WRONLY'},
+                   tonumber('644', 8))
+f:close()
+]]
+
+local function read_all(ph)
+    local chunks = {}
+    while true do
+        local chunk = ph:read()
+        if chunk == nil or chunk == '' then
+            break
+        end
+        table.insert(chunks, chunk)
+    end
+    return table.concat(chunks)
+end
+
+local function run(threads, wal_mode)
+    local dir = fio.tempdir()
+    local script = fio.pathjoin(dir, 'server.lua')
+    local f = fio.open(script, {'O_CREAT', 'O_WRONLY'}, tonumber('644', 8))
+    f:write(SERVER_SCRIPT)
+    f:close()
+    local server = popen.new({arg[-1], script, threads, wal_mode,
+                              tostring(key_count), dir})
+    while not fio.path.exists(fio.pathjoin(dir, 'ready')) do
+        if server:info().status.state ~= popen.state.ALIVE then
+            error('failed to start server, see ' ..
+                  fio.pathjoin(dir, 'tarantool.log'))
+        end
+        fiber.sleep(0.1)
+    end
+    local loader = popen.new({
+        params.loader,
+        '--uri', 'unix/:' .. fio.pathjoin(dir, 'tarantool.sock'),
+        '--connections', tostring(params.connections or 16),
+        '--pipeline', tostring(params.pipeline or 16),
+        '--duration', tostring(params.duration or 10),
+        '--mix', params.mix or 'select=80,replace=20',
+        '--payload', tostring(params.payload or 100),
+        '--keys', tostring(key_count),
+        '--space', '512',
+        '--json',
+    }, {stdout = popen.opts.PIPE})
+    local output = read_all(loader)
+    local status = loader:wait()
+    loader:close()
+    server:kill()
+    server:wait()
+    server:close()
+    fio.rmtree(dir)
+    if status.exit_code ~= 0 then
+        error('load generator failed')
+    end
+    local result = json.decode(output)
+    result.iproto_threads = tonumber(threads)
+    result.wal_mode = wal_mode
+    return result
+end
+
+local results = {}
+for _, threads in ipairs(iproto_threads) do
+    for _, wal_mode in ipairs(wal_modes) do
+        table.insert(results, run(threads, wal_mode))
+    end
+end
+print(json.encode(results))
+os.exit(0)
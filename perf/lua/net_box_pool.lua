@@ -0,0 +1,116 @@
+--
+-- The test measures throughput of net.box calls sent over a single
+-- connection and over a connection pool by many fibers.
+--
+-- Output format:
+-- <test-case> <requests-per-second>
+--
+-- Options:
+-- --fibers <number>   number of fibers sending requests (default 100)
+-- --requests <number> number of requests sent by each fiber
+--                     (default 1000)
+-- --pool_size <number> number of connections in the pool (default 4)
+-- --batch <number>    number of async requests awaited in bulk
+--                     (default 10)
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local net = require('net.box')
+
+local params = require('internal.argparse').parse(arg, {
+    {'fibers', 'number'},
+    {'requests', 'number'},
+    {'pool_size', 'number'},
+    {'batch', 'number'},
+})
+local fiber_count = params.fibers or 100
+local request_count = params.requests or 1000
+local pool_size = params.pool_size or 4
+local batch_size = params.batch or 10
+
+local work_dir = fio.tempdir()
+box.cfg({
+    work_dir = work_dir,
+    listen = 'unix/:./net_box_pool.sock',
+    log_level = 'error',
+})
+box.schema.func.create('echo', {if_not_exists = true})
+box.schema.user.grant('guest', 'execute', 'function', 'echo',
+                      {if_not_exists = true})
+rawset(_G, 'echo', function(...) return ... end)
+
+local uri = box.info.listen
+
+--
+-- Runs the given function in fiber_count fibers and returns the number
+-- of requests per second sent by all of them.
+--
+local function bench(func)
+    local fibers = {}
+    local start = clock.monotonic()
+    for i = 1, fiber_count do
+        fibers[i] = fiber.new(func)
+        fibers[i]:set_joinable(true)
+    end
+    for i = 1, fiber_count do
+        assert(fibers[i]:join())
+    end
+    return fiber_count * request_count / (clock.monotonic() - start)
+end
+
+local TESTS = {
+    {
+        name = 'connection_call',
+        func = function(conn)
+            return function()
+                for i = 1, request_count do
+                    conn:call('echo', {i})
+                end
+            end
+        end,
+    },
+    {
+        name = 'pool_call',
+        pool = true,
+        func = function(pool)
+            return function()
+                for i = 1, request_count do
+                    pool:call('echo', {i})
+                end
+            end
+        end,
+    },
+    {
+        name = 'pool_call_batch',
+        pool = true,
+        func = function(pool)
+            return function()
+                local opts = {is_async = true}
+                for i = 1, request_count, batch_size do
+                    local futures = {}
+                    for j = 1, math.min(batch_size, request_count - i + 1) do
+                        futures[j] = pool:call('echo', {i + j}, opts)
+                    end
+                    assert(net.wait_all(futures) ~= nil)
+                end
+            end
+        end,
+    },
+}
+
+for _, test in ipairs(TESTS) do
+    local conn
+    if test.pool then
+        conn = net.pool(uri, {size = pool_size})
+    else
+        conn = net.connect(uri)
+    end
+    local rps = bench(test.func(conn))
+    conn:close()
+    print(string.format('%s %d', test.name, rps))
+end
+
+fio.rmtree(work_dir)
+os.exit(0)
@@ -0,0 +1,300 @@
+--
+-- The test starts a master in this process and the given number of
+-- replicas as child processes, drives write load on the master and
+-- measures how replication keeps up with it. The replicas are started
+-- anew for each of the given replication_threads values.
+--
+-- Output format:
+-- <replication_threads> <metric> <value>
+-- or a JSON array with an object per replication_threads value if
+-- --json is given.
+--
+-- Metrics:
+-- write_rps        rows written on the master per second
+-- apply_rps        rows applied by the slowest replica per second,
+--                  including the time it needed to catch up
+-- catch_up_time    time the slowest replica needed to catch up after
+--                  the load stopped, seconds
+-- lag_p50/p99/max  distribution of the relay transaction lag
+--                  (box.info.replication[].downstream.lag) of all the
+--                  replicas sampled during the load, seconds
+-- limbo_p50/p99/max distribution of the synchronous queue length
+--                  sampled during the load (with --sync)
+-- relay_cpu        CPU time consumed by the relay threads per second
+--                  of the load, summed over all the replicas (Linux)
+--
+-- Options:
+-- --replicas <number>      number of replicas (default 2)
+-- --anon                   use anonymous replicas
+-- --sync                   use a synchronous space, the quorum includes
+--                          all the replicas
+-- --replication_threads <list> comma separated replication_threads
+--                          values of the replicas (default '1')
+-- --fibers <number>        number of fibers writing on the master
+--                          (default 50)
+-- --transaction <number>   number of rows per transaction (default 10)
+-- --payload <number>       size of the tuple payload, bytes (default 100)
+-- --duration <number>      load time per configuration, seconds
+--                          (default 10)
+-- --json                   print the results in JSON
+--
+
+local clock = require('clock')
+local ffi = require('ffi')
+local fiber = require('fiber')
+local fio = require('fio')
+local json = require('json')
+local popen = require('popen')
+
+local params = require('internal.argparse').parse(arg, {
+    {'replicas', 'number'},
+    {'anon', 'boolean'},
+    {'sync', 'boolean'},
+    {'replication_threads', 'string'},
+    {'fibers', 'number'},
+    {'transaction', 'number'},
+    {'payload', 'number'},
+    {'duration', 'number'},
+    {'json', 'boolean'},
+})
+local replica_count = params.replicas or 2
+local fiber_count = params.fibers or 50
+local rows_per_txn = params.transaction or 10
+local payload = string.rep('x', params.payload or 100)
+local duration = params.duration or 10
+local thread_counts = string.split(params.replication_threads or '1', ',')
+
+local work_dir = fio.tempdir()
+box.cfg({
+    work_dir = work_dir,
+    listen = 'unix/:' .. fio.pathjoin(work_dir, 'master.sock'),
+    log_level = 'error',
+    replication_synchro_quorum = replica_count + 1,
+    replication_synchro_timeout = 1000,
+})
+box.schema.user.create('replicator', {password = 'password'})
+box.schema.user.grant('replicator', 'replication')
+local space = box.schema.space.create('test', {is_sync = params.sync})
+space:create_index('pk')
+if params.sync then
+    box.ctl.promote()
+end
+
+--
+-- Returns the downstream statuses of all the replicas that follow
+-- the master.
+--
+local function downstreams()
+    local result = {}
+    local replicas = params.anon and box.info.replication_anon() or
+                     box.info.replication
+    for _, r in pairs(replicas) do
+        if r.id ~= box.info.id and r.downstream ~= nil and
+                r.downstream.status == 'follow' then
+            table.insert(result, r.downstream)
+        end
+    end
+    return result
+end
+
+--
+-- Returns the CPU time consumed by the relay threads, in seconds.
+--
+ffi.cdef('long sysconf(int name);')
+local SC_CLK_TCK = 2
+local function relay_cpu_time()
+    local tasks = fio.listdir('/proc/self/task')
+    if tasks == nil then
+        return 0
+    end
+    local ticks = 0
+    for _, tid in ipairs(tasks) do
+        local dir = fio.pathjoin('/proc/self/task', tid)
+        local comm = fio.open(fio.pathjoin(dir, 'comm'))
+        local stat = fio.open(fio.pathjoin(dir, 'stat'))
+        if comm ~= nil and stat ~= nil and
+                comm:read():startswith('relay/') then
+            -- Skip the command, which may contain spaces, then
+            -- utime and stime are the 12th and 13th fields.
+            local fields = stat:read():match('%) (.*)'):split(' ')
+            ticks = ticks + tonumber(fields[12]) + tonumber(fields[13])
+        end
+        if comm ~= nil then
+            comm:close()
+        end
+        if stat ~= nil then
+            stat:close()
+        end
+    end
+    return ticks / tonumber(ffi.C.sysconf(SC_CLK_TCK))
+end
+
+local function percentiles(samples)
+    table.sort(samples)
+    local function pct(p)
+        if #samples == 0 then
+            return 0
+        end
+        return samples[math.max(1, math.ceil(#samples * p / 100))]
+    end
+    return pct(50), pct(99), samples[#samples] or 0
+end
+
+local function start_replicas(threads)
+    local replicas = {}
+    for i = 1, replica_count do
+        local dir = fio.pathjoin(work_dir, 'replica_' .. i)
+        fio.mkdir(dir)
+        local cmd = {arg[-1], '-e', string.format([[
+            box.cfg({
+                work_dir = %q,
+                log = 'tarantool.log',
+                log_level = 'error',
+                replication = {'replicator:password@%s'},
+                replication_anon = %s,
+                read_only = %s,
+                replication_threads = %d,
+            })
+        ]], dir, box.info.listen, tostring(params.anon),
+            tostring(params.anon), threads)}
+        replicas[i] = {
+            ph = popen.new(cmd, {
+                stdin = 'devnull', stdout = 'devnull', stderr = 'devnull',
+            }),
+            dir = dir,
+        }
+    end
+    local deadline = clock.monotonic() + 60
+    while #downstreams() < replica_count do
+        assert(clock.monotonic() < deadline, 'replicas failed to start')
+        fiber.sleep(0.1)
+    end
+    return replicas
+end
+
+local function stop_replicas(replicas)
+    for _, r in ipairs(replicas) do
+        r.ph:kill()
+        r.ph:wait()
+        r.ph:close()
+        fio.rmtree(r.dir)
+    end
+    -- Unregister the replicas so that the next ones get fresh ids.
+    local ids = {}
+    for _, t in box.space._cluster:pairs() do
+        if t[1] ~= box.info.id then
+            table.insert(ids, t[1])
+        end
+    end
+    for _, id in ipairs(ids) do
+        box.space._cluster:delete(id)
+    end
+end
+
+local function run(threads)
+    local replicas = start_replicas(threads)
+    local master_id = box.info.id
+    local start_lsn = box.info.lsn
+    local stop = false
+    local next_key = 0
+
+    local lag_samples = {}
+    local limbo_samples = {}
+    local sampler = fiber.new(function()
+        while not stop do
+            for _, d in ipairs(downstreams()) do
+                table.insert(lag_samples, d.lag or 0)
+            end
+            table.insert(limbo_samples, box.info.synchro.queue.len)
+            fiber.sleep(0.01)
+        end
+    end)
+    sampler:set_joinable(true)
+
+    local cpu_start = relay_cpu_time()
+    local start = clock.monotonic()
+    local fibers = {}
+    for i = 1, fiber_count do
+        fibers[i] = fiber.new(function()
+            while not stop do
+                box.atomic(function()
+                    for _ = 1, rows_per_txn do
+                        next_key = next_key + 1
+                        space:replace({next_key, payload})
+                    end
+                end)
+            end
+        end)
+        fibers[i]:set_joinable(true)
+    end
+    fiber.sleep(duration)
+    stop = true
+    for i = 1, fiber_count do
+        assert(fibers[i]:join())
+    end
+    assert(sampler:join())
+    local load_time = clock.monotonic() - start
+    local rows = box.info.lsn - start_lsn
+
+    -- Wait for all the replicas to catch up.
+    local end_lsn = box.info.lsn
+    while true do
+        local caught_up = true
+        for _, d in ipairs(downstreams()) do
+            if (d.vclock[master_id] or 0) < end_lsn then
+                caught_up = false
+            end
+        end
+        if caught_up then
+            break
+        end
+        fiber.sleep(0.001)
+    end
+    local total_time = clock.monotonic() - start
+    local relay_cpu = relay_cpu_time() - cpu_start
+
+    -- Truncate before stopping the replicas: it needs the quorum.
+    space:truncate()
+    stop_replicas(replicas)
+
+    local result = {
+        replication_threads = tonumber(threads),
+        write_rps = math.floor(rows / load_time),
+        apply_rps = math.floor(rows / total_time),
+        catch_up_time = total_time - load_time,
+        relay_cpu = relay_cpu / total_time,
+    }
+    result.lag_p50, result.lag_p99, result.lag_max =
+        percentiles(lag_samples)
+    if params.sync then
+        result.limbo_p50, result.limbo_p99, result.limbo_max =
+            percentiles(limbo_samples)
+    end
+    return result
+end
+
+local results = {}
+for _, threads in ipairs(thread_counts) do
+    table.insert(results, run(threads))
+end
+
+if params.json then
+    print(json.encode(results))
+else
+    for _, result in ipairs(results) do
+        local names = {}
+        for name in pairs(result) do
+            if name ~= 'replication_threads' then
+                table.insert(names, name)
+            end
+        end
+        table.sort(names)
+        for _, name in ipairs(names) do
+            print(string.format('%d %s %s', result.replication_threads,
+                                name, result[name]))
+        end
+    end
+end
+
+fio.rmtree(work_dir)
+os.exit(0)
@@ -0,0 +1,273 @@
+--
+-- The test runs OLTP-style prepared statements and a handful of
+-- analytic queries over generated order entry data (loosely modeled
+-- on TPC-C and TPC-H) and reports the time spent on preparing (parsing
+-- and planning) and executing each statement and the memory it used.
+--
+-- Output format:
+-- <test-case> <metric> <value>
+-- or a JSON object keyed by test case if --json is given.
+--
+-- Metrics:
+-- prepare_us  average time of box.prepare(), microseconds
+-- execute_us  average time of execution of a prepared statement,
+--             microseconds
+-- region_kb   memory allocated on the fiber region by the execution
+--             (high-water mark), KB
+--
+-- Options:
+-- --customers <number>  number of customers (default 10000)
+-- --items <number>      number of items (default 1000)
+-- --orders <number>     number of orders (default 100000)
+-- --runs <number>       number of runs of each OLTP statement, analytic
+--                       queries are run runs / 100 times (default 10000)
+-- --pattern <string>    run only tests matching the pattern; it's
+--                       possible to specify more than one pattern
+--                       separated by '|', for example, 'payment|revenue'
+-- --plan                print the query plan of each statement
+-- --json                print the results in JSON
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local json = require('json')
+
+local params = require('internal.argparse').parse(arg, {
+    {'customers', 'number'},
+    {'items', 'number'},
+    {'orders', 'number'},
+    {'runs', 'number'},
+    {'pattern', 'string'},
+    {'plan', 'boolean'},
+    {'json', 'boolean'},
+})
+local customer_count = params.customers or 10000
+local item_count = params.items or 1000
+local order_count = params.orders or 100000
+local run_count = params.runs or 10000
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local REGIONS = {'NORTH', 'SOUTH', 'EAST', 'WEST'}
+
+local work_dir = fio.tempdir()
+box.cfg({work_dir = work_dir, log_level = 'error'})
+box.execute([[SET SESSION "sql_seq_scan" = true;]])
+
+local function execute(sql, args)
+    local res, err = box.execute(sql, args)
+    if err ~= nil then
+        error(err)
+    end
+    return res
+end
+
+execute([[CREATE TABLE customer (id INTEGER PRIMARY KEY, name STRING,
+                                 region STRING, balance NUMBER);]])
+execute([[CREATE TABLE item (id INTEGER PRIMARY KEY, name STRING,
+                             price NUMBER);]])
+execute([[CREATE TABLE orders (id INTEGER PRIMARY KEY,
+                               customer_id INTEGER, created INTEGER,
+                               total NUMBER);]])
+execute([[CREATE INDEX orders_customer ON orders (customer_id);]])
+execute([[CREATE TABLE order_line (order_id INTEGER, line INTEGER,
+                                   item_id INTEGER, qty INTEGER,
+                                   amount NUMBER,
+                                   PRIMARY KEY (order_id, line));]])
+
+--
+-- Fills the tables with generated data using the Lua API, which is
+-- much faster than SQL inserts.
+--
+local function fill()
+    math.randomseed(42)
+    box.begin()
+    for i = 1, customer_count do
+        box.space.CUSTOMER:insert({i, 'customer' .. i,
+                                   REGIONS[i % #REGIONS + 1], 0})
+    end
+    local prices = {}
+    for i = 1, item_count do
+        prices[i] = math.random(100, 10000) / 100
+        box.space.ITEM:insert({i, 'item' .. i, prices[i]})
+    end
+    box.commit()
+    for i = 1, order_count do
+        if i % 1000 == 1 then
+            box.begin()
+        end
+        local total = 0
+        for line = 1, math.random(1, 10) do
+            local item = math.random(item_count)
+            local qty = math.random(1, 5)
+            box.space.ORDER_LINE:insert({i, line, item, qty,
+                                         qty * prices[item]})
+            total = total + qty * prices[item]
+        end
+        box.space.ORDERS:insert({i, math.random(customer_count), i, total})
+        if i % 1000 == 0 or i == order_count then
+            box.commit()
+        end
+    end
+end
+fill()
+
+local next_order = order_count
+local next_line = 0
+
+--
+-- Array of test cases.
+--
+-- A test case is represented by a table with the following fields:
+--
+-- * name: test case name
+-- * sql: statement text
+-- * args: function returning statement arguments
+-- * analytic: true if the statement is an analytic query
+--
+local TESTS = {
+    {
+        name = 'new_order',
+        sql = [[INSERT INTO orders VALUES (?, ?, ?, ?);]],
+        args = function()
+            next_order = next_order + 1
+            return {next_order, math.random(customer_count), next_order,
+                    math.random(100, 10000) / 100}
+        end,
+    },
+    {
+        name = 'new_order_line',
+        sql = [[INSERT INTO order_line VALUES (?, ?, ?, ?, ?);]],
+        args = function()
+            next_line = next_line + 1
+            return {next_order, next_line, math.random(item_count), 1, 1.5}
+        end,
+    },
+    {
+        name = 'payment',
+        sql = [[UPDATE customer SET balance = balance - ? WHERE id = ?;]],
+        args = function()
+            return {math.random(100, 10000) / 100,
+                    math.random(customer_count)}
+        end,
+    },
+    {
+        name = 'order_status',
+        sql = [[SELECT o.id, o.total, COUNT(*) FROM orders AS o
+                JOIN order_line AS ol ON ol.order_id = o.id
+                WHERE o.customer_id = ? GROUP BY o.id, o.total;]],
+        args = function()
+            return {math.random(customer_count)}
+        end,
+    },
+    {
+        name = 'item_price',
+        sql = [[SELECT price FROM item WHERE id = ?;]],
+        args = function()
+            return {math.random(item_count)}
+        end,
+    },
+    {
+        name = 'revenue_by_region',
+        sql = [[SELECT c.region, SUM(o.total) FROM orders AS o
+                JOIN customer AS c ON c.id = o.customer_id
+                GROUP BY c.region;]],
+        analytic = true,
+    },
+    {
+        name = 'top_items',
+        sql = [[SELECT i.name, SUM(ol.qty) AS q FROM order_line AS ol
+                JOIN item AS i ON i.id = ol.item_id
+                GROUP BY i.name ORDER BY q DESC LIMIT 10;]],
+        analytic = true,
+    },
+    {
+        name = 'big_orders',
+        sql = [[SELECT COUNT(*), AVG(total) FROM orders
+                WHERE total > (SELECT AVG(total) FROM orders);]],
+        analytic = true,
+    },
+    {
+        name = 'top_customers',
+        sql = [[SELECT customer_id, SUM(total) AS s FROM orders
+                GROUP BY customer_id ORDER BY s DESC LIMIT 10;]],
+        analytic = true,
+    },
+}
+
+local function match_pattern(name)
+    if params.pattern == nil then
+        return true
+    end
+    for _, p in ipairs(params.pattern) do
+        if string.match(name, p) then
+            return true
+        end
+    end
+    return false
+end
+
+--
+-- Runs the given test case in a new fiber, so that the region memory
+-- of the fiber reflects the memory used by the statement.
+--
+local function run(test)
+    local count = test.analytic and math.max(1, math.floor(run_count / 100)) or
+                  run_count
+    local result = {}
+    local f = fiber.new(function()
+        local start = clock.monotonic()
+        for _ = 1, count do
+            local stmt = assert(box.prepare(test.sql))
+            stmt:unprepare()
+        end
+        result.prepare_us = (clock.monotonic() - start) / count * 1e6
+        local stmt = assert(box.prepare(test.sql))
+        start = clock.monotonic()
+        for _ = 1, count do
+            local _, err = stmt:execute(test.args and test.args() or {})
+            if err ~= nil then
+                error(err)
+            end
+        end
+        result.execute_us = (clock.monotonic() - start) / count * 1e6
+        stmt:unprepare()
+        local info = fiber.info({backtrace = false})[fiber.id()]
+        result.region_kb = info.memory.total / 1024
+    end)
+    f:set_joinable(true)
+    assert(f:join())
+    if params.plan then
+        local plan = execute('EXPLAIN QUERY PLAN ' .. test.sql,
+                             test.args and test.args() or {})
+        print('# ' .. test.name)
+        for _, row in ipairs(plan.rows) do
+            print('#   ' .. json.encode(row))
+        end
+    end
+    return result
+end
+
+local results = {}
+for _, test in ipairs(TESTS) do
+    if match_pattern(test.name) then
+        local result = run(test)
+        if params.json then
+            results[test.name] = result
+        else
+            for _, metric in ipairs({'prepare_us', 'execute_us',
+                                     'region_kb'}) do
+                print(string.format('%s %s %.1f', test.name, metric,
+                                    result[metric]))
+            end
+        end
+    end
+end
+if params.json then
+    print(json.encode(results))
+end
+
+fio.rmtree(work_dir)
+os.exit(0)
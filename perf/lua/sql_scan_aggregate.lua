@@ -0,0 +1,83 @@
+--
+-- The test measures throughput of SQL full scans with a filter and
+-- an aggregate over narrow and wide tables.
+--
+-- Output format:
+-- <test-case> <rows-per-second>
+--
+-- Options:
+-- --rows <number>     number of rows in each table (default 100000)
+-- --runs <number>     number of times each query is run (default 10)
+--
+
+local clock = require('clock')
+local fio = require('fio')
+
+local params = require('internal.argparse').parse(arg, {
+    {'rows', 'number'},
+    {'runs', 'number'},
+})
+local row_count = params.rows or 100000
+local run_count = params.runs or 10
+
+local work_dir = fio.tempdir()
+box.cfg({work_dir = work_dir, log_level = 'error'})
+box.execute([[SET SESSION "sql_seq_scan" = true;]])
+
+--
+-- Creates a table with the given number of integer columns and fills
+-- it with row_count rows.
+--
+local function create_table(name, column_count)
+    local format = {}
+    for i = 1, column_count do
+        format[i] = {'C' .. i, 'integer'}
+    end
+    local s = box.schema.space.create(name, {format = format})
+    s:create_index('pk')
+    box.begin()
+    for i = 1, row_count do
+        local tuple = {}
+        for j = 1, column_count do
+            tuple[j] = i + j
+        end
+        s:insert(tuple)
+        if i % 1000 == 0 then
+            box.commit()
+            box.begin()
+        end
+    end
+    box.commit()
+end
+
+create_table('NARROW', 4)
+create_table('WIDE', 100)
+
+local TESTS = {
+    {
+        name = 'narrow_sum',
+        sql = 'SELECT SUM(c2) FROM narrow WHERE c3 > ?;',
+    },
+    {
+        name = 'narrow_count_min_max',
+        sql = 'SELECT COUNT(*), MIN(c4), MAX(c4) FROM narrow WHERE c3 > ?;',
+    },
+    {
+        name = 'wide_sum',
+        sql = 'SELECT SUM(c90) FROM wide WHERE c50 > ?;',
+    },
+}
+
+for _, test in ipairs(TESTS) do
+    local stmt = assert(box.prepare(test.sql))
+    local start = clock.monotonic()
+    for _ = 1, run_count do
+        assert(stmt:execute({row_count / 2}))
+    end
+    local rps = row_count * run_count / (clock.monotonic() - start)
+    stmt:unprepare()
+    print(string.format('%s %d', test.name, rps))
+end
+
+fio.rmtree(work_dir)
+os.exit(0)
@@ -0,0 +1,153 @@
+--
+-- The test measures run time of encoding Lua tables to tuples on
+-- various data manipulation requests.
+--
+-- Output format:
+-- <test-case> <run-time-nanoseconds>
+--
+-- Options:
+-- --pattern <string>  run only tests matching the pattern; it's possible
+--                     to specify more than one pattern separated by '|',
+--                     for example, 'replace|tuple_new'
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local msgpack = require('msgpack')
+
+local params = require('internal.argparse').parse(arg, {
+    {'pattern', 'string'},
+})
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+box.cfg({log_level = 'error'})
+box.once('perf_tuple_encode_init', function()
+    local s = box.schema.space.create('perf_tuple_encode_space', {
+        format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'name', type = 'string'},
+            {name = 'email', type = 'string'},
+            {name = 'age', type = 'unsigned'},
+            {name = 'balance', type = 'number'},
+            {name = 'is_active', type = 'boolean'},
+            {name = 'created', type = 'unsigned'},
+            {name = 'comment', type = 'string', is_nullable = true},
+        },
+    })
+    s:create_index('primary')
+end)
+
+local space = box.space.perf_tuple_encode_space
+
+local function user(id)
+    return {id, 'user' .. id, 'user' .. id .. '@example.com', 30, 123.45,
+            true, 1700000000, box.NULL}
+end
+
+local function user_map(id)
+    return {
+        id = id, name = 'user' .. id, email = 'user' .. id .. '@example.com',
+        age = 30, balance = 123.45, is_active = true, created = 1700000000,
+    }
+end
+
+local tuple = user(1)
+local tuple_map = user_map(1)
+local nested = {1, 'user1', {tags = {'a', 'b', 'c'}, score = 10}, {1, 2, 3}}
+
+--
+-- Array of test cases.
+--
+-- A test case is represented by a table with the following mandatory fields:
+--
+-- * name: test case name
+-- * func: test function
+--
+local TESTS = {
+    {
+        name = 'msgpack_encode',
+        func = function()
+            msgpack.encode(tuple)
+        end,
+    },
+    {
+        name = 'msgpack_encode_nested',
+        func = function()
+            msgpack.encode(nested)
+        end,
+    },
+    {
+        name = 'tuple_new',
+        func = function()
+            box.tuple.new(tuple)
+        end,
+    },
+    {
+        name = 'replace',
+        func = function()
+            space:replace(tuple)
+        end,
+    },
+    {
+        name = 'replace_new_table',
+        func = function()
+            space:replace(user(1))
+        end,
+    },
+    {
+        name = 'frommap',
+        func = function()
+            space:frommap(tuple_map)
+        end,
+    },
+}
+
+--
+-- Runs the given test case function in a loop.
+-- Returns the average time it takes to run the function once.
+--
+local function bench(test)
+    local warmup_runs = 1e2 / 4
+    local test_runs = 1e2
+    local iters_per_run = 1e4
+    local func = test.func
+    local run = function()
+        for _ = 1, iters_per_run do
+            func()
+        end
+    end
+    local test_time = 0
+    for i = 1, warmup_runs + test_runs do
+        for _ = 1, 5 do
+            collectgarbage('collect')
+            jit.flush()
+            fiber.yield()
+        end
+        local t = clock.bench(run)[1]
+        if i > warmup_runs then
+            test_time = test_time + t
+        end
+    end
+    return test_time / test_runs / iters_per_run
+end
+
+for _, test in ipairs(TESTS) do
+    local skip = false
+    if params.pattern then
+        skip = true
+        for _, pattern in ipairs(params.pattern) do
+            if string.match(test.name, pattern) then
+                skip = false
+                break
+            end
+        end
+    end
+    if not skip then
+        local t = bench(test)
+        print(string.format('%s %d', test.name, t * 1e9))
+    end
+end
+
+os.exit(0)
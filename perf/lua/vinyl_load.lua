@@ -0,0 +1,249 @@
+--
+-- The test runs a mix of writes, point lookups and range scans against
+-- a vinyl space and reports the throughput, the latency distribution of
+-- each kind of operation and the amplification and background work
+-- metrics collected by vinyl.
+--
+-- Output format:
+-- <metric> <value>
+-- or a JSON object with the same metrics if --json is given.
+--
+-- Metrics:
+-- <op>_rps, <op>_p50/p90/p99/p999/max (microseconds)
+--                     throughput and latency of each kind of operation
+-- write_amplification bytes written to disk by dumps and compactions
+--                     per byte written by the user
+-- read_amplification  pages read from disk per lookup
+-- space_amplification disk size divided by the size of the last level
+-- dump_bandwidth      dump output bytes per second of dump time
+-- compaction_bandwidth compaction output bytes per second of compaction
+--                     time
+-- dump_count, compaction_count
+-- throttle_count, throttle_time
+--                     number of transactions waiting for quota and time
+--                     they waited, seconds
+--
+-- Options:
+-- --vinyl_memory <number>  vinyl_memory, MB (default 128)
+-- --run_count_per_level <number> index option (default 2)
+-- --bloom_fpr <number>     index option (default 0.05)
+-- --page_size <number>     index option, bytes (default 8192)
+-- --range_size <number>    index option, bytes (default 1073741824)
+-- --fibers <number>        number of fibers generating load (default 16)
+-- --duration <number>      measurement time, seconds (default 60)
+-- --keys <number>          number of distinct keys (default 1000000)
+-- --payload <number>       size of the tuple payload, bytes (default 100)
+-- --mix <string>           operation mix
+--                          (default 'replace=50,get=40,scan=10')
+--                          kinds: replace, upsert, delete, get, scan
+-- --scan_limit <number>    number of tuples fetched by a scan (default 10)
+-- --no_prefill             don't fill the space before the measurement
+-- --json                   print the results in JSON
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local fio = require('fio')
+local json = require('json')
+
+local params = require('internal.argparse').parse(arg, {
+    {'vinyl_memory', 'number'},
+    {'run_count_per_level', 'number'},
+    {'bloom_fpr', 'number'},
+    {'page_size', 'number'},
+    {'range_size', 'number'},
+    {'fibers', 'number'},
+    {'duration', 'number'},
+    {'keys', 'number'},
+    {'payload', 'number'},
+    {'mix', 'string'},
+    {'scan_limit', 'number'},
+    {'no_prefill', 'boolean'},
+    {'json', 'boolean'},
+})
+local fiber_count = params.fibers or 16
+local duration = params.duration or 60
+local key_count = params.keys or 1000000
+local payload = string.rep('x', params.payload or 100)
+local scan_limit = params.scan_limit or 10
+
+local OPS = {'replace', 'upsert', 'delete', 'get', 'scan'}
+local mix = {}
+local mix_total = 0
+for _, item in ipairs(string.split(params.mix or
+                                   'replace=50,get=40,scan=10', ',')) do
+    local name, weight = unpack(string.split(item, '='))
+    weight = tonumber(weight or 1)
+    assert(table.find(OPS, name) ~= nil, 'unknown operation ' .. name)
+    assert(weight ~= nil and weight >= 0, 'invalid weight of ' .. name)
+    mix_total = mix_total + weight
+    table.insert(mix, {name = name, weight = mix_total})
+end
+assert(mix_total > 0, 'empty operation mix')
+
+local work_dir = fio.tempdir()
+box.cfg({
+    work_dir = work_dir,
+    log_level = 'error',
+    vinyl_memory = (params.vinyl_memory or 128) * 1024 * 1024,
+})
+local space = box.schema.space.create('test', {engine = 'vinyl'})
+space:create_index('pk', {
+    run_count_per_level = params.run_count_per_level or 2,
+    bloom_fpr = params.bloom_fpr or 0.05,
+    page_size = params.page_size or 8192,
+    range_size = params.range_size or 1024 * 1024 * 1024,
+})
+
+local function random_key()
+    return math.random(0, key_count - 1)
+end
+
+local OP_FUNCS = {
+    replace = function()
+        space:replace({random_key(), payload})
+    end,
+    upsert = function()
+        space:upsert({random_key(), payload}, {{'=', 2, payload}})
+    end,
+    delete = function()
+        space:delete({random_key()})
+    end,
+    get = function()
+        space:get({random_key()})
+    end,
+    scan = function()
+        space:select({random_key()}, {iterator = 'GE', limit = scan_limit})
+    end,
+}
+
+local function choose_op()
+    local r = math.random(mix_total)
+    for _, op in ipairs(mix) do
+        if r <= op.weight then
+            return op.name
+        end
+    end
+end
+
+--
+-- Latency histogram with two significant digits of precision, in
+-- microseconds: maps the upper bound of a bucket to the number of
+-- observations.
+--
+local function hist_collect(hist, value)
+    local us = math.ceil(value * 1e6)
+    if us >= 100 then
+        local scale = 10 ^ (math.floor(math.log10(us)) - 1)
+        us = math.ceil(us / scale) * scale
+    end
+    hist[us] = (hist[us] or 0) + 1
+end
+
+local function hist_percentiles(hist, pcts)
+    local bounds = {}
+    local total = 0
+    for bound, count in pairs(hist) do
+        table.insert(bounds, bound)
+        total = total + count
+    end
+    table.sort(bounds)
+    local result = {}
+    local count = 0
+    local i = 1
+    for _, bound in ipairs(bounds) do
+        count = count + hist[bound]
+        while i <= #pcts and count * 100 >= total * pcts[i] do
+            result[i] = bound
+            i = i + 1
+        end
+    end
+    return result
+end
+
+if not params.no_prefill then
+    for i = 0, key_count - 1, 1000 do
+        box.atomic(function()
+            for k = i, math.min(i + 999, key_count - 1) do
+                space:replace({k, payload})
+            end
+        end)
+    end
+    box.snapshot()
+end
+box.stat.reset()
+
+local hists = {}
+local counts = {}
+for _, name in ipairs(OPS) do
+    hists[name] = {}
+    counts[name] = 0
+end
+
+local deadline = clock.monotonic() + duration
+local fibers = {}
+for i = 1, fiber_count do
+    fibers[i] = fiber.new(function()
+        while clock.monotonic() < deadline do
+            local name = choose_op()
+            local start = clock.monotonic()
+            OP_FUNCS[name]()
+            hist_collect(hists[name], clock.monotonic() - start)
+            counts[name] = counts[name] + 1
+        end
+    end)
+    fibers[i]:set_joinable(true)
+end
+for i = 1, fiber_count do
+    assert(fibers[i]:join())
+end
+
+local results = {}
+local PCTS = {50, 90, 99, 99.9, 100}
+local PCT_NAMES = {'p50', 'p90', 'p99', 'p999', 'max'}
+for _, name in ipairs(OPS) do
+    if counts[name] > 0 then
+        results[name .. '_rps'] = math.floor(counts[name] / duration)
+        local values = hist_percentiles(hists[name], PCTS)
+        for i, pct_name in ipairs(PCT_NAMES) do
+            results[name .. '_' .. pct_name] = values[i]
+        end
+    end
+end
+
+local stat = space.index.pk:stat()
+local vinyl = box.stat.vinyl()
+local function ratio(a, b)
+    return b > 0 and a / b or 0
+end
+results.write_amplification = ratio(stat.disk.dump.output.bytes +
+                                    stat.disk.compaction.output.bytes,
+                                    stat.put.bytes)
+results.read_amplification = ratio(stat.disk.iterator.read.pages,
+                                   stat.lookup)
+results.space_amplification = ratio(stat.disk.bytes,
+                                    stat.disk.last_level.bytes)
+results.dump_bandwidth = ratio(vinyl.scheduler.dump_output,
+                               vinyl.scheduler.dump_time)
+results.compaction_bandwidth = ratio(vinyl.scheduler.compaction_output,
+                                     vinyl.scheduler.compaction_time)
+results.dump_count = stat.disk.dump.count
+results.compaction_count = stat.disk.compaction.count
+results.throttle_count = stat.throttle.count
+results.throttle_time = stat.throttle.time
+
+if params.json then
+    print(json.encode(results))
+else
+    local names = {}
+    for name in pairs(results) do
+        table.insert(names, name)
+    end
+    table.sort(names)
+    for _, name in ipairs(names) do
+        print(string.format('%s %s', name, results[name]))
+    end
+end
+
+fio.rmtree(work_dir)
+os.exit(0)
@@ -0,0 +1,209 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "memory.h"
+#include "fiber.h"
+#include "tuple.h"
+#include "key_def.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * This suite contains benchmarks for tuple comparators selected for
+ * key definitions found in typical schemas: primary keys, secondary
+ * keys extended with the primary key parts, composite keys of mixed
+ * types. Tuples have the following fields:
+ *
+ *   [id, category, name, delta, price, comment]
+ *
+ * where category, name and delta have few distinct values so that
+ * comparisons often go past the first key part. Hints aren't used
+ * to measure the comparators themselves.
+ */
+
+/** Number of test tuples. */
+static constexpr size_t tuple_count = 4096;
+
+/** Key part definition: field number, type and nullability. */
+struct KeyPart {
+	uint32_t fieldno;
+	enum field_type type;
+	bool is_nullable;
+};
+
+/** Key definitions covered by the suite. */
+static const struct {
+	const char *name;
+	std::vector<KeyPart> parts;
+} keys[] = {
+	{"id", {{0, FIELD_TYPE_UNSIGNED, false}}},
+	{"name", {{2, FIELD_TYPE_STRING, false}}},
+	{"category_id", {{1, FIELD_TYPE_UNSIGNED, false},
+			 {0, FIELD_TYPE_UNSIGNED, false}}},
+	{"name_id", {{2, FIELD_TYPE_STRING, false},
+		     {0, FIELD_TYPE_UNSIGNED, false}}},
+	{"delta_comment", {{3, FIELD_TYPE_INTEGER, false},
+			   {5, FIELD_TYPE_STRING, false}}},
+	{"name_category_delta", {{2, FIELD_TYPE_STRING, false},
+				 {1, FIELD_TYPE_UNSIGNED, false},
+				 {3, FIELD_TYPE_INTEGER, false}}},
+	{"category_comment_id", {{1, FIELD_TYPE_UNSIGNED, false},
+				 {5, FIELD_TYPE_STRING, false},
+				 {0, FIELD_TYPE_UNSIGNED, false}}},
+	{"category_price", {{1, FIELD_TYPE_UNSIGNED, false},
+			    {4, FIELD_TYPE_DOUBLE, false}}},
+	{"nullable_category_id", {{1, FIELD_TYPE_UNSIGNED, true},
+				  {0, FIELD_TYPE_UNSIGNED, false}}},
+};
+
+/** Initializes the subsystems tuples depend on. */
+class TupleEnv {
+public:
+	static TupleEnv &instance()
+	{
+		static TupleEnv instance;
+		return instance;
+	}
+private:
+	TupleEnv()
+	{
+		memory_init();
+		fiber_init(fiber_c_invoke);
+		tuple_init(NULL);
+	}
+	~TupleEnv()
+	{
+		tuple_free();
+		fiber_free();
+		memory_free();
+	}
+};
+
+/** Test tuples and keys extracted from them for a key definition. */
+class TupleCompareFixture {
+public:
+	TupleCompareFixture(size_t key_no)
+	{
+		TupleEnv::instance();
+		const auto &parts = keys[key_no].parts;
+		std::vector<struct key_part_def> part_defs(parts.size());
+		for (size_t i = 0; i < parts.size(); i++) {
+			part_defs[i] = key_part_def_default;
+			part_defs[i].fieldno = parts[i].fieldno;
+			part_defs[i].type = parts[i].type;
+			part_defs[i].is_nullable = parts[i].is_nullable;
+		}
+		key_def = key_def_new(part_defs.data(), part_defs.size(), 0);
+		if (key_def == NULL)
+			abort();
+		format = box_tuple_format_new(&key_def, 1);
+		if (format == NULL)
+			abort();
+		tuple_format_ref(format);
+		for (size_t i = 0; i < tuple_count; i++) {
+			struct tuple *tuple = new_tuple(i);
+			tuple_ref(tuple);
+			tuples.push_back(tuple);
+			size_t used = region_used(&fiber()->gc);
+			uint32_t size;
+			const char *key = tuple_extract_key(tuple, key_def,
+							    MULTIKEY_NONE,
+							    &size);
+			if (key == NULL)
+				abort();
+			tuple_keys.emplace_back(key, size);
+			region_truncate(&fiber()->gc, used);
+		}
+		part_count = key_def->part_count;
+	}
+	~TupleCompareFixture()
+	{
+		for (struct tuple *tuple : tuples)
+			tuple_unref(tuple);
+		tuple_format_unref(format);
+		key_def_delete(key_def);
+	}
+
+	struct key_def *key_def;
+	uint32_t part_count;
+	std::vector<struct tuple *> tuples;
+	std::vector<std::string> tuple_keys;
+private:
+	struct tuple *new_tuple(size_t i)
+	{
+		char buf[256];
+		char str[64];
+		char *end = mp_encode_array(buf, 6);
+		end = mp_encode_uint(end, i);
+		end = mp_encode_uint(end, i % 16);
+		int len = snprintf(str, sizeof(str), "name%02zu", (i * 7) % 64);
+		end = mp_encode_str(end, str, len);
+		end = mp_encode_int(end, (int64_t)(i % 8) - 4);
+		end = mp_encode_double(end, (double)(i % 100) / 4);
+		len = snprintf(str, sizeof(str), "comment %zu", i * 31 % 1000);
+		end = mp_encode_str(end, str, len);
+		struct tuple *tuple = tuple_new(format, buf, end);
+		if (tuple == NULL)
+			abort();
+		return tuple;
+	}
+
+	struct tuple_format *format;
+};
+
+/** Tuple with tuple comparison benchmark. */
+static void
+bench_tuple_compare(benchmark::State &state)
+{
+	TupleCompareFixture fixture(state.range(0));
+	state.SetLabel(keys[state.range(0)].name);
+	size_t i = 0, j = 0;
+	for (auto _ : state) {
+		struct tuple *a = fixture.tuples[i];
+		struct tuple *b = fixture.tuples[j];
+		benchmark::DoNotOptimize(tuple_compare(a, HINT_NONE,
+						       b, HINT_NONE,
+						       fixture.key_def));
+		i = (i + 1) % tuple_count;
+		j = (j + 3) % tuple_count;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+/** Tuple with key comparison benchmark. */
+static void
+bench_tuple_compare_with_key(benchmark::State &state)
+{
+	TupleCompareFixture fixture(state.range(0));
+	state.SetLabel(keys[state.range(0)].name);
+	size_t i = 0, j = 0;
+	for (auto _ : state) {
+		struct tuple *a = fixture.tuples[i];
+		const char *key = fixture.tuple_keys[j].data();
+		mp_decode_array(&key);
+		benchmark::DoNotOptimize(tuple_compare_with_key(
+			a, HINT_NONE, key, fixture.part_count, HINT_NONE,
+			fixture.key_def));
+		i = (i + 1) % tuple_count;
+		j = (j + 3) % tuple_count;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void
+bench_keys(benchmark::internal::Benchmark *b)
+{
+	for (size_t i = 0; i < lengthof(keys); i++)
+		b->Arg(i);
+}
+
+BENCHMARK(bench_tuple_compare)
+	->ArgNames({"key"})
+	->Apply(bench_keys);
+
+BENCHMARK(bench_tuple_compare_with_key)
+	->ArgNames({"key"})
+	->Apply(bench_keys);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "memory.h"
+#include "fiber.h"
+#include "tuple.h"
+#include "vy_mem.h"
+#include "vy_stmt.h"
+
+/**
+ * Helpers shared by the vinyl benchmarks.
+ */
+
+/** Size of the arena used for allocating statements. */
+static constexpr size_t mem_arena_size = 512 * 1024 * 1024;
+/** Size of string keys. Keys share a common prefix to defeat hints. */
+static constexpr size_t str_key_size = 32;
+
+/** Initializes the subsystems vinyl statements depend on. */
+class VinylEnv {
+public:
+	static VinylEnv &instance()
+	{
+		static VinylEnv instance;
+		return instance;
+	}
+	struct vy_stmt_env *stmt_env() { return &stmt; }
+	struct vy_mem_env *mem_env() { return &mem; }
+private:
+	VinylEnv()
+	{
+		memory_init();
+		fiber_init(fiber_c_invoke);
+		tuple_init(NULL);
+		vy_stmt_env_create(&stmt);
+		vy_mem_env_create(&mem, mem_arena_size);
+	}
+	~VinylEnv()
+	{
+		vy_mem_env_destroy(&mem);
+		vy_stmt_env_destroy(&stmt);
+		tuple_free();
+		fiber_free();
+		memory_free();
+	}
+
+	struct vy_stmt_env stmt;
+	struct vy_mem_env mem;
+};
+
+/**
+ * Create a REPLACE statement with an unsigned or string (if @a is_str
+ * is set) key in the lsregion of the mem environment so that it can
+ * be inserted into a mem of the given generation.
+ */
+static inline struct vy_entry
+vy_perf_new_stmt(struct tuple_format *format, struct key_def *key_def,
+		 int64_t generation, bool is_str, uint64_t key, int64_t lsn)
+{
+	struct vy_mem_env *env = VinylEnv::instance().mem_env();
+	char buf[64];
+	char *end = mp_encode_array(buf, 1);
+	if (is_str) {
+		char str[str_key_size + 1];
+		snprintf(str, sizeof(str), "%0*llu", (int)str_key_size,
+			 (unsigned long long)key);
+		end = mp_encode_str(end, str, str_key_size);
+	} else {
+		end = mp_encode_uint(end, key);
+	}
+	struct tuple *stmt = vy_stmt_new_replace(format, buf, end);
+	if (stmt == NULL)
+		abort();
+	struct tuple *region_stmt = vy_stmt_dup_lsregion(
+		stmt, &env->allocator, generation);
+	if (region_stmt == NULL)
+		abort();
+	tuple_unref(stmt);
+	vy_stmt_set_lsn(region_stmt, lsn);
+	struct vy_entry entry;
+	entry.stmt = region_stmt;
+	entry.hint = vy_stmt_hint(region_stmt, key_def);
+	return entry;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "vy_common.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * This suite contains benchmarks for the in-memory level of vinyl
+ * LSM trees (vy_mem). It measures insertions into and lookups in
+ * the statement tree, which are done in the tx thread by every
+ * vinyl write.
+ */
+
+/** Number of statements inserted in a mem before it's recreated. */
+static constexpr size_t stmt_count = 1 << 18;
+/**
+ * A mem and a set of REPLACE statements to insert into it, with
+ * unsigned or string keys, in the ascending or random order.
+ */
+class VyMemFixture {
+public:
+	VyMemFixture(bool is_str, bool is_random)
+		: is_str(is_str)
+	{
+		env = VinylEnv::instance().mem_env();
+		uint32_t field = 0;
+		uint32_t type = is_str ? FIELD_TYPE_STRING :
+					 FIELD_TYPE_UNSIGNED;
+		key_def = box_key_def_new(&field, &type, 1);
+		format = vy_simple_stmt_format_new(
+			VinylEnv::instance().stmt_env(), &key_def, 1);
+		tuple_format_ref(format);
+		for (size_t i = 0; i < stmt_count; i++)
+			keys.push_back(i);
+		if (is_random) {
+			std::mt19937 gen(stmt_count);
+			std::shuffle(keys.begin(), keys.end(), gen);
+		}
+		reset();
+	}
+	~VyMemFixture()
+	{
+		vy_mem_delete(mem);
+		lsregion_gc(&env->allocator, generation);
+		tuple_format_unref(format);
+		key_def_delete(key_def);
+	}
+	/** Create a new empty mem and new statements to insert. */
+	void reset()
+	{
+		if (mem != NULL) {
+			vy_mem_delete(mem);
+			lsregion_gc(&env->allocator, generation);
+		}
+		generation++;
+		mem = vy_mem_new(env, key_def, format, generation, 0);
+		if (mem == NULL)
+			abort();
+		entries.clear();
+		for (size_t i = 0; i < stmt_count; i++)
+			entries.push_back(new_stmt(keys[i], i + 1));
+	}
+
+	struct vy_mem *mem = NULL;
+	std::vector<struct vy_entry> entries;
+private:
+	struct vy_entry new_stmt(uint64_t key, int64_t lsn)
+	{
+		return vy_perf_new_stmt(format, key_def, generation, is_str,
+					key, lsn);
+	}
+
+	bool is_str;
+	struct vy_mem_env *env;
+	struct key_def *key_def;
+	struct tuple_format *format;
+	std::vector<uint64_t> keys;
+	int64_t generation = 0;
+};
+
+/** vy_mem_insert() benchmark. */
+static void
+bench_vy_mem_insert(benchmark::State &state)
+{
+	VyMemFixture fixture(state.range(0) != 0, state.range(1) != 0);
+	size_t total_count = 0;
+	size_t i = 0;
+	for (auto _ : state) {
+		if (i == stmt_count) {
+			state.PauseTiming();
+			fixture.reset();
+			total_count += i;
+			i = 0;
+			state.ResumeTiming();
+		}
+		if (vy_mem_insert(fixture.mem, fixture.entries[i]) != 0)
+			abort();
+		i++;
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(bench_vy_mem_insert)
+	->ArgNames({"str", "random"})
+	->Args({0, 0})->Args({0, 1})->Args({1, 0})->Args({1, 1});
+
+/** Point lookup in a mem benchmark. */
+static void
+bench_vy_mem_lookup(benchmark::State &state)
+{
+	VyMemFixture fixture(state.range(0) != 0, /*is_random=*/true);
+	for (size_t i = 0; i < stmt_count; i++) {
+		if (vy_mem_insert(fixture.mem, fixture.entries[i]) != 0)
+			abort();
+	}
+	size_t total_count = 0;
+	size_t i = 0;
+	for (auto _ : state) {
+		struct vy_mem_tree_key key;
+		key.entry = fixture.entries[i];
+		key.lsn = vy_stmt_lsn(key.entry.stmt);
+		bool exact;
+		vy_mem_tree_lower_bound(&fixture.mem->tree, &key, &exact);
+		if (!exact)
+			abort();
+		i = (i + 1) % stmt_count;
+		total_count++;
+	}
+	state.SetItemsProcessed(total_count);
+}
+
+BENCHMARK(bench_vy_mem_lookup)
+	->ArgNames({"str"})
+	->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+#include <vector>
+
+#include "vy_common.h"
+#include "vy_write_iterator.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * This suite contains benchmarks for the vinyl write iterator,
+ * which merges statements of multiple sources on dump and compaction
+ * in worker threads. The sources are mems filled with statements
+ * that have interleaving keys so that every merge step switches to
+ * another source.
+ */
+
+/** Total number of statements in all sources. */
+static constexpr size_t stmt_count = 1 << 18;
+/**
+ * A set of mems with unsigned or string keys. Key i is stored in
+ * mem i % mem_count.
+ */
+class VyWriteIteratorFixture {
+public:
+	VyWriteIteratorFixture(bool is_str, size_t mem_count)
+		: is_str(is_str)
+	{
+		env = VinylEnv::instance().mem_env();
+		uint32_t field = 0;
+		uint32_t type = is_str ? FIELD_TYPE_STRING :
+					 FIELD_TYPE_UNSIGNED;
+		key_def = box_key_def_new(&field, &type, 1);
+		format = vy_simple_stmt_format_new(
+			VinylEnv::instance().stmt_env(), &key_def, 1);
+		tuple_format_ref(format);
+		generation++;
+		for (size_t i = 0; i < mem_count; i++) {
+			struct vy_mem *mem = vy_mem_new(env, key_def, format,
+							generation, 0);
+			if (mem == NULL)
+				abort();
+			mems.push_back(mem);
+		}
+		for (size_t i = 0; i < stmt_count; i++) {
+			if (vy_mem_insert(mems[i % mem_count],
+					  new_stmt(i, i + 1)) != 0)
+				abort();
+		}
+		rlist_create(&read_views);
+	}
+	~VyWriteIteratorFixture()
+	{
+		for (struct vy_mem *mem : mems)
+			vy_mem_delete(mem);
+		lsregion_gc(&env->allocator, generation);
+		tuple_format_unref(format);
+		key_def_delete(key_def);
+	}
+	/** Merge all mems and return the number of merged statements. */
+	size_t merge()
+	{
+		struct vy_stmt_stream *wi = vy_write_iterator_new(
+			key_def, /*is_primary=*/true, /*is_last_level=*/true,
+			&read_views, /*handler=*/NULL);
+		if (wi == NULL)
+			abort();
+		for (struct vy_mem *mem : mems) {
+			if (vy_write_iterator_new_mem(wi, mem) != 0)
+				abort();
+		}
+		if (wi->iface->start(wi) != 0)
+			abort();
+		size_t count = 0;
+		struct vy_entry entry;
+		while (true) {
+			if (wi->iface->next(wi, &entry) != 0)
+				abort();
+			if (entry.stmt == NULL)
+				break;
+			count++;
+		}
+		wi->iface->stop(wi);
+		wi->iface->close(wi);
+		return count;
+	}
+private:
+	struct vy_entry new_stmt(uint64_t key, int64_t lsn)
+	{
+		return vy_perf_new_stmt(format, key_def, generation, is_str,
+					key, lsn);
+	}
+
+	bool is_str;
+	struct vy_mem_env *env;
+	struct key_def *key_def;
+	struct tuple_format *format;
+	std::vector<struct vy_mem *> mems;
+	struct rlist read_views;
+	int64_t generation = 0;
+};
+
+/** Merge of mem sources with the write iterator benchmark. */
+static void
+bench_vy_write_iterator_merge(benchmark::State &state)
+{
+	VyWriteIteratorFixture fixture(state.range(0) != 0, state.range(1));
+	size_t total_count = 0;
+	for (auto _ : state) {
+		size_t count = fixture.merge();
+		if (count != stmt_count)
+			abort();
+		total_count += count;
+	}
+	state.SetItemsProcessed(total_count);
+}
+
+static void
+bench_vy_write_iterator_merge_args(benchmark::internal::Benchmark *b)
+{
+	for (int is_str = 0; is_str <= 1; is_str++) {
+		for (int mem_count = 1; mem_count <= 32; mem_count *= 2)
+			b->Args({is_str, mem_count});
+	}
+}
+
+BENCHMARK(bench_vy_write_iterator_merge)
+	->ArgNames({"str", "sources"})
+	->Apply(bench_vy_write_iterator_merge_args);
+
+BENCHMARK_MAIN();
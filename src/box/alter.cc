@@ -225,7 +225,8 @@ index_opts_decode(struct index_opts *opts, const char *map,
 	}
 	if (opts->distance == rtree_index_distance_type_MAX) {
 		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
-			 "distance must be either 'euclid' or 'manhattan'");
+			 "distance must be one of 'euclid', 'manhattan', "
+			 "'cosine' or 'dot'");
 		return -1;
 	}
 	if (opts->page_size <= 0 || (opts->range_size > 0 &&
@@ -245,12 +246,23 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			 "run_size_ratio must be greater than 1");
 		return -1;
 	}
+	if (opts->compaction_strategy == index_compaction_strategy_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "compaction_strategy must be either 'leveled' "
+			 "or 'tiered'");
+		return -1;
+	}
 	if (opts->bloom_fpr <= 0 || opts->bloom_fpr > 1) {
 		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
 			 "bloom_fpr must be greater than 0 and "
 			 "less than or equal to 1");
 		return -1;
 	}
+	if (opts->bloom_type == index_bloom_type_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "bloom_type must be either 'bloom' or 'xor'");
+		return -1;
+	}
 	return 0;
 }
 
@@ -562,6 +574,20 @@ space_def_new_from_tuple(struct tuple *tuple, uint32_t errcode,
 			 "local space can't be synchronous");
 		return NULL;
 	}
+	if (opts.ttl_field != UINT32_MAX && opts.ttl_field < field_count) {
+		switch (fields[opts.ttl_field].type) {
+		case FIELD_TYPE_UNSIGNED:
+		case FIELD_TYPE_INTEGER:
+		case FIELD_TYPE_NUMBER:
+		case FIELD_TYPE_DOUBLE:
+			break;
+		default:
+			diag_set(ClientError, errcode,
+				 tt_cstr(name, name_len),
+				 "ttl_field must refer to a numeric field");
+			return NULL;
+		}
+	}
 	if (space_opts_is_temporary(&opts) && opts.constraint_count > 0) {
 		diag_set(ClientError, ER_UNSUPPORTED, "temporary space",
 			 "constraints");
@@ -4863,6 +4889,11 @@ sequence_def_new_from_tuple(struct tuple *tuple, uint32_t errcode)
 			 "start must be between min and max");
 		return NULL;
 	}
+	if (def->cache < 0) {
+		diag_set(ClientError, errcode, def->name,
+			 "cache must be non-negative");
+		return NULL;
+	}
 	def_guard.is_active = false;
 	return def;
 }
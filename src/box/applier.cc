@@ -1265,6 +1265,19 @@ applier_txn_wal_write_cb(struct trigger *trigger, void *event)
 	return 0;
 }
 
+/**
+ * Triggers installed on a transaction applied by applier. Allocated
+ * in one chunk to save allocations on the hot path.
+ */
+struct applier_txn_triggers {
+	/** Trigger run on transaction rollback. */
+	struct trigger on_rollback;
+	/** Trigger run once the transaction is written to WAL. */
+	struct trigger on_wal_write;
+	/** Data passed to the on_wal_write trigger. */
+	struct replica_cb_data rcb;
+};
+
 struct synchro_entry {
 	/** Request to process when WAL write is done. */
 	struct synchro_request *req;
@@ -1434,27 +1447,20 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 
 	if (use_triggers) {
 		/* We are ready to submit txn to wal. */
-		struct trigger *on_rollback, *on_wal_write;
+		struct applier_txn_triggers *triggers;
 		size_t size;
-		on_rollback = region_alloc_object(&txn->region, typeof(*on_rollback),
-						  &size);
-		on_wal_write = region_alloc_object(&txn->region, typeof(*on_wal_write),
-						   &size);
-		if (on_rollback == NULL || on_wal_write == NULL) {
+		triggers = region_alloc_object(&txn->region, typeof(*triggers),
+					       &size);
+		if (triggers == NULL) {
 			diag_set(OutOfMemory, size, "region_alloc_object",
-				 "on_rollback/on_wal_write");
-			goto fail;
-		}
-
-		struct replica_cb_data *rcb;
-		rcb = region_alloc_object(&txn->region, typeof(*rcb), &size);
-		if (rcb == NULL) {
-			diag_set(OutOfMemory, size, "region_alloc_object", "rcb");
+				 "triggers");
 			goto fail;
 		}
+		struct replica_cb_data *rcb = &triggers->rcb;
 
-		trigger_create(on_rollback, applier_txn_rollback_cb, NULL, NULL);
-		txn_on_rollback(txn, on_rollback);
+		trigger_create(&triggers->on_rollback, applier_txn_rollback_cb,
+			       NULL, NULL);
+		txn_on_rollback(txn, &triggers->on_rollback);
 
 		/*
 		 * We use *last* entry timestamp because ack comes up to
@@ -1467,8 +1473,9 @@ apply_plain_tx(uint32_t replica_id, struct stailq *rows,
 		rcb->replica_id = replica_id;
 		rcb->txn_last_tm = item->row.tm;
 
-		trigger_create(on_wal_write, applier_txn_wal_write_cb, rcb, NULL);
-		txn_on_wal_write(txn, on_wal_write);
+		trigger_create(&triggers->on_wal_write,
+			       applier_txn_wal_write_cb, rcb, NULL);
+		txn_on_wal_write(txn, &triggers->on_wal_write);
 	}
 
 	return txn_commit_try_async(txn);
@@ -116,6 +116,8 @@ static const struct space_vtab blackhole_space_vtab = {
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ generic_space_ephemeral_rowid_next,
+	/* .ephemeral_begin_build = */ generic_space_ephemeral_begin_build,
+	/* .ephemeral_end_build = */ generic_space_ephemeral_end_build,
 	/* .init_system_space = */ generic_init_system_space,
 	/* .init_ephemeral_space = */ generic_init_ephemeral_space,
 	/* .check_index_def = */ generic_space_check_index_def,
@@ -61,6 +61,7 @@
 #include "vinyl.h"
 #include "space.h"
 #include "index.h"
+#include "read_view.h"
 #include "result.h"
 #include "port.h"
 #include "txn.h"
@@ -77,11 +78,13 @@
 #include "security.h"
 #include "path_lock.h"
 #include "gc.h"
+#include "expiration.h"
 #include "sql.h"
 #include "systemd.h"
 #include "call.h"
 #include "crash.h"
 #include "func.h"
+#include "func_cache.h"
 #include "sequence.h"
 #include "sql_stmt_cache.h"
 #include "msgpack.h"
@@ -138,6 +141,12 @@ static bool backup_is_in_progress;
  */
 static struct gc_checkpoint_ref backup_gc;
 
+/**
+ * If incremental backup is in progress, this points to the gc
+ * consumer that pins the WAL files of the backup.
+ */
+static struct gc_consumer *backup_wal_gc;
+
 bool box_read_ffi_is_disabled;
 
 /**
@@ -235,6 +244,12 @@ static const char *box_recovery_state_strs[box_recovery_state_MAX] = {
 /** Whether the triggers for "synced" recovery stage have already run. */
 static bool recovery_state_synced_is_reached;
 
+/**
+ * How often a hot standby instance tries to take the WAL
+ * directory lock, in seconds.
+ */
+static const double HOT_STANDBY_LOCK_POLL_INTERVAL = 0.01;
+
 /** PATH_MAX is too big and 2K is recommended limit for web address. */
 #define BOX_FEEDBACK_HOST_MAX 2048
 
@@ -1610,6 +1625,30 @@ box_check_wal_queue_max_size(void)
 	return size;
 }
 
+static double
+box_check_wal_commit_delay(void)
+{
+	double value = cfg_getd("wal_commit_delay");
+	if (value < 0) {
+		diag_set(ClientError, ER_CFG, "wal_commit_delay",
+			 "value must be >= 0");
+		return -1;
+	}
+	return value;
+}
+
+static double
+box_check_snap_io_latency_target(void)
+{
+	double value = cfg_getd("snap_io_latency_target");
+	if (value < 0) {
+		diag_set(ClientError, ER_CFG, "snap_io_latency_target",
+			 "value must be >= 0");
+		return -1;
+	}
+	return value;
+}
+
 static double
 box_check_wal_cleanup_delay(void)
 {
@@ -1755,6 +1794,65 @@ box_check_small_alloc_options(void)
 			  " to 1024 * 16 and exponent of two");
 }
 
+static enum iproto_io_backend
+box_check_iproto_io_backend(void)
+{
+	const char *backend = cfg_gets("iproto_io_backend");
+	enum iproto_io_backend io_backend = STR2ENUM(iproto_io_backend,
+						     backend);
+	if (io_backend == iproto_io_backend_MAX) {
+		diag_set(ClientError, ER_CFG, "iproto_io_backend",
+			 "the value must be one of the following strings: "
+			 "'auto', 'epoll', 'io_uring'");
+		return IPROTO_IO_BACKEND_INVALID;
+	}
+	if (!iproto_io_backend_is_supported(io_backend)) {
+		diag_set(ClientError, ER_CFG, "iproto_io_backend",
+			 tt_sprintf("%s is not supported by the system",
+				    backend));
+		return IPROTO_IO_BACKEND_INVALID;
+	}
+	return io_backend;
+}
+
+/**
+ * Check the cpu_affinity option and, if @a apply is set, bind
+ * the threads to the CPUs. The option is a list of thread names
+ * or name prefixes with CPU lists separated by semicolons, like
+ * "tx=0-7;wal=8;iproto=9-11", where tx stands for the main thread.
+ */
+static int
+box_check_cpu_affinity(bool apply)
+{
+	const char *str = cfg_gets("cpu_affinity");
+	if (str == NULL)
+		return 0;
+	const char *p = str;
+	while (*p != '\0') {
+		size_t len = strcspn(p, ";");
+		const char *eq = (const char *)memchr(p, '=', len);
+		if (eq == NULL || eq == p || eq - p >= FIBER_NAME_MAX) {
+			diag_set(ClientError, ER_CFG, "cpu_affinity",
+				 "expected thread=cpus");
+			return -1;
+		}
+		const char *name = tt_cstr(p, eq - p);
+		if (strcmp(name, "tx") == 0)
+			name = cord_name(cord());
+		const char *cpus = tt_cstr(eq + 1, p + len - eq - 1);
+		if ((apply ? cord_set_affinity(name, cpus) :
+			     cord_check_affinity(cpus)) != 0) {
+			diag_set(ClientError, ER_CFG, "cpu_affinity",
+				 diag_last_error(diag_get())->errmsg);
+			return -1;
+		}
+		p += len;
+		if (*p == ';')
+			p++;
+	}
+	return 0;
+}
+
 static int
 box_check_iproto_options(void)
 {
@@ -1766,6 +1864,8 @@ box_check_iproto_options(void)
 				     IPROTO_THREADS_MAX));
 		return -1;
 	}
+	if (box_check_iproto_io_backend() == IPROTO_IO_BACKEND_INVALID)
+		return -1;
 	return 0;
 }
 
@@ -1781,6 +1881,17 @@ box_check_txn_timeout(void)
 	return timeout;
 }
 
+static int
+box_check_expiration_rate(void)
+{
+	if (cfg_getd("expiration_rate") < 0) {
+		diag_set(ClientError, ER_CFG, "expiration_rate",
+			 "the value must be greater than or equal to 0");
+		return -1;
+	}
+	return 0;
+}
+
 /**
  * Get and check isolation level from config, converting number or string to
  * enum txn_isolation_level.
@@ -1911,6 +2022,10 @@ box_check_config(void)
 	box_check_wal_mode(cfg_gets("wal_mode"));
 	if (box_check_wal_queue_max_size() < 0)
 		diag_raise();
+	if (box_check_wal_commit_delay() < 0)
+		diag_raise();
+	if (box_check_snap_io_latency_target() < 0)
+		diag_raise();
 	if (box_check_wal_cleanup_delay() < 0)
 		diag_raise();
 	if (box_check_memory_quota("memtx_memory") < 0)
@@ -1922,10 +2037,14 @@ box_check_config(void)
 	box_check_vinyl_options();
 	if (box_check_iproto_options() != 0)
 		diag_raise();
+	if (box_check_cpu_affinity(false) != 0)
+		diag_raise();
 	if (box_check_sql_cache_size(cfg_geti("sql_cache_size")) != 0)
 		diag_raise();
 	if (box_check_txn_timeout() < 0)
 		diag_raise();
+	if (box_check_expiration_rate() != 0)
+		diag_raise();
 	if (box_check_txn_isolation() == txn_isolation_level_MAX)
 		diag_raise();
 	box_check_memtx_sort_threads();
@@ -2665,11 +2784,7 @@ box_wait_vclock_f(struct trigger *trigger, void *event)
 	return 0;
 }
 
-/**
- * Wait until this instance's vclock reaches @a vclock or @a deadline is
- * reached.
- */
-static int
+int
 box_wait_vclock(const struct vclock *vclock, double deadline)
 {
 	if (vclock_compare_ignore0(vclock, &replicaset.vclock) <= 0)
@@ -2702,17 +2817,26 @@ int
 box_wait_linearization_point(double timeout)
 {
 	double deadline = ev_monotonic_now(loop()) + timeout;
-	struct vclock confirmed_vclock;
-	vclock_create(&confirmed_vclock);
 	/*
-	 * First find out the vclock which might be confirmed on remote
-	 * instances.
+	 * A leader holding the lease already has every synchronous
+	 * transaction which might be confirmed, because all of them are
+	 * written either by this instance or by the previous limbo owners
+	 * before this instance was elected. No need to ask the replicas.
 	 */
-	if (box_collect_confirmed_vclock(&confirmed_vclock, deadline) != 0)
-		return -1;
-	/* Then wait until all the rows up to this vclock are received. */
-	if (box_wait_vclock(&confirmed_vclock, deadline) != 0)
-		return -1;
+	if (!box_raft_has_lease()) {
+		struct vclock confirmed_vclock;
+		vclock_create(&confirmed_vclock);
+		/*
+		 * First find out the vclock which might be confirmed on
+		 * remote instances.
+		 */
+		if (box_collect_confirmed_vclock(&confirmed_vclock,
+						 deadline) != 0)
+			return -1;
+		/* Then wait until the rows up to this vclock are received. */
+		if (box_wait_vclock(&confirmed_vclock, deadline) != 0)
+			return -1;
+	}
 	/*
 	 * Finally, wait until all the synchronous transactions, which should be
 	 * visible to this tx, become visible.
@@ -3064,6 +3188,26 @@ box_set_snap_io_rate_limit(void)
 			cfg_getd("snap_io_rate_limit"));
 }
 
+int
+box_set_snap_io_latency_target(void)
+{
+	double target = box_check_snap_io_latency_target();
+	if (target < 0)
+		return -1;
+	wal_set_io_latency_target(target);
+	return 0;
+}
+
+void
+box_set_memtx_snapshot_index_order(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snapshot_index_order(
+		memtx, cfg_getb("memtx_snapshot_index_order"));
+}
+
 void
 box_set_memtx_memory(void)
 {
@@ -3126,6 +3270,12 @@ box_set_checkpoint_wal_threshold(void)
 	wal_set_checkpoint_threshold(threshold);
 }
 
+void
+box_set_wal_compression_dictionary(void)
+{
+	wal_set_use_dictionary(cfg_getb("wal_compression_dictionary"));
+}
+
 int
 box_set_wal_queue_max_size(void)
 {
@@ -3136,6 +3286,16 @@ box_set_wal_queue_max_size(void)
 	return 0;
 }
 
+int
+box_set_wal_commit_delay(void)
+{
+	double delay = box_check_wal_commit_delay();
+	if (delay < 0)
+		return -1;
+	wal_set_commit_delay(delay);
+	return 0;
+}
+
 int
 box_set_wal_cleanup_delay(void)
 {
@@ -3181,6 +3341,14 @@ box_set_vinyl_cache(void)
 	vinyl_engine_set_cache(vinyl, cfg_geti64("vinyl_cache"));
 }
 
+void
+box_set_vinyl_page_cache(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_page_cache(vinyl, cfg_geti64("vinyl_page_cache"));
+}
+
 void
 box_set_vinyl_timeout(void)
 {
@@ -3454,6 +3622,15 @@ box_set_txn_timeout(void)
 	return 0;
 }
 
+int
+box_set_expiration_rate(void)
+{
+	if (box_check_expiration_rate() != 0)
+		return -1;
+	expiration_set_rate(cfg_getd("expiration_rate"));
+	return 0;
+}
+
 int
 box_set_txn_isolation(void)
 {
@@ -3590,14 +3767,281 @@ box_index_id_by_name(uint32_t space_id, const char *name, uint32_t len)
 	return result;
 }
 
-int
-box_process1(struct request *request, box_tuple_t **result)
+/** Native on_replace trigger set with box_space_on_replace(). */
+struct box_space_trigger {
+	/** Base class. */
+	struct trigger base;
+	/** Trigger function. */
+	box_space_on_replace_f handler;
+	/** Trigger function argument. */
+	void *arg;
+};
+
+static int
+box_space_trigger_f(struct trigger *base, void *event)
 {
-	if (box_check_slice() != 0)
-		return -1;
-	struct space *space = space_cache_find(request->space_id);
+	struct box_space_trigger *trigger = (struct box_space_trigger *)base;
+	struct txn_stmt *stmt = txn_current_stmt((struct txn *)event);
+	return trigger->handler(trigger->arg, stmt->old_tuple,
+				stmt->new_tuple);
+}
+
+static void
+box_space_trigger_destroy(struct trigger *base)
+{
+	TRASH(base);
+	free(base);
+}
+
+API_EXPORT int
+box_space_on_replace(uint32_t space_id, void *arg,
+		     box_space_on_replace_f new_handler,
+		     box_space_on_replace_f old_handler)
+{
+	struct space *space = space_cache_find(space_id);
 	if (space == NULL)
 		return -1;
+	if (old_handler == NULL) {
+		if (new_handler == NULL) {
+			diag_set(IllegalParams, "old_handler and new_handler "
+				 "cannot be NULL at the same time");
+			return -1;
+		}
+		struct box_space_trigger *trigger =
+			(struct box_space_trigger *)xmalloc(sizeof(*trigger));
+		trigger_create(&trigger->base, box_space_trigger_f, NULL,
+			       box_space_trigger_destroy);
+		trigger->handler = new_handler;
+		trigger->arg = arg;
+		trigger_add(&space->on_replace, &trigger->base);
+		return 0;
+	}
+	struct trigger *base;
+	rlist_foreach_entry(base, &space->on_replace, link) {
+		struct box_space_trigger *trigger =
+			(struct box_space_trigger *)base;
+		if (base->run != box_space_trigger_f ||
+		    trigger->handler != old_handler)
+			continue;
+		if (new_handler != NULL) {
+			trigger->handler = new_handler;
+			trigger->arg = arg;
+		} else {
+			trigger_clear(base);
+			box_space_trigger_destroy(base);
+		}
+		return 0;
+	}
+	diag_set(IllegalParams, "on_replace trigger not found");
+	return -1;
+}
+
+/** Read view opened with box_read_view_open(). */
+struct box_read_view {
+	/** Database read view. */
+	struct read_view base;
+	/**
+	 * List of iterators over this read view, linked by
+	 * box_read_view_iterator::in_read_view. The iterators are
+	 * invalidated when the read view is closed.
+	 */
+	struct rlist iterators;
+};
+
+/** Iterator over an index of a read view opened with box_read_view_open(). */
+struct box_read_view_iterator {
+	/**
+	 * Read view the iterator belongs to. Set to NULL when the iterator
+	 * is exhausted or the read view is closed.
+	 */
+	struct box_read_view *rv;
+	/** Link in box_read_view::iterators. */
+	struct rlist in_read_view;
+	/** Set if the iterator has returned all the tuples. */
+	bool is_exhausted;
+	/** Format of tuples returned by the iterator. */
+	struct tuple_format *format;
+	/** Index read view iterator. */
+	struct index_read_view_iterator base;
+};
+
+/**
+ * Only tree and hash indexes support read views so we skip the rest
+ * instead of failing to open a read view of a space that has an index
+ * of another type.
+ */
+static bool
+box_read_view_index_filter(struct space *space, struct index *index,
+			   void *arg)
+{
+	(void)space;
+	(void)arg;
+	return index->vtab->create_read_view != generic_index_create_read_view;
+}
+
+/** Releases the index read view iterator and unlinks it from the read view. */
+static void
+box_read_view_iterator_release(struct box_read_view_iterator *it)
+{
+	if (it->rv == NULL)
+		return;
+	rlist_del_entry(it, in_read_view);
+	index_read_view_iterator_destroy(&it->base);
+	it->rv = NULL;
+}
+
+API_EXPORT box_read_view_t *
+box_read_view_open(const char *name)
+{
+	struct box_read_view *rv = (struct box_read_view *)xmalloc(sizeof(*rv));
+	rlist_create(&rv->iterators);
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = name;
+	opts.filter_index = box_read_view_index_filter;
+	opts.enable_field_names = true;
+	if (read_view_open(&rv->base, &opts) != 0) {
+		free(rv);
+		return NULL;
+	}
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &rv->base) {
+		if (space_rv->format_data == NULL)
+			continue;
+		struct tuple_format *format = runtime_tuple_format_new(
+			space_rv->format_data, space_rv->format_data_len,
+			/*names_only=*/true);
+		if (format == NULL) {
+			box_read_view_close(rv);
+			return NULL;
+		}
+		tuple_format_ref(format);
+		space_rv->format = format;
+	}
+	return rv;
+}
+
+API_EXPORT void
+box_read_view_close(box_read_view_t *rv)
+{
+	struct box_read_view_iterator *it, *next_it;
+	rlist_foreach_entry_safe(it, &rv->iterators, in_read_view, next_it)
+		box_read_view_iterator_release(it);
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &rv->base) {
+		if (space_rv->format != NULL) {
+			tuple_format_unref(space_rv->format);
+			space_rv->format = NULL;
+		}
+	}
+	read_view_close(&rv->base);
+	free(rv);
+}
+
+API_EXPORT int
+box_read_view_iterator_all(box_read_view_t *rv, uint32_t space_id,
+			   uint32_t index_id,
+			   box_read_view_iterator_t **iterator)
+{
+	struct space_read_view *space_rv, *found = NULL;
+	read_view_foreach_space(space_rv, &rv->base) {
+		if (space_rv->id == space_id) {
+			found = space_rv;
+			break;
+		}
+	}
+	if (found == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_SPACE,
+			 tt_sprintf("%u", (unsigned)space_id));
+		return -1;
+	}
+	struct index_read_view *index_rv =
+		space_read_view_index(found, index_id);
+	if (index_rv == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_INDEX_ID, index_id,
+			 found->name);
+		return -1;
+	}
+	struct box_read_view_iterator *it =
+		(struct box_read_view_iterator *)xmalloc(sizeof(*it));
+	if (index_read_view_create_iterator(index_rv, ITER_ALL, NULL, 0,
+					    &it->base) != 0) {
+		free(it);
+		return -1;
+	}
+	it->rv = rv;
+	it->is_exhausted = false;
+	it->format = found->format != NULL ? found->format :
+		     tuple_format_runtime;
+	rlist_add_entry(&rv->iterators, it, in_read_view);
+	*iterator = it;
+	return 0;
+}
+
+API_EXPORT int
+box_read_view_iterator_next_raw(box_read_view_iterator_t *iterator,
+				const char **data, uint32_t *size)
+{
+	if (iterator->is_exhausted) {
+		*data = NULL;
+		*size = 0;
+		return 0;
+	}
+	if (iterator->rv == NULL) {
+		diag_set(IllegalParams, "read view is closed");
+		return -1;
+	}
+	struct read_view_tuple result;
+	if (index_read_view_iterator_next_raw(&iterator->base, &result) != 0)
+		return -1;
+	if (result.data == NULL) {
+		iterator->is_exhausted = true;
+		box_read_view_iterator_release(iterator);
+	}
+	*data = result.data;
+	*size = result.size;
+	return 0;
+}
+
+API_EXPORT void
+box_read_view_iterator_free(box_read_view_iterator_t *iterator)
+{
+	box_read_view_iterator_release(iterator);
+	TRASH(iterator);
+	free(iterator);
+}
+
+box_read_view_t *
+box_read_view_by_id(uint64_t id)
+{
+	struct read_view *rv = read_view_by_id(id);
+	if (rv == NULL || rv->is_system)
+		return NULL;
+	return container_of(rv, struct box_read_view, base);
+}
+
+struct read_view *
+box_read_view_base(box_read_view_t *rv)
+{
+	return &rv->base;
+}
+
+struct tuple_format *
+box_read_view_iterator_format(box_read_view_iterator_t *iterator)
+{
+	return iterator->format;
+}
+
+/**
+ * Find the space with the given id and check that it can be written
+ * to by a DML request. Returns NULL and sets diag on error.
+ */
+static struct space *
+box_dml_space_find(uint32_t space_id)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return NULL;
 	/*
 	 * Allow to write to data-temporary and local spaces in the read-only
 	 * mode. To handle space truncation and/or ddl operations on temporary
@@ -3613,7 +4057,7 @@ box_process1(struct request *request, box_tuple_t **result)
 	    !space_is_data_temporary(space) &&
 	    !space_is_local(space) &&
 	    box_check_writable() != 0)
-		return -1;
+		return NULL;
 	if (space_is_memtx(space)) {
 		/*
 		 * Due to on_init_schema triggers set on system spaces,
@@ -3629,13 +4073,107 @@ box_process1(struct request *request, box_tuple_t **result)
 				"box.ctl.is_recovery_finished() "
 				"to check that snapshot recovery was completed");
 			diag_log();
-			return -1;
+			return NULL;
 		}
 	}
+	return space;
+}
 
+int
+box_process1(struct request *request, box_tuple_t **result)
+{
+	if (box_check_slice() != 0)
+		return -1;
+	struct space *space = box_dml_space_find(request->space_id);
+	if (space == NULL)
+		return -1;
 	return box_process_rw(request, space, result);
 }
 
+/**
+ * Execute an INSERT or REPLACE request for each tuple of the batch
+ * in one transaction.
+ */
+static int
+box_process_batch(uint16_t type, uint32_t space_id, const char *tuples,
+		  const char *tuples_end)
+{
+	assert(type == IPROTO_INSERT || type == IPROTO_REPLACE);
+	if (box_check_slice() != 0)
+		return -1;
+	struct space *space = box_dml_space_find(space_id);
+	if (space == NULL)
+		return -1;
+	if (mp_typeof(*tuples) != MP_ARRAY) {
+		diag_set(IllegalParams, "tuples must be an array");
+		return -1;
+	}
+	uint32_t count = mp_decode_array(&tuples);
+	if (count == 0)
+		return 0;
+	struct txn *txn = in_txn();
+	bool is_autocommit = txn == NULL;
+	struct txn_savepoint *svp = NULL;
+	if (is_autocommit) {
+		if ((txn = txn_begin()) == NULL)
+			return -1;
+	} else if ((svp = txn_savepoint_new(txn, NULL)) == NULL) {
+		return -1;
+	}
+	rmean_collect(rmean_box, type, count);
+	if (access_check_space(space, PRIV_W) != 0)
+		goto rollback;
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = type;
+	request.space_id = space_id;
+	for (uint32_t i = 0; i < count; i++) {
+		if (mp_typeof(*tuples) != MP_ARRAY) {
+			diag_set(IllegalParams, "tuple must be an array");
+			goto rollback;
+		}
+		request.tuple = tuples;
+		mp_next(&tuples);
+		request.tuple_end = tuples;
+		struct tuple *unused;
+		if (txn_begin_stmt(txn, space, type) != 0)
+			goto rollback;
+		if (space_execute_dml(space, txn, &request, &unused) != 0) {
+			txn_rollback_stmt(txn);
+			goto rollback;
+		}
+		if (txn_commit_stmt(txn, &request) != 0)
+			goto rollback;
+	}
+	if (is_autocommit)
+		return txn_commit(txn) < 0 ? -1 : 0;
+	txn_savepoint_release(svp);
+	return 0;
+rollback:
+	if (is_autocommit) {
+		txn_abort(txn);
+	} else if (box_txn_rollback_to_savepoint(svp) != 0) {
+		diag_log();
+		unreachable();
+	}
+	return -1;
+}
+
+int
+box_insert_batch(uint32_t space_id, const char *tuples,
+		 const char *tuples_end)
+{
+	return box_process_batch(IPROTO_INSERT, space_id, tuples, tuples_end);
+}
+
+int
+box_replace_batch(uint32_t space_id, const char *tuples,
+		  const char *tuples_end)
+{
+	return box_process_batch(IPROTO_REPLACE, space_id, tuples,
+				 tuples_end);
+}
+
 void
 box_iterator_position_pack(const char *pos, const char *pos_end,
 			   uint32_t found, const char **packed_pos,
@@ -3728,6 +4266,7 @@ box_select(uint32_t space_id, uint32_t index_id,
 		return -1;
 
 	box_run_on_select(space, index, type, key_array);
+	index->lookup_count.select++;
 
 	ERROR_INJECT(ERRINJ_TESTING, {
 		diag_set(ClientError, ER_INJECTION, "ERRINJ_TESTING");
@@ -3999,6 +4538,30 @@ sequence_data_delete(uint32_t seq_id)
 	return rc;
 }
 
+/** Trigger reserving sequence values on commit. */
+struct sequence_reserve_trigger {
+	struct trigger base;
+	/** Sequence id. */
+	uint32_t seq_id;
+	/** Last reserved value. */
+	int64_t reserved;
+};
+
+/**
+ * Let box_sequence_next() generate the values reserved by a value
+ * written to _sequence_data once the value is persisted.
+ */
+static int
+on_sequence_reserve_commit(struct trigger *trigger, void * /* event */)
+{
+	struct sequence_reserve_trigger *t =
+		(struct sequence_reserve_trigger *)trigger;
+	struct sequence *seq = sequence_by_id(t->seq_id);
+	if (seq != NULL)
+		sequence_reserve_commit(seq, t->reserved);
+	return 0;
+}
+
 API_EXPORT int
 box_sequence_next(uint32_t seq_id, int64_t *result)
 {
@@ -4010,7 +4573,42 @@ box_sequence_next(uint32_t seq_id, int64_t *result)
 	int64_t value;
 	if (sequence_next(seq, &value) != 0)
 		return -1;
-	if (sequence_data_update(seq_id, value) != 0)
+	int64_t reserved;
+	if (sequence_next_is_reserved(seq, value, &reserved)) {
+		*result = value;
+		return 0;
+	}
+	/*
+	 * Use a transaction to restore the sequence value before
+	 * the write yields and to reserve the values on commit.
+	 */
+	bool is_autocommit = in_txn() == NULL;
+	if (is_autocommit && box_txn_begin() != 0)
+		return -1;
+	if (sequence_data_update(seq_id, reserved) != 0) {
+		if (is_autocommit)
+			box_txn_rollback();
+		return -1;
+	}
+	/* Restore the value set by the _sequence_data trigger. */
+	sequence_reserve(seq, value, reserved);
+	/*
+	 * Don't generate the reserved values until the reservation
+	 * is persisted, otherwise they could be generated again
+	 * after restart.
+	 */
+	if (reserved != value) {
+		struct txn *txn = in_txn();
+		struct sequence_reserve_trigger *on_commit =
+			xregion_alloc_object(&txn->region,
+					     struct sequence_reserve_trigger);
+		trigger_create(&on_commit->base, on_sequence_reserve_commit,
+			       NULL, NULL);
+		on_commit->seq_id = seq_id;
+		on_commit->reserved = reserved;
+		txn_on_commit(txn, &on_commit->base);
+	}
+	if (is_autocommit && box_txn_commit() != 0)
 		return -1;
 	*result = value;
 	return 0;
@@ -4767,6 +5365,8 @@ engine_init()
 				    cfg_getd("slab_alloc_factor"),
 				    cfg_geti("memtx_sort_threads"),
 				    box_on_indexes_built);
+	if (cfg_geti("memtx_use_hugepages"))
+		memtx_engine_use_hugepages(memtx);
 	engine_register((struct engine *)memtx);
 	box_set_memtx_max_tuple_size();
 
@@ -4788,6 +5388,7 @@ engine_init()
 	engine_register((struct engine *)vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
+	box_set_vinyl_page_cache();
 	box_set_vinyl_timeout();
 }
 
@@ -5229,7 +5830,11 @@ local_recovery(const struct vclock *checkpoint_vclock)
 				diag_raise();
 			if (wal_dir_lock >= 0)
 				break;
-			fiber_sleep(0.1);
+			/*
+			 * Poll often: it's a couple of cheap syscalls,
+			 * while the interval bounds the failover time.
+			 */
+			fiber_sleep(HOT_STANDBY_LOCK_POLL_INTERVAL);
 		}
 		recovery_stop_local(recovery);
 		recover_remaining_wals(recovery, &wal_stream.base, NULL, true);
@@ -5468,6 +6073,7 @@ box_cfg_xc(void)
 
 	is_box_configured = true;
 	box_broadcast_ballot();
+	expiration_init();
 	/*
 	 * Fill in leader election parameters after bootstrap. Before it is not
 	 * possible - there may be relevant data to recover from WAL and
@@ -5567,8 +6173,66 @@ box_checkpoint(void)
 	return gc_checkpoint();
 }
 
+/**
+ * Calls @cb for each WAL file that contains rows written after
+ * the checkpoint with signature @since and before the checkpoint
+ * with @vclock and pins the files with backup_wal_gc.
+ */
+static int
+box_backup_wal(int64_t since, const struct vclock *vclock,
+	       box_backup_cb cb, void *cb_arg)
+{
+	if (wal_mode() == WAL_NONE) {
+		diag_set(ClientError, ER_INCREMENTAL_BACKUP,
+			 "wal_mode is 'none'");
+		return -1;
+	}
+	int64_t signature = vclock_sum(vclock);
+	if (since > signature) {
+		diag_set(ClientError, ER_INCREMENTAL_BACKUP,
+			 "the token is newer than the checkpoint");
+		return -1;
+	}
+	int rc = -1;
+	struct vclock *first = NULL;
+	struct xdir dir;
+	xdir_create(&dir, wal_dir(), XLOG, &INSTANCE_UUID,
+		    &xlog_opts_default);
+	if (xdir_scan(&dir, true) != 0)
+		goto out;
+	/* Find the WAL file that contains the row following @since. */
+	for (struct vclock *v = vclockset_first(&dir.index);
+	     v != NULL && vclock_sum(v) <= since;
+	     v = vclockset_next(&dir.index, v))
+		first = v;
+	if (first == NULL || vclock_sum(&gc.vclock) > vclock_sum(first)) {
+		diag_set(ClientError, ER_INCREMENTAL_BACKUP,
+			 "WAL files written after the token were removed");
+		goto out;
+	}
+	assert(backup_wal_gc == NULL);
+	backup_wal_gc = gc_consumer_register(first, "backup");
+	if (backup_wal_gc == NULL)
+		goto out;
+	for (struct vclock *v = first; v != NULL && vclock_sum(v) < signature;
+	     v = vclockset_next(&dir.index, v)) {
+		const char *path = xdir_format_filename(&dir, vclock_sum(v),
+							NONE);
+		if (cb(path, cb_arg) != 0) {
+			gc_consumer_unregister(backup_wal_gc);
+			backup_wal_gc = NULL;
+			goto out;
+		}
+	}
+	rc = 0;
+out:
+	xdir_destroy(&dir);
+	return rc;
+}
+
 int
-box_backup_start(int checkpoint_idx, box_backup_cb cb, void *cb_arg)
+box_backup_start(int checkpoint_idx, int64_t since,
+		 box_backup_cb cb, void *cb_arg)
 {
 	assert(checkpoint_idx >= 0);
 	if (backup_is_in_progress) {
@@ -5586,7 +6250,11 @@ box_backup_start(int checkpoint_idx, box_backup_cb cb, void *cb_arg)
 	}
 	backup_is_in_progress = true;
 	gc_ref_checkpoint(checkpoint, &backup_gc, "backup");
-	int rc = engine_backup(&checkpoint->vclock, cb, cb_arg);
+	int rc;
+	if (since >= 0)
+		rc = box_backup_wal(since, &checkpoint->vclock, cb, cb_arg);
+	else
+		rc = engine_backup(&checkpoint->vclock, cb, cb_arg);
 	if (rc != 0) {
 		gc_unref_checkpoint(&backup_gc);
 		backup_is_in_progress = false;
@@ -5599,6 +6267,10 @@ box_backup_stop(void)
 {
 	if (backup_is_in_progress) {
 		gc_unref_checkpoint(&backup_gc);
+		if (backup_wal_gc != NULL) {
+			gc_consumer_unregister(backup_wal_gc);
+			backup_wal_gc = NULL;
+		}
 		backup_is_in_progress = false;
 	}
 }
@@ -5613,8 +6285,20 @@ static int
 box_reset_space_stat(struct space *space, void *arg)
 {
 	(void)arg;
-	for (uint32_t i = 0; i < space->index_count; i++)
-		index_reset_stat(space->index[i]);
+	memset(&space->dml_count, 0, sizeof(space->dml_count));
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		memset(&index->lookup_count, 0, sizeof(index->lookup_count));
+		index_reset_stat(index);
+	}
+	return 0;
+}
+
+static int
+box_reset_func_stat(struct func *func, void *arg)
+{
+	(void)arg;
+	func->call_count = 0;
 	return 0;
 }
 
@@ -5625,6 +6309,7 @@ box_reset_stat(void)
 	rmean_cleanup(rmean_error);
 	engine_reset_stat();
 	space_foreach(box_reset_space_stat, NULL);
+	func_foreach(box_reset_func_stat, NULL);
 }
 
 static void
@@ -5824,10 +6509,17 @@ static void
 box_storage_init(void)
 {
 	assert(!is_storage_initialized);
+	/*
+	 * Bind the threads before they are started and the memtx
+	 * arena is touched, so that the memory is local to tx.
+	 */
+	if (box_check_cpu_affinity(true) != 0)
+		diag_raise();
 	/* Join the cord interconnect as "tx" endpoint. */
 	fiber_pool_create(&tx_fiber_pool, "tx",
 			  IPROTO_MSG_MAX_MIN * IPROTO_FIBER_POOL_SIZE_FACTOR,
 			  FIBER_POOL_IDLE_TIMEOUT);
+	cbus_endpoint_enable_busy_poll(&tx_fiber_pool.endpoint);
 	/* Add an extra endpoint for WAL wake up/rollback messages. */
 	cbus_endpoint_create(&tx_prio_endpoint, "tx_prio", tx_prio_cb,
 			     &tx_prio_endpoint);
@@ -5840,7 +6532,7 @@ box_storage_init(void)
 	schema_init();
 	replication_init(cfg_geti_default("replication_threads", 1));
 	port_init();
-	iproto_init(cfg_geti("iproto_threads"));
+	iproto_init(cfg_geti("iproto_threads"), box_check_iproto_io_backend());
 	sql_init();
 	audit_log_init();
 	security_cfg();
@@ -5920,6 +6612,7 @@ box_free(void)
 	auth_free();
 	wal_ext_free();
 	box_watcher_free();
+	expiration_free();
 	box_raft_free();
 	sequence_free();
 	event_unref(box_on_recovery_state_event);
@@ -54,6 +54,8 @@ struct space;
 struct vclock;
 struct key_def;
 struct ballot;
+struct read_view;
+struct tuple_format;
 
 /**
  * Pointer to TX thread local vclock.
@@ -234,11 +236,18 @@ typedef int (*box_backup_cb)(const char *path, void *arg);
  * is 0, the last checkpoint will be backed up; if it is 1, next
  * to last, and so on.
  *
+ * If @since is not negative, the backup is incremental: @since is
+ * the signature of the checkpoint of a previous backup and @cb is
+ * called only for the WAL files that are needed to roll that
+ * checkpoint forward to the specified one. The files are pinned
+ * until the backup is stopped.
+ *
  * The caller is supposed to call box_backup_stop() after he's
  * done copying the files.
  */
 int
-box_backup_start(int checkpoint_idx, box_backup_cb cb, void *cb_arg);
+box_backup_start(int checkpoint_idx, int64_t since,
+		 box_backup_cb cb, void *cb_arg);
 
 /**
  * Finish backup started with box_backup_start().
@@ -311,18 +320,23 @@ int box_listen(void);
 void box_set_replication(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+int box_set_snap_io_latency_target(void);
+void box_set_memtx_snapshot_index_order(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_checkpoint_count(void);
 void box_set_checkpoint_interval(void);
 void box_set_checkpoint_wal_threshold(void);
 int box_set_wal_queue_max_size(void);
+void box_set_wal_compression_dictionary(void);
+int box_set_wal_commit_delay(void);
 int box_set_wal_cleanup_delay(void);
 void box_set_memtx_memory(void);
 void box_set_memtx_max_tuple_size(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
+void box_set_vinyl_page_cache(void);
 void box_set_vinyl_timeout(void);
 void box_set_force_recovery(void);
 int box_set_election_mode(void);
@@ -345,6 +359,7 @@ void box_set_net_msg_max(void);
 int box_set_prepared_stmt_cache_size(void);
 int box_set_feedback(void);
 int box_set_txn_timeout(void);
+int box_set_expiration_rate(void);
 int box_set_txn_isolation(void);
 int box_set_auth_type(void);
 int box_set_bootstrap_strategy(void);
@@ -380,6 +395,13 @@ box_promote_qsync(void);
 int
 box_wait_linearization_point(double timeout);
 
+/**
+ * Wait until this instance's vclock reaches @a vclock or @a deadline is
+ * reached. Component 0 of @a vclock is ignored.
+ */
+int
+box_wait_vclock(const struct vclock *vclock, double deadline);
+
 /**
  * Allocates memory on region and packs iterator position there.
  * Packed position is returned with packed_pos and packed_pos_end arguments.
@@ -532,6 +554,114 @@ box_space_id_by_name(const char *name, uint32_t len);
 API_EXPORT uint32_t
 box_index_id_by_name(uint32_t space_id, const char *name, uint32_t len);
 
+/**
+ * Native on_replace trigger function. Invoked after a statement changes
+ * a space, in the same transaction, exactly like a Lua on_replace trigger,
+ * but without entering Lua.
+ *
+ * \param arg argument passed to box_space_on_replace()
+ * \param old_tuple tuple replaced or deleted by the statement or NULL
+ * \param new_tuple tuple inserted by the statement or NULL
+ * \retval 0 on success
+ * \retval -1 on error, the statement is rolled back (set box_error_last())
+ */
+typedef int
+(*box_space_on_replace_f)(void *arg, box_tuple_t *old_tuple,
+			  box_tuple_t *new_tuple);
+
+/**
+ * Sets, replaces, or deletes a native on_replace trigger of a space.
+ *
+ * If \a old_handler is NULL, a new trigger calling \a new_handler with
+ * \a arg is added. Otherwise the trigger calling \a old_handler is looked
+ * up and either updated to call \a new_handler with \a arg or deleted if
+ * \a new_handler is NULL.
+ *
+ * The trigger is kept on space alter and is deleted when the space is
+ * dropped. Like internal triggers, it also runs during recovery. It must
+ * not delete itself.
+ *
+ * \param space_id space identifier
+ * \param arg trigger function argument
+ * \param new_handler new trigger function
+ * \param old_handler old trigger function
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \sa \code box.space[space_id]:on_replace(new, old) \endcode
+ */
+API_EXPORT int
+box_space_on_replace(uint32_t space_id, void *arg,
+		     box_space_on_replace_f new_handler,
+		     box_space_on_replace_f old_handler);
+
+/** Read view of memtx spaces opened with box_read_view_open(). */
+typedef struct box_read_view box_read_view_t;
+
+/** Iterator over an index of a read view. */
+typedef struct box_read_view_iterator box_read_view_iterator_t;
+
+/**
+ * Opens a read view of all memtx spaces. Changes done to the database
+ * after the read view was opened aren't visible from it.
+ *
+ * The read view is listed by box.read_view.list() but can't be closed
+ * from Lua. It must be closed with box_read_view_close().
+ *
+ * \param name read view name, used for introspection
+ * \retval NULL on error (check box_error_last())
+ * \retval read view otherwise
+ */
+API_EXPORT box_read_view_t *
+box_read_view_open(const char *name);
+
+/**
+ * Closes a read view. Iterators created over the read view are
+ * invalidated: they fail on the next step and must still be freed
+ * with box_read_view_iterator_free().
+ *
+ * \param rv read view
+ */
+API_EXPORT void
+box_read_view_close(box_read_view_t *rv);
+
+/**
+ * Creates an iterator over all tuples stored in an index of a read view.
+ * Only full scans are supported.
+ *
+ * \param rv read view
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param[out] iterator new iterator
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_read_view_iterator_all(box_read_view_t *rv, uint32_t space_id,
+			   uint32_t index_id,
+			   box_read_view_iterator_t **iterator);
+
+/**
+ * Takes an iterator step. Returns the raw MsgPack data of the next tuple.
+ * The data may be allocated on the fiber region.
+ *
+ * \param iterator read view iterator
+ * \param[out] data tuple data or NULL if the iterator is exhausted
+ * \param[out] size size of the tuple data
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_read_view_iterator_next_raw(box_read_view_iterator_t *iterator,
+				const char **data, uint32_t *size);
+
+/**
+ * Frees a read view iterator.
+ *
+ * \param iterator read view iterator
+ */
+API_EXPORT void
+box_read_view_iterator_free(box_read_view_iterator_t *iterator);
+
 /**
  * Execute an INSERT request.
  *
@@ -741,6 +871,21 @@ box_iproto_override(uint32_t req_type, iproto_handler_t handler,
 
 /** \endcond public */
 
+/**
+ * Returns a read view opened with box_read_view_open() by the id of its
+ * database read view or NULL if there's no such read view.
+ */
+box_read_view_t *
+box_read_view_by_id(uint64_t id);
+
+/** Returns the database read view of a box read view. */
+struct read_view *
+box_read_view_base(box_read_view_t *rv);
+
+/** Returns the format of tuples returned by a read view iterator. */
+struct tuple_format *
+box_read_view_iterator_format(box_read_view_iterator_t *iterator);
+
 /**
  * Used to be entry point to the
  * Box: callbacks into the request processor.
@@ -753,6 +898,32 @@ box_iproto_override(uint32_t req_type, iproto_handler_t handler,
 int
 box_process1(struct request *request, box_tuple_t **result);
 
+/**
+ * Insert a batch of tuples into a space in one transaction. It's faster
+ * than calling box_insert() for each tuple, because the space lookup,
+ * access checks and the transaction are shared by the whole batch. If
+ * called in a transaction, the batch is applied there. On error no
+ * tuple of the batch is inserted.
+ *
+ * \param space_id space identifier
+ * \param tuples encoded tuples in MsgPack Array format
+ *        ([[field1, field2, ...], ...]).
+ * \param tuples_end the end of encoded \a tuples
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+int
+box_insert_batch(uint32_t space_id, const char *tuples,
+		 const char *tuples_end);
+
+/**
+ * Replace a batch of tuples in a space in one transaction.
+ * \sa box_insert_batch()
+ */
+int
+box_replace_batch(uint32_t space_id, const char *tuples,
+		  const char *tuples_end);
+
 /**
  * Execute request on given space.
  *
@@ -329,6 +329,10 @@ struct errcode_record {
 	/*274 */_(ER_UNCONFIGURED,		"Please call box.cfg{} first") \
 	/*275 */_(ER_CREATE_DEFAULT_FUNC,	"Failed to create field default function '%s': %s") \
 	/*276 */_(ER_DEFAULT_FUNC_FAILED,	"Error calling field default function '%s': %s") \
+	/*277 */_(ER_HNSW_VECTOR,		"HNSW: %s must be an array of %u numbers") \
+	/*278 */_(ER_TUPLE_NOT_TAKEN,		"Tuple is not taken from space '%s'") \
+	/*279 */_(ER_INCREMENTAL_BACKUP,	"Can't make incremental backup: %s") \
+	/*280 */_(ER_CSV_IMPORT,		"Failed to import CSV at line %llu: %s") \
 
 /*
  * !IMPORTANT! Please follow instructions at start of the file
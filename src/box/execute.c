@@ -223,6 +223,37 @@ sql_execute(struct Vdbe *stmt, struct port *port, struct region *region)
 	return 0;
 }
 
+/**
+ * Execute a statement stored in the prepared statement or plan
+ * cache. The statement is reset after execution so that it can be
+ * reused.
+ */
+static int
+sql_execute_cached(struct Vdbe *stmt, const struct sql_bind *bind,
+		   uint32_t bind_count, struct port *port,
+		   struct region *region)
+{
+	assert(!sql_stmt_busy(stmt));
+	/*
+	 * Clear all set from previous execution cycle values to be bound and
+	 * remove autoincrement IDs generated in that cycle.
+	 */
+	sql_unbind(stmt);
+	if (sql_bind(stmt, bind, bind_count) != 0)
+		return -1;
+	sql_reset_autoinc_id_list(stmt);
+	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
+					       DQL_EXECUTE : DML_EXECUTE;
+	port_sql_create(port, stmt, format, false);
+	if (sql_execute(stmt, port, region) != 0) {
+		port_destroy(port);
+		sql_stmt_reset(stmt);
+		return -1;
+	}
+	sql_stmt_reset(stmt);
+	return 0;
+}
+
 int
 sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 		     uint32_t bind_count, struct port *port,
@@ -244,25 +275,7 @@ sql_execute_prepared(uint32_t stmt_id, const struct sql_bind *bind,
 		return sql_prepare_and_execute(sql_str, strlen(sql_str), bind,
 					       bind_count, port, region);
 	}
-	/*
-	 * Clear all set from previous execution cycle values to be bound and
-	 * remove autoincrement IDs generated in that cycle.
-	 */
-	sql_unbind(stmt);
-	if (sql_bind(stmt, bind, bind_count) != 0)
-		return -1;
-	sql_reset_autoinc_id_list(stmt);
-	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
-					       DQL_EXECUTE : DML_EXECUTE;
-	port_sql_create(port, stmt, format, false);
-	if (sql_execute(stmt, port, region) != 0) {
-		port_destroy(port);
-		sql_stmt_reset(stmt);
-		return -1;
-	}
-	sql_stmt_reset(stmt);
-
-	return 0;
+	return sql_execute_cached(stmt, bind, bind_count, port, region);
 }
 
 int
@@ -270,10 +283,19 @@ sql_prepare_and_execute(const char *sql, int len, const struct sql_bind *bind,
 			uint32_t bind_count, struct port *port,
 			struct region *region)
 {
-	struct Vdbe *stmt;
+	/*
+	 * Reuse the statement compiled for the same string by
+	 * a previous execution, if any, to skip parsing and query
+	 * planning.
+	 */
+	struct Vdbe *stmt = sql_plan_cache_find(sql, len);
+	if (stmt != NULL)
+		return sql_execute_cached(stmt, bind, bind_count, port, region);
 	if (sql_stmt_compile(sql, len, NULL, &stmt, NULL) != 0)
 		return -1;
 	assert(stmt != NULL);
+	if (sql_plan_cache_insert(stmt) == 0)
+		return sql_execute_cached(stmt, bind, bind_count, port, region);
 	enum sql_serialization_format format = sql_column_count(stmt) > 0 ?
 					   DQL_EXECUTE : DML_EXECUTE;
 	port_sql_create(port, stmt, format, true);
@@ -0,0 +1,261 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "expiration.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "box.h"
+#include "diag.h"
+#include "fiber.h"
+#include "index.h"
+#include "msgpuck.h"
+#include "on_shutdown.h"
+#include "say.h"
+#include "space.h"
+#include "space_cache.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "txn.h"
+
+enum {
+	/** Max number of tuples deleted in one transaction. */
+	EXPIRATION_BATCH_SIZE = 1000,
+};
+
+/** Interval between scans of all spaces, in seconds. */
+static const double EXPIRATION_PERIOD = 1;
+
+struct expiration_stat expiration_stat;
+
+/** Max number of tuples deleted per second, 0 means unlimited. */
+static double expiration_rate;
+
+/** Fiber deleting expired tuples, NULL if not running. */
+static struct fiber *expiration_fiber;
+
+void
+expiration_set_rate(double rate)
+{
+	assert(rate >= 0);
+	expiration_rate = rate;
+}
+
+/**
+ * Return a TREE index of the space whose first part is the ttl_field
+ * or NULL if there's no such index.
+ */
+static struct index *
+expiration_find_index(struct space *space)
+{
+	uint32_t fieldno = space->def->opts.ttl_field;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		struct key_part *part = &index->def->key_def->parts[0];
+		if (index->def->type != TREE || part->fieldno != fieldno ||
+		    part->path != NULL || part->sort_order == SORT_ORDER_DESC)
+			continue;
+		switch (part->type) {
+		case FIELD_TYPE_UNSIGNED:
+		case FIELD_TYPE_INTEGER:
+		case FIELD_TYPE_NUMBER:
+		case FIELD_TYPE_DOUBLE:
+			return index;
+		default:
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Delete up to limit expired tuples of the space in one transaction.
+ * Return the number of deleted tuples or -1 on error.
+ */
+static int
+expiration_space_batch(struct space *space, struct index *index, int limit)
+{
+	uint32_t space_id = space->def->id;
+	uint32_t index_id = index->def->iid;
+	uint32_t fieldno = space->def->opts.ttl_field;
+	/* Nulls precede numbers and never expire, skip them. */
+	bool is_nullable = index->def->key_def->parts[0].is_nullable;
+	const char *key = is_nullable ? "\x91\xc0" : "\x90";
+	const char *key_end = key + (is_nullable ? 2 : 1);
+	int type = is_nullable ? ITER_GT : ITER_GE;
+	double now = fiber_time();
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char **keys = xregion_alloc_array(region, const char *, limit);
+	int count = 0;
+	if (box_txn_begin() != 0)
+		return -1;
+	box_iterator_t *it = box_index_iterator(space_id, index_id, type,
+						key, key_end);
+	if (it == NULL)
+		goto fail;
+	while (count < limit) {
+		box_tuple_t *tuple;
+		if (box_iterator_next(it, &tuple) != 0) {
+			box_iterator_free(it);
+			goto fail;
+		}
+		if (tuple == NULL)
+			break;
+		const char *field = tuple_field(tuple, fieldno);
+		double expires_at;
+		if (field == NULL || mp_read_double(&field, &expires_at) != 0 ||
+		    expires_at > now)
+			break;
+		keys[count] = box_tuple_extract_key(tuple, space_id, 0, NULL);
+		if (keys[count] == NULL) {
+			box_iterator_free(it);
+			goto fail;
+		}
+		count++;
+	}
+	box_iterator_free(it);
+	for (int i = 0; i < count; i++) {
+		const char *end = keys[i];
+		mp_next(&end);
+		if (box_delete(space_id, 0, keys[i], end, NULL) != 0)
+			goto fail;
+	}
+	if (box_txn_commit() != 0)
+		goto fail;
+	region_truncate(region, region_svp);
+	expiration_stat.expired += count;
+	expiration_stat.batches++;
+	return count;
+fail:
+	box_txn_rollback();
+	region_truncate(region, region_svp);
+	return -1;
+}
+
+/** Delete all expired tuples of the space with the given id. */
+static void
+expiration_space(uint32_t space_id)
+{
+	while (!fiber_is_cancelled() && !box_is_ro()) {
+		/* The space may be altered or dropped while we sleep. */
+		struct space *space = space_by_id(space_id);
+		if (space == NULL ||
+		    space->def->opts.ttl_field == UINT32_MAX)
+			return;
+		struct index *index = expiration_find_index(space);
+		if (index == NULL)
+			return;
+		int limit = EXPIRATION_BATCH_SIZE;
+		double rate = expiration_rate;
+		if (rate > 0 && rate < limit)
+			limit = MAX((int)rate, 1);
+		int count = expiration_space_batch(space, index, limit);
+		if (count < 0) {
+			say_error("failed to expire tuples of space '%s'",
+				  space_name(space));
+			diag_log();
+			return;
+		}
+		if (count > 0 && rate > 0)
+			fiber_sleep(count / rate);
+		if (count < limit)
+			return;
+	}
+}
+
+/** Array of ids of spaces with the ttl_field option set. */
+struct expiration_space_ids {
+	uint32_t *ids;
+	uint32_t count;
+	uint32_t capacity;
+};
+
+static int
+expiration_collect_space(struct space *space, void *arg)
+{
+	struct expiration_space_ids *ids = (struct expiration_space_ids *)arg;
+	if (space->def->opts.ttl_field == UINT32_MAX)
+		return 0;
+	if (ids->count == ids->capacity) {
+		ids->capacity = MAX(ids->capacity * 2, 16);
+		ids->ids = xrealloc(ids->ids,
+				    ids->capacity * sizeof(*ids->ids));
+	}
+	ids->ids[ids->count++] = space->def->id;
+	return 0;
+}
+
+static int
+expiration_fiber_f(va_list ap)
+{
+	(void)ap;
+	struct expiration_space_ids ids = {NULL, 0, 0};
+	while (!fiber_is_cancelled()) {
+		fiber_check_gc();
+		fiber_sleep(EXPIRATION_PERIOD);
+		if (box_is_ro())
+			continue;
+		/*
+		 * Collect the space ids first, because the space cache
+		 * may change while the expired tuples are deleted.
+		 */
+		ids.count = 0;
+		space_foreach(expiration_collect_space, &ids);
+		for (uint32_t i = 0; i < ids.count; i++)
+			expiration_space(ids.ids[i]);
+	}
+	free(ids.ids);
+	return 0;
+}
+
+/** Stops the expiration fiber on box shutdown. */
+static int
+expiration_on_shutdown_f(void *arg)
+{
+	(void)arg;
+	fiber_set_name(fiber_self(), "expiration.shutdown");
+	expiration_shutdown();
+	return 0;
+}
+
+void
+expiration_init(void)
+{
+	assert(expiration_fiber == NULL);
+	expiration_fiber = fiber_new_system("expiration", expiration_fiber_f);
+	if (expiration_fiber == NULL)
+		panic("failed to start expiration fiber");
+	fiber_set_joinable(expiration_fiber, true);
+	fiber_start(expiration_fiber);
+	if (box_on_shutdown(NULL, expiration_on_shutdown_f, NULL) != 0)
+		panic("failed to set expiration shutdown trigger");
+}
+
+void
+expiration_shutdown(void)
+{
+	if (expiration_fiber == NULL)
+		return;
+	fiber_cancel(expiration_fiber);
+	fiber_join(expiration_fiber);
+	expiration_fiber = NULL;
+}
+
+void
+expiration_free(void)
+{
+	/*
+	 * Can't join the fiber as the event loop isn't running when
+	 * this function is called, so only drop the shutdown trigger
+	 * if it hasn't run.
+	 */
+	if (expiration_fiber != NULL)
+		box_on_shutdown(NULL, NULL, expiration_on_shutdown_f);
+	expiration_fiber = NULL;
+}
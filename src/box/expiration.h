@@ -0,0 +1,56 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Expiration service deletes tuples of spaces with the ttl_field
+ * option set once the time stored in the field, in seconds since the
+ * epoch, has passed. The deletions are ordinary transactions written
+ * to WAL and replicated, so the service works the same for all engines
+ * and runs only on a writable instance.
+ *
+ * To find expired tuples, the service scans a TREE index whose first
+ * part is the ttl_field in the ascending order. A space without such
+ * an index is skipped.
+ */
+
+struct expiration_stat {
+	/** Number of expired tuples deleted by the service. */
+	int64_t expired;
+	/** Number of transactions committed by the service. */
+	int64_t batches;
+};
+
+extern struct expiration_stat expiration_stat;
+
+/**
+ * Set the max number of tuples deleted by the service per second,
+ * 0 means unlimited.
+ */
+void
+expiration_set_rate(double rate);
+
+/** Start the expiration fiber. */
+void
+expiration_init(void);
+
+/** Cancel the expiration fiber and wait for it to stop. */
+void
+expiration_shutdown(void);
+
+/** Free the expiration service on exit. */
+void
+expiration_free(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -454,6 +454,7 @@ func_new(const struct func_def *def)
 	 * checks (see user_has_data()).
 	 */
 	credentials_create_empty(&func->owner_credentials);
+	func->call_count = 0;
 	return func;
 }
 
@@ -588,6 +589,7 @@ func_call_no_access_check(struct func *base, struct port *args,
 	 * a set-definer-uid one. If the function is not
 	 * defined, it's obviously not a setuid one.
 	 */
+	base->call_count++;
 	struct credentials *orig_credentials = NULL;
 	if (base->def->setuid) {
 		orig_credentials = effective_user();
@@ -71,6 +71,8 @@ struct func {
 	 * Cached runtime access information.
 	 */
 	struct access access[BOX_USER_MAX];
+	/** Number of calls of the function, see box.stat.func(). */
+	int64_t call_count;
 };
 
 /**
@@ -88,6 +88,18 @@ func_by_name(const char *name, uint32_t name_len)
 	return (struct func *)mh_strnptr_node(funcs_by_name, func)->val;
 }
 
+int
+func_foreach(int (*cb)(struct func *func, void *arg), void *arg)
+{
+	mh_int_t i;
+	mh_foreach(funcs, i) {
+		struct func *func = mh_i32ptr_node(funcs, i)->val;
+		if (cb(func, arg) != 0)
+			return -1;
+	}
+	return 0;
+}
+
 void
 func_pin(struct func *func, struct func_cache_holder *holder,
 	 enum func_holder_type type)
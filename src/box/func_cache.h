@@ -91,6 +91,13 @@ func_by_id(uint32_t fid);
 struct func *
 func_by_name(const char *name, uint32_t name_len);
 
+/**
+ * Call a visitor function on every function in the cache. Stops and
+ * returns -1 if the visitor returns a non-zero value.
+ */
+int
+func_foreach(int (*cb)(struct func *func, void *arg), void *arg);
+
 /**
  * Register that there is a @a holder of type @a type that is dependent
  * on function @a func.
@@ -667,6 +667,33 @@ gc_consumer_unregister(struct gc_consumer *consumer)
 	gc_consumer_delete(consumer);
 }
 
+/**
+ * Check if advancing a consumer to @a vclock may let the garbage
+ * collector remove some WAL files. It's possible only if one of
+ * the advanced components of the consumer vclock isn't above the
+ * garbage collector vclock, i.e. the consumer is the one holding
+ * it. Otherwise some other consumer or checkpoint still needs
+ * the same files and the cleanup would be a useless scan of all
+ * consumers. It matters when there are lots of consumers, like
+ * anonymous replicas, each advancing on every relay status update.
+ */
+static bool
+gc_consumer_holds_wal(const struct gc_consumer *consumer,
+		      const struct vclock *vclock)
+{
+	struct vclock_iterator it;
+	vclock_iterator_init(&it, vclock);
+	vclock_foreach(&it, vc) {
+		/* Local rows are never needed by consumers. */
+		if (vc.id == 0)
+			continue;
+		int64_t lsn = vclock_get(&consumer->vclock, vc.id);
+		if (vc.lsn > lsn && lsn <= vclock_get(&gc.vclock, vc.id))
+			return true;
+	}
+	return false;
+}
+
 void
 gc_consumer_advance(struct gc_consumer *consumer, const struct vclock *vclock)
 {
@@ -687,6 +714,7 @@ gc_consumer_advance(struct gc_consumer *consumer, const struct vclock *vclock)
 	struct gc_consumer *next = gc_tree_next(&gc.consumers, consumer);
 	bool update_tree = (next != NULL &&
 			    vclock_lex_compare(vclock, &next->vclock) >= 0);
+	bool need_cleanup = gc_consumer_holds_wal(consumer, vclock);
 
 	if (update_tree)
 		gc_tree_remove(&gc.consumers, consumer);
@@ -696,7 +724,8 @@ gc_consumer_advance(struct gc_consumer *consumer, const struct vclock *vclock)
 	if (update_tree)
 		gc_tree_insert(&gc.consumers, consumer);
 
-	gc_schedule_cleanup();
+	if (need_cleanup)
+		gc_schedule_cleanup();
 }
 
 struct gc_consumer *
@@ -118,6 +118,29 @@ key_validate(const struct index_def *index_def, enum iterator_type type,
 				mp_next(&key);
 			}
 		}
+	} else if (index_def->type == HNSW) {
+		unsigned d = index_def->opts.dimension;
+		if (part_count != 1 && part_count != d) {
+			diag_set(ClientError, ER_KEY_PART_COUNT, d, part_count);
+			return -1;
+		}
+		uint32_t array_size = part_count;
+		if (part_count == 1 && mp_typeof(*key) == MP_ARRAY) {
+			array_size = mp_decode_array(&key);
+			if (array_size != d) {
+				diag_set(ClientError, ER_HNSW_VECTOR, "Key", d);
+				return -1;
+			}
+		} else if (part_count != d) {
+			diag_set(ClientError, ER_HNSW_VECTOR, "Key", d);
+			return -1;
+		}
+		for (uint32_t part = 0; part < array_size; part++) {
+			if (key_part_validate(FIELD_TYPE_NUMBER, key,
+					      part, false))
+				return -1;
+			mp_next(&key);
+		}
 	} else {
 		if (part_count > index_def->key_def->part_count) {
 			diag_set(ClientError, ER_KEY_PART_COUNT,
@@ -317,6 +340,7 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	if (exact_key_validate(index->def->key_def, key, part_count))
 		return -1;
 	box_run_on_select(space, index, ITER_EQ, key_array);
+	index->lookup_count.get++;
 	/* Start transaction in the engine. */
 	struct txn *txn;
 	struct txn_ro_savepoint svp;
@@ -336,6 +360,59 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	return 0;
 }
 
+int
+box_index_get_batch(uint32_t space_id, uint32_t index_id, const char *keys,
+		    const char *keys_end, struct tuple **results)
+{
+	assert(keys != NULL && keys_end != NULL);
+	mp_tuple_assert(keys, keys_end);
+	if (box_check_slice() != 0)
+		return -1;
+	struct space *space;
+	struct index *index;
+	if (check_index(space_id, index_id, &space, &index) != 0)
+		return -1;
+	if (!index->def->opts.is_unique) {
+		diag_set(ClientError, ER_MORE_THAN_ONE_TUPLE);
+		return -1;
+	}
+	uint32_t count = mp_decode_array(&keys);
+	if (count == 0)
+		return 0;
+	const char **key_parts = xregion_alloc_array(&fiber()->gc,
+						     const char *, count);
+	for (uint32_t i = 0; i < count; i++) {
+		if (mp_typeof(*keys) != MP_ARRAY) {
+			diag_set(IllegalParams, "key must be an array");
+			return -1;
+		}
+		const char *key_array = keys;
+		uint32_t part_count = mp_decode_array(&keys);
+		if (exact_key_validate(index->def->key_def, keys, part_count))
+			return -1;
+		box_run_on_select(space, index, ITER_EQ, key_array);
+		index->lookup_count.get++;
+		key_parts[i] = keys;
+		keys = key_array;
+		mp_next(&keys);
+	}
+	/* Start transaction in the engine. */
+	struct txn *txn;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+		return -1;
+	struct result_processor res_proc;
+	result_process_prepare(&res_proc, space);
+	int rc = index_get_batch(index, key_parts, count, results);
+	result_process_perform_batch(&res_proc, &rc, results, count);
+	txn_end_ro_stmt(txn, &svp);
+	if (rc != 0)
+		return -1;
+	/* Count statistics. */
+	rmean_collect(rmean_box, IPROTO_SELECT, 1);
+	return 0;
+}
+
 int
 box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result)
@@ -356,6 +433,7 @@ box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	if (key_validate(index->def, ITER_GE, key, part_count))
 		return -1;
 	box_run_on_select(space, index, ITER_GE, key_array);
+	index->lookup_count.select++;
 	/* Start transaction in the engine. */
 	struct txn *txn;
 	struct txn_ro_savepoint svp;
@@ -393,6 +471,7 @@ box_index_max(uint32_t space_id, uint32_t index_id, const char *key,
 	if (key_validate(index->def, ITER_LE, key, part_count))
 		return -1;
 	box_run_on_select(space, index, ITER_LE, key_array);
+	index->lookup_count.select++;
 	/* Start transaction in the engine. */
 	struct txn *txn;
 	struct txn_ro_savepoint svp;
@@ -489,6 +568,7 @@ box_index_iterator_after(uint32_t space_id, uint32_t index_id, int type,
 		pos_end = pos_buf + pos_buf_size;
 	}
 	box_run_on_select(space, index, itype, key_array);
+	index->lookup_count.select++;
 	struct txn *txn;
 	struct txn_ro_savepoint svp;
 	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
@@ -638,7 +718,12 @@ iterator_next(struct iterator *it, struct tuple **ret)
 		*ret = NULL;
 		return 0;
 	}
-	return it->next(it, ret);
+	int rc = it->next(it, ret);
+	/* The index may have been dropped if the iterator yielded. */
+	if (rc == 0 && *ret != NULL &&
+	    it->space_cache_version == space_cache_version)
+		it->index->lookup_count.scan++;
+	return rc;
 }
 
 int
@@ -787,6 +872,8 @@ index_create(struct index *index, struct engine *engine,
 	/* Unusable until set to proper value during space creation. */
 	index->dense_id = UINT32_MAX;
 	rlist_create(&index->read_gaps);
+	rlist_create(&index->full_scans);
+	memset(&index->lookup_count, 0, sizeof(index->lookup_count));
 }
 
 void
@@ -952,6 +1039,25 @@ generic_index_get(struct index *index, const char *key,
 	return -1;
 }
 
+int
+generic_index_get_batch(struct index *index, const char **keys,
+			uint32_t count, struct tuple **results)
+{
+	uint32_t part_count = index->def->key_def->part_count;
+	for (uint32_t i = 0; i < count; i++) {
+		if (index_get(index, keys[i], part_count, &results[i]) != 0) {
+			for (uint32_t j = 0; j < i; j++) {
+				if (results[j] != NULL)
+					tuple_unref(results[j]);
+			}
+			return -1;
+		}
+		if (results[i] != NULL)
+			tuple_ref(results[i]);
+	}
+	return 0;
+}
+
 int
 generic_index_replace(struct index *index, struct tuple *old_tuple,
 		      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -284,6 +284,28 @@ box_index_tuple_position(uint32_t space_id, uint32_t index_id,
 			 const char *tuple, const char *tuple_end,
 			 const char **packed_pos, const char **packed_pos_end);
 
+/**
+ * Get tuples from a unique index by a batch of full keys. It's faster
+ * than calling box_index_get() for each key, because all the keys are
+ * looked up in one read-only statement and the index may overlap the
+ * lookups with each other.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param keys encoded keys in MsgPack Array format
+ *        ([[part1, part2, ...], ...]).
+ * \param keys_end the end of encoded \a keys
+ * \param[out] results array with room for as many tuples as there are
+ *        keys in \a keys. The tuple found for the i-th key or NULL is
+ *        stored in results[i]. Found tuples are referenced and must be
+ *        unreferenced by the caller.
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+int
+box_index_get_batch(uint32_t space_id, uint32_t index_id, const char *keys,
+		    const char *keys_end, struct tuple **results);
+
 /**
  * Index statistics (index:stat())
  *
@@ -592,6 +614,14 @@ struct index_vtab {
 			    uint32_t part_count, struct tuple **result);
 	int (*get)(struct index *index, const char *key,
 		   uint32_t part_count, struct tuple **result);
+	/**
+	 * Look up @a count full keys at once. Each key points to the first
+	 * key part, i.e. past the MsgPack array header. On success the
+	 * tuple found for keys[i] or NULL is stored in results[i]. Found
+	 * tuples are referenced and must be unreferenced by the caller.
+	 */
+	int (*get_batch)(struct index *index, const char **keys,
+			 uint32_t count, struct tuple **results);
 	/**
 	 * Main entrance point for changing data in index. Once built and
 	 * before deletion this is the only way to insert, replace and delete
@@ -657,14 +687,29 @@ struct index {
 	uint32_t dense_id;
 	/**
 	 * List of gap_item's describing gap reads in the index with NULL
-	 * successor OR full scan gaps.
-	 * The first type happens when reading from empty index,
-	 * or when reading from rightmost part of ordered index (TREE).
-	 * The second type happens when a full scan was finished for
-	 * unordered index (HASH).
+	 * successor.
+	 * It happens when reading from empty index, or when reading from
+	 * rightmost part of ordered index (TREE).
 	 * @sa struct gap_item_base.
 	 */
 	struct rlist read_gaps;
+	/**
+	 * List of gap_item's describing full scans of the index.
+	 * It happens when a full scan was finished for unordered index
+	 * (HASH). Kept apart from read_gaps because every insertion into
+	 * the index must check all of them.
+	 * @sa struct gap_item_base.
+	 */
+	struct rlist full_scans;
+	/** Number of lookups in the index, see box.stat.space(). */
+	struct {
+		/** Point lookups: get(). */
+		int64_t get;
+		/** Range lookups: select(), pairs(), min(), max(). */
+		int64_t select;
+		/** Tuples fetched by iterators, including skipped ones. */
+		int64_t scan;
+	} lookup_count;
 };
 
 /**
@@ -965,6 +1010,13 @@ index_get(struct index *index, const char *key,
 	return index->vtab->get(index, key, part_count, result);
 }
 
+static inline int
+index_get_batch(struct index *index, const char **keys, uint32_t count,
+		struct tuple **results)
+{
+	return index->vtab->get_batch(index, keys, count, results);
+}
+
 static inline int
 index_replace(struct index *index, struct tuple *old_tuple,
 	      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -1121,6 +1173,9 @@ int
 generic_index_get_internal(struct index *index, const char *key,
 			   uint32_t part_count, struct tuple **result);
 int generic_index_get(struct index *, const char *, uint32_t, struct tuple **);
+int
+generic_index_get_batch(struct index *index, const char **keys,
+			uint32_t count, struct tuple **results);
 int generic_index_replace(struct index *, struct tuple *, struct tuple *,
 			  enum dup_replace_mode,
 			  struct tuple **, struct tuple **);
@@ -35,9 +35,15 @@
 #include "json/json.h"
 #include "fiber.h"
 
-const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
+const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE", "TEXT",
+				   "HNSW" };
 
-const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
+const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN",
+						  "COSINE", "DOT" };
+
+const char *index_bloom_type_strs[] = { "BLOOM", "XOR" };
+
+const char *index_compaction_strategy_strs[] = { "LEVELED", "TIERED" };
 
 const struct index_opts index_opts_default = {
 	/* .unique              = */ true,
@@ -47,7 +53,9 @@ const struct index_opts index_opts_default = {
 	/* .page_size           = */ 8192,
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
+	/* .compaction_strategy = */ INDEX_COMPACTION_STRATEGY_LEVELED,
 	/* .bloom_fpr           = */ 0.05,
+	/* .bloom_type          = */ INDEX_BLOOM_TYPE_BLOOM,
 	/* .lsn                 = */ 0,
 	/* .stat                = */ NULL,
 	/* .func                = */ 0,
@@ -84,7 +92,11 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("page_size", OPT_INT64, struct index_opts, page_size),
 	OPT_DEF("run_count_per_level", OPT_INT64, struct index_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct index_opts, run_size_ratio),
+	OPT_DEF_ENUM("compaction_strategy", index_compaction_strategy,
+		     struct index_opts, compaction_strategy, NULL),
 	OPT_DEF("bloom_fpr", OPT_FLOAT, struct index_opts, bloom_fpr),
+	OPT_DEF_ENUM("bloom_type", index_bloom_type, struct index_opts,
+		     bloom_type, NULL),
 	OPT_DEF("lsn", OPT_INT64, struct index_opts, lsn),
 	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_DEF_LEGACY("sql"),
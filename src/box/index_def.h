@@ -44,6 +44,8 @@ enum index_type {
 	TREE,     /* TREE Index */
 	BITSET,   /* BITSET Index */
 	RTREE,    /* R-Tree Index */
+	TEXT,     /* Full-text Index */
+	HNSW,     /* Vector similarity (HNSW graph) Index */
 	index_type_MAX,
 };
 
@@ -61,10 +63,41 @@ enum rtree_index_distance_type {
 	RTREE_INDEX_DISTANCE_TYPE_EUCLID,
 	/* Manhattan distance, fabs(dx) + fabs(dy) */
 	RTREE_INDEX_DISTANCE_TYPE_MANHATTAN,
+	/* Cosine distance, 1 - cos(a, b), HNSW only */
+	RTREE_INDEX_DISTANCE_TYPE_COSINE,
+	/* Negated dot product, -(a, b), HNSW only */
+	RTREE_INDEX_DISTANCE_TYPE_DOT,
 	rtree_index_distance_type_MAX
 };
 extern const char *rtree_index_distance_type_strs[];
 
+/** Type of the filter used by vinyl to skip runs on point lookups. */
+enum index_bloom_type {
+	/* Classic bloom filter. */
+	INDEX_BLOOM_TYPE_BLOOM,
+	/* Xor filter, takes less memory for the same false positive rate. */
+	INDEX_BLOOM_TYPE_XOR,
+	index_bloom_type_MAX
+};
+extern const char *index_bloom_type_strs[];
+
+/** Strategy used by vinyl to decide which runs to compact. */
+enum index_compaction_strategy {
+	/*
+	 * Keep one run at the last level and compact a level once
+	 * it has more than run_count_per_level runs.
+	 */
+	INDEX_COMPACTION_STRATEGY_LEVELED,
+	/*
+	 * Compact runs of similar size once there are more than
+	 * run_count_per_level of them, allow many runs at the last
+	 * level. Trades space amplification for write amplification.
+	 */
+	INDEX_COMPACTION_STRATEGY_TIERED,
+	index_compaction_strategy_MAX
+};
+extern const char *index_compaction_strategy_strs[];
+
 /** Simple alias to represent logarithm metrics. */
 typedef int16_t log_est_t;
 
@@ -135,11 +168,11 @@ struct index_opts {
 	 */
 	bool is_unique;
 	/**
-	 * RTREE index dimension.
+	 * RTREE and HNSW index dimension.
 	 */
 	int64_t dimension;
 	/**
-	 * RTREE distance type.
+	 * RTREE and HNSW distance type.
 	 */
 	enum rtree_index_distance_type distance;
 	/**
@@ -158,8 +191,12 @@ struct index_opts {
 	 * previous one.
 	 */
 	double run_size_ratio;
+	/** Strategy used to pick runs for compaction. */
+	enum index_compaction_strategy compaction_strategy;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
+	/* Type of the filter built for each run. */
+	enum index_bloom_type bloom_type;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -218,8 +255,13 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		       -1 : 1;
 	if (o1->run_size_ratio != o2->run_size_ratio)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
+	if (o1->compaction_strategy != o2->compaction_strategy)
+		return o1->compaction_strategy < o2->compaction_strategy ?
+		       -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->bloom_type != o2->bloom_type)
+		return o1->bloom_type < o2->bloom_type ? -1 : 1;
 	if (o1->func_id != o2->func_id)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
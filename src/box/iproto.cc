@@ -33,11 +33,13 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <limits.h>
 
 #include <msgpuck.h>
 #include <small/ibuf.h>
 #include <small/obuf.h>
 #include <base64.h>
+#include <zstd.h>
 
 #include "version.h"
 #include "event.h"
@@ -59,11 +61,15 @@
 #include "tuple_convert.h"
 #include "session.h"
 #include "xrow.h"
+#include "iterator_type.h"
 #include "schema.h" /* schema_version */
 #include "replication.h" /* instance_uuid */
 #include "iproto_constants.h"
 #include "iproto_features.h"
 #include "rmean.h"
+#include "latency.h"
+#include "clock.h"
+#include "usdt.h"
 #include "execute.h"
 #include "errinj.h"
 #include "tt_static.h"
@@ -77,6 +83,7 @@
 #include "box/mp_box_ctx.h"
 #include "box/tuple.h"
 #include "mpstream/mpstream.h"
+#include "info/info.h"
 
 enum {
 	IPROTO_PACKET_SIZE_MAX = 2UL * 1024 * 1024 * 1024,
@@ -86,6 +93,28 @@ enum {
 	 ENDPOINT_NAME_MAX = 10
 };
 
+enum {
+	/**
+	 * Max number of connections an IPROTO thread may have over
+	 * the least loaded IPROTO thread and still accept new ones.
+	 */
+	IPROTO_ACCEPT_IMBALANCE_MAX = 4,
+	/**
+	 * Min size of a response body that is compressed for clients
+	 * supporting IPROTO_FEATURE_RESPONSE_COMPRESSION. Smaller bodies
+	 * aren't worth the CPU time spent on compression.
+	 */
+	IPROTO_COMPRESSION_THRESHOLD = 16 * 1024,
+	/** Compression level used for response bodies. */
+	IPROTO_COMPRESSION_LEVEL = 1,
+};
+
+/**
+ * How often an IPROTO thread that stopped accepting connections
+ * checks if it may resume, in seconds.
+ */
+static const double IPROTO_ACCEPT_BALANCE_PERIOD = 0.1;
+
 struct iproto_connection;
 struct iproto_msg;
 
@@ -155,6 +184,13 @@ struct iproto_thread {
 	 */
 	struct cpipe tx_pipe;
 	struct cpipe net_pipe;
+	/**
+	 * Pipe to the tx_prio endpoint, which is served directly by
+	 * the tx scheduler fiber before any request from tx_pipe.
+	 * Used for requests that must be answered fast even if tx
+	 * is overloaded and that never yield, see ping_route.
+	 */
+	struct cpipe tx_prio_pipe;
 	/**
 	 * Static routes for this iproto thread
 	 */
@@ -176,6 +212,7 @@ struct iproto_thread {
 	struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX];
 	struct cmsg_hop connect_route[2];
 	struct cmsg_hop override_route[2];
+	struct cmsg_hop ping_route[2];
 	/*
 	 * Set of overridden request handlers. Used by IPROTO thread to skip
 	 * request preprocessing and use the 'override' route.
@@ -201,8 +238,20 @@ struct iproto_thread {
 	uint32_t id;
 	/** Array of iproto binary listeners */
 	struct evio_service binary;
+	/**
+	 * Number of connections served by the thread. Updated by
+	 * the thread itself and read by other IPROTO threads to
+	 * balance new connections, see iproto_thread_balance_accept().
+	 */
+	int connection_count;
+	/** Set if the thread stopped accepting new connections. */
+	bool is_accept_paused;
+	/** Timer calling iproto_thread_balance_accept() periodically. */
+	struct ev_timer balance_timer;
 	/** Requests count currently pending in stream queue. */
 	size_t requests_in_stream_queue;
+	/** Number of connections that have messages in progress. */
+	size_t busy_connection_count;
 	/**
 	 * The following fields are used exclusively by the tx thread.
 	 * Align them to prevent false-sharing.
@@ -223,6 +272,18 @@ static struct uri_set iproto_uris;
 
 static struct iproto_thread *iproto_threads;
 int iproto_threads_count;
+
+const char *iproto_io_backend_strs[] = {
+	/* [IPROTO_IO_BACKEND_AUTO]	= */ "auto",
+	/* [IPROTO_IO_BACKEND_EPOLL]	= */ "epoll",
+	/* [IPROTO_IO_BACKEND_IO_URING]	= */ "io_uring",
+};
+
+static_assert(lengthof(iproto_io_backend_strs) == iproto_io_backend_MAX,
+	      "iproto_io_backend_strs must match enum iproto_io_backend");
+
+/** Event loop backend requested for IPROTO threads. */
+static enum iproto_io_backend iproto_thread_io_backend;
 /**
  * This binary contains all bind socket properties, like
  * address the iproto listens for. Is kept in TX to be
@@ -231,6 +292,8 @@ int iproto_threads_count;
  * in tx thread.
  */
 static struct evio_service tx_binary;
+/** Context used for compression of response bodies in tx. */
+static ZSTD_CCtx *tx_zctx;
 
 /**
  * In Greek mythology, Kharon is the ferryman who carries souls
@@ -435,6 +498,15 @@ struct iproto_msg
 	struct stailq_entry in_stream;
 	/** Stream that owns this message, or NULL. */
 	struct iproto_stream *stream;
+	/** Monotonic time when the request was read from the socket. */
+	double recv_time;
+	/** Monotonic time when the tx thread started the request. */
+	double accept_time;
+	/**
+	 * Context switch count of the fiber processing the request
+	 * when the tx thread started it.
+	 */
+	int accept_csw;
 };
 
 /**
@@ -482,6 +554,34 @@ const char *rmean_tx_strings[RMEAN_TX_LAST] = {
 	"REQUESTS_IN_PROGRESS",
 };
 
+/** Stages of request processing, latency of which is tracked. */
+enum iproto_latency_stage {
+	/**
+	 * From reading the request in the network thread till the tx
+	 * thread starts processing it: time spent in a stream queue,
+	 * in the tx pipe, waiting for a fiber.
+	 */
+	IPROTO_LATENCY_QUEUE,
+	/**
+	 * Processing in the tx thread including waiting for the WAL
+	 * and the reply encoding.
+	 */
+	IPROTO_LATENCY_EXEC,
+	iproto_latency_stage_MAX,
+};
+
+static const char *iproto_latency_stage_strs[iproto_latency_stage_MAX] = {
+	"queue",
+	"exec",
+};
+
+/**
+ * Latency of request processing stages per request type, collected by
+ * the tx thread for requests from all the network threads.
+ */
+static struct latency
+tx_latency[IPROTO_TYPE_STAT_MAX][iproto_latency_stage_MAX];
+
 static void
 tx_process_destroy(struct cmsg *m);
 
@@ -660,6 +760,14 @@ struct iproto_connection
 	 */
 	enum iproto_connection_state state;
 	struct rlist in_stop_list;
+	/** Number of messages of this connection in progress. */
+	size_t msg_count;
+	/**
+	 * Set if the connection input is stopped, because it has
+	 * more messages in progress than its fair share. Checked
+	 * in iproto_msg_delete().
+	 */
+	bool is_over_fair_share;
 	/**
 	 * Flag indicates, that client sent SHUT_RDWR or connection
 	 * is closed from client side. When it is set to false, we
@@ -783,11 +891,46 @@ iproto_check_msg_max(struct iproto_thread *iproto_thread)
 	return request_count > (size_t) iproto_msg_max;
 }
 
+/**
+ * Return true if a connection has more messages in progress than
+ * its fair share. Messages are shared evenly among connections that
+ * have messages in progress, but only when more than half of
+ * net_msg_max is used, so that a single client may pipeline as many
+ * requests as it wants while there's no contention. This prevents
+ * a greedy client from filling up the tx queue and starving others.
+ */
+static inline bool
+iproto_connection_is_over_fair_share(struct iproto_connection *con)
+{
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	size_t request_count = mempool_count(&iproto_thread->iproto_msg_pool);
+	if (request_count <= (size_t)iproto_msg_max / 2)
+		return false;
+	assert(iproto_thread->busy_connection_count > 0);
+	size_t share = (size_t)iproto_msg_max /
+		       iproto_thread->busy_connection_count;
+	return con->msg_count >= MAX(share, (size_t)1);
+}
+
 static inline void
 iproto_msg_delete(struct iproto_msg *msg)
 {
-	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
-	mempool_free(&msg->connection->iproto_thread->iproto_msg_pool, msg);
+	struct iproto_connection *con = msg->connection;
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	mempool_free(&iproto_thread->iproto_msg_pool, msg);
+	assert(con->msg_count > 0);
+	if (--con->msg_count == 0) {
+		assert(iproto_thread->busy_connection_count > 0);
+		iproto_thread->busy_connection_count--;
+	}
+	if (con->is_over_fair_share &&
+	    !iproto_connection_is_over_fair_share(con)) {
+		con->is_over_fair_share = false;
+		/* Let iproto_resume() resume it in its turn. */
+		if (con->state == IPROTO_CONNECTION_ALIVE)
+			rlist_add_tail(&iproto_thread->stopped_connections,
+				       &con->in_stop_list);
+	}
 	iproto_resume(iproto_thread);
 }
 
@@ -808,6 +951,8 @@ iproto_msg_new(struct iproto_connection *con)
 		(struct iproto_msg *)xmempool_alloc(iproto_msg_pool);
 	msg->close_connection = false;
 	msg->connection = con;
+	if (con->msg_count++ == 0)
+		con->iproto_thread->busy_connection_count++;
 	msg->stream = NULL;
 	rmean_collect(con->iproto_thread->rmean, IPROTO_REQUESTS, 1);
 	return msg;
@@ -820,7 +965,8 @@ static inline void
 iproto_connection_feed_input(struct iproto_connection *con)
 {
 	assert(con->state == IPROTO_CONNECTION_ALIVE);
-	if (!ev_is_active(&con->input) && rlist_empty(&con->in_stop_list))
+	if (!ev_is_active(&con->input) && rlist_empty(&con->in_stop_list) &&
+	    !con->is_over_fair_share)
 		ev_feed_event(con->loop, &con->input, EV_CUSTOM);
 }
 
@@ -898,6 +1044,23 @@ iproto_connection_stop_msg_max_limit(struct iproto_connection *con)
 		       &con->in_stop_list);
 }
 
+/**
+ * Stop input when the connection has more messages in progress than
+ * its fair share, see iproto_connection_is_over_fair_share(). The input
+ * is resumed when enough messages of this connection are processed.
+ */
+static inline void
+iproto_connection_stop_fair_share_limit(struct iproto_connection *con)
+{
+	assert(rlist_empty(&con->in_stop_list));
+	assert(con->msg_count > 0);
+	say_warn_ratelimited("stopping input on connection %s, "
+			     "fair share of net_msg_max is reached",
+			     iproto_connection_name(con));
+	ev_io_stop(con->loop, &con->input);
+	con->is_over_fair_share = true;
+}
+
 /**
  * Send a destroy message to TX thread in case all requests are
  * finished.
@@ -1148,6 +1311,11 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 			cpipe_flush_input(&con->iproto_thread->tx_pipe);
 			return 0;
 		}
+		if (iproto_connection_is_over_fair_share(con)) {
+			iproto_connection_stop_fair_share_limit(con);
+			cpipe_flush_input(&con->iproto_thread->tx_pipe);
+			return 0;
+		}
 		const char *reqstart = in->wpos - con->parse_size;
 		const char *pos = reqstart;
 		/* Read request length. */
@@ -1172,6 +1340,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		if (reqend > in->wpos)
 			break;
 		struct iproto_msg *msg = iproto_msg_new(con);
+		msg->recv_time = ev_monotonic_now(con->loop);
 		msg->p_ibuf = con->p_ibuf;
 		msg->reqstart = reqstart;
 		msg->wpos = con->wpos;
@@ -1180,7 +1349,11 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 
 		iproto_msg_prepare(msg, &pos, reqend, &stop_input);
 		if (iproto_msg_start_processing_in_stream(msg)) {
-			cpipe_push_input(&con->iproto_thread->tx_pipe, &msg->base);
+			struct iproto_thread *thread = con->iproto_thread;
+			struct cpipe *pipe = &thread->tx_pipe;
+			if (msg->base.hop == thread->ping_route)
+				pipe = &thread->tx_prio_pipe;
+			cpipe_push_input(pipe, &msg->base);
 			n_requests++;
 		}
 
@@ -1220,6 +1393,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		 */
 		iproto_connection_feed_input(con);
 	}
+	cpipe_flush_input(&con->iproto_thread->tx_prio_pipe);
 	cpipe_flush_input(&con->iproto_thread->tx_pipe);
 	return 0;
 }
@@ -1466,6 +1640,8 @@ iproto_connection_new(struct iproto_thread *iproto_thread)
 	con->long_poll_count = 0;
 	con->session = NULL;
 	rlist_create(&con->in_stop_list);
+	con->msg_count = 0;
+	con->is_over_fair_share = false;
 	/* It may be very awkward to allocate at close. */
 	cmsg_init(&con->destroy_msg, con->iproto_thread->destroy_route);
 	cmsg_init(&con->disconnect_msg, con->iproto_thread->disconnect_route);
@@ -1473,9 +1649,51 @@ iproto_connection_new(struct iproto_thread *iproto_thread)
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = false;
 	rmean_collect(iproto_thread->rmean, IPROTO_CONNECTIONS, 1);
+	__atomic_add_fetch(&iproto_thread->connection_count, 1,
+			   __ATOMIC_RELAXED);
 	return con;
 }
 
+/**
+ * All IPROTO threads listen on the same sockets so the thread that
+ * is woken up first accepts a new connection. As a result, one thread
+ * may end up serving most of the connections, for example, because it
+ * accepted a burst of them. To avoid that, a thread that has more than
+ * IPROTO_ACCEPT_IMBALANCE_MAX connections over the least loaded thread
+ * stops accepting new connections until the others catch up, leaving
+ * them to other threads. The least loaded thread never stops.
+ */
+static void
+iproto_thread_balance_accept(struct iproto_thread *iproto_thread)
+{
+	if (iproto_threads_count <= 1 ||
+	    iproto_thread->binary.entry_count == 0)
+		return;
+	int min_count = INT_MAX;
+	for (int i = 0; i < iproto_threads_count; i++) {
+		int count = __atomic_load_n(&iproto_threads[i].connection_count,
+					    __ATOMIC_RELAXED);
+		min_count = MIN(min_count, count);
+	}
+	bool is_overloaded = iproto_thread->connection_count >
+			     min_count + IPROTO_ACCEPT_IMBALANCE_MAX;
+	if (is_overloaded == iproto_thread->is_accept_paused)
+		return;
+	if (is_overloaded)
+		evio_service_pause(&iproto_thread->binary);
+	else
+		evio_service_resume(&iproto_thread->binary);
+	iproto_thread->is_accept_paused = is_overloaded;
+}
+
+static void
+iproto_thread_balance_timer_cb(ev_loop *loop, ev_timer *watcher, int events)
+{
+	(void)loop;
+	(void)events;
+	iproto_thread_balance_accept((struct iproto_thread *)watcher->data);
+}
+
 /** Recycle a connection. */
 static inline void
 iproto_connection_delete(struct iproto_connection *con)
@@ -1495,7 +1713,11 @@ iproto_connection_delete(struct iproto_connection *con)
 
 	assert(mh_size(con->streams) == 0);
 	mh_i64ptr_delete(con->streams);
-	mempool_free(&con->iproto_thread->iproto_connection_pool, con);
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	mempool_free(&iproto_thread->iproto_connection_pool, con);
+	__atomic_sub_fetch(&iproto_thread->connection_count, 1,
+			   __ATOMIC_RELAXED);
+	iproto_thread_balance_accept(iproto_thread);
 }
 
 /* }}} iproto_connection */
@@ -1505,6 +1727,9 @@ iproto_connection_delete(struct iproto_connection *con)
 static void
 tx_process_misc(struct cmsg *msg);
 
+static void
+tx_process_ping(struct cmsg *msg);
+
 static void
 tx_process_call(struct cmsg *msg);
 
@@ -1682,7 +1907,14 @@ iproto_msg_decode(struct iproto_msg *msg, struct cmsg_hop **route)
 			return -1;
 		return 0;
 	case IPROTO_PING:
-		*route = iproto_thread->misc_route;
+		/*
+		 * A ping doesn't need the session so unless it's
+		 * ordered with other requests in a stream, it can
+		 * bypass the tx request queue.
+		 */
+		*route = msg->header.stream_id == 0 ?
+			 iproto_thread->ping_route :
+			 iproto_thread->misc_route;
 		return 0;
 	case IPROTO_ID:
 		*route = iproto_thread->misc_route;
@@ -1942,6 +2174,9 @@ static inline struct iproto_msg *
 tx_accept_msg(struct cmsg *m)
 {
 	struct iproto_msg *msg = (struct iproto_msg *) m;
+	msg->accept_time = clock_monotonic();
+	msg->accept_csw = fiber_csw(fiber());
+	USDT_PROBE(request_start, msg->header.type, msg->header.sync);
 	tx_accept_wpos(msg->connection, &msg->wpos);
 	tx_fiber_init(msg->connection->session, msg->header.sync);
 	tx_prepare_transaction_for_request(msg);
@@ -1966,6 +2201,23 @@ check_watch_key(const char *key, uint32_t len)
 	return strncmp(key, box_ballot_event_key, len) == 0;
 }
 
+/**
+ * If the request header has IPROTO_WAIT_VCLOCK, wait until this instance's
+ * vclock reaches it, so that a client may read its own writes made on
+ * another instance. The wait is limited by IPROTO_TIMEOUT given in the
+ * header or by replication_disconnect_timeout otherwise.
+ */
+static int
+tx_wait_vclock(struct iproto_msg *msg)
+{
+	struct vclock vclock;
+	double timeout = replication_disconnect_timeout();
+	int rc = xrow_decode_wait_vclock(&msg->header, &vclock, &timeout);
+	if (rc <= 0)
+		return rc;
+	return box_wait_vclock(&vclock, ev_monotonic_now(loop()) + timeout);
+}
+
 /**
  * Check if the tx thread may continue with processing an accepted message.
  * If something's wrong, returns -1 and sets diag, otherwise returns 0.
@@ -1986,12 +2238,74 @@ tx_check_msg(struct iproto_msg *msg)
 	     !check_watch_key(msg->watch.key, msg->watch.key_len)) &&
 	    security_check_session() != 0)
 		return -1;
+	/* IPROTO_PING is processed by the tx scheduler fiber, can't yield. */
+	if (type != IPROTO_PING && tx_wait_vclock(msg) != 0)
+		return -1;
 	return 0;
 }
 
+/** Account the time spent on the request processing stages. */
+static inline void
+tx_collect_latency(struct iproto_msg *msg, double now)
+{
+	uint32_t type = msg->header.type;
+	/* IPROTO_OK is the type of requests failed to decode. */
+	if (type == IPROTO_OK || type >= IPROTO_TYPE_STAT_MAX)
+		return;
+	struct latency *latency = tx_latency[type];
+	latency_collect(&latency[IPROTO_LATENCY_QUEUE],
+			msg->accept_time - msg->recv_time);
+	latency_collect(&latency[IPROTO_LATENCY_EXEC],
+			now - msg->accept_time);
+}
+
+/**
+ * Log a request that took longer than too_long_threshold to complete,
+ * with the time spent in the queue and in the tx thread and the number
+ * of yields. For a DML or SELECT request, also log the space, index,
+ * iterator and key, which are usually enough to find the offending
+ * query.
+ */
+static void
+tx_log_slow_request(struct iproto_msg *msg, double now)
+{
+	uint16_t type = msg->header.type;
+	const char *type_name = iproto_type_name(type);
+	if (type_name == NULL)
+		type_name = "unknown";
+	double queue_time = msg->accept_time - msg->recv_time;
+	double exec_time = now - msg->accept_time;
+	int yield_count = fiber_csw(fiber()) - msg->accept_csw;
+	if (type != IPROTO_NOP && iproto_type_is_dml(type)) {
+		const struct request *req = &msg->dml;
+		const char *key = req->key != NULL ? req->key : req->tuple;
+		say_warn_ratelimited("too long %s request: space %u, "
+				     "index %u, iterator %s, key %s: "
+				     "queue %.3f sec, exec %.3f sec, "
+				     "%d yields", type_name, req->space_id,
+				     req->index_id,
+				     type == IPROTO_SELECT &&
+				     req->iterator < iterator_type_MAX ?
+				     iterator_type_strs[req->iterator] : "EQ",
+				     key != NULL ? mp_str(key) : "[]",
+				     queue_time, exec_time, yield_count);
+	} else {
+		say_warn_ratelimited("too long %s request: "
+				     "queue %.3f sec, exec %.3f sec, "
+				     "%d yields", type_name, queue_time,
+				     exec_time, yield_count);
+	}
+}
+
 static inline void
 tx_end_msg(struct iproto_msg *msg, struct obuf_svp *svp)
 {
+	double now = clock_monotonic();
+	tx_collect_latency(msg, now);
+	if (now - msg->recv_time > too_long_threshold &&
+	    msg->header.type != IPROTO_OK)
+		tx_log_slow_request(msg, now);
+	USDT_PROBE(request_done, msg->header.type, msg->header.sync);
 	if (msg->stream != NULL) {
 		assert(msg->stream->txn == NULL);
 		msg->stream->txn = txn_detach();
@@ -2003,6 +2317,74 @@ tx_end_msg(struct iproto_msg *msg, struct obuf_svp *svp)
 		flightrec_write_response(out, svp);
 }
 
+/**
+ * Replace the body of an IPROTO_OK response written to the output buffer
+ * starting at the given savepoint with IPROTO_COMPRESSED_BODY if the client
+ * supports it and the body is big enough. The savepoint is updated to point
+ * to the new response. If compression fails or is inefficient, the response
+ * is left as is.
+ */
+static void
+tx_compress_reply(struct iproto_msg *msg, struct obuf *out,
+		  struct obuf_svp *svp)
+{
+	if (!iproto_features_test(&msg->connection->session->meta.features,
+				  IPROTO_FEATURE_RESPONSE_COMPRESSION))
+		return;
+	size_t body_size = obuf_size(out) - svp->used - IPROTO_HEADER_LEN;
+	if (body_size < IPROTO_COMPRESSION_THRESHOLD)
+		return;
+	RegionGuard region_guard(&fiber()->gc);
+	size_t zsize_max = ZSTD_compressBound(body_size);
+	char *zbuf = (char *)region_alloc(&fiber()->gc, zsize_max);
+	if (zbuf == NULL)
+		return;
+	ZSTD_CCtx_reset(tx_zctx, ZSTD_reset_session_only);
+	ZSTD_CCtx_setPledgedSrcSize(tx_zctx, body_size);
+	ZSTD_outBuffer zout = {zbuf, zsize_max, 0};
+	/*
+	 * The header is allocated contiguously (see iproto_prepare_header())
+	 * so the body starts in the same iovec.
+	 */
+	int pos = svp->pos;
+	size_t offset = svp->iov_len + IPROTO_HEADER_LEN;
+	size_t left = body_size;
+	while (left > 0) {
+		assert(pos <= out->pos);
+		struct iovec *iov = &out->iov[pos];
+		size_t len = MIN(iov->iov_len - offset, left);
+		left -= len;
+		ZSTD_EndDirective mode = left == 0 ? ZSTD_e_end :
+						     ZSTD_e_continue;
+		ZSTD_inBuffer zin = {(char *)iov->iov_base + offset, len, 0};
+		size_t rc;
+		do {
+			rc = ZSTD_compressStream2(tx_zctx, &zout, &zin, mode);
+			if (ZSTD_isError(rc))
+				return;
+		} while (mode == ZSTD_e_end ? rc != 0 : zin.pos < zin.size);
+		pos++;
+		offset = 0;
+	}
+	size_t zsize = zout.pos;
+	size_t new_body_size = mp_sizeof_map(1) +
+			       mp_sizeof_uint(IPROTO_COMPRESSED_BODY) +
+			       mp_sizeof_binl(zsize) + zsize;
+	if (new_body_size >= body_size)
+		return;
+	obuf_rollback_to_svp(out, svp);
+	iproto_prepare_header(out, svp, IPROTO_HEADER_LEN);
+	size_t size = new_body_size - zsize;
+	char *data = (char *)xobuf_alloc(out, size);
+	data = mp_encode_map(data, 1);
+	data = mp_encode_uint(data, IPROTO_COMPRESSED_BODY);
+	data = mp_encode_binl(data, zsize);
+	xobuf_dup(out, zbuf, zsize);
+	iproto_header_encode((char *)obuf_svp_to_ptr(out, svp), IPROTO_OK,
+			     msg->header.sync, ::schema_version,
+			     new_body_size);
+}
+
 /**
  * Write error message to the output buffer and advance write position.
  */
@@ -2303,6 +2685,7 @@ tx_process_select(struct cmsg *m)
 				    ::schema_version, count, box_tuple_as_ext);
 	}
 	region_truncate(&fiber()->gc, region_svp);
+	tx_compress_reply(msg, out, &svp);
 	iproto_wpos_create(&msg->wpos, out);
 	tx_end_msg(msg, &svp);
 	return;
@@ -2421,6 +2804,7 @@ tx_process_call(struct cmsg *m)
 	}
 	iproto_reply_select(out, &svp, msg->header.sync,
 			    ::schema_version, count, box_tuple_as_ext);
+	tx_compress_reply(msg, out, &svp);
 	iproto_wpos_create(&msg->wpos, out);
 	tx_end_msg(msg, &svp);
 	return;
@@ -2518,6 +2902,31 @@ tx_process_misc(struct cmsg *m)
 	tx_end_msg(msg, &header);
 }
 
+/**
+ * Process IPROTO_PING received via tx_prio_pipe. Runs in the tx
+ * scheduler fiber so it must not yield or touch the fiber session.
+ */
+static void
+tx_process_ping(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *)m;
+	struct iproto_connection *con = msg->connection;
+	tx_accept_wpos(con, &msg->wpos);
+	con->iproto_thread->tx.requests_in_progress++;
+	rmean_collect(con->iproto_thread->tx.rmean, REQUESTS_IN_PROGRESS, 1);
+	flightrec_write_request(msg->reqstart, msg->len);
+	struct obuf *out = con->tx.p_obuf;
+	struct obuf_svp header = obuf_create_svp(out);
+	if (tx_check_msg(msg) != 0) {
+		tx_reply_error(msg);
+		diag_clear(diag_get());
+	} else {
+		iproto_reply_ok(out, msg->header.sync, ::schema_version);
+		iproto_wpos_create(&msg->wpos, out);
+	}
+	tx_end_msg(msg, &header);
+}
+
 static void
 tx_process_sql(struct cmsg *m)
 {
@@ -2900,6 +3309,7 @@ iproto_on_accept_cb(struct evio_service *service, struct iostream *io,
 		(struct iproto_thread *)service->on_accept_param;
 	iproto_thread_accept(iproto_thread, io, addr, addrlen,
 			     /*session=*/NULL);
+	iproto_thread_balance_accept(iproto_thread);
 }
 
 /**
@@ -2921,6 +3331,17 @@ net_cord_f(va_list  ap)
 
 	evio_service_create(loop(), &iproto_thread->binary, "binary",
 			    iproto_on_accept_cb, iproto_thread);
+	ev_timer_init(&iproto_thread->balance_timer,
+		      iproto_thread_balance_timer_cb,
+		      IPROTO_ACCEPT_BALANCE_PERIOD,
+		      IPROTO_ACCEPT_BALANCE_PERIOD);
+	iproto_thread->balance_timer.data = iproto_thread;
+	if (iproto_threads_count > 1)
+		ev_timer_start(loop(), &iproto_thread->balance_timer);
+
+	if (iproto_thread_io_backend == IPROTO_IO_BACKEND_IO_URING &&
+	    ev_backend(loop()) != EVBACKEND_IOURING)
+		say_warn("failed to set up io_uring, falling back on epoll");
 
 	char endpoint_name[ENDPOINT_NAME_MAX];
 	snprintf(endpoint_name, ENDPOINT_NAME_MAX, "net%u",
@@ -2933,11 +3354,15 @@ net_cord_f(va_list  ap)
 	/* Create a pipe to "tx" thread. */
 	cpipe_create(&iproto_thread->tx_pipe, "tx");
 	cpipe_set_max_input(&iproto_thread->tx_pipe, iproto_msg_max / 2);
+	/* Create a pipe to "tx_prio" endpoint. */
+	cpipe_create(&iproto_thread->tx_prio_pipe, "tx_prio");
 
 	/* Process incomming messages. */
 	cbus_loop(&endpoint);
 
+	cpipe_destroy(&iproto_thread->tx_prio_pipe);
 	cpipe_destroy(&iproto_thread->tx_pipe);
+	ev_timer_stop(loop(), &iproto_thread->balance_timer);
 	/*
 	 * Nothing to do in the fiber so far, the service
 	 * will take care of creating events for incoming
@@ -3170,6 +3595,9 @@ iproto_thread_init_routes(struct iproto_thread *iproto_thread)
 	iproto_thread->override_route[0] =
 		{ tx_process_override, &iproto_thread->net_pipe };
 	iproto_thread->override_route[1] = { net_send_msg, NULL };
+	iproto_thread->ping_route[0] =
+		{ tx_process_ping, &iproto_thread->net_pipe };
+	iproto_thread->ping_route[1] = { net_send_msg, NULL };
 };
 
 static inline void
@@ -3184,15 +3612,57 @@ iproto_thread_init(struct iproto_thread *iproto_thread)
 	rlist_create(&iproto_thread->stopped_connections);
 	iproto_thread->tx.requests_in_progress = 0;
 	iproto_thread->requests_in_stream_queue = 0;
+	iproto_thread->busy_connection_count = 0;
+	iproto_thread->connection_count = 0;
+	iproto_thread->is_accept_paused = false;
+}
+
+/** Return libev flags for the given IPROTO event loop backend. */
+static unsigned int
+iproto_io_backend_loop_flags(enum iproto_io_backend backend)
+{
+	switch (backend) {
+	case IPROTO_IO_BACKEND_AUTO:
+		return EVFLAG_AUTO;
+	case IPROTO_IO_BACKEND_EPOLL:
+		return EVBACKEND_EPOLL;
+	case IPROTO_IO_BACKEND_IO_URING:
+		/* libev tries io_uring first. */
+		return EVBACKEND_IOURING | EVBACKEND_EPOLL;
+	default:
+		unreachable();
+	}
+}
+
+bool
+iproto_io_backend_is_supported(enum iproto_io_backend backend)
+{
+	unsigned int flags = iproto_io_backend_loop_flags(backend);
+	if (flags == EVFLAG_AUTO)
+		return true;
+	/* io_uring is supported only if epoll is. */
+	return (ev_supported_backends() & flags) == flags;
 }
 
 /** Initialize the iproto subsystem and start network io thread */
 void
-iproto_init(int threads_count)
+iproto_init(int threads_count, enum iproto_io_backend io_backend)
 {
 	iproto_features_init();
+	for (int type = 0; type < IPROTO_TYPE_STAT_MAX; type++) {
+		for (int i = 0; i < iproto_latency_stage_MAX; i++) {
+			if (latency_create(&tx_latency[type][i]) != 0)
+				panic("failed to allocate latency histogram");
+		}
+	}
+	tx_zctx = ZSTD_createCCtx();
+	if (tx_zctx == NULL)
+		panic("failed to create zstd compression context");
+	ZSTD_CCtx_setParameter(tx_zctx, ZSTD_c_compressionLevel,
+			       IPROTO_COMPRESSION_LEVEL);
 
 	iproto_threads_count = 0;
+	iproto_thread_io_backend = io_backend;
 	struct session_vtab iproto_session_vtab = {
 		/* .push = */ iproto_session_push,
 		/* .fd = */ iproto_session_fd,
@@ -3210,8 +3680,10 @@ iproto_init(int threads_count)
 		struct iproto_thread *iproto_thread = &iproto_threads[i];
 		iproto_thread->id = i;
 		iproto_thread_init(iproto_thread);
-		if (cord_costart(&iproto_thread->net_cord, "iproto",
-				 net_cord_f, iproto_thread))
+		if (cord_costart_with_loop_flags(
+				&iproto_thread->net_cord, "iproto", net_cord_f,
+				iproto_thread,
+				iproto_io_backend_loop_flags(io_backend)))
 			panic("failed to start iproto thread");
 		/* Create a pipe to "net" thread. */
 		char endpoint_name[ENDPOINT_NAME_MAX];
@@ -3339,13 +3811,18 @@ iproto_do_cfg_f(struct cbus_call_msg *m)
 	}
 	case IPROTO_CFG_START:
 		evio_service_attach(binary, &tx_binary);
+		iproto_thread->is_accept_paused = false;
+		iproto_thread_balance_accept(iproto_thread);
 		break;
 	case IPROTO_CFG_STOP:
 		evio_service_detach(binary);
+		iproto_thread->is_accept_paused = false;
 		break;
 	case IPROTO_CFG_RESTART:
 		evio_service_detach(binary);
 		evio_service_attach(binary, &tx_binary);
+		iproto_thread->is_accept_paused = false;
+		iproto_thread_balance_accept(iproto_thread);
 		break;
 	case IPROTO_CFG_STAT:
 		iproto_fill_stat(iproto_thread, cfg_msg);
@@ -3537,6 +4014,33 @@ iproto_reset_stat(void)
 		rmean_cleanup(iproto_threads[i].rmean);
 		rmean_cleanup(iproto_threads[i].tx.rmean);
 	}
+	for (int type = 0; type < IPROTO_TYPE_STAT_MAX; type++) {
+		for (int i = 0; i < iproto_latency_stage_MAX; i++)
+			latency_reset(&tx_latency[type][i]);
+	}
+}
+
+void
+iproto_latency_stat(struct info_handler *h)
+{
+	info_begin(h);
+	for (int type = IPROTO_SELECT; type < IPROTO_TYPE_STAT_MAX; type++) {
+		const char *name = iproto_type_strs[type];
+		if (name == NULL)
+			continue;
+		info_table_begin(h, name);
+		for (int i = 0; i < iproto_latency_stage_MAX; i++) {
+			struct latency *latency = &tx_latency[type][i];
+			info_table_begin(h, iproto_latency_stage_strs[i]);
+			info_append_double(h, "p50", latency_get(latency, 50));
+			info_append_double(h, "p90", latency_get(latency, 90));
+			info_append_double(h, "p99", latency_get(latency, 99));
+			info_append_double(h, "max", latency_get(latency, 100));
+			info_table_end(h);
+		}
+		info_table_end(h);
+	}
+	info_end(h);
 }
 
 int
@@ -3662,6 +4166,11 @@ iproto_free(void)
 		iproto_req_handler_delete(handler);
 	}
 	mh_i32ptr_delete(tx_req_handlers);
+	ZSTD_freeCCtx(tx_zctx);
+	for (int type = 0; type < IPROTO_TYPE_STAT_MAX; type++) {
+		for (int i = 0; i < iproto_latency_stage_MAX; i++)
+			latency_destroy(&tx_latency[type][i]);
+	}
 
 	/*
 	 * Here we close sockets and unlink all unix socket paths.
@@ -40,6 +40,7 @@ struct uri_set;
 struct session;
 struct user;
 struct iostream;
+struct info_handler;
 
 #if defined(__cplusplus)
 extern "C" {
@@ -101,6 +102,13 @@ iproto_thread_stats_get(struct iproto_stats *stats, int thread_id);
 void
 iproto_reset_stat(void);
 
+/**
+ * Report percentiles of the latency of request processing stages
+ * per request type. Reset by iproto_reset_stat().
+ */
+void
+iproto_latency_stat(struct info_handler *h);
+
 /**
  * Return count of the addresses currently served by iproto.
  */
@@ -135,8 +143,33 @@ int
 iproto_override(uint32_t req_type, iproto_handler_t cb,
 		iproto_handler_destroy_t destroy, void *ctx);
 
+/** Event loop backend used by IPROTO threads. */
+enum iproto_io_backend {
+	IPROTO_IO_BACKEND_INVALID = -1,
+	/** Let libev choose the backend, which is epoll on Linux. */
+	IPROTO_IO_BACKEND_AUTO = 0,
+	IPROTO_IO_BACKEND_EPOLL,
+	/**
+	 * Linux io_uring. Socket polling requests are submitted
+	 * along with waiting for events so there is no system call
+	 * per watcher start/stop. Falls back on epoll if io_uring
+	 * can't be set up.
+	 */
+	IPROTO_IO_BACKEND_IO_URING,
+	iproto_io_backend_MAX,
+};
+
+extern const char *iproto_io_backend_strs[];
+
+/**
+ * Return true if the given IPROTO event loop backend is supported
+ * by the system.
+ */
+bool
+iproto_io_backend_is_supported(enum iproto_io_backend backend);
+
 void
-iproto_init(int threads_count);
+iproto_init(int threads_count, enum iproto_io_backend io_backend);
 
 int
 iproto_listen(const struct uri_set *uri_set);
@@ -93,6 +93,7 @@ extern const char *iproto_flag_bit_strs[];
 	_(TSN, 0x08, MP_UINT)						\
 	_(FLAGS, 0x09, MP_UINT)						\
 	_(STREAM_ID, 0x0a, MP_UINT)					\
+	_(WAIT_VCLOCK, 0x0b, MP_MAP)					\
 	/* Leave a gap for other keys in the header. */			\
 	_(SPACE_ID, 0x10, MP_UINT)					\
 	_(INDEX_ID, 0x11, MP_UINT)					\
@@ -214,7 +215,13 @@ extern const char *iproto_flag_bit_strs[];
 	 * Mapping of format identifier to format clause consisting of field
 	 * names and field types.
 	 */								\
-	_(TUPLE_FORMATS, 0x60, MP_MAP)
+	_(TUPLE_FORMATS, 0x60, MP_MAP)					\
+	/**
+	 * Response body compressed with zstd. Replaces the whole body of
+	 * a response to a client that supports the RESPONSE_COMPRESSION
+	 * protocol feature.
+	 */								\
+	_(COMPRESSED_BODY, 0x61, MP_BIN)
 
 #define IPROTO_KEY_MEMBER(s, v, ...) IPROTO_ ## s = v,
 
@@ -392,6 +399,14 @@ iproto_key_bit(unsigned char key)
 	 * VY_INDEX_RUN_INFO = 100
 	 * VY_INDEX_PAGE_INFO = 101
 	 * VY_RUN_ROW_INDEX = 102
+	 *
+	 * The following request is reserved for memtx snapshots.
+	 *
+	 * MEMTX_INDEX_ORDER = 103
+	 *
+	 * The following request is reserved for xlog files.
+	 *
+	 * XLOG_DICTIONARY = 104
 	 */								\
 									\
 	/** Non-final response type. */					\
@@ -418,6 +433,10 @@ enum iproto_type {
 	VY_INDEX_PAGE_INFO = 101,
 	/** Vinyl row index stored in .run file */
 	VY_RUN_ROW_INDEX = 102,
+	/** Secondary memtx index order stored in .snap file */
+	MEMTX_INDEX_ORDER = 103,
+	/** Compression dictionary stored at the beginning of .xlog file */
+	XLOG_DICTIONARY = 104,
 };
 
 /** IPROTO type name by code */
@@ -458,6 +477,10 @@ iproto_type_name(uint16_t type)
 		return "PAGEINFO";
 	case VY_RUN_ROW_INDEX:
 		return "ROWINDEX";
+	case MEMTX_INDEX_ORDER:
+		return "INDEXORDER";
+	case XLOG_DICTIONARY:
+		return "DICTIONARY";
 	default:
 		return NULL;
 	}
@@ -579,6 +602,8 @@ request_replace_body_create(struct request_replace_body *body,
 	_(BLOOM_FILTER, 7)						\
 	/** Number of statements of each type (map). */			\
 	_(STMT_STAT, 8)							\
+	/** Bloom filter for keys that uses xor filters. */		\
+	_(XOR_FILTER, 9)						\
 
 #define VY_RUN_INFO_KEY_MEMBER(s, v) VY_RUN_INFO_ ## s = v,
 
@@ -85,4 +85,8 @@ iproto_features_init(void)
 			    IPROTO_FEATURE_CALL_RET_TUPLE_EXTENSION);
 	iproto_features_set(&IPROTO_CURRENT_FEATURES,
 			    IPROTO_FEATURE_CALL_ARG_TUPLE_EXTENSION);
+	iproto_features_set(&IPROTO_CURRENT_FEATURES,
+			    IPROTO_FEATURE_RESPONSE_COMPRESSION);
+	iproto_features_set(&IPROTO_CURRENT_FEATURES,
+			    IPROTO_FEATURE_WAIT_VCLOCK);
 }
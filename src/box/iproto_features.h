@@ -77,6 +77,20 @@ extern "C" {
 	 * tuple formats are received in IPROTO_TUPLE_FORMATS field.
 	 */								\
 	_(CALL_ARG_TUPLE_EXTENSION, 9)					\
+	/**
+	 * Response body compression support: the body of a big response
+	 * to IPROTO_SELECT, IPROTO_CALL or IPROTO_EVAL may be replaced with
+	 * the IPROTO_COMPRESSED_BODY field storing the original body
+	 * compressed with zstd. The server compresses responses only for
+	 * clients that set this feature bit.
+	 */								\
+	_(RESPONSE_COMPRESSION, 10)					\
+	/**
+	 * IPROTO_WAIT_VCLOCK header key support: a request may ask the
+	 * server to wait until its vclock reaches the given one before
+	 * processing the request.
+	 */								\
+	_(WAIT_VCLOCK, 11)						\
 
 #define IPROTO_FEATURE_MEMBER(s, v) IPROTO_FEATURE_ ## s = v,
 
@@ -101,7 +115,7 @@ struct iproto_features {
  * `box.iproto.protocol_version` needs to be updated correspondingly.
  */
 enum {
-	IPROTO_CURRENT_VERSION = 7,
+	IPROTO_CURRENT_VERSION = 9,
 };
 
 /**
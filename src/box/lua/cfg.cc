@@ -136,6 +136,22 @@ lbox_cfg_set_snap_io_rate_limit(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_snap_io_latency_target(struct lua_State *L)
+{
+	if (box_set_snap_io_latency_target() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_snapshot_index_order(struct lua_State *L)
+{
+	(void)L;
+	box_set_memtx_snapshot_index_order();
+	return 0;
+}
+
 static int
 lbox_cfg_set_checkpoint_count(struct lua_State *L)
 {
@@ -177,6 +193,22 @@ lbox_cfg_set_wal_queue_max_size(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_wal_compression_dictionary(struct lua_State *L)
+{
+	(void)L;
+	box_set_wal_compression_dictionary();
+	return 0;
+}
+
+static int
+lbox_cfg_set_wal_commit_delay(struct lua_State *L)
+{
+	if (box_set_wal_commit_delay() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_wal_cleanup_delay(struct lua_State *L)
 {
@@ -251,6 +283,17 @@ lbox_cfg_set_vinyl_cache(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_page_cache(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_page_cache();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 {
@@ -464,6 +507,14 @@ lbox_cfg_set_txn_timeout(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_expiration_rate(struct lua_State *L)
+{
+	if (box_set_expiration_rate() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_txn_isolation(struct lua_State *L)
 {
@@ -501,10 +552,17 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_io_collect_interval", lbox_cfg_set_io_collect_interval},
 		{"cfg_set_too_long_threshold", lbox_cfg_set_too_long_threshold},
 		{"cfg_set_snap_io_rate_limit", lbox_cfg_set_snap_io_rate_limit},
+		{"cfg_set_snap_io_latency_target",
+			lbox_cfg_set_snap_io_latency_target},
+		{"cfg_set_memtx_snapshot_index_order",
+			lbox_cfg_set_memtx_snapshot_index_order},
 		{"cfg_set_checkpoint_count", lbox_cfg_set_checkpoint_count},
 		{"cfg_set_checkpoint_interval", lbox_cfg_set_checkpoint_interval},
 		{"cfg_set_checkpoint_wal_threshold", lbox_cfg_set_checkpoint_wal_threshold},
 		{"cfg_set_wal_queue_max_size", lbox_cfg_set_wal_queue_max_size},
+		{"cfg_set_wal_compression_dictionary",
+			lbox_cfg_set_wal_compression_dictionary},
+		{"cfg_set_wal_commit_delay", lbox_cfg_set_wal_commit_delay},
 		{"cfg_set_wal_cleanup_delay", lbox_cfg_set_wal_cleanup_delay},
 		{"cfg_set_read_only", lbox_cfg_set_read_only},
 		{"cfg_set_memtx_memory", lbox_cfg_set_memtx_memory},
@@ -512,6 +570,7 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_vinyl_memory", lbox_cfg_set_vinyl_memory},
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_cache", lbox_cfg_set_vinyl_cache},
+		{"cfg_set_vinyl_page_cache", lbox_cfg_set_vinyl_page_cache},
 		{"cfg_set_vinyl_timeout", lbox_cfg_set_vinyl_timeout},
 		{"cfg_set_force_recovery", lbox_cfg_set_force_recovery},
 		{"cfg_set_election_mode", lbox_cfg_set_election_mode},
@@ -533,6 +592,7 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_sql_cache_size", lbox_set_prepared_stmt_cache_size},
 		{"cfg_set_feedback", lbox_cfg_set_feedback},
 		{"cfg_set_txn_timeout", lbox_cfg_set_txn_timeout},
+		{"cfg_set_expiration_rate", lbox_cfg_set_expiration_rate},
 		{"cfg_set_txn_isolation", lbox_cfg_set_txn_isolation},
 		{"cfg_set_auth_type", lbox_cfg_set_auth_type},
 		{"cfg_get_force_recovery", lbox_cfg_get_force_recovery},
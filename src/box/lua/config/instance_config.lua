@@ -502,6 +502,12 @@ return schema.new('instance_config', schema.record({
             mk_parent_dir = true,
             default = 'var/run/{{ instance_name }}/tarantool.pid',
         }),
+        cpu_affinity = schema.scalar({
+            type = 'string',
+            box_cfg = 'cpu_affinity',
+            box_cfg_nondynamic = true,
+            default = box.NULL,
+        }),
     }),
     console = schema.record({
         enabled = schema.scalar({
@@ -600,6 +606,12 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = false,
         }),
+        async = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'log_async',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
         level = schema.scalar({
             type = 'number, string',
             box_cfg = 'log_level',
@@ -760,6 +772,15 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = 1,
         }),
+        io_backend = schema.enum({
+            'auto',
+            'epoll',
+            'io_uring',
+        }, {
+            box_cfg = 'iproto_io_backend',
+            box_cfg_nondynamic = true,
+            default = 'auto',
+        }),
         net_msg_max = schema.scalar({
             type = 'integer',
             box_cfg = 'net_msg_max',
@@ -811,6 +832,13 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'txn_timeout',
             default = 365 * 100 * 86400,
         }),
+        -- Max number of expired tuples deleted per second,
+        -- 0 means unlimited. See the ttl_field space option.
+        expiration_rate = schema.scalar({
+            type = 'number',
+            box_cfg = 'expiration_rate',
+            default = 10000,
+        }),
         txn_isolation = schema.enum({
             'read-committed',
             'read-confirmed',
@@ -876,6 +904,17 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = box.NULL,
         }),
+        use_hugepages = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'memtx_use_hugepages',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
+        snapshot_index_order = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'memtx_snapshot_index_order',
+            default = false,
+        }),
     }),
     vinyl = schema.record({
         bloom_fpr = schema.scalar({
@@ -911,6 +950,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'vinyl_memory',
             default = 128 * 1024 * 1024,
         }),
+        page_cache = schema.scalar({
+            type = 'integer',
+            box_cfg = 'vinyl_page_cache',
+            default = 0,
+        }),
         page_size = schema.scalar({
             type = 'integer',
             box_cfg = 'vinyl_page_size',
@@ -986,11 +1030,21 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'wal_queue_max_size',
             default = 16 * 1024 * 1024,
         }),
+        commit_delay = schema.scalar({
+            type = 'number',
+            box_cfg = 'wal_commit_delay',
+            default = 0,
+        }),
         cleanup_delay = schema.scalar({
             type = 'number',
             box_cfg = 'wal_cleanup_delay',
             default = 4 * 3600,
         }),
+        compression_dictionary = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'wal_compression_dictionary',
+            default = false,
+        }),
         -- box.cfg({wal_ext = <...>}) replaces the previous
         -- value without any merging. See explanation why it is
         -- important in the log.modules description.
@@ -1064,6 +1118,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'snap_io_rate_limit',
             default = box.NULL,
         }),
+        snap_io_latency_target = schema.scalar({
+            type = 'number',
+            box_cfg = 'snap_io_latency_target',
+            default = box.NULL,
+        }),
     }),
     replication = schema.record({
         failover = schema.enum({
@@ -34,9 +34,11 @@
 #include "info/info.h"
 #include "box/box.h"
 #include "box/index.h"
+#include "box/tuple.h"
 #include "box/lua/tuple.h"
 #include "box/lua/misc.h"
 #include "small/region.h"
+#include "msgpuck.h"
 #include "fiber.h"
 
 /** {{{ box.index Lua library: access to spaces and indexes
@@ -82,6 +84,42 @@ lbox_replace(lua_State *L)
 	return rc == 0 ? luaT_pushtupleornil(L, result) : luaT_error(L);
 }
 
+static int
+lbox_insert_batch(lua_State *L)
+{
+	if (lua_gettop(L) != 2 || !lua_isnumber(L, 1))
+		return luaL_error(L, "Usage space:insert_batch(tuples)");
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	size_t tuples_len;
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *tuples = lbox_encode_tuple_on_gc(L, 2, &tuples_len);
+	if (tuples == NULL)
+		return luaT_error(L);
+
+	int rc = box_insert_batch(space_id, tuples, tuples + tuples_len);
+	region_truncate(&fiber()->gc, region_svp);
+	return rc == 0 ? 0 : luaT_error(L);
+}
+
+static int
+lbox_replace_batch(lua_State *L)
+{
+	if (lua_gettop(L) != 2 || !lua_isnumber(L, 1))
+		return luaL_error(L, "Usage space:replace_batch(tuples)");
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	size_t tuples_len;
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *tuples = lbox_encode_tuple_on_gc(L, 2, &tuples_len);
+	if (tuples == NULL)
+		return luaT_error(L);
+
+	int rc = box_replace_batch(space_id, tuples, tuples + tuples_len);
+	region_truncate(&fiber()->gc, region_svp);
+	return rc == 0 ? 0 : luaT_error(L);
+}
+
 static int
 lbox_index_update(lua_State *L)
 {
@@ -197,6 +235,42 @@ lbox_index_get(lua_State *L)
 	return rc == 0 ? luaT_pushtupleornil(L, tuple) : luaT_error(L);
 }
 
+static int
+lbox_index_get_batch(lua_State *L)
+{
+	if (lua_gettop(L) != 3 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2))
+		return luaL_error(L, "Usage index.get_batch(space_id, index_id, "
+				  "keys)");
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+	size_t keys_len;
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *keys = lbox_encode_tuple_on_gc(L, 3, &keys_len);
+	if (keys == NULL)
+		return luaT_error(L);
+
+	const char *data = keys;
+	uint32_t count = mp_decode_array(&data);
+	struct tuple **results = xregion_alloc_array(&fiber()->gc,
+						     struct tuple *, count);
+	if (box_index_get_batch(space_id, index_id, keys, keys + keys_len,
+				results) != 0) {
+		region_truncate(&fiber()->gc, region_svp);
+		return luaT_error(L);
+	}
+	lua_createtable(L, count, 0);
+	for (uint32_t i = 0; i < count; i++) {
+		if (results[i] == NULL)
+			continue;
+		luaT_pushtuple(L, results[i]);
+		lua_rawseti(L, -2, i + 1);
+		tuple_unref(results[i]);
+	}
+	region_truncate(&fiber()->gc, region_svp);
+	return 1;
+}
+
 static int
 lbox_index_min(lua_State *L)
 {
@@ -398,11 +472,14 @@ box_lua_index_init(struct lua_State *L)
 	static const struct luaL_Reg boxlib_internal[] = {
 		{"insert", lbox_insert},
 		{"replace",  lbox_replace},
+		{"insert_batch", lbox_insert_batch},
+		{"replace_batch", lbox_replace_batch},
 		{"update", lbox_index_update},
 		{"upsert",  lbox_upsert},
 		{"delete",  lbox_index_delete},
 		{"random", lbox_index_random},
 		{"get",  lbox_index_get},
+		{"get_batch", lbox_index_get_batch},
 		{"min", lbox_index_min},
 		{"max", lbox_index_max},
 		{"count", lbox_index_count},
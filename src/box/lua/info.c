@@ -58,6 +58,7 @@
 #include "lua/serializer.h" /* luaL_setmaphint */
 #include "fiber.h"
 #include "sio.h"
+#include "say.h"
 #include "tt_strerror.h"
 #include "tweaks.h"
 
@@ -159,6 +160,12 @@ lbox_pushrelay(lua_State *L, struct relay *relay)
 		lua_pushstring(L, "lag");
 		lua_pushnumber(L, relay_txn_lag(relay));
 		lua_settable(L, -3);
+		lua_pushstring(L, "bytes_sent");
+		luaL_pushuint64(L, relay_sent_bytes(relay));
+		lua_settable(L, -3);
+		lua_pushstring(L, "writes");
+		luaL_pushuint64(L, relay_write_count(relay));
+		lua_settable(L, -3);
 		break;
 	case RELAY_STOPPED:
 	{
@@ -653,6 +660,35 @@ lbox_info_sql(struct lua_State *L)
 	return 1;
 }
 
+static int
+lbox_info_snap_io(struct lua_State *L)
+{
+	struct wal_io_stat stat;
+	wal_get_io_stat(&stat);
+	lua_createtable(L, 0, 3);
+	lua_pushnumber(L, stat.latency_target);
+	lua_setfield(L, -2, "latency_target");
+	lua_pushnumber(L, stat.latency);
+	lua_setfield(L, -2, "wal_latency");
+	luaL_pushuint64(L, stat.rate_limit);
+	lua_setfield(L, -2, "rate_limit");
+	return 1;
+}
+
+static int
+lbox_info_log(struct lua_State *L)
+{
+	uint64_t dropped;
+	size_t pending;
+	say_logger_stat(&dropped, &pending);
+	lua_createtable(L, 0, 2);
+	luaL_pushuint64(L, dropped);
+	lua_setfield(L, -2, "dropped");
+	luaL_pushuint64(L, pending);
+	lua_setfield(L, -2, "pending");
+	return 1;
+}
+
 static int
 lbox_info_listen(struct lua_State *L)
 {
@@ -770,6 +806,8 @@ static const struct luaL_Reg lbox_info_dynamic_meta[] = {
 	{"gc", lbox_info_gc},
 	{"vinyl", lbox_info_vinyl},
 	{"sql", lbox_info_sql},
+	{"snap_io", lbox_info_snap_io},
+	{"log", lbox_info_log},
 	{"listen", lbox_info_listen},
 	{"election", lbox_info_election},
 	{"synchro", lbox_info_synchro},
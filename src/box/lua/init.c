@@ -666,20 +666,40 @@ lbox_backup_cb(const char *path, void *cb_arg)
 	return 0;
 }
 
+/**
+ * box.backup.start([checkpoint_idx], [{since = <token>}])
+ *
+ * The token is the signature of the checkpoint of a previous
+ * backup, see box_backup_start().
+ */
 static int
 lbox_backup_start(struct lua_State *L)
 {
 	int checkpoint_idx = 0;
-	if (lua_gettop(L) > 0) {
+	int64_t since = -1;
+	int opts_idx = 1;
+	if (lua_gettop(L) > 0 && !lua_istable(L, 1)) {
 		checkpoint_idx = luaL_checkint(L, 1);
 		if (checkpoint_idx < 0)
 			return luaL_error(L, "invalid checkpoint index");
+		opts_idx = 2;
+	}
+	if (!lua_isnoneornil(L, opts_idx)) {
+		luaL_checktype(L, opts_idx, LUA_TTABLE);
+		lua_getfield(L, opts_idx, "since");
+		if (!lua_isnil(L, -1)) {
+			since = luaL_checkint64(L, -1);
+			if (since < 0)
+				return luaL_error(L, "invalid backup token");
+		}
+		lua_pop(L, 1);
 	}
 	lua_newtable(L);
 	struct lbox_backup_arg arg = {
 		.L = L,
 	};
-	if (box_backup_start(checkpoint_idx, lbox_backup_cb, &arg) != 0)
+	if (box_backup_start(checkpoint_idx, since,
+			     lbox_backup_cb, &arg) != 0)
 		return luaT_error(L);
 	return 1;
 }
@@ -87,6 +87,7 @@ local default_cfg = {
     slab_alloc_granularity = 8,
     slab_alloc_factor   = 1.05,
     iproto_threads      = 1,
+    iproto_io_backend   = 'auto',
     memtx_allocator     = "small",
     work_dir            = nil,
     memtx_dir           = ".",
@@ -95,6 +96,7 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 0,
     vinyl_max_tuple_size = 1024 * 1024,
     vinyl_read_threads  = 1,
     vinyl_write_threads = 4,
@@ -108,6 +110,7 @@ local default_cfg = {
 
     log                 = log.cfg.log,
     log_nonblock        = log.cfg.nonblock,
+    log_async           = log.cfg.async,
     log_level           = log.cfg.level,
     log_modules         = log.cfg.modules,
     log_format          = log.cfg.format,
@@ -145,12 +148,15 @@ local default_cfg = {
     io_collect_interval = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
+    snap_io_latency_target = nil, -- no adaptive limit
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     wal_max_size        = 256 * 1024 * 1024,
     wal_dir_rescan_delay= 2,
     wal_queue_max_size  = 16 * 1024 * 1024,
+    wal_commit_delay    = 0,
     wal_cleanup_delay   = 4 * 3600,
+    wal_compression_dictionary = false,
     wal_ext             = ifdef_wal_ext(nil),
     force_recovery      = false,
     replication         = nil,
@@ -164,9 +170,12 @@ local default_cfg = {
     background          = false,
     username            = nil,
     coredump            = false,
+    cpu_affinity        = nil,
     read_only           = false,
     hot_standby         = false,
     memtx_use_mvcc_engine = false,
+    memtx_use_hugepages = false,
+    memtx_snapshot_index_order = false,
     checkpoint_interval = 3600,
     checkpoint_wal_threshold = 1e18,
     checkpoint_count    = 2,
@@ -196,6 +205,7 @@ local default_cfg = {
     net_msg_max           = 768,
     sql_cache_size        = 5 * 1024 * 1024,
     txn_timeout           = 365 * 100 * 86400,
+    expiration_rate       = 10000,
     txn_isolation         = "best-effort",
     memtx_sort_threads    = nil,
 
@@ -287,6 +297,7 @@ local template_cfg = {
     slab_alloc_granularity = 'number',
     slab_alloc_factor   = 'number',
     iproto_threads      = 'number',
+    iproto_io_backend   = 'string',
     memtx_allocator     = 'string',
     work_dir            = 'string',
     memtx_dir            = 'string',
@@ -294,6 +305,7 @@ local template_cfg = {
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
     vinyl_max_tuple_size      = 'number',
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
@@ -307,6 +319,7 @@ local template_cfg = {
 
     log                 = 'string',
     log_nonblock        = 'boolean',
+    log_async           = 'boolean',
     log_level           = 'number, string',
     log_modules         = 'table',
     log_format          = 'string',
@@ -344,11 +357,13 @@ local template_cfg = {
     io_collect_interval = 'number',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
+    snap_io_latency_target = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     wal_max_size        = 'number',
     wal_dir_rescan_delay= 'number',
     wal_cleanup_delay   = 'number',
+    wal_compression_dictionary = 'boolean',
     wal_ext             = ifdef_wal_ext('table'),
     force_recovery      = 'boolean',
     replication         = 'string, number, table',
@@ -361,14 +376,18 @@ local template_cfg = {
     pid_file            = 'string',
     background          = 'boolean',
     username            = 'string',
+    cpu_affinity        = 'string',
     coredump            = 'boolean',
     checkpoint_interval = 'number',
     checkpoint_wal_threshold = 'number',
     wal_queue_max_size  = 'number',
+    wal_commit_delay    = 'number',
     checkpoint_count    = 'number',
     read_only           = 'boolean',
     hot_standby         = 'boolean',
     memtx_use_mvcc_engine = 'boolean',
+    memtx_use_hugepages = 'boolean',
+    memtx_snapshot_index_order = 'boolean',
     txn_isolation = 'string, number',
     worker_pool_threads = 'number',
     election_mode       = 'string',
@@ -396,6 +415,7 @@ local template_cfg = {
     net_msg_max           = 'number',
     sql_cache_size        = 'number',
     txn_timeout           = 'number',
+    expiration_rate       = 'number',
     memtx_sort_threads    = 'number',
 
     metrics = 'table',
@@ -481,22 +501,27 @@ local dynamic_cfg = {
     readahead               = private.cfg_set_readahead,
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
+    snap_io_latency_target  = private.cfg_set_snap_io_latency_target,
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
+    memtx_snapshot_index_order = private.cfg_set_memtx_snapshot_index_order,
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
+    vinyl_page_cache        = private.cfg_set_vinyl_page_cache,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
     vinyl_defer_deletes     = nop,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
     checkpoint_wal_threshold = private.cfg_set_checkpoint_wal_threshold,
     wal_queue_max_size      = private.cfg_set_wal_queue_max_size,
+    wal_commit_delay        = private.cfg_set_wal_commit_delay,
     worker_pool_threads     = private.cfg_set_worker_pool_threads,
     -- do nothing, affects new replicas, which query this value on start
     wal_dir_rescan_delay    = nop,
     wal_cleanup_delay       = private.cfg_set_wal_cleanup_delay,
+    wal_compression_dictionary = private.cfg_set_wal_compression_dictionary,
     custom_proc_title       = function()
         require('title').update(box.cfg.custom_proc_title)
     end,
@@ -522,6 +547,7 @@ local dynamic_cfg = {
     net_msg_max             = private.cfg_set_net_msg_max,
     sql_cache_size          = private.cfg_set_sql_cache_size,
     txn_timeout             = private.cfg_set_txn_timeout,
+    expiration_rate         = private.cfg_set_expiration_rate,
     txn_isolation           = private.cfg_set_txn_isolation,
     auth_type               = private.cfg_set_auth_type,
     auth_delay              = private.cfg_set_security,
@@ -597,6 +623,7 @@ local dynamic_cfg_modules = {
             log_modules = true,
             log_format = true,
             log_nonblock = true,
+            log_async = true,
         },
         skip_at_load = true,
     }
@@ -661,6 +688,7 @@ local dynamic_cfg_skip_at_load = {
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
+    vinyl_page_cache        = true,
     vinyl_timeout           = true,
     too_long_threshold      = true,
     election_mode           = true,
@@ -39,6 +39,7 @@
 #include "box/authentication.h"
 #include "box/box.h"
 #include "box/errcode.h"
+#include "box/index.h"
 #include "box/lua/tuple.h"
 #include "box/port.h"
 #include "box/read_view.h"
@@ -375,6 +376,22 @@ lbox_txn_set_isolation(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Lua/C wrapper over txn_make_read_only.
+ */
+static int
+lbox_txn_make_read_only(struct lua_State *L)
+{
+	struct txn *txn = in_txn();
+	int rc = -1;
+	if (txn == NULL)
+		diag_set(ClientError, ER_NO_TRANSACTION);
+	else
+		rc = txn_make_read_only(txn);
+	lua_pushnumber(L, rc);
+	return 1;
+}
+
 /** {{{ Read view utils. **/
 
 void
@@ -435,6 +452,182 @@ lbox_read_view_status(struct lua_State *L)
 	return 1;
 }
 
+static const char *read_view_handle_typename = "box.read_view.handle";
+static const char *read_view_iterator_typename = "box.read_view.iterator";
+
+/**
+ * Handle of a read view opened with box.read_view.open(). The read view
+ * object keeps a reference to it so that the read view is closed when
+ * the object is garbage collected.
+ */
+struct lbox_read_view_handle {
+	/** Read view id. */
+	uint64_t id;
+};
+
+/** Pushes a map of read view spaces by id and name to the Lua stack. */
+static void
+lbox_push_read_view_spaces(struct lua_State *L, struct read_view *rv)
+{
+	lua_newtable(L);
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, rv) {
+		lua_newtable(L);
+		lua_pushinteger(L, space_rv->id);
+		lua_setfield(L, -2, "id");
+		lua_pushstring(L, space_rv->name);
+		lua_setfield(L, -2, "name");
+		lua_newtable(L);
+		for (uint32_t i = 0; i <= space_rv->index_id_max; i++) {
+			struct index_read_view *index_rv =
+				space_read_view_index(space_rv, i);
+			if (index_rv == NULL)
+				continue;
+			lua_newtable(L);
+			lua_pushinteger(L, i);
+			lua_setfield(L, -2, "id");
+			lua_pushstring(L, index_rv->def->name);
+			lua_setfield(L, -2, "name");
+			lua_pushstring(L, index_type_strs[index_rv->def->type]);
+			lua_setfield(L, -2, "type");
+			lua_pushvalue(L, -1);
+			lua_rawseti(L, -3, i);
+			lua_setfield(L, -2, index_rv->def->name);
+		}
+		lua_setfield(L, -2, "index");
+		lua_pushvalue(L, -1);
+		lua_rawseti(L, -3, space_rv->id);
+		lua_setfield(L, -2, space_rv->name);
+	}
+}
+
+/**
+ * Opens a read view of all memtx spaces. Takes the read view name.
+ * Pushes the read view info table extended with the 'space' field
+ * that maps space ids and names to space descriptions, and the read
+ * view handle.
+ */
+static int
+lbox_read_view_open(struct lua_State *L)
+{
+	const char *name = luaL_optstring(L, 1, "unknown");
+	box_read_view_t *rv = box_read_view_open(name);
+	if (rv == NULL)
+		return luaT_error(L);
+	struct read_view *base = box_read_view_base(rv);
+	lbox_push_read_view(L, base);
+	lbox_push_read_view_spaces(L, base);
+	lua_setfield(L, -2, "space");
+	struct lbox_read_view_handle *handle =
+		(struct lbox_read_view_handle *)lua_newuserdata(
+			L, sizeof(*handle));
+	handle->id = base->id;
+	luaL_getmetatable(L, read_view_handle_typename);
+	lua_setmetatable(L, -2);
+	return 2;
+}
+
+/**
+ * Given a read view object, closes the read view if it was opened with
+ * box.read_view.open() and returns true. System read views can't be
+ * closed by the user so false is returned for them.
+ */
+static int
+lbox_read_view_destroy(struct lua_State *L)
+{
+	lua_getfield(L, 1, "id");
+	uint64_t id = luaL_checkuint64(L, -1);
+	box_read_view_t *rv = box_read_view_by_id(id);
+	if (rv == NULL) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+	box_read_view_close(rv);
+	lua_pushboolean(L, true);
+	return 1;
+}
+
+/** Closes the read view if it's still open. */
+static int
+lbox_read_view_handle_gc(struct lua_State *L)
+{
+	struct lbox_read_view_handle *handle =
+		(struct lbox_read_view_handle *)luaL_checkudata(
+			L, 1, read_view_handle_typename);
+	box_read_view_t *rv = box_read_view_by_id(handle->id);
+	if (rv != NULL)
+		box_read_view_close(rv);
+	return 0;
+}
+
+static inline box_read_view_iterator_t **
+luaT_check_read_view_iterator(struct lua_State *L, int idx)
+{
+	return (box_read_view_iterator_t **)
+		luaL_checkudata(L, idx, read_view_iterator_typename);
+}
+
+/**
+ * Creates an iterator over all tuples stored in a read view index.
+ * Takes the read view id, the space id, and the index id.
+ */
+static int
+lbox_read_view_iterator_create(struct lua_State *L)
+{
+	uint64_t id = luaL_checkuint64(L, 1);
+	uint32_t space_id = luaL_checkinteger(L, 2);
+	uint32_t index_id = luaL_checkinteger(L, 3);
+	box_read_view_t *rv = box_read_view_by_id(id);
+	if (rv == NULL)
+		return luaL_error(L, "read view is closed");
+	box_read_view_iterator_t **it =
+		(box_read_view_iterator_t **)lua_newuserdata(L, sizeof(*it));
+	*it = NULL;
+	luaL_getmetatable(L, read_view_iterator_typename);
+	lua_setmetatable(L, -2);
+	if (box_read_view_iterator_all(rv, space_id, index_id, it) != 0)
+		return luaT_error(L);
+	return 1;
+}
+
+/**
+ * Takes an iterator step. Pushes the next tuple or nothing if
+ * the iterator is exhausted. Raises an error if the read view
+ * was closed while the iterator was in use.
+ */
+static int
+lbox_read_view_iterator_next(struct lua_State *L)
+{
+	box_read_view_iterator_t *it = *luaT_check_read_view_iterator(L, 1);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *data;
+	uint32_t size;
+	if (box_read_view_iterator_next_raw(it, &data, &size) != 0) {
+		region_truncate(region, region_svp);
+		return luaT_error(L);
+	}
+	if (data == NULL)
+		return 0;
+	struct tuple *tuple = tuple_new(box_read_view_iterator_format(it),
+					data, data + size);
+	region_truncate(region, region_svp);
+	if (tuple == NULL)
+		return luaT_error(L);
+	luaT_pushtuple(L, tuple);
+	return 1;
+}
+
+/** Destroys an iterator. */
+static int
+lbox_read_view_iterator_gc(struct lua_State *L)
+{
+	box_read_view_iterator_t *it = *luaT_check_read_view_iterator(L, 1);
+	if (it != NULL)
+		box_read_view_iterator_free(it);
+	return 0;
+}
+
 /* }}} */
 
 void
@@ -444,8 +637,13 @@ box_lua_misc_init(struct lua_State *L)
 		{"prepare_auth", lbox_prepare_auth},
 		{"select", lbox_select},
 		{"txn_set_isolation", lbox_txn_set_isolation},
+		{"txn_make_read_only", lbox_txn_make_read_only},
 		{"read_view_list", lbox_read_view_list},
 		{"read_view_status", lbox_read_view_status},
+		{"read_view_open", lbox_read_view_open},
+		{"read_view_destroy", lbox_read_view_destroy},
+		{"read_view_iterator_create", lbox_read_view_iterator_create},
+		{"read_view_iterator_next", lbox_read_view_iterator_next},
 		{"generate_space_id", lbox_generate_space_id},
 		{NULL, NULL}
 	};
@@ -453,4 +651,18 @@ box_lua_misc_init(struct lua_State *L)
 	luaL_findtable(L, LUA_GLOBALSINDEX, "box.internal", 0);
 	luaL_setfuncs(L, boxlib_internal, 0);
 	lua_pop(L, 1);
+
+	static const struct luaL_Reg read_view_handle_methods[] = {
+		{"__gc", lbox_read_view_handle_gc},
+		{NULL, NULL}
+	};
+	luaL_register_type(L, read_view_handle_typename,
+			   read_view_handle_methods);
+
+	static const struct luaL_Reg read_view_iterator_methods[] = {
+		{"__gc", lbox_read_view_iterator_gc},
+		{NULL, NULL}
+	};
+	luaL_register_type(L, read_view_iterator_typename,
+			   read_view_iterator_methods);
 }
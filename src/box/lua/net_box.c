@@ -37,6 +37,7 @@
 #include <stdint.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <zstd.h>
 
 #include "box/authentication.h"
 #include "box/errcode.h"
@@ -82,7 +83,7 @@ enum {
 	/**
 	 * IPROTO protocol version supported by the netbox connector.
 	 */
-	NETBOX_IPROTO_VERSION = 7,
+	NETBOX_IPROTO_VERSION = 8,
 };
 
 /**
@@ -90,6 +91,9 @@ enum {
  */
 static struct iproto_features NETBOX_IPROTO_FEATURES;
 
+/** Context used for decompression of response bodies. */
+static ZSTD_DCtx *netbox_zdctx;
+
 #define NETBOX_METHODS(_)						\
 	_(PING)								\
 	_(CALL)								\
@@ -178,6 +182,11 @@ struct netbox_options {
 	 * Flag that determines is it required to fetch server schema or not.
 	 */
 	 bool fetch_schema;
+	/**
+	 * Flag that determines whether the server is allowed to compress
+	 * response bodies.
+	 */
+	bool response_compression;
 };
 
 /**
@@ -273,6 +282,8 @@ struct netbox_transport {
 	struct ibuf recv_buf;
 	/** Size of the last received message. */
 	size_t last_msg_size;
+	/** Buffer for the last decompressed response body. */
+	struct ibuf zbuf;
 	/** Signalled when send_buf becomes empty. */
 	struct fiber_cond on_send_buf_empty;
 	/** Next request id. */
@@ -362,6 +373,13 @@ struct netbox_method_encode_ctx {
 	uint64_t sync;
 	/* Current transport's IPROTO stream identifier. */
 	uint64_t stream_id;
+	/*
+	 * Vclock the server must reach before processing the request
+	 * (IPROTO_WAIT_VCLOCK) or NULL.
+	 */
+	const struct vclock *wait_vclock;
+	/* Timeout of waiting for wait_vclock on the server. */
+	double wait_timeout;
 	/*
 	 * Whether box tuples should be encoded to MsgPack as MP_TUPLE
 	 * extension.
@@ -544,6 +562,7 @@ netbox_transport_create(struct netbox_transport *transport)
 	ibuf_create(&transport->send_buf, &cord()->slabc, NETBOX_READAHEAD);
 	ibuf_create(&transport->recv_buf, &cord()->slabc, NETBOX_READAHEAD);
 	transport->last_msg_size = 0;
+	ibuf_create(&transport->zbuf, &cord()->slabc, NETBOX_READAHEAD);
 	fiber_cond_create(&transport->on_send_buf_empty);
 	transport->next_sync = 1;
 	transport->requests = mh_i64ptr_new();
@@ -563,6 +582,7 @@ netbox_transport_destroy(struct netbox_transport *transport)
 	assert(!iostream_is_initialized(&transport->io));
 	assert(ibuf_used(&transport->send_buf) == 0);
 	assert(ibuf_used(&transport->recv_buf) == 0);
+	ibuf_destroy(&transport->zbuf);
 	fiber_cond_destroy(&transport->on_send_buf_empty);
 	struct mh_i64ptr_t *h = transport->requests;
 	assert(mh_size(h) == 0);
@@ -616,9 +636,15 @@ netbox_transport_set_error(struct netbox_transport *transport)
 	transport->inprogress_request_count = 0;
 }
 
+/**
+ * Writes the fixheader placeholder and the request header to the stream.
+ * If @a wait_vclock isn't NULL, the header also has IPROTO_WAIT_VCLOCK
+ * and IPROTO_TIMEOUT unless @a wait_timeout is infinite.
+ */
 static inline size_t
-netbox_begin_encode(struct mpstream *stream, uint64_t sync,
-		    enum iproto_type type, uint64_t stream_id)
+netbox_begin_encode_ext(struct mpstream *stream, uint64_t sync,
+			enum iproto_type type, uint64_t stream_id,
+			const struct vclock *wait_vclock, double wait_timeout)
 {
 	/* Remember initial size of ibuf (see netbox_end_encode()) */
 	struct ibuf *ibuf = stream->ctx;
@@ -629,8 +655,11 @@ netbox_begin_encode(struct mpstream *stream, uint64_t sync,
 	mpstream_reserve(stream, fixheader_size);
 	mpstream_advance(stream, fixheader_size);
 
+	bool has_wait_timeout = wait_vclock != NULL &&
+				wait_timeout != TIMEOUT_INFINITY;
 	/* encode header */
-	mpstream_encode_map(stream, 1 + (sync != 0) + (stream_id != 0));
+	mpstream_encode_map(stream, 1 + (sync != 0) + (stream_id != 0) +
+			    (wait_vclock != NULL) + has_wait_timeout);
 
 	if (sync != 0) {
 		mpstream_encode_uint(stream, IPROTO_SYNC);
@@ -644,10 +673,42 @@ netbox_begin_encode(struct mpstream *stream, uint64_t sync,
 		mpstream_encode_uint(stream, IPROTO_STREAM_ID);
 		mpstream_encode_uint(stream, stream_id);
 	}
+	if (wait_vclock != NULL) {
+		mpstream_encode_uint(stream, IPROTO_WAIT_VCLOCK);
+		mpstream_encode_map(stream, vclock_size(wait_vclock));
+		struct vclock_iterator it;
+		vclock_iterator_init(&it, wait_vclock);
+		vclock_foreach(&it, replica) {
+			mpstream_encode_uint(stream, replica.id);
+			mpstream_encode_uint(stream, replica.lsn);
+		}
+	}
+	if (has_wait_timeout) {
+		mpstream_encode_uint(stream, IPROTO_TIMEOUT);
+		mpstream_encode_double(stream, wait_timeout);
+	}
 	/* Caller should remember how many bytes was used in ibuf */
 	return used;
 }
 
+static inline size_t
+netbox_begin_encode(struct mpstream *stream, uint64_t sync,
+		    enum iproto_type type, uint64_t stream_id)
+{
+	return netbox_begin_encode_ext(stream, sync, type, stream_id,
+				       NULL, TIMEOUT_INFINITY);
+}
+
+/** Begins encoding of a netbox method request of the given type. */
+static inline size_t
+netbox_begin_encode_method(struct netbox_method_encode_ctx *ctx,
+			   enum iproto_type type)
+{
+	return netbox_begin_encode_ext(ctx->stream, ctx->sync, type,
+				       ctx->stream_id, ctx->wait_vclock,
+				       ctx->wait_timeout);
+}
+
 static inline void
 netbox_end_encode(struct mpstream *stream, size_t initial_size)
 {
@@ -682,8 +743,7 @@ netbox_encode_ping(lua_State *L, int idx, struct netbox_method_encode_ctx *ctx)
 {
 	(void)L;
 	(void)idx;
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_PING,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_PING);
 	netbox_end_encode(ctx->stream, svp);
 	return 0;
 }
@@ -694,13 +754,17 @@ netbox_encode_ping(lua_State *L, int idx, struct netbox_method_encode_ctx *ctx)
  */
 static void
 netbox_encode_id(struct lua_State *L, struct ibuf *ibuf, uint64_t sync,
-		 bool fetch_schema)
+		 bool fetch_schema, bool response_compression)
 {
 	struct iproto_features features = NETBOX_IPROTO_FEATURES;
 	if (fetch_schema) {
 		iproto_features_clear(&features,
 				      IPROTO_FEATURE_DML_TUPLE_EXTENSION);
 	}
+	if (!response_compression) {
+		iproto_features_clear(&features,
+				      IPROTO_FEATURE_RESPONSE_COMPRESSION);
+	}
 #ifndef NDEBUG
 	struct errinj *errinj = errinj(ERRINJ_NETBOX_FLIP_FEATURE, ERRINJ_INT);
 	if (errinj->iparam >= 0 && errinj->iparam < iproto_feature_id_MAX) {
@@ -812,8 +876,7 @@ static int
 netbox_encode_call(lua_State *L, int idx, struct netbox_method_encode_ctx *ctx)
 {
 	/* Lua stack at idx: function_name, args */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_CALL,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_CALL);
 
 	mpstream_encode_map(ctx->stream, 3);
 
@@ -838,8 +901,7 @@ static int
 netbox_encode_eval(lua_State *L, int idx, struct netbox_method_encode_ctx *ctx)
 {
 	/* Lua stack at idx: expr, args */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_EVAL,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_EVAL);
 
 	mpstream_encode_map(ctx->stream, 3);
 
@@ -904,8 +966,7 @@ netbox_encode_select(lua_State *L, int idx,
 	 * Lua stack at idx: space_id, index_id, iterator, offset, limit, key,
 	 * after, fetch_pos.
 	 */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_SELECT,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_SELECT);
 	uint32_t map_size = 6;
 
 	bool have_after = !lua_isnil(L, idx + 6);
@@ -968,12 +1029,13 @@ netbox_encode_select(lua_State *L, int idx,
 }
 
 static int
-netbox_encode_insert_or_replace(lua_State *L, int idx, struct mpstream *stream,
-				uint64_t sync, enum iproto_type type,
-				uint64_t stream_id)
+netbox_encode_insert_or_replace(lua_State *L, int idx,
+				struct netbox_method_encode_ctx *ctx,
+				enum iproto_type type)
 {
 	/* Lua stack at idx: space_id, tuple */
-	size_t svp = netbox_begin_encode(stream, sync, type, stream_id);
+	struct mpstream *stream = ctx->stream;
+	size_t svp = netbox_begin_encode_method(ctx, type);
 
 	mpstream_encode_map(stream, 2);
 
@@ -992,16 +1054,14 @@ static int
 netbox_encode_insert(lua_State *L, int idx,
 		     struct netbox_method_encode_ctx *ctx)
 {
-	return netbox_encode_insert_or_replace(L, idx, ctx->stream, ctx->sync,
-					       IPROTO_INSERT, ctx->stream_id);
+	return netbox_encode_insert_or_replace(L, idx, ctx, IPROTO_INSERT);
 }
 
 static int
 netbox_encode_replace(lua_State *L, int idx,
 		      struct netbox_method_encode_ctx *ctx)
 {
-	return netbox_encode_insert_or_replace(L, idx, ctx->stream, ctx->sync,
-					       IPROTO_REPLACE, ctx->stream_id);
+	return netbox_encode_insert_or_replace(L, idx, ctx, IPROTO_REPLACE);
 }
 
 static int
@@ -1009,8 +1069,7 @@ netbox_encode_delete(lua_State *L, int idx,
 		     struct netbox_method_encode_ctx *ctx)
 {
 	/* Lua stack at idx: space_id, index_id, key */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_DELETE,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_DELETE);
 
 	mpstream_encode_map(ctx->stream, 3);
 
@@ -1036,8 +1095,7 @@ netbox_encode_update(lua_State *L, int idx,
 		     struct netbox_method_encode_ctx *ctx)
 {
 	/* Lua stack at idx: space_id, index_id, key, ops */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_UPDATE,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_UPDATE);
 
 	mpstream_encode_map(ctx->stream, 5);
 
@@ -1072,8 +1130,7 @@ netbox_encode_upsert(lua_State *L, int idx,
 		     struct netbox_method_encode_ctx *ctx)
 {
 	/* Lua stack at idx: space_id, tuple, ops */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_UPSERT,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_UPSERT);
 
 	mpstream_encode_map(ctx->stream, 4);
 
@@ -1296,8 +1353,7 @@ netbox_encode_execute(lua_State *L, int idx,
 		      struct netbox_method_encode_ctx *ctx)
 {
 	/* Lua stack at idx: query, parameters, options */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_EXECUTE,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_EXECUTE);
 
 	mpstream_encode_map(ctx->stream, 3);
 
@@ -1333,8 +1389,7 @@ netbox_encode_prepare(lua_State *L, int idx,
 		      struct netbox_method_encode_ctx *ctx)
 {
 	/* Lua stack at idx: query */
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_PREPARE,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_PREPARE);
 
 	mpstream_encode_map(ctx->stream, 1);
 
@@ -1363,14 +1418,13 @@ netbox_encode_unprepare(lua_State *L, int idx,
 
 static inline int
 netbox_encode_commit_or_rollback(lua_State *L, enum iproto_type type, int idx,
-				 struct mpstream *stream, uint64_t sync,
-				 uint64_t stream_id)
+				 struct netbox_method_encode_ctx *ctx)
 {
 	(void)L;
 	(void) idx;
 	assert(type == IPROTO_COMMIT || type == IPROTO_ROLLBACK);
-	size_t svp = netbox_begin_encode(stream, sync, type, stream_id);
-	netbox_end_encode(stream, svp);
+	size_t svp = netbox_begin_encode_method(ctx, type);
+	netbox_end_encode(ctx->stream, svp);
 	return 0;
 }
 
@@ -1381,8 +1435,7 @@ static int
 netbox_encode_begin(struct lua_State *L, int idx,
 		    struct netbox_method_encode_ctx *ctx)
 {
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync, IPROTO_BEGIN,
-					 ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_BEGIN);
 	bool has_timeout = !lua_isnoneornil(L, idx);
 	bool has_txn_isolation = !lua_isnoneornil(L, idx + 1);
 	if (has_timeout || has_txn_isolation) {
@@ -1410,18 +1463,14 @@ static int
 netbox_encode_commit(struct lua_State *L, int idx,
 		     struct netbox_method_encode_ctx *ctx)
 {
-	return netbox_encode_commit_or_rollback(L, IPROTO_COMMIT, idx,
-						ctx->stream, ctx->sync,
-						ctx->stream_id);
+	return netbox_encode_commit_or_rollback(L, IPROTO_COMMIT, idx, ctx);
 }
 
 static int
 netbox_encode_rollback(struct lua_State *L, int idx,
 		       struct netbox_method_encode_ctx *ctx)
 {
-	return netbox_encode_commit_or_rollback(L, IPROTO_ROLLBACK, idx,
-						ctx->stream, ctx->sync,
-						ctx->stream_id);
+	return netbox_encode_commit_or_rollback(L, IPROTO_ROLLBACK, idx, ctx);
 }
 
 /**
@@ -1434,8 +1483,7 @@ netbox_encode_watch_once(struct lua_State *L, int idx,
 {
 	size_t key_len;
 	const char *key = lua_tolstring(L, idx, &key_len);
-	size_t svp = netbox_begin_encode(ctx->stream, ctx->sync,
-					 IPROTO_WATCH_ONCE, ctx->stream_id);
+	size_t svp = netbox_begin_encode_method(ctx, IPROTO_WATCH_ONCE);
 	mpstream_encode_map(ctx->stream, 1);
 	mpstream_encode_uint(ctx->stream, IPROTO_EVENT_KEY);
 	mpstream_encode_strn(ctx->stream, key, key_len);
@@ -1470,6 +1518,7 @@ netbox_encode_inject(struct lua_State *L, int idx,
 static int
 netbox_encode_method(struct lua_State *L, int idx, enum netbox_method method,
 		     struct ibuf *ibuf, uint64_t sync, uint64_t stream_id,
+		     const struct vclock *wait_vclock, double wait_timeout,
 		     bool box_tuple_arg_as_ext)
 {
 	typedef int (*method_encoder_f)(struct lua_State *L, int idx,
@@ -1505,6 +1554,8 @@ netbox_encode_method(struct lua_State *L, int idx, enum netbox_method method,
 		.stream = &stream,
 		.stream_id = stream_id,
 		.sync = sync,
+		.wait_vclock = wait_vclock,
+		.wait_timeout = wait_timeout,
 		.box_tuple_arg_as_ext = box_tuple_arg_as_ext,
 	};
 	return method_encoder[method](L, idx, &ctx);
@@ -2361,12 +2412,13 @@ luaT_netbox_request_pairs(struct lua_State *L)
  * Takes the following arguments: uri (string or table) or fd (number),
  * user (string or nil), password (string or nil), callback (function),
  * connect_timeout (number or nil), reconnect_after (number or nil),
- * fetch_schema (boolean or nil), auth_type (string or nil).
+ * fetch_schema (boolean or nil), auth_type (string or nil),
+ * response_compression (boolean or nil).
  */
 static int
 luaT_netbox_new_transport(struct lua_State *L)
 {
-	assert(lua_gettop(L) == 8);
+	assert(lua_gettop(L) == 9);
 	/* Create a transport object. */
 	struct netbox_transport *transport;
 	transport = lua_newuserdata(L, sizeof(*transport));
@@ -2412,6 +2464,8 @@ luaT_netbox_new_transport(struct lua_State *L)
 			return luaT_error(L);
 		}
 	}
+	if (!lua_isnil(L, 9))
+		opts->response_compression = lua_toboolean(L, 9);
 	if (opts->user == NULL && opts->password != NULL) {
 		diag_set(ClientError, ER_PROC_LUA,
 			 "net.box: user is not defined");
@@ -2420,6 +2474,36 @@ luaT_netbox_new_transport(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Converts a Lua table mapping replica ids to LSNs, like the one returned
+ * by box.info.vclock, to a vclock. Component 0 is ignored. On error sets
+ * diag and returns -1.
+ */
+static int
+luaT_netbox_tovclock(struct lua_State *L, int idx, struct vclock *vclock)
+{
+	vclock_create(vclock);
+	lua_pushnil(L);
+	while (lua_next(L, idx) != 0) {
+		int id;
+		double lsn = lua_tonumber(L, -1);
+		if (!luaL_tointeger_strict(L, -2, &id) ||
+		    id < 0 || id >= VCLOCK_MAX ||
+		    lua_type(L, -1) != LUA_TNUMBER ||
+		    lsn < 0 || lsn > (double)INT64_MAX ||
+		    (double)(int64_t)lsn != lsn) {
+			lua_pop(L, 2);
+			diag_set(IllegalParams, "wait_vclock must be a table "
+				 "mapping replica ids to LSNs");
+			return -1;
+		}
+		if (id != 0)
+			vclock_reset(vclock, id, lsn);
+		lua_pop(L, 1);
+	}
+	return 0;
+}
+
 /**
  * Writes a request to the send buffer and registers the request object
  * ('future') that can be used for waiting for a response.
@@ -2432,16 +2516,21 @@ luaT_netbox_new_transport(struct lua_State *L)
  *  - on_push_ctx: on_push trigger function argument
  *  - format: tuple format to use for decoding the body or nil
  *  - stream_id: determines whether or not the request belongs to stream
+ *  - wait_vclock: vclock the server must reach before processing
+ *    the request or nil
  *  - method: a value from the netbox_method enumeration
  *  - ...: method-specific arguments passed to the encoder
  *
+ * The server waits for wait_vclock for no longer than @a wait_timeout.
+ *
  * If the request cannot be performed, sets diag and returns -1,
  * otherwise returns 0.
  */
 static int
 luaT_netbox_transport_make_request(struct lua_State *L, int idx,
 				   struct netbox_transport *transport,
-				   struct netbox_request *request)
+				   struct netbox_request *request,
+				   double wait_timeout)
 {
 	if (transport->state != NETBOX_ACTIVE &&
 	    transport->state != NETBOX_FETCH_SCHEMA) {
@@ -2465,6 +2554,20 @@ luaT_netbox_transport_make_request(struct lua_State *L, int idx,
 	int arg = idx + 6;
 	uint64_t sync = transport->next_sync++;
 	uint64_t stream_id = luaL_touint64(L, arg++);
+	struct vclock wait_vclock_buf;
+	struct vclock *wait_vclock = NULL;
+	if (!lua_isnil(L, arg)) {
+		if (!iproto_features_test(&transport->features,
+					  IPROTO_FEATURE_WAIT_VCLOCK)) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Remote server",
+				 "wait_vclock");
+			return -1;
+		}
+		wait_vclock = &wait_vclock_buf;
+		if (luaT_netbox_tovclock(L, arg, wait_vclock) != 0)
+			return -1;
+	}
+	arg++;
 	enum netbox_method method = lua_tointeger(L, arg++);
 	assert(method < netbox_method_MAX);
 	size_t svp = ibuf_used(&transport->send_buf);
@@ -2472,7 +2575,8 @@ luaT_netbox_transport_make_request(struct lua_State *L, int idx,
 		iproto_features_test(&transport->features,
 				     IPROTO_FEATURE_CALL_ARG_TUPLE_EXTENSION);
 	if (netbox_encode_method(L, arg++, method, &transport->send_buf, sync,
-				 stream_id, box_tuple_arg_as_ext) != 0) {
+				 stream_id, wait_vclock, wait_timeout,
+				 box_tuple_arg_as_ext) != 0) {
 		ibuf_truncate(&transport->send_buf, svp);
 		return -1;
 	}
@@ -2512,7 +2616,8 @@ luaT_netbox_transport_perform_async_request(struct lua_State *L)
 {
 	struct netbox_transport *transport = luaT_check_netbox_transport(L, 1);
 	struct netbox_request *request = lua_newuserdata(L, sizeof(*request));
-	if (luaT_netbox_transport_make_request(L, 2, transport, request) != 0)
+	if (luaT_netbox_transport_make_request(L, 2, transport, request,
+					       TIMEOUT_INFINITY) != 0)
 		return luaT_push_nil_and_error(L);
 	luaL_getmetatable(L, netbox_request_typename);
 	lua_setmetatable(L, -2);
@@ -2526,7 +2631,8 @@ luaT_netbox_transport_perform_request(struct lua_State *L)
 	double timeout = (!lua_isnil(L, 2) ?
 			  lua_tonumber(L, 2) : TIMEOUT_INFINITY);
 	struct netbox_request request;
-	if (luaT_netbox_transport_make_request(L, 3, transport, &request) != 0)
+	if (luaT_netbox_transport_make_request(L, 3, transport, &request,
+					       timeout) != 0)
 		return luaT_push_nil_and_error(L);
 	while (!netbox_request_is_ready(&request)) {
 		if (!netbox_request_wait(&request, &timeout)) {
@@ -2707,6 +2813,49 @@ netbox_write_response_to_buffer(const char *data, const char *data_end,
 		lua_rawseti(L, -2, 1);
 }
 
+/**
+ * Decompresses a response body if the server replaced it with
+ * IPROTO_COMPRESSED_BODY (see IPROTO_FEATURE_RESPONSE_COMPRESSION).
+ * The decompressed body is stored in transport->zbuf until the next
+ * call. Returns 0 and updates the body boundaries on success. Returns
+ * -1 and sets diag on failure.
+ */
+static int
+netbox_transport_decompress_body(struct netbox_transport *transport,
+				 const char **data, const char **data_end)
+{
+	const char *p = *data;
+	if (mp_typeof(*p) != MP_MAP || mp_decode_map(&p) != 1 ||
+	    mp_typeof(*p) != MP_UINT ||
+	    mp_decode_uint(&p) != IPROTO_COMPRESSED_BODY)
+		return 0;
+	if (mp_typeof(*p) != MP_BIN)
+		goto error;
+	uint32_t zsize;
+	const char *zdata = mp_decode_bin(&p, &zsize);
+	if (p != *data_end)
+		goto error;
+	unsigned long long size = ZSTD_getFrameContentSize(zdata, zsize);
+	if (size == ZSTD_CONTENTSIZE_UNKNOWN ||
+	    size == ZSTD_CONTENTSIZE_ERROR || size > UINT32_MAX)
+		goto error;
+	ibuf_reset(&transport->zbuf);
+	char *buf = ibuf_alloc(&transport->zbuf, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "ibuf_alloc", "buf");
+		return -1;
+	}
+	size_t rc = ZSTD_decompressDCtx(netbox_zdctx, buf, size, zdata, zsize);
+	if (ZSTD_isError(rc) || rc != size)
+		goto error;
+	*data = buf;
+	*data_end = buf + size;
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_MSGPACK, "compressed response body");
+	return -1;
+}
+
 /**
  * Given a netbox transport and a response header, decodes the response and
  * either completes the request or invokes the on-push trigger, depending on
@@ -2751,6 +2900,13 @@ netbox_transport_dispatch_response(struct netbox_transport *transport,
 	}
 	const char *data = hdr->body[0].iov_base;
 	const char *data_end = data + hdr->body[0].iov_len;
+	if (status == IPROTO_OK && transport->opts.response_compression &&
+	    netbox_transport_decompress_body(transport, &data,
+					     &data_end) != 0) {
+		netbox_request_set_error(request, diag_last_error(diag_get()));
+		netbox_request_complete(request);
+		return;
+	}
 	if (request->buffer != NULL) {
 		netbox_write_response_to_buffer(data, data_end, L,
 						request->buffer,
@@ -2808,7 +2964,8 @@ netbox_transport_do_id(struct netbox_transport *transport, struct lua_State *L)
 	if (peer_version_id < version_id(2, 10, 0))
 		goto unsupported;
 	netbox_encode_id(L, &transport->send_buf, transport->next_sync++,
-			 transport->opts.fetch_schema);
+			 transport->opts.fetch_schema,
+			 transport->opts.response_compression);
 	struct xrow_header hdr;
 	if (netbox_transport_send_and_recv(transport, &hdr) != 0)
 		luaT_error(L);
@@ -3196,6 +3353,18 @@ luaT_netbox_transport_next_sync(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Returns the number of requests sent or queued for sending over
+ * the connection that haven't been replied yet.
+ */
+static int
+luaT_netbox_transport_inprogress_request_count(struct lua_State *L)
+{
+	struct netbox_transport *transport = luaT_check_netbox_transport(L, 1);
+	lua_pushinteger(L, transport->inprogress_request_count);
+	return 1;
+}
+
 /**
  * Puts an active connection to 'graceful_shutdown' state, in which no new
  * requests are allowed. The connection will be switched to the error state
@@ -3244,6 +3413,11 @@ luaopen_net_box(struct lua_State *L)
 			    IPROTO_FEATURE_CALL_RET_TUPLE_EXTENSION);
 	iproto_features_set(&NETBOX_IPROTO_FEATURES,
 			    IPROTO_FEATURE_CALL_ARG_TUPLE_EXTENSION);
+	iproto_features_set(&NETBOX_IPROTO_FEATURES,
+			    IPROTO_FEATURE_RESPONSE_COMPRESSION);
+	netbox_zdctx = ZSTD_createDCtx();
+	if (netbox_zdctx == NULL)
+		panic("failed to create zstd decompression context");
 
 	lua_pushcfunction(L, luaT_netbox_request_iterator_next);
 	luaT_netbox_request_iterator_next_ref = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -3253,6 +3427,8 @@ luaopen_net_box(struct lua_State *L)
 		{ "start",          luaT_netbox_transport_start },
 		{ "stop",           luaT_netbox_transport_stop },
 		{ "next_sync",	    luaT_netbox_transport_next_sync },
+		{ "inprogress_request_count",
+			luaT_netbox_transport_inprogress_request_count },
 		{ "graceful_shutdown",
 			luaT_netbox_transport_graceful_shutdown },
 		{ "perform_request",
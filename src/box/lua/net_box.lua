@@ -3,6 +3,7 @@ local log      = require('log')
 local ffi      = require('ffi')
 local fiber    = require('fiber')
 local msgpack  = require('msgpack')
+local fun      = require('fun')
 local urilib   = require('uri')
 local internal = require('net.box.lib')
 local trigger  = require('internal.trigger')
@@ -40,6 +41,7 @@ local REQUEST_OPTION_TYPES = {
     skip_header = "boolean",
     timeout     = "number",
     fetch_pos   = "boolean",
+    wait_vclock = "table",
     after = function(after)
         if after ~= nil and type(after) ~= "string" and type(after) ~= "table"
                 and not is_tuple(after) then
@@ -55,6 +57,16 @@ local REQUEST_OPTION_TYPES = {
     end,
 }
 
+local PAIRS_OPTION_TYPES = {
+    iterator    = "string, number",
+    after       = REQUEST_OPTION_TYPES.after,
+    batch_size  = "number",
+    timeout     = "number",
+}
+
+-- Number of tuples fetched by one request sent by index:pairs().
+local PAIRS_BATCH_SIZE_DEFAULT = 1000
+
 local CONNECT_OPTION_TYPES = {
     user                        = "string",
     password                    = "string",
@@ -66,6 +78,7 @@ local CONNECT_OPTION_TYPES = {
     auth_type                   = "string",
     required_protocol_version   = "number",
     required_protocol_features  = "table",
+    response_compression        = "boolean",
     _disable_graceful_shutdown  = "boolean",
 }
 
@@ -441,7 +454,7 @@ local function new_sm(uri_or_fd, opts)
     local transport = internal.new_transport(
             uri_or_fd, user, password, weak_callback,
             opts.connect_timeout, opts.reconnect_after,
-            opts.fetch_schema, opts.auth_type)
+            opts.fetch_schema, opts.auth_type, opts.response_compression)
     weak_refs.transport = transport
     remote._transport = transport
     remote._gc_hook = ffi.gc(ffi.new('char[1]'), function()
@@ -804,12 +817,14 @@ function remote_methods:_request_impl(method, opts, format, stream_id, ...)
     assert(method ~= nil)
     local transport = self._transport
     local on_push, on_push_ctx, buffer, skip_header, return_raw, deadline
+    local wait_vclock
     -- Extract options, set defaults, check if the request is
     -- async.
     if opts then
         buffer = opts.buffer
         skip_header = opts.skip_header
         return_raw = opts.return_raw
+        wait_vclock = opts.wait_vclock
         if opts.is_async then
             if opts.on_push or opts.on_push_ctx then
                 error('To handle pushes in an async request use future:pairs()')
@@ -817,7 +832,7 @@ function remote_methods:_request_impl(method, opts, format, stream_id, ...)
             return transport:perform_async_request(buffer, skip_header,
                                                    return_raw, table.insert,
                                                    {}, format, stream_id,
-                                                   method, ...)
+                                                   wait_vclock, method, ...)
         end
         if opts.timeout then
             deadline = fiber_clock() + opts.timeout
@@ -838,7 +853,8 @@ function remote_methods:_request_impl(method, opts, format, stream_id, ...)
     end
     local res, err = transport:perform_request(timeout, buffer, skip_header,
                                                return_raw, on_push, on_push_ctx,
-                                               format, stream_id, method, ...)
+                                               format, stream_id, wait_vclock,
+                                               method, ...)
     -- Try to wait until a schema is reloaded if needed.
     -- Regardless of reloading result, the main response is
     -- returned, since it does not depend on any schema things.
@@ -1140,6 +1156,11 @@ space_metatable = function(remote)
         return check_primary_index(self):get(key, opts)
     end
 
+    function methods:pairs(key, opts)
+        check_space_arg(self, 'pairs')
+        return check_primary_index(self):pairs(key, opts)
+    end
+
     function methods:format(format)
         if format == nil then
             return self._format
@@ -1179,6 +1200,68 @@ index_metatable = function(remote)
         return unpack(res)
     end
 
+    --
+    -- Iterates over tuples of the index. Tuples are fetched in batches
+    -- of batch_size (1000 by default) using pagination, so neither the
+    -- server nor the client has to keep the whole result in memory.
+    -- The next batch is requested as soon as the previous one has been
+    -- received so that the network round trip overlaps with processing
+    -- of the received tuples.
+    --
+    function methods:pairs(key, opts)
+        check_index_arg(self, 'pairs')
+        check_param_table(opts, PAIRS_OPTION_TYPES)
+        if not remote.peer_protocol_features.pagination then
+            return box.error(box.error.UNSUPPORTED, "Remote server",
+                "pagination")
+        end
+        local key_is_nil = (key == nil or
+                            (type(key) == 'table' and #key == 0))
+        local iterator, _, _, _, after = check_select_opts(opts, key_is_nil)
+        local batch_size = opts and opts.batch_size or
+                           PAIRS_BATCH_SIZE_DEFAULT
+        if batch_size < 1 or math.floor(batch_size) ~= batch_size then
+            box.error(E_PROC_LUA, "batch_size must be a positive integer")
+        end
+        local timeout = opts and opts.timeout
+        local request_opts = {is_async = true}
+        local index = self
+        local function fetch(pos)
+            return remote:_request('SELECT_WITH_POS', request_opts,
+                                   index.space._format_cdata,
+                                   index._stream_id, index.space._id_or_name,
+                                   index._id_or_name, iterator, 0, batch_size,
+                                   key, pos, true)
+        end
+        local future = fetch(after)
+        local batch = {}
+        local function gen(_, i)
+            if i < #batch then
+                return i + 1, batch[i + 1]
+            end
+            if future == nil then
+                return nil
+            end
+            local res, err = future:wait_result(timeout)
+            if res == nil then
+                future = nil
+                error(err)
+            end
+            batch = res[1]
+            local pos = res[2]
+            if #batch == batch_size and pos ~= nil then
+                future = fetch(pos)
+            else
+                future = nil
+            end
+            if #batch == 0 then
+                return nil
+            end
+            return 1, batch[1]
+        end
+        return fun.wrap(gen, nil, 0)
+    end
+
     function methods:get(key, opts)
         check_index_arg(self, 'get')
         check_param_table(opts, REQUEST_OPTION_TYPES)
@@ -1260,10 +1343,152 @@ index_metatable = function(remote)
     return { __index = methods, __metatable = false }
 end
 
+local POOL_OPTION_TYPES = table.copy(CONNECT_OPTION_TYPES)
+POOL_OPTION_TYPES.size = "number"
+
+local pool_methods = {}
+local pool_mt = {
+    __index = pool_methods,
+    __serialize = function(self)
+        local connections = {}
+        for i, conn in ipairs(self.connections) do
+            connections[i] = remote_serialize(conn)
+        end
+        return connections
+    end,
+}
+
+local function check_pool_arg(pool, method)
+    if type(pool) ~= 'table' then
+        local fmt = 'Use pool:%s(...) instead of pool.%s(...):'
+        box.error(E_PROC_LUA, string.format(fmt, method, method))
+    end
+end
+
+--
+-- Returns the connected connection of the pool that has the least
+-- number of requests in progress. If no connection is established,
+-- returns the first one so that a request fails with a connection
+-- error.
+--
+function pool_methods:connection()
+    check_pool_arg(self, 'connection')
+    local connections = self.connections
+    local best, best_count
+    for i = 1, #connections do
+        local conn = connections[i]
+        if conn:is_connected() then
+            local count = conn._transport:inprogress_request_count()
+            if best == nil or count < best_count then
+                best, best_count = conn, count
+                if count == 0 then
+                    break
+                end
+            end
+        end
+    end
+    return best or connections[1]
+end
+
+function pool_methods:call(func_name, args, opts)
+    check_pool_arg(self, 'call')
+    return self:connection():call(func_name, args, opts)
+end
+
+function pool_methods:eval(code, args, opts)
+    check_pool_arg(self, 'eval')
+    return self:connection():eval(code, args, opts)
+end
+
+function pool_methods:is_connected()
+    check_pool_arg(self, 'is_connected')
+    for _, conn in ipairs(self.connections) do
+        if conn:is_connected() then
+            return true
+        end
+    end
+    return false
+end
+
+--
+-- Waits until all connections of the pool are established.
+-- Returns false on timeout or if any connection failed.
+--
+function pool_methods:wait_connected(timeout)
+    check_pool_arg(self, 'wait_connected')
+    local deadline = fiber_clock() + (timeout or TIMEOUT_INFINITY)
+    for _, conn in ipairs(self.connections) do
+        if not conn:wait_connected(max(0, deadline - fiber_clock())) then
+            return false
+        end
+    end
+    return true
+end
+
+function pool_methods:close()
+    check_pool_arg(self, 'close')
+    for _, conn in ipairs(self.connections) do
+        conn:close()
+    end
+end
+
+--
+-- Create a pool of connections to a remote server. Requests sent
+-- over the pool are balanced among its connections by the number
+-- of requests in progress.
+-- @param uri URI of the server.
+-- @param opts Connection options (see connect()) and the number of
+--        connections in the pool (size, 4 by default).
+--
+-- @retval Pool object.
+--
+local function new_pool(uri, opts)
+    check_param_table(opts, POOL_OPTION_TYPES)
+    opts = table.copy(opts or {})
+    local size = opts.size or 4
+    if size < 1 or math.floor(size) ~= size then
+        box.error(E_PROC_LUA, "pool size must be a positive integer")
+    end
+    opts.size = nil
+    local wait_connected = opts.wait_connected
+    opts.wait_connected = false
+    local connections = {}
+    for i = 1, size do
+        connections[i] = connect(uri, opts)
+    end
+    local pool = setmetatable({connections = connections}, pool_mt)
+    if wait_connected ~= false then
+        pool:wait_connected(tonumber(wait_connected))
+    end
+    return pool
+end
+
+--
+-- Waits for results of the given array of futures returned by async
+-- requests. Returns an array of the results in the same order. If any
+-- of the requests fails or the timeout expires, returns nil and
+-- the error.
+--
+local function wait_all(futures, timeout)
+    check_param(futures, 'futures', 'table')
+    local deadline = fiber_clock() + (timeout or TIMEOUT_INFINITY)
+    local results = {}
+    for i, future in ipairs(futures) do
+        local res, err = future:wait_result(max(0, deadline - fiber_clock()))
+        if err ~= nil then
+            return nil, err
+        end
+        results[i] = res
+    end
+    return results
+end
+
 this_module = {
     connect = connect,
     new = connect, -- Tarantool < 1.7.1 compatibility,
     from_fd = from_fd,
+    pool = new_pool,
+    wait_all = wait_all,
 }
 
 function this_module.timeout(timeout, ...)
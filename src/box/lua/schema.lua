@@ -297,16 +297,19 @@ local begin_options = {
         return true
     end,
     txn_isolation = normalize_txn_isolation_level,
+    read_only = 'boolean',
 }
 
 box.begin = function(options)
     local timeout
     local txn_isolation
+    local read_only
     if options then
         check_param_table(options, begin_options)
         timeout = options.timeout
         txn_isolation = options.txn_isolation and
                         normalize_txn_isolation_level(options.txn_isolation)
+        read_only = options.read_only
     end
     if builtin.box_txn_begin() == -1 then
         box.error()
@@ -319,6 +322,10 @@ box.begin = function(options)
         box.rollback()
         box.error()
     end
+    if read_only and internal.txn_make_read_only() ~= 0 then
+        box.rollback()
+        box.error()
+    end
 end
 
 box.is_in_txn = builtin.box_txn
@@ -729,6 +736,28 @@ local function check_space_type(space_type)
               table.concat(space_types, "', '") .. "'.")
 end
 
+-- Convert the ttl_field space option, which is either a field name or
+-- a field number, to the zero-based field number stored in _space.
+local function normalize_ttl_field(ttl_field, format)
+    if ttl_field == nil then
+        return nil
+    end
+    if type(ttl_field) == 'number' then
+        if ttl_field < 1 or ttl_field ~= math.floor(ttl_field) then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "ttl_field must be a positive integer or a field name")
+        end
+        return ttl_field - 1
+    end
+    for i, field in ipairs(format) do
+        if field.name == ttl_field then
+            return i - 1
+        end
+    end
+    box.error(box.error.ILLEGAL_PARAMS,
+              "ttl_field '" .. ttl_field .. "' is not found in the format")
+end
+
 box.schema.space = {}
 box.schema.space.create = function(name, options)
     check_param(name, 'name', 'string')
@@ -744,6 +773,7 @@ box.schema.space.create = function(name, options)
         temporary = 'boolean',
         is_sync = 'boolean',
         defer_deletes = 'boolean',
+        ttl_field = 'number, string',
         constraint = 'string, table',
         foreign_key = 'table',
     }
@@ -789,6 +819,7 @@ box.schema.space.create = function(name, options)
     local constraint = normalize_constraint(options.constraint, '')
     local foreign_key = normalize_foreign_key(id, name, options.foreign_key, '',
                                               true)
+    local ttl_field = normalize_ttl_field(options.ttl_field, format)
     -- filter out global parameters from the options array
     local space_options = setmap({
         group_id = options.is_local and 1 or nil,
@@ -796,6 +827,7 @@ box.schema.space.create = function(name, options)
         type = options.type,
         is_sync = options.is_sync,
         defer_deletes = options.defer_deletes and true or nil,
+        ttl_field = ttl_field,
         constraint = constraint,
         foreign_key = foreign_key,
     })
@@ -895,6 +927,131 @@ box.schema.space.rename = function(space_id, space_name)
     _space:update(space_id, {{"=", 3, space_name}})
 end
 
+local bulk_load_template = {
+    batch_size = 'number',
+}
+
+-- Load tuples into an empty space. Secondary indexes are dropped for the
+-- time of the load and created again after it, because building an index
+-- on a filled space is much faster than updating it on each insertion.
+-- Tuples are inserted in transactions of opts.batch_size statements so
+-- that each WAL write carries a batch of them. On failure, the space is
+-- truncated and the secondary indexes are restored.
+--
+-- The operation isn't atomic: an index can't be built on a non-empty space
+-- in a multi-statement transaction so the dropped indexes are restored one
+-- by one and a concurrent request or a crash in the middle of the load may
+-- see the space without them. If an index can't be restored on failure, the
+-- error is logged along with the index definition.
+function box.schema.space.bulk_load(space_id, source, opts)
+    check_param(space_id, 'space_id', 'number')
+    opts = opts or {}
+    check_param_table(opts, bulk_load_template)
+    local batch_size = opts.batch_size or 1000
+    if batch_size < 1 then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "options parameter 'batch_size' should be positive")
+    end
+    local next_tuple
+    if type(source) == 'table' then
+        local i = 0
+        next_tuple = function()
+            i = i + 1
+            return source[i]
+        end
+    elseif type(source) == 'function' then
+        next_tuple = source
+    else
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "source should be a table or a function")
+    end
+    local space = box.space[space_id]
+    if space == nil then
+        box.error(box.error.NO_SUCH_SPACE, '#' .. tostring(space_id))
+    end
+    if space.index[0] == nil then
+        box.error(box.error.NO_SUCH_INDEX_ID, 0, space.name)
+    end
+    if box.is_in_txn() then
+        box.error(box.error.ACTIVE_TRANSACTION)
+    end
+    local gen, param, state = space:pairs()
+    if gen(param, state) ~= nil then
+        box.error(box.error.ILLEGAL_PARAMS, "space is not empty")
+    end
+
+    local _index = box.space[box.schema.INDEX_ID]
+    local _func_index = box.space[box.schema.FUNC_INDEX_ID]
+    local indexes = _index:select({space_id})
+    table.remove(indexes, 1)
+    local func_indexes = {}
+    for _, t in _func_index:pairs({space_id}) do
+        func_indexes[t.index_id] = t
+    end
+    box.atomic(function()
+        for i = #indexes, 1, -1 do
+            local iid = indexes[i].iid
+            if func_indexes[iid] ~= nil then
+                _func_index:delete({space_id, iid})
+            end
+            _index:delete({space_id, iid})
+        end
+    end)
+
+    local function restore_index(t)
+        box.atomic(function()
+            _index:insert(t)
+            if func_indexes[t.iid] ~= nil then
+                _func_index:insert(func_indexes[t.iid])
+            end
+        end)
+    end
+    local restored = 0
+    local function restore_indexes()
+        while restored < #indexes do
+            restore_index(indexes[restored + 1])
+            restored = restored + 1
+        end
+    end
+    local function load()
+        local count = 0
+        box.begin()
+        for tuple in next_tuple do
+            space:insert(tuple)
+            count = count + 1
+            if count % batch_size == 0 then
+                box.commit()
+                box.begin()
+            end
+        end
+        box.commit()
+        restore_indexes()
+    end
+
+    local ok, err = pcall(load)
+    if not ok then
+        if box.is_in_txn() then
+            box.rollback()
+        end
+        local truncate_ok, truncate_err = pcall(space.truncate, space)
+        if not truncate_ok then
+            log.error("bulk_load: failed to truncate space '%s': %s",
+                      space.name, truncate_err)
+        end
+        -- Try to restore all the indexes even if some of them fail.
+        for i = restored + 1, #indexes do
+            local t = indexes[i]
+            local restore_ok, restore_err = pcall(restore_index, t)
+            if not restore_ok then
+                log.error("bulk_load: failed to restore index '%s' of " ..
+                          "space '%s': %s, index definition: %s", t.name,
+                          space.name, restore_err, t)
+            end
+        end
+        error(err)
+    end
+end
+
 local alter_space_template = {
     field_count = 'number',
     user = 'string, number',
@@ -903,6 +1060,7 @@ local alter_space_template = {
     temporary = 'boolean',
     is_sync = 'boolean',
     defer_deletes = 'boolean',
+    ttl_field = 'number, string, boolean',
     name = 'string',
     constraint = 'string, table',
     foreign_key = 'table',
@@ -957,6 +1115,12 @@ box.schema.space.alter = function(space_id, options)
         format = tuple.format
     end
 
+    if options.ttl_field == false then
+        flags.ttl_field = nil
+    elseif options.ttl_field ~= nil then
+        flags.ttl_field = normalize_ttl_field(options.ttl_field, format)
+    end
+
     if options.constraint ~= nil then
         if table.equals(options.constraint, {}) then
             options.constraint = nil
@@ -1426,9 +1590,11 @@ local index_options = {
     distance = 'string',
     run_count_per_level = 'number',
     run_size_ratio = 'number',
+    compaction_strategy = 'string',
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
+    bloom_type = 'string',
     func = 'number, string',
     hint = 'boolean',
 }
@@ -1504,6 +1670,8 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
     local type_dependent_defaults = {
         rtree = {parts = { 2, 'array' }, unique = false},
         bitset = {parts = { 2, 'unsigned' }, unique = false},
+        text = {parts = { 2, 'string' }, unique = false},
+        hnsw = {parts = { 2, 'array' }, unique = false},
         other = {parts = { 1, 'unsigned' }, unique = true},
     }
     options_defaults = type_dependent_defaults[options.type]
@@ -1570,7 +1738,9 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
             range_size = options.range_size,
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
+            compaction_strategy = options.compaction_strategy,
             bloom_fpr = options.bloom_fpr,
+            bloom_type = options.bloom_type,
             func = options.func,
             hint = options.hint,
     }
@@ -1817,6 +1987,40 @@ local iterator_gen = function(param, state) -- luacheck: no unused args
     end
 end
 
+local const_tuple_ref_t = ffi.typeof('box_tuple_t&')
+local tuple_holder_t = ffi.typeof('struct { box_tuple_t *tuple; }')
+
+local function tuple_holder_release(holder)
+    if holder.tuple ~= nil then
+        builtin.box_tuple_unref(holder.tuple)
+        holder.tuple = nil
+    end
+end
+
+-- Same as iterator_gen, but returns tuples borrowed from the iterator
+-- instead of registering a GC finalizer for each of them. A borrowed
+-- tuple is referenced by the holder stored in param until the next
+-- iteration step, after which it must not be used.
+local iterator_gen_borrow = function(param, state)
+    local holder = param.holder
+    tuple_holder_release(holder)
+    if builtin.box_read_ffi_is_disabled then
+        return iterator_gen_luac(param, state)
+    end
+    if not ffi.istype(iterator_t, state) then
+        error('usage: next(param, state)')
+    end
+    if builtin.box_iterator_next(state, ptuple) ~= 0 then
+        return box.error() -- error
+    elseif ptuple[0] ~= nil then
+        builtin.box_tuple_ref(ptuple[0])
+        holder.tuple = ptuple[0]
+        return state, ffi.cast(const_tuple_ref_t, holder.tuple)
+    else
+        return nil
+    end
+end
+
 -- global struct port instance to use by select()/get()
 local port = ffi.new('struct port')
 local port_c = ffi.cast('struct port_c *', port)
@@ -2338,8 +2542,15 @@ base_index_mt.pairs_ffi = function(index, key, opts)
     if cdata == nil then
         box.error()
     end
-    return fun.wrap(iterator_gen, keybuf,
-        ffi.gc(cdata, builtin.box_iterator_free))
+    cdata = ffi.gc(cdata, builtin.box_iterator_free)
+    if opts ~= nil and type(opts) == 'table' and opts.borrow then
+        local param = {
+            keybuf = keybuf,
+            holder = ffi.gc(tuple_holder_t(), tuple_holder_release),
+        }
+        return fun.wrap(iterator_gen_borrow, param, cdata)
+    end
+    return fun.wrap(iterator_gen, keybuf, cdata)
 end
 base_index_mt.pairs_luac = function(index, key, opts)
     check_index_arg(index, 'pairs')
@@ -2398,6 +2609,19 @@ base_index_mt.get_luac = function(index, key)
     return internal.get(index.space_id, index.id, key)
 end
 
+base_index_mt.get_batch = function(index, keys)
+    check_index_arg(index, 'get_batch')
+    if type(keys) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage: index:get_batch({key1, key2, ...})")
+    end
+    local batch = {}
+    for i, key in ipairs(keys) do
+        batch[i] = keify(key)
+    end
+    return internal.get_batch(index.space_id, index.id, batch)
+end
+
 local function check_select_opts(opts, key_is_nil)
     local offset = 0
     local limit = 4294967295
@@ -2601,6 +2825,10 @@ space_mt.get = function(space, key)
     check_space_arg(space, 'get')
     return check_primary_index(space):get(key)
 end
+space_mt.get_batch = function(space, keys)
+    check_space_arg(space, 'get_batch')
+    return check_primary_index(space):get_batch(keys)
+end
 space_mt.select = function(space, key, opts)
     check_space_arg(space, 'select')
     return check_primary_index(space):select(key, opts)
@@ -2626,6 +2854,22 @@ space_mt.replace = function(space, tuple)
     return internal.replace(space.id, tuple);
 end
 space_mt.put = space_mt.replace; -- put is an alias for replace
+space_mt.insert_batch = function(space, tuples)
+    check_space_arg(space, 'insert_batch')
+    if type(tuples) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage: space:insert_batch({tuple1, tuple2, ...})")
+    end
+    return internal.insert_batch(space.id, tuples)
+end
+space_mt.replace_batch = function(space, tuples)
+    check_space_arg(space, 'replace_batch')
+    if type(tuples) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage: space:replace_batch({tuple1, tuple2, ...})")
+    end
+    return internal.replace_batch(space.id, tuples)
+end
 space_mt.update = function(space, key, ops)
     check_space_arg(space, 'update')
     return check_primary_index(space):update(key, ops)
@@ -2676,6 +2920,11 @@ space_mt.format = function(space, format)
     check_space_arg(space, 'format')
     return box.schema.space.format(space.id, format)
 end
+space_mt.bulk_load = function(space, source, opts)
+    check_space_arg(space, 'bulk_load')
+    check_space_exists(space)
+    return box.schema.space.bulk_load(space.id, source, opts)
+end
 space_mt.upgrade = function(space, ...)
     check_space_arg(space, 'upgrade')
     return box.schema.space.upgrade(space.id, ...)
@@ -2708,6 +2957,55 @@ space_mt.run_triggers = function(space, yesno)
     end
     builtin.space_run_triggers(s, yesno)
 end
+space_mt.take = function(space, timeout)
+    check_space_arg(space, 'take')
+    check_space_exists(space)
+    if timeout ~= nil then
+        check_param(timeout, 'timeout', 'number')
+    end
+    return internal.space.take(space.id, timeout)
+end
+space_mt.ack = function(space, key)
+    check_space_arg(space, 'ack')
+    check_space_exists(space)
+    return internal.space.ack(space.id, keify(key))
+end
+space_mt.release = function(space, key)
+    check_space_arg(space, 'release')
+    check_space_exists(space)
+    return internal.space.release(space.id, keify(key))
+end
+local import_csv_options = {
+    delimiter = 'string',
+    quote = 'string',
+    skip_header = 'boolean',
+    batch_size = 'number',
+}
+space_mt.import_csv = function(space, path, opts)
+    check_space_arg(space, 'import_csv')
+    check_space_exists(space)
+    check_param(path, 'path', 'string')
+    check_param_table(opts, import_csv_options)
+    opts = opts or {}
+    for _, name in ipairs({'delimiter', 'quote'}) do
+        if opts[name] ~= nil and #opts[name] ~= 1 then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "options parameter '" .. name ..
+                      "' should be a single character")
+        end
+    end
+    if opts.batch_size ~= nil and (opts.batch_size < 1 or
+                                   opts.batch_size > 0xffffffff or
+                                   math.floor(opts.batch_size) ~=
+                                   opts.batch_size) then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "options parameter 'batch_size' should be " ..
+                  "a positive integer")
+    end
+    return internal.space.import_csv(space.id, path, opts.delimiter,
+                                     opts.quote, opts.skip_header,
+                                     opts.batch_size)
+end
 space_mt.frommap = box.internal.space.frommap
 space_mt.stat = box.internal.space.stat
 space_mt.__index = space_mt
@@ -3753,6 +4051,13 @@ local function check_read_view_arg(rv, method)
     end
 end
 
+--
+-- Handles of read views opened with box.read_view.open(): read view object ->
+-- handle. A handle closes its read view when it's garbage collected so a read
+-- view is closed automatically after the user drops the last reference to it.
+--
+local read_view_handles = setmetatable({}, {__mode = 'k'})
+
 local read_view_methods = {}
 
 --
@@ -3779,10 +4084,13 @@ function read_view_methods:info()
 end
 
 --
--- Function stub. Implemented in Tarantool EE.
+-- Closes a read view opened with box.read_view.open(). System read views
+-- can't be closed by the user.
 --
-function box.internal.read_view_close()
-    error('read view is busy', 3)
+function box.internal.read_view_close(rv)
+    if not internal.read_view_destroy(rv) then
+        error('read view is busy', 3)
+    end
 end
 
 --
@@ -3793,6 +4101,10 @@ function read_view_methods:close()
     if self.status == 'closed' then
         error('read view is closed', 2)
     end
+    if read_view_handles[self] == nil then
+        -- Opened from C, must be closed with box_read_view_close().
+        error('read view is busy', 2)
+    end
     box.internal.read_view_close(self)
 end
 
@@ -3825,11 +4137,150 @@ local read_view_mt = {
 
 box.read_view = {}
 
+local read_view_index_methods = {}
+
+local function check_read_view_index_arg(index, method)
+    if type(index) ~= 'table' or index.rv == nil then
+        local fmt = 'Use index:%s(...) instead of index.%s(...)'
+        error(string.format(fmt, method, method), 3)
+    end
+end
+
+--
+-- Only full scans are supported by memtx read views in this edition.
+--
+local function check_read_view_iterator_args(key, opts)
+    if key ~= nil and (type(key) ~= 'table' or #key > 0) then
+        box.error(box.error.UNSUPPORTED, "Community edition",
+                  "read view lookup by key")
+    end
+    local itype = opts ~= nil and opts.iterator or nil
+    if itype ~= nil and itype ~= 'ALL' and itype ~= box.index.ALL then
+        box.error(box.error.UNSUPPORTED, "Community edition",
+                  "read view iterator other than ALL")
+    end
+end
+
+local function read_view_iterator_gen(_, state)
+    local tuple = internal.read_view_iterator_next(state)
+    if tuple ~= nil then
+        return state, tuple -- new state, value
+    else
+        return nil
+    end
+end
+
+local function read_view_iterator_create(index)
+    return internal.read_view_iterator_create(index.rv.id, index.space_id,
+                                              index.id)
+end
+
+--
+-- Returns a luafun iterator over all tuples stored in the index at the time
+-- when the read view was opened. The index is passed as the iterator param
+-- so that the read view isn't garbage collected while the iterator is used.
+--
+function read_view_index_methods:pairs(key, opts)
+    check_read_view_index_arg(self, 'pairs')
+    check_read_view_iterator_args(key, opts)
+    return fun.wrap(read_view_iterator_gen, self,
+                    read_view_iterator_create(self))
+end
+
+--
+-- Returns an array of tuples stored in the index at the time when the read
+-- view was opened. Supports the 'limit' and 'offset' options.
+--
+function read_view_index_methods:select(key, opts)
+    check_read_view_index_arg(self, 'select')
+    check_read_view_iterator_args(key, opts)
+    local limit = opts ~= nil and opts.limit or 4294967295
+    local offset = opts ~= nil and opts.offset or 0
+    local it = read_view_iterator_create(self)
+    local result = {}
+    while #result < limit do
+        local tuple = internal.read_view_iterator_next(it)
+        if tuple == nil then
+            break
+        end
+        if offset > 0 then
+            offset = offset - 1
+        else
+            table.insert(result, tuple)
+        end
+    end
+    return result
+end
+
+local read_view_index_mt = {
+    __index = read_view_index_methods,
+    __serialize = function(index)
+        return {id = index.id, name = index.name, type = index.type}
+    end,
+}
+
+local read_view_space_methods = {}
+
+local function check_read_view_space_arg(space, method)
+    if type(space) ~= 'table' or space.index == nil then
+        local fmt = 'Use space:%s(...) instead of space.%s(...)'
+        error(string.format(fmt, method, method), 3)
+    end
+end
+
+local function read_view_space_pk(space)
+    local pk = space.index[0]
+    if pk == nil then
+        box.error(box.error.NO_SUCH_INDEX_ID, 0, space.name)
+    end
+    return pk
+end
+
+function read_view_space_methods:pairs(key, opts)
+    check_read_view_space_arg(self, 'pairs')
+    return read_view_space_pk(self):pairs(key, opts)
+end
+
+function read_view_space_methods:select(key, opts)
+    check_read_view_space_arg(self, 'select')
+    return read_view_space_pk(self):select(key, opts)
+end
+
+local read_view_space_mt = {
+    __index = read_view_space_methods,
+    __serialize = function(space)
+        return {id = space.id, name = space.name}
+    end,
+}
+
 --
--- Function stub. Implemented in Tarantool EE.
+-- Opens a read view of all memtx spaces. The read view object returned by
+-- this function has the 'space' field, which maps space ids and names to
+-- space read views. Tuples may be read from a space read view or its index
+-- read views with pairs() and select(), which only support full scans.
 --
-function box.read_view.open()
-    box.error(box.error.UNSUPPORTED, "Community edition", "read view")
+-- A read view should be closed with read_view:close() when it isn't needed
+-- anymore, because it pins the data that was deleted after it was opened.
+-- Otherwise it's closed when the read view object is garbage collected.
+--
+function box.read_view.open(opts)
+    check_param_table(opts, {name = 'string'})
+    local rv, handle = internal.read_view_open(opts and opts.name)
+    read_view_handles[rv] = handle
+    for _, space in pairs(rv.space) do
+        if getmetatable(space) == nil then
+            space.rv = rv
+            setmetatable(space, read_view_space_mt)
+            for _, index in pairs(space.index) do
+                if getmetatable(index) == nil then
+                    index.rv = rv
+                    index.space_id = space.id
+                    setmetatable(index, read_view_index_mt)
+                end
+            end
+        end
+    end
+    return box.internal.read_view_register(rv)
 end
 
 --
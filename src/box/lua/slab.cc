@@ -239,6 +239,19 @@ lbox_slab_info(struct lua_State *L)
 	lua_pushstring(L, ratio_buf);
 	lua_settable(L, -3);
 
+	/*
+	 * How much of the arena is backed by huge pages,
+	 * box.cfg.memtx_use_hugepages.
+	 */
+	if (memtx->use_hugepages) {
+		ssize_t used = tuple_arena_hugepages_used(&memtx->arena);
+		if (used < 0)
+			return luaT_error(L);
+		lua_pushstring(L, "arena_hugepages_used");
+		luaL_pushuint64(L, used);
+		lua_settable(L, -3);
+	}
+
 	return 1;
 }
 
@@ -33,6 +33,7 @@
 #include "box/lua/space.h"
 #include "box/lua/tuple.h"
 #include "box/lua/key_def.h"
+#include "box/lua/misc.h"
 #include "box/sql/sqlLimit.h"
 #include "lua/utils.h"
 #include "lua/trigger.h"
@@ -54,6 +55,8 @@ extern "C" {
 #include "box/tuple_constraint.h"
 #include "box/txn.h"
 #include "box/sequence.h"
+#include "box/space_queue.h"
+#include "box/space_import.h"
 #include "box/coll_id_cache.h"
 #include "box/replication.h" /* GROUP_LOCAL */
 #include "box/iproto_constants.h" /* iproto_type_name */
@@ -413,6 +416,14 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 		lua_settable(L, i);
 	}
 
+	/* space.ttl_field */
+	lua_pushstring(L, "ttl_field");
+	if (space->def->opts.ttl_field != UINT32_MAX)
+		lua_pushnumber(L, space->def->opts.ttl_field + TUPLE_INDEX_BASE);
+	else
+		lua_pushnil(L);
+	lua_settable(L, i);
+
 	lua_getfield(L, i, "index");
 	if (lua_isnil(L, -1)) {
 		lua_pop(L, 1);
@@ -480,7 +491,8 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 		if (index_def->type == HASH || index_def->type == TREE) {
 			lua_pushboolean(L, index_opts->is_unique);
 			lua_setfield(L, -2, "unique");
-		} else if (index_def->type == RTREE) {
+		} else if (index_def->type == RTREE ||
+			   index_def->type == HNSW) {
 			lua_pushnumber(L, index_opts->dimension);
 			lua_setfield(L, -2, "dimension");
 		}
@@ -576,9 +588,20 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnumber(L, index_opts->run_size_ratio);
 			lua_setfield(L, -2, "run_size_ratio");
 
+			if (index_opts->compaction_strategy ==
+			    INDEX_COMPACTION_STRATEGY_TIERED) {
+				lua_pushstring(L, "tiered");
+				lua_setfield(L, -2, "compaction_strategy");
+			}
+
 			lua_pushnumber(L, index_opts->bloom_fpr);
 			lua_setfield(L, -2, "bloom_fpr");
 
+			if (index_opts->bloom_type == INDEX_BLOOM_TYPE_XOR) {
+				lua_pushstring(L, "xor");
+				lua_setfield(L, -2, "bloom_type");
+			}
+
 			lua_settable(L, -3);
 		}
 		lua_setfield(L, -2, index_def->name);
@@ -800,6 +823,98 @@ lbox_space_stat(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Take the first ready tuple of a space, see space_queue_take().
+ * Usage: take(space_id[, timeout])
+ */
+static int
+lbox_space_take(struct lua_State *L)
+{
+	if (lua_gettop(L) < 1 || !lua_isnumber(L, 1) ||
+	    (!lua_isnoneornil(L, 2) && !lua_isnumber(L, 2)))
+		return luaL_error(L, "Usage: space:take([timeout])");
+	uint32_t space_id = lua_tointeger(L, 1);
+	double timeout = lua_isnoneornil(L, 2) ? TIMEOUT_INFINITY :
+			 lua_tonumber(L, 2);
+	struct tuple *tuple;
+	if (space_queue_take(space_id, timeout, &tuple) != 0)
+		return luaT_error(L);
+	return luaT_pushtupleornil(L, tuple);
+}
+
+/** Handler of a taken tuple, see space_queue_ack(). */
+typedef int
+(*lbox_space_queue_f)(uint32_t space_id, const char *key,
+		      const char *key_end, struct tuple **result);
+
+static int
+lbox_space_queue_call(struct lua_State *L, lbox_space_queue_f func,
+		      const char *usage)
+{
+	if (lua_gettop(L) != 2 || !lua_isnumber(L, 1))
+		return luaL_error(L, usage);
+	uint32_t space_id = lua_tointeger(L, 1);
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 2, &key_len);
+	struct tuple *tuple;
+	if (func(space_id, key, key + key_len, &tuple) != 0)
+		return luaT_error(L);
+	return luaT_pushtupleornil(L, tuple);
+}
+
+/**
+ * Delete a taken tuple from a space, see space_queue_ack().
+ * Usage: ack(space_id, key)
+ */
+static int
+lbox_space_ack(struct lua_State *L)
+{
+	return lbox_space_queue_call(L, space_queue_ack,
+				     "Usage: space:ack(key)");
+}
+
+/**
+ * Return a taken tuple to a space, see space_queue_release().
+ * Usage: release(space_id, key)
+ */
+static int
+lbox_space_release(struct lua_State *L)
+{
+	return lbox_space_queue_call(L, space_queue_release,
+				     "Usage: space:release(key)");
+}
+
+/**
+ * Import a CSV file into a space, see space_import_csv().
+ * Usage: import_csv(space_id, path, delimiter, quote_char,
+ *                   skip_header, batch_size)
+ * Returns the number of imported rows.
+ */
+static int
+lbox_space_import_csv(struct lua_State *L)
+{
+	if (lua_gettop(L) != 6 || !lua_isnumber(L, 1) ||
+	    lua_type(L, 2) != LUA_TSTRING)
+		return luaL_error(L, "Usage: space:import_csv(path[, opts])");
+	uint32_t space_id = lua_tointeger(L, 1);
+	const char *path = lua_tostring(L, 2);
+	struct space_import_csv_opts opts;
+	space_import_csv_opts_create(&opts);
+	if (!lua_isnil(L, 3))
+		opts.delimiter = lua_tostring(L, 3)[0];
+	if (!lua_isnil(L, 4))
+		opts.quote_char = lua_tostring(L, 4)[0];
+	if (!lua_isnil(L, 5))
+		opts.skip_header = lua_toboolean(L, 5);
+	if (!lua_isnil(L, 6))
+		opts.batch_size = lua_tointeger(L, 6);
+	uint64_t count;
+	if (space_import_csv(space_id, path, &opts, &count) != 0)
+		return luaT_error(L);
+	luaL_pushuint64(L, count);
+	return 1;
+}
+
 void
 box_lua_space_init(struct lua_State *L)
 {
@@ -904,6 +1019,10 @@ box_lua_space_init(struct lua_State *L)
 	static const struct luaL_Reg space_internal_lib[] = {
 		{"frommap", lbox_space_frommap},
 		{"stat", lbox_space_stat},
+		{"take", lbox_space_take},
+		{"ack", lbox_space_ack},
+		{"import_csv", lbox_space_import_csv},
+		{"release", lbox_space_release},
 		{NULL, NULL}
 	};
 	luaL_findtable(L, LUA_GLOBALSINDEX, "box.internal.space", 0);
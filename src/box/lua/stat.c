@@ -44,6 +44,10 @@
 #include "box/vinyl.h"
 #include "box/sql.h"
 #include "box/memtx_engine.h"
+#include "box/func_cache.h"
+#include "box/space.h"
+#include "box/index.h"
+#include "box/expiration.h"
 #include "info/info.h"
 #include "lua/info.h"
 #include "lua/utils.h"
@@ -179,6 +183,16 @@ lbox_stat_vinyl(struct lua_State *L)
 	return 1;
 }
 
+/* box.stat.latency() */
+static int
+lbox_stat_latency(struct lua_State *L)
+{
+	struct info_handler h;
+	luaT_info_handler_create(&h, L);
+	iproto_latency_stat(&h);
+	return 1;
+}
+
 /* box.stat.memtx() */
 static int
 lbox_stat_memtx(struct lua_State *L)
@@ -317,6 +331,89 @@ lbox_stat_net_thread_call(struct lua_State *L)
 	return 1;
 }
 
+static int
+set_func_stat(struct func *func, void *arg)
+{
+	struct lua_State *L = (struct lua_State *)arg;
+	lua_newtable(L);
+	lua_pushnumber(L, func->call_count);
+	lua_setfield(L, -2, "calls");
+	lua_setfield(L, -2, func->def->name);
+	return 0;
+}
+
+/**
+ * Push a table with the number of calls of each function registered
+ * in the _func space, keyed by the function name.
+ */
+static int
+lbox_stat_func(struct lua_State *L)
+{
+	lua_newtable(L);
+	func_foreach(set_func_stat, L);
+	return 1;
+}
+
+static int
+set_space_stat(struct space *space, void *arg)
+{
+	struct lua_State *L = (struct lua_State *)arg;
+	lua_newtable(L);
+	lua_pushnumber(L, space->dml_count.insert);
+	lua_setfield(L, -2, "insert");
+	lua_pushnumber(L, space->dml_count.replace);
+	lua_setfield(L, -2, "replace");
+	lua_pushnumber(L, space->dml_count.update);
+	lua_setfield(L, -2, "update");
+	lua_pushnumber(L, space->dml_count.delete_);
+	lua_setfield(L, -2, "delete");
+	lua_pushnumber(L, space->dml_count.upsert);
+	lua_setfield(L, -2, "upsert");
+	lua_newtable(L);
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		lua_newtable(L);
+		lua_pushnumber(L, index->lookup_count.get);
+		lua_setfield(L, -2, "get");
+		lua_pushnumber(L, index->lookup_count.select);
+		lua_setfield(L, -2, "select");
+		lua_pushnumber(L, index->lookup_count.scan);
+		lua_setfield(L, -2, "scan");
+		lua_setfield(L, -2, index->def->name);
+	}
+	lua_setfield(L, -2, "index");
+	lua_setfield(L, -2, space_name(space));
+	return 0;
+}
+
+/**
+ * Push a table with the number of requests executed by each space
+ * and the number of lookups in each of its indexes, keyed by the
+ * space name.
+ */
+static int
+lbox_stat_space(struct lua_State *L)
+{
+	lua_newtable(L);
+	space_foreach(set_space_stat, L);
+	return 1;
+}
+
+/**
+ * Push a table with the number of tuples deleted by the expiration
+ * service and the number of transactions it committed.
+ */
+static int
+lbox_stat_expiration(struct lua_State *L)
+{
+	lua_newtable(L);
+	lua_pushnumber(L, expiration_stat.expired);
+	lua_setfield(L, -2, "expired");
+	lua_pushnumber(L, expiration_stat.batches);
+	lua_setfield(L, -2, "batches");
+	return 1;
+}
+
 static int
 lbox_stat_sql(struct lua_State *L)
 {
@@ -367,6 +464,10 @@ box_lua_stat_init(struct lua_State *L)
 		{"vinyl", lbox_stat_vinyl},
 		{"reset", lbox_stat_reset},
 		{"sql", lbox_stat_sql},
+		{"func", lbox_stat_func},
+		{"space", lbox_stat_space},
+		{"expiration", lbox_stat_expiration},
+		{"latency", lbox_stat_latency},
 		{NULL, NULL}
 	};
 
@@ -46,6 +46,7 @@
 #include "box/errcode.h"
 #include "json/json.h"
 #include "mpstream/mpstream.h"
+#include <lua-cjson/lua_cjson.h>
 
 /** {{{ box.tuple Lua library
  *
@@ -708,6 +709,17 @@ lbox_tuple_to_string(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Encode a tuple as a JSON array without converting it to a Lua table.
+ */
+static int
+lbox_tuple_to_json(struct lua_State *L)
+{
+	struct tuple *tuple = luaT_checktuple(L, 1);
+	luaL_json_encode_mp(L, tuple_data(tuple));
+	return 1;
+}
+
 void
 luaT_pushtuple(struct lua_State *L, box_tuple_t *tuple)
 {
@@ -760,6 +772,7 @@ lbox_tuple_info(lua_State *L)
 static const struct luaL_Reg lbox_tuple_meta[] = {
 	{"__gc", lbox_tuple_gc},
 	{"tostring", lbox_tuple_to_string},
+	{"tojson", lbox_tuple_to_json},
 	{"slice", lbox_tuple_slice},
 	{"transform", lbox_tuple_transform},
 	{"tuple_to_map", lbox_tuple_to_map},
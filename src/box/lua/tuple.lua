@@ -35,6 +35,10 @@ box_tuple_to_buf(box_tuple_t *tuple, char *buf, size_t size);
 const char *
 box_tuple_field(box_tuple_t *tuple, uint32_t i);
 
+const char *
+box_tuple_field_by_path(box_tuple_t *tuple, const char *path,
+                        uint32_t path_len, int index_base);
+
 typedef struct tuple_iterator box_tuple_iterator_t;
 
 box_tuple_iterator_t *
@@ -314,9 +318,25 @@ end
 
 msgpackffi.on_encode(const_tuple_ref_t, tuple_to_msgpack)
 
+local const_uchar_ptr_t = ffi.typeof('const unsigned char *')
+
 local function tuple_field_by_path(tuple, path)
     tuple_check(tuple, "tuple['field_name']");
-    return internal.tuple.tuple_field_by_path(tuple, path)
+    -- The field is looked up with FFI, so accessing scalar fields
+    -- by name can be compiled by JIT. Arrays, maps, binary strings
+    -- and extensions are decoded with the C decoder to keep their
+    -- representation intact.
+    local field = builtin.box_tuple_field_by_path(tuple, path, #path, 1)
+    if field == nil then
+        return nil
+    end
+    local c = ffi.cast(const_uchar_ptr_t, field)[0]
+    if (c >= 0x80 and c <= 0x9f) or (c >= 0xc4 and c <= 0xc9) or
+       (c >= 0xd4 and c <= 0xd8) or (c >= 0xdc and c <= 0xdf) then
+        return internal.tuple.tuple_field_by_path(tuple, path)
+    end
+    -- Use () to shrink stack to the first return value
+    return (msgpackffi.decode_unchecked(field))
 end
 
 local methods = {
@@ -333,6 +353,7 @@ local methods = {
     ["upsert"]      = tuple_upsert;
     ["bsize"]       = tuple_bsize;
     ["tomap"]       = internal.tuple.tuple_to_map;
+    ["tojson"]      = internal.tuple.tojson;
     ["info"]        = internal.tuple.info;
 }
 
@@ -394,6 +415,7 @@ internal.tuple.slice = nil
 internal.tuple.transform = nil
 internal.tuple.tuple_to_map = nil
 internal.tuple.tostring = nil
+internal.tuple.tojson = nil
 
 -- internal api for box.select and iterators
 internal.tuple.bless = tuple_bless
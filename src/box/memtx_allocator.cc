@@ -217,6 +217,25 @@ memtx_allocators_close_read_view(memtx_allocators_read_view rv)
 				memtx_allocators_read_view &>(rv);
 }
 
+/** Does a garbage collection step for a MemtxAllocator. */
+struct memtx_allocator_collect_garbage {
+	template<typename Allocator>
+	void invoke(bool &has_garbage)
+	{
+		if (Allocator::collect_garbage())
+			has_garbage = true;
+	}
+};
+
+bool
+memtx_allocators_collect_garbage()
+{
+	bool has_garbage = false;
+	foreach_memtx_allocator<memtx_allocator_collect_garbage,
+				bool &>(has_garbage);
+	return has_garbage;
+}
+
 /** Sums allocator statistics. */
 struct memtx_allocator_add_stats {
 	template<typename Allocator>
@@ -476,6 +476,13 @@ memtx_allocators_open_read_view(const struct read_view_opts *opts);
 void
 memtx_allocators_close_read_view(memtx_allocators_read_view rv);
 
+/**
+ * Does a garbage collection step for each MemtxAllocator. Returns false
+ * if there's no more tuples to collect.
+ */
+bool
+memtx_allocators_collect_garbage();
+
 /** Returns allocator statistics sum over all MemtxAllocators.  */
 void
 memtx_allocators_stats(struct memtx_allocator_stats *stats);
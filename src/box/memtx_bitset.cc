@@ -337,6 +337,50 @@ memtx_bitset_index_replace(struct index *base, struct tuple *old_tuple,
 	return 0;
 }
 
+/**
+ * Build the bitset expression evaluating to the values matching the key
+ * for the given iterator type.
+ */
+static int
+memtx_bitset_index_expr(struct index *base, enum iterator_type type,
+			const void *bitset_key, uint32_t bitset_key_size,
+			struct tt_bitset_expr *expr)
+{
+	int rc = 0;
+	switch (type) {
+	case ITER_ALL:
+		rc = tt_bitset_index_expr_all(expr);
+		break;
+	case ITER_EQ:
+		rc = tt_bitset_index_expr_equals(expr, bitset_key,
+						 bitset_key_size);
+		break;
+	case ITER_BITS_ALL_SET:
+		rc = tt_bitset_index_expr_all_set(expr, bitset_key,
+						  bitset_key_size);
+		break;
+	case ITER_BITS_ALL_NOT_SET:
+		rc = tt_bitset_index_expr_all_not_set(expr, bitset_key,
+						      bitset_key_size);
+		break;
+	case ITER_BITS_ANY_SET:
+		rc = tt_bitset_index_expr_any_set(expr, bitset_key,
+						  bitset_key_size);
+		break;
+	default:
+		diag_set(UnsupportedIndexFeature, base->def,
+			 "requested iterator type");
+		return -1;
+	}
+
+	if (rc != 0) {
+		diag_set(OutOfMemory, 0, "memtx_bitset_index",
+			 "iterator expression");
+		return -1;
+	}
+	return 0;
+}
+
 /** Implementation of create_iterator for memtx bitset index. */
 static struct iterator *
 memtx_bitset_index_create_iterator(struct index *base, enum iterator_type type,
@@ -379,39 +423,9 @@ memtx_bitset_index_create_iterator(struct index *base, enum iterator_type type,
 
 	struct tt_bitset_expr expr;
 	tt_bitset_expr_create(&expr, realloc);
-
-	int rc = 0;
-	switch (type) {
-	case ITER_ALL:
-		rc = tt_bitset_index_expr_all(&expr);
-		break;
-	case ITER_EQ:
-		rc = tt_bitset_index_expr_equals(&expr, bitset_key,
-						 bitset_key_size);
-		break;
-	case ITER_BITS_ALL_SET:
-		rc = tt_bitset_index_expr_all_set(&expr, bitset_key,
-						  bitset_key_size);
-		break;
-	case ITER_BITS_ALL_NOT_SET:
-		rc = tt_bitset_index_expr_all_not_set(&expr, bitset_key,
-						      bitset_key_size);
-		break;
-	case ITER_BITS_ANY_SET:
-		rc = tt_bitset_index_expr_any_set(&expr, bitset_key,
-						  bitset_key_size);
-		break;
-	default:
-		diag_set(UnsupportedIndexFeature, base->def,
-			 "requested iterator type");
-		goto fail;
-	}
-
-	if (rc != 0) {
-		diag_set(OutOfMemory, 0, "memtx_bitset_index",
-			 "iterator expression");
+	if (memtx_bitset_index_expr(base, type, bitset_key, bitset_key_size,
+				    &expr) != 0)
 		goto fail;
-	}
 
 	if (tt_bitset_index_init_iterator(&index->index, &it->bitset_it,
 					  &expr) != 0) {
@@ -428,6 +442,32 @@ memtx_bitset_index_create_iterator(struct index *base, enum iterator_type type,
 	return NULL;
 }
 
+/** Count the values matching the key without iterating over them. */
+static ssize_t
+memtx_bitset_index_count_bits(struct index *base, enum iterator_type type,
+			      const void *bitset_key, uint32_t bitset_key_size)
+{
+	struct memtx_bitset_index *index = (struct memtx_bitset_index *)base;
+	struct tt_bitset_expr expr;
+	tt_bitset_expr_create(&expr, realloc);
+	struct tt_bitset_iterator it;
+	tt_bitset_iterator_create(&it, realloc);
+	ssize_t count = -1;
+	if (memtx_bitset_index_expr(base, type, bitset_key, bitset_key_size,
+				    &expr) != 0)
+		goto out;
+	if (tt_bitset_index_init_iterator(&index->index, &it, &expr) != 0) {
+		diag_set(OutOfMemory, 0, "memtx_bitset_index",
+			 "iterator state");
+		goto out;
+	}
+	count = tt_bitset_iterator_count(&it);
+out:
+	tt_bitset_iterator_destroy(&it);
+	tt_bitset_expr_destroy(&expr);
+	return count;
+}
+
 static ssize_t
 memtx_bitset_index_count(struct index *base, enum iterator_type type,
 			 const char *key, uint32_t part_count)
@@ -488,6 +528,15 @@ memtx_bitset_index_count(struct index *base, enum iterator_type type,
 				tt_bitset_index_count(&index->index, bit);
 	}
 
+	/*
+	 * Without MVCC every value in the index is a visible tuple, so
+	 * the result of the expression can be counted with popcount,
+	 * page by page, instead of iterating over the tuples.
+	 */
+	if (!memtx_tx_manager_use_mvcc_engine)
+		return memtx_bitset_index_count_bits(base, type, bitset_key,
+						     bitset_key_size);
+
 	/* Call generic method */
 	return generic_index_count(base, type, key, part_count);
 }
@@ -510,6 +559,7 @@ static const struct index_vtab memtx_bitset_index_vtab = {
 	/* .count = */ memtx_bitset_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ generic_index_get,
+	/* .get_batch = */ generic_index_get_batch,
 	/* .replace = */ memtx_bitset_index_replace,
 	/* .create_iterator = */ memtx_bitset_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
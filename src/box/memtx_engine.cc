@@ -35,6 +35,8 @@
 #include <small/mempool.h>
 
 #include "fiber.h"
+#include "fiber_cond.h"
+#include "cbus.h"
 #include "errinj.h"
 #include "coio_task.h"
 #include "info/info.h"
@@ -76,6 +78,12 @@ enum {
 	SLAB_SIZE = 16 * 1024 * 1024,
 	MIN_MEMORY_QUOTA = SLAB_SIZE * 4,
 	MAX_TUPLE_SIZE = 1 * 1024 * 1024,
+	/**
+	 * Number of allocator garbage collection steps done by the gc
+	 * fiber in one go. A step frees up to 100 tuples so this gives
+	 * about the same latency as an index garbage collection task.
+	 */
+	MEMTX_GC_ALLOCATOR_STEPS = 10,
 };
 
 template <class ALLOC>
@@ -91,11 +99,23 @@ static inline struct tuple *
 memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
 			 const char *end, bool validate);
 
+struct tuple *
+(*memtx_tuple_new_from_update)(struct tuple_format *format,
+			       struct tuple *old_tuple, const char *data,
+			       const char *end, uint64_t column_mask);
+
+template <class ALLOC>
+static inline struct tuple *
+memtx_tuple_new_from_update_impl(struct tuple_format *format,
+				 struct tuple *old_tuple, const char *data,
+				 const char *end, uint64_t column_mask);
+
 template <class ALLOC>
 static void
 memtx_alloc_init(void)
 {
 	memtx_tuple_new_raw = memtx_tuple_new_raw_impl<ALLOC>;
+	memtx_tuple_new_from_update = memtx_tuple_new_from_update_impl<ALLOC>;
 }
 
 static int
@@ -255,6 +275,211 @@ memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row,
 				  enum snapshot_recovery_state *state);
 
+enum {
+	/**
+	 * Amount of decompressed rows the snapshot reader thread prepares
+	 * for the tx thread in one go.
+	 */
+	SNAPSHOT_READ_BATCH_SIZE = 1024 * 1024,
+};
+
+/**
+ * Snapshot reader thread. It reads transaction blocks from the snapshot
+ * file, validates their checksums and decompresses them while the tx
+ * thread is busy applying the rows read in the previous batch.
+ */
+struct snapshot_reader {
+	/** Reader thread. */
+	struct cord cord;
+	/** A pipe from the tx thread to the reader thread. */
+	struct cpipe reader_pipe;
+	/** A pipe from the reader thread to the tx thread. */
+	struct cpipe tx_pipe;
+	/** Route of a read request. */
+	struct cmsg_hop route[2];
+	/** Snapshot cursor. Accessed only from the reader thread. */
+	struct xlog_cursor cursor;
+	/** Set if the cursor was opened. */
+	bool is_open;
+	/** Name of the snapshot file. */
+	char filename[PATH_MAX];
+};
+
+/** A request to read the next batch of snapshot transaction blocks. */
+struct snapshot_read_msg {
+	struct cmsg base;
+	struct snapshot_reader *reader;
+	/**
+	 * Set if the reader must look for the next transaction block
+	 * before reading, i.e. if the previous one is corrupted.
+	 */
+	bool skip_corrupted;
+	/**
+	 * Read blocks, each is the 32-bit length followed by
+	 * the decoded block rows.
+	 */
+	char *buf;
+	/** Size of the data stored in the buffer. */
+	size_t size;
+	/** Allocated size of the buffer. */
+	size_t capacity;
+	/**
+	 * 0 if there's more data to read, 1 if the end of the file was
+	 * reached, -1 if a read error occurred, see the diag.
+	 */
+	int rc;
+	/** Set if the EOF marker was read. */
+	bool is_eof;
+	/** Read error. */
+	struct diag diag;
+	/** Set when the message returns to the tx thread. */
+	bool is_done;
+	/** Signaled when the message returns to the tx thread. */
+	struct fiber_cond done_cond;
+};
+
+/** Appends a transaction block to a snapshot read batch. */
+static void
+snapshot_read_msg_append(struct snapshot_read_msg *msg,
+			 const char *data, size_t len)
+{
+	size_t needed = msg->size + sizeof(uint32_t) + len;
+	if (needed > msg->capacity) {
+		size_t capacity = MAX(msg->capacity * 2, needed);
+		msg->buf = (char *)xrealloc(msg->buf, capacity);
+		msg->capacity = capacity;
+	}
+	char *dst = msg->buf + msg->size;
+	store_u32(dst, len);
+	memcpy(dst + sizeof(uint32_t), data, len);
+	msg->size = needed;
+}
+
+/** Reads a batch of transaction blocks. Runs in the reader thread. */
+static void
+snapshot_reader_read_f(struct cmsg *base)
+{
+	struct snapshot_read_msg *msg = (struct snapshot_read_msg *)base;
+	struct xlog_cursor *cursor = &msg->reader->cursor;
+	msg->size = 0;
+	msg->rc = 0;
+	if (!msg->reader->is_open) {
+		msg->rc = xlog_cursor_open(cursor, msg->reader->filename);
+		if (msg->rc != 0)
+			goto out;
+		msg->reader->is_open = true;
+	}
+	if (msg->skip_corrupted) {
+		msg->rc = xlog_cursor_find_tx_magic(cursor);
+		if (msg->rc != 0)
+			goto out;
+	}
+	while (msg->size < SNAPSHOT_READ_BATCH_SIZE) {
+		msg->rc = xlog_cursor_next_tx(cursor);
+		if (msg->rc != 0)
+			break;
+		struct ibuf *rows = &cursor->tx_cursor.rows;
+		snapshot_read_msg_append(msg, rows->rpos, ibuf_used(rows));
+	}
+out:
+	if (msg->rc < 0)
+		diag_move(diag_get(), &msg->diag);
+	msg->is_eof = msg->reader->is_open && xlog_cursor_is_eof(cursor);
+}
+
+/** Wakes up the tx fiber waiting for a read batch. */
+static void
+snapshot_reader_done_f(struct cmsg *base)
+{
+	struct snapshot_read_msg *msg = (struct snapshot_read_msg *)base;
+	msg->is_done = true;
+	fiber_cond_signal(&msg->done_cond);
+}
+
+/** Snapshot reader thread function. */
+static int
+snapshot_reader_f(va_list ap)
+{
+	struct snapshot_reader *reader = va_arg(ap, struct snapshot_reader *);
+	struct cbus_endpoint endpoint;
+	cpipe_create(&reader->tx_pipe, "tx_prio");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&reader->tx_pipe);
+	if (reader->is_open)
+		xlog_cursor_close(&reader->cursor, false);
+	return 0;
+}
+
+/**
+ * Starts the reader thread. The snapshot file is opened by the thread
+ * on the first read request.
+ */
+static int
+snapshot_reader_start(struct snapshot_reader *reader, const char *filename)
+{
+	strlcpy(reader->filename, filename, sizeof(reader->filename));
+	reader->is_open = false;
+	if (cord_costart(&reader->cord, "snapshot.reader",
+			 snapshot_reader_f, reader) != 0)
+		return -1;
+	cpipe_create(&reader->reader_pipe, "snapshot.reader");
+	reader->route[0] = {snapshot_reader_read_f, &reader->tx_pipe};
+	reader->route[1] = {snapshot_reader_done_f, NULL};
+	return 0;
+}
+
+/** Stops the reader thread and closes the snapshot cursor. */
+static void
+snapshot_reader_stop(struct snapshot_reader *reader)
+{
+	cbus_stop_loop(&reader->reader_pipe);
+	cpipe_destroy(&reader->reader_pipe);
+	if (cord_join(&reader->cord) != 0)
+		panic_syserror("snapshot reader thread join failed");
+}
+
+static void
+snapshot_read_msg_create(struct snapshot_read_msg *msg,
+			 struct snapshot_reader *reader)
+{
+	memset(msg, 0, sizeof(*msg));
+	msg->reader = reader;
+	msg->is_done = true;
+	diag_create(&msg->diag);
+	fiber_cond_create(&msg->done_cond);
+}
+
+static void
+snapshot_read_msg_destroy(struct snapshot_read_msg *msg)
+{
+	assert(msg->is_done);
+	diag_destroy(&msg->diag);
+	fiber_cond_destroy(&msg->done_cond);
+	free(msg->buf);
+}
+
+/** Sends a request to read the next batch to the reader thread. */
+static void
+snapshot_read_msg_send(struct snapshot_read_msg *msg, bool skip_corrupted)
+{
+	assert(msg->is_done);
+	msg->is_done = false;
+	msg->skip_corrupted = skip_corrupted;
+	cmsg_init(&msg->base, msg->reader->route);
+	cpipe_push(&msg->reader->reader_pipe, &msg->base);
+}
+
+/** Waits for a read request to return from the reader thread. */
+static void
+snapshot_read_msg_wait(struct snapshot_read_msg *msg)
+{
+	while (!msg->is_done)
+		fiber_cond_wait(&msg->done_cond);
+}
+
 int
 memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 			      const struct vclock *vclock)
@@ -266,34 +491,95 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 						    signature, NONE);
 
 	say_info("recovering from `%s'", filename);
-	struct xlog_cursor cursor;
-	if (xlog_cursor_open(&cursor, filename) < 0)
+	struct snapshot_reader reader;
+	if (snapshot_reader_start(&reader, filename) != 0)
 		return -1;
+	struct snapshot_read_msg msgs[2];
+	for (int i = 0; i < (int)lengthof(msgs); i++)
+		snapshot_read_msg_create(&msgs[i], &reader);
+	/*
+	 * While the rows of one batch are applied, the reader thread
+	 * fills the other one.
+	 */
+	struct snapshot_read_msg *msg = &msgs[0];
+	struct snapshot_read_msg *next = &msgs[1];
+	snapshot_read_msg_send(msg, false);
 
-	int rc;
+	int rc = 0;
+	bool is_eof = false;
 	struct xrow_header row;
 	uint64_t row_count = 0;
 	bool force_recovery = false;
 	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
-	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
-		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(memtx, &row, &state);
-		if (state == DONE_RECOVERING_SYSTEM_SPACES)
-			force_recovery = memtx->force_recovery;
-		if (rc < 0) {
-			if (!force_recovery)
-				break;
-			say_error("can't apply row: ");
-			diag_log();
+	while (true) {
+		snapshot_read_msg_wait(msg);
+		if (msg->rc == 0)
+			snapshot_read_msg_send(next, false);
+		const char *pos = msg->buf;
+		const char *end = msg->buf + msg->size;
+		while (pos < end) {
+			const char *tx_end = pos + sizeof(uint32_t) +
+					     load_u32(pos);
+			pos += sizeof(uint32_t);
+			while (pos < tx_end) {
+				if (xrow_header_decode(&row, &pos, tx_end,
+						       false) != 0) {
+					diag_set(XlogError, "can't parse row");
+					if (!force_recovery) {
+						rc = -1;
+						goto out;
+					}
+					say_error("can't decode row: %s",
+						  diag_last_error(
+							diag_get())->errmsg);
+					/* Discard remaining row data. */
+					pos = tx_end;
+					break;
+				}
+				row.lsn = signature;
+				rc = memtx_engine_recover_snapshot_row(
+					memtx, &row, &state);
+				if (state == DONE_RECOVERING_SYSTEM_SPACES)
+					force_recovery = memtx->force_recovery;
+				if (rc < 0) {
+					if (!force_recovery)
+						goto out;
+					say_error("can't apply row: ");
+					diag_log();
+				}
+				++row_count;
+				if (row_count % 100000 == 0) {
+					say_info_ratelimited(
+						"%.1fM rows processed",
+						row_count / 1e6);
+					fiber_yield_timeout(0);
+				}
+			}
 		}
-		++row_count;
-		if (row_count % 100000 == 0) {
-			say_info_ratelimited("%.1fM rows processed",
-					     row_count / 1e6);
-			fiber_yield_timeout(0);
+		if (msg->rc > 0) {
+			is_eof = msg->is_eof;
+			rc = 0;
+			break;
 		}
+		if (msg->rc < 0) {
+			struct error *e = diag_last_error(&msg->diag);
+			if (!force_recovery || e->type != &type_XlogError) {
+				diag_move(&msg->diag, diag_get());
+				rc = -1;
+				break;
+			}
+			say_error("can't open tx: %s", e->errmsg);
+			diag_clear(&msg->diag);
+			snapshot_read_msg_send(next, true);
+		}
+		SWAP(msg, next);
 	}
-	xlog_cursor_close(&cursor, false);
+out:
+	for (int i = 0; i < (int)lengthof(msgs); i++) {
+		snapshot_read_msg_wait(&msgs[i]);
+		snapshot_read_msg_destroy(&msgs[i]);
+	}
+	snapshot_reader_stop(&reader);
 	if (rc < 0)
 		return -1;
 
@@ -302,11 +588,13 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	 * marker - such snapshots are very likely corrupted and
 	 * should not be trusted.
 	 */
-	if (!xlog_cursor_is_eof(&cursor)) {
+	if (!is_eof) {
 		if (!memtx->force_recovery)
-			panic("snapshot `%s' has no EOF marker", cursor.name);
+			panic("snapshot `%s' has no EOF marker",
+			      reader.filename);
 		else
-			say_error("snapshot `%s' has no EOF marker", cursor.name);
+			say_error("snapshot `%s' has no EOF marker",
+				  reader.filename);
 	}
 
 	/*
@@ -317,7 +605,8 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 		diag_set(ClientError, ER_MISSING_SYSTEM_SPACES);
 		return -1;
 	}
-
+	/* Rows loaded from the snapshot are already checkpointed. */
+	memtx->dirty_rows = 0;
 	return 0;
 }
 
@@ -371,6 +660,116 @@ snapshot_recovery_state_update(enum snapshot_recovery_state *state,
 	return 0;
 }
 
+/**
+ * Recovers the order of a secondary index written to the snapshot by
+ * checkpoint_write_index_order(). The order is used for building the
+ * index after recovery. It's ignored if the index doesn't exist anymore
+ * or it's built right away, e.g. if force_recovery is set.
+ */
+static int
+memtx_engine_recover_index_order(struct memtx_engine *memtx,
+				 const struct xrow_header *row)
+{
+	assert(row->type == MEMTX_INDEX_ORDER);
+	const char *data = (const char *)row->body[0].iov_base;
+	const char *end = data + row->body[0].iov_len;
+	const char *pos = data;
+	if (mp_check(&pos, end) != 0 || pos != end ||
+	    mp_typeof(*data) != MP_MAP)
+		goto error;
+	uint32_t space_id, index_id, offset, size;
+	space_id = index_id = offset = size = UINT32_MAX;
+	const char *order;
+	order = NULL;
+	for (uint32_t i = mp_decode_map(&data); i > 0; i--) {
+		if (mp_typeof(*data) != MP_UINT)
+			goto error;
+		uint64_t key = mp_decode_uint(&data);
+		if (key == IPROTO_DATA) {
+			if (mp_typeof(*data) != MP_BIN)
+				goto error;
+			order = mp_decode_bin(&data, &size);
+			continue;
+		}
+		uint32_t *value = key == IPROTO_SPACE_ID ? &space_id :
+				  key == IPROTO_INDEX_ID ? &index_id :
+				  key == IPROTO_OFFSET ? &offset : NULL;
+		if (value == NULL) {
+			mp_next(&data);
+			continue;
+		}
+		if (mp_typeof(*data) != MP_UINT)
+			goto error;
+		*value = mp_decode_uint(&data);
+	}
+	if (space_id == UINT32_MAX || index_id == UINT32_MAX ||
+	    offset == UINT32_MAX || order == NULL ||
+	    size % sizeof(uint32_t) != 0)
+		goto error;
+	if (memtx->state != MEMTX_INITIAL_RECOVERY)
+		return 0;
+	struct space *space;
+	space = space_by_id(space_id);
+	if (space == NULL || space->engine != (struct engine *)memtx)
+		return 0;
+	struct index *index;
+	index = space_index(space, index_id);
+	if (index == NULL || index_id == 0 ||
+	    !memtx_tree_index_def_supports_order(index->def))
+		return 0;
+	memtx_tree_index_append_order(index, offset, order,
+				      size / sizeof(uint32_t));
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_MSGPACK, "index order");
+	return -1;
+}
+
+/**
+ * Check if a snapshot row can be loaded into the space directly,
+ * bypassing the transaction machinery. This is possible during
+ * the bulk load of the primary key, if there's nothing that may
+ * intercept or alter the statement: triggers, sequences, space
+ * upgrade or tuple compression.
+ */
+static bool
+memtx_engine_can_recover_tuple_fast(struct space *space,
+				    struct request *request)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	return request->type == IPROTO_INSERT &&
+	       memtx_space->replace == memtx_space_replace_build_next &&
+	       space->sequence == NULL && space->upgrade == NULL &&
+	       !space->format->is_compressed &&
+	       !space_has_before_replace_triggers(space) &&
+	       !space_has_on_replace_triggers(space);
+}
+
+/**
+ * Load a snapshot row into the space without starting a
+ * transaction. There's nothing to roll back: the primary key is
+ * built from scratch and an error aborts recovery, see
+ * memtx_engine_can_recover_tuple_fast().
+ */
+static int
+memtx_engine_recover_tuple_fast(struct space *space, struct request *request)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	struct tuple *tuple = space->format->vtab.tuple_new(
+		space->format, request->tuple, request->tuple_end);
+	if (tuple == NULL)
+		return -1;
+	tuple_ref(tuple);
+	struct tuple *unused;
+	int rc = memtx_space->replace(space, NULL, tuple, DUP_INSERT,
+				      &unused);
+	tuple_unref(tuple);
+	if (rc != 0)
+		return -1;
+	space->dml_count.insert++;
+	return 0;
+}
+
 static int
 memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row,
@@ -384,6 +783,8 @@ memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 			return memtx_engine_recover_raft(row);
 		if (row->type == IPROTO_RAFT_PROMOTE)
 			return memtx_engine_recover_synchro(row);
+		if (row->type == MEMTX_INDEX_ORDER)
+			return memtx_engine_recover_index_order(memtx, row);
 		diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
 			 (uint32_t) row->type);
 		return -1;
@@ -403,6 +804,11 @@ memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 		diag_set(ClientError, ER_CROSS_ENGINE_TRANSACTION);
 		goto log_request;
 	}
+	if (memtx_engine_can_recover_tuple_fast(space, &request)) {
+		if (memtx_engine_recover_tuple_fast(space, &request) != 0)
+			goto log_request;
+		return 0;
+	}
 	struct txn *txn;
 	txn = txn_begin();
 	if (txn == NULL)
@@ -558,6 +964,8 @@ struct memtx_read_view {
 	 * views from being freed.
 	 */
 	memtx_allocators_read_view allocators_rv;
+	/** Engine that created the read view. */
+	struct memtx_engine *memtx;
 };
 
 static void
@@ -565,6 +973,8 @@ memtx_engine_read_view_free(struct engine_read_view *base)
 {
 	struct memtx_read_view *rv = (struct memtx_read_view *)base;
 	memtx_allocators_close_read_view(rv->allocators_rv);
+	/* Free the tuples that were pinned by the read view. */
+	fiber_wakeup(rv->memtx->gc_fiber);
 	free(rv);
 }
 
@@ -576,11 +986,11 @@ memtx_engine_create_read_view(struct engine *engine,
 	static const struct engine_read_view_vtab vtab = {
 		.free = memtx_engine_read_view_free,
 	};
-	(void)engine;
 	struct memtx_read_view *rv =
 		(struct memtx_read_view *)xmalloc(sizeof(*rv));
 	rv->base.vtab = &vtab;
 	rv->allocators_rv = memtx_allocators_open_read_view(opts);
+	rv->memtx = (struct memtx_engine *)engine;
 	return (struct engine_read_view *)rv;
 }
 
@@ -785,6 +1195,11 @@ struct checkpoint {
 	struct xdir dir;
 	/** New snapshot file. */
 	struct xlog snap;
+	/**
+	 * A pipe from the snapshot writer thread to the tx thread used
+	 * for releasing space read views that have already been written.
+	 */
+	struct cpipe tx_pipe;
 	/** Raft request to be written to the snapshot file. */
 	struct raft_request raft;
 	/** Synchro request to be written to the snapshot file. */
@@ -794,6 +1209,11 @@ struct checkpoint {
 	 * checkpoint already exists.
 	 */
 	bool touch;
+	/**
+	 * Number of rows changed since the previous checkpoint,
+	 * see memtx_engine::dirty_rows.
+	 */
+	int64_t dirty_rows;
 };
 
 /** Space filter for checkpoint. */
@@ -818,6 +1238,20 @@ primary_index_filter(struct space *space, struct index *index, void *arg)
 	return index->def->iid == 0;
 }
 
+/**
+ * Index filter for a checkpoint that also stores the order of secondary
+ * indexes. The order is written only for user spaces because system
+ * spaces are fully built right from the start of recovery.
+ */
+static bool
+index_order_filter(struct space *space, struct index *index, void *arg)
+{
+	(void)arg;
+	return index->def->iid == 0 ||
+	       (!space_id_is_system(space->def->id) &&
+		memtx_tree_index_def_supports_order(index->def));
+}
+
 /*
  * Return true if tuple @a data represents temporary space's metadata.
  * @a space_id is used to determine the tuple's format.
@@ -859,7 +1293,8 @@ is_tuple_temporary(const char *data, uint32_t space_id,
 }
 
 static struct checkpoint *
-checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
+checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit,
+	       bool write_index_order)
 {
 	struct checkpoint *ckpt = (struct checkpoint *)malloc(sizeof(*ckpt));
 	if (ckpt == NULL) {
@@ -872,7 +1307,8 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 	rv_opts.name = "checkpoint";
 	rv_opts.is_system = true;
 	rv_opts.filter_space = checkpoint_space_filter;
-	rv_opts.filter_index = primary_index_filter;
+	rv_opts.filter_index = write_index_order ? index_order_filter :
+				primary_index_filter;
 	if (read_view_open(&ckpt->rv, &rv_opts) != 0) {
 		free(ckpt);
 		return NULL;
@@ -880,6 +1316,7 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 	ckpt->waiting_for_snap_thread = false;
 	struct xlog_opts opts = xlog_opts_default;
 	opts.rate_limit = snap_io_rate_limit;
+	opts.rate_limit_is_adaptive = true;
 	opts.sync_interval = SNAP_SYNC_INTERVAL;
 	opts.free_cache = true;
 	xdir_create(&ckpt->dir, snap_dirname, SNAP, &INSTANCE_UUID, &opts);
@@ -923,6 +1360,162 @@ replica_join_cancel(struct cord *replica_join_cord)
 	cord_cancel_and_join(replica_join_cord);
 }
 
+/** A request to delete a space read view sent to the tx thread. */
+struct checkpoint_release_msg {
+	struct cmsg base;
+	struct space_read_view *space_rv;
+};
+
+static void
+checkpoint_release_space_f(struct cmsg *base)
+{
+	struct checkpoint_release_msg *msg =
+		(struct checkpoint_release_msg *)base;
+	space_read_view_delete(msg->space_rv);
+	free(msg);
+}
+
+/**
+ * Removes a space that has been written to the snapshot from the
+ * checkpoint read view and sends its read view to the tx thread for
+ * deletion. Index read views pin frozen tree and hash blocks so the
+ * sooner they are released, the less memory the checkpoint takes.
+ */
+static void
+checkpoint_release_space(struct checkpoint *ckpt,
+			 struct space_read_view *space_rv)
+{
+	static const struct cmsg_hop route[1] = {
+		{checkpoint_release_space_f, NULL},
+	};
+	rlist_del(&space_rv->link);
+	struct checkpoint_release_msg *msg =
+		(struct checkpoint_release_msg *)xmalloc(sizeof(*msg));
+	cmsg_init(&msg->base, route);
+	msg->space_rv = space_rv;
+	/*
+	 * The snapshot writer thread doesn't yield so the pipe would
+	 * never be flushed by the event loop.
+	 */
+	cpipe_push_input(&ckpt->tx_pipe, &msg->base);
+	cpipe_deliver_now(&ckpt->tx_pipe);
+}
+
+enum {
+	/** Number of tuple positions in a MEMTX_INDEX_ORDER row. */
+	CHECKPOINT_INDEX_ORDER_CHUNK = 64 * 1024,
+};
+
+/**
+ * Write a MEMTX_INDEX_ORDER row storing @a count positions of tuples
+ * in the primary key, starting from position @a offset of the index.
+ * The positions are encoded as big-endian 32-bit integers in @a data.
+ */
+static int
+checkpoint_write_index_order_chunk(struct xlog *l,
+				   struct space_read_view *space_rv,
+				   uint32_t index_id, uint32_t offset,
+				   const char *data, uint32_t count)
+{
+	uint32_t size = count * sizeof(uint32_t);
+	char header[32];
+	char *pos = mp_encode_map(header, 4);
+	pos = mp_encode_uint(pos, IPROTO_SPACE_ID);
+	pos = mp_encode_uint(pos, space_rv->id);
+	pos = mp_encode_uint(pos, IPROTO_INDEX_ID);
+	pos = mp_encode_uint(pos, index_id);
+	pos = mp_encode_uint(pos, IPROTO_OFFSET);
+	pos = mp_encode_uint(pos, offset);
+	pos = mp_encode_uint(pos, IPROTO_DATA);
+	pos = mp_encode_binl(pos, size);
+	assert(pos <= header + sizeof(header));
+
+	struct xrow_header row;
+	memset(&row, 0, sizeof(struct xrow_header));
+	row.type = MEMTX_INDEX_ORDER;
+	row.group_id = space_rv->group_id;
+	row.bodycnt = 2;
+	row.body[0].iov_base = header;
+	row.body[0].iov_len = pos - header;
+	row.body[1].iov_base = (char *)data;
+	row.body[1].iov_len = size;
+	return checkpoint_write_row(l, &row);
+}
+
+/** Return true if the space read view has a secondary index. */
+static bool
+space_read_view_has_secondary_index(struct space_read_view *space_rv)
+{
+	for (uint32_t i = 1; i <= space_rv->index_id_max; i++) {
+		if (space_read_view_index(space_rv, i) != NULL)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Write the order of secondary indexes of a space as permutations of
+ * the primary key, which has just been written to the snapshot, so that
+ * the indexes can be built without sorting on recovery. @a pk_pos maps
+ * tuple data to its position in the primary key.
+ *
+ * If a tuple isn't found in the map, for example, because it was
+ * decompressed, the rest of the order is skipped. Recovery ignores
+ * incomplete orders.
+ */
+static int
+checkpoint_write_index_order(struct xlog *l, struct space_read_view *space_rv,
+			     struct mh_i64ptr_t *pk_pos)
+{
+	char *chunk = (char *)xmalloc(CHECKPOINT_INDEX_ORDER_CHUNK *
+				      sizeof(uint32_t));
+	int rc = 0;
+	for (uint32_t iid = 1; iid <= space_rv->index_id_max; iid++) {
+		struct index_read_view *index_rv =
+			space_read_view_index(space_rv, iid);
+		if (index_rv == NULL)
+			continue;
+		struct index_read_view_iterator it;
+		rc = index_read_view_create_iterator(index_rv, ITER_ALL,
+						     NULL, 0, &it);
+		if (rc != 0)
+			break;
+		uint32_t offset = 0;
+		uint32_t count = 0;
+		while (true) {
+			RegionGuard region_guard(&fiber()->gc);
+			struct read_view_tuple result;
+			rc = index_read_view_iterator_next_raw(&it, &result);
+			if (rc != 0 || result.data == NULL)
+				break;
+			mh_int_t k = mh_i64ptr_find(
+				pk_pos, (uint64_t)(uintptr_t)result.data, NULL);
+			if (k == mh_end(pk_pos))
+				break;
+			uint32_t pos = (uintptr_t)mh_i64ptr_node(pk_pos,
+								 k)->val;
+			mp_store_u32(chunk + count * sizeof(uint32_t), pos);
+			if (++count < CHECKPOINT_INDEX_ORDER_CHUNK)
+				continue;
+			rc = checkpoint_write_index_order_chunk(
+				l, space_rv, iid, offset, chunk, count);
+			if (rc != 0)
+				break;
+			offset += count;
+			count = 0;
+		}
+		index_read_view_iterator_destroy(&it);
+		if (rc == 0 && count > 0) {
+			rc = checkpoint_write_index_order_chunk(
+				l, space_rv, iid, offset, chunk, count);
+		}
+		if (rc != 0)
+			break;
+	}
+	free(chunk);
+	return rc;
+}
+
 static int
 checkpoint_write_raft(struct xlog *l, const struct raft_request *req)
 {
@@ -1040,12 +1633,16 @@ checkpoint_f(va_list ap)
 	}
 
 	struct mh_i32_t *temp_space_ids = mh_i32_new();
+	cpipe_create(&ckpt->tx_pipe, "tx_prio");
 
-	say_info("saving snapshot `%s'", snap->filename);
+	say_info("saving snapshot `%s', %lld rows changed since "
+		 "the previous one", snap->filename,
+		 (long long)ckpt->dirty_rows);
 	ERROR_INJECT_SLEEP(ERRINJ_SNAP_WRITE_DELAY);
 	ERROR_INJECT(ERRINJ_SNAP_SKIP_ALL_ROWS, goto done);
-	struct space_read_view *space_rv;
-	read_view_foreach_space(space_rv, &ckpt->rv) {
+	struct space_read_view *space_rv, *next_space_rv;
+	rlist_foreach_entry_safe(space_rv, &ckpt->rv.spaces, link,
+				 next_space_rv) {
 		FiberGCChecker gc_check;
 		bool skip = false;
 		ERROR_INJECT(ERRINJ_SNAP_SKIP_DDL_ROWS, {
@@ -1053,6 +1650,11 @@ checkpoint_f(va_list ap)
 		});
 		if (skip)
 			continue;
+		ERROR_INJECT_INT(ERRINJ_SNAP_WRITE_SPACE_DELAY,
+				 inj->iparam == (int64_t)space_rv->id, {
+			while (inj->iparam == (int64_t)space_rv->id)
+				usleep(1000);
+		});
 		struct index_read_view *index_rv =
 			space_read_view_index(space_rv, 0);
 		assert(index_rv != NULL);
@@ -1062,6 +1664,11 @@ checkpoint_f(va_list ap)
 			rc = -1;
 			break;
 		}
+		/* Map: tuple data -> position in the primary key. */
+		struct mh_i64ptr_t *pk_pos = NULL;
+		if (space_read_view_has_secondary_index(space_rv))
+			pk_pos = mh_i64ptr_new();
+		uint32_t pk_size = 0;
 		while (true) {
 			RegionGuard region_guard(&fiber()->gc);
 			struct read_view_tuple result;
@@ -1077,10 +1684,24 @@ checkpoint_f(va_list ap)
 						    result.data, result.size);
 			if (rc != 0)
 				break;
+			if (pk_pos != NULL) {
+				struct mh_i64ptr_node_t node = {
+					(uint64_t)(uintptr_t)result.data,
+					(void *)(uintptr_t)pk_size,
+				};
+				mh_i64ptr_put(pk_pos, &node, NULL, NULL);
+			}
+			pk_size++;
 		}
 		index_read_view_iterator_destroy(&it);
+		if (rc == 0 && pk_pos != NULL)
+			rc = checkpoint_write_index_order(snap, space_rv,
+							  pk_pos);
+		if (pk_pos != NULL)
+			mh_i64ptr_delete(pk_pos);
 		if (rc != 0)
 			break;
+		checkpoint_release_space(ckpt, space_rv);
 	}
 	mh_i32_delete(temp_space_ids);
 	if (rc != 0)
@@ -1107,11 +1728,15 @@ checkpoint_f(va_list ap)
 		goto fail;
 	goto done;
 done:
-	if (xlog_close(snap) != 0)
-		goto fail;
+	cpipe_destroy(&ckpt->tx_pipe);
+	if (xlog_close(snap) != 0) {
+		xlog_discard(snap);
+		return -1;
+	}
 	say_info("done");
 	return 0;
 fail:
+	cpipe_destroy(&ckpt->tx_pipe);
 	xlog_discard(snap);
 	return -1;
 }
@@ -1124,9 +1749,16 @@ memtx_engine_begin_checkpoint(struct engine *engine, bool is_scheduled)
 
 	assert(memtx->checkpoint == NULL);
 	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
-					   memtx->snap_io_rate_limit);
+					   memtx->snap_io_rate_limit,
+					   memtx->snapshot_index_order);
 	if (memtx->checkpoint == NULL)
 		return -1;
+	/*
+	 * Rows changed from now on go to the next checkpoint since
+	 * the read view has just been opened.
+	 */
+	memtx->checkpoint->dirty_rows = memtx->dirty_rows;
+	memtx->dirty_rows = 0;
 	return 0;
 }
 
@@ -1219,6 +1851,8 @@ memtx_engine_abort_checkpoint(struct engine *engine)
 	assert(!xlog_is_open(&memtx->checkpoint->snap));
 
 	coio_call(memtx_engine_abort_checkpoint_f, &memtx->checkpoint->snap);
+	/* The changed rows will have to be written by the next checkpoint. */
+	memtx->dirty_rows += memtx->checkpoint->dirty_rows;
 	checkpoint_delete(memtx->checkpoint);
 	memtx->checkpoint = NULL;
 }
@@ -1422,9 +2056,23 @@ static const struct engine_vtab memtx_engine_vtab = {
 static void
 memtx_engine_run_gc(struct memtx_engine *memtx, bool *stop)
 {
-	*stop = stailq_empty(&memtx->gc_queue);
-	if (*stop)
+	if (stailq_empty(&memtx->gc_queue)) {
+		/*
+		 * Free the tuples that were pinned by closed read views.
+		 * The allocator frees them on allocation, too, but doing
+		 * it here doesn't slow down inserts, and memory freed by
+		 * a big truncate or drop during a checkpoint is returned
+		 * even if nothing is allocated.
+		 */
+		*stop = true;
+		for (int i = 0; i < MEMTX_GC_ALLOCATOR_STEPS; i++) {
+			if (!memtx_allocators_collect_garbage())
+				return;
+		}
+		*stop = false;
 		return;
+	}
+	*stop = false;
 
 	struct memtx_gc_task *task = stailq_first_entry(&memtx->gc_queue,
 					struct memtx_gc_task, link);
@@ -1720,6 +2368,12 @@ memtx_engine_stat_tx(struct memtx_engine *memtx, struct info_handler *h)
 		info_table_end(h);
 	}
 	info_table_end(h); /* tuples */
+	info_table_begin(h, "gc");
+	info_append_int(h, "steps", stats.gc_steps);
+	info_append_int(h, "reclaimed", stats.gc_reclaimed);
+	info_append_int(h, "pending", stats.gc_pending);
+	info_append_int(h, "lag", stats.gc_lag);
+	info_table_end(h); /* gc */
 	info_table_end(h); /* mvcc */
 	info_table_end(h); /* tx */
 }
@@ -1738,6 +2392,16 @@ memtx_engine_stat_data(struct memtx_engine *memtx, struct info_handler *h)
 	info_table_end(h); /* data */
 }
 
+/** Appends memtx checkpoint stats to info. */
+static void
+memtx_engine_stat_checkpoint(struct memtx_engine *memtx,
+			     struct info_handler *h)
+{
+	info_table_begin(h, "checkpoint");
+	info_append_int(h, "dirty_rows", memtx->dirty_rows);
+	info_table_end(h); /* checkpoint */
+}
+
 /** Appends memtx index stats to info. */
 static void
 memtx_engine_stat_index(struct memtx_engine *memtx, struct info_handler *h)
@@ -1758,6 +2422,7 @@ memtx_engine_stat(struct memtx_engine *memtx, struct info_handler *h)
 	memtx_engine_stat_data(memtx, h);
 	memtx_engine_stat_index(memtx, h);
 	memtx_engine_stat_tx(memtx, h);
+	memtx_engine_stat_checkpoint(memtx, h);
 	info_end(h);
 }
 
@@ -1775,6 +2440,24 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_snapshot_index_order(struct memtx_engine *memtx, bool value)
+{
+	memtx->snapshot_index_order = value;
+}
+
+void
+memtx_engine_use_hugepages(struct memtx_engine *memtx)
+{
+	if (tuple_arena_use_hugepages(&memtx->arena) != 0) {
+		diag_log();
+		say_warn("memtx arena falls back to regular pages");
+		return;
+	}
+	memtx->use_hugepages = true;
+	say_info("memtx arena is backed by transparent huge pages");
+}
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size)
 {
@@ -1797,33 +2480,27 @@ memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size)
 	memtx->max_tuple_size = max_size;
 }
 
+/**
+ * Allocate a memtx tuple with room for a field map of the given size
+ * and the given MessagePack data, which is copied to the tuple. The
+ * field map is left uninitialized. On error returns NULL and sets diag.
+ */
 template<class ALLOC>
 static struct tuple *
-memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
-			 const char *end, bool validate)
+memtx_tuple_alloc(struct tuple_format *format, uint32_t field_map_size,
+		  const char *data, const char *end)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)format->engine;
-	assert(mp_typeof(*data) == MP_ARRAY);
 	struct tuple *tuple = NULL;
-	struct region *region = &fiber()->gc;
-	size_t region_svp = region_used(region);
-	struct field_map_builder builder;
-	size_t total, tuple_len;
-	uint32_t data_offset, field_map_size;
-	char *raw;
-	bool make_compact;
-	if (tuple_field_map_create(format, data, validate, &builder) != 0)
-		goto end;
-	field_map_size = field_map_build_size(&builder);
-	data_offset = sizeof(struct tuple) + field_map_size;
+	uint32_t data_offset = sizeof(struct tuple) + field_map_size;
 	if (tuple_check_data_offset(data_offset) != 0)
-		goto end;
+		return NULL;
 
-	tuple_len = end - data;
+	size_t tuple_len = end - data;
 	assert(tuple_len <= UINT32_MAX); /* bsize is UINT32_MAX */
-	total = sizeof(struct tuple) + field_map_size + tuple_len;
+	size_t total = sizeof(struct tuple) + field_map_size + tuple_len;
 
-	make_compact = tuple_can_be_compact(data_offset, tuple_len);
+	bool make_compact = tuple_can_be_compact(data_offset, tuple_len);
 	if (make_compact) {
 		data_offset -= TUPLE_COMPACT_SAVINGS;
 		total -= TUPLE_COMPACT_SAVINGS;
@@ -1831,12 +2508,12 @@ memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
 
 	ERROR_INJECT(ERRINJ_TUPLE_ALLOC, {
 		diag_set(OutOfMemory, total, "slab allocator", "memtx_tuple");
-		goto end;
+		return NULL;
 	});
 	if (unlikely(total > memtx->max_tuple_size)) {
 		diag_set(ClientError, ER_MEMTX_MAX_TUPLE_SIZE, total);
 		error_log(diag_last_error(diag_get()));
-		goto end;
+		return NULL;
 	}
 
 	while ((tuple = MemtxAllocator<ALLOC>::alloc_tuple(total)) == NULL) {
@@ -1847,21 +2524,73 @@ memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
 	}
 	if (tuple == NULL) {
 		diag_set(OutOfMemory, total, "slab allocator", "memtx_tuple");
-		goto end;
+		return NULL;
 	}
 	tuple_create(tuple, 0, tuple_format_id(format),
 		     data_offset, tuple_len, make_compact);
 	if (format->is_temporary)
 		tuple_set_flag(tuple, TUPLE_IS_TEMPORARY);
 	tuple_format_ref(format);
-	raw = (char *) tuple + data_offset;
-	field_map_build(&builder, raw - field_map_size);
-	memcpy(raw, data, tuple_len);
+	memcpy((char *)tuple + data_offset, data, tuple_len);
+	return tuple;
+}
+
+template<class ALLOC>
+static struct tuple *
+memtx_tuple_new_raw_impl(struct tuple_format *format, const char *data,
+			 const char *end, bool validate)
+{
+	assert(mp_typeof(*data) == MP_ARRAY);
+	struct tuple *tuple = NULL;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct field_map_builder builder;
+	uint32_t field_map_size;
+	if (tuple_field_map_create(format, data, validate, &builder) != 0)
+		goto end;
+	field_map_size = field_map_build_size(&builder);
+	tuple = memtx_tuple_alloc<ALLOC>(format, field_map_size, data, end);
+	if (tuple == NULL)
+		goto end;
+	field_map_build(&builder, (char *)tuple_data(tuple) - field_map_size);
 end:
 	region_truncate(region, region_svp);
 	return tuple;
 }
 
+template<class ALLOC>
+static struct tuple *
+memtx_tuple_new_from_update_impl(struct tuple_format *format,
+				 struct tuple *old_tuple, const char *data,
+				 const char *end, uint64_t column_mask)
+{
+	/*
+	 * The field map layout is defined by the format, so it can
+	 * only be reused if the old tuple has the same format.
+	 */
+	if (tuple_format(old_tuple) != format || format->is_compressed)
+		return memtx_tuple_new_raw_impl<ALLOC>(format, data, end, true);
+	uint32_t old_bsize;
+	const char *old_data = tuple_data_range(old_tuple, &old_bsize);
+	int rc = tuple_validate_update(format, old_data, old_data + old_bsize,
+				       data, column_mask);
+	if (rc < 0)
+		return NULL;
+	if (rc > 0)
+		return memtx_tuple_new_raw_impl<ALLOC>(format, data, end, true);
+	uint32_t field_map_size = tuple_data_offset(old_tuple) -
+				  sizeof(struct tuple);
+	if (tuple_is_compact(old_tuple))
+		field_map_size += TUPLE_COMPACT_SAVINGS;
+	struct tuple *tuple = memtx_tuple_alloc<ALLOC>(format, field_map_size,
+						       data, end);
+	if (tuple == NULL)
+		return NULL;
+	memcpy((char *)tuple_data(tuple) - field_map_size,
+	       old_data - field_map_size, field_map_size);
+	return tuple;
+}
+
 template<class ALLOC>
 static inline struct tuple *
 memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
@@ -2093,7 +2822,8 @@ memtx_prepare_read_view_tuple(struct tuple *tuple,
 				memtx_read_view_tuple_needs_upgrade(
 					index->space->upgrade, tuple);
 	result->data = tuple_data_range(tuple, &result->size);
-	if (!index->space->rv->disable_decompression) {
+	if (!index->space->rv->disable_decompression &&
+	    tuple_is_compressed(tuple)) {
 		result->data = memtx_tuple_decompress_raw(
 				result->data, result->data + result->size,
 				&result->size);
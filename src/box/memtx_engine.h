@@ -124,8 +124,19 @@ struct memtx_engine {
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * Write the order of secondary tree indexes to snapshots so that
+	 * they can be built without sorting on recovery.
+	 */
+	bool snapshot_index_order;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
+	/**
+	 * Number of rows changed in checkpointed memtx spaces since
+	 * the last checkpoint was started. Rolled back changes are
+	 * counted, too.
+	 */
+	int64_t dirty_rows;
 	/**
 	 * Cord being currently used to join replica. It is only
 	 * needed to be able to cancel it on shutdown.
@@ -145,6 +156,8 @@ struct memtx_engine {
 	 * is reflected in box.slab.info(), @sa lua/slab.c.
 	 */
 	struct slab_arena arena;
+	/** Set if the arena is backed by transparent huge pages. */
+	bool use_hugepages;
 	/** Slab cache for allocating tuples. */
 	struct slab_cache slab_cache;
 	/** Slab cache for allocating index extents. */
@@ -242,9 +255,20 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
+void
+memtx_engine_set_snapshot_index_order(struct memtx_engine *memtx, bool value);
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size);
 
+/**
+ * Back the memtx arena, which stores tuples and index extents,
+ * with transparent huge pages, box.cfg.memtx_use_hugepages.
+ * Falls back to regular pages with a warning on failure.
+ */
+void
+memtx_engine_use_hugepages(struct memtx_engine *memtx);
+
 void
 memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size);
 
@@ -264,6 +288,19 @@ extern struct tuple *
 (*memtx_tuple_new_raw)(struct tuple_format *format, const char *data,
 		       const char *end, bool validate);
 
+/**
+ * Allocate and return a new memtx tuple with the given data produced
+ * by an update of @a old_tuple that changed only the fields marked in
+ * @a column_mask. If the update didn't touch the indexed fields, only
+ * the changed fields are validated and the field map of the old tuple
+ * is copied instead of being built from scratch. On error returns NULL
+ * and sets diag.
+ */
+extern struct tuple *
+(*memtx_tuple_new_from_update)(struct tuple_format *format,
+			       struct tuple *old_tuple, const char *data,
+			       const char *end, uint64_t column_mask);
+
 /**
  * Allocate a block of size MEMTX_EXTENT_SIZE for memtx index
  * @ctx must point to memtx engine
@@ -323,20 +323,15 @@ memtx_hash_index_count(struct index *base, enum iterator_type type,
 	return generic_index_count(base, type, key, part_count);
 }
 
-static int
-memtx_hash_index_get_internal(struct index *base, const char *key,
-			      uint32_t part_count, struct tuple **result)
+/** Look up a full key with the given hash. */
+static void
+memtx_hash_index_get_by_hash(struct memtx_hash_index *index,
+			     struct space *space, const char *key,
+			     uint32_t h, struct tuple **result)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-
-	assert(base->def->opts.is_unique &&
-	       part_count == base->def->key_def->part_count);
-	(void) part_count;
-
-	struct space *space = space_by_id(base->def->space_id);
+	struct index *base = &index->base;
 	struct txn *txn = in_txn();
 	*result = NULL;
-	uint32_t h = key_hash(key, base->def->key_def);
 	uint32_t k = light_index_find_key(&index->hash_table, h, key);
 	if (k != light_index_end) {
 		struct tuple *tuple = light_index_get(&index->hash_table, k);
@@ -349,6 +344,60 @@ memtx_hash_index_get_internal(struct index *base, const char *key,
 		memtx_tx_track_point(txn, space, base, key);
 /*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
 	}
+}
+
+static int
+memtx_hash_index_get_internal(struct index *base, const char *key,
+			      uint32_t part_count, struct tuple **result)
+{
+	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+
+	assert(base->def->opts.is_unique &&
+	       part_count == base->def->key_def->part_count);
+	(void) part_count;
+
+	struct space *space = space_by_id(base->def->space_id);
+	uint32_t h = key_hash(key, base->def->key_def);
+	memtx_hash_index_get_by_hash(index, space, key, h, result);
+	return 0;
+}
+
+/**
+ * Number of keys hashed and prefetched by memtx_hash_index_get_batch()
+ * before looking them up, so that fetching the hash table slot of one
+ * key from memory overlaps with looking up the others.
+ */
+enum { MEMTX_HASH_GET_BATCH_SIZE = 16 };
+
+static int
+memtx_hash_index_get_batch(struct index *base, const char **keys,
+			   uint32_t count, struct tuple **results)
+{
+	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct space *space = space_by_id(base->def->space_id);
+	struct key_def *key_def = base->def->key_def;
+	uint32_t hashes[MEMTX_HASH_GET_BATCH_SIZE];
+	for (uint32_t i = 0; i < count; i += MEMTX_HASH_GET_BATCH_SIZE) {
+		uint32_t n = MIN(count - i, (uint32_t)MEMTX_HASH_GET_BATCH_SIZE);
+		for (uint32_t j = 0; j < n; j++) {
+			hashes[j] = key_hash(keys[i + j], key_def);
+			light_index_prefetch(&index->hash_table, hashes[j]);
+		}
+		for (uint32_t j = 0; j < n; j++) {
+			struct tuple **result = &results[i + j];
+			memtx_hash_index_get_by_hash(index, space, keys[i + j],
+						     hashes[j], result);
+			if (memtx_prepare_result_tuple(result) != 0) {
+				for (uint32_t k = 0; k < i + j; k++) {
+					if (results[k] != NULL)
+						tuple_unref(results[k]);
+				}
+				return -1;
+			}
+			if (*result != NULL)
+				tuple_ref(*result);
+		}
+	}
 	return 0;
 }
 
@@ -674,6 +723,7 @@ static const struct index_vtab memtx_hash_index_vtab = {
 	/* .count = */ memtx_hash_index_count,
 	/* .get_internal = */ memtx_hash_index_get_internal,
 	/* .get = */ memtx_index_get,
+	/* .get_batch = */ memtx_hash_index_get_batch,
 	/* .replace = */ memtx_hash_index_replace,
 	/* .create_iterator = */ memtx_hash_index_create_iterator,
 	/* .create_read_view = */ memtx_hash_index_create_read_view,
@@ -0,0 +1,473 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_hnsw.h"
+
+#include <math.h>
+#include <salad/hnsw.h>
+#include <small/mempool.h>
+
+#include "trivia/util.h"
+
+#include "fiber.h"
+#include "index.h"
+#include "schema.h"
+#include "tuple.h"
+#include "txn.h"
+#include "memtx_tx.h"
+#include "memtx_engine.h"
+
+enum {
+	/** Number of neighbors an iterator looks up at first. */
+	MEMTX_HNSW_BATCH_SIZE_MIN = 16,
+	/** Min size of the search queue used by iterators. */
+	MEMTX_HNSW_EF_SEARCH_MIN = 64,
+};
+
+static_assert((int)HNSW_METRIC_L2 == (int)RTREE_INDEX_DISTANCE_TYPE_EUCLID &&
+	      (int)HNSW_METRIC_L1 ==
+	      (int)RTREE_INDEX_DISTANCE_TYPE_MANHATTAN &&
+	      (int)HNSW_METRIC_COSINE == (int)RTREE_INDEX_DISTANCE_TYPE_COSINE &&
+	      (int)HNSW_METRIC_DOT == (int)RTREE_INDEX_DISTANCE_TYPE_DOT,
+	      "HNSW metrics must match index distance types");
+
+struct memtx_hnsw_index {
+	struct index base;
+	/** The graph, data attached to vectors are tuples. */
+	struct hnsw hnsw;
+	/** Buffer for a decoded tuple vector. */
+	float *vector;
+	/**
+	 * Incremented on every change of the index so that iterators
+	 * know that the neighbors they found may have been deleted.
+	 */
+	uint32_t version;
+};
+
+/** Decode `dimension` numbers from MsgPack. */
+static int
+memtx_hnsw_decode_vector(const char **data, uint32_t dimension, float *vector)
+{
+	for (uint32_t i = 0; i < dimension; i++) {
+		double c;
+		if (mp_read_double(data, &c) != 0) {
+			diag_set(ClientError, ER_FIELD_TYPE,
+				 int2str(i + TUPLE_INDEX_BASE),
+				 field_type_strs[FIELD_TYPE_NUMBER],
+				 mp_type_strs[mp_typeof(**data)]);
+			return -1;
+		}
+		vector[i] = c;
+	}
+	return 0;
+}
+
+/** Decode the vector of a tuple into index->vector. */
+static int
+memtx_hnsw_index_decode_tuple(struct memtx_hnsw_index *index,
+			      struct tuple *tuple)
+{
+	const char *field = tuple_field_by_part(tuple,
+			index->base.def->key_def->parts, MULTIKEY_NONE);
+	assert(field != NULL && mp_typeof(*field) == MP_ARRAY);
+	uint32_t dimension = index->hnsw.dimension;
+	if (mp_decode_array(&field) != dimension) {
+		diag_set(ClientError, ER_HNSW_VECTOR, "Field", dimension);
+		return -1;
+	}
+	return memtx_hnsw_decode_vector(&field, dimension, index->vector);
+}
+
+/**
+ * Decode a key vector: either an array of `dimension` numbers or
+ * `dimension` number parts.
+ */
+static int
+memtx_hnsw_index_decode_key(struct memtx_hnsw_index *index, const char *key,
+			    uint32_t part_count, float *vector)
+{
+	uint32_t dimension = index->hnsw.dimension;
+	uint32_t count = part_count;
+	if (part_count == 1 && mp_typeof(*key) == MP_ARRAY)
+		count = mp_decode_array(&key);
+	if (count != dimension) {
+		diag_set(ClientError, ER_HNSW_VECTOR, "Key", dimension);
+		return -1;
+	}
+	return memtx_hnsw_decode_vector(&key, dimension, vector);
+}
+
+struct hnsw_index_iterator {
+	struct iterator base; /* Must be the first member. */
+	/** Memory pool the iterator was allocated from. */
+	struct mempool *pool;
+	/** Key vector or NULL for ITER_ALL. */
+	float *query;
+	/** Position of ITER_ALL, see hnsw_next(). */
+	uint32_t all_pos;
+	/** Number of neighbors requested by the last search. */
+	uint32_t batch_size;
+	/** Number of neighbors found by the last search. */
+	uint32_t batch_count;
+	/** Position of the next neighbor to return in the batch. */
+	uint32_t batch_pos;
+	/** Neighbors found by the last search. */
+	struct hnsw_neighbor *batch;
+	/** Version of the index the last search was done at. */
+	uint32_t version;
+	/** Distance of the last returned neighbor. */
+	float last_distance;
+	/** Number of returned neighbors at last_distance. */
+	uint32_t last_distance_count;
+};
+
+static_assert(sizeof(struct hnsw_index_iterator) <= MEMTX_ITERATOR_SIZE,
+	      "sizeof(struct hnsw_index_iterator) must be less than or equal "
+	      "to MEMTX_ITERATOR_SIZE");
+
+static struct hnsw_index_iterator *
+hnsw_index_iterator(struct iterator *it)
+{
+	return (struct hnsw_index_iterator *)it;
+}
+
+static void
+hnsw_index_iterator_free(struct iterator *iterator)
+{
+	assert(iterator->free == hnsw_index_iterator_free);
+	struct hnsw_index_iterator *it = hnsw_index_iterator(iterator);
+	free(it->batch);
+	free(it->query);
+	mempool_free(it->pool, it);
+}
+
+/**
+ * Look up the next batch of neighbors. The graph search can't be
+ * resumed, so it's repeated with a greater number of neighbors and
+ * the ones closer than the last returned neighbor are skipped. The
+ * same is done if the index changes, since the found tuples may have
+ * been deleted.
+ */
+static int
+hnsw_index_iterator_search(struct hnsw_index_iterator *it)
+{
+	struct memtx_hnsw_index *index =
+		(struct memtx_hnsw_index *)it->base.index;
+	do {
+		if (it->version == index->version) {
+			/* The current batch is exhausted. */
+			if (it->batch_count < it->batch_size) {
+				it->batch_pos = it->batch_count = 0;
+				return 0;
+			}
+			it->batch_size *= 2;
+		}
+		size_t size = it->batch_size * sizeof(*it->batch);
+		struct hnsw_neighbor *batch =
+			(struct hnsw_neighbor *)realloc(it->batch, size);
+		if (batch == NULL) {
+			diag_set(OutOfMemory, size, "realloc", "neighbors");
+			return -1;
+		}
+		it->batch = batch;
+		uint32_t ef = MAX(it->batch_size,
+				  (uint32_t)MEMTX_HNSW_EF_SEARCH_MIN);
+		it->batch_count = hnsw_search(&index->hnsw, it->query,
+					      it->batch_size, ef, it->batch);
+		it->version = index->version;
+		it->batch_pos = 0;
+		uint32_t ties = 0;
+		while (it->batch_pos < it->batch_count) {
+			float distance = it->batch[it->batch_pos].distance;
+			if (distance < it->last_distance) {
+				it->batch_pos++;
+			} else if (distance == it->last_distance &&
+				   ties < it->last_distance_count) {
+				ties++;
+				it->batch_pos++;
+			} else {
+				break;
+			}
+		}
+	} while (it->batch_pos == it->batch_count);
+	return 0;
+}
+
+static int
+hnsw_index_iterator_next_neighbor(struct iterator *iterator,
+				  struct tuple **ret)
+{
+	assert(iterator->free == hnsw_index_iterator_free);
+	struct hnsw_index_iterator *it = hnsw_index_iterator(iterator);
+	struct memtx_hnsw_index *index =
+		(struct memtx_hnsw_index *)iterator->index;
+
+	do {
+		if (it->version != index->version ||
+		    it->batch_pos == it->batch_count) {
+			if (hnsw_index_iterator_search(it) != 0)
+				return -1;
+			if (it->batch_pos == it->batch_count) {
+				iterator->next_internal =
+					exhausted_iterator_next;
+				*ret = NULL;
+				return 0;
+			}
+		}
+		struct hnsw_neighbor *neighbor = &it->batch[it->batch_pos++];
+		if (neighbor->distance == it->last_distance) {
+			it->last_distance_count++;
+		} else {
+			it->last_distance = neighbor->distance;
+			it->last_distance_count = 1;
+		}
+		struct txn *txn = in_txn();
+		struct space *space = space_by_id(iterator->space_id);
+		*ret = memtx_tx_tuple_clarify(txn, space,
+					      (struct tuple *)neighbor->data,
+					      iterator->index, 0);
+/********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
+		memtx_tx_story_gc();
+/*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
+	} while (*ret == NULL);
+
+	return 0;
+}
+
+static int
+hnsw_index_iterator_next_all(struct iterator *iterator, struct tuple **ret)
+{
+	assert(iterator->free == hnsw_index_iterator_free);
+	struct hnsw_index_iterator *it = hnsw_index_iterator(iterator);
+	struct memtx_hnsw_index *index =
+		(struct memtx_hnsw_index *)iterator->index;
+
+	do {
+		struct tuple *tuple =
+			(struct tuple *)hnsw_next(&index->hnsw, &it->all_pos);
+		if (tuple == NULL) {
+			iterator->next_internal = exhausted_iterator_next;
+			*ret = NULL;
+			return 0;
+		}
+		struct txn *txn = in_txn();
+		struct space *space = space_by_id(iterator->space_id);
+		*ret = memtx_tx_tuple_clarify(txn, space, tuple,
+					      iterator->index, 0);
+/********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
+		memtx_tx_story_gc();
+/*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
+	} while (*ret == NULL);
+
+	return 0;
+}
+
+static void
+memtx_hnsw_index_destroy(struct index *base)
+{
+	struct memtx_hnsw_index *index = (struct memtx_hnsw_index *)base;
+	hnsw_destroy(&index->hnsw);
+	free(index->vector);
+	free(index);
+}
+
+static bool
+memtx_hnsw_index_def_change_requires_rebuild(struct index *index,
+					     const struct index_def *new_def)
+{
+	if (memtx_index_def_change_requires_rebuild(index, new_def))
+		return true;
+	if (index->def->opts.distance != new_def->opts.distance ||
+	    index->def->opts.dimension != new_def->opts.dimension)
+		return true;
+	return false;
+}
+
+static ssize_t
+memtx_hnsw_index_size(struct index *base)
+{
+	struct memtx_hnsw_index *index = (struct memtx_hnsw_index *)base;
+	struct space *space = space_by_id(base->def->space_id);
+	/* Substract invisible count. */
+	return hnsw_size(&index->hnsw) -
+	       memtx_tx_index_invisible_count(in_txn(), space, base);
+}
+
+static ssize_t
+memtx_hnsw_index_bsize(struct index *base)
+{
+	struct memtx_hnsw_index *index = (struct memtx_hnsw_index *)base;
+	return hnsw_bsize(&index->hnsw);
+}
+
+static int
+memtx_hnsw_index_replace(struct index *base, struct tuple *old_tuple,
+			 struct tuple *new_tuple, enum dup_replace_mode mode,
+			 struct tuple **result, struct tuple **successor)
+{
+	struct memtx_hnsw_index *index = (struct memtx_hnsw_index *)base;
+
+	/* HNSW index doesn't support ordering. */
+	*successor = NULL;
+
+	assert(!base->def->opts.is_unique);
+	assert(!base->def->key_def->is_multikey);
+	assert(old_tuple != NULL || new_tuple != NULL);
+	assert(old_tuple != new_tuple);
+	(void)mode;
+
+	*result = NULL;
+
+	/*
+	 * Insert the new tuple first: the insertion may fail, and
+	 * the index must be left intact in this case.
+	 */
+	if (new_tuple != NULL) {
+		if (memtx_hnsw_index_decode_tuple(index, new_tuple) != 0)
+			return -1;
+		if (hnsw_insert(&index->hnsw, index->vector, new_tuple) != 0) {
+			diag_set(OutOfMemory, index->hnsw.dimension *
+				 sizeof(*index->vector), "hnsw_insert", "node");
+			return -1;
+		}
+	}
+	if (old_tuple != NULL && hnsw_delete(&index->hnsw, old_tuple))
+		*result = old_tuple;
+	index->version++;
+	return 0;
+}
+
+static struct iterator *
+memtx_hnsw_index_create_iterator(struct index *base, enum iterator_type type,
+				 const char *key, uint32_t part_count,
+				 const char *pos)
+{
+	struct memtx_hnsw_index *index = (struct memtx_hnsw_index *)base;
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+
+	assert(part_count == 0 || key != NULL);
+	if (pos != NULL) {
+		diag_set(UnsupportedIndexFeature, base->def, "pagination");
+		return NULL;
+	}
+	if (part_count == 0)
+		type = ITER_ALL;
+	if (type != ITER_ALL && type != ITER_NEIGHBOR) {
+		diag_set(UnsupportedIndexFeature, base->def,
+			 "requested iterator type");
+		return NULL;
+	}
+
+	struct hnsw_index_iterator *it = (struct hnsw_index_iterator *)
+		mempool_alloc(&memtx->iterator_pool);
+	if (it == NULL) {
+		diag_set(OutOfMemory, sizeof(*it),
+			 "memtx_hnsw_index", "iterator");
+		return NULL;
+	}
+
+	iterator_create(&it->base, base);
+	it->pool = &memtx->iterator_pool;
+	it->base.next_internal = hnsw_index_iterator_next_all;
+	it->base.next = memtx_iterator_next;
+	it->base.position = generic_iterator_position;
+	it->base.free = hnsw_index_iterator_free;
+	it->query = NULL;
+	it->all_pos = 0;
+	it->batch = NULL;
+	it->batch_count = 0;
+	it->batch_pos = 0;
+	it->last_distance = -INFINITY;
+	it->last_distance_count = 0;
+	/* Force the first search. */
+	it->version = index->version - 1;
+
+	if (type == ITER_NEIGHBOR) {
+		uint32_t dimension = index->hnsw.dimension;
+		size_t size = dimension * sizeof(*it->query);
+		it->query = (float *)malloc(size);
+		if (it->query == NULL) {
+			diag_set(OutOfMemory, size, "malloc", "iterator key");
+			mempool_free(&memtx->iterator_pool, it);
+			return NULL;
+		}
+		if (memtx_hnsw_index_decode_key(index, key, part_count,
+						it->query) != 0) {
+			free(it->query);
+			mempool_free(&memtx->iterator_pool, it);
+			return NULL;
+		}
+		it->batch_size = MEMTX_HNSW_BATCH_SIZE_MIN;
+		it->base.next_internal = hnsw_index_iterator_next_neighbor;
+	}
+	return &it->base;
+}
+
+static const struct index_vtab memtx_hnsw_index_vtab = {
+	/* .destroy = */ memtx_hnsw_index_destroy,
+	/* .commit_create = */ generic_index_commit_create,
+	/* .abort_create = */ generic_index_abort_create,
+	/* .commit_modify = */ generic_index_commit_modify,
+	/* .commit_drop = */ generic_index_commit_drop,
+	/* .update_def = */ generic_index_update_def,
+	/* .depends_on_pk = */ generic_index_depends_on_pk,
+	/* .def_change_requires_rebuild = */
+		memtx_hnsw_index_def_change_requires_rebuild,
+	/* .size = */ memtx_hnsw_index_size,
+	/* .bsize = */ memtx_hnsw_index_bsize,
+	/* .min = */ generic_index_min,
+	/* .max = */ generic_index_max,
+	/* .random = */ generic_index_random,
+	/* .count = */ generic_index_count,
+	/* .get_internal = */ generic_index_get_internal,
+	/* .get = */ generic_index_get,
+	/* .get_batch = */ generic_index_get_batch,
+	/* .replace = */ memtx_hnsw_index_replace,
+	/* .create_iterator = */ memtx_hnsw_index_create_iterator,
+	/* .create_read_view = */ generic_index_create_read_view,
+	/* .stat = */ generic_index_stat,
+	/* .compact = */ generic_index_compact,
+	/* .reset_stat = */ generic_index_reset_stat,
+	/* .begin_build = */ generic_index_begin_build,
+	/* .reserve = */ generic_index_reserve,
+	/* .build_next = */ generic_index_build_next,
+	/* .end_build = */ generic_index_end_build,
+};
+
+struct index *
+memtx_hnsw_index_new(struct memtx_engine *memtx, struct index_def *def)
+{
+	assert(def->iid > 0);
+	assert(def->key_def->part_count == 1);
+	assert(def->key_def->parts[0].type == FIELD_TYPE_ARRAY);
+	assert(!def->opts.is_unique);
+
+	if (def->opts.dimension < 1 ||
+	    def->opts.dimension > HNSW_MAX_DIMENSION) {
+		diag_set(UnsupportedIndexFeature, def,
+			 tt_sprintf("dimension (%lld): must belong to "
+				    "range [%u, %u]",
+				    (long long)def->opts.dimension, 1,
+				    HNSW_MAX_DIMENSION));
+		return NULL;
+	}
+
+	struct memtx_hnsw_index *index =
+		(struct memtx_hnsw_index *)xcalloc(1, sizeof(*index));
+	index->vector = (float *)xcalloc(def->opts.dimension,
+					 sizeof(*index->vector));
+	if (hnsw_create(&index->hnsw, def->opts.dimension,
+			(enum hnsw_metric)def->opts.distance, HNSW_DEFAULT_M,
+			HNSW_DEFAULT_EF_CONSTRUCTION) != 0) {
+		diag_set(OutOfMemory, sizeof(index->hnsw), "hnsw_create",
+			 "graph");
+		free(index->vector);
+		free(index);
+		return NULL;
+	}
+	index_create(&index->base, (struct engine *)memtx,
+		     &memtx_hnsw_index_vtab, def);
+	return &index->base;
+}
@@ -0,0 +1,28 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct index;
+struct index_def;
+struct memtx_engine;
+
+/**
+ * Create a memtx HNSW index - an approximate nearest neighbor index
+ * over an array field holding a vector of `dimension` numbers. The
+ * index supports ITER_NEIGHBOR returning the tuples in the order of
+ * growing distance from the key vector, measured as set by the
+ * `distance` option, and ITER_ALL.
+ */
+struct index *
+memtx_hnsw_index_new(struct memtx_engine *memtx, struct index_def *def);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
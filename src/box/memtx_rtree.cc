@@ -50,6 +50,12 @@ struct memtx_rtree_index {
 	struct index base;
 	unsigned dimension;
 	struct rtree tree;
+	/**
+	 * Records passed to build_next(), bulk loaded into the tree
+	 * by end_build(). See rtree_bulk_entry_set().
+	 */
+	char *build_array;
+	size_t build_array_size, build_array_alloc_size;
 };
 
 /* {{{ Utilities. *************************************************/
@@ -176,6 +182,7 @@ memtx_rtree_index_destroy(struct index *base)
 {
 	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
 	rtree_destroy(&index->tree);
+	free(index->build_array);
 	free(index);
 }
 
@@ -297,6 +304,76 @@ memtx_rtree_index_reserve(struct index *base, uint32_t size_hint)
 	return memtx_index_extent_reserve(memtx, RESERVE_EXTENTS_BEFORE_REPLACE);
 }
 
+static void
+memtx_rtree_index_begin_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	assert(rtree_number_of_records(&index->tree) == 0);
+	assert(index->build_array_size == 0);
+	(void)index;
+}
+
+/**
+ * Number of extents to reserve so that bulk loading the records passed
+ * to build_next() so far can't fail, since there is no error handling
+ * in the rtree lib.
+ */
+static int
+memtx_rtree_index_build_extent_count(struct memtx_rtree_index *index)
+{
+	size_t pages = rtree_bulk_load_page_count(&index->tree,
+						  index->build_array_size);
+	size_t extents = DIV_ROUND_UP(pages, MEMTX_EXTENT_SIZE /
+					     index->tree.page_size);
+	/* Matras needs extents for its page tables as well. */
+	extents += DIV_ROUND_UP(extents, MEMTX_EXTENT_SIZE / sizeof(void *));
+	return extents + RESERVE_EXTENTS_BEFORE_REPLACE;
+}
+
+static int
+memtx_rtree_index_build_next(struct index *base, struct tuple *tuple)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	size_t entry_size = rtree_bulk_entry_size(&index->tree);
+	struct rtree_rect rect;
+	if (extract_rectangle(&rect, tuple, base->def) != 0)
+		return -1;
+	if (index->build_array_size == index->build_array_alloc_size) {
+		size_t alloc_size = index->build_array_alloc_size == 0 ?
+			MEMTX_EXTENT_SIZE / entry_size :
+			index->build_array_alloc_size +
+			DIV_ROUND_UP(index->build_array_alloc_size, 2);
+		char *tmp = (char *)realloc(index->build_array,
+					    alloc_size * entry_size);
+		if (tmp == NULL) {
+			diag_set(OutOfMemory, alloc_size * entry_size,
+				 "memtx_rtree_index", "build_next");
+			return -1;
+		}
+		index->build_array = tmp;
+		index->build_array_alloc_size = alloc_size;
+	}
+	rtree_bulk_entry_set(&index->tree, index->build_array +
+			     index->build_array_size * entry_size,
+			     &rect, tuple);
+	index->build_array_size++;
+	return memtx_index_extent_reserve(
+		memtx, memtx_rtree_index_build_extent_count(index));
+}
+
+static void
+memtx_rtree_index_end_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	rtree_bulk_load(&index->tree, index->build_array,
+			index->build_array_size);
+	free(index->build_array);
+	index->build_array = NULL;
+	index->build_array_size = 0;
+	index->build_array_alloc_size = 0;
+}
+
 /** Implementation of create_iterator for memtx rtree index. */
 static struct iterator *
 memtx_rtree_index_create_iterator(struct index *base, enum iterator_type type,
@@ -398,16 +475,17 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .count = */ memtx_rtree_index_count,
 	/* .get_internal = */ memtx_rtree_index_get_internal,
 	/* .get = */ memtx_index_get,
+	/* .get_batch = */ generic_index_get_batch,
 	/* .replace = */ memtx_rtree_index_replace,
 	/* .create_iterator = */ memtx_rtree_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
 	/* .stat = */ generic_index_stat,
 	/* .compact = */ generic_index_compact,
 	/* .reset_stat = */ generic_index_reset_stat,
-	/* .begin_build = */ generic_index_begin_build,
+	/* .begin_build = */ memtx_rtree_index_begin_build,
 	/* .reserve = */ memtx_rtree_index_reserve,
-	/* .build_next = */ generic_index_build_next,
-	/* .end_build = */ generic_index_end_build,
+	/* .build_next = */ memtx_rtree_index_build_next,
+	/* .end_build = */ memtx_rtree_index_end_build,
 };
 
 struct index *
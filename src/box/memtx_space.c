@@ -40,6 +40,8 @@
 #include "memtx_tree.h"
 #include "memtx_rtree.h"
 #include "memtx_bitset.h"
+#include "memtx_text.h"
+#include "memtx_hnsw.h"
 #include "memtx_engine.h"
 #include "column_mask.h"
 #include "sequence.h"
@@ -401,6 +403,8 @@ memtx_space_replace_tuple(struct space *space, struct txn_stmt *stmt,
 	if (rc != 0)
 		goto finish;
 	txn_stmt_prepare_rollback_info(stmt, result, new_tuple);
+	if (!space_is_temporary(space))
+		((struct memtx_engine *)space->engine)->dirty_rows++;
 	stmt->engine_savepoint = stmt;
 	stmt->new_tuple = orig_new_tuple;
 	stmt->old_tuple = result;
@@ -513,16 +517,22 @@ memtx_space_execute_update(struct space *space, struct txn *txn,
 	struct tuple_format *format = space->format;
 	const char *old_data = tuple_data_range(decompressed, &bsize);
 	size_t region_svp = region_used(&fiber()->gc);
+	uint64_t column_mask = COLUMN_MASK_FULL;
 	const char *new_data =
 		xrow_update_execute(request->tuple, request->tuple_end,
 				    old_data, old_data + bsize, format,
-				    &new_size, request->index_base, NULL);
+				    &new_size, request->index_base,
+				    &column_mask);
 	if (new_data == NULL)
 		return -1;
 
+	/*
+	 * Counter-like updates of non-indexed fields are common, so
+	 * reuse the field map of the old tuple when possible.
+	 */
 	struct tuple *new_tuple =
-		space->format->vtab.tuple_new(format, new_data,
-					      new_data + new_size);
+		memtx_tuple_new_from_update(format, decompressed, new_data,
+					    new_data + new_size, column_mask);
 	region_truncate(&fiber()->gc, region_svp);
 	if (new_tuple == NULL)
 		return -1;
@@ -629,9 +639,10 @@ memtx_space_execute_upsert(struct space *space, struct txn *txn,
 		if (new_data == NULL)
 			return -1;
 
-		new_tuple =
-			space->format->vtab.tuple_new(format, new_data,
-						      new_data + new_size);
+		new_tuple = memtx_tuple_new_from_update(format, decompressed,
+							new_data,
+							new_data + new_size,
+							column_mask);
 		region_truncate(&fiber()->gc, region_svp);
 		if (new_tuple == NULL)
 			return -1;
@@ -739,6 +750,24 @@ memtx_space_ephemeral_rowid_next(struct space *space, uint64_t *rowid)
 	return 0;
 }
 
+static void
+memtx_space_ephemeral_begin_build(struct space *space)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	assert(memtx_space->replace != memtx_space_replace_build_next);
+	index_begin_build(space->index[0]);
+	memtx_space->replace = memtx_space_replace_build_next;
+}
+
+static void
+memtx_space_ephemeral_end_build(struct space *space)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	assert(memtx_space->replace == memtx_space_replace_build_next);
+	index_end_build(space->index[0]);
+	memtx_space->replace = memtx_space_replace_primary_key;
+}
+
 /* }}} DML */
 
 /* {{{ DDL */
@@ -816,6 +845,16 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 				 "RTREE index can not use a function");
 			return -1;
 		}
+		if (index_def->opts.distance !=
+		    RTREE_INDEX_DISTANCE_TYPE_EUCLID &&
+		    index_def->opts.distance !=
+		    RTREE_INDEX_DISTANCE_TYPE_MANHATTAN) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "RTREE index distance must be EUCLID or "
+				 "MANHATTAN");
+			return -1;
+		}
 		/* no furter checks of parts needed */
 		return 0;
 	case BITSET:
@@ -854,6 +893,70 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 		}
 		/* no furter checks of parts needed */
 		return 0;
+	case TEXT:
+		if (key_def->part_count != 1) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "TEXT index key can not be multipart");
+			return -1;
+		}
+		if (index_def->opts.is_unique) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "TEXT index can not be unique");
+			return -1;
+		}
+		if (key_def->parts[0].type != FIELD_TYPE_STRING) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "TEXT index field type must be STRING");
+			return -1;
+		}
+		if (key_def->is_multikey) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "TEXT index cannot be multikey");
+			return -1;
+		}
+		if (key_def->for_func_index) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "TEXT index can not use a function");
+			return -1;
+		}
+		return 0;
+	case HNSW:
+		if (key_def->part_count != 1) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "HNSW index key can not be multipart");
+			return -1;
+		}
+		if (index_def->opts.is_unique) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "HNSW index can not be unique");
+			return -1;
+		}
+		if (key_def->parts[0].type != FIELD_TYPE_ARRAY) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "HNSW index field type must be ARRAY");
+			return -1;
+		}
+		if (key_def->is_multikey) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "HNSW index cannot be multikey");
+			return -1;
+		}
+		if (key_def->for_func_index) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "HNSW index can not use a function");
+			return -1;
+		}
+		return 0;
 	default:
 		diag_set(ClientError, ER_INDEX_TYPE,
 			 index_def->name, space_name(space));
@@ -932,6 +1035,10 @@ memtx_space_create_index(struct space *space, struct index_def *index_def)
 		return memtx_rtree_index_new(memtx, index_def);
 	case BITSET:
 		return memtx_bitset_index_new(memtx, index_def);
+	case TEXT:
+		return memtx_text_index_new(memtx, index_def);
+	case HNSW:
+		return memtx_hnsw_index_new(memtx, index_def);
 	default:
 		unreachable();
 		return NULL;
@@ -983,10 +1090,118 @@ struct memtx_ddl_state {
 	struct tuple *cursor;
 	/* Primary key key_def to compare new tuples with cursor. */
 	struct key_def *cmp_def;
+	/*
+	 * Set if the index is built in bulk, with index_build_next() and
+	 * index_end_build(), rather than tuple by tuple. The index can't
+	 * be updated until the build ends so changes made to tuples that
+	 * have already been passed to it are logged and applied after.
+	 */
+	bool is_bulk;
+	/* Set when a bulk build has ended and the log has been applied. */
+	bool is_built;
+	/* Logged changes, linked by memtx_ddl_change::in_log. */
+	struct rlist log;
 	struct diag diag;
 	int rc;
 };
 
+/* A change logged during a bulk index build. */
+struct memtx_ddl_change {
+	/* Link in memtx_ddl_state::log. */
+	struct rlist in_log;
+	/* Tuple to delete from the index or NULL. Referenced. */
+	struct tuple *old_tuple;
+	/* Tuple to insert into the index or NULL. Referenced. */
+	struct tuple *new_tuple;
+};
+
+/*
+ * Log a change to apply to an index after it's built in bulk.
+ */
+static void
+memtx_ddl_state_log_change(struct memtx_ddl_state *state,
+			   struct tuple *old_tuple, struct tuple *new_tuple)
+{
+	assert(state->is_bulk && !state->is_built);
+	struct memtx_ddl_change *change = xmalloc(sizeof(*change));
+	change->old_tuple = old_tuple;
+	change->new_tuple = new_tuple;
+	if (old_tuple != NULL)
+		tuple_ref(old_tuple);
+	if (new_tuple != NULL)
+		tuple_ref(new_tuple);
+	rlist_add_tail_entry(&state->log, change, in_log);
+}
+
+/*
+ * Free the log of a bulk index build. If @a apply is set, the logged
+ * changes are applied to the index, which must be built by now. The
+ * function doesn't yield so no changes can be logged while it runs.
+ */
+static int
+memtx_ddl_state_flush_log(struct memtx_ddl_state *state, bool apply)
+{
+	assert(state->is_bulk && !state->is_built);
+	int rc = apply ? 0 : -1;
+	struct memtx_ddl_change *change, *next;
+	rlist_foreach_entry_safe(change, &state->log, in_log, next) {
+		struct tuple *delete;
+		struct tuple *successor;
+		if (rc == 0 &&
+		    index_replace(state->index, change->old_tuple,
+				  change->new_tuple, DUP_REPLACE_OR_INSERT,
+				  &delete, &successor) != 0)
+			rc = -1;
+		if (change->old_tuple != NULL)
+			tuple_unref(change->old_tuple);
+		if (change->new_tuple != NULL)
+			tuple_unref(change->new_tuple);
+		free(change);
+	}
+	rlist_create(&state->log);
+	state->is_built = true;
+	return apply ? rc : 0;
+}
+
+/*
+ * Check if an index can be built in bulk, see memtx_ddl_state::is_bulk.
+ * A unique index can't, because the bulk build doesn't check for
+ * duplicates. A functional index can: the function is still called
+ * for every tuple on the tx thread while the space is scanned, but
+ * the keys it returns are sorted on the sort threads.
+ */
+static bool
+memtx_index_can_build_in_bulk(struct index *index)
+{
+	struct index_def *def = index->def;
+	return def->iid != 0 && def->type == TREE && !def->opts.is_unique;
+}
+
+/*
+ * Insert a tuple into an index being built tuple by tuple.
+ */
+static int
+memtx_build_index_insert(struct index *index, struct tuple *tuple)
+{
+	/*
+	 * @todo: better message if there is a duplicate.
+	 */
+	struct tuple *old_tuple;
+	struct tuple *successor;
+	if (index_replace(index, NULL, tuple, DUP_INSERT,
+			  &old_tuple, &successor) != 0)
+		return -1;
+	assert(old_tuple == NULL); /* Guaranteed by DUP_INSERT. */
+	(void) old_tuple;
+	/*
+	 * All tuples stored in a memtx space must be
+	 * referenced by the primary index.
+	 */
+	if (index->def->iid == 0)
+		tuple_ref(tuple);
+	return 0;
+}
+
 static int
 memtx_check_on_replace(struct trigger *trigger, void *event)
 {
@@ -1131,6 +1346,11 @@ memtx_build_on_replace_rollback(struct trigger *trigger, void *event)
 	assert(stmt->old_tuple == NULL ||
 	       memtx_tuple_validate(state->format, stmt->old_tuple) == 0);
 
+	if (state->is_bulk && !state->is_built) {
+		memtx_ddl_state_log_change(state, stmt->new_tuple,
+					   stmt->old_tuple);
+		return 0;
+	}
 	struct tuple *delete = NULL;
 	struct tuple *successor = NULL;
 	/*
@@ -1168,30 +1388,13 @@ struct on_rollback_trigger_with_data {
 	struct index_build_on_rollback_data data;
 };
 
+/*
+ * Apply a change made by a statement to an index being built.
+ * On failure, sets the error in the build state and returns -1.
+ */
 static int
-memtx_build_on_replace(struct trigger *trigger, void *event)
+memtx_build_apply_change(struct memtx_ddl_state *state, struct txn_stmt *stmt)
 {
-	struct txn *txn = event;
-	struct memtx_ddl_state *state = trigger->data;
-	struct txn_stmt *stmt = txn_current_stmt(txn);
-
-	struct tuple *cmp_tuple = stmt->new_tuple != NULL ? stmt->new_tuple :
-							    stmt->old_tuple;
-	/*
-	 * Only update the already built part of an index. All the other
-	 * tuples will be inserted when build continues.
-	 */
-	if (tuple_compare(state->cursor, HINT_NONE, cmp_tuple, HINT_NONE,
-			  state->cmp_def) < 0)
-		return 0;
-
-	if (stmt->new_tuple != NULL &&
-	    memtx_tuple_validate(state->format, stmt->new_tuple) != 0) {
-		state->rc = -1;
-		diag_move(diag_get(), &state->diag);
-		return 0;
-	}
-
 	struct tuple *delete = NULL;
 	enum dup_replace_mode mode =
 		state->index->def->opts.is_unique ? DUP_INSERT :
@@ -1201,7 +1404,7 @@ memtx_build_on_replace(struct trigger *trigger, void *event)
 				  stmt->new_tuple, mode, &delete, &successor);
 	if (state->rc != 0) {
 		diag_move(diag_get(), &state->diag);
-		return 0;
+		return -1;
 	}
 	/*
 	 * All tuples stored in a memtx space are
@@ -1214,6 +1417,41 @@ memtx_build_on_replace(struct trigger *trigger, void *event)
 		if (stmt->old_tuple != NULL)
 			tuple_unref(stmt->old_tuple);
 	}
+	return 0;
+}
+
+static int
+memtx_build_on_replace(struct trigger *trigger, void *event)
+{
+	struct txn *txn = event;
+	struct memtx_ddl_state *state = trigger->data;
+	struct txn_stmt *stmt = txn_current_stmt(txn);
+
+	struct tuple *cmp_tuple = stmt->new_tuple != NULL ? stmt->new_tuple :
+							    stmt->old_tuple;
+	/*
+	 * Only update the already built part of an index. All the other
+	 * tuples will be inserted when build continues. The cursor is
+	 * cleared when all tuples have been passed to a bulk build.
+	 */
+	if (state->cursor != NULL &&
+	    tuple_compare(state->cursor, HINT_NONE, cmp_tuple, HINT_NONE,
+			  state->cmp_def) < 0)
+		return 0;
+
+	if (stmt->new_tuple != NULL &&
+	    memtx_tuple_validate(state->format, stmt->new_tuple) != 0) {
+		state->rc = -1;
+		diag_move(diag_get(), &state->diag);
+		return 0;
+	}
+
+	if (state->is_bulk && !state->is_built)
+		memtx_ddl_state_log_change(state, stmt->old_tuple,
+					   stmt->new_tuple);
+	else if (memtx_build_apply_change(state, stmt) != 0)
+		return 0;
+
 	/*
 	 * Set on_rollback trigger on stmt to avoid
 	 * problem when rollbacked changes appears in
@@ -1294,16 +1532,27 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 	bool can_yield = pk->def->type != HASH;
 
 	struct memtx_engine *memtx = (struct memtx_engine *)src_space->engine;
+	/*
+	 * Sorting all keys at once on the sort threads is much faster
+	 * than inserting them one by one. Not done during recovery,
+	 * because the sort yields while waiting for the threads.
+	 */
+	bool is_bulk = memtx->state == MEMTX_OK &&
+		       memtx_index_can_build_in_bulk(new_index);
 	struct memtx_ddl_state state;
 	struct trigger on_replace;
 	/*
 	 * Create trigger and initialize ddl state
 	 * if build in background is enabled.
 	 */
-	if (can_yield) {
+	if (can_yield || is_bulk) {
 		state.index = new_index;
 		state.format = new_format;
+		state.cursor = NULL;
 		state.cmp_def = pk->def->key_def;
+		state.is_bulk = is_bulk;
+		state.is_built = false;
+		rlist_create(&state.log);
 		state.rc = 0;
 		diag_create(&state.diag);
 
@@ -1320,10 +1569,14 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 	 * etc., the build is aborted.
 	 */
 	/* Build the new index. */
-	int rc;
+	int rc = 0;
+	if (is_bulk) {
+		index_begin_build(new_index);
+		rc = index_reserve(new_index, index_size(pk));
+	}
 	struct tuple *tuple;
 	size_t count = 0;
-	while ((rc = iterator_next_internal(it, &tuple)) == 0 &&
+	while (rc == 0 && (rc = iterator_next_internal(it, &tuple)) == 0 &&
 	       tuple != NULL) {
 		struct key_def *key_def = new_index->def->key_def;
 		if (!tuple_format_is_compatible_with_key_def(tuple_format(tuple),
@@ -1338,23 +1591,12 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 		rc = memtx_tuple_validate(new_format, tuple);
 		if (rc != 0)
 			break;
-		/*
-		 * @todo: better message if there is a duplicate.
-		 */
-		struct tuple *old_tuple;
-		struct tuple *successor;
-		rc = index_replace(new_index, NULL, tuple,
-				   DUP_INSERT, &old_tuple, &successor);
+		if (is_bulk)
+			rc = index_build_next(new_index, tuple);
+		else
+			rc = memtx_build_index_insert(new_index, tuple);
 		if (rc != 0)
 			break;
-		assert(old_tuple == NULL); /* Guaranteed by DUP_INSERT. */
-		(void) old_tuple;
-		/*
-		 * All tuples stored in a memtx space must be
-		 * referenced by the primary index.
-		 */
-		if (new_index->def->iid == 0)
-			tuple_ref(tuple);
 		/*
 		 * Do not build index in background
 		 * if the feature is disabled.
@@ -1388,7 +1630,23 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 		}
 	}
 	iterator_delete(it);
-	if (can_yield) {
+	if (is_bulk) {
+		if (rc == 0) {
+			/*
+			 * All tuples have been passed to the index so
+			 * log all changes made while it's being built.
+			 */
+			state.cursor = NULL;
+			index_end_build(new_index);
+			if (state.rc != 0) {
+				rc = -1;
+				diag_move(&state.diag, diag_get());
+			}
+		}
+		if (memtx_ddl_state_flush_log(&state, rc == 0) != 0)
+			rc = -1;
+	}
+	if (can_yield || is_bulk) {
 		diag_destroy(&state.diag);
 		trigger_clear(&on_replace);
 	}
@@ -1447,6 +1705,8 @@ static const struct space_vtab memtx_space_vtab = {
 	/* .ephemeral_replace = */ memtx_space_ephemeral_replace,
 	/* .ephemeral_delete = */ memtx_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ memtx_space_ephemeral_rowid_next,
+	/* .ephemeral_begin_build = */ memtx_space_ephemeral_begin_build,
+	/* .ephemeral_end_build = */ memtx_space_ephemeral_end_build,
 	/* .init_system_space = */ memtx_init_system_space,
 	/* .init_ephemeral_space = */ memtx_init_ephemeral_space,
 	/* .check_index_def = */ memtx_space_check_index_def,
@@ -0,0 +1,699 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_text.h"
+
+#include <string.h>
+#include <small/mempool.h>
+#include <PMurHash.h>
+
+#include "trivia/util.h"
+
+#include "coll/coll.h"
+#include "fiber.h"
+#include "index.h"
+#include "schema.h"
+#include "tuple.h"
+#include "txn.h"
+#include "memtx_tx.h"
+#include "memtx_engine.h"
+
+enum {
+	/** Seed of the term hash, the same as used by mh_strn_hash(). */
+	TEXT_TERM_HASH_SEED = 13,
+};
+
+struct text_term;
+
+/**
+ * Entry of a posting list: a tuple containing a term. The posting
+ * lists of all terms are stored in one tree ordered by term and
+ * tuple address, so the list of a term is a range of the tree
+ * sorted by tuple address, and the lists of different terms can
+ * be intersected without looking at the tuples.
+ */
+struct text_posting {
+	/** The term or NULL for the list of all tuples of the index. */
+	struct text_term *term;
+	struct tuple *tuple;
+};
+
+static inline int
+text_posting_cmp(const struct text_posting *a, const struct text_posting *b)
+{
+	if (a->term != b->term)
+		return (uintptr_t)a->term < (uintptr_t)b->term ? -1 : 1;
+	if (a->tuple != b->tuple)
+		return (uintptr_t)a->tuple < (uintptr_t)b->tuple ? -1 : 1;
+	return 0;
+}
+
+#define BPS_TREE_NAME text_posting_tree
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE MEMTX_EXTENT_SIZE
+#define BPS_TREE_COMPARE(a, b, arg) text_posting_cmp(&(a), &(b))
+#define BPS_TREE_COMPARE_KEY(a, b, arg) text_posting_cmp(&(a), (b))
+#define BPS_TREE_IS_IDENTICAL(a, b) (text_posting_cmp(&(a), &(b)) == 0)
+#define BPS_TREE_NO_DEBUG 1
+#define bps_tree_elem_t struct text_posting
+#define bps_tree_key_t const struct text_posting *
+#define bps_tree_arg_t void *
+
+#include "salad/bps_tree.h"
+
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_NO_DEBUG
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+/** A term (word) of a TEXT index. */
+struct text_term {
+	/** Number of tuples containing the term. */
+	uint32_t tuple_count;
+	/** Hash of the term, see text_term_hash(). */
+	uint32_t hash;
+	/** Length of the term. */
+	uint32_t len;
+	/** The term, not null-terminated. */
+	char str[0];
+};
+
+/** Term lookup key. */
+struct text_term_key {
+	const char *str;
+	uint32_t len;
+	uint32_t hash;
+};
+
+static inline bool
+text_term_equal(const char *a, uint32_t a_len, const char *b, uint32_t b_len,
+		struct coll *coll)
+{
+	if (coll != NULL)
+		return coll->cmp(a, a_len, b, b_len, coll) == 0;
+	return a_len == b_len && memcmp(a, b, a_len) == 0;
+}
+
+/**
+ * Hash a term. If the index has a collation, the hash is calculated
+ * by it so that the terms equal according to the collation have the
+ * same hash.
+ */
+static uint32_t
+text_term_hash(const char *str, uint32_t len, struct coll *coll)
+{
+	uint32_t h = TEXT_TERM_HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = len;
+	if (coll != NULL)
+		total_size = coll->hash(str, len, &h, &carry, coll);
+	else
+		PMurHash32_Process(&h, &carry, str, len);
+	return PMurHash32_Result(h, carry, total_size);
+}
+
+#define mh_name _text_terms
+#define mh_key_t const struct text_term_key *
+#define mh_node_t struct text_term *
+#define mh_arg_t struct coll *
+#define mh_hash(a, arg) ((*(a))->hash)
+#define mh_hash_key(a, arg) ((a)->hash)
+#define mh_cmp(a, b, arg) (!text_term_equal((*(a))->str, (*(a))->len, \
+					    (*(b))->str, (*(b))->len, arg))
+#define mh_cmp_key(a, b, arg) (!text_term_equal((a)->str, (a)->len, \
+						(*(b))->str, (*(b))->len, arg))
+#define MH_SOURCE 1
+#include <salad/mhash.h>
+
+struct memtx_text_index {
+	struct index base;
+	/** Collation of the indexed field or NULL. */
+	struct coll *coll;
+	/** Term dictionary. */
+	struct mh_text_terms_t *terms;
+	/** Posting lists of all terms, see struct text_posting. */
+	struct text_posting_tree postings;
+	/** Number of tuples in the index. */
+	uint32_t tuple_count;
+	/** Memory used by the terms. */
+	size_t bsize;
+	/**
+	 * Incremented on every change of the index so that iterators
+	 * know that the terms they refer to may have been freed.
+	 */
+	uint32_t version;
+};
+
+/**
+ * Check if a byte belongs to a term. Terms are runs of ASCII letters
+ * and digits and non-ASCII characters, anything else separates them.
+ */
+static inline bool
+text_is_term_byte(char c)
+{
+	unsigned char u = c;
+	return u >= 0x80 || (u >= '0' && u <= '9') ||
+	       (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z');
+}
+
+/**
+ * Find the next term of the string [*pos, end) and advance *pos past
+ * it. Return false if there are no more terms.
+ */
+static bool
+text_next_term(const char **pos, const char *end, const char **term,
+	       uint32_t *len)
+{
+	const char *p = *pos;
+	while (p < end && !text_is_term_byte(*p))
+		p++;
+	const char *start = p;
+	while (p < end && text_is_term_byte(*p))
+		p++;
+	*pos = p;
+	*term = start;
+	*len = p - start;
+	return *len > 0;
+}
+
+/**
+ * Return the first tuple of the posting list of a term that is
+ * greater than (or equal to, if @is_inclusive is set) the given
+ * one or NULL. Tuple NULL is less than any tuple.
+ */
+static struct tuple *
+memtx_text_index_posting_seek(struct memtx_text_index *index,
+			      struct text_term *term, struct tuple *tuple,
+			      bool is_inclusive)
+{
+	struct text_posting key = {term, tuple};
+	struct text_posting_tree_iterator itr = is_inclusive ?
+		text_posting_tree_lower_bound(&index->postings, &key, NULL) :
+		text_posting_tree_upper_bound(&index->postings, &key, NULL);
+	struct text_posting *posting =
+		text_posting_tree_iterator_get_elem(&index->postings, &itr);
+	if (posting == NULL || posting->term != term)
+		return NULL;
+	return posting->tuple;
+}
+
+static bool
+memtx_text_index_posting_contains(struct memtx_text_index *index,
+				  struct text_term *term, struct tuple *tuple)
+{
+	struct text_posting key = {term, tuple};
+	return text_posting_tree_find(&index->postings, &key) != NULL;
+}
+
+/**
+ * Add a tuple to the posting list of a term (or of all tuples if
+ * the term is NULL) unless it's already there.
+ */
+static int
+memtx_text_index_posting_insert(struct memtx_text_index *index,
+				struct text_term *term, struct tuple *tuple)
+{
+	struct text_posting posting = {term, tuple};
+	struct text_posting replaced = {NULL, NULL};
+	if (text_posting_tree_insert(&index->postings, posting,
+				     &replaced, NULL) != 0) {
+		diag_set(OutOfMemory, MEMTX_EXTENT_SIZE, "memtx_text_index",
+			 "posting list");
+		return -1;
+	}
+	if (replaced.tuple != NULL)
+		return 0;
+	if (term != NULL)
+		term->tuple_count++;
+	else
+		index->tuple_count++;
+	return 0;
+}
+
+/** Remove a tuple from a posting list if it's there. */
+static void
+memtx_text_index_posting_delete(struct memtx_text_index *index,
+				struct text_term *term, struct tuple *tuple)
+{
+	struct text_posting posting = {term, tuple};
+	if (text_posting_tree_delete(&index->postings, posting) != 0)
+		return;
+	if (term != NULL)
+		term->tuple_count--;
+	else
+		index->tuple_count--;
+}
+
+static struct text_term *
+memtx_text_index_find_term(struct memtx_text_index *index,
+			   const char *str, uint32_t len)
+{
+	struct text_term_key key;
+	key.str = str;
+	key.len = len;
+	key.hash = text_term_hash(str, len, index->coll);
+	mh_int_t k = mh_text_terms_find(index->terms, &key, index->coll);
+	if (k == mh_end(index->terms))
+		return NULL;
+	return *mh_text_terms_node(index->terms, k);
+}
+
+/** Find a term or add it to the dictionary if it isn't there. */
+static struct text_term *
+memtx_text_index_add_term(struct memtx_text_index *index,
+			  const char *str, uint32_t len)
+{
+	struct text_term *term = memtx_text_index_find_term(index, str, len);
+	if (term != NULL)
+		return term;
+	size_t size = sizeof(*term) + len;
+	term = (struct text_term *)malloc(size);
+	if (term == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "text term");
+		return NULL;
+	}
+	term->tuple_count = 0;
+	term->hash = text_term_hash(str, len, index->coll);
+	term->len = len;
+	memcpy(term->str, str, len);
+	mh_text_terms_put(index->terms, &term, NULL, index->coll);
+	index->bsize += size;
+	return term;
+}
+
+static void
+memtx_text_index_delete_term(struct memtx_text_index *index,
+			     struct text_term *term)
+{
+	mh_int_t k = mh_text_terms_get(index->terms, &term, index->coll);
+	assert(k != mh_end(index->terms));
+	mh_text_terms_del(index->terms, k, index->coll);
+	index->bsize -= sizeof(*term) + term->len;
+	free(term);
+}
+
+/** Return the indexed string of a tuple. */
+static const char *
+memtx_text_index_field(struct memtx_text_index *index, struct tuple *tuple,
+		       uint32_t *len)
+{
+	const char *field = tuple_field_by_part(tuple,
+			index->base.def->key_def->parts, MULTIKEY_NONE);
+	assert(field != NULL && mp_typeof(*field) == MP_STR);
+	return mp_decode_str(&field, len);
+}
+
+/**
+ * Remove a tuple from the posting lists of all its terms and drop
+ * the terms that don't have any tuples left.
+ */
+static void
+memtx_text_index_delete(struct memtx_text_index *index, struct tuple *tuple)
+{
+	uint32_t len;
+	const char *pos = memtx_text_index_field(index, tuple, &len);
+	const char *end = pos + len;
+	const char *str;
+	while (text_next_term(&pos, end, &str, &len)) {
+		struct text_term *term =
+			memtx_text_index_find_term(index, str, len);
+		if (term == NULL)
+			continue;
+		memtx_text_index_posting_delete(index, term, tuple);
+		if (term->tuple_count == 0)
+			memtx_text_index_delete_term(index, term);
+	}
+	memtx_text_index_posting_delete(index, NULL, tuple);
+}
+
+/**
+ * Add a tuple to the posting lists of all its terms. On failure the
+ * index is left unchanged.
+ */
+static int
+memtx_text_index_insert(struct memtx_text_index *index, struct tuple *tuple)
+{
+	if (memtx_text_index_posting_insert(index, NULL, tuple) != 0)
+		return -1;
+	uint32_t len;
+	const char *pos = memtx_text_index_field(index, tuple, &len);
+	const char *end = pos + len;
+	const char *str;
+	while (text_next_term(&pos, end, &str, &len)) {
+		struct text_term *term =
+			memtx_text_index_add_term(index, str, len);
+		if (term == NULL ||
+		    memtx_text_index_posting_insert(index, term, tuple) != 0) {
+			memtx_text_index_delete(index, tuple);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+struct text_index_iterator {
+	struct iterator base; /* Must be the first member. */
+	/** Memory pool the iterator was allocated from. */
+	struct mempool *pool;
+	/** Copy of the key string or NULL for ITER_ALL. */
+	char *key;
+	/** Length of the key string. */
+	uint32_t key_len;
+	/** Number of posting lists to intersect. */
+	uint32_t posting_count;
+	/**
+	 * The key terms sorted by the number of tuples, the smallest
+	 * first, or NULL for ITER_ALL. Valid as long as the index
+	 * version is equal to the iterator version.
+	 */
+	struct text_term **terms;
+	/** Version of the index the terms were looked up at. */
+	uint32_t version;
+	/** The last tuple found by the iterator or NULL. */
+	struct tuple *last;
+};
+
+static_assert(sizeof(struct text_index_iterator) <= MEMTX_ITERATOR_SIZE,
+	      "sizeof(struct text_index_iterator) must be less than or equal "
+	      "to MEMTX_ITERATOR_SIZE");
+
+static struct text_index_iterator *
+text_index_iterator(struct iterator *it)
+{
+	return (struct text_index_iterator *)it;
+}
+
+static void
+text_index_iterator_free(struct iterator *iterator)
+{
+	assert(iterator->free == text_index_iterator_free);
+	struct text_index_iterator *it = text_index_iterator(iterator);
+	free(it->terms);
+	free(it->key);
+	mempool_free(it->pool, it);
+}
+
+/**
+ * Look up the key terms. Return false if some term isn't present
+ * in the index so nothing can match the key.
+ */
+static bool
+text_index_iterator_lookup(struct text_index_iterator *it)
+{
+	struct memtx_text_index *index =
+		(struct memtx_text_index *)it->base.index;
+	it->version = index->version;
+	if (it->key == NULL) {
+		assert(it->posting_count == 1);
+		it->terms[0] = NULL;
+		return true;
+	}
+	const char *pos = it->key;
+	const char *end = pos + it->key_len;
+	const char *str;
+	uint32_t len;
+	uint32_t count = 0;
+	while (text_next_term(&pos, end, &str, &len)) {
+		struct text_term *term =
+			memtx_text_index_find_term(index, str, len);
+		if (term == NULL)
+			return false;
+		uint32_t i = count++;
+		for (; i > 0 && it->terms[i - 1]->tuple_count >
+				term->tuple_count; i--)
+			it->terms[i] = it->terms[i - 1];
+		it->terms[i] = term;
+	}
+	assert(count == it->posting_count);
+	return count > 0;
+}
+
+/**
+ * Find the first tuple following the last found one that is present
+ * in all the posting lists. The smallest list drives the search, the
+ * other lists are only probed with tree lookups, and a miss lets it
+ * skip all the tuples preceding the one found in the probed list.
+ */
+static struct tuple *
+text_index_iterator_advance(struct text_index_iterator *it)
+{
+	struct memtx_text_index *index =
+		(struct memtx_text_index *)it->base.index;
+	struct text_term *first = it->terms[0];
+	struct tuple *candidate =
+		memtx_text_index_posting_seek(index, first, it->last, false);
+	while (candidate != NULL) {
+		uint32_t i;
+		for (i = 1; i < it->posting_count; i++) {
+			struct tuple *found = memtx_text_index_posting_seek(
+				index, it->terms[i], candidate, true);
+			if (found == NULL)
+				return NULL;
+			if (found != candidate) {
+				candidate = memtx_text_index_posting_seek(
+					index, first, found, true);
+				break;
+			}
+		}
+		if (i == it->posting_count)
+			return candidate;
+	}
+	return NULL;
+}
+
+static int
+text_index_iterator_next(struct iterator *iterator, struct tuple **ret)
+{
+	assert(iterator->free == text_index_iterator_free);
+	struct text_index_iterator *it = text_index_iterator(iterator);
+	struct memtx_text_index *index =
+		(struct memtx_text_index *)iterator->index;
+
+	do {
+		if (it->version != index->version &&
+		    !text_index_iterator_lookup(it)) {
+			iterator->next_internal = exhausted_iterator_next;
+			*ret = NULL;
+			return 0;
+		}
+		struct tuple *tuple = text_index_iterator_advance(it);
+		if (tuple == NULL) {
+			iterator->next_internal = exhausted_iterator_next;
+			*ret = NULL;
+			return 0;
+		}
+		it->last = tuple;
+		struct txn *txn = in_txn();
+		struct space *space = space_by_id(iterator->space_id);
+		*ret = memtx_tx_tuple_clarify(txn, space, tuple,
+					      iterator->index, 0);
+/********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
+		memtx_tx_story_gc();
+/*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
+	} while (*ret == NULL);
+
+	return 0;
+}
+
+static void
+memtx_text_index_destroy(struct index *base)
+{
+	struct memtx_text_index *index = (struct memtx_text_index *)base;
+	mh_int_t k;
+	mh_foreach(index->terms, k) {
+		struct text_term *term = *mh_text_terms_node(index->terms, k);
+		free(term);
+	}
+	mh_text_terms_delete(index->terms);
+	text_posting_tree_destroy(&index->postings);
+	free(index);
+}
+
+static ssize_t
+memtx_text_index_size(struct index *base)
+{
+	struct memtx_text_index *index = (struct memtx_text_index *)base;
+	struct space *space = space_by_id(base->def->space_id);
+	/* Substract invisible count. */
+	return index->tuple_count -
+	       memtx_tx_index_invisible_count(in_txn(), space, base);
+}
+
+static ssize_t
+memtx_text_index_bsize(struct index *base)
+{
+	struct memtx_text_index *index = (struct memtx_text_index *)base;
+	return index->bsize + mh_text_terms_memsize(index->terms) +
+	       text_posting_tree_mem_used(&index->postings);
+}
+
+static int
+memtx_text_index_replace(struct index *base, struct tuple *old_tuple,
+			 struct tuple *new_tuple, enum dup_replace_mode mode,
+			 struct tuple **result, struct tuple **successor)
+{
+	struct memtx_text_index *index = (struct memtx_text_index *)base;
+
+	/* TEXT index doesn't support ordering. */
+	*successor = NULL;
+
+	assert(!base->def->opts.is_unique);
+	assert(!base->def->key_def->is_multikey);
+	assert(old_tuple != NULL || new_tuple != NULL);
+	(void)mode;
+
+	*result = NULL;
+
+	/*
+	 * Insert the new tuple first: the insertion may fail, and
+	 * the index must be left intact in this case.
+	 */
+	if (new_tuple != NULL &&
+	    memtx_text_index_insert(index, new_tuple) != 0)
+		return -1;
+	if (old_tuple != NULL &&
+	    memtx_text_index_posting_contains(index, NULL, old_tuple)) {
+		assert(old_tuple != new_tuple);
+		memtx_text_index_delete(index, old_tuple);
+		*result = old_tuple;
+	}
+	index->version++;
+	return 0;
+}
+
+static struct iterator *
+memtx_text_index_create_iterator(struct index *base, enum iterator_type type,
+				 const char *key, uint32_t part_count,
+				 const char *pos)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+
+	assert(part_count == 0 || key != NULL);
+	if (pos != NULL) {
+		diag_set(UnsupportedIndexFeature, base->def, "pagination");
+		return NULL;
+	}
+	if (part_count == 0)
+		type = ITER_ALL;
+	if (type != ITER_ALL && type != ITER_EQ) {
+		diag_set(UnsupportedIndexFeature, base->def,
+			 "requested iterator type");
+		return NULL;
+	}
+
+	struct text_index_iterator *it = (struct text_index_iterator *)
+		mempool_alloc(&memtx->iterator_pool);
+	if (it == NULL) {
+		diag_set(OutOfMemory, sizeof(*it),
+			 "memtx_text_index", "iterator");
+		return NULL;
+	}
+
+	iterator_create(&it->base, base);
+	it->pool = &memtx->iterator_pool;
+	it->base.next_internal = text_index_iterator_next;
+	it->base.next = memtx_iterator_next;
+	it->base.position = generic_iterator_position;
+	it->base.free = text_index_iterator_free;
+	it->key = NULL;
+	it->key_len = 0;
+	it->posting_count = 1;
+	it->terms = NULL;
+	it->last = NULL;
+
+	if (type == ITER_EQ) {
+		assert(part_count == 1);
+		uint32_t len;
+		const char *str = mp_decode_str(&key, &len);
+		/* The key must outlive the request, so copy it. */
+		it->key = (char *)malloc(MAX(len, 1));
+		if (it->key == NULL) {
+			diag_set(OutOfMemory, len, "malloc", "iterator key");
+			goto fail;
+		}
+		memcpy(it->key, str, len);
+		it->key_len = len;
+		it->posting_count = 0;
+		const char *end = str + len;
+		const char *term;
+		while (text_next_term(&str, end, &term, &len))
+			it->posting_count++;
+		if (it->posting_count == 0) {
+			/* A key without terms matches nothing. */
+			it->base.next_internal = exhausted_iterator_next;
+			return &it->base;
+		}
+	}
+	it->terms = (struct text_term **)
+		malloc(it->posting_count * sizeof(*it->terms));
+	if (it->terms == NULL) {
+		diag_set(OutOfMemory, it->posting_count * sizeof(*it->terms),
+			 "malloc", "iterator terms");
+		goto fail;
+	}
+	if (!text_index_iterator_lookup(it))
+		it->base.next_internal = exhausted_iterator_next;
+	return &it->base;
+fail:
+	free(it->key);
+	mempool_free(&memtx->iterator_pool, it);
+	return NULL;
+}
+
+static const struct index_vtab memtx_text_index_vtab = {
+	/* .destroy = */ memtx_text_index_destroy,
+	/* .commit_create = */ generic_index_commit_create,
+	/* .abort_create = */ generic_index_abort_create,
+	/* .commit_modify = */ generic_index_commit_modify,
+	/* .commit_drop = */ generic_index_commit_drop,
+	/* .update_def = */ generic_index_update_def,
+	/* .depends_on_pk = */ generic_index_depends_on_pk,
+	/* .def_change_requires_rebuild = */
+		memtx_index_def_change_requires_rebuild,
+	/* .size = */ memtx_text_index_size,
+	/* .bsize = */ memtx_text_index_bsize,
+	/* .min = */ generic_index_min,
+	/* .max = */ generic_index_max,
+	/* .random = */ generic_index_random,
+	/* .count = */ generic_index_count,
+	/* .get_internal = */ generic_index_get_internal,
+	/* .get = */ generic_index_get,
+	/* .get_batch = */ generic_index_get_batch,
+	/* .replace = */ memtx_text_index_replace,
+	/* .create_iterator = */ memtx_text_index_create_iterator,
+	/* .create_read_view = */ generic_index_create_read_view,
+	/* .stat = */ generic_index_stat,
+	/* .compact = */ generic_index_compact,
+	/* .reset_stat = */ generic_index_reset_stat,
+	/* .begin_build = */ generic_index_begin_build,
+	/* .reserve = */ generic_index_reserve,
+	/* .build_next = */ generic_index_build_next,
+	/* .end_build = */ generic_index_end_build,
+};
+
+struct index *
+memtx_text_index_new(struct memtx_engine *memtx, struct index_def *def)
+{
+	assert(def->iid > 0);
+	assert(!def->opts.is_unique);
+
+	struct memtx_text_index *index =
+		(struct memtx_text_index *)xcalloc(1, sizeof(*index));
+	index_create(&index->base, (struct engine *)memtx,
+		     &memtx_text_index_vtab, def);
+	index->coll = def->key_def->parts[0].coll;
+	index->terms = mh_text_terms_new();
+	text_posting_tree_create(&index->postings, NULL,
+				 memtx_index_extent_alloc,
+				 memtx_index_extent_free, memtx,
+				 &memtx->index_extent_stats);
+	return &index->base;
+}
@@ -0,0 +1,29 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct index;
+struct index_def;
+struct memtx_engine;
+
+/**
+ * Create a memtx TEXT index - an inverted index mapping every term
+ * (word) of a string field to the tuples containing it. The index
+ * supports ITER_EQ lookups returning the tuples that contain all terms
+ * of the key and ITER_ALL. If the indexed part has a collation, terms
+ * are compared with it, so a case-insensitive collation gives
+ * case-insensitive search.
+ */
+struct index *
+memtx_text_index_new(struct memtx_engine *memtx, struct index_def *def);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -132,15 +132,39 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
 
+/**
+ * Returns the hint of a key that can be used for interpolation search
+ * in a tree block or HINT_NONE. Tuple hints grow linearly with integer
+ * field values so keys generated by a sequence are spread uniformly
+ * over the range of hints in a block. Multikey and functional indexes
+ * store different data in element hints so they can't use them.
+ */
+static inline hint_t
+memtx_tree_key_interpolation_hint(const struct memtx_tree_key_data<true> *key,
+				  const struct key_def *def)
+{
+	if (def->is_multikey || def->for_func_index)
+		return HINT_NONE;
+	enum field_type type = def->parts[0].type;
+	if (type != FIELD_TYPE_UNSIGNED && type != FIELD_TYPE_INTEGER)
+		return HINT_NONE;
+	return key->hint;
+}
+
 #define BPS_TREE_NAMESPACE NS_USE_HINT
 #define bps_tree_elem_t struct memtx_tree_data<true>
 #define bps_tree_key_t struct memtx_tree_key_data<true> *
+#define BPS_TREE_KEY_INTERPOLATION_HINT(key, arg)\
+	memtx_tree_key_interpolation_hint(key, arg)
+#define BPS_TREE_ELEM_INTERPOLATION_HINT(elem, arg) ((elem).hint)
 
 #include "salad/bps_tree.h"
 
 #undef BPS_TREE_NAMESPACE
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
+#undef BPS_TREE_KEY_INTERPOLATION_HINT
+#undef BPS_TREE_ELEM_INTERPOLATION_HINT
 
 #undef BPS_TREE_NAME
 #undef BPS_TREE_BLOCK_SIZE
@@ -212,6 +236,13 @@ struct memtx_tree_index {
 	memtx_tree_t<USE_HINT> tree;
 	struct memtx_tree_data<USE_HINT> *build_array;
 	size_t build_array_size, build_array_alloc_size;
+	/**
+	 * Order of the index recovered from a snapshot: positions of
+	 * the index tuples in the primary key, see
+	 * memtx_tree_index_append_order().
+	 */
+	uint32_t *build_order;
+	size_t build_order_size;
 	struct memtx_gc_task gc_task;
 	memtx_tree_iterator_t<USE_HINT> gc_iterator;
 };
@@ -804,6 +835,7 @@ memtx_tree_index_free(struct memtx_tree_index<USE_HINT> *index)
 {
 	memtx_tree_destroy(&index->tree);
 	free(index->build_array);
+	free(index->build_order);
 	free(index);
 }
 
@@ -872,15 +904,27 @@ memtx_tree_index_destroy(struct index *base)
 		 * Primary index. We need to free all tuples stored
 		 * in the index, which may take a while. Schedule a
 		 * background task in order not to block tx thread.
+		 * Tuples of an unfinished bulk build of an ephemeral
+		 * space are not in the tree yet so free them right away.
 		 */
+		for (size_t i = 0; i < index->build_array_size; i++)
+			tuple_unref(index->build_array[i].tuple);
+		index->build_array_size = 0;
 		index->gc_task.vtab = get_memtx_tree_index_gc_vtab<USE_HINT>();
 		index->gc_iterator = memtx_tree_first(&index->tree);
 		memtx_engine_schedule_gc(memtx, &index->gc_task);
 	} else {
 		/*
 		 * Secondary index. Destruction is fast, no need to
-		 * hand over to background fiber.
+		 * hand over to background fiber. Functional keys of
+		 * an unfinished bulk build are referenced by the
+		 * build array, release them.
 		 */
+		if (base->def->key_def->for_func_index) {
+			for (size_t i = 0; i < index->build_array_size; i++)
+				tuple_unref((struct tuple *)
+					    index->build_array[i].hint);
+		}
 		memtx_tree_index_free(index);
 	}
 }
@@ -968,7 +1012,53 @@ memtx_tree_index_count(struct index *base, enum iterator_type type,
 {
 	if (type == ITER_ALL)
 		return memtx_tree_index_size<USE_HINT>(base); /* optimization */
-	return generic_index_count(base, type, key, part_count);
+	/*
+	 * Without MVCC all the tuples stored in the tree are visible so
+	 * we can count the range by walking the tree leaves instead of
+	 * iterating over the tuples. Multikey and functional indexes are
+	 * counted by iteration to keep the semantics of index:count().
+	 */
+	struct key_def *key_def = base->def->key_def;
+	if (memtx_tx_manager_use_mvcc_engine || key_def->is_multikey ||
+	    key_def->for_func_index || type > ITER_GT)
+		return generic_index_count(base, type, key, part_count);
+	if (part_count == 0)
+		return memtx_tree_index_size<USE_HINT>(base);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	struct memtx_tree_key_data<USE_HINT> key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	if (USE_HINT)
+		key_data.set_hint(key_hint(key, part_count, cmp_def));
+	memtx_tree_iterator_t<USE_HINT> begin;
+	memtx_tree_iterator_t<USE_HINT> end;
+	invalidate_tree_iterator(&end);
+	switch (type) {
+	case ITER_EQ:
+	case ITER_REQ:
+		begin = memtx_tree_lower_bound(&index->tree, &key_data, NULL);
+		end = memtx_tree_upper_bound(&index->tree, &key_data, NULL);
+		break;
+	case ITER_GE:
+		begin = memtx_tree_lower_bound(&index->tree, &key_data, NULL);
+		break;
+	case ITER_GT:
+		begin = memtx_tree_upper_bound(&index->tree, &key_data, NULL);
+		break;
+	case ITER_LE:
+		begin = memtx_tree_first(&index->tree);
+		end = memtx_tree_upper_bound(&index->tree, &key_data, NULL);
+		break;
+	case ITER_LT:
+		begin = memtx_tree_first(&index->tree);
+		end = memtx_tree_lower_bound(&index->tree, &key_data, NULL);
+		break;
+	default:
+		unreachable();
+	}
+	return memtx_tree_iterator_distance(&index->tree, &begin, &end);
 }
 
 template <bool USE_HINT>
@@ -1833,6 +1923,49 @@ memtx_tree_index_build_array_deduplicate(
 	index->build_array_size = w_idx + 1;
 }
 
+/**
+ * Reorder build_array, which is filled in the primary key order, as
+ * specified by the order recovered from a snapshot. Return true if the
+ * array is sorted after that. The order is stale if the space was
+ * changed by WAL rows, in which case build_array is left intact.
+ */
+template <bool USE_HINT>
+static bool
+memtx_tree_index_apply_build_order(struct memtx_tree_index<USE_HINT> *index)
+{
+	size_t size = index->build_array_size;
+	uint32_t *order = index->build_order;
+	if (size == 0 || index->build_order_size != size)
+		return false;
+	struct memtx_tree_data<USE_HINT> *array =
+		(struct memtx_tree_data<USE_HINT> *)
+		malloc(size * sizeof(*array));
+	if (array == NULL)
+		return false;
+	/*
+	 * A strictly ascending sequence can't contain the same element
+	 * twice so checking adjacent elements is enough to make sure
+	 * that the order is a valid permutation.
+	 */
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	for (size_t i = 0; i < size; i++) {
+		if (order[i] >= size)
+			goto stale;
+		array[i] = index->build_array[order[i]];
+		if (i > 0 && memtx_tree_qcompare<USE_HINT>(&array[i - 1],
+							   &array[i],
+							   cmp_def) >= 0)
+			goto stale;
+	}
+	free(index->build_array);
+	index->build_array = array;
+	index->build_array_alloc_size = size;
+	return true;
+stale:
+	free(array);
+	return false;
+}
+
 template <bool USE_HINT>
 static void
 memtx_tree_index_end_build(struct index *base)
@@ -1841,9 +1974,17 @@ memtx_tree_index_end_build(struct index *base)
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
-	tt_sort(index->build_array, index->build_array_size,
-		sizeof(index->build_array[0]), memtx_tree_qcompare<USE_HINT>,
-		cmp_def, memtx->sort_threads);
+	bool is_sorted = index->build_order != NULL &&
+			 memtx_tree_index_apply_build_order(index);
+	free(index->build_order);
+	index->build_order = NULL;
+	index->build_order_size = 0;
+	if (!is_sorted) {
+		tt_sort(index->build_array, index->build_array_size,
+			sizeof(index->build_array[0]),
+			memtx_tree_qcompare<USE_HINT>, cmp_def,
+			memtx->sort_threads);
+	}
 	if (cmp_def->is_multikey || cmp_def->for_func_index) {
 		/*
 		 * Multikey index may have equal(in terms of
@@ -2104,6 +2245,7 @@ static const struct index_vtab memtx_tree_disabled_index_vtab = {
 	/* .count = */ generic_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ generic_index_get,
+	/* .get_batch = */ generic_index_get_batch,
 	/* .replace = */ disabled_index_replace,
 	/* .create_iterator = */ generic_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
@@ -2164,6 +2306,7 @@ get_memtx_tree_index_vtab(void)
 		/* .count = */ memtx_tree_index_count<USE_HINT>,
 		/* .get_internal */ memtx_tree_index_get_internal<USE_HINT>,
 		/* .get = */ memtx_index_get,
+		/* .get_batch = */ generic_index_get_batch,
 		/* .replace = */ is_mk ? memtx_tree_index_replace_multikey :
 				 is_func ? memtx_tree_func_index_replace :
 				 memtx_tree_index_replace<USE_HINT>,
@@ -2235,3 +2378,51 @@ memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def)
 	else
 		return memtx_tree_index_new_tpl<false>(memtx, def, vtab);
 }
+
+bool
+memtx_tree_index_def_supports_order(const struct index_def *def)
+{
+	return def->type == TREE && !def->key_def->for_func_index &&
+	       !def->key_def->is_multikey && !def->key_def->has_exclude_null;
+}
+
+template <bool USE_HINT>
+static void
+memtx_tree_index_append_order_tpl(struct memtx_tree_index<USE_HINT> *index,
+				  uint32_t offset, const char *data,
+				  uint32_t count)
+{
+	if (offset != index->build_order_size)
+		goto drop;
+	uint32_t *order;
+	order = (uint32_t *)realloc(index->build_order,
+				    (offset + count) * sizeof(*order));
+	if (order == NULL)
+		goto drop;
+	for (uint32_t i = 0; i < count; i++)
+		order[offset + i] = mp_load_u32(&data);
+	index->build_order = order;
+	index->build_order_size = offset + count;
+	return;
+drop:
+	/* The order is just a hint so we can always build without it. */
+	free(index->build_order);
+	index->build_order = NULL;
+	index->build_order_size = 0;
+}
+
+void
+memtx_tree_index_append_order(struct index *index, uint32_t offset,
+			      const char *data, uint32_t count)
+{
+	assert(memtx_tree_index_def_supports_order(index->def));
+	if (index->def->opts.hint == INDEX_HINT_ON) {
+		memtx_tree_index_append_order_tpl(
+			(struct memtx_tree_index<true> *)index,
+			offset, data, count);
+	} else {
+		memtx_tree_index_append_order_tpl(
+			(struct memtx_tree_index<false> *)index,
+			offset, data, count);
+	}
+}
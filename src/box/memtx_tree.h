@@ -31,6 +31,9 @@
  * SUCH DAMAGE.
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -42,6 +45,27 @@ struct memtx_engine;
 struct index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def);
 
+/**
+ * Return true if a tree index with the given definition stores exactly
+ * one entry per tuple so that its order can be written to a snapshot as
+ * a permutation of the primary key.
+ */
+bool
+memtx_tree_index_def_supports_order(const struct index_def *def);
+
+/**
+ * Append @a count tuple positions in the primary key stored in @a data
+ * as big-endian 32-bit integers to the order of a secondary tree index
+ * recovered from a snapshot. The order starts at position @a offset and
+ * is dropped if it doesn't follow the previously appended positions.
+ *
+ * If the order matches the primary key after recovery, the index will
+ * be built without sorting, see memtx_tree_index_end_build().
+ */
+void
+memtx_tree_index_append_order(struct index *index, uint32_t offset,
+			      const char *data, uint32_t count);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
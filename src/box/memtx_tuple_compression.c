@@ -0,0 +1,566 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_tuple_compression.h"
+
+#if !defined(ENABLE_TUPLE_COMPRESSION)
+
+#define ZSTD_STATIC_LINKING_ONLY
+#include <zstd.h>
+#include <zdict.h>
+
+#include "diag.h"
+#include "error.h"
+#include "fiber.h"
+#include "memtx_engine.h"
+#include "mp_compression.h"
+#include "mp_extension_types.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "say.h"
+#include "trivia/util.h"
+#include "tt_compression.h"
+#include "tt_pthread.h"
+#include "tuple_format.h"
+
+enum {
+	/** Fields shorter than this aren't compressed. */
+	MEMTX_COMPRESSION_MIN_FIELD_SIZE = 16,
+	/** Max size of MP_COMPRESSION extension header. */
+	MEMTX_COMPRESSION_MAX_HEADER_SIZE = 16,
+	/** Fields longer than this aren't used for dictionary training. */
+	MEMTX_COMPRESSION_MAX_SAMPLE_SIZE = 4 * 1024,
+	/** Max total size of samples used for dictionary training. */
+	MEMTX_COMPRESSION_SAMPLES_SIZE = 256 * 1024,
+	/** Max number of samples used for dictionary training. */
+	MEMTX_COMPRESSION_SAMPLE_COUNT = 4096,
+	/** Max size of a trained dictionary. */
+	MEMTX_COMPRESSION_DICT_SIZE = 16 * 1024,
+	/** Zstd compression level. */
+	MEMTX_COMPRESSION_LEVEL = 3,
+};
+
+/**
+ * Compression state of a tuple format.
+ *
+ * Fields are compressed with zstd. The first fields compressed with
+ * a format are compressed without a dictionary and also collected as
+ * samples. Once enough samples are collected, a dictionary is trained
+ * on them and used for all fields compressed after that. Fields of
+ * a space usually have a lot in common (JSON keys, enum-like values),
+ * so short fields, which zstd can't compress on its own, shrink a lot
+ * with a dictionary. Since tuples reference their format, the format
+ * dictionary lives as long as there are tuples compressed with it.
+ */
+struct memtx_tuple_compression {
+	/** Base class. */
+	struct tuple_format_compression base;
+	/** Id of the format. Used as the dictionary id. */
+	uint16_t format_id;
+	/** Compression dictionary or NULL if not trained yet. */
+	ZSTD_CDict *cdict;
+	/** Decompression dictionary or NULL if not trained yet. */
+	ZSTD_DDict *ddict;
+	/**
+	 * Concatenated samples for dictionary training. Freed once
+	 * the dictionary is trained or the training failed.
+	 */
+	char *samples;
+	/** Total size of the collected samples. */
+	size_t samples_size;
+	/** Sizes of the collected samples. */
+	size_t *sample_sizes;
+	/** Number of the collected samples. */
+	uint32_t sample_count;
+};
+
+/**
+ * Decompression dictionaries indexed by format id. Allocated on
+ * the first trained dictionary. Updated only by the tx thread, but
+ * read by any thread decompressing raw tuples, hence atomic access.
+ */
+static ZSTD_DDict **memtx_tuple_compression_ddicts;
+
+/** Compression context. Used only by the tx thread. */
+static ZSTD_CCtx *memtx_tuple_compression_cctx;
+
+/** Thread-local decompression context. */
+static pthread_key_t memtx_tuple_compression_dctx_key;
+
+/** Guards creation of memtx_tuple_compression_dctx_key. */
+static pthread_once_t memtx_tuple_compression_dctx_once = PTHREAD_ONCE_INIT;
+
+/** Destructor of memtx_tuple_compression_dctx_key. */
+static void
+memtx_tuple_compression_free_dctx(void *arg)
+{
+	assert(arg != NULL);
+	ZSTD_freeDCtx(arg);
+}
+
+static void
+memtx_tuple_compression_create_dctx_key(void)
+{
+	tt_pthread_key_create(&memtx_tuple_compression_dctx_key,
+			      memtx_tuple_compression_free_dctx);
+}
+
+/** Return the decompression context of the current thread. */
+static ZSTD_DCtx *
+memtx_tuple_compression_dctx(void)
+{
+	tt_pthread_once(&memtx_tuple_compression_dctx_once,
+			memtx_tuple_compression_create_dctx_key);
+	ZSTD_DCtx *dctx =
+		tt_pthread_getspecific(memtx_tuple_compression_dctx_key);
+	if (dctx != NULL)
+		return dctx;
+	dctx = ZSTD_createDCtx();
+	if (dctx == NULL) {
+		diag_set(OutOfMemory, sizeof(dctx), "ZSTD_createDCtx",
+			 "dctx");
+		return NULL;
+	}
+	ZSTD_DCtx_setParameter(dctx, ZSTD_d_format, ZSTD_f_zstd1_magicless);
+	tt_pthread_setspecific(memtx_tuple_compression_dctx_key, dctx);
+	return dctx;
+}
+
+/** Return the compression context, creating it on demand. */
+static ZSTD_CCtx *
+memtx_tuple_compression_get_cctx(void)
+{
+	ZSTD_CCtx *cctx = memtx_tuple_compression_cctx;
+	if (cctx != NULL)
+		return cctx;
+	cctx = ZSTD_createCCtx();
+	if (cctx == NULL) {
+		diag_set(OutOfMemory, sizeof(cctx), "ZSTD_createCCtx",
+			 "cctx");
+		return NULL;
+	}
+	/*
+	 * Drop everything that can be restored from the field header
+	 * or the format to save a few bytes per field.
+	 */
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+			       MEMTX_COMPRESSION_LEVEL);
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_format, ZSTD_f_zstd1_magicless);
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_contentSizeFlag, 0);
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 0);
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_dictIDFlag, 0);
+	memtx_tuple_compression_cctx = cctx;
+	return cctx;
+}
+
+/** Free the collected dictionary samples. */
+static void
+memtx_tuple_compression_free_samples(struct memtx_tuple_compression *c)
+{
+	free(c->samples);
+	free(c->sample_sizes);
+	c->samples = NULL;
+	c->sample_sizes = NULL;
+	c->samples_size = 0;
+	c->sample_count = 0;
+}
+
+static void
+memtx_tuple_compression_destroy(struct tuple_format_compression *base)
+{
+	struct memtx_tuple_compression *c =
+		(struct memtx_tuple_compression *)base;
+	if (c->ddict != NULL) {
+		assert(memtx_tuple_compression_ddicts != NULL);
+		__atomic_store_n(&memtx_tuple_compression_ddicts[c->format_id],
+				 NULL, __ATOMIC_RELEASE);
+	}
+	ZSTD_freeCDict(c->cdict);
+	ZSTD_freeDDict(c->ddict);
+	memtx_tuple_compression_free_samples(c);
+	free(c);
+}
+
+/** Return the compression state of a format, creating it on demand. */
+static struct memtx_tuple_compression *
+memtx_tuple_compression_get(struct tuple_format *format)
+{
+	if (format->compression != NULL)
+		return (struct memtx_tuple_compression *)format->compression;
+	struct memtx_tuple_compression *c = xcalloc(1, sizeof(*c));
+	c->base.destroy = memtx_tuple_compression_destroy;
+	c->format_id = tuple_format_id(format);
+	c->samples = xmalloc(MEMTX_COMPRESSION_SAMPLES_SIZE);
+	c->sample_sizes = xmalloc(MEMTX_COMPRESSION_SAMPLE_COUNT *
+				  sizeof(*c->sample_sizes));
+	format->compression = &c->base;
+	return c;
+}
+
+/**
+ * Train a dictionary on the collected samples. On failure the fields
+ * of the format are compressed without a dictionary.
+ */
+static void
+memtx_tuple_compression_train(struct memtx_tuple_compression *c)
+{
+	char *dict = xmalloc(MEMTX_COMPRESSION_DICT_SIZE);
+	size_t dict_size = ZDICT_trainFromBuffer(dict,
+						 MEMTX_COMPRESSION_DICT_SIZE,
+						 c->samples, c->sample_sizes,
+						 c->sample_count);
+	memtx_tuple_compression_free_samples(c);
+	if (ZDICT_isError(dict_size)) {
+		say_verbose("failed to train tuple compression dictionary "
+			    "for format %u: %s", (unsigned)c->format_id,
+			    ZDICT_getErrorName(dict_size));
+		goto out;
+	}
+	c->cdict = ZSTD_createCDict(dict, dict_size, MEMTX_COMPRESSION_LEVEL);
+	c->ddict = ZSTD_createDDict(dict, dict_size);
+	if (c->cdict == NULL || c->ddict == NULL) {
+		ZSTD_freeCDict(c->cdict);
+		ZSTD_freeDDict(c->ddict);
+		c->cdict = NULL;
+		c->ddict = NULL;
+		goto out;
+	}
+	if (memtx_tuple_compression_ddicts == NULL) {
+		ZSTD_DDict **ddicts = xcalloc(FORMAT_ID_MAX + 1,
+					      sizeof(*ddicts));
+		__atomic_store_n(&memtx_tuple_compression_ddicts, ddicts,
+				 __ATOMIC_RELEASE);
+	}
+	__atomic_store_n(&memtx_tuple_compression_ddicts[c->format_id],
+			 c->ddict, __ATOMIC_RELEASE);
+out:
+	free(dict);
+}
+
+/** Add a field to the dictionary samples, train if there's enough. */
+static void
+memtx_tuple_compression_add_sample(struct memtx_tuple_compression *c,
+				   const char *field, size_t size)
+{
+	if (c->samples == NULL || size > MEMTX_COMPRESSION_MAX_SAMPLE_SIZE)
+		return;
+	if (c->samples_size + size > MEMTX_COMPRESSION_SAMPLES_SIZE ||
+	    c->sample_count == MEMTX_COMPRESSION_SAMPLE_COUNT) {
+		memtx_tuple_compression_train(c);
+		return;
+	}
+	memcpy(c->samples + c->samples_size, field, size);
+	c->samples_size += size;
+	c->sample_sizes[c->sample_count++] = size;
+}
+
+/**
+ * Compress a MsgPack field into MP_COMPRESSION extension stored at
+ * @a dst, which must have room for the extension header and
+ * ZSTD_compressBound(@a size) bytes. Unless @a force is set, leaves
+ * the field uncompressed if compression doesn't make it shorter.
+ * Returns the end of the written data, @a dst if the field was left
+ * uncompressed, or NULL on error.
+ */
+static char *
+memtx_tuple_compress_field(ZSTD_CCtx *cctx, struct memtx_tuple_compression *c,
+			   const char *field, size_t size, bool force,
+			   char *dst)
+{
+	uint32_t dict_id = c->cdict != NULL ? c->format_id + 1 : 0;
+	char *payload = dst + MEMTX_COMPRESSION_MAX_HEADER_SIZE;
+	ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+	ZSTD_CCtx_refCDict(cctx, c->cdict);
+	size_t payload_size = ZSTD_compress2(cctx, payload,
+					     ZSTD_compressBound(size),
+					     field, size);
+	if (ZSTD_isError(payload_size)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZSTD_getErrorName(payload_size));
+		return NULL;
+	}
+	uint32_t len = mp_sizeof_uint(COMPRESSION_TYPE_ZSTD) +
+		       mp_sizeof_uint(dict_id) + mp_sizeof_uint(size) +
+		       payload_size;
+	if (!force && mp_sizeof_ext(len) >= size)
+		return dst;
+	char *pos = mp_encode_extl(dst, MP_COMPRESSION, len);
+	pos = mp_encode_uint(pos, COMPRESSION_TYPE_ZSTD);
+	pos = mp_encode_uint(pos, dict_id);
+	pos = mp_encode_uint(pos, size);
+	assert(pos <= payload);
+	memmove(pos, payload, payload_size);
+	return pos + payload_size;
+}
+
+/** Return true if the field is MP_COMPRESSION extension. */
+static inline bool
+memtx_field_is_compressed(const char *field)
+{
+	if (mp_typeof(*field) != MP_EXT)
+		return false;
+	int8_t type;
+	mp_decode_extl(&field, &type);
+	return type == MP_COMPRESSION;
+}
+
+/**
+ * Return the compression type of a top-level field of a format or
+ * COMPRESSION_TYPE_NONE if the field isn't defined by the format.
+ */
+static inline enum compression_type
+memtx_field_compression_type(struct tuple_format *format, uint32_t fieldno)
+{
+	if (fieldno >= tuple_format_field_count(format))
+		return COMPRESSION_TYPE_NONE;
+	return tuple_format_field(format, fieldno)->compression_type;
+}
+
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	assert(format->is_compressed);
+	ZSTD_CCtx *cctx = memtx_tuple_compression_get_cctx();
+	if (cctx == NULL)
+		return NULL;
+	struct memtx_tuple_compression *c = memtx_tuple_compression_get(format);
+	uint32_t size;
+	const char *data = tuple_data_range(tuple, &size);
+	const char *data_end = data + size;
+	/* Find out how much space compression may take in the worst case. */
+	size_t capacity = size;
+	const char *field = data;
+	uint32_t field_count = mp_decode_array(&field);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field_end = field;
+		mp_next(&field_end);
+		if (memtx_field_compression_type(format, i) !=
+		    COMPRESSION_TYPE_NONE || memtx_field_is_compressed(field)) {
+			capacity += MEMTX_COMPRESSION_MAX_HEADER_SIZE +
+				    ZSTD_compressBound(field_end - field);
+		}
+		field = field_end;
+	}
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	char *buf = xregion_alloc(region, capacity);
+	struct tuple *result = NULL;
+	bool is_compressed = false;
+	field = data;
+	field_count = mp_decode_array(&field);
+	char *pos = mp_encode_array(buf, field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field_end = field;
+		mp_next(&field_end);
+		size_t field_size = field_end - field;
+		/*
+		 * Any field that looks compressed must be compressed
+		 * again, even if the format doesn't enable compression
+		 * for it, because all such fields are decompressed on
+		 * read, see memtx_tuple_decompress_data().
+		 */
+		bool force = memtx_field_is_compressed(field);
+		bool compress = memtx_field_compression_type(format, i) !=
+				COMPRESSION_TYPE_NONE &&
+				field_size >= MEMTX_COMPRESSION_MIN_FIELD_SIZE;
+		if (compress)
+			memtx_tuple_compression_add_sample(c, field,
+							   field_size);
+		char *end = pos;
+		if (compress || force) {
+			end = memtx_tuple_compress_field(cctx, c, field,
+							 field_size, force,
+							 pos);
+			if (end == NULL)
+				goto out;
+		}
+		if (end == pos) {
+			memcpy(pos, field, field_size);
+			end = pos + field_size;
+		} else {
+			is_compressed = true;
+		}
+		pos = end;
+		field = field_end;
+	}
+	assert(field == data_end);
+	(void)data_end;
+	assert((size_t)(pos - buf) <= capacity);
+	if (!is_compressed) {
+		result = tuple;
+		goto out;
+	}
+	result = memtx_tuple_new_raw(format, buf, pos, /*validate=*/false);
+	if (result != NULL)
+		tuple_set_flag(result, TUPLE_IS_COMPRESSED);
+out:
+	region_truncate(region, region_svp);
+	return result;
+}
+
+/**
+ * Decode MP_COMPRESSION extension, decompress it to @a dst, and
+ * advance @a data and @a dst. Returns 0 on success, -1 on error.
+ */
+static int
+memtx_tuple_decompress_field(const char **data, char **dst)
+{
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(data, &ext_type);
+	assert(ext_type == MP_COMPRESSION);
+	const char *end = *data + len;
+	uint64_t type, dict_id, raw_size;
+	if (mp_decode_compression_header(data, end, &type, &dict_id,
+					 &raw_size) != 0 ||
+	    type != COMPRESSION_TYPE_ZSTD || dict_id > FORMAT_ID_MAX + 1)
+		goto corrupted;
+	ZSTD_DDict *ddict = NULL;
+	if (dict_id != 0) {
+		ZSTD_DDict **ddicts = __atomic_load_n(
+			&memtx_tuple_compression_ddicts, __ATOMIC_ACQUIRE);
+		if (ddicts != NULL) {
+			ddict = __atomic_load_n(&ddicts[dict_id - 1],
+						__ATOMIC_ACQUIRE);
+		}
+		if (ddict == NULL)
+			goto corrupted;
+	}
+	ZSTD_DCtx *dctx = memtx_tuple_compression_dctx();
+	if (dctx == NULL)
+		return -1;
+	ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+	ZSTD_DCtx_refDDict(dctx, ddict);
+	size_t size = ZSTD_decompressDCtx(dctx, *dst, raw_size,
+					  *data, end - *data);
+	if (ZSTD_isError(size)) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 ZSTD_getErrorName(size));
+		return -1;
+	}
+	if (size != raw_size)
+		goto corrupted;
+	*data = end;
+	*dst += size;
+	return 0;
+corrupted:
+	diag_set(ClientError, ER_DECOMPRESSION, "corrupted data");
+	return -1;
+}
+
+/**
+ * Return the size of a compressed field after decompression or 0
+ * if the field header is malformed.
+ */
+static size_t
+memtx_compressed_field_raw_size(const char *field)
+{
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(&field, &ext_type);
+	uint64_t type, dict_id, raw_size;
+	if (mp_decode_compression_header(&field, field + len, &type,
+					 &dict_id, &raw_size) != 0 ||
+	    raw_size > UINT32_MAX)
+		return 0;
+	return raw_size;
+}
+
+/**
+ * Decompress all MP_COMPRESSION top-level fields of tuple data into
+ * a buffer allocated on the fiber region. Returns the given data if
+ * no field is compressed. Returns NULL on error.
+ *
+ * The format isn't needed, because memtx_tuple_compress() compresses
+ * every field that looks compressed so all of them were produced by
+ * it, and the dictionary is found by the id stored in the field.
+ */
+static const char *
+memtx_tuple_decompress_data(const char *data, const char *data_end,
+			    uint32_t *p_size)
+{
+	/* Find out the size of the decompressed data. */
+	size_t size = data_end - data;
+	bool is_compressed = false;
+	const char *field = data;
+	uint32_t field_count = mp_decode_array(&field);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field_end = field;
+		mp_next(&field_end);
+		if (memtx_field_is_compressed(field)) {
+			size_t raw_size =
+				memtx_compressed_field_raw_size(field);
+			if (raw_size == 0) {
+				diag_set(ClientError, ER_DECOMPRESSION,
+					 "corrupted data");
+				return NULL;
+			}
+			size += raw_size - (field_end - field);
+			is_compressed = true;
+		}
+		field = field_end;
+	}
+	if (!is_compressed) {
+		*p_size = data_end - data;
+		return data;
+	}
+	if (size > UINT32_MAX) {
+		diag_set(ClientError, ER_DECOMPRESSION, "tuple is too large");
+		return NULL;
+	}
+	char *buf = region_alloc(&fiber()->gc, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc", "buf");
+		return NULL;
+	}
+	field = data;
+	field_count = mp_decode_array(&field);
+	char *pos = mp_encode_array(buf, field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field_end = field;
+		mp_next(&field_end);
+		if (memtx_field_is_compressed(field)) {
+			if (memtx_tuple_decompress_field(&field, &pos) != 0)
+				return NULL;
+			assert(field == field_end);
+		} else {
+			memcpy(pos, field, field_end - field);
+			pos += field_end - field;
+		}
+		field = field_end;
+	}
+	assert(pos == buf + size);
+	*p_size = size;
+	return buf;
+}
+
+struct tuple *
+memtx_tuple_decompress_slow(struct tuple *tuple)
+{
+	assert(tuple_is_compressed(tuple));
+	struct tuple_format *format = tuple_format(tuple);
+	uint32_t size;
+	const char *data = tuple_data_range(tuple, &size);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *raw = memtx_tuple_decompress_data(data, data + size,
+						      &size);
+	struct tuple *result = tuple;
+	if (raw == NULL)
+		result = NULL;
+	else if (raw != data)
+		result = memtx_tuple_new_raw(format, raw, raw + size,
+					     /*validate=*/false);
+	region_truncate(region, region_svp);
+	return result;
+}
+
+const char *
+memtx_tuple_decompress_raw(const char *tuple, const char *tuple_end,
+			   uint32_t *p_size)
+{
+	return memtx_tuple_decompress_data(tuple, tuple_end, p_size);
+}
+
+#endif /* !defined(ENABLE_TUPLE_COMPRESSION) */
@@ -17,28 +17,43 @@
 extern "C" {
 #endif
 
-static inline struct tuple *
-memtx_tuple_compress(struct tuple *tuple)
-{
-        (void)tuple;
-        unreachable();
-        return NULL;
-}
+/**
+ * Compress the fields of a tuple that have compression enabled in
+ * the tuple format. Each such field is replaced with MP_COMPRESSION
+ * MsgPack extension if that makes it shorter. Returns a new tuple or
+ * the original tuple if no field was compressed. On error returns
+ * NULL and sets diag.
+ */
+struct tuple *
+memtx_tuple_compress(struct tuple *tuple);
+
+/** Slow path of memtx_tuple_decompress(). */
+struct tuple *
+memtx_tuple_decompress_slow(struct tuple *tuple);
 
+/**
+ * Return a tuple with all fields of the given tuple decompressed.
+ * The returned tuple may be the same as the given one. On error
+ * returns NULL and sets diag.
+ */
 static inline struct tuple *
 memtx_tuple_decompress(struct tuple *tuple)
 {
-	assert(!tuple_is_compressed(tuple));
-	return tuple;
+	if (likely(!tuple_is_compressed(tuple)))
+		return tuple;
+	return memtx_tuple_decompress_slow(tuple);
 }
 
-static inline const char *
+/**
+ * Decompress the fields of raw tuple data into the fiber region.
+ * Returns the decompressed data and stores its size in @a p_size.
+ * Returns the given data if nothing was compressed. May be called
+ * from any thread as long as the tuple is alive. On error returns
+ * NULL and sets diag.
+ */
+const char *
 memtx_tuple_decompress_raw(const char *tuple, const char *tuple_end,
-			   uint32_t *p_size)
-{
-	*p_size = tuple_end - tuple;
-	return tuple;
-}
+			   uint32_t *p_size);
 
 #if defined(__cplusplus)
 } /* extern "C" */
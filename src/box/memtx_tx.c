@@ -36,6 +36,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "fiber.h"
 #include "schema_def.h"
 #include "small/mempool.h"
 
@@ -107,23 +108,22 @@ struct memtx_story {
 	 */
 	struct rlist reader_list;
 	/**
-	 * Link in tx_manager::all_stories
-	 */
-	struct rlist in_all_stories;
-	/**
-	 * Link in space::memtx_tx_stories.
+	 * Link in space::memtx_tx_stories. The lists are traversed by
+	 * the garbage collector, see tx_manager::story_spaces.
 	 */
 	struct rlist in_space_stories;
-	/**
-	 * Number of indexes in this space - and the count of link[].
-	 */
-	uint32_t index_count;
 	/**
 	 * Status of story, describes the reason why story cannot be deleted.
 	 * It is initialized in memtx_story constructor and is changed only in
 	 * memtx_tx_story_gc.
 	 */
 	enum memtx_tx_story_status status;
+	/**
+	 * Number of indexes in this space - and the count of link[].
+	 * The story header is packed since there's a story per each
+	 * changed tuple.
+	 */
+	uint16_t index_count;
 	/**
 	 * Flag is set when @a tuple is not placed in primary key and
 	 * the story is the only reason why @a tuple cannot be deleted.
@@ -136,6 +136,9 @@ struct memtx_story {
 	struct memtx_story_link link[];
 };
 
+static_assert(BOX_INDEX_MAX <= UINT16_MAX,
+	      "memtx_story::index_count must fit the max index count");
+
 static uint32_t
 memtx_tx_story_key_hash(const struct tuple *a)
 {
@@ -214,7 +217,7 @@ enum gap_item_type {
 	/**
 	 * A transaction completed a full scan of unordered index. After that
 	 * any consequent write to any new place of the index must lead to
-	 * conflict. Such an item will be store in index->read_gaps.
+	 * conflict. Such an item will be store in index->full_scans.
 	 */
 	GAP_FULL_SCAN,
 };
@@ -227,7 +230,10 @@ enum gap_item_type {
 struct gap_item_base {
 	/** Type of gap record. */
 	enum gap_item_type type;
-	/** A link in memtx_story_link::read_gaps OR index::read_gaps. */
+	/**
+	 * A link in memtx_story_link::read_gaps OR index::read_gaps OR
+	 * index::full_scans.
+	 */
 	struct rlist in_read_gaps;
 	/** Link in txn->gap_list. */
 	struct rlist in_gap_list;
@@ -562,16 +568,43 @@ struct tx_manager
 	struct memtx_tx_mempool nearby_gap_item_mempoool;
 	/** Mempool for full_scan_gap_item objects. */
 	struct memtx_tx_mempool full_scan_gap_item_mempool;
-	/** List of all memtx_story objects. */
-	struct rlist all_stories;
+	/**
+	 * List of all spaces that have stories, linked by
+	 * space::in_story_spaces. All memtx_story objects are reachable
+	 * through space::memtx_stories of these spaces.
+	 */
+	struct rlist story_spaces;
 	struct memtx_tx_stats story_stats[MEMTX_TX_STORY_STATUS_MAX];
 	struct memtx_tx_stats retained_tuple_stats[MEMTX_TX_STORY_STATUS_MAX];
-	/** Iterator that sequentially traverses all memtx_story objects. */
-	struct rlist *traverse_all_stories;
+	/**
+	 * Space whose stories are being traversed by GC or NULL if GC
+	 * came to the head of the story_spaces list.
+	 */
+	struct space *traverse_space;
+	/**
+	 * Iterator that sequentially traverses stories of traverse_space.
+	 * Points either to a story or to the head of the story list.
+	 */
+	struct rlist *traverse_stories;
 	/** The list containing all transactions. */
 	struct rlist all_txs;
 	/** Accumulated number of GC steps that should be done. */
 	size_t must_do_gc_steps;
+	/**
+	 * Lowest read view PSN seen by the last GC run. Stories retained
+	 * for read views may only become garbage when it grows, so it
+	 * serves as a GC epoch: once it advances, a bulk GC pass over
+	 * all stories is scheduled.
+	 */
+	int64_t gc_rv_psn;
+	/** Number of steps left to do by the bulk GC fiber. */
+	size_t gc_bulk_steps;
+	/** Fiber doing bulk GC, started on demand. */
+	struct fiber *gc_fiber;
+	/** Number of stories visited by GC. */
+	int64_t gc_steps;
+	/** Number of stories deleted by GC. */
+	int64_t gc_reclaimed;
 };
 
 enum {
@@ -581,6 +614,11 @@ enum {
 	 * a new story.
 	 */
 		TX_MANAGER_GC_STEPS_SIZE = 2,
+	/**
+	 * Number of steps done by the bulk GC fiber before yielding to
+	 * let other fibers run.
+	 */
+	TX_MANAGER_GC_BULK_STEPS_SIZE = 1000,
 };
 
 /** That's a definition, see declaration for description. */
@@ -613,10 +651,16 @@ memtx_tx_manager_init()
 	memtx_tx_mempool_create(&txm.full_scan_gap_item_mempool,
 				sizeof(struct full_scan_gap_item),
 				MEMTX_TX_ALLOC_TRACKER);
-	rlist_create(&txm.all_stories);
+	rlist_create(&txm.story_spaces);
 	rlist_create(&txm.all_txs);
-	txm.traverse_all_stories = &txm.all_stories;
+	txm.traverse_space = NULL;
+	txm.traverse_stories = NULL;
 	txm.must_do_gc_steps = 0;
+	txm.gc_rv_psn = 0;
+	txm.gc_bulk_steps = 0;
+	txm.gc_fiber = NULL;
+	txm.gc_steps = 0;
+	txm.gc_reclaimed = 0;
 	memset(&txm.story_stats, 0, sizeof(txm.story_stats));
 }
 
@@ -633,6 +677,26 @@ memtx_tx_manager_free()
 	memtx_tx_mempool_destroy(&txm.full_scan_gap_item_mempool);
 }
 
+/**
+ * Return the PSN of the oldest read view. Stories changed by transactions
+ * with a lower PSN are not visible from any read view.
+ */
+static int64_t
+memtx_tx_lowest_rv_psn(void)
+{
+	/*
+	 * Default value is txn_next_psn because if it is not so some
+	 * stories (stories produced by last txn at least) will be marked as
+	 * potentially in read view even though there are no txns in read view.
+	 */
+	if (rlist_empty(&txm.read_view_txs))
+		return txn_next_psn;
+	struct txn *txn = rlist_first_entry(&txm.read_view_txs, struct txn,
+					    in_read_view_txs);
+	assert(txn->rv_psn != 0);
+	return txn->rv_psn;
+}
+
 void
 memtx_tx_statistics_collect(struct memtx_tx_statistics *stats)
 {
@@ -641,6 +705,10 @@ memtx_tx_statistics_collect(struct memtx_tx_statistics *stats)
 		stats->stories[i] = txm.story_stats[i];
 		stats->retained_tuples[i] = txm.retained_tuple_stats[i];
 	}
+	stats->gc_steps = txm.gc_steps;
+	stats->gc_reclaimed = txm.gc_reclaimed;
+	stats->gc_pending = txm.gc_bulk_steps;
+	stats->gc_lag = txn_next_psn - memtx_tx_lowest_rv_psn();
 	if (rlist_empty(&txm.all_txs)) {
 		return;
 	}
@@ -732,6 +800,23 @@ memtx_tx_adjust_position_in_read_view_list(struct txn *txn)
 	rlist_add_tail(&prev_txn->in_read_view_txs, &txn->in_read_view_txs);
 }
 
+void
+memtx_tx_send_to_read_view(struct txn *txn)
+{
+	assert(stailq_empty(&txn->stmts));
+	if (!memtx_tx_manager_use_mvcc_engine ||
+	    txn->status != TXN_INPROGRESS)
+		return;
+	/*
+	 * Changes of all transactions prepared so far have PSN less
+	 * than txn_next_psn so they stay visible.
+	 */
+	txn->status = TXN_IN_READ_VIEW;
+	txn->rv_psn = txn_next_psn;
+	rlist_add_tail(&txm.read_view_txs, &txn->in_read_view_txs);
+	memtx_tx_adjust_position_in_read_view_list(txn);
+}
+
 /**
  * Mark @a victim as conflicted and abort it.
  * Does nothing if the transaction is already aborted.
@@ -937,7 +1022,8 @@ memtx_tx_story_new(struct space *space, struct tuple *tuple)
 	story->del_stmt = NULL;
 	story->del_psn = 0;
 	rlist_create(&story->reader_list);
-	rlist_add_tail(&txm.all_stories, &story->in_all_stories);
+	if (rlist_empty(&space->memtx_stories))
+		rlist_add_tail(&txm.story_spaces, &space->in_story_spaces);
 	rlist_add(&space->memtx_stories, &story->in_space_stories);
 	for (uint32_t i = 0; i < index_count; i++) {
 		story->link[i].newer_story = story->link[i].older_story = NULL;
@@ -947,6 +1033,26 @@ memtx_tx_story_new(struct space *space, struct tuple *tuple)
 	return story;
 }
 
+/**
+ * Move the story GC crawler to the next space that has stories or to the
+ * head of the space list if the current space is the last one.
+ */
+static void
+memtx_tx_story_gc_next_space(void)
+{
+	struct space *space = txm.traverse_space;
+	assert(space != NULL);
+	if (rlist_next(&space->in_story_spaces) == &txm.story_spaces) {
+		txm.traverse_space = NULL;
+		txm.traverse_stories = NULL;
+		return;
+	}
+	space = rlist_next_entry(space, in_story_spaces);
+	assert(!rlist_empty(&space->memtx_stories));
+	txm.traverse_space = space;
+	txm.traverse_stories = rlist_first(&space->memtx_stories);
+}
+
 /**
  * Deletes a story. Expects the story to be fully unlinked.
  */
@@ -966,10 +1072,20 @@ memtx_tx_story_delete(struct memtx_story *story)
 	if (story->tuple_is_retained)
 		memtx_tx_story_untrack_retained_tuple(story);
 
-	if (txm.traverse_all_stories == &story->in_all_stories)
-		txm.traverse_all_stories = rlist_next(txm.traverse_all_stories);
-	rlist_del(&story->in_all_stories);
-	rlist_del(&story->in_space_stories);
+	if (txm.traverse_space != NULL &&
+	    txm.traverse_stories == &story->in_space_stories)
+		txm.traverse_stories = rlist_next(txm.traverse_stories);
+	if (story->in_space_stories.next == story->in_space_stories.prev) {
+		/* The last story of the space, the other link is the head. */
+		struct space *space = rlist_entry(story->in_space_stories.next,
+						  struct space, memtx_stories);
+		rlist_del(&story->in_space_stories);
+		if (txm.traverse_space == space)
+			memtx_tx_story_gc_next_space();
+		rlist_del(&space->in_story_spaces);
+	} else {
+		rlist_del(&story->in_space_stories);
+	}
 
 	mh_int_t pos = mh_history_find(txm.history, story->tuple, 0);
 	assert(pos != mh_end(txm.history));
@@ -1496,37 +1612,38 @@ memtx_tx_story_full_unlink_story_gc_step(struct memtx_story *story)
 }
 
 /**
- * Run one step of a crawler that traverses all stories and removes no more
- * used stories.
+ * Run one step of a crawler that traverses all stories space by space
+ * and removes no more used stories.
  */
 void
 memtx_tx_story_gc_step()
 {
-	if (txm.traverse_all_stories == &txm.all_stories) {
+	if (txm.traverse_space == NULL) {
 		/* We came to the head of the list. */
-		txm.traverse_all_stories = txm.traverse_all_stories->next;
+		if (!rlist_empty(&txm.story_spaces)) {
+			struct space *space =
+				rlist_first_entry(&txm.story_spaces,
+						  struct space,
+						  in_story_spaces);
+			txm.traverse_space = space;
+			txm.traverse_stories =
+				rlist_first(&space->memtx_stories);
+		}
 		return;
 	}
-
-	/*
-	 * Lowest read view PSN.
-	 * Default value is txn_next_psn because if it is not so some
-	 * stories (stories produced by last txn at least) will be marked as
-	 * potentially in read view even though there are no txns in read view.
-	 */
-	int64_t lowest_rv_psn = txn_next_psn;
-	if (!rlist_empty(&txm.read_view_txs)) {
-		struct txn *txn =
-			rlist_first_entry(&txm.read_view_txs, struct txn,
-					  in_read_view_txs);
-		assert(txn->rv_psn != 0);
-		lowest_rv_psn = txn->rv_psn;
+	if (txm.traverse_stories == &txm.traverse_space->memtx_stories) {
+		/* We came to the end of the space story list. */
+		memtx_tx_story_gc_next_space();
+		if (txm.traverse_space == NULL)
+			return;
 	}
 
+	int64_t lowest_rv_psn = memtx_tx_lowest_rv_psn();
 	struct memtx_story *story =
-		rlist_entry(txm.traverse_all_stories, struct memtx_story,
-			    in_all_stories);
-	txm.traverse_all_stories = txm.traverse_all_stories->next;
+		rlist_entry(txm.traverse_stories, struct memtx_story,
+			    in_space_stories);
+	txm.traverse_stories = txm.traverse_stories->next;
+	txm.gc_steps++;
 
 	/**
 	 * The order in which conditions are checked is important,
@@ -1582,6 +1699,55 @@ memtx_tx_story_gc_step()
 	/* Unlink and delete the story */
 	memtx_tx_story_full_unlink_story_gc_step(story);
 	memtx_tx_story_delete(story);
+	txm.gc_reclaimed++;
+}
+
+/**
+ * Body of the fiber that runs bulk GC passes scheduled by
+ * memtx_tx_story_gc_schedule_bulk(). The work is split in batches,
+ * yielding in between, so that GC runs when the tx thread has
+ * nothing else to do rather than in the middle of transactions.
+ */
+static int
+memtx_tx_story_gc_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		if (txm.gc_bulk_steps == 0) {
+			fiber_yield();
+			continue;
+		}
+		size_t steps = MIN(txm.gc_bulk_steps,
+				   (size_t)TX_MANAGER_GC_BULK_STEPS_SIZE);
+		txm.gc_bulk_steps -= steps;
+		for (size_t i = 0; i < steps; i++)
+			memtx_tx_story_gc_step();
+		fiber_sleep(0);
+	}
+	return 0;
+}
+
+/**
+ * Schedule a GC pass over all stories in the background.
+ */
+static void
+memtx_tx_story_gc_schedule_bulk(void)
+{
+	size_t story_count = 0;
+	for (size_t i = 0; i < MEMTX_TX_STORY_STATUS_MAX; i++)
+		story_count += txm.story_stats[i].count;
+	txm.gc_bulk_steps = story_count;
+	if (txm.gc_fiber == NULL) {
+		txm.gc_fiber = fiber_new_system("memtx.tx_gc",
+						memtx_tx_story_gc_f);
+		if (txm.gc_fiber == NULL) {
+			/* Not critical - incremental GC will do the job. */
+			diag_log();
+			txm.gc_bulk_steps = 0;
+			return;
+		}
+	}
+	fiber_wakeup(txm.gc_fiber);
 }
 
 void
@@ -1590,6 +1756,16 @@ memtx_tx_story_gc()
 	for (size_t i = 0; i < txm.must_do_gc_steps; i++)
 		memtx_tx_story_gc_step();
 	txm.must_do_gc_steps = 0;
+	/*
+	 * Stories retained for read views can't be deleted by incremental
+	 * GC until the oldest read view is closed. When it happens, there
+	 * may be a lot of garbage to collect so do it in bulk.
+	 */
+	int64_t lowest_rv_psn = memtx_tx_lowest_rv_psn();
+	if (lowest_rv_psn > txm.gc_rv_psn &&
+	    txm.story_stats[MEMTX_TX_STORY_READ_VIEW].count > 0)
+		memtx_tx_story_gc_schedule_bulk();
+	txm.gc_rv_psn = lowest_rv_psn;
 }
 
 /**
@@ -1733,6 +1909,21 @@ memtx_tx_track_read_story(struct txn *txn, struct space *space,
  * Track that the @a story was read by @a txn and in index @a ind,
  * by no tuple was visible here. The @a story must be on top of chain.
  */
+/**
+ * Check if all the changes described by @a story are committed, i.e. it
+ * can't be rolled back any more. A transaction in a read view doesn't
+ * need to track such a story: changes prepared later have greater PSN
+ * and are never visible from the read view. Stories with prepared
+ * changes must be tracked though, because if they are rolled back, the
+ * readers that saw them must be aborted, see
+ * memtx_tx_abort_story_readers() and memtx_tx_abort_gap_readers().
+ */
+static inline bool
+memtx_tx_story_is_committed(const struct memtx_story *story)
+{
+	return story->add_stmt == NULL && story->del_stmt == NULL;
+}
+
 static void
 memtx_tx_track_story_gap(struct txn *txn, struct memtx_story *story,
 			 uint32_t ind);
@@ -1866,6 +2057,9 @@ memtx_tx_track_story_gap(struct txn *txn, struct memtx_story *story,
 {
 	assert(story->link[ind].newer_story == NULL);
 	assert(txn != NULL);
+	if (txn->status == TXN_IN_READ_VIEW &&
+	    memtx_tx_story_is_committed(story))
+		return;
 	struct inplace_gap_item *item = memtx_tx_inplace_gap_item_new(txn);
 	rlist_add(&story->link[ind].read_gaps, &item->base.in_read_gaps);
 }
@@ -1882,10 +2076,9 @@ memtx_tx_handle_gap_write(struct space *space, struct memtx_story *story,
 	struct tuple *tuple = story->tuple;
 	struct index *index = space->index[ind];
 	struct gap_item_base *item_base, *tmp;
-	rlist_foreach_entry_safe(item_base, &index->read_gaps,
+	rlist_foreach_entry_safe(item_base, &index->full_scans,
 				 in_read_gaps, tmp) {
-		if (item_base->type != GAP_FULL_SCAN)
-			continue;
+		assert(item_base->type == GAP_FULL_SCAN);
 		memtx_tx_track_story_gap(item_base->txn, story, ind);
 	}
 	if (successor != NULL && !tuple_has_flag(successor, TUPLE_IS_DIRTY))
@@ -2927,6 +3120,13 @@ memtx_tx_on_index_delete(struct index *index)
 					  in_read_gaps);
 		memtx_tx_delete_gap(item);
 	}
+	while (!rlist_empty(&index->full_scans)) {
+		struct gap_item_base *item =
+			rlist_first_entry(&index->full_scans,
+					  struct gap_item_base,
+					  in_read_gaps);
+		memtx_tx_delete_gap(item);
+	}
 	memtx_tx_story_gc();
 }
 
@@ -2989,6 +3189,9 @@ memtx_tx_track_read_story(struct txn *txn, struct space *space,
 {
 	if (txn == NULL || space == NULL || space->def->opts.is_ephemeral)
 		return;
+	if (txn->status == TXN_IN_READ_VIEW &&
+	    memtx_tx_story_is_committed(story))
+		return;
 	(void)space;
 	assert(story != NULL);
 	struct tx_read_tracker *tracker = NULL;
@@ -3038,6 +3241,9 @@ memtx_tx_track_read(struct txn *txn, struct space *space, struct tuple *tuple)
 		struct memtx_story *story = memtx_tx_story_get(tuple);
 		memtx_tx_track_read_story(txn, space, story);
 	} else {
+		/* A tuple without a story is committed. */
+		if (txn->status == TXN_IN_READ_VIEW)
+			return;
 		struct memtx_story *story = memtx_tx_story_new(space, tuple);
 		struct tx_read_tracker *tracker;
 		tracker = tx_read_tracker_new(txn, story);
@@ -3213,6 +3419,35 @@ memtx_tx_full_scan_gap_item_new(struct txn *txn)
 	return item;
 }
 
+/**
+ * Check if the gap item added last to @a list was created by @a txn for
+ * the same read. A transaction reading the same range again, e.g. in a
+ * loop, doesn't need another item, since both would be split, moved, and
+ * cause conflicts together.
+ */
+static bool
+memtx_tx_nearby_gap_is_tracked(struct rlist *list, struct txn *txn,
+			       enum iterator_type type, const char *key,
+			       uint32_t part_count)
+{
+	if (rlist_empty(list))
+		return false;
+	struct gap_item_base *item_base =
+		rlist_first_entry(list, struct gap_item_base, in_read_gaps);
+	if (item_base->type != GAP_NEARBY || item_base->txn != txn)
+		return false;
+	struct nearby_gap_item *item = (struct nearby_gap_item *)item_base;
+	if (item->type != type || item->part_count != part_count)
+		return false;
+	if (part_count == 0)
+		return true;
+	const char *key_end = key;
+	for (uint32_t i = 0; i < part_count; i++)
+		mp_next(&key_end);
+	return item->key_len == (uint32_t)(key_end - key) &&
+	       memcmp(item->key, key, item->key_len) == 0;
+}
+
 /**
  * Record in TX manager that a transaction @a txn have read nothing
  * from @a space and @a index with @a key, somewhere from interval between
@@ -3229,9 +3464,7 @@ memtx_tx_track_gap_slow(struct txn *txn, struct space *space, struct index *inde
 	if (txn->status != TXN_INPROGRESS)
 		return;
 
-	struct nearby_gap_item *item =
-		memtx_tx_nearby_gap_item_new(txn, type, key, part_count);
-
+	struct rlist *list = &index->read_gaps;
 	if (successor != NULL) {
 		struct memtx_story *story;
 		if (tuple_has_flag(successor, TUPLE_IS_DIRTY)) {
@@ -3241,10 +3474,13 @@ memtx_tx_track_gap_slow(struct txn *txn, struct space *space, struct index *inde
 		}
 		assert(index->dense_id < story->index_count);
 		assert(story->link[index->dense_id].in_index != NULL);
-		rlist_add(&story->link[index->dense_id].read_gaps,
-			  &item->base.in_read_gaps);
-	} else {
-		rlist_add(&index->read_gaps, &item->base.in_read_gaps);
+		list = &story->link[index->dense_id].read_gaps;
+	}
+	if (!memtx_tx_nearby_gap_is_tracked(list, txn, type, key, part_count)) {
+		struct nearby_gap_item *item =
+			memtx_tx_nearby_gap_item_new(txn, type, key,
+						     part_count);
+		rlist_add(list, &item->base.in_read_gaps);
 	}
 	memtx_tx_story_gc();
 }
@@ -3260,8 +3496,13 @@ memtx_tx_track_full_scan_slow(struct txn *txn, struct index *index)
 	if (txn->status != TXN_INPROGRESS)
 		return;
 
+	/* The same transaction may scan the index more than once. */
+	if (!rlist_empty(&index->full_scans) &&
+	    rlist_first_entry(&index->full_scans, struct gap_item_base,
+			      in_read_gaps)->txn == txn)
+		return;
 	struct full_scan_gap_item *item = memtx_tx_full_scan_gap_item_new(txn);
-	rlist_add(&index->read_gaps, &item->base.in_read_gaps);
+	rlist_add(&index->full_scans, &item->base.in_read_gaps);
 	memtx_tx_story_gc();
 }
 
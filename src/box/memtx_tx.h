@@ -132,6 +132,18 @@ struct memtx_tx_statistics {
 	size_t tx_max[TX_ALLOC_TYPE_MAX];
 	/* Number of txns registered in memtx transaction manager. */
 	size_t txn_count;
+	/* Number of stories visited by garbage collector. */
+	int64_t gc_steps;
+	/* Number of stories deleted by garbage collector. */
+	int64_t gc_reclaimed;
+	/* Number of steps left to do by background garbage collector. */
+	size_t gc_pending;
+	/*
+	 * Number of transactions prepared since the oldest read view was
+	 * created. Stories created by them can't be deleted until the
+	 * read view is closed.
+	 */
+	int64_t gc_lag;
 };
 
 /**
@@ -147,6 +159,15 @@ memtx_tx_statistics_collect(struct memtx_tx_statistics *stats);
 void
 memtx_tx_register_txn(struct txn *txn);
 
+/**
+ * Send a transaction that hasn't made any changes to a read view of
+ * the current database state. Reads done in a read view don't need
+ * to be tracked, because no transaction that is prepared later can
+ * change what the transaction sees. Does nothing if MVCC is disabled.
+ */
+void
+memtx_tx_send_to_read_view(struct txn *txn);
+
 /**
  * Initialize memtx transaction manager.
  */
@@ -36,9 +36,6 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-#define HEAP_FORWARD_DECLARATION
-#include "salad/heap.h"
-
 #include "diag.h"             /* diag_set() */
 #include "box/tuple.h"        /* tuple_ref(), tuple_unref(),
 				 tuple_validate() */
@@ -53,41 +50,39 @@
  * Holds a source to fetch next tuples and a last fetched tuple to
  * compare the node against other nodes.
  *
- * The main reason why this structure is separated from a merge
- * source is that a heap node can not be a member of several
- * heaps.
- *
- * The second reason is that it allows to encapsulate all heap
- * related logic inside this compilation unit, without any traces
- * in externally visible structures.
+ * The structure is separated from a merge source, because a source
+ * can be used by several mergers. It also allows to encapsulate all
+ * tournament tree related logic inside this compilation unit,
+ * without any traces in externally visible structures.
  */
-struct merger_heap_node {
+struct merger_node {
 	/* A source of tuples. */
 	struct merge_source *source;
 	/*
 	 * A last fetched (refcounted) tuple to compare against
-	 * other nodes.
+	 * other nodes or NULL if the source is exhausted.
 	 */
 	struct tuple *tuple;
-	/* An anchor to make the structure a merger heap node. */
-	struct heap_node in_merger;
 };
 
 static bool
-merge_source_less(const heap_t *heap, const struct merger_heap_node *left,
-		  const struct merger_heap_node *right);
-#define HEAP_NAME merger_heap
-#define HEAP_LESS merge_source_less
-#define heap_value_t struct merger_heap_node
-#define heap_value_attr in_merger
-#include "salad/heap.h"
-#undef HEAP_NAME
-#undef HEAP_LESS
-#undef heap_value_t
-#undef heap_value_attr
+merger_node_less(struct loser_tree *tree, struct merger_node *a,
+		 struct merger_node *b);
+
+#define LOSER_TREE_NAME merger_tree
+#define LOSER_TREE_LESS merger_node_less
+#define loser_tree_value_t struct merger_node
+#include "salad/loser_tree.h"
 
 /**
- * Holds a heap, parameters of a merge process and utility fields.
+ * Holds a tournament tree, parameters of a merge process and utility
+ * fields.
+ *
+ * The sources are merged with a tournament tree of losers, see
+ * salad/loser_tree.h. When the winner fetches its next tuple, only
+ * the matches on the path from its leaf to the root are replayed, so
+ * one comparison per tree level is made instead of two made by
+ * a binary heap. Exhausted sources are removed from the tree.
  */
 struct merger {
 	/* A merger is a source. */
@@ -95,7 +90,7 @@ struct merger {
 	/*
 	 * Whether a merge process started.
 	 *
-	 * The merger postpones charging of heap nodes until a
+	 * The merger postpones fetching of first tuples until a
 	 * first output tuple is acquired.
 	 */
 	bool started;
@@ -103,14 +98,16 @@ struct merger {
 	struct key_def *key_def;
 	/* A format to acquire compatible tuples from sources. */
 	struct tuple_format *format;
+	/* An array of nodes. */
+	uint32_t node_count;
+	struct merger_node *nodes;
 	/*
-	 * A heap of sources (of nodes that contains a source to
-	 * be exact).
+	 * Pointers to the nodes that aren't exhausted, used to
+	 * build the tree.
 	 */
-	heap_t heap;
-	/* An array of heap nodes. */
-	uint32_t node_count;
-	struct merger_heap_node *nodes;
+	struct merger_node **node_ptrs;
+	/* The tournament tree of nodes, the winner at the top. */
+	struct loser_tree tree;
 	/* Ascending (false) / descending (true) order. */
 	bool reverse;
 };
@@ -118,77 +115,45 @@ struct merger {
 /* Helpers */
 
 /**
- * Data comparing function to construct a heap of sources.
+ * Return true if the tuple of the node a must be output before the
+ * tuple of the node b. Ties are won by the node with the lesser index
+ * to keep the merge stable.
  */
 static bool
-merge_source_less(const heap_t *heap, const struct merger_heap_node *left,
-		  const struct merger_heap_node *right)
+merger_node_less(struct loser_tree *tree, struct merger_node *a,
+		 struct merger_node *b)
 {
-	assert(left->tuple != NULL);
-	assert(right->tuple != NULL);
-	struct merger *merger = container_of(heap, struct merger, heap);
-	int cmp = tuple_compare(left->tuple, HINT_NONE, right->tuple, HINT_NONE,
+	struct merger *merger = container_of(tree, struct merger, tree);
+	assert(a->tuple != NULL && b->tuple != NULL);
+	int cmp = tuple_compare(a->tuple, HINT_NONE, b->tuple, HINT_NONE,
 				merger->key_def);
-	return merger->reverse ? cmp >= 0 : cmp < 0;
+	if (merger->reverse)
+		cmp = -cmp;
+	return cmp < 0 || (cmp == 0 && a < b);
 }
 
 /**
- * Initialize a new merger heap node.
+ * Initialize a new merger node.
  */
 static void
-merger_heap_node_create(struct merger_heap_node *node,
-			struct merge_source *source)
+merger_node_create(struct merger_node *node, struct merge_source *source)
 {
 	node->source = source;
 	merge_source_ref(node->source);
 	node->tuple = NULL;
-	heap_node_create(&node->in_merger);
 }
 
 /**
- * Free a merger heap node.
+ * Free a merger node.
  */
 static void
-merger_heap_node_delete(struct merger_heap_node *node)
+merger_node_delete(struct merger_node *node)
 {
 	merge_source_unref(node->source);
 	if (node->tuple != NULL)
 		tuple_unref(node->tuple);
 }
 
-/**
- * The helper to add a new heap node to a merger heap.
- *
- * Return -1 at an error and set a diag.
- *
- * Otherwise store a next tuple in node->tuple, add the node to
- * merger->heap and return 0.
- */
-static int
-merger_add_heap_node(struct merger *merger, struct merger_heap_node *node)
-{
-	struct tuple *tuple = NULL;
-
-	/* Acquire a next tuple. */
-	struct merge_source *source = node->source;
-	if (merge_source_next(source, merger->format, &tuple) != 0)
-		return -1;
-
-	/* Don't add an empty source to a heap. */
-	if (tuple == NULL)
-		return 0;
-
-	node->tuple = tuple;
-
-	/* Add a node to a heap. */
-	if (merger_heap_insert(&merger->heap, node) != 0) {
-		diag_set(OutOfMemory, 0, "malloc", "merger->heap");
-		return -1;
-	}
-
-	return 0;
-}
-
 /* Virtual methods declarations */
 
 static void
@@ -210,20 +175,21 @@ static int
 merger_set_sources(struct merger *merger, struct merge_source **sources,
 		   uint32_t source_count)
 {
-	const size_t nodes_size = sizeof(struct merger_heap_node) *
-		source_count;
-	struct merger_heap_node *nodes = malloc(nodes_size);
+	const size_t nodes_size = sizeof(struct merger_node) * source_count;
+	const size_t ptrs_size = sizeof(struct merger_node *) * source_count;
+	struct merger_node *nodes = malloc(nodes_size + ptrs_size);
 	if (nodes == NULL) {
-		diag_set(OutOfMemory, nodes_size, "malloc",
-			 "merger heap nodes");
+		diag_set(OutOfMemory, nodes_size + ptrs_size, "malloc",
+			 "merger nodes");
 		return -1;
 	}
 
 	for (uint32_t i = 0; i < source_count; ++i)
-		merger_heap_node_create(&nodes[i], sources[i]);
+		merger_node_create(&nodes[i], sources[i]);
 
 	merger->node_count = source_count;
 	merger->nodes = nodes;
+	merger->node_ptrs = (struct merger_node **)(nodes + source_count);
 	return 0;
 }
 
@@ -262,15 +228,15 @@ merger_new(struct key_def *key_def, struct merge_source **sources,
 	merger->started = false;
 	merger->key_def = key_def;
 	merger->format = format;
-	merger_heap_create(&merger->heap);
 	merger->node_count = 0;
 	merger->nodes = NULL;
+	merger->node_ptrs = NULL;
+	merger_tree_create(&merger->tree);
 	merger->reverse = reverse;
 
 	if (merger_set_sources(merger, sources, source_count) != 0) {
 		key_def_delete(merger->key_def);
 		tuple_format_unref(merger->format);
-		merger_heap_destroy(&merger->heap);
 		free(merger);
 		return NULL;
 	}
@@ -287,13 +253,13 @@ merger_delete(struct merge_source *base)
 
 	key_def_delete(merger->key_def);
 	tuple_format_unref(merger->format);
-	merger_heap_destroy(&merger->heap);
 
 	for (uint32_t i = 0; i < merger->node_count; ++i)
-		merger_heap_node_delete(&merger->nodes[i]);
+		merger_node_delete(&merger->nodes[i]);
 
 	if (merger->nodes != NULL)
 		free(merger->nodes);
+	merger_tree_destroy(&merger->tree);
 
 	free(merger);
 }
@@ -304,22 +270,44 @@ merger_next(struct merge_source *base, struct tuple_format *format,
 {
 	struct merger *merger = container_of(base, struct merger, base);
 
+	if (merger->node_count == 0) {
+		*out = NULL;
+		return 0;
+	}
+
 	/*
-	 * Fetch a first tuple for each source and add all heap
-	 * nodes to a merger heap.
+	 * Fetch a first tuple for each source and play all
+	 * matches of the tournament tree.
 	 */
 	if (!merger->started) {
 		for (uint32_t i = 0; i < merger->node_count; ++i) {
-			struct merger_heap_node *node = &merger->nodes[i];
-			if (merger_add_heap_node(merger, node) != 0)
+			struct merger_node *node = &merger->nodes[i];
+			if (node->tuple != NULL)
+				continue;
+			if (merge_source_next(node->source, merger->format,
+					      &node->tuple) != 0)
 				return -1;
 		}
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < merger->node_count; ++i) {
+			struct merger_node *node = &merger->nodes[i];
+			if (node->tuple != NULL)
+				merger->node_ptrs[count++] = node;
+		}
+		if (merger_tree_build(&merger->tree, merger->node_ptrs,
+				      count) != 0) {
+			size_t size = count * (sizeof(void *) +
+					       2 * sizeof(uint32_t));
+			diag_set(OutOfMemory, size, "malloc", "merger tree");
+			return -1;
+		}
 		merger->started = true;
 	}
 
 	/* Get a next tuple. */
-	struct merger_heap_node *node = merger_heap_top(&merger->heap);
+	struct merger_node *node = merger_tree_top(&merger->tree);
 	if (node == NULL) {
+		/* All sources are exhausted. */
 		*out = NULL;
 		return 0;
 	}
@@ -339,11 +327,11 @@ merger_next(struct merge_source *base, struct tuple_format *format,
 	if (merge_source_next(source, merger->format, &node->tuple) != 0)
 		return -1;
 
-	/* Update a heap. */
-	if (node->tuple == NULL)
-		merger_heap_delete(&merger->heap, node);
+	/* Update the tournament tree. */
+	if (node->tuple != NULL)
+		merger_tree_update_top(&merger->tree);
 	else
-		merger_heap_update(&merger->heap, node);
+		merger_tree_pop(&merger->tree);
 
 	*out = tuple;
 	return 0;
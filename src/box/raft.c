@@ -67,6 +67,13 @@ static struct trigger box_raft_on_quorum_loss;
 
 struct event *box_raft_on_election_event;
 
+/**
+ * Raft term in which this instance obtained the leader lease by taking
+ * over the limbo or 0 if it doesn't have the lease. See
+ * box_raft_has_lease().
+ */
+static uint64_t box_raft_lease_term = 0;
+
 /**
  * Worker fiber does all the asynchronous work, which may need yields and can be
  * long. These are WAL writes, network broadcasts. That allows not to block the
@@ -195,6 +202,10 @@ box_raft_on_update_f(struct trigger *trigger, void *event)
 	 */
 	box_update_ro_summary();
 	box_broadcast_election();
+	/* Any term bump ends the lease, even if the node is the leader. */
+	if (raft->volatile_term != box_raft_lease_term ||
+	    raft->state != RAFT_STATE_LEADER)
+		box_raft_lease_end();
 	/*
 	 * Once the node becomes read-only due to new term, it should stop
 	 * finalizing existing synchronous transactions so that it doesn't
@@ -293,6 +304,35 @@ box_raft_fence(void)
 	raft_resign(raft);
 }
 
+void
+box_raft_lease_start(uint64_t term)
+{
+	box_raft_lease_term = term;
+}
+
+void
+box_raft_lease_end(void)
+{
+	box_raft_lease_term = 0;
+}
+
+bool
+box_raft_has_lease(void)
+{
+	struct raft *raft = box_raft();
+	return box_raft_lease_term != 0 &&
+	       box_raft_lease_term == raft->term &&
+	       raft->volatile_term == raft->term &&
+	       !latch_is_locked(&txn_limbo.promote_latch) &&
+	       raft->is_enabled && raft->state == RAFT_STATE_LEADER &&
+	       box_election_fencing_mode == ELECTION_FENCING_MODE_STRICT &&
+	       !box_raft_election_fencing_paused &&
+	       replicaset_has_healthy_quorum() &&
+	       txn_limbo.owner_id == instance_id &&
+	       txn_limbo.promote_greatest_term == raft->term &&
+	       txn_limbo.frozen_reasons == 0;
+}
+
 /**
  * Configure the raft node according to whether it has a quorum of connected
  * peers or not. It can't start elections, when it doesn't.
@@ -106,6 +106,35 @@ box_raft(void)
 void
 box_raft_update_election_quorum(void);
 
+/**
+ * Check if this instance holds a leader lease, i.e. no other instance can
+ * commit synchronous transactions while the lease holds. This is the case
+ * when the instance is the Raft leader owning the limbo in the current term
+ * and strict fencing is enabled: the leader resigns on losing the quorum
+ * earlier than the followers may elect a new one.
+ *
+ * The lease is obtained when the instance writes PROMOTE and ends on any
+ * term bump or limbo ownership change, e.g. when a PROMOTE written by
+ * another instance on manual box.ctl.promote() is received. It isn't held
+ * while a PROMOTE or DEMOTE is being processed by the limbo either.
+ */
+bool
+box_raft_has_lease(void);
+
+/**
+ * Start the leader lease in the given term. Called when the limbo
+ * processes a PROMOTE written by this instance.
+ */
+void
+box_raft_lease_start(uint64_t term);
+
+/**
+ * End the leader lease. Called on limbo ownership change and on term
+ * bump.
+ */
+void
+box_raft_lease_end(void);
+
 /** Set the node's election_mode to @a mode. */
 void
 box_raft_cfg_election_mode(enum election_mode mode);
@@ -71,7 +71,7 @@ read_view_opts_create(struct read_view_opts *opts)
 	opts->disable_decompression = false;
 }
 
-static void
+void
 space_read_view_delete(struct space_read_view *space_rv)
 {
 	assert(space_rv->format == NULL);
@@ -199,6 +199,14 @@ read_view_open(struct read_view *rv, const struct read_view_opts *opts);
 void
 read_view_close(struct read_view *rv);
 
+/**
+ * Deletes a space read view. The space read view must be unlinked from
+ * the database read view with rlist_del() before it can be passed to this
+ * function. Must be called from the tx thread.
+ */
+void
+space_read_view_delete(struct space_read_view *space_rv);
+
 /**
  * Looks up an open read view by id.
  *
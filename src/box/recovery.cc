@@ -42,6 +42,7 @@
 #include "session.h"
 #include "coio_file.h"
 #include "error.h"
+#include "errinj.h"
 #include "iproto_constants.h"
 
 /*
@@ -197,6 +198,12 @@ recovery_open_log(struct recovery *r, const struct vclock *vclock)
 		goto gap_error;
 	}
 out:
+	/*
+	 * Skip the part of the file that has already been applied
+	 * without decoding it.
+	 */
+	if (vclock_compare(&r->vclock, &r->cursor.meta.vclock) > 0)
+		xlog_cursor_seek_index(&r->cursor, &r->vclock);
 	/*
 	 * We must promote recovery clock even if we don't recover
 	 * anything from the next WAL. Otherwise if the last WAL
@@ -379,6 +386,10 @@ recovery_finalize(struct recovery *r)
  * Any change to the WAL dir itself or a change in the XLOG
  * file triggers a wakeup. The WAL dir path is set in the
  * constructor. XLOG file path is set with set_log_path().
+ *
+ * On Linux the events are delivered by inotify. If it isn't
+ * available (or the file system is remote), libev falls back
+ * on polling the paths with the given interval.
  */
 class WalSubscription {
 public:
@@ -388,9 +399,12 @@ class WalSubscription {
 	struct ev_stat file_stat;
 	char dir_path[PATH_MAX];
 	char file_path[PATH_MAX];
+	/** Interval of polling the paths if inotify isn't used. */
+	ev_tstamp interval;
 
 	static void dir_stat_cb(struct ev_loop *, struct ev_stat *stat, int)
 	{
+		ERROR_INJECT(ERRINJ_HOT_STANDBY_SKIP_DIR_EVENT, return);
 		((WalSubscription *)stat->data)->wakeup(WAL_EVENT_ROTATE);
 	}
 
@@ -405,10 +419,11 @@ class WalSubscription {
 		fiber_wakeup(f);
 	}
 
-	WalSubscription(const char *wal_dir)
+	WalSubscription(const char *wal_dir, ev_tstamp interval)
 	{
 		f = fiber();
 		events = 0;
+		this->interval = interval;
 		if ((size_t)snprintf(dir_path, sizeof(dir_path), "%s", wal_dir) >=
 				sizeof(dir_path)) {
 
@@ -420,7 +435,7 @@ class WalSubscription {
 		dir_stat.data = this;
 		file_stat.data = this;
 
-		ev_stat_set(&dir_stat, dir_path, 0.0);
+		ev_stat_set(&dir_stat, dir_path, interval);
 		ev_stat_start(loop(), &dir_stat);
 	}
 
@@ -452,7 +467,7 @@ class WalSubscription {
 
 			panic("path too long: %s", path);
 		}
-		ev_stat_set(&file_stat, file_path, 0.0);
+		ev_stat_set(&file_stat, file_path, interval);
 		ev_stat_start(loop(), &file_stat);
 	}
 };
@@ -467,7 +482,8 @@ hot_standby_f(va_list ap)
 	ev_tstamp wal_dir_rescan_delay = va_arg(ap, ev_tstamp);
 	fiber_set_user(fiber(), &admin_credentials);
 
-	WalSubscription subscription(r->wal_dir.dirname);
+	WalSubscription subscription(r->wal_dir.dirname,
+				     wal_dir_rescan_delay);
 
 	while (! fiber_is_cancelled()) {
 		FiberGCChecker gc_check;
@@ -509,8 +525,19 @@ hot_standby_f(va_list ap)
 			timed_out = fiber_yield_deadline(deadline);
 		}
 
-		scan_dir = timed_out ||
-			(subscription.events & WAL_EVENT_ROTATE) != 0;
+		/*
+		 * While a WAL file is being read it's enough to rescan
+		 * the directory on rotation: the file is read
+		 * incrementally, from the last cursor position. If
+		 * there's no open file or its EOF marker has been read,
+		 * a new file may appear at any moment, so rescan the
+		 * directory on timeout too in case the directory
+		 * watcher missed the event.
+		 */
+		scan_dir = (subscription.events & WAL_EVENT_ROTATE) != 0 ||
+			   (timed_out &&
+			    (!xlog_cursor_is_open(&r->cursor) ||
+			     xlog_cursor_is_eof(&r->cursor)));
 
 		subscription.events = 0;
 	}
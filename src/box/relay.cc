@@ -59,6 +59,14 @@
 #include "raft.h"
 
 #include <stdlib.h>
+#include <sys/socket.h>
+
+enum {
+	/** Min size of the buffer used for accumulating rows. */
+	RELAY_SEND_BUF_SIZE_MIN = 128 * 1024,
+	/** Max size of the buffer used for accumulating rows. */
+	RELAY_SEND_BUF_SIZE_MAX = 1024 * 1024,
+};
 
 /**
  * Cbus message to send status updates from relay to tx thread.
@@ -121,6 +129,16 @@ struct relay {
 	struct applier_heartbeat last_recv_ack;
 	/** Recovery instance to read xlog from the disk */
 	struct recovery *r;
+	/**
+	 * Set if the relay reads rows from the buffer of rows recently
+	 * written to WAL rather than from xlog files, see
+	 * wal_row_buf_read().
+	 */
+	bool is_reading_row_buf;
+	/** Position of the relay in the WAL row buffer. */
+	uint64_t row_buf_pos;
+	/** Buffer for rows read from the WAL row buffer. */
+	struct ibuf row_buf;
 	/** Xstream argument to recovery */
 	struct xstream stream;
 	/** A region used to save rows when collecting transactions. */
@@ -155,6 +173,26 @@ struct relay {
 	 * is passed by the replica on subscribe.
 	 */
 	uint32_t id_filter;
+	/**
+	 * Buffer used for accumulating rows sent to the replica so that
+	 * they are written to the socket in big chunks rather than one by
+	 * one. The buffer is flushed when it's full, before the relay
+	 * yields and after processing a WAL event. Allocated with malloc,
+	 * because the rows may be sent from a thread other than the relay
+	 * thread.
+	 */
+	char *send_buf;
+	/**
+	 * Size of the send buffer. Matches the socket send buffer size
+	 * so that a flush fits in the socket in one write.
+	 */
+	size_t send_buf_size;
+	/** Size of the data stored in the send buffer. */
+	size_t send_buf_used;
+	/** Number of bytes written to the socket since relay start. */
+	uint64_t sent_bytes;
+	/** Number of socket writes since relay start. */
+	uint64_t write_count;
 	/**
 	 * Local vclock at the moment of subscribe, used to check
 	 * dataset on the other side and send missing data rows if any.
@@ -265,11 +303,26 @@ relay_txn_lag(const struct relay *relay)
 	return relay->tx.txn_lag;
 }
 
+uint64_t
+relay_sent_bytes(const struct relay *relay)
+{
+	return relay->sent_bytes;
+}
+
+uint64_t
+relay_write_count(const struct relay *relay)
+{
+	return relay->write_count;
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet);
 static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row);
 
+static void
+relay_flush(struct relay *relay);
+
 /** Process a single row from the WAL stream. */
 static void
 relay_process_row(struct xstream *stream, struct xrow_header *row);
@@ -314,7 +367,8 @@ relay_new(struct replica *replica)
 static void
 relay_yield(struct xstream *stream)
 {
-	(void) stream;
+	struct relay *relay = container_of(stream, struct relay, stream);
+	relay_flush(relay);
 	fiber_sleep(0);
 }
 
@@ -327,9 +381,25 @@ relay_yield_and_send_heartbeat(struct xstream *stream)
 {
 	struct relay *relay = container_of(stream, struct relay, stream);
 	relay_send_heartbeat_on_timeout(relay);
+	relay_flush(relay);
 	fiber_sleep(0);
 }
 
+/**
+ * Returns the size of the relay send buffer for the given connection:
+ * the size of the socket send buffer clamped to sane limits.
+ */
+static size_t
+relay_send_buf_size(struct iostream *io)
+{
+	int size = 0;
+	socklen_t len = sizeof(size);
+	if (getsockopt(io->fd, SOL_SOCKET, SO_SNDBUF, &size, &len) != 0)
+		return RELAY_SEND_BUF_SIZE_MIN;
+	return MIN(MAX((size_t)size, (size_t)RELAY_SEND_BUF_SIZE_MIN),
+		   (size_t)RELAY_SEND_BUF_SIZE_MAX);
+}
+
 static void
 relay_start(struct relay *relay, struct iostream *io, uint64_t sync,
 	     void (*stream_write)(struct xstream *, struct xrow_header *),
@@ -345,6 +415,15 @@ relay_start(struct relay *relay, struct iostream *io, uint64_t sync,
 	relay->io = io;
 	relay->sync = sync;
 	relay->state = RELAY_FOLLOW;
+	size_t send_buf_size = relay_send_buf_size(io);
+	if (relay->send_buf_size != send_buf_size) {
+		free(relay->send_buf);
+		relay->send_buf = NULL;
+		relay->send_buf_size = send_buf_size;
+	}
+	relay->send_buf_used = 0;
+	relay->sent_bytes = 0;
+	relay->write_count = 0;
 	relay->sent_raft_term = sent_raft_term;
 	relay->need_new_vclock_sync = false;
 	relay->last_row_time = ev_monotonic_now(loop());
@@ -420,6 +499,7 @@ relay_delete(struct relay *relay)
 		relay_stop(relay);
 	fiber_cond_destroy(&relay->reader_cond);
 	diag_destroy(&relay->diag);
+	free(relay->send_buf);
 	TRASH(relay);
 	free(relay);
 }
@@ -523,6 +603,7 @@ relay_initial_join(struct iostream *io, uint64_t sync, struct vclock *vclock,
 
 	/* Send read view to the replica. */
 	engine_join_xc(&ctx, &relay->stream);
+	relay_flush(relay);
 }
 
 int
@@ -537,6 +618,7 @@ relay_final_join_f(va_list ap)
 	assert(relay->stream.write != NULL);
 	recover_remaining_wals(relay->r, &relay->stream,
 			       &relay->stop_vclock, true);
+	relay_flush(relay);
 	assert(vclock_compare(&relay->r->vclock, &relay->stop_vclock) == 0);
 	return 0;
 }
@@ -722,6 +804,59 @@ relay_set_error(struct relay *relay, struct error *e)
 		diag_set_error(&relay->diag, e);
 }
 
+enum {
+	/** Max size of rows read from the WAL row buffer at once. */
+	RELAY_ROW_BUF_READ_MAX = 256 * 1024,
+};
+
+/**
+ * Send rows following the relay vclock from the buffer of rows
+ * recently written to WAL. Returns false if the buffer doesn't
+ * have some of the rows so they must be read from xlog files.
+ */
+static bool
+relay_send_buffered_rows(struct relay *relay)
+{
+	struct recovery *r = relay->r;
+	struct ibuf *ibuf = &relay->row_buf;
+	while (true) {
+		ibuf_reset(ibuf);
+		ssize_t size = wal_row_buf_read(&r->vclock, &relay->row_buf_pos,
+						ibuf, RELAY_ROW_BUF_READ_MAX);
+		if (size < 0)
+			return false;
+		if (size == 0)
+			return true;
+		const char *data = ibuf->rpos;
+		const char *end = ibuf->wpos;
+		while (data < end) {
+			struct xrow_header row;
+			xrow_header_decode_xc(&row, &data, end, false);
+			/* Skip rows the replica already has. */
+			if (row.lsn <= vclock_get(&r->vclock, row.replica_id))
+				continue;
+			vclock_follow_xrow(&r->vclock, &row);
+			if (xstream_write(&relay->stream, &row) != 0)
+				diag_raise();
+		}
+	}
+}
+
+/**
+ * Recreate the recovery context at the current relay position to
+ * switch from reading the WAL row buffer back to xlog files.
+ */
+static void
+relay_restart_recovery(struct relay *relay)
+{
+	struct recovery *r = recovery_new(wal_dir(), false, &relay->r->vclock);
+	rlist_swap(&r->on_close_log, &relay->r->on_close_log);
+	recovery_delete(relay->r);
+	relay->r = r;
+	relay->row_buf_pos = UINT64_MAX;
+	relay->is_reading_row_buf = false;
+}
+
 static void
 relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 {
@@ -739,8 +874,31 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		return;
 	}
 	try {
-		recover_remaining_wals(relay->r, &relay->stream, NULL,
-				       (events & WAL_EVENT_ROTATE) != 0);
+		bool is_rotated = (events & WAL_EVENT_ROTATE) != 0;
+		if (relay_send_buffered_rows(relay)) {
+			if (!relay->is_reading_row_buf) {
+				/* Don't keep the current xlog open. */
+				if (xlog_cursor_is_open(&relay->r->cursor))
+					xlog_cursor_close(&relay->r->cursor,
+							  false);
+				relay->is_reading_row_buf = true;
+			}
+			/*
+			 * The relay doesn't see xlog files being closed
+			 * while reading the buffer so let the garbage
+			 * collector know on rotation.
+			 */
+			if (is_rotated)
+				trigger_run_xc(&relay->r->on_close_log, NULL);
+		} else {
+			if (relay->is_reading_row_buf) {
+				relay_restart_recovery(relay);
+				is_rotated = true;
+			}
+			recover_remaining_wals(relay->r, &relay->stream, NULL,
+					       is_rotated);
+		}
+		relay_flush(relay);
 	} catch (Exception *e) {
 		relay_set_error(relay, e);
 		fiber_cancel(fiber());
@@ -993,6 +1151,11 @@ relay_subscribe_f(va_list ap)
 			     tt_sprintf("relay_wal_%p", relay),
 			     fiber_schedule_cb, fiber());
 
+	ibuf_create(&relay->row_buf, &cord()->slabc, RELAY_ROW_BUF_READ_MAX);
+	relay->row_buf_pos = UINT64_MAX;
+	relay->is_reading_row_buf = false;
+	wal_row_buf_enable();
+
 	/*
 	 * Setup garbage collection trigger.
 	 * Not needed for anonymous replicas, since they
@@ -1072,6 +1235,7 @@ relay_subscribe_f(va_list ap)
 	cbus_endpoint_destroy(&relay->wal_endpoint, cbus_process);
 	cbus_endpoint_destroy(&relay->tx_endpoint, cbus_process);
 
+	ibuf_destroy(&relay->row_buf);
 	relay_exit(relay);
 
 	/*
@@ -1145,6 +1309,60 @@ relay_subscribe(struct replica *replica, struct iostream *io, uint64_t sync,
 		diag_raise();
 }
 
+/** Write the rows accumulated in the send buffer to the socket. */
+static void
+relay_flush(struct relay *relay)
+{
+	if (relay->send_buf_used == 0)
+		return;
+	size_t size = relay->send_buf_used;
+	relay->send_buf_used = 0;
+	relay->sent_bytes += size;
+	relay->write_count++;
+	if (coio_write_timeout(relay->io, relay->send_buf, size,
+			       TIMEOUT_INFINITY) < 0)
+		diag_raise();
+}
+
+/**
+ * Append a row to the send buffer. The buffer is flushed if the row
+ * doesn't fit in it. A row too big to be buffered is written to the
+ * socket directly.
+ */
+static void
+relay_write_row(struct relay *relay, struct xrow_header *row)
+{
+	RegionGuard region_guard(&fiber()->gc);
+	int iovcnt;
+	struct iovec iov[XROW_IOVMAX];
+	xrow_to_iovec(row, iov, &iovcnt);
+	size_t len = 0;
+	for (int i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+	if (relay->send_buf_used + len > relay->send_buf_size)
+		relay_flush(relay);
+	if (len > relay->send_buf_size) {
+		/* Too big to be buffered. */
+		relay->sent_bytes += len;
+		relay->write_count++;
+		if (coio_writev(relay->io, iov, iovcnt, 0) < 0)
+			diag_raise();
+	} else {
+		if (relay->send_buf == NULL)
+			relay->send_buf = (char *)xmalloc(relay->send_buf_size);
+		char *pos = relay->send_buf + relay->send_buf_used;
+		for (int i = 0; i < iovcnt; i++) {
+			memcpy(pos, iov[i].iov_base, iov[i].iov_len);
+			pos += iov[i].iov_len;
+		}
+		relay->send_buf_used += len;
+	}
+}
+
+/**
+ * Send a row to the replica right away, together with the rows
+ * accumulated in the send buffer.
+ */
 static void
 relay_send(struct relay *relay, struct xrow_header *packet)
 {
@@ -1152,7 +1370,8 @@ relay_send(struct relay *relay, struct xrow_header *packet)
 
 	packet->sync = relay->sync;
 	relay->last_row_time = ev_monotonic_now(loop());
-	coio_write_xrow(relay->io, packet);
+	relay_write_row(relay, packet);
+	relay_flush(relay);
 
 	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
 	if (inj != NULL && inj->dparam > 0)
@@ -1167,8 +1386,18 @@ relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row)
 	 * Ignore replica local requests as we don't need to promote
 	 * vclock while sending a snapshot.
 	 */
-	if (row->group_id != GROUP_LOCAL)
-		relay_send(relay, row);
+	if (row->group_id == GROUP_LOCAL)
+		return;
+
+	ERROR_INJECT_YIELD(ERRINJ_RELAY_SEND_DELAY);
+
+	row->sync = relay->sync;
+	relay->last_row_time = ev_monotonic_now(loop());
+	relay_write_row(relay, row);
+
+	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
+	if (inj != NULL && inj->dparam > 0)
+		fiber_sleep(inj->dparam);
 }
 
 /**
@@ -1324,7 +1553,11 @@ relay_save_row(struct relay *relay, struct xrow_header *packet)
 	rlist_add_tail_entry(&relay->current_tx, tx_row, in_tx);
 }
 
-/** Send a full transaction to the replica. */
+/**
+ * Send a full transaction to the replica. Rows are accumulated in the
+ * send buffer so as not to make a syscall and send a network packet per
+ * each row or transaction.
+ */
 static void
 relay_send_tx(struct relay *relay)
 {
@@ -1341,7 +1574,20 @@ relay_send_tx(struct relay *relay)
 			say_warn("injected broken lsn: %lld",
 				 (long long) packet->lsn);
 		}
-		relay_send(relay, packet);
+		inj = errinj(ERRINJ_RELAY_SEND_DELAY, ERRINJ_BOOL);
+		if (inj != NULL && inj->bparam)
+			relay_flush(relay);
+		ERROR_INJECT_YIELD(ERRINJ_RELAY_SEND_DELAY);
+
+		packet->sync = relay->sync;
+		relay_write_row(relay, packet);
+		relay->last_row_time = ev_monotonic_now(loop());
+
+		inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
+		if (inj != NULL && inj->dparam > 0) {
+			relay_flush(relay);
+			fiber_sleep(inj->dparam);
+		}
 	}
 
 	rlist_create(&relay->current_tx);
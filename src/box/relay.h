@@ -100,6 +100,21 @@ relay_last_row_time(const struct relay *relay);
 double
 relay_txn_lag(const struct relay *relay);
 
+/**
+ * Returns the number of bytes the relay has written to the replica
+ * socket since it was started.
+ */
+uint64_t
+relay_sent_bytes(const struct relay *relay);
+
+/**
+ * Returns the number of writes the relay has made to the replica
+ * socket since it was started. Rows are sent in batches, so it's
+ * usually much less than the number of rows sent.
+ */
+uint64_t
+relay_write_count(const struct relay *relay);
+
 /**
  * Makes the relay issue a new vclock sync request and returns the sync to wait
  * for.
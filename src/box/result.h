@@ -9,6 +9,7 @@
 
 #include "space.h"
 #include "space_upgrade.h"
+#include "tuple.h"
 #include "trivia/util.h"
 
 #if defined(__cplusplus)
@@ -60,6 +61,36 @@ result_process_perform(struct result_processor *p, int *rc,
 	space_upgrade_unref(p->upgrade);
 }
 
+/**
+ * Same as result_process_perform(), but processes an array of referenced
+ * tuples, as returned by index_get_batch(). The processed tuples are
+ * referenced as well. On failure, all the tuples are unreferenced.
+ */
+static inline void
+result_process_perform_batch(struct result_processor *p, int *rc,
+			     struct tuple **results, uint32_t count)
+{
+	if (likely(p->upgrade == NULL))
+		return;
+	for (uint32_t i = 0; *rc == 0 && i < count; i++) {
+		struct tuple *tuple = results[i];
+		if (tuple == NULL)
+			continue;
+		results[i] = space_upgrade_apply(p->upgrade, tuple);
+		tuple_unref(tuple);
+		if (results[i] == NULL) {
+			for (uint32_t j = 0; j < count; j++) {
+				if (j != i && results[j] != NULL)
+					tuple_unref(results[j]);
+			}
+			*rc = -1;
+		} else {
+			tuple_ref(results[i]);
+		}
+	}
+	space_upgrade_unref(p->upgrade);
+}
+
 /**
  * A shortcut for
  *
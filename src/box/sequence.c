@@ -61,6 +61,19 @@ struct sequence_data {
 	uint32_t id;
 	/** Sequence value. */
 	int64_t value;
+	/**
+	 * Last value reserved by sequence_reserve_commit() or the
+	 * sequence value if no values are reserved. The reserved values
+	 * aren't persisted when generated so this value is stored in
+	 * snapshots.
+	 */
+	int64_t reserved;
+	/**
+	 * Last value written to _sequence_data. A reservation started
+	 * by sequence_reserve() takes effect only if no other value is
+	 * written before it's committed.
+	 */
+	int64_t written;
 };
 
 static inline bool
@@ -110,6 +123,13 @@ sequence_hash(uint32_t id)
 	return PMurHash32(SEQUENCE_HASH_SEED, &id, sizeof(id));
 }
 
+/** Return true if value a comes after value b in the sequence. */
+static inline bool
+sequence_is_after(const struct sequence_def *def, int64_t a, int64_t b)
+{
+	return def->step > 0 ? a > b : a < b;
+}
+
 void
 sequence_init(void)
 {
@@ -163,6 +183,8 @@ sequence_set(struct sequence *seq, int64_t value)
 	struct sequence_data new_data, old_data;
 	new_data.id = key;
 	new_data.value = value;
+	new_data.reserved = value;
+	new_data.written = value;
 	if (light_sequence_replace(&sequence_data_index, hash,
 				   new_data, &old_data) != light_sequence_end)
 		return 0;
@@ -181,10 +203,14 @@ sequence_update(struct sequence *seq, int64_t value)
 	struct sequence_data new_data, data;
 	new_data.id = key;
 	new_data.value = value;
+	new_data.reserved = value;
+	new_data.written = value;
 	if (pos != light_sequence_end) {
 		data = light_sequence_get(&sequence_data_index, pos);
-		if ((seq->def->step > 0 && value > data.value) ||
-		    (seq->def->step < 0 && value < data.value)) {
+		new_data.written = data.written;
+		if (sequence_is_after(seq->def, value, data.value)) {
+			if (!sequence_is_after(seq->def, value, data.reserved))
+				new_data.reserved = data.reserved;
 			if (light_sequence_replace(&sequence_data_index, hash,
 					new_data, &data) == light_sequence_end)
 				unreachable();
@@ -209,6 +235,8 @@ sequence_next(struct sequence *seq, int64_t *result)
 	if (pos == light_sequence_end) {
 		new_data.id = key;
 		new_data.value = def->start;
+		new_data.reserved = def->start;
+		new_data.written = def->start;
 		if (light_sequence_insert(&sequence_data_index, hash,
 					  new_data) == light_sequence_end)
 			return -1;
@@ -243,6 +271,13 @@ sequence_next(struct sequence *seq, int64_t *result)
 	assert(value >= def->min && value <= def->max);
 	new_data.id = key;
 	new_data.value = value;
+	/* Keep the reserved values unless the sequence has wrapped. */
+	if (sequence_is_after(def, value, old_data.value) &&
+	    !sequence_is_after(def, value, old_data.reserved))
+		new_data.reserved = old_data.reserved;
+	else
+		new_data.reserved = value;
+	new_data.written = old_data.written;
 	if (light_sequence_replace(&sequence_data_index, hash,
 				   new_data, &old_data) == light_sequence_end)
 		unreachable();
@@ -257,6 +292,72 @@ sequence_next(struct sequence *seq, int64_t *result)
 	goto done;
 }
 
+bool
+sequence_next_is_reserved(struct sequence *seq, int64_t value,
+			  int64_t *reserved)
+{
+	struct sequence_def *def = seq->def;
+	uint32_t key = def->id;
+	uint32_t hash = sequence_hash(key);
+	uint32_t pos = light_sequence_find_key(&sequence_data_index, hash, key);
+	assert(pos != light_sequence_end);
+	struct sequence_data data = light_sequence_get(&sequence_data_index,
+						       pos);
+	assert(data.value == value);
+	if (data.reserved != value)
+		return true;
+	/* Reserve the cache values following this one. */
+	int64_t limit = def->step > 0 ? def->max : def->min;
+	int64_t end = value;
+	if (def->cache > 0 &&
+	    (__builtin_mul_overflow(def->step, def->cache, &end) ||
+	     __builtin_add_overflow(value, end, &end) ||
+	     sequence_is_after(def, end, limit)))
+		end = limit;
+	*reserved = end;
+	return false;
+}
+
+void
+sequence_reserve(struct sequence *seq, int64_t value, int64_t reserved)
+{
+	uint32_t key = seq->def->id;
+	uint32_t hash = sequence_hash(key);
+	struct sequence_data new_data, old_data;
+	new_data.id = key;
+	new_data.value = value;
+	new_data.reserved = value;
+	new_data.written = reserved;
+	if (light_sequence_replace(&sequence_data_index, hash,
+				   new_data, &old_data) == light_sequence_end)
+		unreachable();
+}
+
+void
+sequence_reserve_commit(struct sequence *seq, int64_t reserved)
+{
+	uint32_t key = seq->def->id;
+	uint32_t hash = sequence_hash(key);
+	uint32_t pos = light_sequence_find_key(&sequence_data_index, hash, key);
+	if (pos == light_sequence_end)
+		return;
+	struct sequence_data new_data, old_data;
+	old_data = light_sequence_get(&sequence_data_index, pos);
+	/*
+	 * If another value was written after the reservation, the
+	 * reservation isn't the last persisted value.
+	 */
+	if (old_data.written != reserved ||
+	    sequence_is_after(seq->def, old_data.value, reserved) ||
+	    !sequence_is_after(seq->def, reserved, old_data.reserved))
+		return;
+	new_data = old_data;
+	new_data.reserved = reserved;
+	if (light_sequence_replace(&sequence_data_index, hash,
+				   new_data, &old_data) == light_sequence_end)
+		unreachable();
+}
+
 int
 access_check_sequence(struct sequence *seq)
 {
@@ -341,9 +442,9 @@ sequence_data_iterator_next_raw(struct index_read_view_iterator *iterator,
 	char *buf_end = buf;
 	buf_end = mp_encode_array(buf_end, 2);
 	buf_end = mp_encode_uint(buf_end, sd->id);
-	buf_end = (sd->value >= 0 ?
-		   mp_encode_uint(buf_end, sd->value) :
-		   mp_encode_int(buf_end, sd->value));
+	buf_end = (sd->reserved >= 0 ?
+		   mp_encode_uint(buf_end, sd->reserved) :
+		   mp_encode_int(buf_end, sd->reserved));
 	assert(buf_end <= buf + buf_size);
 	result->data = buf;
 	result->size = buf_end - buf;
@@ -64,7 +64,11 @@ struct sequence_def {
 	int64_t max;
 	/** Initial sequence value. */
 	int64_t start;
-	/** Number of values to preallocate. Not implemented yet. */
+	/**
+	 * Number of values generated by box_sequence_next() after
+	 * persisting a sequence value before the next one has to be
+	 * persisted. Reserved but unused values are skipped on recovery.
+	 */
 	int64_t cache;
 	/**
 	 * If this flag is set, the sequence will wrap
@@ -152,6 +156,34 @@ sequence_update(struct sequence *seq, int64_t value);
 int
 sequence_next(struct sequence *seq, int64_t *result);
 
+/**
+ * Check if a value just returned by sequence_next() was reserved by
+ * sequence_reserve_commit() so it doesn't need to be persisted.
+ * Otherwise, set @reserved to the value that should be persisted to
+ * reserve the next cache values of the sequence.
+ */
+bool
+sequence_next_is_reserved(struct sequence *seq, int64_t value,
+			  int64_t *reserved);
+
+/**
+ * Set the sequence value after @reserved was written to
+ * _sequence_data. The reserved values aren't generated without
+ * persisting them until sequence_reserve_commit() is called.
+ * The sequence must be started.
+ */
+void
+sequence_reserve(struct sequence *seq, int64_t value, int64_t reserved);
+
+/**
+ * Reserve the values up to @reserved after the value written by
+ * sequence_reserve() is persisted. Does nothing if another value
+ * was written to _sequence_data after it. The reserved value is
+ * stored in snapshots instead of the sequence value.
+ */
+void
+sequence_reserve_commit(struct sequence *seq, int64_t reserved);
+
 /**
  * Check whether or not the current user can be granted
  * access to the sequence.
@@ -535,6 +535,7 @@ space_create(struct space *space, struct engine *engine,
 	}
 	space->constraint_ids = mh_strnptr_new();
 	rlist_create(&space->memtx_stories);
+	rlist_create(&space->in_story_spaces);
 	rlist_create(&space->alter_stmts);
 	return 0;
 
@@ -1244,11 +1245,16 @@ space_execute_dml(struct space *space, struct txn *txn,
 		if (space->vtab->execute_replace(space, txn,
 						 request, result) != 0)
 			return -1;
+		if (request->type == IPROTO_INSERT)
+			space->dml_count.insert++;
+		else
+			space->dml_count.replace++;
 		break;
 	case IPROTO_UPDATE:
 		if (space->vtab->execute_update(space, txn,
 						request, result) != 0)
 			return -1;
+		space->dml_count.update++;
 		if (*result != NULL && request->index_id != 0) {
 			/*
 			 * XXX: this is going to break with sync replication
@@ -1265,6 +1271,7 @@ space_execute_dml(struct space *space, struct txn *txn,
 		if (space->vtab->execute_delete(space, txn,
 						request, result) != 0)
 			return -1;
+		space->dml_count.delete_++;
 		if (*result != NULL && request->index_id != 0) {
 			struct region *txn_region = tx_region_acquire(txn);
 			request_rebind_to_primary_key(request, space, *result,
@@ -1276,6 +1283,7 @@ space_execute_dml(struct space *space, struct txn *txn,
 		*result = NULL;
 		if (space->vtab->execute_upsert(space, txn, request) != 0)
 			return -1;
+		space->dml_count.upsert++;
 		break;
 	default:
 		*result = NULL;
@@ -1356,6 +1364,20 @@ generic_space_ephemeral_rowid_next(struct space *space, uint64_t *rowid)
 	return 0;
 }
 
+void
+generic_space_ephemeral_begin_build(struct space *space)
+{
+	(void)space;
+	unreachable();
+}
+
+void
+generic_space_ephemeral_end_build(struct space *space)
+{
+	(void)space;
+	unreachable();
+}
+
 void
 generic_init_system_space(struct space *space)
 {
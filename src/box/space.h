@@ -76,6 +76,16 @@ struct space_vtab {
 	int (*ephemeral_delete)(struct space *, const char *);
 
 	int (*ephemeral_rowid_next)(struct space *, uint64_t *);
+	/**
+	 * Switch an empty ephemeral space to the bulk build mode:
+	 * tuples inserted with ephemeral_replace() are collected
+	 * without maintaining the index order until ephemeral_end_build()
+	 * is called, which builds the index at once. Tuples inserted in
+	 * this mode must be unique.
+	 */
+	void (*ephemeral_begin_build)(struct space *);
+	/** Build the index of an ephemeral space in bulk build mode. */
+	void (*ephemeral_end_build)(struct space *);
 
 	void (*init_system_space)(struct space *);
 	/**
@@ -216,6 +226,14 @@ struct space {
 	char *sequence_path;
 	/** Enable/disable triggers. */
 	bool run_triggers;
+	/** Number of executed requests by type, see box.stat.space(). */
+	struct {
+		int64_t insert;
+		int64_t replace;
+		int64_t update;
+		int64_t delete_;
+		int64_t upsert;
+	} dml_count;
 	/**
 	 * When the flag is set, the space executes recovery triggers
 	 * (e.g. before_recovery_replace instead of before_replace).
@@ -257,6 +275,11 @@ struct space {
 	 * List of all tx stories in the space.
 	 */
 	struct rlist memtx_stories;
+	/**
+	 * Link in the list of spaces that have tx stories, which is
+	 * traversed by the memtx tx manager garbage collector.
+	 */
+	struct rlist in_story_spaces;
 	/**
 	 * List of currently running long (yielding) space alter operations
 	 * triggered by statements applied to this space (see alter_space_do),
@@ -594,6 +617,18 @@ space_ephemeral_delete(struct space *space, const char *key)
 	return space->vtab->ephemeral_delete(space, key);
 }
 
+static inline void
+space_ephemeral_begin_build(struct space *space)
+{
+	space->vtab->ephemeral_begin_build(space);
+}
+
+static inline void
+space_ephemeral_end_build(struct space *space)
+{
+	space->vtab->ephemeral_end_build(space);
+}
+
 /**
  * Generic implementation of space_vtab::swap_index
  * that simply swaps the two indexes in index maps.
@@ -775,6 +810,8 @@ size_t generic_space_bsize(struct space *);
 int generic_space_ephemeral_replace(struct space *, const char *, const char *);
 int generic_space_ephemeral_delete(struct space *, const char *);
 int generic_space_ephemeral_rowid_next(struct space *, uint64_t *);
+void generic_space_ephemeral_begin_build(struct space *);
+void generic_space_ephemeral_end_build(struct space *);
 void generic_init_system_space(struct space *);
 void generic_init_ephemeral_space(struct space *);
 int generic_space_check_index_def(struct space *, struct index_def *);
@@ -15,6 +15,8 @@ static struct mh_i32ptr_t *spaces;
 /** Name -> space dictionary. */
 static struct mh_strnptr_t *spaces_by_name;
 
+struct space *space_cache_dense[SPACE_CACHE_DENSE_ID_MAX];
+
 /**
  * Internal change counter. Grows faster, than public schema_version,
  * because we need to remember when to update pointers to already
@@ -52,6 +54,8 @@ space_cache_destroy(void)
 struct space *
 space_by_id(uint32_t id)
 {
+	if (id < SPACE_CACHE_DENSE_ID_MAX)
+		return space_cache_dense[id];
 	mh_int_t space = mh_i32ptr_find(spaces, id, NULL);
 	if (space == mh_end(spaces))
 		return NULL;
@@ -134,6 +138,8 @@ space_cache_replace(struct space *old_space, struct space *new_space)
 						NULL;
 		assert(old_space_by_id == old_space);
 		(void)old_space_by_id;
+		if (space_id(new_space) < SPACE_CACHE_DENSE_ID_MAX)
+			space_cache_dense[space_id(new_space)] = new_space;
 		/*
 		 * Insert @new_space into @spaces_by_name cache.
 		 */
@@ -170,6 +176,8 @@ space_cache_replace(struct space *old_space, struct space *new_space)
 		assert(old_space_by_id == old_space);
 		(void)old_space_by_id;
 		mh_i32ptr_del(spaces, k, NULL);
+		if (space_id(old_space) < SPACE_CACHE_DENSE_ID_MAX)
+			space_cache_dense[space_id(old_space)] = NULL;
 		/*
 		 * Delete @old_space from @spaces_by_name cache.
 		 */
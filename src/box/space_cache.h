@@ -19,6 +19,18 @@ extern "C" {
  */
 extern uint32_t space_cache_version;
 
+enum {
+	/**
+	 * Spaces with ids below this threshold are also stored in
+	 * a dense array so that looking them up is a single load.
+	 * It covers all system spaces and the first user spaces.
+	 */
+	SPACE_CACHE_DENSE_ID_MAX = 4096,
+};
+
+/** Space id -> space array for ids below SPACE_CACHE_DENSE_ID_MAX. */
+extern struct space *space_cache_dense[SPACE_CACHE_DENSE_ID_MAX];
+
 /**
  * Triggers fired after committing a change in space definition.
  * The space is passed to the trigger callback in the event
@@ -119,6 +131,13 @@ space_cache_find_next_unused_id(uint32_t cur_id);
 static inline struct space *
 space_cache_find(uint32_t id)
 {
+	if (likely(id < SPACE_CACHE_DENSE_ID_MAX)) {
+		struct space *space = space_cache_dense[id];
+		if (likely(space != NULL))
+			return space;
+		diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(id));
+		return NULL;
+	}
 	static uint32_t prev_space_cache_version;
 	static struct space *space;
 	if (prev_space_cache_version != space_cache_version)
@@ -112,6 +112,12 @@ struct space_opts {
 	 * which should speed up writes, but may also slow down reads.
 	 */
 	bool defer_deletes;
+	/**
+	 * Number of the field storing the time, in seconds since the
+	 * epoch, after which a tuple is deleted by the expiration
+	 * service, or UINT32_MAX if the space tuples never expire.
+	 */
+	uint32_t ttl_field;
 	/** SQL statement that produced this space. */
 	char *sql;
 	/** Array of constraints. Can be NULL if constraints_count == 0. */
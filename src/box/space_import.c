@@ -0,0 +1,387 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "space_import.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "box.h"
+#include "coio_file.h"
+#include "csv/csv.h"
+#include "decimal.h"
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "field_def.h"
+#include "mp_decimal.h"
+#include "msgpuck.h"
+#include "small/ibuf.h"
+#include "space.h"
+#include "space_cache.h"
+#include "trivia/util.h"
+#include "tt_static.h"
+#include "tuple_format.h"
+
+enum {
+	/** Size of a chunk of the file read at once. */
+	SPACE_IMPORT_CHUNK_SIZE = 1024 * 1024,
+	/** Max size of a MsgPack array header. */
+	SPACE_IMPORT_ARRAY_HEADER_SIZE = 5,
+	/** Max length of a field converted to a number. */
+	SPACE_IMPORT_NUMBER_LEN_MAX = 64,
+};
+
+void
+space_import_csv_opts_create(struct space_import_csv_opts *opts)
+{
+	opts->delimiter = ',';
+	opts->quote_char = '"';
+	opts->skip_header = false;
+	opts->batch_size = 1000;
+}
+
+/** State of an import passed to the CSV parser callbacks. */
+struct space_import {
+	/** Target space identifier. */
+	uint32_t space_id;
+	/** Import options. */
+	const struct space_import_csv_opts *opts;
+	/** Format of the space, looked up at the start of each row. */
+	struct tuple_format *format;
+	/** Number of the line being parsed, starting from 1. */
+	uint64_t line;
+	/** Number of fields of the current row. */
+	uint32_t field_count;
+	/** Whether the current row consists of one empty field. */
+	bool row_is_empty;
+	/** Fields of the current row after a reserved array header. */
+	struct ibuf row;
+	/** Tuples of the current batch after a reserved array header. */
+	struct ibuf batch;
+	/** Number of tuples in the current batch. */
+	uint32_t batch_count;
+	/** Number of inserted tuples. */
+	uint64_t count;
+	/** Set on error, stops processing of the rest of the file. */
+	int rc;
+};
+
+/** Set an import error for the current line. */
+static void
+space_import_error(struct space_import *import, const char *msg)
+{
+	diag_set(ClientError, ER_CSV_IMPORT,
+		 (unsigned long long)import->line, msg);
+	import->rc = -1;
+}
+
+/** Allocate @a size bytes in @a ibuf, set an error on failure. */
+static char *
+space_import_alloc(struct space_import *import, struct ibuf *ibuf,
+		   size_t size)
+{
+	char *data = (char *)ibuf_alloc(ibuf, size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, size, "ibuf_alloc", "data");
+		import->rc = -1;
+	}
+	return data;
+}
+
+/**
+ * Convert a field to an integer. Set @a is_neg if it's negative, in
+ * which case the value is stored in @a ival, otherwise in @a uval.
+ */
+static int
+space_import_parse_int(const char *str, bool *is_neg, int64_t *ival,
+		       uint64_t *uval)
+{
+	char *end;
+	errno = 0;
+	*is_neg = str[0] == '-';
+	if (*is_neg)
+		*ival = strtoll(str, &end, 10);
+	else
+		*uval = strtoull(str, &end, 10);
+	if (errno != 0 || end == str || *end != '\0')
+		return -1;
+	return 0;
+}
+
+/** Convert a field to a double. */
+static int
+space_import_parse_double(const char *str, double *value)
+{
+	char *end;
+	errno = 0;
+	*value = strtod(str, &end);
+	if (errno != 0 || end == str || *end != '\0')
+		return -1;
+	return 0;
+}
+
+/** Encode a field of the given type to the row buffer. */
+static int
+space_import_encode_field(struct space_import *import,
+			  enum field_type type, const char *field,
+			  size_t len)
+{
+	const char *str = NULL;
+	if (type != FIELD_TYPE_STRING && type != FIELD_TYPE_ANY &&
+	    type != FIELD_TYPE_SCALAR && type != FIELD_TYPE_VARBINARY) {
+		if (len > SPACE_IMPORT_NUMBER_LEN_MAX)
+			goto error;
+		str = tt_cstr(field, len);
+	}
+	char *data;
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_NUMBER: {
+		bool is_neg;
+		int64_t ival;
+		uint64_t uval;
+		if (space_import_parse_int(str, &is_neg, &ival, &uval) == 0) {
+			if (is_neg && type == FIELD_TYPE_UNSIGNED)
+				goto error;
+			size_t size = is_neg ? mp_sizeof_int(ival) :
+					       mp_sizeof_uint(uval);
+			data = space_import_alloc(import, &import->row, size);
+			if (data == NULL)
+				return -1;
+			if (is_neg)
+				mp_encode_int(data, ival);
+			else
+				mp_encode_uint(data, uval);
+			return 0;
+		}
+		if (type != FIELD_TYPE_NUMBER)
+			goto error;
+		FALLTHROUGH;
+	}
+	case FIELD_TYPE_DOUBLE: {
+		double value;
+		if (space_import_parse_double(str, &value) != 0)
+			goto error;
+		data = space_import_alloc(import, &import->row,
+					  mp_sizeof_double(value));
+		if (data == NULL)
+			return -1;
+		mp_encode_double(data, value);
+		return 0;
+	}
+	case FIELD_TYPE_DECIMAL: {
+		decimal_t dec;
+		if (decimal_from_string(&dec, str) == NULL)
+			goto error;
+		data = space_import_alloc(import, &import->row,
+					  mp_sizeof_decimal(&dec));
+		if (data == NULL)
+			return -1;
+		mp_encode_decimal(data, &dec);
+		return 0;
+	}
+	case FIELD_TYPE_BOOLEAN: {
+		bool value;
+		if (strcmp(str, "true") == 0)
+			value = true;
+		else if (strcmp(str, "false") == 0)
+			value = false;
+		else
+			goto error;
+		data = space_import_alloc(import, &import->row,
+					  mp_sizeof_bool(value));
+		if (data == NULL)
+			return -1;
+		mp_encode_bool(data, value);
+		return 0;
+	}
+	case FIELD_TYPE_VARBINARY:
+		data = space_import_alloc(import, &import->row,
+					  mp_sizeof_bin(len));
+		if (data == NULL)
+			return -1;
+		mp_encode_bin(data, field, len);
+		return 0;
+	default:
+		/* Type checks are left to the insertion. */
+		data = space_import_alloc(import, &import->row,
+					  mp_sizeof_str(len));
+		if (data == NULL)
+			return -1;
+		mp_encode_str(data, field, len);
+		return 0;
+	}
+error:
+	space_import_error(import, tt_sprintf("can't convert field %u "
+					      "'%.*s' to %s",
+					      import->field_count + 1,
+					      (int)MIN(len, 64), field,
+					      field_type_strs[type]));
+	return -1;
+}
+
+/** Insert the tuples of the current batch. */
+static int
+space_import_flush(struct space_import *import)
+{
+	if (import->batch_count == 0)
+		return 0;
+	char *begin = import->batch.rpos + SPACE_IMPORT_ARRAY_HEADER_SIZE -
+		      mp_sizeof_array(import->batch_count);
+	mp_encode_array(begin, import->batch_count);
+	if (box_insert_batch(import->space_id, begin,
+			     import->batch.wpos) != 0) {
+		import->rc = -1;
+		return -1;
+	}
+	import->count += import->batch_count;
+	import->batch_count = 0;
+	ibuf_reset(&import->batch);
+	return 0;
+}
+
+static void
+space_import_on_field(void *ctx, const char *field, const char *end)
+{
+	struct space_import *import = (struct space_import *)ctx;
+	if (import->rc != 0)
+		return;
+	size_t len = end - field;
+	if (import->field_count == 0) {
+		/* The space may be altered while a batch is inserted. */
+		struct space *space = space_cache_find(import->space_id);
+		if (space == NULL) {
+			import->rc = -1;
+			return;
+		}
+		import->format = space->format;
+		import->row_is_empty = len == 0;
+		ibuf_reset(&import->row);
+		if (space_import_alloc(import, &import->row,
+				       SPACE_IMPORT_ARRAY_HEADER_SIZE) == NULL)
+			return;
+	} else {
+		import->row_is_empty = false;
+	}
+	if (import->opts->skip_header && import->line == 1) {
+		import->field_count++;
+		return;
+	}
+	enum field_type type = FIELD_TYPE_ANY;
+	struct tuple_field *tuple_field =
+		tuple_format_field(import->format, import->field_count);
+	if (tuple_field != NULL) {
+		type = tuple_field->type;
+		if (len == 0 && tuple_field_is_nullable(tuple_field) &&
+		    type != FIELD_TYPE_STRING) {
+			char *data = space_import_alloc(import, &import->row,
+							mp_sizeof_nil());
+			if (data == NULL)
+				return;
+			mp_encode_nil(data);
+			import->field_count++;
+			return;
+		}
+	}
+	if (space_import_encode_field(import, type, field, len) != 0)
+		return;
+	import->field_count++;
+}
+
+static void
+space_import_on_row(void *ctx)
+{
+	struct space_import *import = (struct space_import *)ctx;
+	if (import->rc != 0)
+		return;
+	uint32_t field_count = import->field_count;
+	import->field_count = 0;
+	import->line++;
+	if ((import->opts->skip_header && import->line == 2) ||
+	    field_count == 0 || (field_count == 1 && import->row_is_empty))
+		return;
+	struct ibuf *row = &import->row;
+	char *begin = row->rpos + SPACE_IMPORT_ARRAY_HEADER_SIZE -
+		      mp_sizeof_array(field_count);
+	mp_encode_array(begin, field_count);
+	size_t size = row->wpos - begin;
+	if (import->batch_count == 0 &&
+	    space_import_alloc(import, &import->batch,
+			       SPACE_IMPORT_ARRAY_HEADER_SIZE) == NULL)
+		return;
+	char *data = space_import_alloc(import, &import->batch, size);
+	if (data == NULL)
+		return;
+	memcpy(data, begin, size);
+	if (++import->batch_count == import->opts->batch_size)
+		space_import_flush(import);
+}
+
+int
+space_import_csv(uint32_t space_id, const char *path,
+		 const struct space_import_csv_opts *opts, uint64_t *count)
+{
+	*count = 0;
+	int fd = coio_file_open(path, O_RDONLY, 0);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to open file '%s'", path);
+		return -1;
+	}
+	char *chunk = (char *)malloc(SPACE_IMPORT_CHUNK_SIZE);
+	if (chunk == NULL) {
+		diag_set(OutOfMemory, SPACE_IMPORT_CHUNK_SIZE, "malloc",
+			 "chunk");
+		coio_file_close(fd);
+		return -1;
+	}
+	struct space_import import;
+	memset(&import, 0, sizeof(import));
+	import.space_id = space_id;
+	import.opts = opts;
+	import.line = 1;
+	ibuf_create(&import.row, &cord()->slabc, 16 * 1024);
+	ibuf_create(&import.batch, &cord()->slabc, 16 * 1024);
+
+	struct csv csv;
+	csv_create(&csv);
+	csv_setopt(&csv, CSV_OPT_DELIMITER, opts->delimiter);
+	csv_setopt(&csv, CSV_OPT_QUOTE, opts->quote_char);
+	csv_setopt(&csv, CSV_OPT_EMIT_FIELD, space_import_on_field);
+	csv_setopt(&csv, CSV_OPT_EMIT_ROW, space_import_on_row);
+	csv_setopt(&csv, CSV_OPT_EMIT_CTX, &import);
+	while (import.rc == 0) {
+		ssize_t n = coio_read(fd, chunk, SPACE_IMPORT_CHUNK_SIZE);
+		if (n < 0) {
+			diag_set(SystemError, "failed to read file '%s'",
+				 path);
+			import.rc = -1;
+			break;
+		}
+		if (n == 0) {
+			csv_finish_parsing(&csv);
+			break;
+		}
+		csv_parse_chunk(&csv, chunk, chunk + n);
+		if (csv_get_error_status(&csv) == CSV_ER_MEMORY_ERROR) {
+			diag_set(OutOfMemory, 0, "realloc", "csv buffer");
+			import.rc = -1;
+		}
+	}
+	if (import.rc == 0 && csv_get_error_status(&csv) != CSV_ER_OK)
+		space_import_error(&import, "unterminated quoted field");
+	if (import.rc == 0)
+		space_import_flush(&import);
+	csv_destroy(&csv);
+	ibuf_destroy(&import.batch);
+	ibuf_destroy(&import.row);
+	free(chunk);
+	coio_file_close(fd);
+	*count = import.count;
+	return import.rc;
+}
@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/** Options of space_import_csv(). */
+struct space_import_csv_opts {
+	/** Field delimiter. */
+	char delimiter;
+	/** Quote character. */
+	char quote_char;
+	/** Skip the first line of the file. */
+	bool skip_header;
+	/** Number of rows inserted in one transaction. */
+	uint32_t batch_size;
+};
+
+/** Initialize import options with default values. */
+void
+space_import_csv_opts_create(struct space_import_csv_opts *opts);
+
+/**
+ * Import a CSV file into a space.
+ *
+ * Each line of the file is inserted into the space as a tuple.
+ * Fields are converted from strings according to the space format:
+ * fields of the unsigned, integer, number, double, decimal and
+ * boolean types are converted to the respective values, an empty
+ * field of a nullable field is converted to nil, other fields are
+ * inserted as strings. Empty lines are skipped.
+ *
+ * The rows are inserted in batches of opts->batch_size tuples, one
+ * transaction per batch, so on error the batches inserted before
+ * the failed one stay in the space. If called in a transaction, all
+ * rows are inserted in it.
+ *
+ * The number of inserted rows is returned in @a count.
+ */
+int
+space_import_csv(uint32_t space_id, const char *path,
+		 const struct space_import_csv_opts *opts, uint64_t *count);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
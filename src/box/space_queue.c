@@ -0,0 +1,628 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "space_queue.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "assoc.h"
+#include "box.h"
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "fiber_cond.h"
+#include "index.h"
+#include "key_def.h"
+#include "memtx_engine.h"
+#include "session.h"
+#include "space.h"
+#include "space_cache.h"
+#include "trigger.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "txn.h"
+
+#define BPS_TREE_NAME space_queue_tree
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE MEMTX_EXTENT_SIZE
+#define BPS_TREE_COMPARE(a, b, cmp_def) \
+	tuple_compare(a, HINT_NONE, b, HINT_NONE, cmp_def)
+#define BPS_TREE_COMPARE_KEY(a, b, cmp_def) \
+	tuple_compare(a, HINT_NONE, b, HINT_NONE, cmp_def)
+#define BPS_TREE_IS_IDENTICAL(a, b) ((a) == (b))
+#define BPS_TREE_NO_DEBUG 1
+#define bps_tree_elem_t struct tuple *
+#define bps_tree_key_t struct tuple *
+#define bps_tree_arg_t struct key_def *
+
+#include "salad/bps_tree.h"
+
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_NO_DEBUG
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+/**
+ * Queue state of a space. It's owned by a trigger installed on the
+ * space on_replace list, which is moved to the new space object on
+ * alter and destroyed along with the space on drop.
+ *
+ * A tuple of the space is either ready or taken. The ready tuples
+ * are kept in a tree ordered by the primary key, so taking a tuple
+ * doesn't need to skip the taken ones.
+ */
+struct space_queue {
+	/** Trigger tracking the changes of the space. */
+	struct trigger on_replace;
+	/** Link in space_queue_list. */
+	struct rlist in_queue_list;
+	/** Taken tuples: tuple pointer -> id of the session that took it. */
+	struct mh_i64ptr_t *taken;
+	/** Ready tuples ordered by the primary key. */
+	struct space_queue_tree ready;
+	/** Primary key definition the ready tuples are ordered by. */
+	struct key_def *cmp_def;
+	/**
+	 * Value of space_cache_version the ready tuples were collected
+	 * at. The space may be altered after that, so the ready tuples
+	 * are collected again if the version changes.
+	 */
+	uint32_t space_cache_version;
+	/** Set if the ready tuples must be collected again. */
+	bool is_ready_stale;
+	/** Signalled when a tuple becomes ready to be taken. */
+	struct fiber_cond cond;
+	/** Number of fibers waiting on the condition. */
+	int waiter_count;
+	/** Set when the space is dropped. */
+	bool is_dropped;
+};
+
+/** All queues, see space_queue_on_disconnect(). */
+static RLIST_HEAD(space_queue_list);
+
+/** Releases the tuples taken by a session on disconnect. */
+static struct trigger space_queue_on_disconnect_trigger;
+
+/** Remove all ready tuples. */
+static void
+space_queue_clear_ready(struct space_queue *queue)
+{
+	struct space_queue_tree_iterator itr =
+		space_queue_tree_first(&queue->ready);
+	struct tuple **elem;
+	while ((elem = space_queue_tree_iterator_get_elem(&queue->ready,
+							  &itr)) != NULL) {
+		tuple_unref(*elem);
+		space_queue_tree_iterator_next(&queue->ready, &itr);
+	}
+	space_queue_tree_destroy(&queue->ready);
+	key_def_delete(queue->cmp_def);
+	queue->cmp_def = NULL;
+}
+
+static void
+space_queue_delete(struct space_queue *queue)
+{
+	assert(queue->is_dropped);
+	assert(queue->waiter_count == 0);
+	struct mh_i64ptr_t *h = queue->taken;
+	mh_int_t i;
+	mh_foreach(h, i)
+		tuple_unref((struct tuple *)mh_i64ptr_node(h, i)->key);
+	mh_i64ptr_delete(h);
+	if (queue->cmp_def != NULL)
+		space_queue_clear_ready(queue);
+	rlist_del_entry(queue, in_queue_list);
+	fiber_cond_destroy(&queue->cond);
+	free(queue);
+}
+
+/**
+ * Stop taking the tuple if it's taken. Return the id of the session
+ * that took the tuple or 0 if it wasn't taken.
+ */
+static uint64_t
+space_queue_forget(struct space_queue *queue, struct tuple *tuple)
+{
+	struct mh_i64ptr_t *h = queue->taken;
+	mh_int_t i = mh_i64ptr_find(h, (uintptr_t)tuple, NULL);
+	if (i == mh_end(h))
+		return 0;
+	uint64_t sid = (uintptr_t)mh_i64ptr_node(h, i)->val;
+	mh_i64ptr_del(h, i, NULL);
+	tuple_unref(tuple);
+	return sid;
+}
+
+static bool
+space_queue_is_taken(struct space_queue *queue, struct tuple *tuple)
+{
+	struct mh_i64ptr_t *h = queue->taken;
+	return mh_i64ptr_find(h, (uintptr_t)tuple, NULL) != mh_end(h);
+}
+
+/** Mark a tuple as taken by a session. */
+static void
+space_queue_add_taken(struct space_queue *queue, struct tuple *tuple,
+		      uint64_t sid)
+{
+	assert(sid != 0);
+	tuple_ref(tuple);
+	struct mh_i64ptr_node_t node = {(uintptr_t)tuple,
+					(void *)(uintptr_t)sid};
+	mh_i64ptr_put(queue->taken, &node, NULL, NULL);
+}
+
+/**
+ * Make a tuple ready to be taken. The ready tuples are referenced,
+ * because a tuple may be deleted from the space without being
+ * deleted from the ready tuples, for example if the rollback of a
+ * statement restores a tuple replaced by another transaction, so
+ * space_queue_take() checks that a ready tuple is in the space.
+ */
+static int
+space_queue_insert_ready(struct space_queue *queue, struct tuple *tuple)
+{
+	struct tuple *replaced = NULL;
+	if (space_queue_tree_insert(&queue->ready, tuple, &replaced,
+				    NULL) != 0)
+		return -1;
+	tuple_ref(tuple);
+	if (replaced != NULL)
+		tuple_unref(replaced);
+	return 0;
+}
+
+/** Make a tuple ready to be taken and wake up a consumer. */
+static void
+space_queue_add_ready(struct space_queue *queue, struct tuple *tuple)
+{
+	if (queue->is_ready_stale)
+		return;
+	if (space_queue_insert_ready(queue, tuple) != 0) {
+		/* Collect the ready tuples again on the next take. */
+		queue->is_ready_stale = true;
+		return;
+	}
+	fiber_cond_signal(&queue->cond);
+}
+
+static void
+space_queue_delete_ready(struct space_queue *queue, struct tuple *tuple)
+{
+	if (queue->is_ready_stale)
+		return;
+	struct tuple *deleted;
+	if (space_queue_tree_delete_value(&queue->ready, tuple, &deleted))
+		tuple_unref(deleted);
+}
+
+static int
+space_queue_on_replace(struct trigger *trigger, void *event);
+
+/** Return the queue state of the space or NULL if it isn't used. */
+static struct space_queue *
+space_queue_lookup(struct space *space)
+{
+	struct trigger *trigger;
+	rlist_foreach_entry(trigger, &space->on_replace, link) {
+		if (trigger->run == space_queue_on_replace)
+			return (struct space_queue *)trigger->data;
+	}
+	return NULL;
+}
+
+/** Return the queue state of the space by id or NULL. */
+static struct space_queue *
+space_queue_lookup_by_id(uint32_t space_id)
+{
+	struct space *space = space_by_id(space_id);
+	return space != NULL ? space_queue_lookup(space) : NULL;
+}
+
+/**
+ * Change of the space made by a statement. The queue state may be
+ * destroyed by the time the statement is committed or rolled back,
+ * so it's looked up by the space id.
+ */
+struct space_queue_stmt {
+	struct trigger on_commit;
+	struct trigger on_rollback;
+	uint32_t space_id;
+	/** Replaced or deleted tuple or NULL, referenced. */
+	struct tuple *old_tuple;
+	/** Inserted tuple or NULL, referenced. */
+	struct tuple *new_tuple;
+	/** Session that had taken the old tuple or 0. */
+	uint64_t old_owner;
+};
+
+static void
+space_queue_stmt_unref(struct space_queue_stmt *stmt)
+{
+	if (stmt->old_tuple != NULL)
+		tuple_unref(stmt->old_tuple);
+	if (stmt->new_tuple != NULL)
+		tuple_unref(stmt->new_tuple);
+}
+
+/** A new tuple becomes ready when it's committed. */
+static int
+space_queue_stmt_on_commit(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct space_queue_stmt *stmt =
+		(struct space_queue_stmt *)trigger->data;
+	struct space_queue *queue = space_queue_lookup_by_id(stmt->space_id);
+	if (queue != NULL && stmt->new_tuple != NULL)
+		space_queue_add_ready(queue, stmt->new_tuple);
+	space_queue_stmt_unref(stmt);
+	return 0;
+}
+
+/** An old tuple is restored in the same state on rollback. */
+static int
+space_queue_stmt_on_rollback(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct space_queue_stmt *stmt =
+		(struct space_queue_stmt *)trigger->data;
+	struct space_queue *queue = space_queue_lookup_by_id(stmt->space_id);
+	if (queue != NULL && stmt->old_tuple != NULL) {
+		if (stmt->old_owner != 0)
+			space_queue_add_taken(queue, stmt->old_tuple,
+					      stmt->old_owner);
+		else
+			space_queue_add_ready(queue, stmt->old_tuple);
+	}
+	space_queue_stmt_unref(stmt);
+	return 0;
+}
+
+static int
+space_queue_on_replace(struct trigger *trigger, void *event)
+{
+	struct space_queue *queue = (struct space_queue *)trigger->data;
+	struct txn *txn = (struct txn *)event;
+	struct txn_stmt *txn_stmt = txn_current_stmt(txn);
+	struct space_queue_stmt *stmt = xregion_alloc_object(
+		&txn->region, struct space_queue_stmt);
+	stmt->space_id = txn_stmt->space->def->id;
+	stmt->old_tuple = txn_stmt->old_tuple;
+	stmt->new_tuple = txn_stmt->new_tuple;
+	stmt->old_owner = 0;
+	if (stmt->old_tuple != NULL) {
+		tuple_ref(stmt->old_tuple);
+		/* The old tuple can't be taken until rollback. */
+		stmt->old_owner = space_queue_forget(queue, stmt->old_tuple);
+		if (stmt->old_owner == 0)
+			space_queue_delete_ready(queue, stmt->old_tuple);
+	}
+	if (stmt->new_tuple != NULL)
+		tuple_ref(stmt->new_tuple);
+	trigger_create(&stmt->on_commit, space_queue_stmt_on_commit,
+		       stmt, NULL);
+	trigger_create(&stmt->on_rollback, space_queue_stmt_on_rollback,
+		       stmt, NULL);
+	txn_stmt_on_commit(txn_stmt, &stmt->on_commit);
+	txn_stmt_on_rollback(txn_stmt, &stmt->on_rollback);
+	return 0;
+}
+
+static void
+space_queue_on_destroy(struct trigger *trigger)
+{
+	struct space_queue *queue = (struct space_queue *)trigger->data;
+	queue->is_dropped = true;
+	if (queue->waiter_count > 0)
+		fiber_cond_broadcast(&queue->cond);
+	else
+		space_queue_delete(queue);
+}
+
+/** Make the tuples taken by the session ready again. */
+static int
+space_queue_on_disconnect(struct trigger *trigger, void *event)
+{
+	(void)trigger;
+	(void)event;
+	uint64_t sid = current_session()->id;
+	struct space_queue *queue;
+	rlist_foreach_entry(queue, &space_queue_list, in_queue_list) {
+		if (queue->is_dropped)
+			continue;
+		struct mh_i64ptr_t *h = queue->taken;
+		mh_int_t i;
+		mh_foreach(h, i) {
+			struct mh_i64ptr_node_t *node = mh_i64ptr_node(h, i);
+			if ((uintptr_t)node->val != sid)
+				continue;
+			struct tuple *tuple = (struct tuple *)node->key;
+			space_queue_add_ready(queue, tuple);
+			mh_i64ptr_del(h, i, NULL);
+			tuple_unref(tuple);
+		}
+	}
+	return 0;
+}
+
+/**
+ * Collect the ready tuples of the space: all the tuples that aren't
+ * taken.
+ */
+static int
+space_queue_collect_ready(struct space *space, struct space_queue *queue)
+{
+	if (queue->cmp_def != NULL)
+		space_queue_clear_ready(queue);
+	struct index *pk = space_index(space, 0);
+	if (pk == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_INDEX_ID, 0, space_name(space));
+		return -1;
+	}
+	queue->cmp_def = key_def_dup(pk->def->cmp_def);
+	space_queue_tree_create(&queue->ready, queue->cmp_def,
+				memtx_index_extent_alloc,
+				memtx_index_extent_free, space->engine,
+				NULL);
+	queue->space_cache_version = space_cache_version;
+	queue->is_ready_stale = false;
+	static const char key[] = {(char)0x90};
+	box_iterator_t *it = box_index_iterator(space_id(space), 0, ITER_ALL,
+						key, key + sizeof(key));
+	if (it == NULL)
+		goto fail;
+	struct tuple *tuple;
+	while (true) {
+		if (box_iterator_next(it, &tuple) != 0) {
+			box_iterator_free(it);
+			goto fail;
+		}
+		if (tuple == NULL)
+			break;
+		if (space_queue_is_taken(queue, tuple))
+			continue;
+		if (space_queue_insert_ready(queue, tuple) != 0) {
+			box_iterator_free(it);
+			diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
+				 "space_queue", "ready tuples");
+			goto fail;
+		}
+	}
+	box_iterator_free(it);
+	return 0;
+fail:
+	queue->is_ready_stale = true;
+	return -1;
+}
+
+/**
+ * Find the queue state of the space, creating it on the first use.
+ */
+static struct space_queue *
+space_queue_find(uint32_t space_id)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return NULL;
+	if (!space_is_memtx(space)) {
+		diag_set(ClientError, ER_UNSUPPORTED, space->engine->name,
+			 "queue operations");
+		return NULL;
+	}
+	struct space_queue *queue = space_queue_lookup(space);
+	if (queue != NULL) {
+		if ((queue->is_ready_stale ||
+		     queue->space_cache_version != space_cache_version) &&
+		    space_queue_collect_ready(space, queue) != 0)
+			return NULL;
+		return queue;
+	}
+	static bool is_on_disconnect_set;
+	if (!is_on_disconnect_set) {
+		trigger_create(&space_queue_on_disconnect_trigger,
+			       space_queue_on_disconnect, NULL, NULL);
+		trigger_add(&session_on_disconnect,
+			    &space_queue_on_disconnect_trigger);
+		is_on_disconnect_set = true;
+	}
+	queue = xmalloc(sizeof(*queue));
+	queue->taken = mh_i64ptr_new();
+	queue->cmp_def = NULL;
+	fiber_cond_create(&queue->cond);
+	queue->waiter_count = 0;
+	queue->is_dropped = false;
+	trigger_create(&queue->on_replace, space_queue_on_replace, queue,
+		       space_queue_on_destroy);
+	trigger_add(&space->on_replace, &queue->on_replace);
+	rlist_add_entry(&space_queue_list, queue, in_queue_list);
+	if (space_queue_collect_ready(space, queue) != 0)
+		return NULL;
+	return queue;
+}
+
+/** Take back a tuple taken by a rolled back transaction. */
+struct space_queue_take {
+	struct trigger on_commit;
+	struct trigger on_rollback;
+	uint32_t space_id;
+	/** The taken tuple, referenced. */
+	struct tuple *tuple;
+};
+
+static int
+space_queue_take_on_commit(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct space_queue_take *take =
+		(struct space_queue_take *)trigger->data;
+	tuple_unref(take->tuple);
+	return 0;
+}
+
+static int
+space_queue_take_on_rollback(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct space_queue_take *take =
+		(struct space_queue_take *)trigger->data;
+	struct space_queue *queue = space_queue_lookup_by_id(take->space_id);
+	if (queue != NULL && space_queue_forget(queue, take->tuple) != 0)
+		space_queue_add_ready(queue, take->tuple);
+	tuple_unref(take->tuple);
+	return 0;
+}
+
+/**
+ * Remove the first ready tuple that is still in the space from the
+ * ready tuples. Set result to NULL if there's no such tuple.
+ */
+static int
+space_queue_first_ready(uint32_t space_id, struct space_queue *queue,
+			struct tuple **result)
+{
+	struct tuple **elem;
+	struct space_queue_tree_iterator itr;
+	while (true) {
+		itr = space_queue_tree_first(&queue->ready);
+		elem = space_queue_tree_iterator_get_elem(&queue->ready, &itr);
+		if (elem == NULL) {
+			*result = NULL;
+			return 0;
+		}
+		struct tuple *tuple = *elem;
+		space_queue_tree_delete_value(&queue->ready, tuple, NULL);
+		struct region *region = &fiber()->gc;
+		size_t region_svp = region_used(region);
+		uint32_t key_size;
+		const char *key = tuple_extract_key(tuple, queue->cmp_def,
+						    MULTIKEY_NONE, &key_size);
+		struct tuple *found = NULL;
+		int rc = key == NULL ? -1 :
+			 box_index_get(space_id, 0, key, key + key_size,
+				       &found);
+		region_truncate(region, region_svp);
+		if (rc != 0) {
+			tuple_unref(tuple);
+			return -1;
+		}
+		if (found == tuple) {
+			/* The space references the tuple. */
+			tuple_unref(tuple);
+			*result = tuple;
+			return 0;
+		}
+		tuple_unref(tuple);
+	}
+}
+
+int
+space_queue_take(uint32_t space_id, double timeout, struct tuple **result)
+{
+	double deadline = ev_monotonic_now(loop()) + timeout;
+	while (true) {
+		/* The space may be altered or dropped while we wait. */
+		struct space_queue *queue = space_queue_find(space_id);
+		if (queue == NULL)
+			return -1;
+		struct tuple *tuple;
+		if (space_queue_first_ready(space_id, queue, &tuple) != 0)
+			return -1;
+		if (tuple != NULL) {
+			space_queue_add_taken(queue, tuple,
+					      current_session()->id);
+			struct txn *txn = in_txn();
+			if (txn != NULL) {
+				struct space_queue_take *take =
+					xregion_alloc_object(
+						&txn->region,
+						struct space_queue_take);
+				take->space_id = space_id;
+				take->tuple = tuple;
+				tuple_ref(tuple);
+				trigger_create(&take->on_commit,
+					       space_queue_take_on_commit,
+					       take, NULL);
+				trigger_create(&take->on_rollback,
+					       space_queue_take_on_rollback,
+					       take, NULL);
+				txn_on_commit(txn, &take->on_commit);
+				txn_on_rollback(txn, &take->on_rollback);
+			}
+			*result = tuple;
+			return 0;
+		}
+		if (ev_monotonic_now(loop()) >= deadline) {
+			*result = NULL;
+			return 0;
+		}
+		queue->waiter_count++;
+		fiber_cond_wait_deadline(&queue->cond, deadline);
+		queue->waiter_count--;
+		if (queue->is_dropped && queue->waiter_count == 0)
+			space_queue_delete(queue);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			return -1;
+		}
+	}
+}
+
+/**
+ * Find a taken tuple of the space by the primary key. Set the queue
+ * state of the space and the found tuple.
+ */
+static int
+space_queue_find_taken(uint32_t space_id, const char *key,
+		       const char *key_end, struct space_queue **queue,
+		       struct tuple **tuple)
+{
+	*queue = space_queue_find(space_id);
+	if (*queue == NULL)
+		return -1;
+	if (box_index_get(space_id, 0, key, key_end, tuple) != 0)
+		return -1;
+	if (*tuple == NULL || !space_queue_is_taken(*queue, *tuple)) {
+		diag_set(ClientError, ER_TUPLE_NOT_TAKEN,
+			 space_name(space_by_id(space_id)));
+		return -1;
+	}
+	return 0;
+}
+
+int
+space_queue_ack(uint32_t space_id, const char *key, const char *key_end,
+		struct tuple **result)
+{
+	struct space_queue *queue;
+	struct tuple *tuple;
+	if (space_queue_find_taken(space_id, key, key_end, &queue, &tuple) != 0)
+		return -1;
+	/* The tuple is forgotten by the on_replace trigger. */
+	return box_delete(space_id, 0, key, key_end, result);
+}
+
+int
+space_queue_release(uint32_t space_id, const char *key, const char *key_end,
+		    struct tuple **result)
+{
+	struct space_queue *queue;
+	struct tuple *tuple;
+	if (space_queue_find_taken(space_id, key, key_end, &queue, &tuple) != 0)
+		return -1;
+	*result = tuple;
+	space_queue_forget(queue, tuple);
+	space_queue_add_ready(queue, tuple);
+	return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Queue operations on a memtx space.
+ *
+ * A space is used as a queue ordered by its primary key, so a tuple
+ * with the least key is taken first: an auto-increment key gives FIFO
+ * order, a {priority, id} key gives priority order. Taking a tuple
+ * doesn't modify it: taken tuples are kept in memory until they are
+ * acknowledged, which deletes them from the space, or released, which
+ * makes them ready to be taken again. Taken tuples thus become ready
+ * after restart and a tuple replaced or deleted by another request
+ * stops being taken. The tuples taken by a session are also released
+ * when the session is closed, and a take is undone if the transaction
+ * it was done in is rolled back. A consumer waits for a ready tuple on
+ * a condition variable signalled on insertion or release.
+ */
+
+struct tuple;
+
+/**
+ * Take the first ready tuple of the space, waiting for it for up to
+ * timeout seconds. Set result to NULL on timeout.
+ */
+int
+space_queue_take(uint32_t space_id, double timeout, struct tuple **result);
+
+/**
+ * Delete a taken tuple with the given primary key from the space.
+ * Set result to the deleted tuple.
+ */
+int
+space_queue_ack(uint32_t space_id, const char *key, const char *key_end,
+		struct tuple **result);
+
+/**
+ * Return a taken tuple with the given primary key to the queue.
+ * Set result to the released tuple.
+ */
+int
+space_queue_release(uint32_t space_id, const char *key, const char *key_end,
+		    struct tuple **result);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -621,6 +621,248 @@ int tarantoolsqlClearTable(struct space *space, uint32_t *tuple_count)
 	return 0;
 }
 
+/** Max number of key samples collected by ANALYZE for an index. */
+enum { SQL_STAT_SAMPLE_MAX = 24 };
+
+/** Marker of a sample eq counter that isn't known yet. */
+#define SQL_STAT_EQ_UNKNOWN UINT32_MAX
+
+/**
+ * Position of sample @a sample_no in an index of @a size tuples.
+ * Samples are spaced evenly so that each of them is in the middle
+ * of its share of the index.
+ */
+static inline uint64_t
+sql_stat_sample_pos(uint32_t sample_no, uint64_t size)
+{
+	if (size <= SQL_STAT_SAMPLE_MAX)
+		return sample_no;
+	return (2 * (uint64_t)sample_no + 1) * size /
+	       (2 * SQL_STAT_SAMPLE_MAX);
+}
+
+/**
+ * Set the eq counter of key prefixes of @a field_no + 1 parts of
+ * the samples that are in the group of tuples that has just ended
+ * at position @a pos. Such samples are always at the end of the
+ * sample array.
+ */
+static void
+sql_stat_group_end(struct index_sample *samples, uint32_t sample_count,
+		   uint32_t field_no, uint32_t pos)
+{
+	for (uint32_t i = sample_count; i > 0; i--) {
+		struct index_sample *sample = &samples[i - 1];
+		if (sample->eq[field_no] != SQL_STAT_EQ_UNKNOWN)
+			break;
+		sample->eq[field_no] = pos - sample->lt[field_no];
+	}
+}
+
+/**
+ * Collect SQL statistics of an index by a full scan: the number
+ * of tuples, the average number of tuples per each key prefix,
+ * and samples of keys evenly spaced in the index order, which
+ * the query planner uses to estimate range selectivity.
+ *
+ * Returns NULL and sets diag on error.
+ */
+static struct index_stat *
+sql_index_stat_collect(struct index *index)
+{
+	struct key_def *key_def = index->def->key_def;
+	uint32_t field_count = key_def->part_count;
+	/*
+	 * Per each key prefix length: the position of the first
+	 * tuple of the current group of tuples having equal key
+	 * prefixes and the number of groups preceding it.
+	 */
+	uint32_t *group_start = xcalloc(2 * field_count, sizeof(uint32_t));
+	uint32_t *group_count = group_start + field_count;
+	struct index_sample samples[SQL_STAT_SAMPLE_MAX];
+	uint32_t *sample_stat = xcalloc(3 * field_count * SQL_STAT_SAMPLE_MAX,
+					sizeof(uint32_t));
+	for (uint32_t i = 0; i < SQL_STAT_SAMPLE_MAX; i++) {
+		samples[i].sample_key = NULL;
+		samples[i].key_size = 0;
+		samples[i].eq = sample_stat + 3 * field_count * i;
+		samples[i].lt = samples[i].eq + field_count;
+		samples[i].dlt = samples[i].lt + field_count;
+	}
+	uint32_t sample_count = 0;
+	uint32_t sample_no = 0;
+	/*
+	 * The index size may be approximate, e.g. in vinyl, so
+	 * the samples may be spaced not quite evenly.
+	 */
+	ssize_t size = index_size(index);
+	if (size < 0)
+		size = 0;
+	char *prev_key = NULL;
+	size_t prev_key_capacity = 0;
+	uint32_t count = 0;
+	struct index_stat *stat = NULL;
+	struct iterator *it = index_create_iterator(index, ITER_ALL,
+						    nil_key, 0);
+	if (it == NULL)
+		goto out;
+	struct tuple *tuple;
+	while (true) {
+		if (iterator_next(it, &tuple) != 0)
+			goto out;
+		if (tuple == NULL)
+			break;
+		/* Number of key parts equal to the previous tuple's. */
+		uint32_t common = 0;
+		if (count > 0) {
+			const char *key = prev_key;
+			mp_decode_array(&key);
+			while (common < field_count &&
+			       tuple_compare_with_key(tuple, HINT_NONE, key,
+						      common + 1, HINT_NONE,
+						      key_def) == 0)
+				common++;
+		}
+		for (uint32_t i = common; i < field_count; i++) {
+			if (count > 0) {
+				sql_stat_group_end(samples, sample_count,
+						   i, count);
+				group_count[i]++;
+			}
+			group_start[i] = count;
+		}
+		size_t region_svp = region_used(&fiber()->gc);
+		uint32_t key_size;
+		const char *key = tuple_extract_key(tuple, key_def,
+						    MULTIKEY_NONE, &key_size);
+		if (key == NULL)
+			goto out;
+		if (sample_no < SQL_STAT_SAMPLE_MAX &&
+		    count == sql_stat_sample_pos(sample_no, size)) {
+			sample_no++;
+			/*
+			 * Skip a sample equal to the previous one: the
+			 * planner expects samples to be distinct.
+			 */
+			if (sample_count == 0 ||
+			    samples[sample_count - 1].eq[field_count - 1] !=
+			    SQL_STAT_EQ_UNKNOWN) {
+				struct index_sample *sample =
+					&samples[sample_count++];
+				sample->sample_key = xmalloc(key_size);
+				memcpy(sample->sample_key, key, key_size);
+				sample->key_size = key_size;
+				for (uint32_t i = 0; i < field_count; i++) {
+					sample->eq[i] = SQL_STAT_EQ_UNKNOWN;
+					sample->lt[i] = group_start[i];
+					sample->dlt[i] = group_count[i];
+				}
+			}
+		}
+		if (key_size > prev_key_capacity) {
+			prev_key_capacity = key_size;
+			prev_key = xrealloc(prev_key, prev_key_capacity);
+		}
+		memcpy(prev_key, key, key_size);
+		region_truncate(&fiber()->gc, region_svp);
+		count++;
+	}
+	for (uint32_t i = 0; i < field_count; i++)
+		sql_stat_group_end(samples, sample_count, i, count);
+
+	size_t array_size = field_count * sizeof(uint32_t);
+	stat = xmalloc(index_stat_sizeof(samples, sample_count, field_count));
+	/* The layout must match the one expected by index_stat_dup(). */
+	char *pos = (char *)stat + sizeof(*stat);
+	stat->tuple_stat1 = (uint32_t *)pos;
+	pos += array_size + sizeof(uint32_t);
+	stat->tuple_log_est = (log_est_t *)pos;
+	pos += array_size + sizeof(uint32_t);
+	stat->avg_eq = (uint32_t *)pos;
+	pos += array_size;
+	stat->samples = (struct index_sample *)pos;
+	pos += sample_count * sizeof(struct index_sample);
+	for (uint32_t i = 0; i < sample_count; i++) {
+		struct index_sample *sample = &stat->samples[i];
+		sample->eq = (uint32_t *)pos;
+		memcpy(pos, samples[i].eq, array_size);
+		pos += array_size;
+		sample->lt = (uint32_t *)pos;
+		memcpy(pos, samples[i].lt, array_size);
+		pos += array_size;
+		sample->dlt = (uint32_t *)pos;
+		memcpy(pos, samples[i].dlt, array_size);
+		pos += array_size;
+		sample->sample_key = pos;
+		sample->key_size = samples[i].key_size;
+		memcpy(pos, samples[i].sample_key, samples[i].key_size);
+		pos += samples[i].key_size;
+	}
+	stat->sample_count = sample_count;
+	stat->sample_field_count = field_count;
+	stat->is_unordered = false;
+	stat->skip_scan_enabled = true;
+	stat->tuple_stat1[0] = count;
+	stat->tuple_log_est[0] = sqlLogEst(count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		uint32_t distinct = count > 0 ? group_count[i] + 1 : 1;
+		uint32_t avg = DIV_ROUND_UP(count, distinct);
+		stat->tuple_stat1[i + 1] = avg;
+		stat->tuple_log_est[i + 1] = sqlLogEst(avg);
+		stat->avg_eq[i] = avg;
+	}
+out:
+	if (it != NULL)
+		iterator_delete(it);
+	for (uint32_t i = 0; i < sample_count; i++)
+		free(samples[i].sample_key);
+	free(sample_stat);
+	free(group_start);
+	free(prev_key);
+	return stat;
+}
+
+int
+sql_analyze_space(uint32_t space_id)
+{
+	struct space *space = space_by_id(space_id);
+	if (space == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(space_id));
+		return -1;
+	}
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	for (uint32_t i = 0; space != NULL && i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		struct index_def *def = index->def;
+		if (def->type != TREE || def->key_def->is_multikey ||
+		    def->key_def->for_func_index)
+			continue;
+		uint32_t iid = def->iid;
+		uint64_t schema_ver = box_schema_version();
+		struct index_stat *stat = sql_index_stat_collect(index);
+		if (stat == NULL)
+			return -1;
+		/*
+		 * A scan of a vinyl index may yield, and the space
+		 * may be altered meanwhile. Drop the statistics then,
+		 * since they may be collected for another key.
+		 */
+		if (box_schema_version() != schema_ver) {
+			free(stat);
+			space = space_by_id(space_id);
+			continue;
+		}
+		index = space_index(space, iid);
+		assert(index != NULL);
+		free(index->def->opts.stat);
+		index->def->opts.stat = stat;
+	}
+	/* Plans built with the old statistics may be not optimal. */
+	sql_plan_cache_flush();
+	return 0;
+}
+
 /*
  * Change the statement of trigger in _trigger space.
  * This function is called after tarantoolsqlRenameTable,
@@ -930,8 +1172,11 @@ cursor_advance(BtCursor *pCur, int *pRes)
 	assert(pCur->iter != NULL);
 
 	struct tuple *tuple;
-	if (iterator_next(pCur->iter, &tuple) != 0)
-		return -1;
+	do {
+		if (iterator_next(pCur->iter, &tuple) != 0)
+			return -1;
+	} while (tuple != NULL && pCur->filter_count > 0 &&
+		 !sql_cursor_filter_match(pCur, tuple));
 	if (pCur->last_tuple)
 		box_tuple_unref(pCur->last_tuple);
 	if (tuple) {
@@ -1285,10 +1530,19 @@ vdbe_field_ref_fill(struct vdbe_field_ref *field_ref, struct tuple *tuple,
 	field_ref->format = NULL;
 	field_ref->field_count = MIN(field_ref->field_capacity, mp_count);
 	field_ref->slots[0] = 0;
-	memset(&field_ref->slots[1], 0,
-	       field_ref->field_count * sizeof(field_ref->slots[0]));
 	field_ref->slot_bitmask = 0;
 	bitmask64_set_bit(&field_ref->slot_bitmask, 0);
+	/*
+	 * Slots of the first 64 fields are valid only if they are
+	 * marked in the slot_bitmask so only the rest of the slots
+	 * has to be reset. This is done for every row fetched by
+	 * a scan so it's worth avoiding touching all the slots.
+	 */
+	if (field_ref->field_count >= 64) {
+		memset(&field_ref->slots[64], 0,
+		       (field_ref->field_count - 63) *
+		       sizeof(field_ref->slots[0]));
+	}
 }
 
 void
@@ -352,8 +352,9 @@ struct vdbe_field_ref {
 	 */
 	uint64_t slot_bitmask;
 	/**
-	 * Array of offsets of tuple fields.
-	 * Only values <= rightmost_slot are valid.
+	 * Array of offsets of tuple fields. A slot of a field
+	 * with fieldno < 64 is valid only if it is marked in
+	 * slot_bitmask, the rest of the slots are valid if not 0.
 	 */
 	uint32_t slots[1];
 };
@@ -3775,3 +3775,38 @@ sql_emit_show_create_table_all(struct Parse *parse)
 	sqlVdbeAddOp2(v, OP_Next, cursor, addr2);
 	sqlVdbeJumpHere(v, addr1);
 }
+
+void
+sql_analyze(struct Parse *parse, struct SrcList *tab_list)
+{
+	struct Vdbe *v = sqlGetVdbe(parse);
+	int space_id_reg = ++parse->nMem;
+	if (tab_list != NULL) {
+		assert(tab_list->nSrc == 1);
+		const struct space *space = sql_space_by_src(&tab_list->a[0]);
+		if (space == NULL) {
+			diag_set(ClientError, ER_NO_SUCH_SPACE,
+				 tab_list->a[0].zName);
+			parse->is_aborted = true;
+		} else {
+			sqlVdbeAddOp2(v, OP_Integer, space->def->id,
+				      space_id_reg);
+			sqlVdbeAddOp2(v, OP_Analyze, space_id_reg, 0);
+		}
+		sqlSrcListDelete(tab_list);
+		return;
+	}
+	/* Analyze all user spaces visible to the current user. */
+	int cursor = parse->nTab++;
+	int space_reg = ++parse->nMem;
+	int key_reg = ++parse->nMem;
+	sqlVdbeAddOp2(v, OP_OpenSpace, space_reg, BOX_VSPACE_ID);
+	sqlVdbeAddOp3(v, OP_IteratorOpen, cursor, 0, space_reg);
+	sqlVdbeAddOp2(v, OP_Integer, BOX_SYSTEM_ID_MAX, key_reg);
+	int addr1 = sqlVdbeAddOp4Int(v, OP_SeekGT, cursor, 0, key_reg, 1);
+	int addr2 = sqlVdbeAddOp3(v, OP_Column, cursor, BOX_SPACE_FIELD_ID,
+				  space_id_reg);
+	sqlVdbeAddOp2(v, OP_Analyze, space_id_reg, 1);
+	sqlVdbeAddOp2(v, OP_Next, cursor, addr2);
+	sqlVdbeJumpHere(v, addr1);
+}
@@ -32,6 +32,7 @@
 #include "sqlInt.h"
 #include "tarantoolInt.h"
 #include "box/tuple.h"
+#include "mem.h"
 
 void
 sql_cursor_cleanup(struct BtCursor *cursor)
@@ -67,6 +68,102 @@ sql_cursor_close(struct BtCursor *cursor)
 	sql_cursor_cleanup(cursor);
 }
 
+void
+sql_cursor_add_filter(struct BtCursor *cursor, uint32_t fieldno, int op,
+		      const struct Mem *value, const struct coll *coll)
+{
+	assert(op == OP_Eq || op == OP_Ne || op == OP_Lt || op == OP_Le ||
+	       op == OP_Gt || op == OP_Ge);
+	for (uint32_t i = 0; i < cursor->filter_count; i++) {
+		const struct sql_cursor_filter *filter = &cursor->filters[i];
+		/* The filter is added again on a rescan. */
+		if (filter->value == value && filter->fieldno == fieldno &&
+		    filter->op == op)
+			return;
+	}
+	if (cursor->filter_count == SQL_CURSOR_FILTER_MAX)
+		return;
+	struct sql_cursor_filter *filter =
+		&cursor->filters[cursor->filter_count++];
+	filter->value = value;
+	filter->coll = coll;
+	filter->fieldno = fieldno;
+	filter->op = op;
+}
+
+bool
+sql_cursor_filter_match(const struct BtCursor *cursor, struct tuple *tuple)
+{
+	for (uint32_t i = 0; i < cursor->filter_count; i++) {
+		const struct sql_cursor_filter *filter = &cursor->filters[i];
+		/* A comparison with NULL is never true. */
+		if (mem_is_null(filter->value))
+			return false;
+		/*
+		 * A missing field may be replaced with the default
+		 * value by OP_Column, so let the caller check it.
+		 */
+		const char *data = tuple_field(tuple, filter->fieldno);
+		if (data == NULL)
+			continue;
+		/*
+		 * Only values that mem_cmp_fast() compares are checked,
+		 * so that errors and implicit casts of comparisons of
+		 * other values are left to the caller.
+		 */
+		struct Mem field;
+		field.flags = 0;
+		switch (mp_typeof(*data)) {
+		case MP_NIL:
+			return false;
+		case MP_UINT:
+			field.type = MEM_TYPE_UINT;
+			field.u.u = mp_decode_uint(&data);
+			break;
+		case MP_INT:
+			field.type = MEM_TYPE_INT;
+			field.u.i = mp_decode_int(&data);
+			break;
+		case MP_STR:
+			field.type = MEM_TYPE_STR;
+			field.n = mp_decode_strl(&data);
+			field.z = (char *)data;
+			break;
+		default:
+			continue;
+		}
+		int cmp;
+		if (!mem_cmp_fast(&field, filter->value, &cmp, filter->coll))
+			continue;
+		bool is_match;
+		switch (filter->op) {
+		case OP_Eq:
+			is_match = cmp == 0;
+			break;
+		case OP_Ne:
+			is_match = cmp != 0;
+			break;
+		case OP_Lt:
+			is_match = cmp < 0;
+			break;
+		case OP_Le:
+			is_match = cmp <= 0;
+			break;
+		case OP_Gt:
+			is_match = cmp > 0;
+			break;
+		case OP_Ge:
+			is_match = cmp >= 0;
+			break;
+		default:
+			unreachable();
+		}
+		if (!is_match)
+			return false;
+	}
+	return true;
+}
+
 #ifndef NDEBUG			/* The next routine used only within assert() statements */
 /*
  * Return true if the given BtCursor is valid.  A valid cursor is one
@@ -34,6 +34,24 @@
 
 typedef struct BtCursor BtCursor;
 
+/** Max number of filters pushed down into a cursor. */
+enum { SQL_CURSOR_FILTER_MAX = 4 };
+
+/**
+ * A comparison of a tuple field with a VDBE register evaluated by
+ * a cursor on each fetched tuple, see OP_CursorFilter.
+ */
+struct sql_cursor_filter {
+	/** Register holding the value to compare the field with. */
+	const struct Mem *value;
+	/** Collation of the comparison or NULL. */
+	const struct coll *coll;
+	/** Number of the compared field. */
+	uint32_t fieldno;
+	/** One of OP_Eq, OP_Ne, OP_Lt, OP_Le, OP_Gt and OP_Ge. */
+	int op;
+};
+
 /*
  * A cursor contains a particular entry either from Tarantrool or
  * Sorter. Tarantool cursor is able to point to ordinary table or
@@ -50,6 +68,10 @@ struct BtCursor {
 	enum iterator_type iter_type;
 	struct tuple *last_tuple;
 	char *key;		/* Saved key that was cursor last known position */
+	/** Filters that tuples must pass to be returned. */
+	struct sql_cursor_filter filters[SQL_CURSOR_FILTER_MAX];
+	/** Number of filters. */
+	uint32_t filter_count;
 };
 
 void sqlCursorZero(BtCursor *);
@@ -61,6 +83,24 @@ void sqlCursorZero(BtCursor *);
 void
 sql_cursor_close(struct BtCursor *cursor);
 
+/**
+ * Make a cursor skip tuples for which the comparison of the given
+ * field with the value is known to be false or NULL. Other tuples
+ * are returned, so the comparison must be checked by the caller as
+ * well. The filter is ignored if the cursor already has the same
+ * filter or the max number of filters.
+ */
+void
+sql_cursor_add_filter(struct BtCursor *cursor, uint32_t fieldno, int op,
+		      const struct Mem *value, const struct coll *coll);
+
+/**
+ * Return false if a tuple fails a filter of a cursor and thus must
+ * be skipped.
+ */
+bool
+sql_cursor_filter_match(const struct BtCursor *cursor, struct tuple *tuple);
+
 int sqlCursorNext(BtCursor *, int *pRes);
 int sqlCursorPrevious(BtCursor *, int *pRes);
 void
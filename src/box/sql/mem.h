@@ -657,6 +657,39 @@ int
 mem_cmp(const struct Mem *a, const struct Mem *b, int *result,
 	const struct coll *coll);
 
+/**
+ * Compare two MEMs if both of them are integers or both of them are
+ * strings compared without a collation, which are the most frequent
+ * operands of predicates. The check is inlined so that comparison
+ * opcodes don't pay for the generic type dispatch of mem_cmp() in
+ * these cases. Return true and set the result if the MEMs have been
+ * compared, false if mem_cmp() should be used instead.
+ */
+static inline bool
+mem_cmp_fast(const struct Mem *a, const struct Mem *b, int *result,
+	     const struct coll *coll)
+{
+	if (((a->flags | b->flags) & MEM_Any) != 0)
+		return false;
+	uint32_t types = a->type | b->type;
+	if ((types & ~(MEM_TYPE_INT | MEM_TYPE_UINT)) == 0) {
+		/* Values of type INT are always negative. */
+		if (a->type != b->type)
+			*result = a->type == MEM_TYPE_INT ? -1 : 1;
+		else if (a->type == MEM_TYPE_INT)
+			*result = (a->u.i > b->u.i) - (a->u.i < b->u.i);
+		else
+			*result = (a->u.u > b->u.u) - (a->u.u < b->u.u);
+		return true;
+	}
+	if (types == MEM_TYPE_STR && coll == NULL) {
+		int res = memcmp(a->z, b->z, MIN(a->n, b->n));
+		*result = res != 0 ? res : (a->n > b->n) - (a->n < b->n);
+		return true;
+	}
+	return false;
+}
+
 /**
  * Convert the given MEM to INTEGER. This function and the function below define
  * the rules that are used to convert values of all other types to INTEGER. In
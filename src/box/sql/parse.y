@@ -808,6 +808,15 @@ cmd ::= TRUNCATE TABLE fullname(X). {
   sql_table_truncate(pParse, X);
 }
 
+/////////////////////////// The ANALYZE statement /////////////////////////////
+//
+cmd ::= ANALYZE. {
+  sql_analyze(pParse, NULL);
+}
+cmd ::= ANALYZE fullname(X). {
+  sql_analyze(pParse, X);
+}
+
 %type where_opt {Expr*}
 %destructor where_opt {sql_expr_delete($$);}
 
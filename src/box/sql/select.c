@@ -105,17 +105,11 @@ struct SortCtx {
 	ExprList *pOrderBy;	/* The ORDER BY (or GROUP BY clause) */
 	int nOBSat;		/* Number of ORDER BY terms satisfied by indices */
 	int iECursor;		/* Cursor number for the sorter */
-	/** Register, containing pointer to ephemeral space. */
-	int reg_eph;
 	int regReturn;		/* Register holding block-output return address */
 	int labelBkOut;		/* Start label for the block-output subroutine */
-	int addrSortIndex;	/* Address of the OP_SorterOpen or OP_OpenEphemeral */
+	int addrSortIndex;	/* Address of the OP_SorterOpen */
 	int labelDone;		/* Jump here when done, ex: LIMIT reached */
-	u8 sortFlags;		/* Zero or more SORTFLAG_* bits */
-	u8 bOrderedInnerLoop;	/* ORDER BY correctly sorts the inner loop */
 };
-#define SORTFLAG_UseSorter  0x01	/* Use SorterOpen instead of OpenEphemeral */
-#define SORTFLAG_DESC 0xF0
 
 static inline uint32_t
 multi_select_coll_seq(struct Parse *parser, struct Select *p, int n);
@@ -285,24 +279,6 @@ sql_key_info_new_from_space_info(const struct sql_space_info *info)
 	return key_info;
 }
 
-/* Drop fields with type field_type_MAX from space info. */
-static void
-sql_space_info_normalize(struct sql_space_info *info, uint32_t drop_count)
-{
-	for (uint32_t j = 0; j < drop_count; ++j) {
-		uint32_t k = 0;
-		for (; k < info->field_count - j - 1; ++k) {
-			if (info->types[k] == field_type_MAX)
-				break;
-		}
-		for (; k < info->field_count - j - 1; ++k) {
-			info->types[k] = info->types[k + 1];
-			info->coll_ids[k] = info->coll_ids[k + 1];
-		}
-	}
-	info->field_count -= drop_count;
-}
-
 /*
  * Delete all the content of a Select structure.  Deallocate the structure
  * itself only if bFree is true.
@@ -343,20 +319,6 @@ sqlSelectDestInit(SelectDest * pDest, int eDest, int iParm, int reg_eph)
 	pDest->nSdst = 0;
 }
 
-static bool
-is_same_sorting_direction(const struct ExprList *expr_list)
-{
-	if(expr_list == NULL)
-		return true;
-	enum sort_order reference_order = expr_list->a[0].sort_order;
-	for (int i = 1; i < expr_list->nExpr; i++) {
-		assert(expr_list->a[i].sort_order != SORT_ORDER_UNDEF);
-		if (expr_list->a[i].sort_order != reference_order)
-			return false;
-	}
-	return true;
-}
-
 /*
  * Allocate a new Select structure and return a pointer to that
  * structure.
@@ -941,19 +903,17 @@ pushOntoSorter(Parse * pParse,		/* Parser context */
 	       int nPrefixReg)		/* No. of reg prior to regData available for use */
 {
 	Vdbe *v = pParse->pVdbe;	/* Stmt under construction */
-	int bSeq = ((pSort->sortFlags & SORTFLAG_UseSorter) == 0);
 	int nExpr = pSort->pOrderBy->nExpr;	/* No. of ORDER BY terms */
-	int nBase = nExpr + bSeq + nData;	/* Fields in sorter record */
+	int nBase = nExpr + nData;	/* Fields in sorter record */
 	int regBase;		/* Regs for sorter record */
 	int regRecord = ++pParse->nMem;	/* Assembled sorter record */
 	int nOBSat = pSort->nOBSat;	/* ORDER BY terms to skip */
 	int iLimit;		/* LIMIT counter */
 
-	assert(bSeq == 0 || bSeq == 1);
 	assert(nData == 1 || regData == regOrigData || regOrigData == 0);
 	if (nPrefixReg) {
-		assert(nPrefixReg == nExpr + bSeq);
-		regBase = regData - nExpr - bSeq;
+		assert(nPrefixReg == nExpr);
+		regBase = regData - nExpr;
 	} else {
 		regBase = pParse->nMem + 1;
 		pParse->nMem += nBase;
@@ -964,14 +924,8 @@ pushOntoSorter(Parse * pParse,		/* Parser context */
 	sqlExprCodeExprList(pParse, pSort->pOrderBy, regBase, regOrigData,
 				SQL_ECEL_DUP | (regOrigData ? SQL_ECEL_REF
 						   : 0));
-	if (bSeq) {
-		sqlVdbeAddOp2(v, OP_Sequence, pSort->iECursor,
-				  regBase + nExpr);
-	}
-	if (nPrefixReg == 0 && nData > 0) {
-		sqlExprCodeMove(pParse, regData, regBase + nExpr + bSeq,
-				    nData);
-	}
+	if (nPrefixReg == 0 && nData > 0)
+		sqlExprCodeMove(pParse, regData, regBase + nExpr, nData);
 	sqlVdbeAddOp3(v, OP_MakeRecord, regBase + nOBSat, nBase - nOBSat,
 			  regRecord);
 	if (nOBSat > 0) {
@@ -979,51 +933,24 @@ pushOntoSorter(Parse * pParse,		/* Parser context */
 		int addrFirst;	/* Address of the OP_IfNot opcode */
 		int addrJmp;	/* Address of the OP_Jump opcode */
 		VdbeOp *pOp;	/* Opcode that opens the sorter */
-		int nKey;	/* Number of sorting key columns, including OP_Sequence */
+		int nKey;	/* Number of sorting key columns */
 
 		regPrevKey = pParse->nMem + 1;
 		pParse->nMem += pSort->nOBSat;
-		nKey = nExpr - pSort->nOBSat + bSeq;
-		if (bSeq) {
-			int r1 = sqlGetTempReg(pParse);
-			sqlVdbeAddOp2(v, OP_Integer, 0, r1);
-			addrFirst = sqlVdbeAddOp3(v, OP_Eq, r1, 0, regBase + nExpr);
-			sqlReleaseTempReg(pParse, r1);
-		} else {
-			addrFirst =
-			    sqlVdbeAddOp1(v, OP_SequenceTest,
-					      pSort->iECursor);
-		}
+		nKey = nExpr - pSort->nOBSat;
+		addrFirst = sqlVdbeAddOp1(v, OP_SequenceTest, pSort->iECursor);
 		sqlVdbeAddOp3(v, OP_Compare, regPrevKey, regBase,
 				  pSort->nOBSat);
 		pOp = sqlVdbeGetOp(v, pSort->addrSortIndex);
 		pOp->p2 = nKey + nData;
-		assert(pOp->opcode == OP_OpenTEphemeral ||
-		       pOp->opcode == OP_SorterOpen);
-		struct sql_key_info *key_info =
-			pOp->opcode == OP_SorterOpen ? pOp->p4.key_info :
-			sql_key_info_new_from_space_info(pOp->p4.space_info);
+		assert(pOp->opcode == OP_SorterOpen);
+		struct sql_key_info *key_info = pOp->p4.key_info;
 		for (uint32_t i = 0; i < key_info->part_count; i++)
 			key_info->parts[i].sort_order = SORT_ORDER_ASC;
 		sqlVdbeChangeP4(v, -1, (char *)key_info, P4_KEYINFO);
-		if (pOp->opcode == OP_SorterOpen) {
-			pOp->p4.key_info =
-				sql_expr_list_to_key_info(pParse,
-							  pSort->pOrderBy,
-							  nOBSat);
-		} else {
-			struct sql_space_info *info =
-				sql_space_info_new_for_sorting(pParse,
-							       pSort->pOrderBy,
-							       pSelect->pEList,
-							       nOBSat, bSeq);
-			if (info == NULL) {
-				pParse->is_aborted = true;
-				return;
-			}
-			sqlVdbeChangeP4(v, pSort->addrSortIndex, (char *)info,
-					P4_DYNAMIC);
-		}
+		pOp->p4.key_info = sql_expr_list_to_key_info(pParse,
+							     pSort->pOrderBy,
+							     nOBSat);
 		addrJmp = sqlVdbeCurrentAddr(v);
 		sqlVdbeAddOp3(v, OP_Jump, addrJmp + 1, 0, addrJmp + 1);
 		pSort->labelBkOut = sqlVdbeMakeLabel(v);
@@ -1041,48 +968,11 @@ pushOntoSorter(Parse * pParse,		/* Parser context */
 		sqlExprCodeMove(pParse, regBase, regPrevKey, pSort->nOBSat);
 		sqlVdbeJumpHere(v, addrJmp);
 	}
-	if (pSort->sortFlags & SORTFLAG_UseSorter) {
-		sqlVdbeAddOp2(v, OP_SorterInsert, pSort->iECursor,
-				  regRecord);
-		return;
-	}
-	sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, pSort->reg_eph);
-
-	if (iLimit) {
-		int addr;
-		int r1 = 0;
-		/* Fill the sorter until it contains LIMIT+OFFSET entries.  (The iLimit
-		 * register is initialized with value of LIMIT+OFFSET.)  After the sorter
-		 * fills up, delete the least entry in the sorter after each insert.
-		 * Thus we never hold more than the LIMIT+OFFSET rows in memory at once
-		 */
-		addr = sqlVdbeAddOp1(v, OP_IfNotZero, iLimit);
-		if (pSort->sortFlags & SORTFLAG_DESC) {
-			int iNextInstr = sqlVdbeCurrentAddr(v) + 1;
-			sqlVdbeAddOp2(v, OP_Rewind, pSort->iECursor, iNextInstr);
-		} else {
-			sqlVdbeAddOp1(v, OP_Last, pSort->iECursor);
-		}
-		if (pSort->bOrderedInnerLoop) {
-			r1 = ++pParse->nMem;
-			sqlVdbeAddOp3(v, OP_Column, pSort->iECursor, nExpr,
-					  r1);
-			VdbeComment((v, "seq"));
-		}
-		sqlVdbeAddOp1(v, OP_Delete, pSort->iECursor);
-		if (pSort->bOrderedInnerLoop) {
-			/* If the inner loop is driven by an index such that values from
-			 * the same iteration of the inner loop are in sorted order, then
-			 * immediately jump to the next iteration of an inner loop if the
-			 * entry from the current iteration does not fit into the top
-			 * LIMIT+OFFSET entries of the sorter.
-			 */
-			int iBrk = sqlVdbeCurrentAddr(v) + 2;
-			sqlVdbeAddOp3(v, OP_Eq, regBase + nExpr, iBrk, r1);
-			sqlVdbeChangeP5(v, SQL_NULLEQ);
-		}
-		sqlVdbeJumpHere(v, addr);
-	}
+	/*
+	 * With LIMIT the sorter needs to keep only LIMIT+OFFSET
+	 * least records, see sqlVdbeSorterWrite().
+	 */
+	sqlVdbeAddOp3(v, OP_SorterInsert, pSort->iECursor, regRecord, iLimit);
 }
 
 /*
@@ -1182,8 +1072,6 @@ selectInnerLoop(Parse * pParse,		/* The parser context */
 	if (pDest->iSdst == 0) {
 		if (pSort) {
 			nPrefixReg = pSort->pOrderBy->nExpr;
-			if (!(pSort->sortFlags & SORTFLAG_UseSorter))
-				nPrefixReg++;
 			pParse->nMem += nPrefixReg;
 		}
 		pDest->iSdst = pParse->nMem + 1;
@@ -1227,19 +1115,17 @@ selectInnerLoop(Parse * pParse,		/* The parser context */
 			 */
 			ecelFlags |= (SQL_ECEL_OMITREF | SQL_ECEL_REF);
 			/*
-			 * Format for ephemeral space has been
-			 * already set with field count calculated
-			 * as orderBy->nExpr + pEList->nExpr + 1,
-			 * where pEList is a select list.
-			 * Since we want to reduce number of fields
-			 * in format of ephemeral space, we should
-			 * fix corresponding opcode's argument.
-			 * Otherwise, tuple format won't match
-			 * space format.
+			 * The sorter has been already opened with
+			 * field count calculated as orderBy->nExpr +
+			 * pEList->nExpr, where pEList is a select list.
+			 * Since the fields are omitted from the sorter
+			 * record, fix the corresponding opcode's
+			 * argument.
 			 */
 			uint32_t excess_field_count = 0;
 			struct VdbeOp *op = sqlVdbeGetOp(v,
 							 pSort->addrSortIndex);
+			assert(op->opcode == OP_SorterOpen);
 			for (i = pSort->nOBSat; i < pSort->pOrderBy->nExpr;
 			     i++) {
 				int j = pSort->pOrderBy->a[i].u.x.iOrderByCol;
@@ -1249,23 +1135,10 @@ selectInnerLoop(Parse * pParse,		/* The parser context */
 				excess_field_count++;
 				pEList->a[j - 1].u.x.iOrderByCol =
 					(uint16_t)(i + 1 - pSort->nOBSat);
-				if (op->opcode != OP_OpenTEphemeral)
-					continue;
-				struct sql_space_info *info = op->p4.space_info;
-				/* Mark fields to drop in info. */
-				info->types[j + pSort->pOrderBy->nExpr] =
-					field_type_MAX;
-			}
-			if (op->opcode != OP_OpenTEphemeral) {
-				assert(op->p2 - excess_field_count > 0);
-				sqlVdbeChangeP2(v, pSort->addrSortIndex,
-						op->p2 - excess_field_count);
-			} else {
-				struct sql_space_info *info = op->p4.space_info;
-				assert(info != NULL);
-				sql_space_info_normalize(info,
-							 excess_field_count);
 			}
+			assert(op->p2 - excess_field_count > 0);
+			sqlVdbeChangeP2(v, pSort->addrSortIndex,
+					op->p2 - excess_field_count);
 			regOrig = 0;
 			assert(eDest == SRT_Set || eDest == SRT_Mem
 			       || eDest == SRT_Coroutine
@@ -1782,7 +1655,6 @@ generateSortTail(Parse * pParse,	/* Parsing context */
 	int iSortTab;		/* Sorter cursor to read from */
 	int nSortData;		/* Trailing values to read from sorter */
 	int i;
-	int bSeq;		/* True if sorter record includes seq. no. */
 	struct ExprList_item *aOutEx = p->pEList->a;
 
 	assert(addrBreak < 0);
@@ -1803,30 +1675,18 @@ generateSortTail(Parse * pParse,	/* Parsing context */
 		nSortData = nColumn;
 	}
 	nKey = pOrderBy->nExpr - pSort->nOBSat;
-	if (pSort->sortFlags & SORTFLAG_UseSorter) {
-		int regSortOut = ++pParse->nMem;
-		iSortTab = pParse->nTab++;
-		if (pSort->labelBkOut)
-			addrOnce = sqlVdbeAddOp0(v, OP_Once);
-		sqlVdbeAddOp3(v, OP_OpenPseudo, iSortTab, regSortOut,
-				  nKey + 1 + nSortData);
-		if (addrOnce)
-			sqlVdbeJumpHere(v, addrOnce);
-		addr = 1 + sqlVdbeAddOp2(v, OP_SorterSort, iTab, addrBreak);
-		codeOffset(v, p->iOffset, addrContinue);
-		sqlVdbeAddOp3(v, OP_SorterData, iTab, regSortOut, iSortTab);
-		bSeq = 0;
-	} else {
-		/* In case of DESC sorting order data should be taken from
-		 * the end of table. */
-		int opPositioning = (pSort->sortFlags & SORTFLAG_DESC) ?
-				    OP_Last : OP_Sort;
-		addr = 1 + sqlVdbeAddOp2(v, opPositioning, iTab, addrBreak);
-		codeOffset(v, p->iOffset, addrContinue);
-		iSortTab = iTab;
-		bSeq = 1;
-	}
-	for (i = 0, iCol = nKey + bSeq; i < nSortData; i++) {
+	int regSortOut = ++pParse->nMem;
+	iSortTab = pParse->nTab++;
+	if (pSort->labelBkOut)
+		addrOnce = sqlVdbeAddOp0(v, OP_Once);
+	sqlVdbeAddOp3(v, OP_OpenPseudo, iSortTab, regSortOut,
+			  nKey + 1 + nSortData);
+	if (addrOnce)
+		sqlVdbeJumpHere(v, addrOnce);
+	addr = 1 + sqlVdbeAddOp2(v, OP_SorterSort, iTab, addrBreak);
+	codeOffset(v, p->iOffset, addrContinue);
+	sqlVdbeAddOp3(v, OP_SorterData, iTab, regSortOut, iSortTab);
+	for (i = 0, iCol = nKey; i < nSortData; i++) {
 		int iRead;
 		if (aOutEx[i].u.x.iOrderByCol) {
 			iRead = aOutEx[i].u.x.iOrderByCol - 1;
@@ -1890,18 +1750,11 @@ generateSortTail(Parse * pParse,	/* Parsing context */
 	/* The bottom of the loop
 	 */
 	sqlVdbeResolveLabel(v, addrContinue);
-	if (pSort->sortFlags & SORTFLAG_UseSorter) {
-		if (p->iLimit != 0) {
-			int iLimit = p->iOffset ? p->iOffset + 1 : p->iLimit;
-			sqlVdbeAddOp2(v, OP_DecrJumpZero, iLimit, addrBreak);
-		}
-		sqlVdbeAddOp2(v, OP_SorterNext, iTab, addr);
-	} else {
-		/* In case of DESC sorting cursor should move backward. */
-		int opPositioning = (pSort->sortFlags & SORTFLAG_DESC) ?
-				    OP_Prev : OP_Next;
-		sqlVdbeAddOp2(v, opPositioning, iTab, addr);
+	if (p->iLimit != 0) {
+		int iLimit = p->iOffset ? p->iOffset + 1 : p->iLimit;
+		sqlVdbeAddOp2(v, OP_DecrJumpZero, iLimit, addrBreak);
 	}
+	sqlVdbeAddOp2(v, OP_SorterNext, iTab, addr);
 	if (pSort->regReturn)
 		sqlVdbeAddOp1(v, OP_Return, pSort->regReturn);
 	sqlVdbeResolveLabel(v, addrBreak);
@@ -5839,16 +5692,14 @@ sqlSelect(Parse * pParse,		/* The parser context */
 #endif
 	}
 
-	/* If there is an ORDER BY clause, then create an ephemeral index to
-	 * do the sorting.  But this sorting ephemeral index might end up
-	 * being unused if the data can be extracted in pre-sorted order.
-	 * If that is the case, then the OP_OpenEphemeral instruction will be
-	 * changed to an OP_Noop once we figure out that the sorting index is
-	 * not needed.  The sSort.addrSortIndex variable is used to facilitate
-	 * that change.
+	/* If there is an ORDER BY clause, then open a sorter. But it might
+	 * end up being unused if the data can be extracted in pre-sorted
+	 * order. If that is the case, then the OP_SorterOpen instruction
+	 * will be changed to an OP_Noop once we figure out that the sorter
+	 * is not needed. The sSort.addrSortIndex variable is used to
+	 * facilitate that change.
 	 */
 	if (sSort.pOrderBy) {
-		sSort.reg_eph = ++pParse->nMem;
 		sSort.iECursor = pParse->nTab++;
 		struct sql_space_info *info =
 			sql_space_info_new_for_sorting(pParse, sSort.pOrderBy,
@@ -5857,14 +5708,14 @@ sqlSelect(Parse * pParse,		/* The parser context */
 			pParse->is_aborted = true;
 			goto select_end;
 		}
-		if (info->sort_orders[0] == SORT_ORDER_DESC)
-			sSort.sortFlags |= SORTFLAG_DESC;
+		struct sql_key_info *key_info =
+			sql_key_info_new_from_space_info(info);
 		sSort.addrSortIndex =
-			sqlVdbeAddOp4(v, OP_OpenTEphemeral, sSort.reg_eph, 0, 0,
-				      (char *)info, P4_DYNAMIC);
-
-		sqlVdbeAddOp3(v, OP_IteratorOpen, sSort.iECursor, 0, sSort.reg_eph);
-		VdbeComment((v, "Sort table"));
+			sqlVdbeAddOp4(v, OP_SorterOpen, sSort.iECursor,
+				      info->field_count, 0, (char *)key_info,
+				      P4_KEYINFO);
+		sql_xfree(info);
+		VdbeComment((v, "Sorter"));
 	} else {
 		sSort.addrSortIndex = -1;
 	}
@@ -5893,25 +5744,6 @@ sqlSelect(Parse * pParse,		/* The parser context */
 		p->nSelectRow = 320;	/* 4 billion rows */
 	}
 	computeLimitRegisters(pParse, p, iEnd);
-	/*
-	 * At the moment we don't have iterators where the fields are sorted in
-	 * a different order. Because of this, we have to sort all the data and
-	 * select only the required number of rows.
-	 */
-	if (sSort.addrSortIndex >= 0 &&
-	    (p->iLimit == 0 || !is_same_sorting_direction(sSort.pOrderBy))) {
-		struct VdbeOp *op = sqlVdbeGetOp(v, sSort.addrSortIndex);
-		struct sql_key_info *key_info =
-			sql_key_info_new_from_space_info(op->p4.space_info);
-		sqlVdbeChangeOpcode(v, sSort.addrSortIndex, OP_SorterOpen);
-		sqlVdbeChangeP1(v, sSort.addrSortIndex, sSort.iECursor);
-		sqlVdbeChangeP2(v, sSort.addrSortIndex,
-				op->p4.space_info->field_count);
-		sqlVdbeChangeP4(v, sSort.addrSortIndex, (char *)key_info,
-				P4_KEYINFO);
-		sqlVdbeChangeToNoop(v, sSort.addrSortIndex + 1);
-		sSort.sortFlags |= SORTFLAG_UseSorter;
-	}
 
 	/* Open an ephemeral index to use for the distinct set.
 	 */
@@ -5956,29 +5788,17 @@ sqlSelect(Parse * pParse,		/* The parser context */
 		}
 		if (sSort.pOrderBy) {
 			sSort.nOBSat = sqlWhereIsOrdered(pWInfo);
-			sSort.bOrderedInnerLoop =
-			    sqlWhereOrderedInnerLoop(pWInfo);
 			if (sSort.nOBSat == sSort.pOrderBy->nExpr) {
 				sSort.pOrderBy = 0;
 			}
 		}
 
-		/* If sorting index that was created by a prior OP_OpenEphemeral
-		 * instruction ended up not being needed, then change the OP_OpenEphemeral
-		 * into an OP_Noop.
+		/* If the sorter that was opened by a prior OP_SorterOpen
+		 * instruction ended up not being needed, then change the
+		 * OP_SorterOpen into an OP_Noop.
 		 */
-		if (sSort.addrSortIndex >= 0 && sSort.pOrderBy == 0) {
-			/*
-			 * To handle ordering two op-codes are
-			 * emitted: OpenTEphemeral & IteratorOpen.
-			 * sSort.addrSortIndex is address of
-			 * first insn in a couple. To evict
-			 * ephemral space, need to noop both
-			 * op-codes.
-			 */
+		if (sSort.addrSortIndex >= 0 && sSort.pOrderBy == 0)
 			sqlVdbeChangeToNoop(v, sSort.addrSortIndex);
-			sqlVdbeChangeToNoop(v, sSort.addrSortIndex + 1);
-		}
 
 		/* Use the standard inner loop. */
 		selectInnerLoop(pParse, p, pEList, -1, &sSort, &sDistinct,
@@ -6219,7 +6039,6 @@ sqlSelect(Parse * pParse,		/* The parser context */
 			    (groupBySort || sqlWhereIsSorted(pWInfo))) {
 				sSort.pOrderBy = 0;
 				sqlVdbeChangeToNoop(v, sSort.addrSortIndex);
-				sqlVdbeChangeToNoop(v, sSort.addrSortIndex + 1);
 			}
 
 			/* Evaluate the current GROUP BY terms and store in b0, b1, b2...
@@ -3025,6 +3025,16 @@ sql_table_delete_from(struct Parse *parse, struct SrcList *tab_list,
 void
 sql_table_truncate(struct Parse *parse, struct SrcList *tab_list);
 
+/**
+ * Generate a code for ANALYZE statement.
+ *
+ * @param parse Parsing context.
+ * @param tab_list List of single table to analyze or NULL to
+ *        analyze all user tables.
+ */
+void
+sql_analyze(struct Parse *parse, struct SrcList *tab_list);
+
 void sqlUpdate(Parse *, SrcList *, ExprList *, Expr *,
 		   enum on_conflict_action);
 WhereInfo *sqlWhereBegin(Parse *, SrcList *, Expr *, ExprList *, ExprList *,
@@ -94,6 +94,19 @@ sql_delete_by_key(struct space *space, uint32_t iid, char *key,
 
 int tarantoolsqlClearTable(struct space *space, uint32_t *tuple_count);
 
+/**
+ * Collect statistics used by the query planner for all TREE
+ * indexes of the space, except multikey and functional ones,
+ * replacing the statistics collected before. The statistics are
+ * kept in memory only.
+ *
+ * @param space_id Identifier of the space to analyze.
+ *
+ * @retval 0 on success, -1 otherwise.
+ */
+int
+sql_analyze_space(uint32_t space_id);
+
 /**
  * Rename the table in _space.
  * @param space_id Table's space identifier.
@@ -290,7 +290,9 @@ vdbe_field_ref_closest_slotno(struct vdbe_field_ref *field_ref,
 static const char *
 vdbe_field_ref_fetch_data(struct vdbe_field_ref *field_ref, uint32_t fieldno)
 {
-	if (field_ref->slots[fieldno] != 0 || fieldno == 0)
+	if (fieldno < 64 ?
+	    bitmask64_is_bit_set(field_ref->slot_bitmask, fieldno) :
+	    field_ref->slots[fieldno] != 0)
 		return field_ref->data + field_ref->slots[fieldno];
 
 	const char *field_begin;
@@ -308,7 +310,8 @@ vdbe_field_ref_fetch_data(struct vdbe_field_ref *field_ref, uint32_t fieldno)
 			 * Try to find the biggest initialized
 			 * slot.
 			 */
-			for (uint32_t it = fieldno - 1; it > prev; it--) {
+			for (uint32_t it = fieldno - 1; it > prev && it >= 64;
+			     it--) {
 				if (field_ref->slots[it] == 0)
 					continue;
 				prev = it;
@@ -1465,7 +1468,8 @@ case OP_Ne: {             /* same as TK_NE, jump, in1, in3 */
 		break;
 	}
 	int cmp_res;
-	if (mem_cmp(pIn3, pIn1, &cmp_res, pOp->p4.pColl) != 0)
+	if (!mem_cmp_fast(pIn3, pIn1, &cmp_res, pOp->p4.pColl) &&
+	    mem_cmp(pIn3, pIn1, &cmp_res, pOp->p4.pColl) != 0)
 		goto abort_due_to_error;
 	bool result = pOp->opcode == OP_Eq ? cmp_res == 0 : cmp_res != 0;
 	if ((pOp->p5 & SQL_STOREP2) != 0) {
@@ -1525,7 +1529,8 @@ case OP_Ge: {             /* same as TK_GE, jump, in1, in3 */
 		break;
 	}
 	int cmp_res;
-	if (mem_cmp(pIn3, pIn1, &cmp_res, pOp->p4.pColl) != 0)
+	if (!mem_cmp_fast(pIn3, pIn1, &cmp_res, pOp->p4.pColl) &&
+	    mem_cmp(pIn3, pIn1, &cmp_res, pOp->p4.pColl) != 0)
 		goto abort_due_to_error;
 
 	bool result;
@@ -2467,6 +2472,26 @@ case OP_IteratorOpen: {
 	break;
 }
 
+/* Opcode: CursorFilter P1 P2 P3 P4 P5
+ * Synopsis: field P2 cmp r[P3]
+ *
+ * Make the cursor P1 skip tuples for which the comparison P5 of the
+ * field P2 with the register P3 using the collation P4 is known to
+ * be false or NULL. P5 is one of OP_Eq, OP_Ne, OP_Lt, OP_Le, OP_Gt
+ * and OP_Ge. The register is read each time a tuple is fetched, so
+ * it may be changed until the cursor is positioned. The filter only
+ * saves returning the tuples to the VDBE, the comparison must be
+ * coded as well.
+ */
+case OP_CursorFilter: {
+	struct VdbeCursor *cur = p->apCsr[pOp->p1];
+	assert(cur != NULL && cur->eCurType == CURTYPE_TARANTOOL);
+	assert(pOp->p4type == P4_COLLSEQ);
+	sql_cursor_add_filter(cur->uc.pCursor, pOp->p2, pOp->p5,
+			      &aMem[pOp->p3], pOp->p4.pColl);
+	break;
+}
+
 /**
  * Opcode: OP_OpenSpace P1 P2 * * *
  * Synopsis: reg[P1] = space_by_id(P2)
@@ -2483,13 +2508,16 @@ case OP_OpenSpace: {
 }
 
 /**
- * Opcode: OpenTEphemeral P1 * * P4 *
+ * Opcode: OpenTEphemeral P1 P2 * P4 *
  * Synopsis:
  * @param P1 register, where pointer to new space is stored.
+ * @param P2 if not 0, the space is filled in the bulk build mode.
  * @param P4 key def for new table, NULL is allowed.
  *
  * This opcode creates Tarantool's ephemeral table and stores pointer
- * to it into P1 register.
+ * to it into P1 register. If P2 is not 0, inserted tuples are only
+ * collected and the index is built at once by OP_EndBuild, so the
+ * tuples must be unique and the space must not be read before that.
  */
 case OP_OpenTEphemeral: {
 	assert(pOp->p1 >= 0);
@@ -2501,10 +2529,27 @@ case OP_OpenTEphemeral: {
 
 	if (space == NULL)
 		goto abort_due_to_error;
+	if (pOp->p2 != 0)
+		space_ephemeral_begin_build(space);
 	mem_set_ptr(&aMem[pOp->p1], space);
 	break;
 }
 
+/**
+ * Opcode: EndBuild P1 * * * *
+ * Synopsis: space=r[P1]
+ * @param P1 register, where pointer to the ephemeral space is stored.
+ *
+ * Build the index of an ephemeral space opened by OP_OpenTEphemeral
+ * in the bulk build mode.
+ */
+case OP_EndBuild: {
+	struct space *space = aMem[pOp->p1].u.p;
+	assert(space != NULL && space->def->opts.is_ephemeral);
+	space_ephemeral_end_build(space);
+	break;
+}
+
 /* Opcode: SorterOpen P1 P2 P3 P4 *
  *
  * This opcode works like OP_OpenEphemeral except that it opens
@@ -3499,12 +3544,15 @@ case OP_Next:          /* jump */
 	break;
 }
 
-/* Opcode: SorterInsert P1 P2 * * *
+/* Opcode: SorterInsert P1 P2 P3 * *
  * Synopsis: key=r[P2]
  *
  * Register P2 holds an SQL index key made using the
  * MakeRecord instructions.  This opcode writes that key
  * into the sorter P1.  Data for the entry is nil.
+ *
+ * If P3 is not 0, register P3 holds the number of the least
+ * keys the sorter must return, so it may drop greater keys.
  */
 case OP_SorterInsert: {      /* in2 */
 	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
@@ -3513,7 +3561,12 @@ case OP_SorterInsert: {      /* in2 */
 	assert(isSorter(cursor));
 	pIn2 = &aMem[pOp->p2];
 	assert(mem_is_bin(pIn2));
-	if (sqlVdbeSorterWrite(cursor, pIn2) != 0)
+	uint64_t limit = 0;
+	if (pOp->p3 != 0) {
+		assert(mem_is_uint(&aMem[pOp->p3]));
+		limit = aMem[pOp->p3].u.u;
+	}
+	if (sqlVdbeSorterWrite(cursor, pIn2, limit) != 0)
 		goto abort_due_to_error;
 	break;
 }
@@ -3897,6 +3950,30 @@ case OP_Clear: {
 	break;
 }
 
+/* Opcode: Analyze P1 P2 * * *
+ * Synopsis: space id = r[P1]
+ *
+ * Collect statistics of indexes of the space with the identifier
+ * from register P1 for the query planner. If P2 is not 0, skip
+ * the space silently if it doesn't exist or the current user
+ * can't read it.
+ */
+case OP_Analyze: {
+	uint32_t space_id = aMem[pOp->p1].u.i;
+	if (pOp->p2 != 0) {
+		struct space *space = space_by_id(space_id);
+		if (space == NULL)
+			break;
+		if (access_check_space(space, PRIV_R) != 0) {
+			diag_clear(diag_get());
+			break;
+		}
+	}
+	if (sql_analyze_space(space_id) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
 /* Opcode: ResetSorter P1 * * * *
  *
  * Delete all contents from the ephemeral table or sorter
@@ -375,7 +375,7 @@ int
 sqlVdbeSorterNext(const struct VdbeCursor *pCsr, int *pbEof);
 
 int sqlVdbeSorterRewind(const VdbeCursor *, int *);
-int sqlVdbeSorterWrite(const VdbeCursor *, Mem *);
+int sqlVdbeSorterWrite(const VdbeCursor *, Mem *, uint64_t limit);
 int sqlVdbeSorterCompare(const VdbeCursor *, Mem *, int, int *);
 
 int sqlVdbeMemTranslate(Mem *, u8);
@@ -173,6 +173,7 @@ typedef struct SortSubtask SortSubtask;	/* A sub-task in the sort process */
 typedef struct SorterFile SorterFile;	/* Temporary file object wrapper */
 typedef struct SorterList SorterList;	/* In-memory list of records */
 typedef struct IncrMerger IncrMerger;	/* Read & merge multiple PMAs */
+typedef struct SorterHeapNode SorterHeapNode;	/* A record in a top-N heap */
 
 /*
  * A container for a temp file handle and the current amount of data
@@ -317,6 +318,14 @@ struct VdbeSorter {
 	int nMemory;		/* Size of list.aMemory allocation in bytes */
 	u8 bUsePMA;		/* True if one or more PMAs created */
 	SortSubtask aTask;	/* A single subtask */
+	/*
+	 * Max-heap of the least records written with a limit, see
+	 * sqlVdbeSorterWrite(). Used instead of the list.
+	 */
+	SorterHeapNode *aHeap;
+	u32 nHeap;		/* Number of records in aHeap */
+	u32 nHeapAlloc;	/* Number of records aHeap has room for */
+	u64 iHeapSeq;		/* Sequence number of the next heap record */
 };
 
 /*
@@ -439,6 +448,23 @@ struct SorterRecord {
 /* Maximum number of PMAs that a single MergeEngine can merge */
 #define SORTER_MAX_MERGE_COUNT 16
 
+/*
+ * A record kept in the heap of a sorter written with a limit. Records
+ * with equal keys are ordered by the sequence number, so the records
+ * written first are returned, like with a stable sort.
+ */
+struct SorterHeapNode {
+	SorterRecord *pRecord;	/* The record, allocated separately */
+	u64 iSeq;		/* Number of the record in the write order */
+};
+
+/*
+ * Max LIMIT + OFFSET served by keeping the least records in a heap.
+ * Bigger limits are served by the ordinary sort, which can spill the
+ * records to disk.
+ */
+#define SORTER_HEAP_MAX_LIMIT (1 << 16)
+
 static int vdbeIncrSwap(IncrMerger *);
 static void vdbeIncrFree(IncrMerger *);
 
@@ -917,6 +943,10 @@ sqlVdbeSorterReset(struct VdbeSorter *pSorter)
 	pSorter->bUsePMA = 0;
 	pSorter->iMemory = 0;
 	pSorter->mxKeysize = 0;
+	for (u32 i = 0; i < pSorter->nHeap; i++)
+		sql_xfree(pSorter->aHeap[i].pRecord);
+	pSorter->nHeap = 0;
+	pSorter->iHeapSeq = 0;
 	sql_xfree(pSorter->pUnpacked);
 	pSorter->pUnpacked = 0;
 }
@@ -930,6 +960,7 @@ sqlVdbeSorterClose(struct VdbeCursor *pCsr)
 	if (pSorter) {
 		sqlVdbeSorterReset(pSorter);
 		free(pSorter->list.aMemory);
+		free(pSorter->aHeap);
 		sql_xfree(pSorter);
 		pCsr->uc.pSorter = 0;
 	}
@@ -1369,11 +1400,152 @@ vdbeSorterFlushPMA(VdbeSorter * pSorter)
 }
 
 /*
- * Add a record to the sorter.
+ * Compare two records of a sorter heap. Records with equal keys
+ * are compared by their sequence numbers.
+ */
+static int
+vdbeSorterHeapCompare(SortSubtask * pTask, const SorterHeapNode * a,
+		      const SorterHeapNode * b)
+{
+	bool bCached = false;
+	int res = pTask->xCompare(pTask, &bCached, SRVAL(a->pRecord),
+				  SRVAL(b->pRecord));
+	if (res != 0)
+		return res;
+	return a->iSeq < b->iSeq ? -1 : a->iSeq > b->iSeq;
+}
+
+/*
+ * Restore the heap order moving the record at position i towards
+ * the leaves.
+ */
+static void
+vdbeSorterHeapSiftDown(VdbeSorter * pSorter, u32 i)
+{
+	SortSubtask *pTask = &pSorter->aTask;
+	SorterHeapNode *aHeap = pSorter->aHeap;
+	SorterHeapNode node = aHeap[i];
+	for (;;) {
+		u32 child = 2 * i + 1;
+		if (child >= pSorter->nHeap)
+			break;
+		if (child + 1 < pSorter->nHeap &&
+		    vdbeSorterHeapCompare(pTask, &aHeap[child + 1],
+					  &aHeap[child]) > 0)
+			child++;
+		if (vdbeSorterHeapCompare(pTask, &aHeap[child], &node) <= 0)
+			break;
+		aHeap[i] = aHeap[child];
+		i = child;
+	}
+	aHeap[i] = node;
+}
+
+/*
+ * Restore the heap order moving the record at position i towards
+ * the root.
+ */
+static void
+vdbeSorterHeapSiftUp(VdbeSorter * pSorter, u32 i)
+{
+	SortSubtask *pTask = &pSorter->aTask;
+	SorterHeapNode *aHeap = pSorter->aHeap;
+	SorterHeapNode node = aHeap[i];
+	while (i > 0) {
+		u32 parent = (i - 1) / 2;
+		if (vdbeSorterHeapCompare(pTask, &aHeap[parent], &node) >= 0)
+			break;
+		aHeap[i] = aHeap[parent];
+		i = parent;
+	}
+	aHeap[i] = node;
+}
+
+/*
+ * Add a record to a sorter that has to return only the limit least
+ * records. The records are kept in a max-heap of the limit size, so
+ * once the heap is full, a record that is not less than the greatest
+ * one is dropped right away while a lesser record replaces it. This
+ * takes O(log(limit)) comparisons per record and bounds the memory
+ * used by the sorter.
+ */
+static int
+vdbeSorterHeapWrite(VdbeSorter * pSorter, Mem * pVal, u32 limit)
+{
+	SortSubtask *pTask = &pSorter->aTask;
+	assert(limit > 0);
+	assert(pSorter->list.pList == NULL && !pSorter->bUsePMA);
+	vdbeSortAllocUnpacked(pTask);
+	pTask->xCompare = vdbeSorterGetCompare(pSorter);
+	if (pSorter->list.aMemory != NULL) {
+		/*
+		 * The records are allocated separately, so that
+		 * they can be freed one by one.
+		 */
+		free(pSorter->list.aMemory);
+		pSorter->list.aMemory = NULL;
+		pSorter->nMemory = 0;
+	}
+	if (pSorter->nHeap >= limit) {
+		/*
+		 * The new record is the last written one, so it's
+		 * greater than the heap top if their keys are equal.
+		 */
+		bool bCached = false;
+		if (pTask->xCompare(pTask, &bCached, pVal->z,
+				    SRVAL(pSorter->aHeap[0].pRecord)) >= 0)
+			return 0;
+	}
+	SorterHeapNode node;
+	node.pRecord = xmalloc(pVal->n + sizeof(SorterRecord));
+	node.pRecord->nVal = pVal->n;
+	node.pRecord->u.pNext = NULL;
+	memcpy(SRVAL(node.pRecord), pVal->z, pVal->n);
+	node.iSeq = pSorter->iHeapSeq++;
+	if (pSorter->nHeap >= limit) {
+		sql_xfree(pSorter->aHeap[0].pRecord);
+		pSorter->aHeap[0] = node;
+		vdbeSorterHeapSiftDown(pSorter, 0);
+		return 0;
+	}
+	if (pSorter->nHeap == pSorter->nHeapAlloc) {
+		u32 nNew = MIN(MAX(2 * pSorter->nHeapAlloc, 16), limit);
+		pSorter->aHeap = xrealloc(pSorter->aHeap,
+					  nNew * sizeof(SorterHeapNode));
+		pSorter->nHeapAlloc = nNew;
+	}
+	pSorter->aHeap[pSorter->nHeap] = node;
+	vdbeSorterHeapSiftUp(pSorter, pSorter->nHeap++);
+	return 0;
+}
+
+/*
+ * Move the records from the heap of a sorter written with a limit
+ * to the in-memory list in the sorted order.
+ */
+static void
+vdbeSorterHeapToList(VdbeSorter * pSorter)
+{
+	SorterRecord *pList = NULL;
+	while (pSorter->nHeap > 0) {
+		SorterRecord *p = pSorter->aHeap[0].pRecord;
+		pSorter->aHeap[0] = pSorter->aHeap[--pSorter->nHeap];
+		if (pSorter->nHeap > 0)
+			vdbeSorterHeapSiftDown(pSorter, 0);
+		p->u.pNext = pList;
+		pList = p;
+	}
+	pSorter->list.pList = pList;
+}
+
+/*
+ * Add a record to the sorter. If the limit is not 0, the sorter is
+ * allowed to return only the limit least records.
  */
 int
 sqlVdbeSorterWrite(const VdbeCursor * pCsr,	/* Sorter cursor */
-		       Mem * pVal	/* Memory cell containing record */
+		       Mem * pVal,	/* Memory cell containing record */
+		       uint64_t limit	/* Number of records needed or 0 */
     )
 {
 	VdbeSorter *pSorter;
@@ -1387,6 +1559,12 @@ sqlVdbeSorterWrite(const VdbeCursor * pCsr,	/* Sorter cursor */
 	pSorter = pCsr->uc.pSorter;
 	assert(pSorter);
 
+	/* If only a few least records are needed, keep them in a heap. */
+	if (pSorter->nHeap > 0 ||
+	    (limit > 0 && limit <= SORTER_HEAP_MAX_LIMIT &&
+	     pSorter->list.pList == NULL && !pSorter->bUsePMA))
+		return vdbeSorterHeapWrite(pSorter, pVal, limit);
+
 	/* Figure out whether or not the current contents of memory should be
 	 * flushed to a PMA before continuing. If so, do so.
 	 *
@@ -1968,6 +2146,11 @@ sqlVdbeSorterRewind(const VdbeCursor * pCsr, int *pbEof)
 	 * sort the VdbeSorter.pRecord list. The vdbe layer will read data directly
 	 * from the in-memory list.
 	 */
+	if (pSorter->nHeap > 0) {
+		vdbeSorterHeapToList(pSorter);
+		*pbEof = 0;
+		return 0;
+	}
 	if (pSorter->bUsePMA == 0) {
 		if (pSorter->list.pList) {
 			*pbEof = 0;
@@ -910,7 +910,13 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	struct sql_space_info *info = sql_space_info_new_from_index_def(idx_def,
 									true);
 	int reg_eph = sqlGetTempReg(pParse);
-	sqlVdbeAddOp4(v, OP_OpenTEphemeral, reg_eph, 0, 0, (char *)info,
+	/*
+	 * Rows of the index are unique due to rowid and the index
+	 * isn't read until it's filled up, so collect all rows and
+	 * then build the index at once instead of inserting them one
+	 * by one, which is much cheaper for big tables.
+	 */
+	sqlVdbeAddOp4(v, OP_OpenTEphemeral, reg_eph, 1, 0, (char *)info,
 		      P4_DYNAMIC);
 	sqlVdbeAddOp3(v, OP_IteratorOpen, pLevel->iIdxCur, 0, reg_eph);
 	VdbeComment((v, "for %s", space->def->name));
@@ -927,6 +933,7 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	sqlVdbeAddOp2(v, OP_Next, cursor, addrTop + 1);
 	sqlVdbeChangeP5(v, SQL_STMTSTATUS_AUTOINDEX);
 	sqlVdbeJumpHere(v, addrTop);
+	sqlVdbeAddOp1(v, OP_EndBuild, reg_eph);
 	sqlReleaseTempReg(pParse, regRecord);
 	sqlReleaseTempReg(pParse, reg_eph);
 	sqlExprCachePop(pParse);
@@ -38,6 +38,7 @@
  * that actually generate the bulk of the WHERE loop code.  The original where.c
  * file retains the code that does query planning and analysis.
  */
+#include "box/coll_id_cache.h"
 #include "box/schema.h"
 #include "sqlInt.h"
 #include "whereInt.h"
@@ -658,6 +659,95 @@ codeExprOrVector(Parse * pParse, Expr * p, int iReg, int nReg)
 	}
 }
 
+/*
+ * Push comparisons of columns of a table that is scanned completely
+ * with values that are known before the scan down into the cursor of
+ * the table, see OP_CursorFilter. The cursor then skips most of the
+ * tuples not matching the comparisons without returning them to the
+ * VDBE. The comparisons are still coded after the loop start.
+ */
+static void
+whereLoopPushFilters(WhereInfo * pWInfo, WhereLevel * pLevel, int iCur,
+		     Bitmask notReady)
+{
+	Parse *pParse = pWInfo->pParse;
+	Vdbe *v = pParse->pVdbe;
+	WhereClause *pWC = &pWInfo->sWC;
+	struct SrcList_item *pTabItem = &pWInfo->pTabList->a[pLevel->iFrom];
+	struct space_def *def = pTabItem->space->def;
+	if (def->id == 0 || def->opts.is_view || pLevel->iLeftJoin)
+		return;
+	/* Comparisons pushed down into the cursor. */
+	struct {
+		int reg;
+		int iColumn;
+		int op;
+		struct coll *coll;
+	} aFilter[SQL_CURSOR_FILTER_MAX];
+	int nFilter = 0;
+	WhereTerm *pTerm;
+	int j;
+	for (pTerm = pWC->a, j = pWC->nTerm; j > 0; j--, pTerm++) {
+		if (nFilter == SQL_CURSOR_FILTER_MAX)
+			break;
+		if (pTerm->wtFlags & (TERM_VIRTUAL | TERM_CODED))
+			continue;
+		/* The term is coded at a later level. */
+		if ((pTerm->prereqAll & pLevel->notReady) != 0)
+			continue;
+		Expr *pE = pTerm->pExpr;
+		/*
+		 * An ON term of a LEFT JOIN must not filter out the
+		 * rows of the left table.
+		 */
+		if (ExprHasProperty(pE, EP_FromJoin))
+			continue;
+		if (pE->op != TK_EQ && pE->op != TK_NE && pE->op != TK_LT &&
+		    pE->op != TK_LE && pE->op != TK_GT && pE->op != TK_GE)
+			continue;
+		Expr *pLeft = pE->pLeft;
+		Expr *pRight = pE->pRight;
+		if (pLeft->op != TK_COLUMN || pLeft->iTable != iCur ||
+		    pLeft->iColumn < 0 || sqlExprIsVector(pRight))
+			continue;
+		/* Comparisons of ANY values are left to the VDBE. */
+		if (def->fields[pLeft->iColumn].type == FIELD_TYPE_ANY)
+			continue;
+		/* The value must be known before the scan. */
+		if (!sqlExprIsConstant(pRight) &&
+		    (pRight->op != TK_COLUMN ||
+		     (sqlWhereExprUsage(&pWInfo->sMaskSet, pRight) &
+		      notReady) != 0))
+			continue;
+		uint32_t coll_id;
+		if (sql_binary_compare_coll_seq(pParse, pLeft, pRight,
+						&coll_id) != 0)
+			return;
+		/*
+		 * The value may depend on outer loops, so it's
+		 * evaluated each time the scan is started.
+		 */
+		aFilter[nFilter].reg = ++pParse->nMem;
+		sqlExprCode(pParse, pRight, aFilter[nFilter].reg);
+		aFilter[nFilter].iColumn = pLeft->iColumn;
+		/* Comparison opcodes are the same as the tokens. */
+		aFilter[nFilter].op = pE->op;
+		aFilter[nFilter].coll = coll_by_id(coll_id)->coll;
+		nFilter++;
+	}
+	/*
+	 * The filters are added each time the scan is started: the
+	 * cursor may be reopened in a loop, and a reopened cursor has
+	 * no filters.
+	 */
+	for (j = 0; j < nFilter; j++) {
+		sqlVdbeAddOp4(v, OP_CursorFilter, iCur, aFilter[j].iColumn,
+			      aFilter[j].reg, (char *)aFilter[j].coll,
+			      P4_COLLSEQ);
+		sqlVdbeChangeP5(v, aFilter[j].op);
+	}
+}
+
 /*
  * Generate code for the start of the iLevel-th loop in the WHERE clause
  * implementation described by pWInfo.
@@ -1291,6 +1381,7 @@ sqlWhereCodeOneLoopStart(WhereInfo * pWInfo,	/* Complete information about the W
 			 */
 			pLevel->op = OP_Noop;
 		} else {
+			whereLoopPushFilters(pWInfo, pLevel, iCur, notReady);
 			pLevel->op = aStep[bRev];
 			pLevel->p1 = iCur;
 			pLevel->p2 =
@@ -35,6 +35,9 @@
 #include "execute.h"
 #include "diag.h"
 #include "info/info.h"
+#include "schema.h"
+#include "session.h"
+#include "sql/sqlInt.h"
 
 static struct sql_stmt_cache sql_stmt_cache;
 
@@ -45,6 +48,11 @@ sql_stmt_cache_init(void)
 	sql_stmt_cache.mem_quota = 0;
 	sql_stmt_cache.mem_used = 0;
 	rlist_create(&sql_stmt_cache.gc_queue);
+	sql_stmt_cache.plan_hash = mh_i32ptr_new();
+	rlist_create(&sql_stmt_cache.plan_lru);
+	sql_stmt_cache.plan_mem_used = 0;
+	sql_stmt_cache.plan_hits = 0;
+	sql_stmt_cache.plan_misses = 0;
 }
 
 void
@@ -59,6 +67,13 @@ sql_stmt_cache_stat(struct info_handler *h)
 		entry_count++;
 	info_append_int(h, "stmt_count", entry_count);
 	info_table_end(h);
+	info_table_begin(h, "plan_cache");
+	info_append_int(h, "size", sql_stmt_cache.plan_mem_used);
+	info_append_int(h, "stmt_count",
+			mh_size(sql_stmt_cache.plan_hash));
+	info_append_int(h, "hits", sql_stmt_cache.plan_hits);
+	info_append_int(h, "misses", sql_stmt_cache.plan_misses);
+	info_table_end(h);
 	info_end(h);
 }
 
@@ -272,6 +287,128 @@ sql_stmt_cache_find(uint32_t stmt_id)
 	return entry->stmt;
 }
 
+/** Remove an entry from the plan cache and delete its statement. */
+static void
+sql_plan_cache_delete(struct plan_cache_entry *entry, uint32_t stmt_id)
+{
+	assert(!sql_stmt_busy(entry->stmt));
+	struct mh_i32ptr_t *hash = sql_stmt_cache.plan_hash;
+	mh_int_t i = mh_i32ptr_find(hash, stmt_id, NULL);
+	assert(i != mh_end(hash));
+	assert(mh_i32ptr_node(hash, i)->val == entry);
+	mh_i32ptr_del(hash, i, NULL);
+	rlist_del(&entry->in_lru);
+	sql_stmt_cache.plan_mem_used -= sql_stmt_est_size(entry->stmt) +
+					sizeof(*entry);
+	sql_stmt_finalize(entry->stmt);
+	TRASH(entry);
+	free(entry);
+}
+
+/**
+ * Evict the least recently used statements that aren't being
+ * executed from the plan cache until there's @a size bytes of
+ * free space in it. Returns false if there's still not enough
+ * space after that.
+ */
+static bool
+sql_plan_cache_reserve(size_t size)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	struct plan_cache_entry *entry, *prev;
+	rlist_foreach_entry_safe_reverse(entry, &cache->plan_lru,
+					 in_lru, prev) {
+		if (cache->plan_mem_used + size <= cache->mem_quota)
+			break;
+		if (sql_stmt_busy(entry->stmt))
+			continue;
+		const char *sql_str = sql_stmt_query_str(entry->stmt);
+		sql_plan_cache_delete(entry, sql_stmt_calculate_id(
+					sql_str, strlen(sql_str)));
+	}
+	return cache->plan_mem_used + size <= cache->mem_quota;
+}
+
+struct Vdbe *
+sql_plan_cache_find(const char *sql_str, uint32_t len)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, len);
+	mh_int_t i = mh_i32ptr_find(cache->plan_hash, stmt_id, NULL);
+	if (i == mh_end(cache->plan_hash))
+		return NULL;
+	struct plan_cache_entry *entry =
+		mh_i32ptr_node(cache->plan_hash, i)->val;
+	struct Vdbe *stmt = entry->stmt;
+	const char *stmt_str = sql_stmt_query_str(stmt);
+	struct session *session = current_session();
+	if (strlen(stmt_str) != len || memcmp(stmt_str, sql_str, len) != 0 ||
+	    entry->sql_flags != session->sql_flags ||
+	    entry->sql_default_engine != session->sql_default_engine ||
+	    sql_stmt_busy(stmt))
+		return NULL;
+	if (sql_stmt_schema_version(stmt) != box_schema_version()) {
+		sql_plan_cache_delete(entry, stmt_id);
+		return NULL;
+	}
+	rlist_move(&cache->plan_lru, &entry->in_lru);
+	cache->plan_hits++;
+	return stmt;
+}
+
+int
+sql_plan_cache_insert(struct Vdbe *stmt)
+{
+	struct sql_stmt_cache *cache = &sql_stmt_cache;
+	if (sql_column_count(stmt) == 0)
+		return -1;
+	const char *sql_str = sql_stmt_query_str(stmt);
+	uint32_t stmt_id = sql_stmt_calculate_id(sql_str, strlen(sql_str));
+	mh_int_t i = mh_i32ptr_find(cache->plan_hash, stmt_id, NULL);
+	if (i != mh_end(cache->plan_hash)) {
+		/*
+		 * A statement compiled in another session or for
+		 * another string with the same hash. Replace it
+		 * unless it's being executed.
+		 */
+		struct plan_cache_entry *old =
+			mh_i32ptr_node(cache->plan_hash, i)->val;
+		if (sql_stmt_busy(old->stmt))
+			return -1;
+		sql_plan_cache_delete(old, stmt_id);
+	}
+	size_t size = sql_stmt_est_size(stmt) + sizeof(struct plan_cache_entry);
+	if (!sql_plan_cache_reserve(size))
+		return -1;
+	struct plan_cache_entry *entry = malloc(sizeof(*entry));
+	if (entry == NULL)
+		return -1;
+	struct session *session = current_session();
+	entry->stmt = stmt;
+	entry->sql_flags = session->sql_flags;
+	entry->sql_default_engine = session->sql_default_engine;
+	const struct mh_i32ptr_node_t id_node = { stmt_id, entry };
+	mh_i32ptr_put(cache->plan_hash, &id_node, NULL, NULL);
+	rlist_add_entry(&cache->plan_lru, entry, in_lru);
+	cache->plan_mem_used += size;
+	cache->plan_misses++;
+	return 0;
+}
+
+void
+sql_plan_cache_flush(void)
+{
+	struct plan_cache_entry *entry, *next;
+	rlist_foreach_entry_safe(entry, &sql_stmt_cache.plan_lru,
+				 in_lru, next) {
+		if (sql_stmt_busy(entry->stmt))
+			continue;
+		const char *sql_str = sql_stmt_query_str(entry->stmt);
+		sql_plan_cache_delete(entry, sql_stmt_calculate_id(
+					sql_str, strlen(sql_str)));
+	}
+}
+
 int
 sql_stmt_cache_set_size(size_t size)
 {
@@ -284,5 +421,6 @@ sql_stmt_cache_set_size(size_t size)
 		return -1;
 	}
 	sql_stmt_cache.mem_quota = size;
+	sql_plan_cache_reserve(0);
 	return 0;
 }
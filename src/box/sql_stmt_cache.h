@@ -57,6 +57,22 @@ struct stmt_cache_entry {
 	uint32_t refs;
 };
 
+/**
+ * Entry of the cache of statements compiled for unprepared
+ * execution. Unlike prepared statements, these entries aren't
+ * referenced by sessions and are evicted in the LRU order.
+ */
+struct plan_cache_entry {
+	/** Compiled statement. */
+	struct Vdbe *stmt;
+	/** Session SQL flags the statement was compiled with. */
+	uint32_t sql_flags;
+	/** Session default engine the statement was compiled with. */
+	uint8_t sql_default_engine;
+	/** Link in sql_stmt_cache::plan_lru. */
+	struct rlist in_lru;
+};
+
 /**
  * Global prepared statements holder.
  */
@@ -81,6 +97,19 @@ struct sql_stmt_cache {
 	 * times.
 	 */
 	struct stmt_cache_entry *last_found;
+	/** Query id -> struct plan_cache_entry hash. */
+	struct mh_i32ptr_t *plan_hash;
+	/** Plan cache entries, most recently used first. */
+	struct rlist plan_lru;
+	/**
+	 * Size of memory occupied by the plan cache. It's limited
+	 * by the same quota as the prepared statements.
+	 */
+	size_t plan_mem_used;
+	/** Number of executions that reused a cached plan. */
+	int64_t plan_hits;
+	/** Number of executions that compiled and cached a plan. */
+	int64_t plan_misses;
 };
 
 /**
@@ -142,6 +171,34 @@ struct Vdbe *
 sql_stmt_cache_find(uint32_t stmt_id);
 
 
+/**
+ * Find a statement compiled for the given SQL string by
+ * sql_plan_cache_insert() that can be executed in the current
+ * session. A statement compiled for an older schema is evicted.
+ * Returns NULL if there is no such statement or it's being
+ * executed.
+ */
+struct Vdbe *
+sql_plan_cache_find(const char *sql_str, uint32_t len);
+
+/**
+ * Save a statement compiled for unprepared execution in the
+ * current session to the plan cache, evicting the least recently
+ * used statements if the cache is full. Only statements returning
+ * rows are cached. Returns 0 if the statement was cached and now
+ * belongs to the cache, -1 otherwise. Never sets diag.
+ */
+int
+sql_plan_cache_insert(struct Vdbe *stmt);
+
+/**
+ * Evict all statements that aren't being executed from the plan
+ * cache, e.g. because the statistics they were planned with have
+ * changed.
+ */
+void
+sql_plan_cache_flush(void);
+
 /** Set prepared cache size limit. */
 int
 sql_stmt_cache_set_size(size_t size);
@@ -30,6 +30,10 @@
  */
 #include "tuple.h"
 
+#include <errno.h>
+#include <stdio.h>
+#include <sys/mman.h>
+
 #include "trivia/util.h"
 #include "memory.h"
 #include "fiber.h"
@@ -428,6 +432,45 @@ tuple_arena_destroy(struct slab_arena *arena)
 	slab_arena_destroy(arena);
 }
 
+int
+tuple_arena_use_hugepages(struct slab_arena *arena)
+{
+#if defined(HAVE_MADV_HUGEPAGE)
+	if (madvise(arena->arena, arena->prealloc, MADV_HUGEPAGE) == 0)
+		return 0;
+#else
+	(void)arena;
+	errno = ENOTSUP;
+#endif
+	diag_set(SystemError, "failed to enable transparent huge pages");
+	return -1;
+}
+
+ssize_t
+tuple_arena_hugepages_used(struct slab_arena *arena)
+{
+	FILE *f = fopen("/proc/self/smaps", "r");
+	if (f == NULL) {
+		diag_set(SystemError, "failed to open /proc/self/smaps");
+		return -1;
+	}
+	uintptr_t begin = (uintptr_t)arena->arena;
+	uintptr_t end = begin + arena->prealloc;
+	bool in_arena = false;
+	size_t used = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), f) != NULL) {
+		unsigned long vma_begin, vma_end, kb;
+		if (sscanf(line, "%lx-%lx ", &vma_begin, &vma_end) == 2)
+			in_arena = vma_begin < end && vma_end > begin;
+		else if (in_arena &&
+			 sscanf(line, "AnonHugePages: %lu kB", &kb) == 1)
+			used += kb * 1024;
+	}
+	fclose(f);
+	return used;
+}
+
 void
 tuple_free(void)
 {
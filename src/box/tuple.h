@@ -75,6 +75,23 @@ tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 void
 tuple_arena_destroy(struct slab_arena *arena);
 
+/**
+ * Advise the kernel to back a tuples arena with transparent huge
+ * pages to reduce TLB misses. Returns 0 on success, otherwise
+ * sets diag and returns -1, in which case the arena keeps using
+ * regular pages.
+ */
+int
+tuple_arena_use_hugepages(struct slab_arena *arena);
+
+/**
+ * Return the size of the memory of a tuples arena backed by
+ * transparent huge pages, read from /proc/self/smaps. Returns -1
+ * and sets diag on error.
+ */
+ssize_t
+tuple_arena_hugepages_used(struct slab_arena *arena);
+
 /**
  * Creates a new format for standalone tuples.
  * Tuples created with the new format are allocated from the runtime arena.
@@ -403,6 +420,11 @@ enum tuple_flag {
 	 * immediately while a snapshot is in progress.
 	 */
 	TUPLE_IS_TEMPORARY = 2,
+	/**
+	 * Some fields of the tuple are stored compressed, see
+	 * memtx_tuple_compress().
+	 */
+	TUPLE_IS_COMPRESSED = 3,
 	tuple_flag_MAX,
 };
 
@@ -777,11 +799,14 @@ tuple_format(struct tuple *tuple)
 	return format;
 }
 
-/** Check that some fields in tuple are compressed */
+/**
+ * Check that some fields in tuple are compressed. Doesn't access
+ * the tuple format so may be called from any thread.
+ */
 static inline bool
 tuple_is_compressed(struct tuple *tuple)
 {
-        return tuple_format(tuple)->is_compressed;
+	return tuple_has_flag(tuple, TUPLE_IS_COMPRESSED);
 }
 
 /**
@@ -150,20 +150,95 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
 	return 0;
 }
 
-struct tuple_bloom *
-tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
+/**
+ * Allocate a tuple bloom filter with room for the given number
+ * of partial key filters. The filters aren't initialized and
+ * part_count is set to 0.
+ */
+static struct tuple_bloom *
+tuple_bloom_alloc(uint32_t part_count, bool is_xor)
 {
-	uint32_t part_count = builder->part_count;
-	size_t size = sizeof(struct tuple_bloom) +
-			part_count * sizeof(struct bloom);
+	size_t size = sizeof(struct tuple_bloom);
+	if (!is_xor)
+		size += part_count * sizeof(struct bloom);
 	struct tuple_bloom *bloom = malloc(size);
 	if (bloom == NULL) {
 		diag_set(OutOfMemory, size, "malloc", "tuple bloom");
 		return NULL;
 	}
-
 	bloom->is_legacy = false;
+	bloom->is_xor = is_xor;
 	bloom->part_count = 0;
+	bloom->xor_parts = NULL;
+	if (is_xor) {
+		size = part_count * sizeof(*bloom->xor_parts);
+		bloom->xor_parts = malloc(size);
+		if (bloom->xor_parts == NULL) {
+			diag_set(OutOfMemory, size, "malloc",
+				 "tuple bloom xor parts");
+			free(bloom);
+			return NULL;
+		}
+	}
+	return bloom;
+}
+
+/**
+ * Return the false positive rate of the filter storing
+ * the given number of partial keys of rank i.
+ */
+static double
+tuple_bloom_part_fpr(const struct tuple_bloom *bloom, uint32_t i,
+		     uint32_t count)
+{
+	if (bloom->is_xor)
+		return xor_filter_fpr(&bloom->xor_parts[i]);
+	return bloom_fpr(&bloom->parts[i], count);
+}
+
+/** Check if a partial key of rank i may be stored in a bloom. */
+static inline bool
+tuple_bloom_part_maybe_has(const struct tuple_bloom *bloom, uint32_t i,
+			   uint32_t hash)
+{
+	if (bloom->is_xor)
+		return xor_filter_maybe_has(&bloom->xor_parts[i], hash);
+	return bloom_maybe_has(&bloom->parts[i], hash);
+}
+
+/**
+ * Create a filter for partial keys of rank i having
+ * the given false positive rate.
+ */
+static int
+tuple_bloom_create_part(struct tuple_bloom *bloom, uint32_t i,
+			const struct tuple_hash_array *hash_arr, double fpr)
+{
+	if (bloom->is_xor) {
+		if (xor_filter_create(&bloom->xor_parts[i], hash_arr->values,
+				      hash_arr->count, fpr) != 0) {
+			diag_set(OutOfMemory, 0, "xor_filter_create",
+				 "tuple bloom part");
+			return -1;
+		}
+		return 0;
+	}
+	if (bloom_create(&bloom->parts[i], hash_arr->count, fpr) != 0) {
+		diag_set(OutOfMemory, 0, "bloom_create", "tuple bloom part");
+		return -1;
+	}
+	for (uint32_t k = 0; k < hash_arr->count; k++)
+		bloom_add(&bloom->parts[i], hash_arr->values[k]);
+	return 0;
+}
+
+struct tuple_bloom *
+tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr, bool is_xor)
+{
+	uint32_t part_count = builder->part_count;
+	struct tuple_bloom *bloom = tuple_bloom_alloc(part_count, is_xor);
+	if (bloom == NULL)
+		return NULL;
 
 	for (uint32_t i = 0; i < part_count; i++) {
 		struct tuple_hash_array *hash_arr = &builder->parts[i];
@@ -178,17 +253,14 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 		 */
 		double part_fpr = fpr;
 		for (uint32_t j = 0; j < i; j++)
-			part_fpr /= bloom_fpr(&bloom->parts[j], count);
+			part_fpr /= tuple_bloom_part_fpr(bloom, j, count);
 		part_fpr = MIN(part_fpr, 0.5);
-		if (bloom_create(&bloom->parts[i], count, part_fpr) != 0) {
-			diag_set(OutOfMemory, 0, "bloom_create",
-				 "tuple bloom part");
+		if (tuple_bloom_create_part(bloom, i, hash_arr,
+					    part_fpr) != 0) {
 			tuple_bloom_delete(bloom);
 			return NULL;
 		}
 		bloom->part_count++;
-		for (uint32_t k = 0; k < count; k++)
-			bloom_add(&bloom->parts[i], hash_arr->values[k]);
 	}
 	return bloom;
 }
@@ -196,8 +268,13 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 void
 tuple_bloom_delete(struct tuple_bloom *bloom)
 {
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		bloom_destroy(&bloom->parts[i]);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		if (bloom->is_xor)
+			xor_filter_destroy(&bloom->xor_parts[i]);
+		else
+			bloom_destroy(&bloom->parts[i]);
+	}
+	free(bloom->xor_parts);
 	free(bloom);
 }
 
@@ -223,7 +300,7 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 						  &key_def->parts[i],
 						  multikey_idx);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (!tuple_bloom_part_maybe_has(bloom, i, hash))
 			return false;
 	}
 	return true;
@@ -253,7 +330,7 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 					       key_def->parts[i].type,
 					       key_def->parts[i].coll);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (!tuple_bloom_part_maybe_has(bloom, i, hash))
 			return false;
 	}
 	return true;
@@ -300,13 +377,62 @@ tuple_bloom_decode_part(struct bloom *part, const char **data)
 	return 0;
 }
 
+static size_t
+tuple_bloom_sizeof_xor_part(const struct xor_filter *part)
+{
+	size_t size = 0;
+	size += mp_sizeof_array(4);
+	size += mp_sizeof_uint(part->block_length);
+	size += mp_sizeof_uint(part->fingerprint_bits);
+	size += mp_sizeof_uint(part->seed);
+	size += mp_sizeof_bin(xor_filter_store_size(part));
+	return size;
+}
+
+static char *
+tuple_bloom_encode_xor_part(const struct xor_filter *part, char *buf)
+{
+	buf = mp_encode_array(buf, 4);
+	buf = mp_encode_uint(buf, part->block_length);
+	buf = mp_encode_uint(buf, part->fingerprint_bits);
+	buf = mp_encode_uint(buf, part->seed);
+	buf = mp_encode_binl(buf, xor_filter_store_size(part));
+	buf = xor_filter_store(part, buf);
+	return buf;
+}
+
+static int
+tuple_bloom_decode_xor_part(struct xor_filter *part, const char **data)
+{
+	memset(part, 0, sizeof(*part));
+	if (mp_decode_array(data) != 4)
+		unreachable();
+	part->block_length = mp_decode_uint(data);
+	part->fingerprint_bits = mp_decode_uint(data);
+	part->seed = mp_decode_uint(data);
+	size_t store_size = mp_decode_binl(data);
+	assert(store_size == xor_filter_store_size(part));
+	if (xor_filter_load_table(part, *data) != 0) {
+		diag_set(OutOfMemory, store_size, "xor_filter_load_table",
+			 "tuple bloom part");
+		return -1;
+	}
+	*data += store_size;
+	return 0;
+}
+
 size_t
 tuple_bloom_size(const struct tuple_bloom *bloom)
 {
 	size_t size = 0;
 	size += mp_sizeof_array(bloom->part_count);
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		size += tuple_bloom_sizeof_part(&bloom->parts[i]);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		if (bloom->is_xor)
+			size += tuple_bloom_sizeof_xor_part(
+						&bloom->xor_parts[i]);
+		else
+			size += tuple_bloom_sizeof_part(&bloom->parts[i]);
+	}
 	return size;
 }
 
@@ -314,8 +440,13 @@ char *
 tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf)
 {
 	buf = mp_encode_array(buf, bloom->part_count);
-	for (uint32_t i = 0; i < bloom->part_count; i++)
-		buf = tuple_bloom_encode_part(&bloom->parts[i], buf);
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		if (bloom->is_xor)
+			buf = tuple_bloom_encode_xor_part(&bloom->xor_parts[i],
+							  buf);
+		else
+			buf = tuple_bloom_encode_part(&bloom->parts[i], buf);
+	}
 	return buf;
 }
 
@@ -323,20 +454,31 @@ struct tuple_bloom *
 tuple_bloom_decode(const char **data)
 {
 	uint32_t part_count = mp_decode_array(data);
-	struct tuple_bloom *bloom = malloc(sizeof(*bloom) +
-			part_count * sizeof(*bloom->parts));
-	if (bloom == NULL) {
-		diag_set(OutOfMemory, sizeof(*bloom) +
-			 part_count * sizeof(*bloom->parts),
-			 "malloc", "tuple bloom");
+	struct tuple_bloom *bloom = tuple_bloom_alloc(part_count, false);
+	if (bloom == NULL)
 		return NULL;
+
+	for (uint32_t i = 0; i < part_count; i++) {
+		if (tuple_bloom_decode_part(&bloom->parts[i], data) != 0) {
+			tuple_bloom_delete(bloom);
+			return NULL;
+		}
+		bloom->part_count++;
 	}
+	return bloom;
+}
 
-	bloom->is_legacy = false;
-	bloom->part_count = 0;
+struct tuple_bloom *
+tuple_bloom_decode_xor(const char **data)
+{
+	uint32_t part_count = mp_decode_array(data);
+	struct tuple_bloom *bloom = tuple_bloom_alloc(part_count, true);
+	if (bloom == NULL)
+		return NULL;
 
 	for (uint32_t i = 0; i < part_count; i++) {
-		if (tuple_bloom_decode_part(&bloom->parts[i], data) != 0) {
+		if (tuple_bloom_decode_xor_part(&bloom->xor_parts[i],
+						data) != 0) {
 			tuple_bloom_delete(bloom);
 			return NULL;
 		}
@@ -357,7 +499,9 @@ tuple_bloom_decode_legacy(const char **data)
 	}
 
 	bloom->is_legacy = true;
+	bloom->is_xor = false;
 	bloom->part_count = 1;
+	bloom->xor_parts = NULL;
 
 	if (mp_decode_array(data) != 4)
 		unreachable();
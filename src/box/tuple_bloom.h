@@ -35,6 +35,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "salad/bloom.h"
+#include "salad/xor_filter.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -58,8 +59,16 @@ struct tuple_bloom {
 	 * (see tuple_bloom_decode_legacy).
 	 */
 	bool is_legacy;
+	/**
+	 * If the following flag is set, partial keys are stored
+	 * in xor filters (see xor_parts) rather than in bloom
+	 * filters (see parts).
+	 */
+	bool is_xor;
 	/** Number of key parts. */
 	uint32_t part_count;
+	/** Array of xor filters, one per each partial key. */
+	struct xor_filter *xor_parts;
 	/** Array of bloom filters, one per each partial key. */
 	struct bloom parts[0];
 };
@@ -154,10 +163,15 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
  * Create a new tuple bloom filter.
  * @param builder - bloom filter builder
  * @param fpr - desired false positive rate
+ * @param is_xor - use xor filters instead of bloom filters
  * @return bloom filter on success or NULL on OOM
+ *
+ * Xor filters take less memory than bloom filters with the same
+ * false positive rate, but they can't be read by versions that
+ * don't support them, see tuple_bloom_decode_xor().
  */
 struct tuple_bloom *
-tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr);
+tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr, bool is_xor);
 
 /**
  * Delete a tuple bloom filter.
@@ -219,6 +233,15 @@ tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf);
 struct tuple_bloom *
 tuple_bloom_decode(const char **data);
 
+/**
+ * Decode a tuple bloom filter that uses xor filters from MsgPack.
+ * @param data - pointer to buffer storing encoded bloom filter;
+ *  on success it is advanced by the number of decoded bytes
+ * @return the decoded bloom on success or NULL on OOM
+ */
+struct tuple_bloom *
+tuple_bloom_decode_xor(const char **data);
+
 /**
  * Decode a legacy bloom filter from MsgPack.
  * @param data - pointer to buffer storing encoded bloom filter;
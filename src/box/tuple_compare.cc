@@ -226,6 +226,17 @@ mp_compare_double_any_number(double lhs, const char *rhs,
 static int
 mp_compare_decimal(const char *lhs, const char *rhs)
 {
+	/* Try to compare the values without unpacking them. */
+	const char *lhs_data = lhs, *rhs_data = rhs;
+	int8_t lhs_ext_type, rhs_ext_type;
+	uint32_t lhs_len = mp_decode_extl(&lhs_data, &lhs_ext_type);
+	uint32_t rhs_len = mp_decode_extl(&rhs_data, &rhs_ext_type);
+	assert(lhs_ext_type == MP_DECIMAL && rhs_ext_type == MP_DECIMAL);
+	int result;
+	if (decimal_compare_packed(lhs_data, lhs_len, rhs_data, rhs_len,
+				   &result) == 0)
+		return result;
+
 	decimal_t lhs_dec, rhs_dec;
 	decimal_t *ret;
 	ret = mp_decode_decimal(&lhs, &lhs_dec);
@@ -321,6 +332,8 @@ mp_compare_number_with_type(const char *lhs, enum mp_type lhs_type,
 	 * account for them in other comparators.
 	 */
 	decimal_t dec;
+	if (lhs_type == MP_EXT && rhs_type == MP_EXT)
+		return mp_compare_decimal(lhs, rhs);
 	if (rhs_type == MP_EXT) {
 		int8_t ext_type;
 		uint32_t len = mp_decode_extl(&rhs, &ext_type);
@@ -1043,6 +1056,21 @@ field_compare<FIELD_TYPE_STRING>(const char **field_a, const char **field_b)
 	return r;
 }
 
+template <>
+inline int
+field_compare<FIELD_TYPE_INTEGER>(const char **field_a, const char **field_b)
+{
+	return mp_compare_integer_with_type(*field_a, mp_typeof(**field_a),
+					    *field_b, mp_typeof(**field_b));
+}
+
+template <>
+inline int
+field_compare<FIELD_TYPE_DOUBLE>(const char **field_a, const char **field_b)
+{
+	return mp_compare_as_double(*field_a, *field_b);
+}
+
 template <int TYPE>
 static inline int
 field_compare_and_next(const char **field_a, const char **field_b);
@@ -1074,6 +1102,28 @@ field_compare_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+					   const char **field_b)
+{
+	int r = field_compare<FIELD_TYPE_INTEGER>(field_a, field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_DOUBLE>(const char **field_a,
+					  const char **field_b)
+{
+	int r = mp_compare_as_double(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
 /* Tuple comparator */
 namespace /* local symbols */ {
 
@@ -1200,6 +1250,15 @@ static const comparator_signature cmp_arr[] = {
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_DOUBLE)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_DOUBLE)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_DOUBLE)
 };
 
 #undef COMPARATOR
@@ -1231,6 +1290,20 @@ field_compare_with_key<FIELD_TYPE_STRING>(const char **field, const char **key)
 	return r;
 }
 
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_INTEGER>(const char **field, const char **key)
+{
+	return field_compare<FIELD_TYPE_INTEGER>(field, key);
+}
+
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_DOUBLE>(const char **field, const char **key)
+{
+	return mp_compare_as_double(*field, *key);
+}
+
 template <int TYPE>
 static inline int
 field_compare_with_key_and_next(const char **field_a, const char **field_b);
@@ -1262,6 +1335,22 @@ field_compare_with_key_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+						    const char **field_b)
+{
+	return field_compare_and_next<FIELD_TYPE_INTEGER>(field_a, field_b);
+}
+
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_DOUBLE>(const char **field_a,
+						   const char **field_b)
+{
+	return field_compare_and_next<FIELD_TYPE_DOUBLE>(field_a, field_b);
+}
+
 /* Tuple with key comparator */
 namespace /* local symbols */ {
 
@@ -1385,10 +1474,228 @@ static const comparator_with_key_signature cmp_wk_arr[] = {
 	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_DOUBLE)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_DOUBLE)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_DOUBLE)
 };
 
 #undef KEY_COMPARATOR
 
+/* {{{ Comparators specialized by part types */
+
+/*
+ * The pre-compiled comparators above are used only if both the field
+ * numbers and the types of the key parts match. The comparators below
+ * take field numbers from the key definition at runtime and are
+ * specialized only by the types of the parts, so that they can be used
+ * for any plain key of up to three unsigned, string or integer parts.
+ */
+namespace /* local symbols */ {
+
+template <int TYPE, int ...MORE_TYPES>
+struct FieldCompareByType {};
+
+template <int TYPE, int TYPE2, int ...MORE_TYPES>
+struct FieldCompareByType<TYPE, TYPE2, MORE_TYPES...>
+{
+	inline static int
+	compare(struct tuple_format *format_a, const char *data_a,
+		const uint32_t *field_map_a, struct tuple_format *format_b,
+		const char *data_b, const uint32_t *field_map_b,
+		const struct key_part *part)
+	{
+		const char *field_a = tuple_field_raw(format_a, data_a,
+						      field_map_a,
+						      part->fieldno);
+		const char *field_b = tuple_field_raw(format_b, data_b,
+						      field_map_b,
+						      part->fieldno);
+		int r = field_compare<TYPE>(&field_a, &field_b);
+		if (r != 0)
+			return r;
+		return FieldCompareByType<TYPE2, MORE_TYPES...>::
+			compare(format_a, data_a, field_map_a,
+				format_b, data_b, field_map_b, part + 1);
+	}
+};
+
+template <int TYPE>
+struct FieldCompareByType<TYPE>
+{
+	inline static int
+	compare(struct tuple_format *format_a, const char *data_a,
+		const uint32_t *field_map_a, struct tuple_format *format_b,
+		const char *data_b, const uint32_t *field_map_b,
+		const struct key_part *part)
+	{
+		const char *field_a = tuple_field_raw(format_a, data_a,
+						      field_map_a,
+						      part->fieldno);
+		const char *field_b = tuple_field_raw(format_b, data_b,
+						      field_map_b,
+						      part->fieldno);
+		return field_compare<TYPE>(&field_a, &field_b);
+	}
+};
+
+template <int ...TYPES>
+struct TupleCompareByType
+{
+	static int compare(struct tuple *tuple_a, hint_t tuple_a_hint,
+			   struct tuple *tuple_b, hint_t tuple_b_hint,
+			   struct key_def *key_def)
+	{
+		int rc = hint_cmp(tuple_a_hint, tuple_b_hint);
+		if (rc != 0)
+			return rc;
+		return FieldCompareByType<TYPES...>::
+			compare(tuple_format(tuple_a), tuple_data(tuple_a),
+				tuple_field_map(tuple_a),
+				tuple_format(tuple_b), tuple_data(tuple_b),
+				tuple_field_map(tuple_b), key_def->parts);
+	}
+};
+
+template <int TYPE, int ...MORE_TYPES>
+struct FieldCompareWithKeyByType {};
+
+template <int TYPE, int TYPE2, int ...MORE_TYPES>
+struct FieldCompareWithKeyByType<TYPE, TYPE2, MORE_TYPES...>
+{
+	inline static int
+	compare(struct tuple_format *format, const char *data,
+		const uint32_t *field_map, const char *key,
+		uint32_t part_count, const struct key_part *part)
+	{
+		const char *field = tuple_field_raw(format, data, field_map,
+						    part->fieldno);
+		int r = field_compare_with_key_and_next<TYPE>(&field, &key);
+		if (r != 0 || part_count == 1)
+			return r;
+		return FieldCompareWithKeyByType<TYPE2, MORE_TYPES...>::
+			compare(format, data, field_map, key,
+				part_count - 1, part + 1);
+	}
+};
+
+template <int TYPE>
+struct FieldCompareWithKeyByType<TYPE>
+{
+	inline static int
+	compare(struct tuple_format *format, const char *data,
+		const uint32_t *field_map, const char *key,
+		uint32_t, const struct key_part *part)
+	{
+		const char *field = tuple_field_raw(format, data, field_map,
+						    part->fieldno);
+		return field_compare_with_key<TYPE>(&field, &key);
+	}
+};
+
+template <int ...TYPES>
+struct TupleCompareWithKeyByType
+{
+	static int
+	compare(struct tuple *tuple, hint_t tuple_hint,
+		const char *key, uint32_t part_count,
+		hint_t key_hint, struct key_def *key_def)
+	{
+		/* Part count can be 0 in wildcard searches. */
+		if (part_count == 0)
+			return 0;
+		int rc = hint_cmp(tuple_hint, key_hint);
+		if (rc != 0)
+			return rc;
+		return FieldCompareWithKeyByType<TYPES...>::
+			compare(tuple_format(tuple), tuple_data(tuple),
+				tuple_field_map(tuple), key, part_count,
+				key_def->parts);
+	}
+};
+
+/**
+ * Selects the comparators specialized by the types of the key parts.
+ * TYPES are the types of the first parts of the key, the types of the
+ * rest of the parts are matched recursively.
+ */
+template <int ...TYPES>
+struct CompareByTypeSelector
+{
+	static bool
+	select(struct key_def *def, tuple_compare_t *cmp,
+	       tuple_compare_with_key_t *cmp_wk)
+	{
+		const uint32_t n = sizeof...(TYPES);
+		if (def->part_count == n) {
+			*cmp = TupleCompareByType<TYPES...>::compare;
+			*cmp_wk = TupleCompareWithKeyByType<TYPES...>::compare;
+			return true;
+		}
+		switch (def->parts[n].type) {
+		case FIELD_TYPE_UNSIGNED:
+			return CompareByTypeSelector<TYPES...,
+				FIELD_TYPE_UNSIGNED>::select(def, cmp, cmp_wk);
+		case FIELD_TYPE_STRING:
+			return CompareByTypeSelector<TYPES...,
+				FIELD_TYPE_STRING>::select(def, cmp, cmp_wk);
+		case FIELD_TYPE_INTEGER:
+			return CompareByTypeSelector<TYPES...,
+				FIELD_TYPE_INTEGER>::select(def, cmp, cmp_wk);
+		default:
+			return false;
+		}
+	}
+};
+
+template <int TYPE1, int TYPE2, int TYPE3>
+struct CompareByTypeSelector<TYPE1, TYPE2, TYPE3>
+{
+	static bool
+	select(struct key_def *def, tuple_compare_t *cmp,
+	       tuple_compare_with_key_t *cmp_wk)
+	{
+		if (def->part_count != 3)
+			return false;
+		*cmp = TupleCompareByType<TYPE1, TYPE2, TYPE3>::compare;
+		*cmp_wk = TupleCompareWithKeyByType<TYPE1, TYPE2,
+						    TYPE3>::compare;
+		return true;
+	}
+};
+
+} /* end of anonymous namespace */
+
+/**
+ * Looks up the comparators specialized by the types of the parts of
+ * a plain key definition. Returns false if there are none.
+ */
+static bool
+key_def_select_compare_by_type(struct key_def *def, tuple_compare_t *cmp,
+			       tuple_compare_with_key_t *cmp_wk)
+{
+	switch (def->parts[0].type) {
+	case FIELD_TYPE_UNSIGNED:
+		return CompareByTypeSelector<FIELD_TYPE_UNSIGNED>::
+			select(def, cmp, cmp_wk);
+	case FIELD_TYPE_STRING:
+		return CompareByTypeSelector<FIELD_TYPE_STRING>::
+			select(def, cmp, cmp_wk);
+	case FIELD_TYPE_INTEGER:
+		return CompareByTypeSelector<FIELD_TYPE_INTEGER>::
+			select(def, cmp, cmp_wk);
+	default:
+		return false;
+	}
+}
+
+/* }}} Comparators specialized by part types */
+
 /**
  * A functional index tuple compare.
  * tuple_a_hint and tuple_b_hint are expected to be valid pointers to functional
@@ -1586,8 +1893,11 @@ func_index_compare_with_key(struct tuple *tuple, hint_t tuple_hint,
 #define HINT_CLASS_BITS		4
 #define HINT_VALUE_BITS		(HINT_BITS - HINT_CLASS_BITS)
 
-/** Number of bytes that fit in a hint value. */
-#define HINT_VALUE_BYTES	(HINT_VALUE_BITS / CHAR_BIT)
+/**
+ * Number of leading bytes of a string that are used for its hint.
+ * The last byte contributes only its most significant bits.
+ */
+#define HINT_VALUE_STR_BYTES	DIV_ROUND_UP(HINT_VALUE_BITS, CHAR_BIT)
 
 /** Max unsigned integer that can be stored in a hint value. */
 #define HINT_VALUE_MAX		((1ULL << HINT_VALUE_BITS) - 1)
@@ -1749,14 +2059,20 @@ hint_datetime(struct datetime *date)
 static inline uint64_t
 hint_str_raw(const char *s, uint32_t len)
 {
-	len = MIN(len, HINT_VALUE_BYTES);
-	uint64_t val = 0;
-	for (uint32_t i = 0; i < len; i++) {
-		val <<= CHAR_BIT;
-		val |= (unsigned char)s[i];
+	static_assert(HINT_VALUE_STR_BYTES == sizeof(uint64_t),
+		      "string hint prefix must fit in uint64_t");
+	uint64_t val;
+	if (len >= HINT_VALUE_STR_BYTES) {
+		val = mp_load_u64(&s);
+	} else {
+		val = 0;
+		for (uint32_t i = 0; i < len; i++) {
+			val <<= CHAR_BIT;
+			val |= (unsigned char)s[i];
+		}
+		val <<= CHAR_BIT * (HINT_VALUE_STR_BYTES - len);
 	}
-	val <<= CHAR_BIT * (HINT_VALUE_BYTES - len);
-	return val;
+	return val >> (HINT_VALUE_STR_BYTES * CHAR_BIT - HINT_VALUE_BITS);
 }
 
 static inline hint_t
@@ -1769,7 +2085,7 @@ hint_str(const char *s, uint32_t len)
 static inline hint_t
 hint_str_coll(const char *s, uint32_t len, struct coll *coll)
 {
-	char buf[HINT_VALUE_BYTES];
+	char buf[HINT_VALUE_STR_BYTES];
 	uint32_t buf_len = coll->hint(s, len, buf, sizeof(buf), coll);
 	uint64_t val = hint_str_raw(buf, buf_len);
 	return hint_create(MP_CLASS_STR, val);
@@ -2160,6 +2476,17 @@ key_def_set_compare_func_fast(struct key_def *def)
 			break;
 		}
 	}
+	if (cmp == NULL || cmp_wk == NULL) {
+		tuple_compare_t by_type_cmp;
+		tuple_compare_with_key_t by_type_cmp_wk;
+		if (key_def_select_compare_by_type(def, &by_type_cmp,
+						   &by_type_cmp_wk)) {
+			if (cmp == NULL)
+				cmp = by_type_cmp;
+			if (cmp_wk == NULL)
+				cmp_wk = by_type_cmp_wk;
+		}
+	}
 	if (cmp == NULL) {
 		cmp = is_sequential ?
 			tuple_compare_sequential<false, false, false> :
@@ -30,6 +30,7 @@
  */
 #include "tuple_format.h"
 #include "bit/bit.h"
+#include "column_mask.h"
 #include "fiber.h"
 #include "json/json.h"
 #include "coll_id_cache.h"
@@ -817,6 +818,7 @@ tuple_format_alloc(struct key_def * const *keys, uint16_t key_count,
 	format->constraint_count = 0;
 	format->constraint = NULL;
 	format->default_field_count = 0;
+	format->compression = NULL;
 	return format;
 error:
 	tuple_format_destroy_fields(format);
@@ -835,6 +837,8 @@ tuple_format_destroy(struct tuple_format *format)
 		format->constraint[i].destroy(&format->constraint[i]);
 	free(format->constraint);
 	free(format->data);
+	if (format->compression != NULL)
+		format->compression->destroy(format->compression);
 }
 
 /**
@@ -1102,8 +1106,13 @@ tuple_field_map_create_plain(struct tuple_format *format, const char *tuple,
 			 (unsigned) format->exact_field_count);
 		return -1;
 	}
-	defined_field_count = MIN(defined_field_count,
-				  tuple_format_field_count(format));
+	/*
+	 * Without validation only the offsets of indexed fields matter,
+	 * so there's no need to decode the tail of a wide tuple.
+	 */
+	defined_field_count = MIN(defined_field_count, validate ?
+				  tuple_format_field_count(format) :
+				  format->index_field_count);
 
 	void *required_fields = NULL;
 	uint32_t required_fields_sz = BITMAP_SIZE(format->total_field_count);
@@ -1191,7 +1200,8 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 
 	uint32_t field_count;
 	struct tuple_format_iterator it;
-	uint8_t flags = validate ? TUPLE_FORMAT_ITERATOR_VALIDATE : 0;
+	uint8_t flags = validate ? TUPLE_FORMAT_ITERATOR_VALIDATE :
+			TUPLE_FORMAT_ITERATOR_KEY_PARTS_ONLY;
 	if (tuple_format_iterator_create(&it, format, tuple, flags,
 					 &field_count, region) != 0)
 		return -1;
@@ -1209,6 +1219,65 @@ tuple_field_map_create(struct tuple_format *format, const char *tuple,
 	return entry.data == NULL ? 0 : -1;
 }
 
+/** @sa declaration for details. */
+int
+tuple_validate_update(struct tuple_format *format, const char *old_tuple,
+		      const char *old_end, const char *tuple,
+		      uint64_t column_mask)
+{
+	/*
+	 * The mask must not cover fields with numbers >= 63, which
+	 * share the last bit, nor any indexed field.
+	 */
+	if (column_mask == 0 || column_mask_fieldno_is_set(column_mask, 63) ||
+	    format->index_field_count >= 63)
+		return 1;
+	uint64_t index_mask = (UINT64_C(1) << format->index_field_count) - 1;
+	if ((column_mask & index_mask) != 0)
+		return 1;
+	/* Defaults and tuple constraints depend on the whole tuple. */
+	if (format->constraint_count > 0 || format->default_field_count > 0)
+		return 1;
+	uint32_t first = bit_ctz_u64(column_mask);
+	uint32_t last = 63 - bit_clz_u64(column_mask);
+	const char *pos = tuple;
+	uint32_t field_count = mp_decode_array(&pos);
+	if (field_count <= last)
+		return 1;
+	for (uint32_t i = 0; i < first; i++)
+		mp_next(&pos);
+	/*
+	 * The array header and the fields preceding the first changed
+	 * one must be unchanged, so the offsets of the indexed fields
+	 * and the field count stay the same.
+	 */
+	size_t prefix_len = pos - tuple;
+	if (prefix_len > (size_t)(old_end - old_tuple) ||
+	    memcmp(old_tuple, tuple, prefix_len) != 0)
+		return 1;
+	uint32_t format_field_count = tuple_format_field_count(format);
+	const char *next_pos = pos;
+	for (uint32_t i = first; i <= last && i < format_field_count;
+	     i++, pos = next_pos) {
+		mp_next(&next_pos);
+		if (!column_mask_fieldno_is_set(column_mask, i))
+			continue;
+		struct tuple_field *field = tuple_format_field(format, i);
+		bool allow_null = tuple_field_is_nullable(field);
+		if (!field_mp_type_is_compatible(field->type, pos,
+						 allow_null)) {
+			diag_set(ClientError, ER_FIELD_TYPE,
+				 tuple_field_path(field, format),
+				 field_type_strs[field->type],
+				 mp_type_strs[mp_typeof(*pos)]);
+			return -1;
+		}
+		if (tuple_field_check_constraint(field, pos, next_pos) != 0)
+			return -1;
+	}
+	return 0;
+}
+
 uint32_t
 tuple_format_min_field_count(struct key_def * const *keys, uint16_t key_count,
 			     const struct field_def *space_fields,
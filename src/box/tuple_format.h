@@ -228,6 +228,16 @@ const char *
 tuple_field_path(const struct tuple_field *field,
 		 const struct tuple_format *format);
 
+/**
+ * Engine-specific state of tuple compression attached to a format,
+ * for example, a compression dictionary trained on its tuples.
+ */
+struct tuple_format_compression {
+	/** Free the state. Called when the format is destroyed. */
+	void
+	(*destroy)(struct tuple_format_compression *compression);
+};
+
 /**
  * @brief Tuple format
  * Tuple format describes how tuple is stored and information about its fields
@@ -269,6 +279,11 @@ struct tuple_format {
 	bool is_reusable;
 	/** True if tuples of this format may contain compressed fields. */
 	bool is_compressed;
+	/**
+	 * Compression state, created by the engine on demand.
+	 * NULL if the format doesn't have any.
+	 */
+	struct tuple_format_compression *compression;
 	/**
 	 * Size of minimal field map of tuple where each indexed
 	 * field has own offset slot (in bytes). The real tuple
@@ -562,6 +577,29 @@ int
 tuple_field_map_create(struct tuple_format *format, const char *tuple,
 		       bool validate, struct field_map_builder *builder);
 
+/**
+ * Validate @a tuple produced by an update of @a old_tuple that changed
+ * only the top-level fields marked in @a column_mask. If the tuples share
+ * a common prefix that contains the array header and all indexed fields,
+ * only the changed fields are checked against the format, and the field
+ * map of the old tuple is valid for the new one as is.
+ *
+ * @param format     Format of both tuples.
+ * @param old_tuple  MessagePack array of the old tuple.
+ * @param old_end    End of the old tuple.
+ * @param tuple      MessagePack array of the new tuple.
+ * @param column_mask Mask of the fields changed by the update.
+ *
+ * @retval  0 Success, the field map of the old tuple can be reused.
+ * @retval  1 The check isn't applicable, the tuple must be validated
+ *            with tuple_field_map_create().
+ * @retval -1 Format error.
+ */
+int
+tuple_validate_update(struct tuple_format *format, const char *old_tuple,
+		      const char *old_end, const char *tuple,
+		      uint64_t column_mask);
+
 /**
  * Initialize tuple format subsystem.
  */
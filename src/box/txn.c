@@ -42,6 +42,7 @@
 #include "session.h"
 #include "wal_ext.h"
 #include "rmean.h"
+#include "usdt.h"
 
 double too_long_threshold;
 
@@ -73,6 +74,17 @@ const char *txn_isolation_level_aliases[txn_isolation_level_MAX] = {
 /* Txn cache. */
 static STAILQ(txn_cache);
 
+/**
+ * Max number of transactions kept in the cache. Each cached txn pins
+ * its region slab, so without the limit a spike of concurrent
+ * transactions (e.g. waiting for WAL or the synchronous quorum) would
+ * keep the memory forever.
+ */
+enum { TXN_CACHE_SIZE_MAX = 1024 };
+
+/** Number of transactions in the cache. */
+static int txn_cache_size;
+
 static int
 txn_on_stop(struct trigger *trigger, void *event);
 
@@ -390,6 +402,21 @@ txn_rollback_to_svp(struct txn *txn, struct stailq_entry *svp)
 	stailq_cut_tail(&txn->stmts, svp, &rollback);
 	stailq_reverse(&rollback);
 	stailq_foreach_entry(stmt, &rollback, next) {
+		/*
+		 * Statements are allocated in the order of execution, so on
+		 * rollback we walk the memory backwards, which the hardware
+		 * prefetcher doesn't handle well. Fetch the statement after
+		 * next and the tuples of the next statement in advance (the
+		 * latter was fetched on the previous iteration).
+		 */
+		struct stailq_entry *next = stailq_next(&stmt->next);
+		if (next != NULL) {
+			struct txn_stmt *next_stmt =
+				stailq_entry(next, struct txn_stmt, next);
+			prefetch(stailq_next(next), 0);
+			prefetch(next_stmt->rollback_info.old_tuple, 0);
+			prefetch(next_stmt->rollback_info.new_tuple, 0);
+		}
 		txn_rollback_one_stmt(txn, stmt);
 		if (stmt->row != NULL)
 			txn_update_row_counts(txn, stmt, -1);
@@ -405,8 +432,11 @@ txn_rollback_to_svp(struct txn *txn, struct stailq_entry *svp)
 inline static struct txn *
 txn_new(void)
 {
-	if (!stailq_empty(&txn_cache))
+	if (!stailq_empty(&txn_cache)) {
+		assert(txn_cache_size > 0);
+		txn_cache_size--;
 		return stailq_shift_entry(&txn_cache, struct txn, in_txn_cache);
+	}
 
 	/* Create a region. */
 	struct region region;
@@ -421,7 +451,13 @@ txn_new(void)
 	}
 	assert(region_used(&region) == sizeof(*txn));
 	txn_reset_stats(txn);
+	/*
+	 * The region slab list is intrusive, so relink the slabs
+	 * to the list head in the txn after the struct copy.
+	 */
 	txn->region = region;
+	rlist_create(&txn->region.slabs.slabs);
+	rlist_splice(&txn->region.slabs.slabs, &region.slabs.slabs);
 	rlist_create(&txn->read_set);
 	rlist_create(&txn->point_holes_list);
 	rlist_create(&txn->gap_list);
@@ -449,8 +485,22 @@ txn_free(struct txn *txn)
 
 	/* Truncate region up to struct txn size. */
 	txn_reset_stats(txn);
+	if (txn_cache_size >= TXN_CACHE_SIZE_MAX) {
+		/*
+		 * The txn structure lives on its own region, so move
+		 * the slabs to a local region before destroying it:
+		 * region_destroy() keeps walking the slab list after
+		 * freeing the slab the txn is allocated on.
+		 */
+		struct region region;
+		region_create(&region, txn->region.cache);
+		rlist_splice(&region.slabs.slabs, &txn->region.slabs.slabs);
+		region_destroy(&region);
+		return;
+	}
 	region_truncate(&txn->region, sizeof(struct txn));
 	stailq_add(&txn_cache, &txn->in_txn_cache);
+	txn_cache_size++;
 }
 
 void
@@ -552,6 +602,12 @@ txn_begin_stmt(struct txn *txn, struct space *space, uint16_t type)
 		return -1;
 	}
 
+	if (txn_has_flag(txn, TXN_IS_READ_ONLY)) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Read-only transaction",
+			 "data modification");
+		return -1;
+	}
+
 	if (txn->status == TXN_IN_READ_VIEW) {
 		rlist_del(&txn->in_read_view_txs);
 		txn->status = TXN_ABORTED;
@@ -719,6 +775,7 @@ txn_complete_fail(struct txn *txn)
 		/* Commit won't happen after rollback. */
 		trigger_destroy(&txn->on_commit);
 	}
+	USDT_PROBE(txn_rollback, txn->id, txn->signature);
 	txn_free_or_wakeup(txn);
 	rmean_collect(rmean_box, IPROTO_ROLLBACK, 1);
 }
@@ -748,6 +805,7 @@ txn_complete_success(struct txn *txn)
 		/* Rollback won't happen after commit. */
 		trigger_destroy(&txn->on_rollback);
 	}
+	USDT_PROBE(txn_commit, txn->id, txn->signature);
 	txn_free_or_wakeup(txn);
 	rmean_collect(rmean_box, IPROTO_COMMIT, 1);
 }
@@ -1318,6 +1376,18 @@ txn_check_space_linearizability(const struct txn *txn,
 	return 0;
 }
 
+int
+txn_make_read_only(struct txn *txn)
+{
+	if (!stailq_empty(&txn->stmts)) {
+		diag_set(ClientError, ER_ACTIVE_TRANSACTION);
+		return -1;
+	}
+	txn_set_flags(txn, TXN_IS_READ_ONLY);
+	memtx_tx_send_to_read_view(txn);
+	return 0;
+}
+
 int
 box_txn_set_isolation(uint32_t level)
 {
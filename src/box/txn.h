@@ -106,6 +106,11 @@ enum txn_flag {
 	 * rolled back at commit.
 	 */
 	TXN_IS_ABORTED_BY_TIMEOUT = 0x100,
+	/**
+	 * Transaction was made read-only with txn_make_read_only()
+	 * so any attempt to modify data in it fails.
+	 */
+	TXN_IS_READ_ONLY = 0x200,
 };
 
 enum {
@@ -1044,6 +1049,17 @@ box_txn_set_isolation(uint32_t level);
 
 /** \endcond public */
 
+/**
+ * Make a transaction read-only. With MVCC enabled, the transaction is
+ * also sent to a read view of the current database state so that its
+ * reads needn't be tracked for conflicts. Must be called before the
+ * first DML.
+ * @retval 0 if success
+ * @retval -1 if failed, diag is set.
+ */
+int
+txn_make_read_only(struct txn *txn);
+
 typedef struct txn_savepoint box_txn_savepoint_t;
 
 /**
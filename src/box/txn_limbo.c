@@ -54,6 +54,8 @@ txn_limbo_create(struct txn_limbo *limbo)
 	limbo->confirmed_lsn = 0;
 	limbo->rollback_count = 0;
 	limbo->is_in_rollback = false;
+	limbo->is_writing_confirm = false;
+	limbo->pending_confirm_lsn = -1;
 	limbo->svp_confirmed_lsn = -1;
 	limbo->frozen_reasons = 0;
 	limbo->is_frozen_until_promotion = true;
@@ -507,6 +509,39 @@ txn_limbo_read_confirm(struct txn_limbo *limbo, int64_t lsn)
 		limbo->confirmed_lsn = lsn;
 }
 
+/**
+ * Write a confirmation entry to WAL and confirm all the entries <= @a lsn.
+ * If a CONFIRM is being written already, the confirmation is postponed
+ * until the write is complete so that all quorums gathered meanwhile are
+ * confirmed by a single WAL write.
+ */
+static void
+txn_limbo_confirm(struct txn_limbo *limbo, int64_t lsn)
+{
+	if (limbo->is_writing_confirm) {
+		if (lsn > limbo->pending_confirm_lsn)
+			limbo->pending_confirm_lsn = lsn;
+		return;
+	}
+	limbo->is_writing_confirm = true;
+	while (true) {
+		txn_limbo_write_confirm(limbo, lsn);
+		txn_limbo_read_confirm(limbo, lsn);
+		lsn = limbo->pending_confirm_lsn;
+		limbo->pending_confirm_lsn = -1;
+		/*
+		 * The limbo could change hands or start a rollback while
+		 * the CONFIRM was being written.
+		 */
+		if (lsn <= limbo->confirmed_lsn || limbo->is_in_rollback ||
+		    txn_limbo_is_frozen(limbo) ||
+		    limbo->owner_id != instance_id ||
+		    rlist_empty(&limbo->queue))
+			break;
+	}
+	limbo->is_writing_confirm = false;
+}
+
 /**
  * Write a rollback message to WAL. After it's written all the
  * transactions following the current one and waiting for
@@ -688,8 +723,7 @@ txn_limbo_ack(struct txn_limbo *limbo, uint32_t replica_id, int64_t lsn)
 	}
 	if (confirm_lsn == -1 || confirm_lsn <= limbo->confirmed_lsn)
 		return;
-	txn_limbo_write_confirm(limbo, confirm_lsn);
-	txn_limbo_read_confirm(limbo, confirm_lsn);
+	txn_limbo_confirm(limbo, confirm_lsn);
 }
 
 /**
@@ -1196,9 +1230,14 @@ txn_limbo_req_commit(struct txn_limbo *limbo, const struct synchro_request *req)
 	case IPROTO_RAFT_PROMOTE:
 		txn_limbo_read_promote(limbo, req->origin_id, req->replica_id,
 				       lsn);
+		if (req->origin_id == instance_id)
+			box_raft_lease_start(term);
+		else
+			box_raft_lease_end();
 		break;
 	case IPROTO_RAFT_DEMOTE:
 		txn_limbo_read_demote(limbo, req->replica_id, lsn);
+		box_raft_lease_end();
 		break;
 	default:
 		unreachable();
@@ -1237,10 +1276,8 @@ txn_limbo_on_parameters_change(struct txn_limbo *limbo)
 			assert(confirm_lsn > 0);
 		}
 	}
-	if (confirm_lsn > limbo->confirmed_lsn && !limbo->is_in_rollback) {
-		txn_limbo_write_confirm(limbo, confirm_lsn);
-		txn_limbo_read_confirm(limbo, confirm_lsn);
-	}
+	if (confirm_lsn > limbo->confirmed_lsn && !limbo->is_in_rollback)
+		txn_limbo_confirm(limbo, confirm_lsn);
 	/*
 	 * Wakeup all the others - timed out will rollback. Also
 	 * there can be non-transactional waiters, such as CONFIRM
@@ -185,6 +185,17 @@ struct txn_limbo {
 	 * by the 'reversed rollback order' rule - contradiction.
 	 */
 	bool is_in_rollback;
+	/**
+	 * Whether a CONFIRM is being written to WAL. Only one CONFIRM is
+	 * written at a time. Quorums gathered meanwhile are confirmed by
+	 * the next one, see pending_confirm_lsn.
+	 */
+	bool is_writing_confirm;
+	/**
+	 * Maximal LSN gathered quorum while a CONFIRM was being written
+	 * to WAL or -1. It is confirmed once the write is complete.
+	 */
+	int64_t pending_confirm_lsn;
 	/**
 	 * Savepoint of confirmed LSN. To rollback to in case the current
 	 * synchro command (promote/demote/...) fails.
@@ -55,6 +55,7 @@
 #include <small/region.h>
 #include <small/mempool.h>
 
+#include "assoc.h"
 #include "coio_task.h"
 #include "cbus.h"
 #include "histogram.h"
@@ -71,6 +72,7 @@
 #include "column_mask.h"
 #include "trigger.h"
 #include "wal.h" /* wal_mode() */
+#include "on_shutdown.h"
 
 /**
  * Yield after iterating over this many objects (e.g. ranges).
@@ -130,6 +132,19 @@ struct vy_env {
 	double timeout;
 	/** Try to recover corrupted data if set. */
 	bool force_recovery;
+	/** Fiber warming up the page cache after recovery or NULL. */
+	struct fiber *warmup_fiber;
+	/** Fiber writing the list of cached pages to disk or NULL. */
+	struct fiber *page_cache_saver;
+	/**
+	 * List of cached pages encoded on checkpoint, which is to be
+	 * written by the page_cache_saver fiber, or NULL.
+	 */
+	char *page_cache_buf;
+	/** Size of page_cache_buf. */
+	size_t page_cache_buf_size;
+	/** Signalled when page_cache_buf is set. */
+	struct fiber_cond page_cache_cond;
 };
 
 /** Mask passed to vy_gc(). */
@@ -298,11 +313,24 @@ vy_info_append_memory(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "level0", lsregion_used(&env->mem_env.allocator));
 	info_append_int(h, "tuple", env->stmt_env.sum_tuple_size);
 	info_append_int(h, "tuple_cache", env->cache_env.mem_used);
+	info_append_int(h, "page_cache", env->run_env.page_cache.mem_used);
 	info_append_int(h, "page_index", env->lsm_env.page_index_size);
 	info_append_int(h, "bloom_filter", env->lsm_env.bloom_size);
 	info_table_end(h); /* memory */
 }
 
+static void
+vy_info_append_page_cache(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_page_cache *cache = &env->run_env.page_cache;
+	info_table_begin(h, "page_cache");
+	info_append_int(h, "lookup", cache->lookup);
+	info_append_int(h, "hit", cache->hit);
+	info_append_int(h, "evict", cache->evict);
+	info_append_int(h, "warmup", cache->warmup);
+	info_table_end(h); /* page_cache */
+}
+
 static void
 vy_info_append_disk(struct vy_env *env, struct info_handler *h)
 {
@@ -321,6 +349,7 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *h)
 	info_begin(h);
 	vy_info_append_tx(env, h);
 	vy_info_append_memory(env, h);
+	vy_info_append_page_cache(env, h);
 	vy_info_append_disk(env, h);
 	vy_info_append_scheduler(env, h);
 	vy_info_append_regulator(env, h);
@@ -385,6 +414,11 @@ vinyl_index_stat(struct index *index, struct info_handler *h)
 	info_append_int(h, "applied", stat->upsert.applied);
 	info_table_end(h); /* upsert */
 
+	info_table_begin(h, "throttle");
+	info_append_int(h, "count", stat->throttle.count);
+	info_append_double(h, "time", stat->throttle.time);
+	info_table_end(h); /* throttle */
+
 	info_table_begin(h, "memory");
 	vy_info_append_stmt_counter(h, NULL, &stat->memory.count);
 	info_table_begin(h, "iterator");
@@ -475,6 +509,7 @@ vinyl_index_reset_stat(struct index *index)
 	vy_stmt_counter_reset(&stat->skip);
 	vy_stmt_counter_reset(&stat->put);
 	memset(&stat->upsert, 0, sizeof(stat->upsert));
+	memset(&stat->throttle, 0, sizeof(stat->throttle));
 
 	/* Iterator */
 	memset(&stat->txw.iterator, 0, sizeof(stat->txw.iterator));
@@ -523,6 +558,12 @@ vinyl_engine_reset_stat(struct engine *engine)
 	struct vy_tx_manager *xm = env->xm;
 	memset(&xm->stat, 0, sizeof(xm->stat));
 
+	struct vy_page_cache *page_cache = &env->run_env.page_cache;
+	page_cache->lookup = 0;
+	page_cache->hit = 0;
+	page_cache->evict = 0;
+	page_cache->warmup = 0;
+
 	vy_scheduler_reset_stat(&env->scheduler);
 	vy_regulator_reset_stat(&env->regulator);
 }
@@ -1624,6 +1665,54 @@ vy_check_is_unique_secondary(struct vy_tx *tx, const struct vy_read_view **rv,
 	return 0;
 }
 
+/**
+ * Return true if insertion of a new tuple requires checking
+ * uniqueness in the given secondary index.
+ */
+static inline bool
+vy_check_is_unique_secondary_needed(struct space *space, struct vy_lsm *lsm,
+				    uint64_t column_mask)
+{
+	if (!space_needs_check_unique_constraint(space, lsm->index_id))
+		return false;
+	return !key_update_can_be_skipped(lsm->key_def->column_mask,
+					  column_mask);
+}
+
+/**
+ * Submit reads of the disk pages that may be needed to check
+ * uniqueness of a new tuple in a secondary index to a prefetch
+ * batch.
+ */
+static void
+vy_check_is_unique_secondary_prefetch(const struct vy_read_view **rv,
+				      struct vy_lsm *lsm, struct tuple *stmt,
+				      struct vy_page_prefetch *prefetch)
+{
+	int count = 1;
+	if (lsm->cmp_def->is_multikey)
+		count = tuple_multikey_count(stmt, lsm->cmp_def);
+	for (int i = 0; i < count; i++) {
+		int multikey_idx = lsm->cmp_def->is_multikey ?
+				   i : MULTIKEY_NONE;
+		if (lsm->key_def->is_nullable &&
+		    tuple_key_contains_null(stmt, lsm->key_def, multikey_idx))
+			continue;
+		struct tuple *key = vy_stmt_extract_key(stmt, lsm->key_def,
+							lsm->env->key_format,
+							multikey_idx);
+		if (key == NULL) {
+			diag_clear(diag_get());
+			return;
+		}
+		struct vy_entry entry;
+		entry.stmt = key;
+		entry.hint = vy_stmt_hint(key, lsm->cmp_def);
+		vy_point_lookup_prefetch(lsm, rv, entry, prefetch);
+		tuple_unref(key);
+	}
+}
+
 /**
  * Check if insertion of a new tuple violates unique constraint
  * of any index of the space.
@@ -1661,25 +1750,56 @@ vy_check_is_unique(struct vy_env *env, struct vy_tx *tx,
 	 * if this is INSERT, because REPLACE will silently overwrite
 	 * the existing tuple, if any.
 	 */
-	if (space_needs_check_unique_constraint(space, 0) &&
-	    vy_stmt_type(stmt) == IPROTO_INSERT) {
+	bool check_primary = space_needs_check_unique_constraint(space, 0) &&
+			     vy_stmt_type(stmt) == IPROTO_INSERT;
+	/*
+	 * For secondary indexes, uniqueness must be checked on both
+	 * INSERT and REPLACE.
+	 */
+	int check_count = check_primary ? 1 : 0;
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		struct vy_lsm *lsm = vy_lsm(space->index[i]);
+		if (vy_check_is_unique_secondary_needed(space, lsm,
+							column_mask))
+			check_count++;
+	}
+
+	/*
+	 * Lookups are done one by one, each waiting for a disk read,
+	 * if any, so if there's more than one index to check, read
+	 * all pages the lookups may need in parallel first.
+	 */
+	if (check_count > 1) {
+		struct vy_page_prefetch prefetch;
+		vy_page_prefetch_create(&prefetch);
+		if (check_primary) {
+			struct vy_lsm *pk = vy_lsm(space->index[0]);
+			struct vy_entry entry;
+			entry.stmt = stmt;
+			entry.hint = vy_stmt_hint(stmt, pk->cmp_def);
+			vy_point_lookup_prefetch(pk, rv, entry, &prefetch);
+		}
+		for (uint32_t i = 1; i < space->index_count; i++) {
+			struct vy_lsm *lsm = vy_lsm(space->index[i]);
+			if (vy_check_is_unique_secondary_needed(space, lsm,
+								column_mask))
+				vy_check_is_unique_secondary_prefetch(
+					rv, lsm, stmt, &prefetch);
+		}
+		vy_page_prefetch_wait(&prefetch);
+	}
+
+	if (check_primary) {
 		struct vy_lsm *lsm = vy_lsm(space->index[0]);
 		if (vy_check_is_unique_primary(tx, rv, space_name(space),
 					       index_name_by_id(space, 0),
 					       lsm, stmt) != 0)
 			return -1;
 	}
-
-	/*
-	 * For secondary indexes, uniqueness must be checked on both
-	 * INSERT and REPLACE.
-	 */
 	for (uint32_t i = 1; i < space->index_count; i++) {
 		struct vy_lsm *lsm = vy_lsm(space->index[i]);
-		if (!space_needs_check_unique_constraint(space, lsm->index_id))
-			continue;
-		if (key_update_can_be_skipped(lsm->key_def->column_mask,
-					      column_mask))
+		if (!vy_check_is_unique_secondary_needed(space, lsm,
+							 column_mask))
 			continue;
 		if (vy_check_is_unique_secondary(tx, rv, space_name(space),
 						 index_name_by_id(space, i),
@@ -2442,6 +2562,25 @@ vinyl_engine_begin(struct engine *engine, struct txn *txn)
 	return 0;
 }
 
+/**
+ * Account the time a transaction spent waiting for memory quota
+ * to all LSM trees it writes to.
+ */
+static void
+vy_tx_account_throttle(struct vy_tx *tx, double time)
+{
+	struct vy_lsm *lsm = NULL;
+	struct txv *v = write_set_first(&tx->write_set);
+	for (; v != NULL; v = write_set_next(&tx->write_set, v)) {
+		/* The write set is sorted by LSM tree first. */
+		if (v->lsm == lsm)
+			continue;
+		lsm = v->lsm;
+		lsm->stat.throttle.count++;
+		lsm->stat.throttle.time += time;
+	}
+}
+
 static int
 vinyl_engine_prepare(struct engine *engine, struct txn *txn)
 {
@@ -2467,13 +2606,18 @@ vinyl_engine_prepare(struct engine *engine, struct txn *txn)
 	 * the transaction to be sent to read view or aborted, we call
 	 * it before checking for conflicts.
 	 */
-	if (vy_quota_use(&env->quota, VY_QUOTA_CONSUMER_TX,
-			 tx->write_size, timeout) != 0)
+	double wait_start = ev_monotonic_now(loop());
+	int rc = vy_quota_use(&env->quota, VY_QUOTA_CONSUMER_TX,
+			      tx->write_size, timeout);
+	double wait_time = ev_monotonic_now(loop()) - wait_start;
+	if (wait_time > 0)
+		vy_tx_account_throttle(tx, wait_time);
+	if (rc != 0)
 		return -1;
 
 	size_t mem_used_before = lsregion_used(&env->mem_env.allocator);
 
-	int rc = vy_tx_prepare(tx);
+	rc = vy_tx_prepare(tx);
 
 	size_t mem_used_after = lsregion_used(&env->mem_env.allocator);
 	assert(mem_used_after >= mem_used_before);
@@ -2610,6 +2754,8 @@ static struct vy_squash_queue *
 vy_squash_queue_new(void);
 static void
 vy_squash_queue_delete(struct vy_squash_queue *q);
+static int
+vy_env_on_shutdown_f(void *arg);
 static void
 vy_squash_schedule(struct vy_lsm *lsm, struct vy_entry entry,
 		   void /* struct vy_env */ *arg);
@@ -2663,6 +2809,9 @@ vy_env_new(const char *path, size_t memory,
 	               sizeof(struct vinyl_iterator));
 	vy_cache_env_create(&e->cache_env, slab_cache);
 	vy_run_env_create(&e->run_env, read_threads);
+	fiber_cond_create(&e->page_cache_cond);
+	if (box_on_shutdown(e, vy_env_on_shutdown_f, NULL) != 0)
+		panic("failed to set vinyl shutdown trigger");
 	vy_log_init(e->path);
 	return e;
 
@@ -2682,6 +2831,14 @@ vy_env_new(const char *path, size_t memory,
 static void
 vy_env_delete(struct vy_env *e)
 {
+	/*
+	 * The page cache fibers are stopped by the shutdown trigger,
+	 * the event loop isn't running anymore so they can't be
+	 * joined here.
+	 */
+	box_on_shutdown(e, NULL, vy_env_on_shutdown_f);
+	free(e->page_cache_buf);
+	fiber_cond_destroy(&e->page_cache_cond);
 	vy_regulator_destroy(&e->regulator);
 	vy_scheduler_destroy(&e->scheduler);
 	vy_squash_queue_delete(e->squash_queue);
@@ -2741,6 +2898,13 @@ vinyl_engine_set_cache(struct engine *engine, size_t quota)
 	vy_cache_env_set_quota(&env->cache_env, quota);
 }
 
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_page_cache(&env->run_env, quota);
+}
+
 int
 vinyl_engine_set_memory(struct engine *engine, size_t size)
 {
@@ -2788,6 +2952,210 @@ vinyl_engine_set_snap_io_rate_limit(struct engine *engine, double limit)
 
 /** }}} Environment */
 
+/* {{{ Page cache warmup */
+
+/**
+ * Name of the file in the vinyl directory where the list of pages
+ * stored in the page cache is saved on checkpoint.
+ */
+#define VY_PAGE_CACHE_FILE_NAME "vinyl.pagecache"
+
+static void
+vy_env_page_cache_path(struct vy_env *env, char *path)
+{
+	snprintf(path, PATH_MAX, "%s/%s", env->path, VY_PAGE_CACHE_FILE_NAME);
+}
+
+static int
+vy_page_cache_saver_f(va_list ap)
+{
+	struct vy_env *env = va_arg(ap, struct vy_env *);
+	while (!fiber_is_cancelled()) {
+		if (env->page_cache_buf == NULL) {
+			fiber_cond_wait(&env->page_cache_cond);
+			continue;
+		}
+		char *buf = env->page_cache_buf;
+		size_t size = env->page_cache_buf_size;
+		env->page_cache_buf = NULL;
+		char path[PATH_MAX];
+		vy_env_page_cache_path(env, path);
+		if (vy_page_cache_write(path, buf, size) != 0)
+			diag_log();
+		free(buf);
+	}
+	return 0;
+}
+
+/**
+ * Save the list of cached pages so that the page cache can be
+ * warmed up after restart. The list is encoded right away while
+ * the file is written in the background by the page cache saver
+ * fiber so this function doesn't yield. A failure isn't critical,
+ * so it's only logged.
+ */
+static void
+vy_env_save_page_cache(struct vy_env *env)
+{
+	struct vy_page_cache *cache = &env->run_env.page_cache;
+	if (cache->quota == 0)
+		return;
+	size_t size;
+	char *buf = vy_page_cache_dump(cache, &size);
+	if (buf == NULL) {
+		diag_log();
+		return;
+	}
+	/* A list that hasn't been written yet is outdated. */
+	free(env->page_cache_buf);
+	env->page_cache_buf = buf;
+	env->page_cache_buf_size = size;
+	if (env->page_cache_saver != NULL) {
+		fiber_cond_signal(&env->page_cache_cond);
+		return;
+	}
+	struct fiber *fiber = fiber_new_system("vinyl.pagecache",
+					       vy_page_cache_saver_f);
+	if (fiber == NULL) {
+		diag_log();
+		return;
+	}
+	fiber_set_joinable(fiber, true);
+	env->page_cache_saver = fiber;
+	fiber_start(fiber, env);
+}
+
+/** Callback passed to space_foreach() to collect all vinyl runs. */
+static int
+vy_warmup_add_space(struct space *space, void *arg)
+{
+	struct mh_i64ptr_t *runs = arg;
+	if (!space_is_vinyl(space))
+		return 0;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct vy_lsm *lsm = vy_lsm(space->index[i]);
+		struct vy_run *run;
+		rlist_foreach_entry(run, &lsm->runs, in_lsm) {
+			struct mh_i64ptr_node_t node = { run->id, run };
+			mh_i64ptr_put(runs, &node, NULL, NULL);
+			vy_run_ref(run);
+		}
+	}
+	return 0;
+}
+
+/**
+ * Read the pages that were stored in the page cache at the time
+ * of the last checkpoint, hottest first, until the cache is full.
+ * The reads are done by reader threads, at most one per thread at
+ * a time, so as not to stall lookups issued by user requests.
+ */
+static void
+vy_env_warm_up_page_cache(struct vy_env *env)
+{
+	struct vy_run_env *run_env = &env->run_env;
+	struct vy_page_cache *cache = &run_env->page_cache;
+	char path[PATH_MAX];
+	vy_env_page_cache_path(env, path);
+	struct vy_page_id *ids;
+	uint32_t count;
+	if (vy_page_cache_load(path, &ids, &count) != 0) {
+		diag_log();
+		return;
+	}
+	if (count == 0)
+		return;
+	struct mh_i64ptr_t *runs = mh_i64ptr_new();
+	space_foreach(vy_warmup_add_space, runs);
+	struct vy_page_prefetch prefetch;
+	vy_page_prefetch_create(&prefetch);
+	size_t size = 0;
+	uint32_t submitted = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (fiber_is_cancelled() ||
+		    run_env->reader_pool == NULL || cache->quota == 0)
+			break;
+		mh_int_t k = mh_i64ptr_find(runs, ids[i].run_id, NULL);
+		if (k == mh_end(runs))
+			continue;
+		struct vy_run *run = mh_i64ptr_node(runs, k)->val;
+		/* Skip runs deleted by compaction meanwhile. */
+		if (rlist_empty(&run->in_lsm) ||
+		    ids[i].page_no >= run->info.page_count)
+			continue;
+		size += vy_page_cache_page_size(
+				vy_run_page_info(run, ids[i].page_no));
+		if (size > cache->quota)
+			break;
+		while (prefetch.in_progress >= run_env->reader_pool_size)
+			fiber_cond_wait(&prefetch.cond);
+		if (fiber_is_cancelled())
+			break;
+		vy_page_prefetch_add_page(&prefetch, run, ids[i].page_no,
+					  NULL);
+		submitted++;
+	}
+	vy_page_prefetch_wait(&prefetch);
+	say_info("vinyl page cache warmed up: %u pages", submitted);
+	mh_int_t k;
+	mh_foreach(runs, k)
+		vy_run_unref(mh_i64ptr_node(runs, k)->val);
+	mh_i64ptr_delete(runs);
+	free(ids);
+}
+
+static int
+vy_warmup_f(va_list ap)
+{
+	struct vy_env *env = va_arg(ap, struct vy_env *);
+	vy_env_warm_up_page_cache(env);
+	return 0;
+}
+
+/**
+ * Start a background fiber warming up the page cache. Called on
+ * recovery completion.
+ */
+static void
+vy_env_start_warmup(struct vy_env *env)
+{
+	if (env->run_env.page_cache.quota == 0 ||
+	    env->run_env.reader_pool == NULL)
+		return;
+	assert(env->warmup_fiber == NULL);
+	struct fiber *fiber = fiber_new_system("vinyl.warmup", vy_warmup_f);
+	if (fiber == NULL) {
+		diag_log();
+		return;
+	}
+	fiber_set_joinable(fiber, true);
+	env->warmup_fiber = fiber;
+	fiber_start(fiber, env);
+}
+
+/**
+ * Shutdown trigger stopping the page cache warmup and saver fibers
+ * so that they don't access the environment after it's destroyed.
+ */
+static int
+vy_env_on_shutdown_f(void *arg)
+{
+	struct vy_env *env = arg;
+	if (env->warmup_fiber != NULL) {
+		fiber_cancel(env->warmup_fiber);
+		fiber_join(env->warmup_fiber);
+		env->warmup_fiber = NULL;
+	}
+	if (env->page_cache_saver != NULL) {
+		fiber_cancel(env->page_cache_saver);
+		fiber_join(env->page_cache_saver);
+		env->page_cache_saver = NULL;
+	}
+	return 0;
+}
+
+/* }}} Page cache warmup */
+
 /* {{{ Checkpoint */
 
 static int
@@ -2829,6 +3197,7 @@ vinyl_engine_commit_checkpoint(struct engine *engine,
 	struct vy_env *env = vy_env(engine);
 	assert(env->status == VINYL_ONLINE);
 	vy_scheduler_end_checkpoint(&env->scheduler);
+	vy_env_save_page_cache(env);
 }
 
 static void
@@ -2990,8 +3359,10 @@ vinyl_engine_end_recovery(struct engine *engine)
 	 * The threads will be started lazily upon the first LSM tree
 	 * creation, see vinyl_index_open().
 	 */
-	if (e->lsm_env.lsm_count > 0)
+	if (e->lsm_env.lsm_count > 0) {
 		vy_run_env_enable_coio(&e->run_env);
+		vy_env_start_warmup(e);
+	}
 
 	e->status = VINYL_ONLINE;
 	return 0;
@@ -4630,6 +5001,8 @@ static const struct space_vtab vinyl_space_vtab = {
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ generic_space_ephemeral_rowid_next,
+	/* .ephemeral_begin_build = */ generic_space_ephemeral_begin_build,
+	/* .ephemeral_end_build = */ generic_space_ephemeral_end_build,
 	/* .init_system_space = */ generic_init_system_space,
 	/* .init_ephemeral_space = */ generic_init_ephemeral_space,
 	/* .check_index_def = */ vinyl_space_check_index_def,
@@ -4663,6 +5036,7 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .count = */ generic_index_count,
 	/* .get_internal = */ generic_index_get_internal,
 	/* .get = */ vinyl_index_get,
+	/* .get_batch = */ generic_index_get_batch,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
 	/* .create_read_view = */ generic_index_create_read_view,
@@ -676,6 +676,15 @@ vy_lsm_compaction_priority(struct vy_lsm *lsm)
 	return range->compaction_priority;
 }
 
+int64_t
+vy_lsm_compaction_read_count(struct vy_lsm *lsm)
+{
+	struct vy_range *range = vy_range_heap_top(&lsm->range_heap);
+	if (range == NULL)
+		return 0;
+	return range->compaction_read_count;
+}
+
 int64_t
 vy_lsm_range_size(struct vy_lsm *lsm)
 {
@@ -1039,33 +1048,18 @@ vy_lsm_find_range_intersection(struct vy_lsm *lsm,
 	return 0;
 }
 
-bool
-vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
+int
+vy_lsm_split_range_by_keys(struct vy_lsm *lsm, struct vy_range *range,
+			   const struct vy_entry *split_keys, int key_count)
 {
-	struct tuple_format *key_format = lsm->env->key_format;
-
-	const char *split_key_raw;
-	if (!vy_range_needs_split(range, vy_lsm_range_size(lsm),
-				  &split_key_raw))
-		return false;
-
-	/* Split a range in two parts. */
-	const int n_parts = 2;
-	struct vy_range *parts[2] = { NULL, NULL };
-	/*
-	 * Determine new ranges' boundaries.
-	 */
-	struct vy_entry split_key;
-	split_key = vy_entry_key_from_msgpack(key_format, lsm->cmp_def,
-					      split_key_raw);
-	if (split_key.stmt == NULL)
-		goto fail;
-
-	struct vy_entry keys[3];
-	keys[0] = range->begin;
-	keys[1] = split_key;
-	keys[2] = range->end;
-
+	assert(key_count > 0);
+	int n_parts = key_count + 1;
+	struct vy_range **parts = calloc(n_parts, sizeof(*parts));
+	if (parts == NULL) {
+		diag_set(OutOfMemory, n_parts * sizeof(*parts),
+			 "calloc", "range parts");
+		return -1;
+	}
 	/*
 	 * Allocate new ranges and create slices of
 	 * the old range's runs for them.
@@ -1073,7 +1067,11 @@ vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
 	struct vy_slice *slice, *new_slice;
 	struct vy_range *part = NULL;
 	for (int i = 0; i < n_parts; i++) {
-		part = vy_range_new(vy_log_next_id(), keys[i], keys[i + 1],
+		struct vy_entry begin = i > 0 ? split_keys[i - 1] :
+						range->begin;
+		struct vy_entry end = i < key_count ? split_keys[i] :
+						      range->end;
+		part = vy_range_new(vy_log_next_id(), begin, end,
 				    lsm->cmp_def);
 		if (part == NULL)
 			goto fail;
@@ -1092,6 +1090,7 @@ vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
 				vy_range_add_slice(part, new_slice);
 		}
 		part->needs_compaction = range->needs_compaction;
+		part->read_count = range->read_count / n_parts;
 		vy_range_update_compaction_priority(part, &lsm->opts);
 		vy_range_update_dumps_per_compaction(part);
 	}
@@ -1128,20 +1127,52 @@ vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
 		vy_lsm_acct_range(lsm, part);
 	}
 	lsm->range_tree_version++;
+	free(parts);
 
-	say_info("%s: split range %s by key %s", vy_lsm_name(lsm),
-		 vy_range_str(range), tuple_str(split_key.stmt));
+	if (key_count == 1) {
+		say_info("%s: split range %s by key %s", vy_lsm_name(lsm),
+			 vy_range_str(range), tuple_str(split_keys[0].stmt));
+	} else {
+		say_info("%s: split range %s in %d parts", vy_lsm_name(lsm),
+			 vy_range_str(range), n_parts);
+	}
 
 	rlist_foreach_entry(slice, &range->slices, in_range)
 		vy_slice_wait_pinned(slice);
 	vy_range_delete(range);
-	tuple_unref(split_key.stmt);
-	return true;
+	return 0;
 fail:
 	for (int i = 0; i < n_parts; i++) {
 		if (parts[i] != NULL)
 			vy_range_delete(parts[i]);
 	}
+	free(parts);
+	return -1;
+}
+
+bool
+vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
+{
+	struct tuple_format *key_format = lsm->env->key_format;
+
+	const char *split_key_raw;
+	if (!vy_range_needs_split(range, vy_lsm_range_size(lsm),
+				  &split_key_raw))
+		return false;
+
+	/* Split a range in two parts. */
+	struct vy_entry split_key;
+	split_key = vy_entry_key_from_msgpack(key_format, lsm->cmp_def,
+					      split_key_raw);
+	if (split_key.stmt == NULL)
+		goto fail;
+
+	if (vy_lsm_split_range_by_keys(lsm, range, &split_key, 1) != 0)
+		goto fail;
+
+	tuple_unref(split_key.stmt);
+	return true;
+fail:
 	if (split_key.stmt != NULL)
 		tuple_unref(split_key.stmt);
 
@@ -1203,6 +1234,7 @@ vy_lsm_coalesce_range(struct vy_lsm *lsm, struct vy_range *range)
 		vy_disk_stmt_counter_add(&result->count, &it->count);
 		if (it->needs_compaction)
 			result->needs_compaction = true;
+		result->read_count += it->read_count;
 		vy_range_delete(it);
 		it = next;
 	}
@@ -466,6 +466,13 @@ vy_lsm_generation(struct vy_lsm *lsm);
 int
 vy_lsm_compaction_priority(struct vy_lsm *lsm);
 
+/**
+ * Return compaction_read_count of the range of an LSM tree that
+ * will be compacted next.
+ */
+int64_t
+vy_lsm_compaction_read_count(struct vy_lsm *lsm);
+
 /** Return the target size of a range in an LSM tree. */
 int64_t
 vy_lsm_range_size(struct vy_lsm *lsm);
@@ -586,6 +593,15 @@ vy_lsm_find_range_intersection(struct vy_lsm *lsm,
 bool
 vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range);
 
+/**
+ * Split a range in parts by the given keys. The keys must be sorted
+ * and lie strictly within the range boundaries. The range is deleted
+ * on success. Returns 0 on success, -1 on failure.
+ */
+int
+vy_lsm_split_range_by_keys(struct vy_lsm *lsm, struct vy_range *range,
+			   const struct vy_entry *split_keys, int key_count);
+
 /**
  * Coalesce a range with one or more its neighbors if it is too small,
  * return true if the range was coalesced. We coalesce ranges by
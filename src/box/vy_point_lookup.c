@@ -188,6 +188,7 @@ vy_point_lookup_scan_slices(struct vy_lsm *lsm, const struct vy_read_view **rv,
 	size_t region_svp = region_used(&fiber()->gc);
 	if (slice_count == 0)
 		return 0;
+	range->read_count += slice_count;
 	struct vy_slice **slices =
 		xregion_alloc_array(&fiber()->gc, typeof(slices[0]),
 				    slice_count);
@@ -349,3 +350,28 @@ vy_point_lookup_mem(struct vy_lsm *lsm, const struct vy_read_view **rv,
 	vy_history_cleanup(&history);
 	return rc;
 }
+
+void
+vy_point_lookup_prefetch(struct vy_lsm *lsm, const struct vy_read_view **rv,
+			 struct vy_entry key, struct vy_page_prefetch *prefetch)
+{
+	if (vy_stmt_is_full_key(key.stmt, lsm->cmp_def)) {
+		struct vy_entry entry;
+		if (vy_point_lookup_mem(lsm, rv, key, &entry) != 0) {
+			diag_clear(diag_get());
+			return;
+		}
+		if (entry.stmt != NULL) {
+			tuple_unref(entry.stmt);
+			return;
+		}
+	}
+	struct vy_range *range = vy_range_tree_find_by_key(&lsm->range_tree,
+							   ITER_EQ, key);
+	assert(range != NULL);
+	struct vy_slice *slice;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		vy_page_prefetch_add(prefetch, slice, key, lsm->cmp_def,
+				     lsm->key_def, &lsm->stat.disk.iterator);
+	}
+}
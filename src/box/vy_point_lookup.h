@@ -54,6 +54,7 @@ extern "C" {
 struct vy_lsm;
 struct vy_tx;
 struct vy_read_view;
+struct vy_page_prefetch;
 
 /**
  * Given a key that has all index parts (including primary index
@@ -88,6 +89,18 @@ int
 vy_point_lookup_mem(struct vy_lsm *lsm, const struct vy_read_view **rv,
 		    struct vy_entry key, struct vy_entry *ret);
 
+/**
+ * Submit reads of the disk pages that vy_point_lookup() may need
+ * to look up the given key to a prefetch batch. Nothing is read if
+ * the key is found in memory. The function doesn't yield.
+ *
+ * The LSM tree must not be destroyed until the prefetch batch
+ * is complete.
+ */
+void
+vy_point_lookup_prefetch(struct vy_lsm *lsm, const struct vy_read_view **rv,
+			 struct vy_entry key, struct vy_page_prefetch *prefetch);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -261,6 +261,69 @@ vy_range_remove_slice(struct vy_range *range, struct vy_slice *slice)
 	range->version++;
 }
 
+/**
+ * Size-tiered compaction strategy, see INDEX_COMPACTION_STRATEGY_TIERED.
+ *
+ * Runs are grouped in tiers: a run belongs to the same tier as the
+ * previous (newer) run unless it is more than run_size_ratio times
+ * bigger than the first run of the tier. A tier is compacted along
+ * with all newer tiers once it has more than run_count_per_level
+ * runs. The resulting run moves to the next tier. Unlike the leveled
+ * strategy, we don't try to keep a single run at the last level so
+ * data written once, e.g. in an append-mostly space, is rewritten
+ * only when tiers of the size of this data fill up.
+ */
+static void
+vy_range_update_compaction_priority_tiered(struct vy_range *range,
+					   const struct index_opts *opts)
+{
+	/* Total number of statements in checked runs. */
+	struct vy_disk_stmt_counter total_stmt_count;
+	vy_disk_stmt_counter_reset(&total_stmt_count);
+	/* Total number of checked runs. */
+	uint32_t total_run_count = 0;
+	/* Estimated size of a compacted run, if compaction is scheduled. */
+	uint64_t est_new_run_size = 0;
+	/* The number of runs in the current tier. */
+	uint32_t tier_run_count = 0;
+	/* Max size of a run in the current tier. */
+	uint64_t tier_max_run_size = 0;
+
+	struct vy_slice *slice;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		uint64_t size = MAX(slice->count.bytes, 1);
+		total_run_count++;
+		vy_disk_stmt_counter_add(&total_stmt_count, &slice->count);
+		if (size > tier_max_run_size) {
+			/*
+			 * The run is too big for the current tier.
+			 * Start a new tier. If we have already scheduled
+			 * compaction of upper tiers and the compacted run
+			 * will end up in this tier, account it right away
+			 * to avoid a cascading compaction.
+			 */
+			tier_run_count = 1;
+			if (est_new_run_size * opts->run_size_ratio >= size)
+				tier_run_count++;
+			tier_max_run_size = size * opts->run_size_ratio;
+		} else {
+			tier_run_count++;
+		}
+		/*
+		 * Randomize compaction pace among ranges, see
+		 * vy_range_update_compaction_priority().
+		 */
+		uint32_t max_run_count = opts->run_count_per_level;
+		if (slice->seed < RAND_MAX / 10)
+			max_run_count++;
+		if (tier_run_count > max_run_count) {
+			range->compaction_priority = total_run_count;
+			range->compaction_queue = total_stmt_count;
+			est_new_run_size = total_stmt_count.bytes;
+		}
+	}
+}
+
 /**
  * To reduce write amplification caused by compaction, we follow
  * the LSM tree design. Runs in each range are divided into groups
@@ -291,6 +354,7 @@ vy_range_update_compaction_priority(struct vy_range *range,
 	assert(opts->run_count_per_level > 0);
 	assert(opts->run_size_ratio > 1);
 
+	range->compaction_read_count = range->read_count;
 	range->compaction_priority = 0;
 	vy_disk_stmt_counter_reset(&range->compaction_queue);
 
@@ -306,6 +370,11 @@ vy_range_update_compaction_priority(struct vy_range *range,
 		return;
 	}
 
+	if (opts->compaction_strategy == INDEX_COMPACTION_STRATEGY_TIERED) {
+		vy_range_update_compaction_priority_tiered(range, opts);
+		return;
+	}
+
 	/* Total number of statements in checked runs. */
 	struct vy_disk_stmt_counter total_stmt_count;
 	vy_disk_stmt_counter_reset(&total_stmt_count);
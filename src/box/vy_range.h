@@ -119,6 +119,19 @@ struct vy_range {
 	bool needs_compaction;
 	/** Number of times the range was compacted. */
 	int n_compactions;
+	/**
+	 * Number of run slices probed by reads from this range, i.e.
+	 * the read amplification paid by the range. Halved whenever
+	 * the range is compacted so that it reflects recent reads.
+	 */
+	int64_t read_count;
+	/**
+	 * Value of read_count at the time compaction_priority was last
+	 * updated. Ranges of equal compaction priority are ordered by
+	 * it in the heap, because read_count changes on every read
+	 * without updating the heap.
+	 */
+	int64_t compaction_read_count;
 	/**
 	 * Number of dumps it takes to trigger major compaction in
 	 * this range, see vy_run::dump_count for more details.
@@ -143,7 +156,10 @@ struct vy_range {
 static inline bool
 vy_range_heap_less(struct vy_range *r1, struct vy_range *r2)
 {
-	return r1->compaction_priority > r2->compaction_priority;
+	if (r1->compaction_priority != r2->compaction_priority)
+		return r1->compaction_priority > r2->compaction_priority;
+	/* Compacting a read-hot range first cuts read latency most. */
+	return r1->compaction_read_count > r2->compaction_read_count;
 }
 #define HEAP_LESS(h, l, r) vy_range_heap_less(l, r)
 #define heap_value_t struct vy_range
@@ -679,6 +679,7 @@ static void
 vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 {
 	assert(itr->curr_range != NULL);
+	itr->curr_range->read_count += itr->curr_range->slice_count;
 	enum iterator_type iterator_type = (itr->iterator_type != ITER_REQ ?
 					    itr->iterator_type : ITER_LE);
 	struct vy_lsm *lsm = itr->lsm;
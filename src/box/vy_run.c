@@ -30,6 +30,7 @@
  */
 #include "vy_run.h"
 
+#include <fcntl.h>
 #include <zstd.h>
 
 #include "fiber.h"
@@ -38,6 +39,7 @@
 #include "cbus.h"
 #include "memory.h"
 #include "coio_task.h"
+#include "coio_file.h"
 
 #include "replication.h"
 #include "tuple_bloom.h"
@@ -74,6 +76,12 @@ const char *vy_file_suffix[] = {
 /* sync run and index files very 16 MB */
 #define VY_RUN_SYNC_INTERVAL (1 << 24)
 
+/**
+ * Amount of data a slice stream asks the kernel to read ahead,
+ * see vy_slice_stream_read_ahead().
+ */
+enum { VY_SLICE_STREAM_READ_AHEAD = 4 * 1024 * 1024 };
+
 /**
  * We read runs in background threads so as not to stall tx.
  * This structure represents such a thread.
@@ -111,6 +119,15 @@ struct vy_page_read_task {
 	struct vy_page *page;
 };
 
+static void
+vy_page_cache_create(struct vy_page_cache *cache);
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache);
+
+static void
+vy_page_cache_purge_run(struct vy_page_cache *cache, struct vy_run *run);
+
 /** Destructor for env->zdctx_key thread-local variable */
 static void
 vy_free_zdctx(void *arg)
@@ -182,6 +199,7 @@ vy_run_env_create(struct vy_run_env *env, int read_threads)
 	tt_pthread_key_create(&env->zdctx_key, vy_free_zdctx);
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
 		       sizeof(struct vy_page_read_task));
+	vy_page_cache_create(&env->page_cache);
 	env->initial_join = false;
 }
 
@@ -193,6 +211,7 @@ vy_run_env_destroy(struct vy_run_env *env)
 {
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
+	vy_page_cache_destroy(&env->page_cache);
 	mempool_destroy(&env->read_task_pool);
 	tt_pthread_key_delete(env->zdctx_key);
 }
@@ -285,16 +304,49 @@ vy_run_new(struct vy_run_env *env, int64_t id)
 	return run;
 }
 
+/**
+ * Return true if the vinyl page cache is enabled. Without it the OS
+ * page cache is the only cache of run files so we don't give the
+ * kernel any hints about them and leave it to the default policy.
+ */
+static inline bool
+vy_run_env_has_page_cache(struct vy_run_env *env)
+{
+	return env->page_cache.quota > 0;
+}
+
+/**
+ * Prepare a run file descriptor for reading pages. Lookups read
+ * pages at random so kernel read-ahead, which may have been enabled
+ * for the descriptor by xlog_cursor_open(), would only flush useful
+ * data from the OS page cache. Slice streams, which read runs
+ * sequentially, ask for read-ahead explicitly.
+ */
+static void
+vy_run_set_fd(struct vy_run *run, int fd)
+{
+	assert(run->fd < 0);
+	run->fd = fd;
+#ifdef HAVE_POSIX_FADVISE
+	if (vy_run_env_has_page_cache(run->env) &&
+	    posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM) != 0)
+		say_syserror("posix_fadvise, fd=%i", fd);
+#endif /* HAVE_POSIX_FADVISE */
+}
+
 static void
 vy_run_clear(struct vy_run *run)
 {
-	if (run->page_info != NULL) {
+	vy_page_cache_purge_run(&run->env->page_cache, run);
+	if (run->page_info != NULL && run->page_keys == NULL) {
 		uint32_t page_no;
 		for (page_no = 0; page_no < run->info.page_count; ++page_no)
 			vy_page_info_destroy(run->page_info + page_no);
-		free(run->page_info);
 	}
+	free(run->page_info);
 	run->page_info = NULL;
+	free(run->page_keys);
+	run->page_keys = NULL;
 	run->page_index_size = 0;
 	run->info.page_count = 0;
 	if (run->info.bloom != NULL) {
@@ -679,6 +731,11 @@ vy_run_info_decode(struct vy_run_info *run_info,
 			if (run_info->bloom == NULL)
 				return -1;
 			break;
+		case VY_RUN_INFO_XOR_FILTER:
+			run_info->bloom = tuple_bloom_decode_xor(&pos);
+			if (run_info->bloom == NULL)
+				return -1;
+			break;
 		case VY_RUN_INFO_STMT_STAT:
 			vy_stmt_stat_decode(&run_info->stmt_stat, &pos);
 			break;
@@ -707,6 +764,10 @@ vy_page_new(const struct vy_page_info *page_info)
 			 "load_page", "page cache");
 		return NULL;
 	}
+	page->refs = 1;
+	page->run = NULL;
+	page->is_hot = false;
+	rlist_create(&page->in_cache);
 	page->unpacked_size = page_info->unpacked_size;
 	page->row_count = page_info->row_count;
 	page->row_index = calloc(page_info->row_count, sizeof(uint32_t));
@@ -743,6 +804,327 @@ vy_page_delete(struct vy_page *page)
 	free(page);
 }
 
+static inline void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+static inline void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/* {{{ vy_page_cache */
+
+/**
+ * Max percentage of the page cache quota that may be taken up by
+ * pages stored in the hot list, see vy_page_cache.
+ */
+enum { VY_PAGE_CACHE_HOT_PCT = 75 };
+
+/** Size of memory taken up by a page. */
+static inline size_t
+vy_page_size(struct vy_page *page)
+{
+	return sizeof(*page) + page->unpacked_size +
+	       page->row_count * sizeof(*page->row_index);
+}
+
+static void
+vy_page_cache_create(struct vy_page_cache *cache)
+{
+	memset(cache, 0, sizeof(*cache));
+	rlist_create(&cache->cold);
+	rlist_create(&cache->hot);
+}
+
+/** Remove a page from the cache. */
+static void
+vy_page_cache_remove(struct vy_page_cache *cache, struct vy_page *page)
+{
+	assert(page->run != NULL);
+	assert(page->run->cached_pages[page->page_no] == page);
+	size_t size = vy_page_size(page);
+	assert(cache->mem_used >= size);
+	cache->mem_used -= size;
+	if (page->is_hot) {
+		assert(cache->hot_mem_used >= size);
+		cache->hot_mem_used -= size;
+		page->is_hot = false;
+	}
+	rlist_del_entry(page, in_cache);
+	page->run->cached_pages[page->page_no] = NULL;
+	page->run = NULL;
+	vy_page_unref(page);
+}
+
+/** Evict pages until the cache fits in the quota. */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache)
+{
+	while (cache->mem_used > cache->quota) {
+		struct rlist *list = !rlist_empty(&cache->cold) ?
+				     &cache->cold : &cache->hot;
+		assert(!rlist_empty(list));
+		struct vy_page *page = rlist_first_entry(list, struct vy_page,
+							 in_cache);
+		vy_page_cache_remove(cache, page);
+		cache->evict++;
+	}
+}
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache)
+{
+	cache->quota = 0;
+	vy_page_cache_evict(cache);
+}
+
+/**
+ * Look up a page in the cache. Returns NULL if the page isn't
+ * cached. The returned page isn't referenced.
+ */
+static struct vy_page *
+vy_page_cache_get(struct vy_page_cache *cache, struct vy_run *run,
+		  uint32_t page_no)
+{
+	cache->lookup++;
+	if (run->cached_pages == NULL)
+		return NULL;
+	struct vy_page *page = run->cached_pages[page_no];
+	if (page == NULL)
+		return NULL;
+	cache->hit++;
+	if (!page->is_hot) {
+		page->is_hot = true;
+		cache->hot_mem_used += vy_page_size(page);
+	}
+	rlist_move_tail_entry(&cache->hot, page, in_cache);
+	/* Move pages overflowing the hot list to the cold list. */
+	size_t hot_quota = cache->quota / 100 * VY_PAGE_CACHE_HOT_PCT;
+	while (cache->hot_mem_used > hot_quota) {
+		struct vy_page *victim = rlist_first_entry(&cache->hot,
+							   struct vy_page,
+							   in_cache);
+		victim->is_hot = false;
+		cache->hot_mem_used -= vy_page_size(victim);
+		rlist_move_tail_entry(&cache->cold, victim, in_cache);
+	}
+	return page;
+}
+
+/** Add a page read from a run file to the cache. */
+static void
+vy_page_cache_put(struct vy_page_cache *cache, struct vy_run *run,
+		  struct vy_page *page)
+{
+	assert(page->run == NULL);
+	size_t size = vy_page_size(page);
+	if (size > cache->quota)
+		return;
+	if (run->cached_pages == NULL) {
+		run->cached_pages = calloc(run->info.page_count,
+					   sizeof(*run->cached_pages));
+		/* The page cache is optional so ignore errors. */
+		if (run->cached_pages == NULL)
+			return;
+	}
+	/*
+	 * The page could have been read and cached by another
+	 * fiber while this one was waiting for the reader thread.
+	 */
+	if (run->cached_pages[page->page_no] != NULL)
+		return;
+	run->cached_pages[page->page_no] = page;
+	page->run = run;
+	vy_page_ref(page);
+	rlist_add_tail_entry(&cache->cold, page, in_cache);
+	cache->mem_used += size;
+	vy_page_cache_evict(cache);
+}
+
+/** Remove all pages of a run from the cache. */
+static void
+vy_page_cache_purge_run(struct vy_page_cache *cache, struct vy_run *run)
+{
+	if (run->cached_pages == NULL)
+		return;
+	for (uint32_t page_no = 0; page_no < run->info.page_count; page_no++) {
+		struct vy_page *page = run->cached_pages[page_no];
+		if (page != NULL)
+			vy_page_cache_remove(cache, page);
+	}
+	free(run->cached_pages);
+	run->cached_pages = NULL;
+}
+
+void
+vy_run_env_set_page_cache(struct vy_run_env *env, size_t quota)
+{
+	env->page_cache.quota = quota;
+	vy_page_cache_evict(&env->page_cache);
+}
+
+size_t
+vy_page_cache_page_size(struct vy_page_info *page_info)
+{
+	return sizeof(struct vy_page) + page_info->unpacked_size +
+	       page_info->row_count * sizeof(uint32_t);
+}
+
+/**
+ * Signature of a file written by vy_page_cache_write(). It's followed
+ * by a MsgPack array of run ids and page numbers: [id1, no1, ...].
+ */
+static const char vy_page_cache_file_magic[] = "VYPAGECACHE\n";
+
+/** Encode the ids of the pages stored in a page cache list, MRU first. */
+static char *
+vy_page_cache_encode_list(struct rlist *list, char *pos)
+{
+	struct vy_page *page;
+	rlist_foreach_entry_reverse(page, list, in_cache) {
+		pos = mp_encode_uint(pos, page->run->id);
+		pos = mp_encode_uint(pos, page->page_no);
+	}
+	return pos;
+}
+
+char *
+vy_page_cache_dump(struct vy_page_cache *cache, size_t *size)
+{
+	uint32_t count = 0;
+	struct vy_page *page;
+	rlist_foreach_entry(page, &cache->hot, in_cache)
+		count++;
+	rlist_foreach_entry(page, &cache->cold, in_cache)
+		count++;
+	size_t magic_size = strlen(vy_page_cache_file_magic);
+	size_t max_size = magic_size + mp_sizeof_array(UINT32_MAX) +
+			  count * (mp_sizeof_uint(INT64_MAX) +
+				   mp_sizeof_uint(UINT32_MAX));
+	char *buf = malloc(max_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, max_size, "malloc", "page cache list");
+		return NULL;
+	}
+	char *pos = buf;
+	memcpy(pos, vy_page_cache_file_magic, magic_size);
+	pos += magic_size;
+	pos = mp_encode_array(pos, 2 * count);
+	pos = vy_page_cache_encode_list(&cache->hot, pos);
+	pos = vy_page_cache_encode_list(&cache->cold, pos);
+	assert(pos <= buf + max_size);
+	*size = pos - buf;
+	return buf;
+}
+
+int
+vy_page_cache_write(const char *path, const char *buf, size_t size)
+{
+	char tmp_path[PATH_MAX];
+	snprintf(tmp_path, sizeof(tmp_path), "%s%s", path, inprogress_suffix);
+	int fd = coio_file_open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to create file '%s'", tmp_path);
+		return -1;
+	}
+	if (coio_write(fd, buf, size) < 0 || coio_fsync(fd) != 0) {
+		diag_set(SystemError, "failed to write file '%s'", tmp_path);
+		coio_file_close(fd);
+		goto fail_unlink;
+	}
+	coio_file_close(fd);
+	if (coio_rename(tmp_path, path) != 0) {
+		diag_set(SystemError, "failed to rename file '%s'", tmp_path);
+		goto fail_unlink;
+	}
+	return 0;
+fail_unlink:
+	coio_unlink(tmp_path);
+	return -1;
+}
+
+int
+vy_page_cache_load(const char *path, struct vy_page_id **ids,
+		   uint32_t *count)
+{
+	*ids = NULL;
+	*count = 0;
+	int fd = coio_file_open(path, O_RDONLY, 0);
+	if (fd < 0) {
+		if (errno == ENOENT)
+			return 0;
+		diag_set(SystemError, "failed to open file '%s'", path);
+		return -1;
+	}
+	char *buf = NULL;
+	struct vy_page_id *result = NULL;
+	struct stat st;
+	if (coio_fstat(fd, &st) != 0) {
+		diag_set(SystemError, "failed to stat file '%s'", path);
+		goto fail;
+	}
+	size_t size = st.st_size;
+	size_t magic_size = strlen(vy_page_cache_file_magic);
+	if (size <= magic_size)
+		goto invalid;
+	buf = malloc(size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "page cache list");
+		goto fail;
+	}
+	if (coio_preadn(fd, buf, size, 0) < 0) {
+		diag_set(SystemError, "failed to read file '%s'", path);
+		goto fail;
+	}
+	const char *pos = buf + magic_size;
+	const char *end = buf + size;
+	if (memcmp(buf, vy_page_cache_file_magic, magic_size) != 0 ||
+	    mp_typeof(*pos) != MP_ARRAY || mp_check(&pos, end) != 0 ||
+	    pos != end)
+		goto invalid;
+	pos = buf + magic_size;
+	uint32_t len = mp_decode_array(&pos);
+	if (len % 2 != 0)
+		goto invalid;
+	len /= 2;
+	result = malloc(len * sizeof(*result) + 1);
+	if (result == NULL) {
+		diag_set(OutOfMemory, len * sizeof(*result),
+			 "malloc", "struct vy_page_id");
+		goto fail;
+	}
+	for (uint32_t i = 0; i < len; i++) {
+		if (mp_typeof(*pos) != MP_UINT)
+			goto invalid;
+		result[i].run_id = mp_decode_uint(&pos);
+		if (mp_typeof(*pos) != MP_UINT)
+			goto invalid;
+		result[i].page_no = mp_decode_uint(&pos);
+	}
+	*ids = result;
+	*count = len;
+	free(buf);
+	coio_file_close(fd);
+	return 0;
+invalid:
+	diag_set(ClientError, ER_INVALID_MSGPACK,
+		 tt_sprintf("page cache file '%s'", path));
+fail:
+	free(result);
+	free(buf);
+	coio_file_close(fd);
+	return -1;
+}
+
+/* }}} vy_page_cache */
+
 static int
 vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	     struct xrow_header *xrow)
@@ -829,9 +1211,9 @@ vy_run_iterator_stop(struct vy_run_iterator *itr)
 		itr->curr = vy_entry_none();
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 }
@@ -991,9 +1373,175 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	return 0;
 }
 
+/** Cbus message for a page read submitted to a prefetch batch. */
+struct vy_page_prefetch_msg {
+	/** parent */
+	struct cmsg base;
+	/** Read the page in a reader thread, then complete it in tx. */
+	struct cmsg_hop route[2];
+	/** Prefetch batch this read belongs to. */
+	struct vy_page_prefetch *prefetch;
+	/** vy_run with fd - ref. counted */
+	struct vy_run *run;
+	/** Number of the page to read. */
+	uint32_t page_no;
+	/** Page to read the data into. */
+	struct vy_page *page;
+	/** Statistics to account the read to or NULL if it's a warmup. */
+	struct vy_run_iterator_stat *stat;
+	/** Set by the reader thread if the page couldn't be read. */
+	bool is_failed;
+};
+
+void
+vy_page_prefetch_create(struct vy_page_prefetch *prefetch)
+{
+	prefetch->in_progress = 0;
+	fiber_cond_create(&prefetch->cond);
+}
+
+/** Read a prefetched page. Called in a reader thread. */
+static void
+vy_page_prefetch_read_f(struct cmsg *base)
+{
+	struct vy_page_prefetch_msg *msg = (struct vy_page_prefetch_msg *)base;
+	struct vy_page_info *page_info = vy_run_page_info(msg->run,
+							  msg->page_no);
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(msg->run->env);
+	if (zdctx == NULL ||
+	    vy_page_read(msg->page, page_info, msg->run, zdctx) != 0) {
+		msg->is_failed = true;
+		diag_clear(diag_get());
+	}
+}
+
+/** Store a prefetched page in the cache. Called in tx. */
+static void
+vy_page_prefetch_complete_f(struct cmsg *base)
+{
+	struct vy_page_prefetch_msg *msg = (struct vy_page_prefetch_msg *)base;
+	struct vy_run *run = msg->run;
+	struct vy_page *page = msg->page;
+	if (!msg->is_failed) {
+		struct vy_page_info *page_info = vy_run_page_info(run,
+								  msg->page_no);
+		page->page_no = msg->page_no;
+		vy_page_cache_put(&run->env->page_cache, run, page);
+		struct vy_run_iterator_stat *stat = msg->stat;
+		if (stat != NULL) {
+			stat->read.rows += page_info->row_count;
+			stat->read.bytes += page_info->unpacked_size;
+			stat->read.bytes_compressed += page_info->size;
+			stat->read.pages++;
+		} else {
+			run->env->page_cache.warmup++;
+		}
+	}
+	vy_page_unref(page);
+	vy_run_unref(run);
+	struct vy_page_prefetch *prefetch = msg->prefetch;
+	assert(prefetch->in_progress > 0);
+	prefetch->in_progress--;
+	fiber_cond_signal(&prefetch->cond);
+	free(msg);
+}
+
+void
+vy_page_prefetch_add(struct vy_page_prefetch *prefetch,
+		     struct vy_slice *slice, struct vy_entry key,
+		     struct key_def *cmp_def, struct key_def *key_def,
+		     struct vy_run_iterator_stat *stat)
+{
+	struct vy_run *run = slice->run;
+	struct vy_run_env *env = run->env;
+	/* Reads are blocking during WAL recovery. */
+	if (env->reader_pool == NULL || env->page_cache.quota == 0)
+		return;
+	if (run->info.page_count == 0)
+		return;
+	struct tuple_bloom *bloom = run->info.bloom;
+	if (bloom != NULL && !vy_bloom_maybe_has(bloom, key, key_def))
+		return;
+	bool unused;
+	uint32_t page_no = vy_page_index_find_page(run, key, cmp_def,
+						   ITER_GE, &unused);
+	if (page_no == run->info.page_count)
+		return;
+	vy_page_prefetch_add_page(prefetch, run, page_no, stat);
+}
+
+void
+vy_page_prefetch_add_page(struct vy_page_prefetch *prefetch,
+			  struct vy_run *run, uint32_t page_no,
+			  struct vy_run_iterator_stat *stat)
+{
+	struct vy_run_env *env = run->env;
+	if (env->reader_pool == NULL || env->page_cache.quota == 0)
+		return;
+	assert(page_no < run->info.page_count);
+	if (run->cached_pages != NULL && run->cached_pages[page_no] != NULL)
+		return;
+
+	struct vy_page *page = vy_page_new(vy_run_page_info(run, page_no));
+	if (page == NULL)
+		goto fail;
+	struct vy_page_prefetch_msg *msg = malloc(sizeof(*msg));
+	if (msg == NULL) {
+		diag_set(OutOfMemory, sizeof(*msg), "malloc",
+			 "struct vy_page_prefetch_msg");
+		vy_page_delete(page);
+		goto fail;
+	}
+	msg->route[0].f = vy_page_prefetch_read_f;
+	msg->route[1].f = vy_page_prefetch_complete_f;
+	msg->route[1].pipe = NULL;
+	msg->prefetch = prefetch;
+	msg->run = run;
+	msg->page_no = page_no;
+	msg->page = page;
+	msg->stat = stat;
+	msg->is_failed = false;
+	vy_run_ref(run);
+	prefetch->in_progress++;
+
+	/* Pick a reader thread. */
+	struct vy_run_reader *reader;
+	reader = &env->reader_pool[env->next_reader++];
+	env->next_reader %= env->reader_pool_size;
+
+	msg->route[0].pipe = &reader->tx_pipe;
+	cmsg_init(&msg->base, msg->route);
+	cpipe_push(&reader->reader_pipe, &msg->base);
+	return;
+fail:
+	diag_clear(diag_get());
+}
+
+void
+vy_page_prefetch_wait(struct vy_page_prefetch *prefetch)
+{
+	while (prefetch->in_progress > 0)
+		fiber_cond_wait(&prefetch->cond);
+	fiber_cond_destroy(&prefetch->cond);
+}
+
+/**
+ * Make a page the current page of an iterator, see vy_run_iterator::
+ * curr_page. The iterator takes over the page reference.
+ */
+static void
+vy_run_iterator_keep_page(struct vy_run_iterator *itr, struct vy_page *page)
+{
+	if (itr->prev_page != NULL)
+		vy_page_unref(itr->prev_page);
+	itr->prev_page = itr->curr_page;
+	itr->curr_page = page;
+}
+
 /**
  * Read a page from disk given its number.
- * The function caches two most recently read pages.
+ * The function caches two most recently read pages in the iterator
+ * and looks up the page in the shared page cache before reading it.
  *
  * @retval 0 success
  * @retval -1 critical error
@@ -1026,6 +1574,19 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		return 0;
 	}
 
+	/* Check the shared page cache */
+	page = vy_page_cache_get(&env->page_cache, slice->run, page_no);
+	if (page != NULL) {
+		vy_page_ref(page);
+		if (key.stmt != NULL)
+			*pos_in_page = vy_page_find_key(page, key, itr->cmp_def,
+							itr->format, iterator_type,
+							equal_found);
+		vy_run_iterator_keep_page(itr, page);
+		*result = page;
+		return 0;
+	}
+
 	/* Allocate buffers */
 	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
 	page = vy_page_new(page_info);
@@ -1060,13 +1621,8 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		vy_page_delete(page);
 		return -1;
 	}
-
-	/* Update cache */
-	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
-	itr->prev_page = itr->curr_page;
-	itr->curr_page = page;
 	page->page_no = page_no;
+	vy_page_cache_put(&env->page_cache, slice->run, page);
 
 	/* Update read statistics. */
 	itr->stat->read.rows += page_info->row_count;
@@ -1074,6 +1630,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	itr->stat->read.bytes_compressed += page_info->size;
 	itr->stat->read.pages++;
 
+	vy_run_iterator_keep_page(itr, page);
 	*result = page;
 	return 0;
 }
@@ -1637,6 +2194,43 @@ vy_run_iterator_close(struct vy_run_iterator *itr)
 
 /* }}} vy_run_iterator API implementation */
 
+/**
+ * Move min keys of all the run pages to one memory block. This saves
+ * the malloc() overhead, which is comparable to the size of a key, and
+ * makes the page index binary search touch fewer cache lines. Called
+ * once the page index is complete. On allocation failure the keys are
+ * left as is.
+ */
+static void
+vy_run_compact_page_keys(struct vy_run *run)
+{
+	assert(run->page_keys == NULL);
+	size_t size = 0;
+	for (uint32_t page_no = 0; page_no < run->info.page_count; page_no++) {
+		const char *key = run->page_info[page_no].min_key;
+		const char *key_end = key;
+		mp_next(&key_end);
+		size += key_end - key;
+	}
+	if (size == 0)
+		return;
+	char *page_keys = malloc(size);
+	if (page_keys == NULL)
+		return;
+	char *pos = page_keys;
+	for (uint32_t page_no = 0; page_no < run->info.page_count; page_no++) {
+		struct vy_page_info *page = run->page_info + page_no;
+		const char *key_end = page->min_key;
+		mp_next(&key_end);
+		size_t key_size = key_end - page->min_key;
+		memcpy(pos, page->min_key, key_size);
+		vy_page_info_destroy(page);
+		page->min_key = pos;
+		pos += key_size;
+	}
+	run->page_keys = page_keys;
+}
+
 /** Account a page to run statistics. */
 static void
 vy_run_acct_page(struct vy_run *run, struct vy_page_info *page)
@@ -1747,6 +2341,7 @@ vy_run_recover(struct vy_run *run, const char *dir,
 		}
 		vy_run_acct_page(run, page);
 	}
+	vy_run_compact_page_keys(run);
 
 	/* We don't need to keep metadata file open any longer. */
 	xlog_cursor_close(&cursor, false);
@@ -1762,7 +2357,7 @@ vy_run_recover(struct vy_run *run, const char *dir,
 			 XLOG_META_TYPE_RUN, meta->filetype);
 		goto fail_close;
 	}
-	run->fd = cursor.fd;
+	vy_run_set_fd(run, cursor.fd);
 	xlog_cursor_close(&cursor, true);
 	return 0;
 
@@ -1984,8 +2579,12 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	size_t max_key_size = tmp - run_info->max_key;
 
 	uint32_t key_count = 6;
-	if (run_info->bloom != NULL)
+	uint32_t bloom_key = VY_RUN_INFO_BLOOM_FILTER;
+	if (run_info->bloom != NULL) {
 		key_count++;
+		if (run_info->bloom->is_xor)
+			bloom_key = VY_RUN_INFO_XOR_FILTER;
+	}
 
 	size_t size = mp_sizeof_map(key_count);
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_KEY) + min_key_size;
@@ -1997,7 +2596,7 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	size += mp_sizeof_uint(VY_RUN_INFO_PAGE_COUNT) +
 		mp_sizeof_uint(run_info->page_count);
 	if (run_info->bloom != NULL)
-		size += mp_sizeof_uint(VY_RUN_INFO_BLOOM_FILTER) +
+		size += mp_sizeof_uint(bloom_key) +
 			tuple_bloom_size(run_info->bloom);
 	size += mp_sizeof_uint(VY_RUN_INFO_STMT_STAT) +
 		vy_stmt_stat_sizeof(&run_info->stmt_stat);
@@ -2024,7 +2623,7 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	pos = mp_encode_uint(pos, VY_RUN_INFO_PAGE_COUNT);
 	pos = mp_encode_uint(pos, run_info->page_count);
 	if (run_info->bloom != NULL) {
-		pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM_FILTER);
+		pos = mp_encode_uint(pos, bloom_key);
 		pos = tuple_bloom_encode(run_info->bloom, pos);
 	}
 	pos = mp_encode_uint(pos, VY_RUN_INFO_STMT_STAT);
@@ -2056,6 +2655,7 @@ vy_run_write_index(struct vy_run *run, const char *dirpath,
 			 NULL, NULL);
 	struct xlog_opts opts = xlog_opts_default;
 	opts.rate_limit = run->env->snap_io_rate_limit;
+	opts.rate_limit_is_adaptive = true;
 	opts.sync_interval = VY_RUN_SYNC_INTERVAL;
 	if (xlog_create(&index_xlog, path, 0, &meta, &opts) < 0)
 		return -1;
@@ -2105,7 +2705,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression)
+		     uint64_t page_size, double bloom_fpr,
+		     enum index_bloom_type bloom_type, bool no_compression)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->run = run;
@@ -2116,6 +2717,7 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->key_def = key_def;
 	writer->page_size = page_size;
 	writer->bloom_fpr = bloom_fpr;
+	writer->bloom_type = bloom_type;
 	writer->no_compression = no_compression;
 	if (bloom_fpr < 1) {
 		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
@@ -2151,7 +2753,9 @@ vy_run_writer_create_xlog(struct vy_run_writer *writer)
 			 NULL, NULL);
 	struct xlog_opts opts = xlog_opts_default;
 	opts.rate_limit = writer->run->env->snap_io_rate_limit;
+	opts.rate_limit_is_adaptive = true;
 	opts.sync_interval = VY_RUN_SYNC_INTERVAL;
+	opts.free_cache = vy_run_env_has_page_cache(writer->run->env);
 	opts.no_compression = writer->no_compression;
 	if (xlog_create(&writer->data_xlog, path, 0, &meta, &opts) != 0)
 		return -1;
@@ -2347,21 +2951,40 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 	});
 
 	/* Sync data and link the file to the final name. */
-	if (xlog_close_reuse_fd(&writer->data_xlog, &run->fd) != 0 ||
-	    xlog_materialize(&writer->data_xlog) != 0) {
+	int fd;
+	if (xlog_close_reuse_fd(&writer->data_xlog, &fd) != 0) {
+		close(fd);
+		xlog_discard(&writer->data_xlog);
+		goto out;
+	}
+	vy_run_set_fd(run, fd);
+	if (xlog_materialize(&writer->data_xlog) != 0) {
 		xlog_discard(&writer->data_xlog);
 		goto out;
 	}
+#ifdef HAVE_POSIX_FADVISE
+	/*
+	 * Pages that are read often will end up in the vinyl page
+	 * cache so don't let the file pollute the OS page cache.
+	 * Most of it has already been dropped by the xlog writer,
+	 * see xlog_opts::free_cache, this drops the tail.
+	 */
+	if (vy_run_env_has_page_cache(run->env) &&
+	    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0)
+		say_syserror("posix_fadvise, fd=%i", fd);
+#endif /* HAVE_POSIX_FADVISE */
 
 	if (writer->bloom != NULL) {
 		run->info.bloom = tuple_bloom_new(writer->bloom,
-						  writer->bloom_fpr);
+				writer->bloom_fpr,
+				writer->bloom_type == INDEX_BLOOM_TYPE_XOR);
 		if (run->info.bloom == NULL)
 			goto out;
 	}
 	if (vy_run_write_index(run, writer->dirpath,
 			       writer->space_id, writer->iid) != 0)
 		goto out;
+	vy_run_compact_page_keys(run);
 
 	rc = 0;
 out:
@@ -2496,12 +3119,13 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		prev_tuple = NULL;
 	}
 	region_truncate(region, mem_used);
-	run->fd = cursor.fd;
+	vy_run_set_fd(run, cursor.fd);
 	xlog_cursor_close(&cursor, true);
 
 	if (bloom_builder != NULL) {
 		run->info.bloom = tuple_bloom_new(bloom_builder,
-						  opts->bloom_fpr);
+				opts->bloom_fpr,
+				opts->bloom_type == INDEX_BLOOM_TYPE_XOR);
 		if (run->info.bloom == NULL)
 			goto close_err;
 		tuple_bloom_builder_delete(bloom_builder);
@@ -2514,6 +3138,7 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 	xlog_remove_file(path, 0);
 	if (vy_run_write_index(run, dir, space_id, iid) != 0)
 		goto close_err;
+	vy_run_compact_page_keys(run);
 	return 0;
 close_err:
 	vy_run_clear(run);
@@ -2586,6 +3211,40 @@ vy_run_remove_files(const char *dir, uint32_t space_id,
 	return coio_call(vy_run_remove_files_f, dir, space_id, iid, run_id);
 }
 
+/**
+ * Ask the kernel to read ahead the pages of a slice that follow
+ * the current stream position so that they are likely to be in
+ * the OS page cache by the time the stream gets to them. A new hint
+ * is issued when a half of the previously requested data is read.
+ */
+static void
+vy_slice_stream_read_ahead(struct vy_slice_stream *stream)
+{
+#ifdef HAVE_POSIX_FADVISE
+	struct vy_slice *slice = stream->slice;
+	struct vy_run *run = slice->run;
+	if (!vy_run_env_has_page_cache(run->env))
+		return;
+	struct vy_page_info *page_info = vy_run_page_info(run, stream->page_no);
+	if (stream->read_ahead_offset >
+	    page_info->offset + VY_SLICE_STREAM_READ_AHEAD / 2)
+		return;
+	struct vy_page_info *last_page_info =
+		vy_run_page_info(run, slice->last_page_no);
+	uint64_t begin = MAX(stream->read_ahead_offset, page_info->offset);
+	uint64_t end = MIN(page_info->offset + VY_SLICE_STREAM_READ_AHEAD,
+			   last_page_info->offset + last_page_info->size);
+	if (end <= begin)
+		return;
+	if (posix_fadvise(run->fd, begin, end - begin,
+			  POSIX_FADV_WILLNEED) != 0)
+		say_syserror("posix_fadvise, fd=%i", run->fd);
+	stream->read_ahead_offset = end;
+#else
+	(void)stream;
+#endif /* HAVE_POSIX_FADVISE */
+}
+
 /**
  * Read a page with stream->page_no from the run and save it in stream->page.
  * Support function of slice stream.
@@ -2602,6 +3261,8 @@ vy_slice_stream_read_page(struct vy_slice_stream *stream)
 	if (zdctx == NULL)
 		return -1;
 
+	vy_slice_stream_read_ahead(stream);
+
 	struct vy_page_info *page_info = vy_run_page_info(run, stream->page_no);
 	stream->page = vy_page_new(page_info);
 	if (stream->page == NULL)
@@ -2759,6 +3420,7 @@ vy_slice_stream_open(struct vy_slice_stream *stream, struct vy_slice *slice,
 	stream->pos_in_page = 0; /* We'll find it later */
 	stream->page = NULL;
 	stream->entry = vy_entry_none();
+	stream->read_ahead_offset = 0;
 
 	stream->slice = slice;
 	stream->cmp_def = cmp_def;
@@ -52,8 +52,44 @@ extern "C" {
 struct vy_history;
 struct vy_run_reader;
 
+/**
+ * Cache of pages read from run files, shared by all LSM trees.
+ *
+ * Pages are stored decompressed so a hit saves both a disk read
+ * and decompression. To prevent a long range scan from flushing
+ * the pages that are accessed often, a page is first added to the
+ * cold list and moved to the hot list only when it's accessed
+ * again while cached (2Q). Pages are evicted from the cold list
+ * first. The hot list may take up to VY_PAGE_CACHE_HOT_PCT percent
+ * of the quota; pages overflowing it are moved to the cold list.
+ *
+ * The cache is only accessed from the tx thread.
+ */
+struct vy_page_cache {
+	/** Max size of cached pages, in bytes. 0 disables the cache. */
+	size_t quota;
+	/** Size of cached pages, in bytes. */
+	size_t mem_used;
+	/** Size of pages stored in the hot list, in bytes. */
+	size_t hot_mem_used;
+	/** Pages accessed once since they were cached, LRU first. */
+	struct rlist cold;
+	/** Pages accessed more than once, LRU first. */
+	struct rlist hot;
+	/** Number of page lookups. */
+	int64_t lookup;
+	/** Number of lookups that found a page in the cache. */
+	int64_t hit;
+	/** Number of pages evicted from the cache. */
+	int64_t evict;
+	/** Number of pages read into the cache on warmup. */
+	int64_t warmup;
+};
+
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
+	/** Cache of pages read from run files. */
+	struct vy_page_cache page_cache;
 	/** Write rate limit, in bytes per second. */
 	uint64_t snap_io_rate_limit;
 	/** Mempool for struct vy_page_read_task */
@@ -126,6 +162,12 @@ struct vy_run {
 	struct vy_run_info info;
 	/** Info about the run pages stored in the index file. */
 	struct vy_page_info *page_info;
+	/**
+	 * Memory block storing min keys of all the run pages or NULL
+	 * if the keys are allocated separately, see
+	 * vy_run_compact_page_keys().
+	 */
+	char *page_keys;
 	/** Run data file. */
 	int fd;
 	/** Unique ID of this run. */
@@ -173,6 +215,12 @@ struct vy_run {
 	struct rlist in_unused;
 	/** Link in vy_lsm::runs list. */
 	struct rlist in_lsm;
+	/**
+	 * Pages of this run stored in vy_run_env::page_cache,
+	 * indexed by page number, or NULL if none has been cached
+	 * yet.
+	 */
+	struct vy_page **cached_pages;
 };
 
 /**
@@ -294,6 +342,18 @@ struct vy_run_iterator {
 struct vy_page {
 	/** Page position in the run file. */
 	uint32_t page_no;
+	/**
+	 * Page reference counter, the page is freed once it hits 0.
+	 * A page is referenced by each run iterator that keeps it
+	 * and by the page cache.
+	 */
+	int refs;
+	/** Run the page was read from, set if the page is cached. */
+	struct vy_run *run;
+	/** Set if the page is in vy_page_cache::hot. */
+	bool is_hot;
+	/** Link in vy_page_cache::cold or vy_page_cache::hot. */
+	struct rlist in_cache;
 	/** Size of page data in memory, i.e. unpacked. */
 	uint32_t unpacked_size;
 	/** Number of statements in the page. */
@@ -320,6 +380,13 @@ vy_run_env_create(struct vy_run_env *env, int read_threads);
 void
 vy_run_env_destroy(struct vy_run_env *env);
 
+/**
+ * Set the max size of the page cache, evicting pages if
+ * it's exceeded.
+ */
+void
+vy_run_env_set_page_cache(struct vy_run_env *env, size_t quota);
+
 /**
  * Enable coio reads for a vinyl run environment.
  *
@@ -335,6 +402,106 @@ vy_run_env_destroy(struct vy_run_env *env);
 void
 vy_run_env_enable_coio(struct vy_run_env *env);
 
+/**
+ * Batch of page reads executed by the reader threads in parallel.
+ *
+ * A fiber that is going to do a number of point lookups one by
+ * one may first submit reads of all pages it's going to need with
+ * vy_page_prefetch_add() and then wait for them to complete with
+ * vy_page_prefetch_wait(). The pages are stored in the page cache
+ * so the lookups that follow don't have to wait for disk reads.
+ */
+struct vy_page_prefetch {
+	/** Number of page reads in progress. */
+	int in_progress;
+	/** Signaled when a page read completes. */
+	struct fiber_cond cond;
+};
+
+void
+vy_page_prefetch_create(struct vy_page_prefetch *prefetch);
+
+/**
+ * Submit a read of the page of a run slice that may store the given
+ * key. The function doesn't yield. It does nothing if the page is
+ * already cached, the bloom filter says the key isn't in the run,
+ * the page cache or the reader threads are disabled. The statistics
+ * are updated when the read completes so the caller must make sure
+ * they are still alive at that time.
+ *
+ * Errors are ignored, because prefetching is merely an optimization:
+ * if a page fails to be read, it will be read again on lookup.
+ */
+void
+vy_page_prefetch_add(struct vy_page_prefetch *prefetch,
+		     struct vy_slice *slice, struct vy_entry key,
+		     struct key_def *cmp_def, struct key_def *key_def,
+		     struct vy_run_iterator_stat *stat);
+
+/**
+ * Submit a read of a run page unless it's already cached. Works
+ * like vy_page_prefetch_add(). If @a stat is NULL, the read is
+ * accounted as a page cache warmup.
+ */
+void
+vy_page_prefetch_add_page(struct vy_page_prefetch *prefetch,
+			  struct vy_run *run, uint32_t page_no,
+			  struct vy_run_iterator_stat *stat);
+
+/**
+ * Wait for all page reads submitted to a prefetch batch to complete
+ * and destroy it. Must be called even if no reads were submitted.
+ */
+void
+vy_page_prefetch_wait(struct vy_page_prefetch *prefetch);
+
+/** Identifier of a run page saved for the page cache warmup. */
+struct vy_page_id {
+	/** ID of the run the page belongs to. */
+	int64_t run_id;
+	/** Page number in the run. */
+	uint32_t page_no;
+};
+
+/**
+ * Encode the list of pages stored in the page cache, hot pages first,
+ * so that it can be written to a file with vy_page_cache_write().
+ * Doesn't yield. On success returns a malloc'ed buffer and sets
+ * @a size to its size.
+ *
+ * Returns NULL on memory allocation error (diag is set).
+ */
+char *
+vy_page_cache_dump(struct vy_page_cache *cache, size_t *size);
+
+/**
+ * Write a page list encoded with vy_page_cache_dump() to a file so
+ * that the cache can be warmed up after restart. The file is written
+ * atomically. Yields.
+ *
+ * Returns 0 on success, -1 on error (diag is set).
+ */
+int
+vy_page_cache_write(const char *path, const char *buf, size_t size);
+
+/**
+ * Load the list of pages saved with vy_page_cache_write(). On success
+ * returns 0 and sets @a ids to a malloc'ed array of @a count page
+ * identifiers, in the order they should be read. If the file doesn't
+ * exist, the returned list is empty. Yields.
+ *
+ * Returns -1 on error (diag is set).
+ */
+int
+vy_page_cache_load(const char *path, struct vy_page_id **ids,
+		   uint32_t *count);
+
+/**
+ * Return the size of memory a page will take up in the page cache.
+ */
+size_t
+vy_page_cache_page_size(struct vy_page_info *page_info);
+
 /**
  * Return the size of a run bloom filter.
  */
@@ -577,6 +744,11 @@ struct vy_slice_stream {
 	struct vy_page *page;
 	/** The last tuple returned to user */
 	struct vy_entry entry;
+	/**
+	 * End of the run file region the kernel was asked to read
+	 * ahead, see vy_slice_stream_read_ahead().
+	 */
+	uint64_t read_ahead_offset;
 
 	/** Members needed for memory allocation and disk access */
 	/** Slice to stream */
@@ -633,6 +805,8 @@ struct vy_run_writer {
 	struct xlog data_xlog;
 	/** Bloom filter false positive rate. */
 	double bloom_fpr;
+	/** Type of the filter to build for the run. */
+	enum index_bloom_type bloom_type;
 	/** Bloom filter. */
 	struct tuple_bloom_builder *bloom;
 	/** Buffer of a current page row offsets. */
@@ -649,7 +823,8 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression);
+		     uint64_t page_size, double bloom_fpr,
+		     enum index_bloom_type bloom_type, bool no_compression);
 
 /**
  * Write a specified statement into a run.
@@ -59,6 +59,7 @@
 #include "vy_run.h"
 #include "vy_write_iterator.h"
 #include "trivia/util.h"
+#include "usdt.h"
 
 /* Min and max values for vy_scheduler::timeout. */
 #define VY_SCHEDULER_TIMEOUT_MIN	1
@@ -104,6 +105,9 @@ struct vy_worker {
 /** Max number of statements in a batch of deferred DELETEs. */
 enum { VY_DEFERRED_DELETE_BATCH_MAX = 100 };
 
+/** Max number of parts a range compaction can be split in. */
+enum { VY_COMPACTION_PARTS_MAX = 8 };
+
 /** Deferred DELETE statement. */
 struct vy_deferred_delete_stmt {
 	/** Overwritten tuple. */
@@ -204,6 +208,7 @@ struct vy_task {
 	 * from another thread.
 	 */
 	double bloom_fpr;
+	enum index_bloom_type bloom_type;
 	int64_t page_size;
 	/**
 	 * Deferred DELETE handler passed to the write iterator.
@@ -218,6 +223,39 @@ struct vy_task {
 	 * and not yet processed.
 	 */
 	int deferred_delete_in_progress;
+	/**
+	 * Copies of the secondary index key definitions used for
+	 * filtering out deferred DELETEs that don't change any
+	 * secondary key. NULL if filtering is disabled.
+	 */
+	struct key_def **deferred_delete_cmp_defs;
+	/** Number of elements in deferred_delete_cmp_defs. */
+	int deferred_delete_cmp_def_count;
+	/**
+	 * Compaction of a big range may be split in parts by key
+	 * so that they can be executed by different workers in
+	 * parallel. In this case the compaction task handles the
+	 * first part while the rest are handled by subtasks.
+	 */
+	struct vy_task **subtasks;
+	/** Number of subtasks. */
+	int subtask_count;
+	/** Keys separating the compaction parts. */
+	struct vy_entry *split_keys;
+	/** Number of keys in the split_keys array. */
+	int split_key_count;
+	/** Compaction task this task is a part of or NULL. */
+	struct vy_task *parent;
+	/**
+	 * Number of parts of this task, including the task itself,
+	 * that haven't been returned by worker threads yet.
+	 */
+	int parts_in_progress;
+	/**
+	 * Slices of the compacted runs cut by the boundaries
+	 * of the compaction part handled by this task.
+	 */
+	struct rlist part_slices;
 	/** Link in vy_scheduler::processed_tasks. */
 	struct stailq_entry in_processed;
 };
@@ -253,6 +291,8 @@ vy_task_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	vy_lsm_ref(lsm);
 	diag_create(&task->diag);
 	task->deferred_delete_handler.iface = &vy_task_deferred_delete_iface;
+	task->parts_in_progress = 1;
+	rlist_create(&task->part_slices);
 	return task;
 }
 
@@ -262,6 +302,16 @@ vy_task_delete(struct vy_task *task)
 {
 	assert(task->deferred_delete_batch == NULL);
 	assert(task->deferred_delete_in_progress == 0);
+	assert(rlist_empty(&task->part_slices));
+	for (int i = 0; i < task->subtask_count; i++)
+		vy_task_delete(task->subtasks[i]);
+	free(task->subtasks);
+	for (int i = 0; i < task->split_key_count; i++)
+		tuple_unref(task->split_keys[i].stmt);
+	free(task->split_keys);
+	for (int i = 0; i < task->deferred_delete_cmp_def_count; i++)
+		key_def_delete(task->deferred_delete_cmp_defs[i]);
+	free(task->deferred_delete_cmp_defs);
 	key_def_delete(task->cmp_def);
 	key_def_delete(task->key_def);
 	vy_lsm_unref(task->lsm);
@@ -312,7 +362,13 @@ vy_compaction_heap_less(struct vy_lsm *i1, struct vy_lsm *i2)
 	 * Prefer LSM trees whose read amplification will be reduced
 	 * most as a result of compaction.
 	 */
-	return vy_lsm_compaction_priority(i1) > vy_lsm_compaction_priority(i2);
+	int p1 = vy_lsm_compaction_priority(i1);
+	int p2 = vy_lsm_compaction_priority(i2);
+	if (p1 != p2)
+		return p1 > p2;
+	/* Among equal candidates, prefer the one that is read more. */
+	return vy_lsm_compaction_read_count(i1) >
+	       vy_lsm_compaction_read_count(i2);
 }
 
 #define HEAP_NAME vy_compaction_heap
@@ -983,6 +1039,63 @@ vy_task_deferred_delete_flush(struct vy_task *task)
 	cpipe_push(&worker->tx_pipe, &batch->cmsg);
 }
 
+/**
+ * Save copies of the secondary index key definitions of the space
+ * in a primary index compaction task so that the worker thread can
+ * filter out deferred DELETEs that don't change any secondary key.
+ * Filtering is disabled if any secondary index is multikey or
+ * functional, because a tuple key can't be extracted with a plain
+ * comparison in this case.
+ */
+static int
+vy_task_deferred_delete_prepare(struct vy_task *task)
+{
+	struct vy_lsm *pk = task->lsm;
+	assert(pk->index_id == 0);
+	struct space *space = space_by_id(pk->space_id);
+	if (space == NULL || space->index_count <= 1)
+		return 0;
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		struct key_def *def = vy_lsm(space->index[i])->cmp_def;
+		if (def->is_multikey || def->for_func_index)
+			return 0;
+	}
+	int count = space->index_count - 1;
+	struct key_def **defs = calloc(count, sizeof(*defs));
+	if (defs == NULL) {
+		diag_set(OutOfMemory, count * sizeof(*defs),
+			 "malloc", "struct key_def *");
+		return -1;
+	}
+	for (int i = 0; i < count; i++)
+		defs[i] = key_def_dup(vy_lsm(space->index[i + 1])->cmp_def);
+	task->deferred_delete_cmp_defs = defs;
+	task->deferred_delete_cmp_def_count = count;
+	return 0;
+}
+
+/**
+ * Return true if a deferred DELETE generated for @a old_stmt
+ * overwritten by @a new_stmt is useless, because @a new_stmt is
+ * a REPLACE that has the same keys in all secondary indexes and
+ * so it purges @a old_stmt from them on compaction anyway.
+ */
+static bool
+vy_task_deferred_delete_is_noop(struct vy_task *task,
+				struct tuple *old_stmt, struct tuple *new_stmt)
+{
+	if (task->deferred_delete_cmp_defs == NULL ||
+	    vy_stmt_type(new_stmt) == IPROTO_DELETE)
+		return false;
+	for (int i = 0; i < task->deferred_delete_cmp_def_count; i++) {
+		struct key_def *def = task->deferred_delete_cmp_defs[i];
+		if (vy_stmt_compare(old_stmt, HINT_NONE, new_stmt, HINT_NONE,
+				    def) != 0)
+			return false;
+	}
+	return true;
+}
+
 /**
  * Add a deferred DELETE to a batch. Once the batch gets full,
  * submit it to tx where it will get processed.
@@ -997,6 +1110,10 @@ vy_task_deferred_delete_process(struct vy_deferred_delete_handler *handler,
 					    deferred_delete_handler);
 	struct vy_deferred_delete_batch *batch = task->deferred_delete_batch;
 
+	/* Don't bother tx with DELETEs that are no-op. */
+	if (vy_task_deferred_delete_is_noop(task, old_stmt, new_stmt))
+		return 0;
+
 	/*
 	 * Throttle compaction task if there are too many batches
 	 * being processed so as to limit memory consumption.
@@ -1068,7 +1185,7 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 				 lsm->space_id, lsm->index_id,
 				 task->cmp_def, task->key_def,
 				 task->page_size, task->bloom_fpr,
-				 no_compression) != 0)
+				 task->bloom_type, no_compression) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
@@ -1113,12 +1230,16 @@ static int
 vy_task_dump_execute(struct vy_task *task)
 {
 	ERROR_INJECT_SLEEP(ERRINJ_VY_DUMP_DELAY);
+	struct vy_lsm *lsm = task->lsm;
+	USDT_PROBE(vy_dump_start, lsm->space_id, lsm->index_id);
 	/*
 	 * Don't compress L1 runs as they are most frequently read
 	 * and smallest runs at the same time and so we would gain
 	 * nothing by compressing them.
 	 */
-	return vy_task_write_run(task, true);
+	int rc = vy_task_write_run(task, true);
+	USDT_PROBE(vy_dump_done, lsm->space_id, lsm->index_id, rc);
+	return rc;
 }
 
 static int
@@ -1396,6 +1517,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
+	task->bloom_type = lsm->opts.bloom_type;
 	task->page_size = lsm->opts.page_size;
 
 	lsm->is_dumping = true;
@@ -1435,7 +1557,44 @@ static int
 vy_task_compaction_execute(struct vy_task *task)
 {
 	ERROR_INJECT_SLEEP(ERRINJ_VY_COMPACTION_DELAY);
-	return vy_task_write_run(task, false);
+	struct vy_lsm *lsm = task->lsm;
+	USDT_PROBE(vy_compaction_start, lsm->space_id, lsm->index_id);
+	int rc = vy_task_write_run(task, false);
+	USDT_PROBE(vy_compaction_done, lsm->space_id, lsm->index_id, rc);
+	return rc;
+}
+
+/**
+ * Return the task handling the given part of a compaction.
+ * Part 0 is handled by the compaction task itself.
+ */
+static inline struct vy_task *
+vy_task_compaction_part(struct vy_task *task, int i)
+{
+	assert(i >= 0 && i <= task->subtask_count);
+	return i == 0 ? task : task->subtasks[i - 1];
+}
+
+/**
+ * Close the write iterators of all parts of a compaction task
+ * and delete the slices cut for them.
+ */
+static void
+vy_task_compaction_release(struct vy_task *task)
+{
+	for (int i = 0; i <= task->subtask_count; i++) {
+		struct vy_task *part = vy_task_compaction_part(task, i);
+		/* The iterator has been cleaned up in worker. */
+		if (part->wi != NULL) {
+			part->wi->iface->close(part->wi);
+			part->wi = NULL;
+		}
+		struct vy_slice *slice, *next_slice;
+		rlist_foreach_entry_safe(slice, &part->part_slices,
+					 in_range, next_slice)
+			vy_slice_delete(slice);
+		rlist_create(&part->part_slices);
+	}
 }
 
 static int
@@ -1444,15 +1603,25 @@ vy_task_compaction_complete(struct vy_task *task)
 	struct vy_scheduler *scheduler = task->scheduler;
 	struct vy_lsm *lsm = task->lsm;
 	struct vy_range *range = task->range;
-	struct vy_run *new_run = task->new_run;
+	int part_count = task->subtask_count + 1;
 	double compaction_time = ev_monotonic_now(loop()) - task->start_time;
-	struct vy_disk_stmt_counter compaction_output = new_run->count;
+	struct vy_disk_stmt_counter compaction_output;
 	struct vy_disk_stmt_counter compaction_input;
 	struct vy_slice *first_slice = task->first_slice;
 	struct vy_slice *last_slice = task->last_slice;
-	struct vy_slice *slice, *next_slice, *new_slice = NULL;
+	struct vy_slice *slice, *next_slice, **new_slices = NULL;
+	struct vy_task *part;
 	struct vy_run *run;
 
+	vy_task_compaction_release(task);
+	for (int i = 1; i < part_count; i++) {
+		part = vy_task_compaction_part(task, i);
+		if (part->is_failed) {
+			diag_move(&part->diag, diag_get());
+			return -1;
+		}
+	}
+
 	/*
 	 * The LSM tree could have been dropped while we were writing the new
 	 * run. In this case we should discard the run without committing to
@@ -1460,23 +1629,39 @@ vy_task_compaction_complete(struct vy_task *task)
 	 * could have already been garbage collected from vylog.
 	 */
 	if (lsm->is_dropped) {
-		vy_run_unref(new_run);
+		for (int i = 0; i < part_count; i++)
+			vy_run_unref(vy_task_compaction_part(task, i)->new_run);
 		goto out;
 	}
 
 	/*
-	 * Allocate a slice of the new run.
+	 * Allocate slices of the new runs. Each run is sliced by
+	 * the boundaries of the part it was written for.
 	 *
-	 * If the run is empty, we don't need to allocate a new slice
+	 * If a run is empty, we don't need to allocate a new slice
 	 * and insert it into the range, but we still need to delete
 	 * compacted runs.
 	 */
-	if (!vy_run_is_empty(new_run)) {
-		new_slice = vy_slice_new(vy_log_next_id(), new_run,
-					 vy_entry_none(), vy_entry_none(),
-					 lsm->cmp_def);
-		if (new_slice == NULL)
-			return -1;
+	new_slices = calloc(part_count, sizeof(*new_slices));
+	if (new_slices == NULL) {
+		diag_set(OutOfMemory, part_count * sizeof(*new_slices),
+			 "malloc", "struct vy_slice *");
+		return -1;
+	}
+	vy_disk_stmt_counter_reset(&compaction_output);
+	for (int i = 0; i < part_count; i++) {
+		run = vy_task_compaction_part(task, i)->new_run;
+		vy_disk_stmt_counter_add(&compaction_output, &run->count);
+		if (vy_run_is_empty(run))
+			continue;
+		struct vy_entry begin = i > 0 ? task->split_keys[i - 1] :
+						vy_entry_none();
+		struct vy_entry end = i < part_count - 1 ?
+				      task->split_keys[i] : vy_entry_none();
+		new_slices[i] = vy_slice_new(vy_log_next_id(), run,
+					     begin, end, lsm->cmp_def);
+		if (new_slices[i] == NULL)
+			goto fail_free_slices;
 	}
 
 	/*
@@ -1509,18 +1694,19 @@ vy_task_compaction_complete(struct vy_task *task)
 	}
 	rlist_foreach_entry(run, &unused_runs, in_unused)
 		vy_log_drop_run(run->id, VY_LOG_GC_LSN_CURRENT);
-	if (new_slice != NULL) {
-		vy_log_create_run(lsm->id, new_run->id, new_run->dump_lsn,
-				  new_run->dump_count);
-		vy_log_insert_slice(range->id, new_run->id, new_slice->id,
+	for (int i = 0; i < part_count; i++) {
+		struct vy_slice *new_slice = new_slices[i];
+		if (new_slice == NULL)
+			continue;
+		run = new_slice->run;
+		vy_log_create_run(lsm->id, run->id, run->dump_lsn,
+				  run->dump_count);
+		vy_log_insert_slice(range->id, run->id, new_slice->id,
 				    tuple_data_or_null(new_slice->begin.stmt),
 				    tuple_data_or_null(new_slice->end.stmt));
 	}
-	if (vy_log_tx_commit() < 0) {
-		if (new_slice != NULL)
-			vy_slice_delete(new_slice);
-		return -1;
-	}
+	if (vy_log_tx_commit() < 0)
+		goto fail_free_slices;
 
 	/*
 	 * Remove compacted run files that were created after
@@ -1540,29 +1726,35 @@ vy_task_compaction_complete(struct vy_task *task)
 	}
 
 	/*
-	 * Account the new run if it is not empty,
-	 * otherwise discard it.
+	 * Account the new runs if they are not empty,
+	 * otherwise discard them.
 	 */
-	if (new_slice != NULL) {
-		vy_lsm_add_run(lsm, new_run);
-		/* Drop the reference held by the task. */
-		vy_run_unref(new_run);
-	} else
-		vy_run_discard(new_run);
+	for (int i = 0; i < part_count; i++) {
+		run = vy_task_compaction_part(task, i)->new_run;
+		if (new_slices[i] != NULL) {
+			vy_lsm_add_run(lsm, run);
+			/* Drop the reference held by the task. */
+			vy_run_unref(run);
+		} else
+			vy_run_discard(run);
+	}
 
 	/*
-	 * Replace compacted slices with the resulting slice and
+	 * Replace compacted slices with the resulting slices and
 	 * account compaction in LSM tree statistics.
 	 *
 	 * Note, since a slice might have been added to the range
 	 * by a concurrent dump while compaction was in progress,
-	 * we must insert the new slice at the same position where
+	 * we must insert the new slices at the same position where
 	 * the compacted slices were.
 	 */
 	RLIST_HEAD(compacted_slices);
 	vy_lsm_unacct_range(lsm, range);
-	if (new_slice != NULL)
-		vy_range_add_slice_before(range, new_slice, first_slice);
+	for (int i = 0; i < part_count; i++) {
+		if (new_slices[i] != NULL)
+			vy_range_add_slice_before(range, new_slices[i],
+						  first_slice);
+	}
 	vy_disk_stmt_counter_reset(&compaction_input);
 	for (slice = first_slice; ; slice = next_slice) {
 		next_slice = rlist_next_entry(slice, in_range);
@@ -1573,6 +1765,7 @@ vy_task_compaction_complete(struct vy_task *task)
 			break;
 	}
 	range->n_compactions++;
+	range->read_count /= 2;
 	vy_range_update_compaction_priority(range, &lsm->opts);
 	vy_range_update_dumps_per_compaction(range);
 	vy_lsm_acct_range(lsm, range);
@@ -1592,17 +1785,38 @@ vy_task_compaction_complete(struct vy_task *task)
 		vy_slice_wait_pinned(slice);
 		vy_slice_delete(slice);
 	}
+	free(new_slices);
 out:
-	/* The iterator has been cleaned up in worker. */
-	task->wi->iface->close(task->wi);
-
 	assert(heap_node_is_stray(&range->heap_node));
 	vy_range_heap_insert(&lsm->range_heap, range);
-	vy_scheduler_update_lsm(scheduler, lsm);
 
 	say_info("%s: completed compacting range %s",
 		 vy_lsm_name(lsm), vy_range_str(range));
+	/*
+	 * The range now has a slice per each compacted part.
+	 * Split it by the part boundaries so that each slice
+	 * gets its own range, otherwise the slices would be
+	 * accounted as separate runs and trigger compaction.
+	 * Failure to split isn't critical: the range will be
+	 * compacted again.
+	 */
+	if (!lsm->is_dropped && part_count > 1 &&
+	    vy_lsm_split_range_by_keys(lsm, range, task->split_keys,
+				       task->subtask_count) != 0) {
+		diag_log();
+		say_error("%s: failed to split range %s",
+			  vy_lsm_name(lsm), vy_range_str(range));
+	}
+	vy_scheduler_update_lsm(scheduler, lsm);
 	return 0;
+
+fail_free_slices:
+	for (int i = 0; i < part_count; i++) {
+		if (new_slices[i] != NULL)
+			vy_slice_delete(new_slices[i]);
+	}
+	free(new_slices);
+	return -1;
 }
 
 static void
@@ -1612,21 +1826,135 @@ vy_task_compaction_abort(struct vy_task *task)
 	struct vy_lsm *lsm = task->lsm;
 	struct vy_range *range = task->range;
 
-	/* The iterator has been cleaned up in worker. */
-	task->wi->iface->close(task->wi);
+	vy_task_compaction_release(task);
 
 	struct error *e = diag_last_error(&task->diag);
 	error_log(e);
 	say_error("%s: failed to compact range %s",
 		  vy_lsm_name(lsm), vy_range_str(range));
 
-	vy_run_discard(task->new_run);
+	for (int i = 0; i <= task->subtask_count; i++)
+		vy_run_discard(vy_task_compaction_part(task, i)->new_run);
 
 	assert(heap_node_is_stray(&range->heap_node));
 	vy_range_heap_insert(&lsm->range_heap, range);
 	vy_scheduler_update_lsm(scheduler, lsm);
 }
 
+/**
+ * Find keys to split compaction of a range in parts of roughly
+ * equal size so that the parts can be executed by different
+ * workers in parallel. The keys are taken from the page index
+ * of the biggest compacted slice.
+ *
+ * A compaction is split only if its input exceeds the target
+ * range size, and the number of parts is limited by the number
+ * of idle compaction workers, which are taken from the pool and
+ * returned in @a workers.
+ *
+ * Returns the number of split keys stored in @a split_keys.
+ */
+static int
+vy_task_compaction_find_split_keys(struct vy_scheduler *scheduler,
+				   struct vy_lsm *lsm, struct vy_range *range,
+				   struct vy_slice *slice, int64_t input_size,
+				   struct vy_entry *split_keys,
+				   struct vy_worker **workers)
+{
+	int64_t range_size = vy_lsm_range_size(lsm);
+	int part_count = MIN(input_size / range_size,
+			     VY_COMPACTION_PARTS_MAX);
+	int page_count = slice->last_page_no - slice->first_page_no + 1;
+	part_count = MIN(part_count, page_count);
+	if (part_count <= 1)
+		return 0;
+
+	struct tuple_format *key_format = lsm->env->key_format;
+	int key_count = 0;
+	for (int i = 1; i < part_count; i++) {
+		struct vy_page_info *page = vy_run_page_info(slice->run,
+				slice->first_page_no +
+				(int64_t)page_count * i / part_count);
+		struct vy_entry key = vy_entry_key_from_msgpack(
+				key_format, lsm->cmp_def, page->min_key);
+		if (key.stmt == NULL) {
+			diag_log();
+			break;
+		}
+		/* Split keys must lie strictly within the range. */
+		struct vy_entry prev = key_count > 0 ?
+				split_keys[key_count - 1] : range->begin;
+		if ((prev.stmt != NULL &&
+		     vy_entry_compare(key, prev, lsm->cmp_def) <= 0) ||
+		    (range->end.stmt != NULL &&
+		     vy_entry_compare(key, range->end, lsm->cmp_def) >= 0)) {
+			tuple_unref(key.stmt);
+			continue;
+		}
+		workers[key_count] =
+			vy_worker_pool_get(&scheduler->compaction_pool);
+		if (workers[key_count] == NULL) {
+			/* All workers are busy. */
+			tuple_unref(key.stmt);
+			break;
+		}
+		split_keys[key_count++] = key;
+	}
+	return key_count;
+}
+
+/**
+ * Prepare a part of a compaction task: create a run to write
+ * the result to and a write iterator over the compacted slices.
+ * If the compaction is split in parts by key, the slices are
+ * cut by the part boundaries, [@a begin, @a end).
+ */
+static int
+vy_task_compaction_prepare_part(struct vy_task *task, struct vy_range *range,
+				struct vy_entry begin, struct vy_entry end,
+				bool is_last_level)
+{
+	struct vy_scheduler *scheduler = task->scheduler;
+	struct vy_lsm *lsm = task->lsm;
+	bool is_split = begin.stmt != NULL || end.stmt != NULL;
+
+	task->range = range;
+	task->bloom_fpr = lsm->opts.bloom_fpr;
+	task->bloom_type = lsm->opts.bloom_type;
+	task->page_size = lsm->opts.page_size;
+	task->new_run = vy_run_prepare(scheduler->run_env, lsm);
+	if (task->new_run == NULL)
+		return -1;
+	if (lsm->index_id == 0 && vy_task_deferred_delete_prepare(task) != 0)
+		return -1;
+	task->wi = vy_write_iterator_new(task->cmp_def, lsm->index_id == 0,
+					 is_last_level, scheduler->read_views,
+					 lsm->index_id > 0 ? NULL :
+					 &task->deferred_delete_handler);
+	if (task->wi == NULL)
+		return -1;
+
+	struct vy_slice *slice = task->first_slice;
+	for (;; slice = rlist_next_entry(slice, in_range)) {
+		struct vy_slice *part_slice = slice;
+		if (is_split) {
+			if (vy_slice_cut(slice, vy_log_next_id(), begin, end,
+					 lsm->cmp_def, &part_slice) != 0)
+				return -1;
+			if (part_slice != NULL)
+				rlist_add_tail_entry(&task->part_slices,
+						     part_slice, in_range);
+		}
+		if (part_slice != NULL &&
+		    vy_write_iterator_new_slice(task->wi, part_slice,
+						lsm->disk_format) != 0)
+			return -1;
+		if (slice == task->last_slice)
+			break;
+	}
+	return 0;
+}
+
 static int
 vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		       struct vy_lsm *lsm, struct vy_task **p_task)
@@ -1636,6 +1964,15 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		.complete = vy_task_compaction_complete,
 		.abort = vy_task_compaction_abort,
 	};
+	/*
+	 * Parts of a split compaction are completed and aborted
+	 * by the compaction task they belong to.
+	 */
+	static struct vy_task_ops compaction_part_ops = {
+		.execute = vy_task_compaction_execute,
+		.complete = NULL,
+		.abort = NULL,
+	};
 
 	struct vy_range *range = vy_range_heap_top(&lsm->range_heap);
 	assert(range != NULL);
@@ -1652,30 +1989,19 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	if (task == NULL)
 		goto err_task;
 
-	struct vy_run *new_run = vy_run_prepare(scheduler->run_env, lsm);
-	if (new_run == NULL)
-		goto err_run;
-
-	struct vy_stmt_stream *wi;
-	bool is_last_level = (range->compaction_priority == range->slice_count);
-	wi = vy_write_iterator_new(task->cmp_def, lsm->index_id == 0,
-				   is_last_level, scheduler->read_views,
-				   lsm->index_id > 0 ? NULL :
-				   &task->deferred_delete_handler);
-	if (wi == NULL)
-		goto err_wi;
-
-	struct vy_slice *slice;
+	/* Remember the slices we are compacting. */
+	struct vy_slice *slice, *max_slice = NULL;
+	int64_t dump_lsn = -1;
+	int64_t input_size = 0;
 	int32_t dump_count = 0;
 	int n = range->compaction_priority;
 	rlist_foreach_entry(slice, &range->slices, in_range) {
-		if (vy_write_iterator_new_slice(wi, slice,
-						lsm->disk_format) != 0)
-			goto err_wi_sub;
-		new_run->dump_lsn = MAX(new_run->dump_lsn,
-					slice->run->dump_lsn);
+		dump_lsn = MAX(dump_lsn, slice->run->dump_lsn);
 		dump_count += slice->run->dump_count;
-		/* Remember the slices we are compacting. */
+		input_size += slice->count.bytes;
+		if (max_slice == NULL ||
+		    slice->count.bytes > max_slice->count.bytes)
+			max_slice = slice;
 		if (task->first_slice == NULL)
 			task->first_slice = slice;
 		task->last_slice = slice;
@@ -1684,7 +2010,7 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 			break;
 	}
 	assert(n == 0);
-	assert(new_run->dump_lsn >= 0);
+	assert(dump_lsn >= 0);
 	if (range->compaction_priority == range->slice_count)
 		dump_count -= slice->run->dump_count;
 	/*
@@ -1693,17 +2019,70 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	 * such as splitting/coalescing ranges for no good reason.
 	 */
 	if (range->needs_compaction)
-		new_run->dump_count = slice->run->dump_count;
-	else
-		new_run->dump_count = dump_count;
+		dump_count = slice->run->dump_count;
 
-	range->needs_compaction = false;
+	/*
+	 * If the range is big, split compaction in parts by key
+	 * and hand them over to idle workers.
+	 */
+	struct vy_entry split_keys[VY_COMPACTION_PARTS_MAX - 1];
+	struct vy_worker *workers[VY_COMPACTION_PARTS_MAX - 1];
+	int split_key_count = vy_task_compaction_find_split_keys(
+				scheduler, lsm, range, max_slice, input_size,
+				split_keys, workers);
+	if (split_key_count > 0) {
+		task->split_keys = calloc(split_key_count,
+					  sizeof(*task->split_keys));
+		task->subtasks = calloc(split_key_count,
+					sizeof(*task->subtasks));
+		if (task->split_keys == NULL || task->subtasks == NULL) {
+			diag_set(OutOfMemory, split_key_count *
+				 sizeof(*task->subtasks), "malloc",
+				 "struct vy_task *");
+			free(task->split_keys);
+			free(task->subtasks);
+			task->split_keys = NULL;
+			task->subtasks = NULL;
+			for (int i = 0; i < split_key_count; i++) {
+				tuple_unref(split_keys[i].stmt);
+				vy_worker_pool_put(workers[i]);
+			}
+			goto err_parts;
+		}
+		memcpy(task->split_keys, split_keys,
+		       split_key_count * sizeof(*split_keys));
+		task->split_key_count = split_key_count;
+		for (int i = 0; i < split_key_count; i++) {
+			struct vy_task *subtask = vy_task_new(scheduler,
+					workers[i], lsm, &compaction_part_ops);
+			if (subtask == NULL) {
+				for (int j = i; j < split_key_count; j++)
+					vy_worker_pool_put(workers[j]);
+				goto err_parts;
+			}
+			subtask->parent = task;
+			subtask->first_slice = task->first_slice;
+			subtask->last_slice = task->last_slice;
+			task->subtasks[task->subtask_count++] = subtask;
+		}
+		task->parts_in_progress += task->subtask_count;
+	}
 
-	task->range = range;
-	task->new_run = new_run;
-	task->wi = wi;
-	task->bloom_fpr = lsm->opts.bloom_fpr;
-	task->page_size = lsm->opts.page_size;
+	bool is_last_level = (range->compaction_priority == range->slice_count);
+	for (int i = 0; i <= task->subtask_count; i++) {
+		struct vy_task *part = vy_task_compaction_part(task, i);
+		struct vy_entry begin = i > 0 ? task->split_keys[i - 1] :
+						vy_entry_none();
+		struct vy_entry end = i < task->subtask_count ?
+				      task->split_keys[i] : vy_entry_none();
+		if (vy_task_compaction_prepare_part(part, range, begin, end,
+						    is_last_level) != 0)
+			goto err_parts;
+		part->new_run->dump_lsn = dump_lsn;
+		part->new_run->dump_count = dump_count;
+	}
+
+	range->needs_compaction = false;
 
 	/*
 	 * Remove the range we are going to compact from the heap
@@ -1715,14 +2094,23 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	say_info("%s: started compacting range %s, runs %d/%d",
 		 vy_lsm_name(lsm), vy_range_str(range),
                  range->compaction_priority, range->slice_count);
+	if (task->subtask_count > 0) {
+		say_info("%s: compaction of range %s is split in %d parts",
+			 vy_lsm_name(lsm), vy_range_str(range),
+			 task->subtask_count + 1);
+	}
 	*p_task = task;
 	return 0;
 
-err_wi_sub:
-	task->wi->iface->close(wi);
-err_wi:
-	vy_run_discard(new_run);
-err_run:
+err_parts:
+	vy_task_compaction_release(task);
+	for (int i = 0; i <= task->subtask_count; i++) {
+		struct vy_task *part = vy_task_compaction_part(task, i);
+		if (part->new_run != NULL)
+			vy_run_discard(part->new_run);
+		if (i > 0)
+			vy_worker_pool_put(part->worker);
+	}
 	vy_task_delete(task);
 err_task:
 	diag_log();
@@ -1795,6 +2183,21 @@ static void
 vy_task_complete_f(struct cmsg *cmsg)
 {
 	struct vy_task *task = container_of(cmsg, struct vy_task, cmsg);
+	if (task->parent != NULL) {
+		/*
+		 * A part of a compaction task is done. Return the worker
+		 * to the pool right away so that it can be reused while
+		 * other parts are still in progress. The compaction task
+		 * is completed once all its parts are done.
+		 */
+		vy_worker_pool_put(task->worker);
+		task->worker = NULL;
+		task = task->parent;
+		fiber_cond_signal(&task->scheduler->scheduler_cond);
+	}
+	assert(task->parts_in_progress > 0);
+	if (--task->parts_in_progress > 0)
+		return;
 	stailq_add_tail_entry(&task->scheduler->processed_tasks,
 			      task, in_processed);
 	fiber_cond_signal(&task->scheduler->scheduler_cond);
@@ -2045,6 +2448,12 @@ vy_scheduler_f(va_list va)
 		/* Queue the task for execution. */
 		cmsg_init(&task->cmsg, vy_task_execute_route);
 		cpipe_push(&task->worker->worker_pipe, &task->cmsg);
+		for (int i = 0; i < task->subtask_count; i++) {
+			struct vy_task *subtask = task->subtasks[i];
+			cmsg_init(&subtask->cmsg, vy_task_execute_route);
+			cpipe_push(&subtask->worker->worker_pipe,
+				   &subtask->cmsg);
+		}
 
 		fiber_reschedule();
 		continue;
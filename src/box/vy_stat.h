@@ -130,6 +130,16 @@ struct vy_lsm_stat {
 		/** How many upserts have been applied on read. */
 		int64_t applied;
 	} upsert;
+	/** Throttling statistics. */
+	struct {
+		/**
+		 * Number of transactions writing to this LSM tree
+		 * that had to wait for memory quota.
+		 */
+		int64_t count;
+		/** Time spent waiting for memory quota, in seconds. */
+		double time;
+	} throttle;
 	/** Memory related statistics. */
 	struct {
 		/** Number of statements stored in memory. */
@@ -34,30 +34,19 @@
 #include "vy_upsert.h"
 #include "fiber.h"
 
-#define HEAP_FORWARD_DECLARATION
-#include "salad/heap.h"
-
 /**
  * Merge source of a write iterator. Represents a mem or a run.
  */
 struct vy_write_src {
 	/* Link in vy_write_iterator::src_list */
 	struct rlist in_src_list;
-	/* Node in vy_write_iterator::src_heap */
-	struct heap_node heap_node;
 	/* Current tuple in the source (with minimal key and maximal LSN) */
 	struct vy_entry entry;
 	/**
-	 * If this flag is set, this is a so called "virtual"
-	 * source. A virtual source does not stand for any mem or
-	 * run, but represents a delimiter between the current key
-	 * and the next one. There is a special rule used by the
-	 * write iterator heap when comparing with a virtual
-	 * source. Such source is greater than any source with
-	 * the same key and less than any source with a greater
-	 * key, regardless of LSN.
+	 * Set if the source was started and hasn't been exhausted
+	 * yet, i.e. it's merged by vy_write_iterator::src_tree.
 	 */
-	bool is_end_of_key;
+	bool is_active;
 	/** An iterator over the source */
 	union {
 		struct vy_slice_stream slice_stream;
@@ -67,13 +56,13 @@ struct vy_write_src {
 };
 
 static bool
-heap_less(heap_t *heap, struct vy_write_src *src1, struct vy_write_src *src2);
+vy_write_src_less(struct loser_tree *tree, struct vy_write_src *src1,
+		  struct vy_write_src *src2);
 
-#define HEAP_NAME vy_source_heap
-#define HEAP_LESS heap_less
-#define heap_value_t struct vy_write_src
-#define heap_value_attr heap_node
-#include "salad/heap.h"
+#define LOSER_TREE_NAME vy_source_tree
+#define LOSER_TREE_LESS vy_write_src_less
+#define loser_tree_value_t struct vy_write_src
+#include "salad/loser_tree.h"
 
 /**
  * A sequence of versions of a key, sorted by LSN in ascending order.
@@ -169,8 +158,8 @@ struct vy_write_iterator {
 	struct vy_stmt_stream base;
 	/* List of all sources of the iterator */
 	struct rlist src_list;
-	/* A heap to order the sources, newest LSN at heap top. */
-	heap_t src_heap;
+	/* A loser tree to merge the sources, newest LSN at the top. */
+	struct loser_tree src_tree;
 	/** Index key definition used to store statements on disk. */
 	struct key_def *cmp_def;
 	/* There is no LSM tree level older than the one we're writing to. */
@@ -219,26 +208,22 @@ struct vy_write_iterator {
 };
 
 /**
- * Comparator of the heap. Put newer LSNs first, unless
- * it's a virtual source (is_end_of_key).
+ * Comparator of the source tree. Put newer LSNs first.
  */
 static bool
-heap_less(heap_t *heap, struct vy_write_src *src1, struct vy_write_src *src2)
+vy_write_src_less(struct loser_tree *tree, struct vy_write_src *src1,
+		  struct vy_write_src *src2)
 {
 	struct vy_write_iterator *stream =
-		container_of(heap, struct vy_write_iterator, src_heap);
+		container_of(tree, struct vy_write_iterator, src_tree);
 
 	int cmp = vy_entry_compare(src1->entry, src2->entry, stream->cmp_def);
 	if (cmp != 0)
 		return cmp < 0;
 
-	/**
-	 * Keys are equal, order by LSN, descending.
-	 * Virtual sources use 0 for LSN, so they are ordered
-	 * last automatically.
-	 */
-	int64_t lsn1 = src1->is_end_of_key  ? 0 : vy_stmt_lsn(src1->entry.stmt);
-	int64_t lsn2 = src2->is_end_of_key  ? 0 : vy_stmt_lsn(src2->entry.stmt);
+	/* Keys are equal, order by LSN, descending. */
+	int64_t lsn1 = vy_stmt_lsn(src1->entry.stmt);
+	int64_t lsn2 = vy_stmt_lsn(src2->entry.stmt);
 	if (lsn1 != lsn2)
 		return lsn1 > lsn2;
 
@@ -268,9 +253,8 @@ vy_write_iterator_new_src(struct vy_write_iterator *stream)
 			 "malloc", "vinyl write stream");
 		return NULL;
 	}
-	heap_node_create(&res->heap_node);
 	res->entry = vy_entry_none();
-	res->is_end_of_key = false;
+	res->is_active = false;
 	rlist_add(&stream->src_list, &res->in_src_list);
 	return res;
 }
@@ -282,7 +266,7 @@ vy_write_iterator_delete_src(struct vy_write_iterator *stream,
 			     struct vy_write_src *src)
 {
 	(void)stream;
-	assert(!src->is_end_of_key);
+	assert(!src->is_active);
 	if (src->stream.iface->close != NULL)
 		src->stream.iface->close(&src->stream);
 	rlist_del(&src->in_src_list);
@@ -290,8 +274,9 @@ vy_write_iterator_delete_src(struct vy_write_iterator *stream,
 }
 
 /**
- * Start iteration in the given source, retrieve the first tuple,
- * and add the source to the write iterator heap.
+ * Start iteration in the given source and retrieve the first tuple.
+ * If the source isn't empty, mark it active so that it's added to
+ * the write iterator source tree.
  *
  * @return 0 - success, not 0 - error.
  */
@@ -299,6 +284,7 @@ static NODISCARD int
 vy_write_iterator_add_src(struct vy_write_iterator *stream,
 			  struct vy_write_src *src)
 {
+	(void)stream;
 	if (src->stream.iface->start != NULL) {
 		int rc = src->stream.iface->start(&src->stream);
 		if (rc != 0)
@@ -307,13 +293,7 @@ vy_write_iterator_add_src(struct vy_write_iterator *stream,
 	int rc = src->stream.iface->next(&src->stream, &src->entry);
 	if (rc != 0 || src->entry.stmt == NULL)
 		goto stop;
-
-	rc = vy_source_heap_insert(&stream->src_heap, src);
-	if (rc != 0) {
-		diag_set(OutOfMemory, sizeof(void *),
-			 "malloc", "vinyl write stream heap");
-		goto stop;
-	}
+	src->is_active = true;
 	return 0;
 stop:
 	if (src->stream.iface->stop != NULL)
@@ -322,15 +302,17 @@ vy_write_iterator_add_src(struct vy_write_iterator *stream,
 }
 
 /**
- * Remove a source from the heap and stop iteration.
+ * Stop iteration in a source. The source must be removed from
+ * the source tree by the caller.
  */
 static void
 vy_write_iterator_remove_src(struct vy_write_iterator *stream,
 			   struct vy_write_src *src)
 {
-	if (heap_node_is_stray(&src->heap_node))
+	(void)stream;
+	if (!src->is_active)
 		return; /* already removed */
-	vy_source_heap_delete(&stream->src_heap, src);
+	src->is_active = false;
 	if (src->stream.iface->stop != NULL)
 		src->stream.iface->stop(&src->stream);
 }
@@ -383,7 +365,7 @@ vy_write_iterator_new(struct key_def *cmp_def, bool is_primary,
 	assert(count == 0);
 
 	stream->base.iface = &vy_slice_stream_iface;
-	vy_source_heap_create(&stream->src_heap);
+	vy_source_tree_create(&stream->src_tree);
 	rlist_create(&stream->src_list);
 	stream->cmp_def = cmp_def;
 	stream->is_primary = is_primary;
@@ -405,9 +387,12 @@ vy_write_iterator_start(struct vy_stmt_stream *vstream)
 	assert(vstream->iface->start == vy_write_iterator_start);
 	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
 	struct vy_write_src *src;
+	uint32_t src_count = 0;
 	rlist_foreach_entry(src, &stream->src_list, in_src_list) {
 		if (vy_write_iterator_add_src(stream, src) != 0)
 			goto fail;
+		if (src->is_active)
+			src_count++;
 #ifndef NDEBUG
 		struct errinj *inj =
 			errinj(ERRINJ_VY_WRITE_ITERATOR_START_FAIL, ERRINJ_BOOL);
@@ -418,6 +403,28 @@ vy_write_iterator_start(struct vy_stmt_stream *vstream)
 		}
 #endif
 	}
+	if (src_count == 0)
+		return 0;
+	size_t size = src_count * sizeof(struct vy_write_src *);
+	struct vy_write_src **srcs = (struct vy_write_src **)malloc(size);
+	if (srcs == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "vinyl write stream tree");
+		goto fail;
+	}
+	uint32_t i = 0;
+	rlist_foreach_entry(src, &stream->src_list, in_src_list) {
+		if (src->is_active)
+			srcs[i++] = src;
+	}
+	assert(i == src_count);
+	int rc = vy_source_tree_build(&stream->src_tree, srcs, src_count);
+	free(srcs);
+	if (rc != 0) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "vinyl write stream tree");
+		goto fail;
+	}
 	return 0;
 fail:
 	rlist_foreach_entry(src, &stream->src_list, in_src_list)
@@ -438,6 +445,7 @@ vy_write_iterator_stop(struct vy_stmt_stream *vstream)
 	struct vy_write_src *src;
 	rlist_foreach_entry(src, &stream->src_list, in_src_list)
 		vy_write_iterator_remove_src(stream, src);
+	vy_source_tree_destroy(&stream->src_tree);
 	if (stream->last.stmt != NULL) {
 		vy_stmt_unref_if_possible(stream->last.stmt);
 		stream->last = vy_entry_none();
@@ -465,7 +473,7 @@ vy_write_iterator_close(struct vy_stmt_stream *vstream)
 	struct vy_write_src *src, *tmp;
 	rlist_foreach_entry_safe(src, &stream->src_list, in_src_list, tmp)
 		vy_write_iterator_delete_src(stream, src);
-	vy_source_heap_destroy(&stream->src_heap);
+	vy_source_tree_destroy(&stream->src_tree);
 	free(stream);
 }
 
@@ -509,15 +517,17 @@ vy_write_iterator_new_slice(struct vy_stmt_stream *vstream,
 static NODISCARD int
 vy_write_iterator_merge_step(struct vy_write_iterator *stream)
 {
-	struct vy_write_src *src = vy_source_heap_top(&stream->src_heap);
+	struct vy_write_src *src = vy_source_tree_top(&stream->src_tree);
 	assert(src != NULL);
 	int rc = src->stream.iface->next(&src->stream, &src->entry);
 	if (rc != 0)
 		return rc;
-	if (src->entry.stmt != NULL)
-		vy_source_heap_update(&stream->src_heap, src);
-	else
+	if (src->entry.stmt != NULL) {
+		vy_source_tree_update_top(&stream->src_tree);
+	} else {
+		vy_source_tree_pop(&stream->src_tree);
 		vy_write_iterator_remove_src(stream, src);
+	}
 	return 0;
 }
 
@@ -676,30 +686,20 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 	*is_first_insert = false;
 	assert(stream->stmt_i == -1);
 	assert(stream->deferred_delete.stmt == NULL);
-	struct vy_write_src *src = vy_source_heap_top(&stream->src_heap);
+	struct vy_write_src *src = vy_source_tree_top(&stream->src_tree);
 	if (src == NULL)
 		return 0; /* no more data */
 	/* Search must have been started already. */
 	assert(src->entry.stmt != NULL);
 	/*
-	 * A virtual source instance which represents the end on
-	 * the current key in the source heap. It is greater
-	 * than any statement on the current key and less than
-	 * any statement on the next key.
-	 * The moment we get this source from the heap we know
-	 * that there are no statements that there are no more
-	 * statements for the current key.
+	 * The current key. The moment the top source has a different
+	 * key, we know that there are no more statements for the
+	 * current key, because statements of the same key are
+	 * ordered by LSN, descending, and precede greater keys.
 	 */
-	struct vy_write_src end_of_key_src;
-	end_of_key_src.is_end_of_key = true;
-	end_of_key_src.entry = src->entry;
-	int rc = vy_source_heap_insert(&stream->src_heap, &end_of_key_src);
-	if (rc) {
-		diag_set(OutOfMemory, sizeof(void *),
-			 "malloc", "vinyl write stream heap");
-		return rc;
-	}
-	vy_stmt_ref_if_possible(src->entry.stmt);
+	struct vy_entry key = src->entry;
+	vy_stmt_ref_if_possible(key.stmt);
+	int rc = 0;
 	/*
 	 * For each pair (merge_until_lsn, current_rv_lsn] build
 	 * a history in the corresponding read view.
@@ -795,11 +795,11 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		rc = vy_write_iterator_merge_step(stream);
 		if (rc != 0)
 			break;
-		src = vy_source_heap_top(&stream->src_heap);
-		assert(src != NULL);
-		assert(src->entry.stmt != NULL);
-		if (src->is_end_of_key)
+		src = vy_source_tree_top(&stream->src_tree);
+		if (src == NULL ||
+		    vy_entry_compare(src->entry, key, stream->cmp_def) != 0)
 			break;
+		assert(src->entry.stmt != NULL);
 	}
 
 	/*
@@ -813,8 +813,7 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		stream->deferred_delete = vy_entry_none();
 	}
 
-	vy_source_heap_delete(&stream->src_heap, &end_of_key_src);
-	vy_stmt_unref_if_possible(end_of_key_src.entry.stmt);
+	vy_stmt_unref_if_possible(key.stmt);
 	return rc;
 }
 
@@ -1109,7 +1108,8 @@ vy_write_iterator_next(struct vy_stmt_stream *vstream, struct vy_entry *ret)
 		 * DELETE or it consisted only from optimized
 		 * updates. Then try to get the next key.
 		 */
-		if (count != 0 || stream->src_heap.size == 0)
+		if (count != 0 ||
+		    vy_source_tree_top(&stream->src_tree) == NULL)
 			break;
 	}
 	/* Again try to get the statement, after calling next_key(). */
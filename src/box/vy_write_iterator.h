@@ -36,6 +36,10 @@
 #include <stdbool.h>
 #include <pthread.h>
 
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
 /**
  * Iterate over an in-memory index when writing it to disk (dump)
  * or over a series of sorted runs on disk to create a new sorted
@@ -49,7 +53,7 @@
  *
  * The sources supply statements in ascending order of the
  * key and descending order of LSN (newest changes first).
- * A heap is used to preserve descending order of LSNs
+ * A loser tree is used to preserve descending order of LSNs
  * in the output.
  *
  * There may be many statements for the same key, forming
@@ -81,7 +85,7 @@
  * The following optimizations are applicable, all aiming at
  * purging unnecessary statements from the output. The
  * optimizations are applied while reading the statements from
- * the heap, from newest LSN to oldest.
+ * the source tree, from newest LSN to oldest.
  *
  * ---------------------------------------------------------------
  * Optimization #1: when merging the last level of the LSM tree,
@@ -268,5 +272,9 @@ vy_write_iterator_new_slice(struct vy_stmt_stream *stream,
 			    struct vy_slice *slice,
 			    struct tuple_format *disk_format);
 
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
 #endif /* INCLUDES_TARANTOOL_BOX_VY_WRITE_STREAM_H */
 
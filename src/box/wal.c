@@ -43,6 +43,10 @@
 #include "coio_task.h"
 #include "replication.h"
 #include "iproto_constants.h"
+#include "tweaks.h"
+#include "usdt.h"
+#include "tt_pthread.h"
+#include "small/ibuf.h"
 
 enum {
 	/**
@@ -54,8 +58,35 @@ enum {
 	 * latency. 1 MB seems to be a well balanced choice.
 	 */
 	WAL_FALLOCATE_LEN = 1024 * 1024,
+	/**
+	 * Distance between tx blocks in the sparse WAL index, see
+	 * xlog_opts::index_step. An entry takes about a hundred
+	 * bytes so the index of a 256 MB file fits in a few pages
+	 * while a reader never has to scan more than 1 MB to find
+	 * its position in a file.
+	 */
+	WAL_INDEX_STEP = 1024 * 1024,
+	/**
+	 * Max size of disk space to preallocate for a spare WAL
+	 * file, see wal_prepare_spare().
+	 */
+	WAL_SPARE_LEN = 64 * 1024 * 1024,
 };
 
+/**
+ * Bounds of the adaptive checkpoint write rate limit, in bytes
+ * per second, see wal_io_timer_cb(). The limit starts at the upper
+ * bound, which is high enough not to throttle any real disk.
+ */
+static const uint64_t WAL_IO_RATE_MIN = 1024 * 1024;
+static const uint64_t WAL_IO_RATE_MAX = 4ULL * 1024 * 1024 * 1024;
+
+/**
+ * Period of updating the adaptive checkpoint write rate limit,
+ * in seconds.
+ */
+static const double WAL_IO_PERIOD = 0.1;
+
 const char *wal_mode_STRS[WAL_MODE_MAX] = {
 	[WAL_NONE]	= "none",
 	[WAL_WRITE]	= "write",
@@ -110,6 +141,17 @@ struct wal_writer
 	 * rolled back too.
 	 */
 	struct journal_entry *last_entry;
+	/**
+	 * A setting from instance configuration - wal_commit_delay.
+	 * Max time a new write request batch may be held back in
+	 * the tx thread while the WAL thread is busy writing
+	 * previous batches. Zero means batches are never held.
+	 */
+	double commit_delay;
+	/** Number of write request batches not completed yet. */
+	int n_batches;
+	/** Timer that flushes a held back batch to the WAL thread. */
+	struct ev_timer commit_timer;
 	/* ----------------- wal ------------------- */
 	/** A setting from instance configuration - wal_max_size */
 	int64_t wal_max_size;
@@ -161,6 +203,36 @@ struct wal_writer
 	bool checkpoint_triggered;
 	/** The current WAL file. */
 	struct xlog current_wal;
+	/**
+	 * A preallocated file used for the next WAL so that
+	 * rotation doesn't have to wait for the file creation
+	 * and disk space allocation, see wal_prepare_spare().
+	 */
+	struct xlog_spare spare;
+	/** Set if the spare file is being prepared. */
+	bool spare_in_progress;
+	/**
+	 * Set if WAL files are compressed with a zstd dictionary
+	 * trained on the previous WAL files, see wal_train_dictionary().
+	 */
+	bool use_dictionary;
+	/** Samples of the current WAL file for dictionary training. */
+	struct xlog_dict_samples *dict_samples;
+	/** Set if a dictionary is being trained. */
+	bool dict_training_in_progress;
+	/**
+	 * A setting from instance configuration -
+	 * snap_io_latency_target. Target write latency of the WAL
+	 * kept by throttling checkpoint and dump writes, in seconds.
+	 * Zero disables the adaptive rate limit.
+	 */
+	double io_latency_target;
+	/** Max latency of a WAL write over the current period. */
+	double io_latency_max;
+	/** Max latency of a WAL write over the last period. */
+	double io_latency_last;
+	/** Timer that updates the adaptive rate limit. */
+	struct ev_timer io_timer;
 	/**
 	 * Used if there was a WAL I/O error and we need to
 	 * keep adding all incoming requests to the rollback
@@ -201,6 +273,320 @@ struct vy_log_writer {
 static struct vy_log_writer vy_log_writer;
 static struct wal_writer wal_writer_singleton;
 
+/**
+ * Size of the buffer of rows recently written to WAL, see
+ * struct wal_row_buf. Zero disables the buffer. It's applied
+ * when the buffer is allocated, i.e. on the first subscribe.
+ */
+static int wal_row_buf_size = 16 * 1024 * 1024;
+TWEAK_INT(wal_row_buf_size);
+
+enum {
+	/** Alignment of entries stored in the WAL row buffer. */
+	WAL_ROW_BUF_ALIGN = 16,
+};
+
+/** Header of a row stored in the WAL row buffer. */
+struct wal_row_buf_hdr {
+	/** LSN of the row. */
+	int64_t lsn;
+	/** Id of the replica that generated the row. */
+	uint32_t replica_id;
+	/**
+	 * Length of the encoded row following the header or 0 for
+	 * a padding entry that spans till the end of the buffer.
+	 */
+	uint32_t len;
+};
+
+static_assert(sizeof(struct wal_row_buf_hdr) == WAL_ROW_BUF_ALIGN,
+	      "WAL row buffer header must be aligned");
+
+/**
+ * Ring buffer of rows recently written to WAL. The WAL thread
+ * encodes rows right to the buffer and writes them to xlog from
+ * there. Rows become visible to relay threads once they have been
+ * successfully written to disk so that relays that keep up with
+ * the master don't need to read and decode xlog files and rows are
+ * encoded once no matter how many replicas there are. Once the
+ * buffer is full, the oldest rows are evicted. A relay that needs
+ * an evicted row falls back on reading xlog files.
+ *
+ * Offsets are absolute, i.e. grow monotonically, so that a reader
+ * can tell if the rows at its position have been evicted. Entries
+ * never wrap around the buffer end: if an entry doesn't fit in the
+ * buffer tail, the tail is filled with a padding entry.
+ */
+struct wal_row_buf {
+	/** Protects the buffer from concurrent access. */
+	pthread_mutex_t mutex;
+	/** Set if the buffer was requested by a relay. */
+	bool is_enabled;
+	/** Buffer memory or NULL if the buffer isn't allocated. */
+	char *data;
+	/** Size of the buffer memory. */
+	size_t capacity;
+	/** Offset of the oldest stored entry. */
+	uint64_t begin;
+	/** Offset following the newest stored entry. */
+	uint64_t end;
+	/**
+	 * Offset following the newest entry of the batch being
+	 * written. Entries between end and tail aren't visible to
+	 * readers. Accessed only by the WAL thread.
+	 */
+	uint64_t tail;
+	/**
+	 * Set if some rows of the batch being written couldn't be
+	 * stored. Accessed only by the WAL thread.
+	 */
+	bool is_broken;
+	/** Vclock preceding the oldest stored row. */
+	struct vclock begin_vclock;
+	/** Vclock of the newest stored row. */
+	struct vclock vclock;
+};
+
+static struct wal_row_buf wal_row_buf;
+
+/** Returns the header of the entry stored at the given offset. */
+static inline struct wal_row_buf_hdr *
+wal_row_buf_entry(struct wal_row_buf *buf, uint64_t offset)
+{
+	return (struct wal_row_buf_hdr *)(buf->data + offset % buf->capacity);
+}
+
+/** Returns the size of an entry storing a row of the given length. */
+static inline size_t
+wal_row_buf_entry_size_for(size_t len)
+{
+	size_t size = sizeof(struct wal_row_buf_hdr) + len;
+	return (size + WAL_ROW_BUF_ALIGN - 1) & ~(size_t)(WAL_ROW_BUF_ALIGN - 1);
+}
+
+/** Returns the size of the entry stored at the given offset. */
+static inline size_t
+wal_row_buf_entry_size(struct wal_row_buf *buf, uint64_t offset)
+{
+	struct wal_row_buf_hdr *hdr = wal_row_buf_entry(buf, offset);
+	if (hdr->len == 0)
+		return buf->capacity - offset % buf->capacity;
+	return wal_row_buf_entry_size_for(hdr->len);
+}
+
+/**
+ * Drop all rows stored in the buffer. Readers positioned in the
+ * buffer will have to look up the next row by vclock, which will
+ * fail, because all rows preceding the buffer vclock are gone.
+ */
+static void
+wal_row_buf_reset(struct wal_row_buf *buf)
+{
+	buf->end += WAL_ROW_BUF_ALIGN;
+	buf->begin = buf->end;
+	vclock_copy(&buf->begin_vclock, &buf->vclock);
+}
+
+/** Evict the oldest entry stored in the buffer. */
+static void
+wal_row_buf_evict(struct wal_row_buf *buf)
+{
+	assert(buf->begin < buf->end);
+	struct wal_row_buf_hdr *hdr = wal_row_buf_entry(buf, buf->begin);
+	if (hdr->len != 0)
+		vclock_follow(&buf->begin_vclock, hdr->replica_id, hdr->lsn);
+	buf->begin += wal_row_buf_entry_size(buf, buf->begin);
+}
+
+/**
+ * Prepare the buffer for writing a batch. Allocates the buffer if
+ * it was requested by a relay.
+ */
+static void
+wal_row_buf_begin(struct wal_row_buf *buf, const struct vclock *vclock)
+{
+	assert(buf->tail == buf->end);
+	if (buf->data != NULL)
+		return;
+	tt_pthread_mutex_lock(&buf->mutex);
+	if (!buf->is_enabled || wal_row_buf_size < WAL_ROW_BUF_ALIGN)
+		goto out;
+	size_t capacity = wal_row_buf_size & ~(size_t)(WAL_ROW_BUF_ALIGN - 1);
+	buf->data = malloc(capacity);
+	if (buf->data == NULL) {
+		say_warn("failed to allocate WAL row buffer");
+		buf->is_enabled = false;
+		goto out;
+	}
+	buf->capacity = capacity;
+	vclock_copy(&buf->vclock, vclock);
+	wal_row_buf_reset(buf);
+	buf->tail = buf->end;
+out:
+	tt_pthread_mutex_unlock(&buf->mutex);
+}
+
+/**
+ * Encode a row to the buffer past the visible entries, evicting
+ * old entries if necessary. Returns the encoded row or NULL if it
+ * can't be stored, e.g. because it's too big, in which case the
+ * buffer will be reset when the batch is committed.
+ */
+static const char *
+wal_row_buf_stage(struct wal_row_buf *buf, const struct xrow_header *row,
+		  size_t *len)
+{
+	if (buf->data == NULL || buf->is_broken)
+		return NULL;
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt;
+	size_t region_svp = region_used(&fiber()->gc);
+	xrow_header_encode(row, /*sync=*/0, /*fixheader_len=*/0, iov, &iovcnt);
+	*len = 0;
+	for (int i = 0; i < iovcnt; i++)
+		*len += iov[i].iov_len;
+	size_t size = wal_row_buf_entry_size_for(*len);
+	size_t tail = buf->capacity - buf->tail % buf->capacity;
+	size_t pad = tail < size ? tail : 0;
+	if (size > buf->capacity / 2)
+		goto fail;
+	if (buf->tail - buf->begin + pad + size > buf->capacity) {
+		tt_pthread_mutex_lock(&buf->mutex);
+		while (buf->tail - buf->begin + pad + size > buf->capacity &&
+		       buf->begin < buf->end)
+			wal_row_buf_evict(buf);
+		tt_pthread_mutex_unlock(&buf->mutex);
+		/* The batch may be too big to be stored. */
+		if (buf->tail - buf->begin + pad + size > buf->capacity)
+			goto fail;
+	}
+	if (pad > 0) {
+		struct wal_row_buf_hdr *hdr = wal_row_buf_entry(buf, buf->tail);
+		hdr->len = 0;
+		buf->tail += pad;
+	}
+	struct wal_row_buf_hdr *hdr = wal_row_buf_entry(buf, buf->tail);
+	hdr->lsn = row->lsn;
+	hdr->replica_id = row->replica_id;
+	hdr->len = *len;
+	char *data = (char *)(hdr + 1);
+	for (int i = 0; i < iovcnt; i++) {
+		memcpy(data, iov[i].iov_base, iov[i].iov_len);
+		data += iov[i].iov_len;
+	}
+	buf->tail += size;
+	region_truncate(&fiber()->gc, region_svp);
+	return (const char *)(hdr + 1);
+fail:
+	region_truncate(&fiber()->gc, region_svp);
+	buf->is_broken = true;
+	return NULL;
+}
+
+/**
+ * Make rows of journal entries written to disk visible to readers
+ * and drop the rows of the entries that failed to be written.
+ * @a vclock is the WAL vclock after writing the batch.
+ */
+static void
+wal_row_buf_commit(struct wal_row_buf *buf, struct stailq *entries,
+		   const struct vclock *vclock)
+{
+	if (buf->data == NULL)
+		return;
+	int64_t n_rows = 0;
+	struct journal_entry *entry;
+	stailq_foreach_entry(entry, entries, fifo)
+		n_rows += entry->n_rows;
+	uint64_t end = buf->end;
+	struct vclock end_vclock;
+	vclock_copy(&end_vclock, &buf->vclock);
+	bool is_broken = buf->is_broken;
+	while (!is_broken && n_rows > 0 && end < buf->tail) {
+		struct wal_row_buf_hdr *hdr = wal_row_buf_entry(buf, end);
+		if (hdr->len != 0) {
+			if (hdr->lsn <= vclock_get(&end_vclock,
+						   hdr->replica_id)) {
+				is_broken = true;
+				break;
+			}
+			vclock_follow(&end_vclock, hdr->replica_id, hdr->lsn);
+			n_rows--;
+		}
+		end += wal_row_buf_entry_size(buf, end);
+	}
+	if (n_rows > 0 || vclock_compare(&end_vclock, vclock) != 0) {
+		/*
+		 * The buffer is out of sync with WAL, which may only
+		 * happen if a row couldn't be stored or on error
+		 * injection. Start from scratch.
+		 */
+		is_broken = true;
+	}
+	tt_pthread_mutex_lock(&buf->mutex);
+	if (is_broken) {
+		vclock_copy(&buf->vclock, vclock);
+		buf->end = buf->tail;
+		wal_row_buf_reset(buf);
+	} else {
+		vclock_copy(&buf->vclock, &end_vclock);
+		buf->end = end;
+	}
+	tt_pthread_mutex_unlock(&buf->mutex);
+	buf->tail = buf->end;
+	buf->is_broken = false;
+}
+
+void
+wal_row_buf_enable(void)
+{
+	struct wal_row_buf *buf = &wal_row_buf;
+	tt_pthread_mutex_lock(&buf->mutex);
+	buf->is_enabled = true;
+	tt_pthread_mutex_unlock(&buf->mutex);
+}
+
+ssize_t
+wal_row_buf_read(const struct vclock *vclock, uint64_t *pos,
+		 struct ibuf *out, size_t max_size)
+{
+	struct wal_row_buf *buf = &wal_row_buf;
+	ssize_t rc = 0;
+	tt_pthread_mutex_lock(&buf->mutex);
+	if (buf->data == NULL)
+		goto fail;
+	if (*pos == UINT64_MAX || *pos < buf->begin) {
+		/*
+		 * The reader isn't positioned or its rows have been
+		 * evicted. It may start from the oldest stored row
+		 * only if all rows following its vclock are stored.
+		 */
+		int cmp = vclock_compare_ignore0(&buf->begin_vclock, vclock);
+		if (cmp != 0 && cmp != -1)
+			goto fail;
+		*pos = buf->begin;
+	}
+	assert(*pos <= buf->end);
+	while (*pos < buf->end) {
+		struct wal_row_buf_hdr *hdr = wal_row_buf_entry(buf, *pos);
+		if (hdr->len != 0) {
+			if (rc > 0 && (size_t)rc + hdr->len > max_size)
+				break;
+			char *data = ibuf_alloc(out, hdr->len);
+			if (data == NULL)
+				goto fail;
+			memcpy(data, hdr + 1, hdr->len);
+			rc += hdr->len;
+		}
+		*pos += wal_row_buf_entry_size(buf, *pos);
+	}
+	tt_pthread_mutex_unlock(&buf->mutex);
+	return rc;
+fail:
+	tt_pthread_mutex_unlock(&buf->mutex);
+	return -1;
+}
+
 enum wal_mode
 wal_mode(void)
 {
@@ -224,6 +610,66 @@ static struct cmsg_hop wal_request_route[] = {
 	{tx_complete_batch, NULL},
 };
 
+/**
+ * Flush write requests accumulated in the tx-wal pipe input to the
+ * WAL thread.
+ *
+ * This is where group commit happens: while the WAL thread is busy
+ * writing a batch, new requests can't be written anyway, so instead
+ * of queuing them as separate batches, each of which would need a
+ * separate write (and sync, in the fsync mode), we keep appending
+ * them to the batch sitting in the pipe input until the WAL thread
+ * completes the previous batch or wal_commit_delay expires. There's
+ * no delay at all if the WAL thread is idle.
+ */
+static void
+wal_flush_input(struct wal_writer *writer)
+{
+	struct cpipe *pipe = &writer->wal_pipe;
+	if (writer->commit_delay > 0 && writer->n_batches > 1 &&
+	    pipe->n_input > 0 && pipe->n_input < pipe->max_input) {
+		if (!ev_is_active(&writer->commit_timer)) {
+			ev_timer_set(&writer->commit_timer,
+				     writer->commit_delay, 0);
+			ev_timer_start(loop(), &writer->commit_timer);
+		}
+		return;
+	}
+	ev_timer_stop(loop(), &writer->commit_timer);
+	cpipe_flush_input(pipe);
+}
+
+static void
+wal_commit_timer_cb(struct ev_loop *loop, struct ev_timer *timer, int events)
+{
+	(void)loop;
+	(void)events;
+	struct wal_writer *writer = (struct wal_writer *)timer->data;
+	cpipe_flush_input(&writer->wal_pipe);
+}
+
+/**
+ * Adjusts the checkpoint write rate limit to keep the WAL write
+ * latency below the target: if a WAL write exceeded the target
+ * over the last period, the limit is halved, otherwise it's
+ * raised by 10%. Called in the WAL thread.
+ */
+static void
+wal_io_timer_cb(struct ev_loop *loop, struct ev_timer *timer, int events)
+{
+	(void)loop;
+	(void)events;
+	struct wal_writer *writer = (struct wal_writer *)timer->data;
+	uint64_t rate = pm_atomic_load(&xlog_adaptive_rate_limit);
+	if (writer->io_latency_max > writer->io_latency_target)
+		rate = MAX(rate / 2, WAL_IO_RATE_MIN);
+	else
+		rate = MIN(rate + rate / 10, WAL_IO_RATE_MAX);
+	pm_atomic_store(&xlog_adaptive_rate_limit, rate);
+	writer->io_latency_last = writer->io_latency_max;
+	writer->io_latency_max = 0;
+}
+
 static void
 wal_msg_create(struct wal_msg *batch)
 {
@@ -240,9 +686,13 @@ wal_msg(struct cmsg *msg)
 	return msg->route == wal_request_route ? (struct wal_msg *) msg : NULL;
 }
 
-/** Write a request to a log in a single transaction. */
+/**
+ * Write a request to a log in a single transaction. If @a buf is
+ * not NULL, rows are also stored in the WAL row buffer.
+ */
 static ssize_t
-xlog_write_entry(struct xlog *l, struct journal_entry *entry)
+xlog_write_entry(struct xlog *l, struct journal_entry *entry,
+		 struct wal_row_buf *buf)
 {
 	/*
 	 * Iterate over request rows (tx statements)
@@ -257,7 +707,13 @@ xlog_write_entry(struct xlog *l, struct journal_entry *entry)
 			say_warn("injected broken lsn: %lld",
 				 (long long) (*row)->lsn);
 		}
-		if (xlog_write_row(l, *row) < 0) {
+		size_t len;
+		const char *data = buf != NULL ?
+				   wal_row_buf_stage(buf, *row, &len) : NULL;
+		ssize_t rc = data != NULL ?
+			     xlog_write_encoded_row(l, data, len) :
+			     xlog_write_row(l, *row);
+		if (rc < 0) {
 			/*
 			 * Rollback all un-written rows
 			 */
@@ -365,6 +821,8 @@ tx_complete_batch(struct cmsg *msg)
 {
 	struct wal_writer *writer = &wal_writer_singleton;
 	struct wal_msg *batch = (struct wal_msg *) msg;
+	assert(writer->n_batches > 0);
+	writer->n_batches--;
 	/*
 	 * Move the rollback list to the writer first, since
 	 * wal_msg memory disappears after the first
@@ -379,6 +837,12 @@ tx_complete_batch(struct cmsg *msg)
 	tx_schedule_queue(&batch->commit);
 	trigger_run(&wal_on_write, NULL);
 	mempool_free(&writer->msg_pool, container_of(msg, struct wal_msg, base));
+	/*
+	 * If there's a batch held back while this one was being
+	 * written, it may be sent to the WAL thread now.
+	 */
+	if (ev_is_active(&writer->commit_timer))
+		wal_flush_input(writer);
 }
 
 /**
@@ -433,10 +897,19 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	struct xlog_opts opts = xlog_opts_default;
 	opts.sync_is_async = true;
+	opts.index_step = WAL_INDEX_STEP;
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid, &opts);
 	xlog_clear(&writer->current_wal);
-	if (wal_mode == WAL_FSYNC)
-		writer->wal_dir.open_wflags |= O_SYNC;
+	xlog_spare_clear(&writer->spare);
+	writer->spare_in_progress = false;
+	writer->use_dictionary = false;
+	writer->dict_samples = NULL;
+	writer->dict_training_in_progress = false;
+	writer->io_latency_target = 0;
+	writer->io_latency_max = 0;
+	writer->io_latency_last = 0;
+	ev_timer_init(&writer->io_timer, wal_io_timer_cb, 0, WAL_IO_PERIOD);
+	writer->io_timer.data = writer;
 
 	stailq_create(&writer->rollback);
 	writer->is_in_rollback = false;
@@ -454,6 +927,11 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	mempool_create(&writer->msg_pool, &cord()->slabc,
 		       sizeof(struct wal_msg));
+
+	writer->commit_delay = 0;
+	writer->n_batches = 0;
+	ev_timer_init(&writer->commit_timer, wal_commit_timer_cb, 0, 0);
+	writer->commit_timer.data = writer;
 }
 
 /** Destroy a WAL writer structure. */
@@ -548,6 +1026,8 @@ wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 			  instance_uuid, on_garbage_collection,
 			  on_checkpoint_threshold);
 
+	tt_pthread_mutex_init(&wal_row_buf.mutex, NULL);
+
 	/* Start WAL thread. */
 	if (cord_costart(&writer->cord, "wal", wal_writer_f, NULL) != 0)
 		return -1;
@@ -588,6 +1068,7 @@ wal_free(void)
 {
 	struct wal_writer *writer = &wal_writer_singleton;
 
+	ev_timer_stop(loop(), &writer->commit_timer);
 	cbus_stop_loop(&writer->wal_pipe);
 
 	if (cord_join(&writer->cord)) {
@@ -598,6 +1079,10 @@ wal_free(void)
 	trigger_destroy(&wal_on_write);
 
 	wal_writer_destroy(writer);
+
+	free(wal_row_buf.data);
+	wal_row_buf.data = NULL;
+	tt_pthread_mutex_destroy(&wal_row_buf.mutex);
 }
 
 struct wal_vclock_msg {
@@ -776,12 +1261,130 @@ wal_set_checkpoint_threshold(int64_t threshold)
 		  wal_set_checkpoint_threshold_f);
 }
 
+struct wal_set_io_latency_target_msg {
+	struct cbus_call_msg base;
+	double latency_target;
+};
+
+static int
+wal_set_io_latency_target_f(struct cbus_call_msg *data)
+{
+	struct wal_set_io_latency_target_msg *msg;
+	msg = (struct wal_set_io_latency_target_msg *)data;
+	struct wal_writer *writer = &wal_writer_singleton;
+	bool was_enabled = writer->io_latency_target > 0;
+	writer->io_latency_target = msg->latency_target;
+	if (writer->io_latency_target > 0 && !was_enabled) {
+		writer->io_latency_max = 0;
+		writer->io_latency_last = 0;
+		pm_atomic_store(&xlog_adaptive_rate_limit, WAL_IO_RATE_MAX);
+		ev_timer_again(loop(), &writer->io_timer);
+	} else if (writer->io_latency_target == 0 && was_enabled) {
+		ev_timer_stop(loop(), &writer->io_timer);
+		pm_atomic_store(&xlog_adaptive_rate_limit, 0);
+	}
+	return 0;
+}
+
+void
+wal_set_io_latency_target(double latency_target)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_io_latency_target_msg msg;
+	msg.latency_target = latency_target;
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_set_io_latency_target_f);
+}
+
+struct wal_get_io_stat_msg {
+	struct cbus_call_msg base;
+	struct wal_io_stat *stat;
+};
+
+static int
+wal_get_io_stat_f(struct cbus_call_msg *data)
+{
+	struct wal_get_io_stat_msg *msg = (struct wal_get_io_stat_msg *)data;
+	struct wal_writer *writer = &wal_writer_singleton;
+	msg->stat->latency_target = writer->io_latency_target;
+	msg->stat->latency = writer->io_latency_last;
+	msg->stat->rate_limit = pm_atomic_load(&xlog_adaptive_rate_limit);
+	return 0;
+}
+
+void
+wal_get_io_stat(struct wal_io_stat *stat)
+{
+	memset(stat, 0, sizeof(*stat));
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_get_io_stat_msg msg;
+	msg.stat = stat;
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_get_io_stat_f);
+}
+
+struct wal_set_use_dictionary_msg {
+	struct cbus_call_msg base;
+	bool use_dictionary;
+};
+
+static int
+wal_set_use_dictionary_f(struct cbus_call_msg *data)
+{
+	struct wal_set_use_dictionary_msg *msg;
+	msg = (struct wal_set_use_dictionary_msg *)data;
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->use_dictionary == msg->use_dictionary)
+		return 0;
+	writer->use_dictionary = msg->use_dictionary;
+	if (writer->use_dictionary) {
+		/* Start sampling the current WAL file. */
+		assert(writer->dict_samples == NULL);
+		writer->dict_samples = xlog_dict_samples_new();
+		if (xlog_is_open(&writer->current_wal))
+			writer->current_wal.dict_samples =
+				writer->dict_samples;
+	} else {
+		/* The current WAL file keeps its dictionary. */
+		writer->current_wal.dict_samples = NULL;
+		xlog_dict_samples_delete(writer->dict_samples);
+		writer->dict_samples = NULL;
+		xdir_set_dictionary(&writer->wal_dir, NULL, 0);
+	}
+	return 0;
+}
+
+void
+wal_set_use_dictionary(bool use_dictionary)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (writer->wal_mode == WAL_NONE)
+		return;
+	struct wal_set_use_dictionary_msg msg;
+	msg.use_dictionary = use_dictionary;
+	cbus_call(&writer->wal_pipe, &writer->tx_prio_pipe, &msg.base,
+		  wal_set_use_dictionary_f);
+}
+
 void
 wal_set_queue_max_size(int64_t size)
 {
 	journal_queue_set_max_size(size);
 }
 
+void
+wal_set_commit_delay(double delay)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	writer->commit_delay = delay;
+	if (ev_is_active(&writer->commit_timer))
+		wal_flush_input(writer);
+}
+
 struct wal_gc_msg
 {
 	struct cbus_call_msg base;
@@ -831,6 +1434,163 @@ wal_collect_garbage(const struct vclock *vclock)
 static void
 wal_notify_watchers(struct wal_writer *writer, unsigned events);
 
+struct wal_spare_task {
+	struct coio_task base;
+	/** The writer the spare file is prepared for. */
+	struct wal_writer *writer;
+	/** Size of disk space to preallocate. */
+	size_t len;
+	/** The spare file. Filled in a coio thread. */
+	struct xlog_spare spare;
+	/** Name of the spare file. */
+	char filename[PATH_MAX];
+};
+
+/** Creates a spare WAL file. Called in a coio thread. */
+static int
+wal_spare_create_f(struct coio_task *base)
+{
+	struct wal_spare_task *task = (struct wal_spare_task *)base;
+	if (xlog_spare_create(&task->spare, task->filename, 0,
+			      task->len) != 0) {
+		diag_log();
+		say_warn("failed to prepare a spare WAL file");
+	}
+	return 0;
+}
+
+/** Passes a spare WAL file to the writer. Called in the WAL thread. */
+static int
+wal_spare_create_done_f(struct coio_task *base)
+{
+	struct wal_spare_task *task = (struct wal_spare_task *)base;
+	struct wal_writer *writer = task->writer;
+	assert(writer->spare_in_progress);
+	assert(writer->spare.fd < 0);
+	writer->spare = task->spare;
+	writer->spare_in_progress = false;
+	coio_task_destroy(&task->base);
+	free(task);
+	return 0;
+}
+
+/**
+ * Starts preparing a spare file for the next WAL in background
+ * unless there's one already. Creating a file and allocating
+ * disk space for it may take a while on some file systems, so
+ * doing it right at rotation causes latency spikes.
+ *
+ * Note, we don't reuse old WAL files for this, because readers
+ * assume that everything before EOF is valid data so an old file
+ * would have to be truncated, which frees its disk space anyway.
+ */
+static void
+wal_prepare_spare(struct wal_writer *writer)
+{
+	if (writer->spare.fd >= 0 || writer->spare_in_progress)
+		return;
+	struct wal_spare_task *task = malloc(sizeof(*task));
+	if (task == NULL) {
+		say_warn("failed to allocate spare WAL file task");
+		return;
+	}
+	task->writer = writer;
+	task->len = MIN(writer->wal_max_size, WAL_SPARE_LEN);
+	xlog_spare_clear(&task->spare);
+	strlcpy(task->filename, xdir_spare_filename(&writer->wal_dir),
+		sizeof(task->filename));
+	coio_task_create(&task->base, wal_spare_create_f,
+			 wal_spare_create_done_f);
+	coio_task_set_pri(&task->base, COIO_PRI_META);
+	coio_task_post(&task->base);
+	writer->spare_in_progress = true;
+}
+
+struct wal_dict_task {
+	struct coio_task base;
+	/** The writer the dictionary is trained for. */
+	struct wal_writer *writer;
+	/** Samples to train the dictionary on. */
+	struct xlog_dict_samples *samples;
+	/** The trained dictionary or NULL. Filled in a coio thread. */
+	char *dictionary;
+	/** Size of the trained dictionary. */
+	size_t dictionary_size;
+};
+
+/** Trains a compression dictionary. Called in a coio thread. */
+static int
+wal_dict_train_f(struct coio_task *base)
+{
+	struct wal_dict_task *task = (struct wal_dict_task *)base;
+	task->dictionary = xlog_dict_train(task->samples,
+					   &task->dictionary_size);
+	if (task->dictionary == NULL) {
+		diag_log();
+		say_warn("failed to train a WAL compression dictionary");
+	}
+	return 0;
+}
+
+/**
+ * Passes a trained dictionary to the writer. Called in the WAL
+ * thread.
+ */
+static int
+wal_dict_train_done_f(struct coio_task *base)
+{
+	struct wal_dict_task *task = (struct wal_dict_task *)base;
+	struct wal_writer *writer = task->writer;
+	assert(writer->dict_training_in_progress);
+	writer->dict_training_in_progress = false;
+	if (task->dictionary != NULL && writer->use_dictionary) {
+		say_verbose("trained a WAL compression dictionary "
+			    "of %zu bytes", task->dictionary_size);
+		xdir_set_dictionary(&writer->wal_dir, task->dictionary,
+				    task->dictionary_size);
+	} else {
+		free(task->dictionary);
+	}
+	xlog_dict_samples_delete(task->samples);
+	coio_task_destroy(&task->base);
+	free(task);
+	return 0;
+}
+
+/**
+ * Starts training a new compression dictionary on the samples
+ * of the previous WAL files in background if there are enough
+ * of them and starts sampling the next WAL file. The dictionary
+ * is used for WAL files created after the training completes.
+ *
+ * Must be called when there's no current WAL file, because
+ * the current WAL file refers to the samples.
+ */
+static void
+wal_train_dictionary(struct wal_writer *writer)
+{
+	assert(!xlog_is_open(&writer->current_wal));
+	if (!writer->use_dictionary || writer->dict_training_in_progress)
+		return;
+	assert(writer->dict_samples != NULL);
+	if (!xlog_dict_samples_are_enough(writer->dict_samples))
+		return;
+	struct wal_dict_task *task = malloc(sizeof(*task));
+	if (task == NULL) {
+		say_warn("failed to allocate dictionary training task");
+		return;
+	}
+	task->writer = writer;
+	task->samples = writer->dict_samples;
+	task->dictionary = NULL;
+	task->dictionary_size = 0;
+	writer->dict_samples = xlog_dict_samples_new();
+	coio_task_create(&task->base, wal_dict_train_f,
+			 wal_dict_train_done_f);
+	coio_task_post(&task->base);
+	writer->dict_training_in_progress = true;
+}
+
 /**
  * If there is no current WAL, try to open it, and close the
  * previous WAL. We close the previous WAL only after opening
@@ -860,9 +1620,14 @@ wal_opt_rotate(struct wal_writer *writer)
 	if (xlog_is_open(&writer->current_wal))
 		return 0;
 
-	if (xdir_create_xlog(&writer->wal_dir, &writer->current_wal,
-			     &writer->vclock) != 0)
+	wal_train_dictionary(writer);
+	if (xdir_create_xlog_from_spare(&writer->wal_dir,
+					&writer->current_wal,
+					&writer->vclock,
+					&writer->spare) != 0)
 		return -1;
+	writer->current_wal.dict_samples = writer->dict_samples;
+	wal_prepare_spare(writer);
 	/*
 	 * Keep track of the new WAL vclock. Required for garbage
 	 * collection, see wal_collect_garbage().
@@ -914,6 +1679,11 @@ wal_fallocate(struct wal_writer *writer, size_t len)
 	}
 	if (errno != ENOSPC)
 		goto error;
+	if (writer->spare.fd >= 0) {
+		/* Free the disk space reserved for the next WAL. */
+		xlog_spare_destroy(&writer->spare);
+		goto retry;
+	}
 	if (!xdir_has_garbage(&writer->wal_dir, gc_lsn))
 		goto error;
 
@@ -1029,14 +1799,72 @@ wal_assign_lsn(struct vclock *vclock_diff, struct vclock *base,
 	(*end)->is_commit = true;
 }
 
+/**
+ * WAL writer state at the beginning of a batch, used for rolling
+ * back the batch in case it fails to be synced to disk.
+ */
+struct wal_batch_start {
+	/** Write position in the current WAL file. */
+	off_t offset;
+	/** Number of rows in the current WAL file. */
+	int64_t rows;
+	/** Size of WAL files written since the last checkpoint. */
+	int64_t checkpoint_wal_size;
+	/** WAL writer vclock. */
+	struct vclock vclock;
+};
+
+static void
+wal_batch_start_create(struct wal_batch_start *start,
+		       struct wal_writer *writer)
+{
+	start->offset = writer->current_wal.offset;
+	start->rows = writer->current_wal.rows;
+	start->checkpoint_wal_size = writer->checkpoint_wal_size;
+	vclock_copy(&start->vclock, &writer->vclock);
+}
+
+/**
+ * Flush rows written by the current batch to the storage device.
+ * If it fails, we can't tell which of them reached the disk, so
+ * the whole batch is discarded: the WAL file is truncated to the
+ * position where the batch started and the writer vclock is reset
+ * to the value it had before the batch.
+ */
+static int
+wal_sync_batch(struct wal_writer *writer, struct wal_batch_start *start)
+{
+	struct xlog *l = &writer->current_wal;
+	USDT_PROBE(wal_fsync_start);
+	int rc = xlog_sync_data(l);
+	USDT_PROBE(wal_fsync_done, rc);
+	if (rc == 0)
+		return 0;
+	/*
+	 * If we can't discard the rows, they may be read back on
+	 * recovery after we've rolled the batch back in memory.
+	 */
+	if (xlog_truncate(l, start->offset) != 0) {
+		diag_log();
+		panic("failed to discard rows of a WAL batch that failed "
+		      "to sync");
+	}
+	l->rows = start->rows;
+	writer->checkpoint_wal_size = start->checkpoint_wal_size;
+	vclock_copy(&writer->vclock, &start->vclock);
+	return -1;
+}
+
 static void
 wal_write_to_disk(struct cmsg *msg)
 {
 	struct wal_writer *writer = &wal_writer_singleton;
 	struct wal_msg *wal_msg = (struct wal_msg *) msg;
+	double start_time = ev_monotonic_time();
 	int err_code = JOURNAL_ENTRY_ERR_UNKNOWN;
 	struct stailq_entry *last_committed = NULL;
 	struct journal_entry *entry;
+	struct wal_batch_start batch_start;
 	struct error *error;
 	if (stailq_empty(&wal_msg->commit))
 		panic("Attempted to write an empty batch to WAL");
@@ -1049,6 +1877,7 @@ wal_write_to_disk(struct cmsg *msg)
 	struct vclock vclock_diff;
 	vclock_create(&vclock_diff);
 
+	USDT_PROBE(wal_write_start, wal_msg->approx_len);
 	ERROR_INJECT_SLEEP(ERRINJ_WAL_DELAY);
 
 	ERROR_INJECT_COUNTDOWN(ERRINJ_WAL_DELAY_COUNTDOWN, {
@@ -1098,15 +1927,30 @@ wal_write_to_disk(struct cmsg *msg)
 
 	struct xlog *l = &writer->current_wal;
 
+	/*
+	 * In the fsync mode, the batch is flushed to the storage device
+	 * with a single fdatasync(2) call after all its rows have been
+	 * written rather than with O_SYNC on every writev(2). Should
+	 * the sync fail, the whole batch is rolled back, so remember
+	 * the state to restore.
+	 */
+	wal_batch_start_create(&batch_start, writer);
+	wal_row_buf_begin(&wal_row_buf, &writer->vclock);
+
 	/*
 	 * Iterate over requests (transactions)
 	 */
 	int rc;
 	stailq_foreach_entry(entry, &wal_msg->commit, fifo) {
+		/*
+		 * If the row buffer is empty, all rows written so far
+		 * are accounted in the writer vclock, see below.
+		 */
+		xlog_index_add(l, &writer->vclock);
 		wal_assign_lsn(&vclock_diff, &writer->vclock, entry);
 		entry->res = vclock_sum(&vclock_diff) +
 			     vclock_sum(&writer->vclock);
-		rc = xlog_write_entry(l, entry);
+		rc = xlog_write_entry(l, entry, &wal_row_buf);
 		if (rc < 0) {
 			err_code = JOURNAL_ENTRY_ERR_IO;
 			goto done;
@@ -1151,6 +1995,15 @@ wal_write_to_disk(struct cmsg *msg)
 	}
 
 done:
+	if (writer->wal_mode == WAL_FSYNC && last_committed != NULL &&
+	    wal_sync_batch(writer, &batch_start) != 0) {
+		err_code = JOURNAL_ENTRY_ERR_IO;
+		last_committed = NULL;
+	}
+	if (writer->io_latency_target > 0) {
+		double latency = ev_monotonic_time() - start_time;
+		writer->io_latency_max = MAX(writer->io_latency_max, latency);
+	}
 	error = diag_last_error(diag_get());
 	if (error) {
 		/* Until we can pass the error to tx, log it and clear. */
@@ -1184,6 +2037,13 @@ wal_write_to_disk(struct cmsg *msg)
 	} else {
 		assert(err_code == JOURNAL_ENTRY_ERR_UNKNOWN);
 	}
+	/*
+	 * Make the committed rows available to relays before
+	 * notifying them.
+	 */
+	wal_row_buf_commit(&wal_row_buf, &wal_msg->commit, &writer->vclock);
+	USDT_PROBE(wal_write_done, vclock_sum(&writer->vclock),
+		   err_code != JOURNAL_ENTRY_ERR_UNKNOWN);
 	wal_notify_watchers(writer, WAL_EVENT_WRITE);
 	ERROR_INJECT_SLEEP(ERRINJ_RELAY_FASTER_THAN_TX);
 }
@@ -1228,6 +2088,10 @@ wal_writer_f(va_list ap)
 
 	if (xlog_is_open(&writer->current_wal))
 		wal_xlog_close(&writer->current_wal);
+	xlog_spare_destroy(&writer->spare);
+	if (writer->dict_samples != NULL)
+		xlog_dict_samples_delete(writer->dict_samples);
+	ev_timer_stop(loop(), &writer->io_timer);
 
 	if (xlog_is_open(&vy_log_writer.xlog))
 		wal_xlog_close(&vy_log_writer.xlog);
@@ -1279,13 +2143,14 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 			goto fail;
 		}
 		wal_msg_create(batch);
+		writer->n_batches++;
 		/*
 		 * Sic: first add a request, then push the batch,
-		 * since cpipe_push() may pass the batch to WAL
-		 * thread right away.
+		 * since cpipe_push_input() may pass the batch to
+		 * WAL thread right away.
 		 */
 		stailq_add_tail_entry(&batch->commit, entry, fifo);
-		cpipe_push(&writer->wal_pipe, &batch->base);
+		cpipe_push_input(&writer->wal_pipe, &batch->base);
 	}
 	/*
 	 * Remember last entry sent to WAL. In case of rollback
@@ -1298,7 +2163,7 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 #ifndef NDEBUG
 	++errinj(ERRINJ_WAL_WRITE_COUNT, ERRINJ_INT)->iparam;
 #endif
-	cpipe_flush_input(&writer->wal_pipe);
+	wal_flush_input(writer);
 	return 0;
 
 fail:
@@ -1369,7 +2234,7 @@ wal_write_vy_log_f(struct cbus_call_msg *msg)
 			return -1;
 	}
 
-	if (xlog_write_entry(&vy_log_writer.xlog, entry) < 0)
+	if (xlog_write_entry(&vy_log_writer.xlog, entry, NULL) < 0)
 		return -1;
 
 	if (xlog_flush(&vy_log_writer.xlog) < 0)
@@ -40,6 +40,7 @@
 struct fiber;
 struct wal_writer;
 struct tt_uuid;
+struct ibuf;
 
 enum wal_mode {
 	/**
@@ -205,6 +206,33 @@ void
 wal_clear_watcher(struct wal_watcher *watcher,
 		  void (*process_cb)(struct cbus_endpoint *));
 
+/**
+ * Ask the WAL thread to keep rows it writes in memory so that
+ * relays can read them without accessing xlog files. The buffer
+ * is allocated on the next write.
+ */
+void
+wal_row_buf_enable(void);
+
+/**
+ * Copy rows following @a vclock from the buffer of rows recently
+ * written to WAL to @a out. The rows are stored one after another
+ * encoded as in xlog files so that they can be decoded with
+ * xrow_header_decode(). At least one row and no more than
+ * @a max_size bytes are copied unless the first row is bigger.
+ *
+ * @a pos is the reader position in the buffer, which is advanced
+ * past the copied rows. It must be set to UINT64_MAX before the
+ * first call and whenever the reader vclock changes otherwise.
+ *
+ * Returns the size of the copied data, which is 0 if there are
+ * no rows following @a vclock yet, or -1 if some of the rows are
+ * missing from the buffer and have to be read from xlog files.
+ */
+ssize_t
+wal_row_buf_read(const struct vclock *vclock, uint64_t *pos,
+		 struct ibuf *out, size_t max_size);
+
 enum wal_mode
 wal_mode(void);
 
@@ -266,6 +294,43 @@ wal_set_checkpoint_threshold(int64_t threshold);
 void
 wal_set_queue_max_size(int64_t size);
 
+/**
+ * Set the target WAL write latency, in seconds. If it's greater
+ * than 0, the WAL thread throttles checkpoint and vinyl dump
+ * writes to keep the latency of WAL writes below the target.
+ */
+void
+wal_set_io_latency_target(double latency_target);
+
+/** Statistics of the adaptive checkpoint write rate limit. */
+struct wal_io_stat {
+	/** Target WAL write latency, in seconds, 0 if disabled. */
+	double latency_target;
+	/** Max WAL write latency over the last period, in seconds. */
+	double latency;
+	/** Current write rate limit, in bytes per second. */
+	uint64_t rate_limit;
+};
+
+/** Get statistics of the adaptive checkpoint write rate limit. */
+void
+wal_get_io_stat(struct wal_io_stat *stat);
+
+/**
+ * Enable or disable compression of new WAL files with a zstd
+ * dictionary trained on the previous WAL files.
+ */
+void
+wal_set_use_dictionary(bool use_dictionary);
+
+/**
+ * Set the max time a new batch of write requests may be held back
+ * while the WAL thread is busy writing previous batches so that
+ * more requests get committed with a single write.
+ */
+void
+wal_set_commit_delay(double delay);
+
 /**
  * Remove WAL files that are not needed by consumers reading
  * rows at @vclock or newer.
@@ -25,6 +25,17 @@
  */
 static struct watchable box_watchable;
 
+enum {
+	/**
+	 * Max number of watchers the worker fiber runs in a row before
+	 * yielding. When a key with thousands of subscribers is updated,
+	 * this lets the event loop flush the notifications queued so far
+	 * and the network threads start sending them while the rest of
+	 * the watchers are still being run.
+	 */
+	WATCHABLE_WORKER_BATCH_SIZE = 1000,
+};
+
 /**
  * Returns true if the watchable node can be dropped, i.e. it doesn't have data
  * or registered watchers.
@@ -348,11 +359,21 @@ watchable_worker_f(va_list ap)
 	(void)ap;
 	struct watchable *watchable = fiber()->f_arg;
 	assert(watchable->worker == fiber());
+	int batch_size = 0;
 	while (!fiber_is_cancelled()) {
 		fiber_check_gc();
 		if (!watchable_run(watchable)) {
 			/* No more watchers to run, wait... */
+			batch_size = 0;
 			fiber_sleep(TIMEOUT_INFINITY);
+		} else if (++batch_size >= WATCHABLE_WORKER_BATCH_SIZE) {
+			/*
+			 * Updates done while we are yielding don't reschedule
+			 * the watchers that are still pending so they will
+			 * run only once, with the latest data.
+			 */
+			batch_size = 0;
+			fiber_sleep(0);
 		}
 	}
 	return 0;
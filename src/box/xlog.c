@@ -31,6 +31,7 @@
 #include "xlog.h"
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <ctype.h>
 
 #include "fiber.h"
@@ -48,6 +49,8 @@
 #include "errinj.h"
 #include "salad/grp_alloc.h"
 #include "trivia/util.h"
+#include "zdict.h"
+#include <pmatomic.h>
 
 /*
  * FALLOC_FL_KEEP_SIZE flag has existed since fallocate() was
@@ -89,16 +92,27 @@ enum {
 	 * Maybe this should be a configuration option.
 	 */
 	XLOG_TX_COMPRESS_THRESHOLD = 2 * 1024,
+	/**
+	 * Compression threshold used when compressing with
+	 * a dictionary.
+	 */
+	XLOG_TX_DICT_COMPRESS_THRESHOLD = 256,
+	/** Zstd compression level. */
+	XLOG_ZSTD_LEVEL = 3,
 };
 
 const struct xlog_opts xlog_opts_default = {
 	.rate_limit = 0,
+	.rate_limit_is_adaptive = false,
 	.sync_interval = 0,
 	.free_cache = false,
 	.sync_is_async = false,
 	.no_compression = false,
+	.index_step = 0,
 };
 
+uint64_t xlog_adaptive_rate_limit = 0;
+
 /* {{{ struct xlog_meta */
 
 enum {
@@ -115,6 +129,7 @@ enum {
 #define VCLOCK_KEY "VClock"
 #define VERSION_KEY "Version"
 #define PREV_VCLOCK_KEY "PrevVClock"
+#define DICTIONARY_KEY "Dictionary"
 
 static const char v13[] = "0.13";
 static const char v12[] = "0.12";
@@ -135,6 +150,7 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 		vclock_copy(&meta->prev_vclock, prev_vclock);
 	else
 		vclock_clear(&meta->prev_vclock);
+	meta->dictionary_id = 0;
 }
 
 /**
@@ -168,6 +184,10 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 		SNPRINT(total, snprintf, buf, size, PREV_VCLOCK_KEY ": %s\n",
 			vclock_to_string(&meta->prev_vclock));
 	}
+	if (meta->dictionary_id != 0) {
+		SNPRINT(total, snprintf, buf, size, DICTIONARY_KEY ": %u\n",
+			(unsigned)meta->dictionary_id);
+	}
 	SNPRINT(total, snprintf, buf, size, "\n");
 	assert(total > 0);
 	return total;
@@ -309,6 +329,17 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 			 */
 			if (parse_vclock(val, val_end, &meta->prev_vclock) != 0)
 				return -1;
+		} else if (xlog_meta_key_equal(key, key_end, DICTIONARY_KEY)) {
+			/*
+			 * Dictionary: <dictionary id>
+			 */
+			char *id_end;
+			unsigned long id = strtoul(val, &id_end, 10);
+			if (id_end != val_end || id == 0 || id > UINT32_MAX) {
+				diag_set(XlogError, "can't parse dictionary id");
+				return -1;
+			}
+			meta->dictionary_id = id;
 		} else if (xlog_meta_key_equal(key, key_end, VERSION_KEY)) {
 			/* Ignore Version: for now */
 		} else {
@@ -385,6 +416,15 @@ xdir_destroy(struct xdir *dir)
 {
 	/** Free vclock objects allocated in xdir_scan(). */
 	vclockset_reset(&dir->index);
+	free(dir->dictionary);
+}
+
+void
+xdir_set_dictionary(struct xdir *dir, char *dictionary, size_t size)
+{
+	free(dir->dictionary);
+	dir->dictionary = dictionary;
+	dir->dictionary_size = dictionary != NULL ? size : 0;
 }
 
 /**
@@ -659,6 +699,13 @@ xdir_format_filename(struct xdir *dir, int64_t signature,
 					      inprogress_suffix : "");
 }
 
+/** Returns the name of the sparse tx block index of an xlog file. */
+static const char *
+xlog_index_filename(const char *filename)
+{
+	return tt_snprintf(PATH_MAX, "%s%s", filename, xlog_index_suffix);
+}
+
 void
 xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 {
@@ -671,6 +718,10 @@ xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags)
 		const char *filename =
 			xdir_format_filename(dir, vclock_sum(vclock), NONE);
 		xlog_remove_file(filename, rm_flags);
+		if (dir->type == XLOG) {
+			xlog_remove_file(xlog_index_filename(filename),
+					 rm_flags & ~XLOG_RM_VERBOSE);
+		}
 		vclockset_remove(&dir->index, vclock);
 		free(vclock);
 		if (flags & XDIR_GC_REMOVE_ONE)
@@ -688,6 +739,8 @@ xdir_remove_file_by_vclock(struct xdir *dir, struct vclock *to_remove)
 		xdir_format_filename(dir, vclock_sum(find), NONE);
 	if (!xlog_remove_file(filename, XLOG_RM_VERBOSE))
 		return -1;
+	if (dir->type == XLOG)
+		xlog_remove_file(xlog_index_filename(filename), 0);
 	vclockset_remove(&dir->index, find);
 	free(find);
 	return 0;
@@ -772,6 +825,7 @@ xlog_init(struct xlog *xlog, const struct xlog_opts *opts)
 {
 	memset(xlog, 0, sizeof(*xlog));
 	xlog->opts = *opts;
+	xlog->index_fd = -1;
 	xlog->sync_time = ev_monotonic_time();
 	xlog->is_autocommit = true;
 	obuf_create(&xlog->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
@@ -792,6 +846,7 @@ xlog_clear(struct xlog *l)
 {
 	memset(l, 0, sizeof(*l));
 	l->fd = -1;
+	l->index_fd = -1;
 }
 
 /**
@@ -802,17 +857,183 @@ static void
 xlog_free(struct xlog *xlog)
 {
 	assert(xlog->fd < 0);
+	if (xlog->index_fd >= 0) {
+		close(xlog->index_fd);
+		xlog->index_fd = -1;
+	}
 	assert(xlog->obuf.slabc == &cord()->slabc);
 	assert(xlog->zbuf.slabc == &cord()->slabc);
 	obuf_destroy(&xlog->obuf);
 	obuf_destroy(&xlog->zbuf);
 	ZSTD_freeCCtx(xlog->zctx);
 	xlog->zctx = NULL;
+	ZSTD_freeCDict(xlog->zcdict);
+	xlog->zcdict = NULL;
+}
+
+/**
+ * Returns the name of the sparse tx block index of an xlog.
+ * The index is named after the final xlog file name so that
+ * it doesn't have to be renamed when the xlog is materialized.
+ */
+static const char *
+xlog_index_path(const struct xlog *l)
+{
+	int len = strlen(l->filename);
+	if (l->is_inprogress)
+		len -= strlen(inprogress_suffix);
+	return tt_snprintf(PATH_MAX, "%.*s%s", len, l->filename,
+			   xlog_index_suffix);
+}
+
+/**
+ * Creates the sparse tx block index of an xlog. The index is
+ * a text file. It starts with the vclock of the xlog meta so
+ * that readers can check that the index matches the file. Each
+ * entry is a line with a tx block offset and the vclock of all
+ * rows written before the block.
+ *
+ * The index is created on the first entry so that small files
+ * don't get one.
+ */
+static int
+xlog_index_create(struct xlog *l)
+{
+	assert(l->index_fd < 0);
+	const char *path = xlog_index_path(l);
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		say_syserror("failed to create xlog index '%s'", path);
+		return -1;
+	}
+	const char *header = tt_sprintf("VClock: %s\n",
+					vclock_to_string(&l->meta.vclock));
+	if (fio_writen(fd, header, strlen(header)) < 0) {
+		say_syserror("failed to write xlog index '%s'", path);
+		close(fd);
+		xlog_remove_file(path, 0);
+		return -1;
+	}
+	l->index_fd = fd;
+	return 0;
+}
+
+/**
+ * Stops maintaining the sparse tx block index of an xlog and
+ * removes it so that readers don't use it.
+ */
+static void
+xlog_index_drop(struct xlog *l)
+{
+	if (l->index_fd >= 0) {
+		close(l->index_fd);
+		l->index_fd = -1;
+	}
+	xlog_remove_file(xlog_index_path(l), 0);
+	l->opts.index_step = 0;
+}
+
+void
+xlog_index_add(struct xlog *log, const struct vclock *vclock)
+{
+	if (log->opts.index_step == 0 || obuf_size(&log->obuf) != 0 ||
+	    log->offset < log->index_offset + (off_t)log->opts.index_step)
+		return;
+	/*
+	 * The index is optional so an error isn't fatal: it is
+	 * logged and the xlog is written without the index.
+	 */
+	if (log->index_fd < 0 && xlog_index_create(log) != 0) {
+		log->opts.index_step = 0;
+		return;
+	}
+	const char *entry = tt_sprintf("%lld %s\n", (long long)log->offset,
+				       vclock_to_string(vclock));
+	if (fio_writen(log->index_fd, entry, strlen(entry)) < 0) {
+		say_syserror("failed to write xlog index '%s'",
+			     xlog_index_path(log));
+		xlog_index_drop(log);
+		return;
+	}
+	log->index_offset = log->offset;
+}
+
+const char *
+xdir_spare_filename(struct xdir *dir)
+{
+	return tt_snprintf(PATH_MAX, "%s/spare%s%s", dir->dirname,
+			   dir->filename_ext, inprogress_suffix);
 }
 
 int
-xlog_create(struct xlog *xlog, const char *name, int flags,
-	    const struct xlog_meta *meta, const struct xlog_opts *opts)
+xlog_spare_create(struct xlog_spare *spare, const char *filename,
+		  int flags, size_t len)
+{
+	xlog_spare_clear(spare);
+	strlcpy(spare->filename, filename, sizeof(spare->filename));
+	/*
+	 * A spare file left from a previous run, if any, is
+	 * overwritten, because it's never used by readers.
+	 */
+	flags |= O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC;
+	spare->fd = open(filename, flags, 0644);
+	if (spare->fd < 0) {
+		diag_set(SystemError, "failed to create file '%s'", filename);
+		return -1;
+	}
+#ifdef HAVE_FALLOCATE
+	/* Keep the file size for the same reason as xlog_fallocate(). */
+	if (fallocate(spare->fd, FALLOC_FL_KEEP_SIZE, 0, len) == 0) {
+		spare->allocated = len;
+	} else if (errno != ENOSYS && errno != EOPNOTSUPP) {
+		diag_set(SystemError, "%s: can't allocate disk space",
+			 filename);
+		xlog_spare_destroy(spare);
+		return -1;
+	}
+#else
+	(void)len;
+#endif
+	return 0;
+}
+
+void
+xlog_spare_destroy(struct xlog_spare *spare)
+{
+	if (spare->fd < 0)
+		return;
+	close(spare->fd);
+	xlog_remove_file(spare->filename, 0);
+	xlog_spare_clear(spare);
+}
+
+/**
+ * Gives a spare file the name of a new xlog file. link() is used
+ * instead of rename(), because it fails if the target exists.
+ * On failure the spare file is destroyed.
+ */
+static int
+xlog_spare_use(struct xlog_spare *spare, const char *filename)
+{
+	if (link(spare->filename, filename) != 0) {
+		say_syserror("failed to link '%s' to '%s'",
+			     spare->filename, filename);
+		xlog_spare_destroy(spare);
+		return -1;
+	}
+	if (unlink(spare->filename) != 0)
+		say_syserror("failed to unlink '%s'", spare->filename);
+	return 0;
+}
+
+/**
+ * Creates a new xlog file. If @a spare is not NULL and holds
+ * a spare file, the spare file is used for the new xlog.
+ */
+static int
+xlog_create_impl(struct xlog *xlog, const char *name, int flags,
+		 const struct xlog_meta *meta, const struct xlog_opts *opts,
+		 struct xlog_spare *spare)
 {
 	char meta_buf[XLOG_META_LEN_MAX];
 	int meta_len;
@@ -853,7 +1074,14 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	 * may think that this is a corrupt file and stop
 	 * replication.
 	 */
-	xlog->fd = open(xlog->filename, flags, 0644);
+	if (spare != NULL && spare->fd >= 0 &&
+	    xlog_spare_use(spare, xlog->filename) == 0) {
+		xlog->fd = spare->fd;
+		xlog->allocated = spare->allocated;
+		xlog_spare_clear(spare);
+	} else {
+		xlog->fd = open(xlog->filename, flags, 0644);
+	}
 	if (xlog->fd < 0) {
 		diag_set(SystemError, "failed to create file '%s'",
 			 xlog->filename);
@@ -875,6 +1103,11 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	}
 
 	xlog->offset = meta_len; /* first log starts after meta */
+	xlog->allocated -= MIN(xlog->allocated, (size_t)meta_len);
+	/* The index is created lazily, remove a stale one, if any. */
+	if (xlog->opts.index_step != 0)
+		xlog_remove_file(xlog_index_path(xlog), 0);
+	xlog->index_offset = xlog->offset;
 	return 0;
 err_write:
 	close(xlog->fd);
@@ -886,6 +1119,13 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	return -1;
 }
 
+int
+xlog_create(struct xlog *xlog, const char *name, int flags,
+	    const struct xlog_meta *meta, const struct xlog_opts *opts)
+{
+	return xlog_create_impl(xlog, name, flags, meta, opts, NULL);
+}
+
 int
 xlog_open(struct xlog *xlog, const char *name, const struct xlog_opts *opts)
 {
@@ -949,6 +1189,14 @@ xlog_open(struct xlog *xlog, const char *name, const struct xlog_opts *opts)
 			goto err_read;
 		}
 	}
+	/*
+	 * We don't know if the existing index matches the blocks
+	 * written to the file, because the last entry could have
+	 * been written without its block, so start a new one.
+	 */
+	if (xlog->opts.index_step != 0)
+		xlog_remove_file(xlog_index_path(xlog), 0);
+	xlog->index_offset = xlog->offset;
 	return 0;
 err_read:
 	close(xlog->fd);
@@ -982,9 +1230,50 @@ xdir_touch_xlog(struct xdir *dir, const struct vclock *vclock)
  * In case of error, writes a message to the error log
  * and sets errno.
  */
+/**
+ * Writes a zstd dictionary to a new xlog file and starts using it
+ * for compression. The dictionary is written in a separate tx
+ * block, which is compressed without the dictionary, as a row of
+ * type XLOG_DICTIONARY with the dictionary stored in IPROTO_DATA.
+ */
+static int
+xlog_write_dictionary(struct xlog *log, const char *dictionary,
+		      size_t size)
+{
+	assert(log->zcdict == NULL);
+	assert(obuf_size(&log->obuf) == 0);
+	size_t body_size = mp_sizeof_map(1) + mp_sizeof_uint(IPROTO_DATA) +
+			   mp_sizeof_bin(size);
+	char *body = xmalloc(body_size);
+	char *data = mp_encode_map(body, 1);
+	data = mp_encode_uint(data, IPROTO_DATA);
+	data = mp_encode_bin(data, dictionary, size);
+	assert(data == body + body_size);
+	struct xrow_header row;
+	memset(&row, 0, sizeof(row));
+	row.type = XLOG_DICTIONARY;
+	row.bodycnt = 1;
+	row.body[0].iov_base = body;
+	row.body[0].iov_len = body_size;
+	int rc = -1;
+	if (xlog_write_row(log, &row) < 0 || xlog_flush(log) < 0)
+		goto out;
+	log->zcdict = ZSTD_createCDict(dictionary, size, XLOG_ZSTD_LEVEL);
+	if (log->zcdict == NULL) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 "failed to create dictionary");
+		goto out;
+	}
+	rc = 0;
+out:
+	free(body);
+	return rc;
+}
+
 int
-xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
-		 const struct vclock *vclock)
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock,
+			    struct xlog_spare *spare)
 {
 	int64_t signature = vclock_sum(vclock);
 	assert(signature >= 0);
@@ -1001,11 +1290,26 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	struct xlog_meta meta;
 	xlog_meta_create(&meta, dir->filetype, dir->instance_uuid,
 			 vclock, prev_vclock);
+	if (dir->dictionary != NULL) {
+		meta.dictionary_id = ZDICT_getDictID(dir->dictionary,
+						     dir->dictionary_size);
+	}
 
 	const char *filename = xdir_format_filename(dir, signature, NONE);
-	if (xlog_create(xlog, filename, dir->open_wflags, &meta,
-			&dir->opts) != 0)
+	if (xlog_create_impl(xlog, filename, dir->open_wflags, &meta,
+			     &dir->opts, spare) != 0)
+		return -1;
+
+	/*
+	 * Write the dictionary before renaming the file so that
+	 * readers never see a file without it.
+	 */
+	if (dir->dictionary != NULL &&
+	    xlog_write_dictionary(xlog, dir->dictionary,
+				  dir->dictionary_size) != 0) {
+		xlog_discard(xlog);
 		return -1;
+	}
 
 	/* Rename xlog file */
 	if (dir->suffix != INPROGRESS && xlog_materialize(xlog) != 0) {
@@ -1016,6 +1320,13 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	return 0;
 }
 
+int
+xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
+		 const struct vclock *vclock)
+{
+	return xdir_create_xlog_from_spare(dir, xlog, vclock, NULL);
+}
+
 ssize_t
 xlog_fallocate(struct xlog *log, size_t len)
 {
@@ -1110,6 +1421,72 @@ xlog_tx_write_plain(struct xlog *log)
 	return obuf_size(&log->obuf);
 }
 
+struct xlog_dict_samples *
+xlog_dict_samples_new(void)
+{
+	struct xlog_dict_samples *samples = xmalloc(sizeof(*samples));
+	samples->data = xmalloc(XLOG_DICT_SAMPLES_SIZE_MAX);
+	samples->size = 0;
+	samples->count = 0;
+	return samples;
+}
+
+void
+xlog_dict_samples_delete(struct xlog_dict_samples *samples)
+{
+	free(samples->data);
+	free(samples);
+}
+
+/**
+ * Adds the rows buffered for writing to the sample set unless
+ * it's full. Large blocks are truncated, which is fine for
+ * dictionary training.
+ */
+static void
+xlog_dict_samples_add(struct xlog_dict_samples *samples, struct obuf *obuf)
+{
+	if (samples->count >= XLOG_DICT_SAMPLE_COUNT_MAX)
+		return;
+	size_t size = MIN(XLOG_DICT_SAMPLES_SIZE_MAX - samples->size,
+			  (size_t)XLOG_DICT_SAMPLE_SIZE_MAX);
+	char *data = samples->data + samples->size;
+	char *data_end = data + size;
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	for (struct iovec *iov = obuf->iov; iov->iov_len != 0 &&
+	     data < data_end; ++iov) {
+		size_t len = MIN(iov->iov_len - offset,
+				 (size_t)(data_end - data));
+		memcpy(data, (char *)iov->iov_base + offset, len);
+		data += len;
+		offset = 0;
+		if (iov == obuf->iov + obuf->pos)
+			break;
+	}
+	size = data - (samples->data + samples->size);
+	if (size == 0)
+		return;
+	samples->sizes[samples->count++] = size;
+	samples->size += size;
+}
+
+char *
+xlog_dict_train(const struct xlog_dict_samples *samples, size_t *size)
+{
+	char *dictionary = xmalloc(XLOG_DICT_SIZE_MAX);
+	size_t rc = ZDICT_trainFromBuffer(dictionary, XLOG_DICT_SIZE_MAX,
+					  samples->data, samples->sizes,
+					  samples->count);
+	if (ZDICT_isError(rc)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZDICT_getErrorName(rc));
+		free(dictionary);
+		return NULL;
+	}
+	*size = rc;
+	return dictionary;
+}
+
 /**
  * Write a compressed block of xrow objects.
  * @retval -1  error
@@ -1127,8 +1504,10 @@ xlog_tx_write_zstd(struct xlog *log)
 	}
 	uint32_t crc32c = 0;
 	struct iovec *iov;
-	/* 3 is compression level. */
-	ZSTD_compressBegin(log->zctx, 3);
+	if (log->zcdict != NULL)
+		ZSTD_compressBegin_usingCDict(log->zctx, log->zcdict);
+	else
+		ZSTD_compressBegin(log->zctx, XLOG_ZSTD_LEVEL);
 	size_t offset = XLOG_FIXHEADER_SIZE;
 	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
 		/* Estimate max output buffer size. */
@@ -1214,6 +1593,20 @@ xlog_tx_write_zstd(struct xlog *log)
 #define SYNC_ROUND_DOWN(size)	((size) & ~(4096 - 1))
 #define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
 
+/** Returns the write rate limit of an xlog, 0 if there's no limit. */
+static uint64_t
+xlog_rate_limit(const struct xlog *log)
+{
+	uint64_t rate_limit = log->opts.rate_limit;
+	if (log->opts.rate_limit_is_adaptive) {
+		uint64_t adaptive = pm_atomic_load_explicit(
+			&xlog_adaptive_rate_limit, pm_memory_order_relaxed);
+		if (adaptive > 0 && (rate_limit == 0 || adaptive < rate_limit))
+			rate_limit = adaptive;
+	}
+	return rate_limit;
+}
+
 /**
  * Writes xlog batch to file
  */
@@ -1224,8 +1617,17 @@ xlog_tx_write(struct xlog *log)
 		return 0;
 	ssize_t written;
 
+	if (log->dict_samples != NULL)
+		xlog_dict_samples_add(log->dict_samples, &log->obuf);
+	/*
+	 * With a dictionary even small blocks compress well,
+	 * because they have a lot in common with each other.
+	 */
+	size_t compress_threshold = log->zcdict != NULL ?
+				    XLOG_TX_DICT_COMPRESS_THRESHOLD :
+				    XLOG_TX_COMPRESS_THRESHOLD;
 	if (!log->opts.no_compression &&
-	    obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
+	    obuf_size(&log->obuf) >= compress_threshold) {
 		written = xlog_tx_write_zstd(log);
 	} else {
 		written = xlog_tx_write_plain(log);
@@ -1255,16 +1657,17 @@ xlog_tx_write(struct xlog *log)
 	log->offset += written;
 	log->rows += log->tx_rows;
 	log->tx_rows = 0;
+	uint64_t rate_limit = xlog_rate_limit(log);
 	if ((log->opts.sync_interval && log->offset >=
 	    (off_t)(log->synced_size + log->opts.sync_interval)) ||
-	    (log->opts.rate_limit && log->offset >=
-	    (off_t)(log->synced_size + log->opts.rate_limit))) {
+	    (rate_limit && log->offset >=
+	    (off_t)(log->synced_size + rate_limit))) {
 		off_t sync_from = SYNC_ROUND_DOWN(log->synced_size);
 		size_t sync_len = SYNC_ROUND_UP(log->offset) -
 				  sync_from;
-		if (log->opts.rate_limit > 0) {
+		if (rate_limit > 0) {
 			double throttle_time;
-			throttle_time = (double)sync_len / log->opts.rate_limit -
+			throttle_time = (double)sync_len / rate_limit -
 					(ev_monotonic_time() - log->sync_time);
 			if (throttle_time > 0)
 				ev_sleep(throttle_time);
@@ -1297,13 +1700,13 @@ xlog_tx_write(struct xlog *log)
 }
 
 /*
- * Add a row to a log and possibly flush the log.
+ * Add an encoded row to a log and possibly flush the log.
  *
  * @retval  -1 error, check diag.
  * @retval >=0 the number of bytes written to buffer.
  */
-ssize_t
-xlog_write_row(struct xlog *log, const struct xrow_header *packet)
+static ssize_t
+xlog_write_iov(struct xlog *log, const struct iovec *iov, int iovcnt)
 {
 	/*
 	 * Automatically reserve space for a fixheader when adding
@@ -1320,13 +1723,6 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 
 	struct obuf_svp svp = obuf_create_svp(&log->obuf);
 	size_t page_offset = obuf_size(&log->obuf);
-	/** encode row into iovec */
-	struct iovec iov[XROW_IOVMAX];
-	/** don't write sync to the disk */
-	size_t region_svp = region_used(&fiber()->gc);
-	int iovcnt;
-	xrow_header_encode(packet, /*sync=*/0, /*fixheader_len=*/0,
-			   iov, &iovcnt);
 	for (int i = 0; i < iovcnt; ++i) {
 		struct errinj *inj = errinj(ERRINJ_WAL_WRITE_PARTIAL,
 					    ERRINJ_INT);
@@ -1335,7 +1731,6 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 			diag_set(ClientError, ER_INJECTION,
 				 "xlog write injection");
 			obuf_rollback_to_svp(&log->obuf, &svp);
-			region_truncate(&fiber()->gc, region_svp);
 			return -1;
 		};
 		if (obuf_dup(&log->obuf, iov[i].iov_base, iov[i].iov_len) <
@@ -1343,12 +1738,9 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 			diag_set(OutOfMemory, XLOG_FIXHEADER_SIZE,
 				  "runtime arena", "xlog tx output buffer");
 			obuf_rollback_to_svp(&log->obuf, &svp);
-			region_truncate(&fiber()->gc, region_svp);
 			return -1;
 		}
 	}
-	region_truncate(&fiber()->gc, region_svp);
-	assert(iovcnt <= XROW_IOVMAX);
 	log->tx_rows++;
 
 	size_t row_size = obuf_size(&log->obuf) - page_offset;
@@ -1360,6 +1752,29 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 	return row_size;
 }
 
+ssize_t
+xlog_write_row(struct xlog *log, const struct xrow_header *packet)
+{
+	/** encode row into iovec */
+	struct iovec iov[XROW_IOVMAX];
+	/** don't write sync to the disk */
+	size_t region_svp = region_used(&fiber()->gc);
+	int iovcnt;
+	xrow_header_encode(packet, /*sync=*/0, /*fixheader_len=*/0,
+			   iov, &iovcnt);
+	assert(iovcnt <= XROW_IOVMAX);
+	ssize_t rc = xlog_write_iov(log, iov, iovcnt);
+	region_truncate(&fiber()->gc, region_svp);
+	return rc;
+}
+
+ssize_t
+xlog_write_encoded_row(struct xlog *log, const char *data, size_t len)
+{
+	struct iovec iov = {(void *)data, len};
+	return xlog_write_iov(log, &iov, 1);
+}
+
 /**
  * Begin a multi-statement xlog transaction. All xrow objects
  * of a single transaction share the same header and checksum
@@ -1413,6 +1828,48 @@ xlog_flush(struct xlog *log)
 	return xlog_tx_write(log);
 }
 
+int
+xlog_sync_data(struct xlog *log)
+{
+	ERROR_INJECT(ERRINJ_WAL_SYNC_DATA, {
+		diag_set(ClientError, ER_INJECTION, "xlog sync injection");
+		return -1;
+	});
+	if (fdatasync(log->fd) < 0) {
+		diag_set(SystemError, "failed to sync file '%s'",
+			 log->filename);
+		return -1;
+	}
+	log->synced_size = log->offset;
+	log->sync_time = ev_monotonic_time();
+	return 0;
+}
+
+int
+xlog_truncate(struct xlog *log, off_t offset)
+{
+	assert(offset <= log->offset);
+	/* Rows that haven't been written yet are discarded, too. */
+	xlog_tx_rollback(log);
+	if (lseek(log->fd, offset, SEEK_SET) < 0 ||
+	    ftruncate(log->fd, offset) != 0) {
+		diag_set(SystemError, "failed to truncate file '%s'",
+			 log->filename);
+		return -1;
+	}
+	log->offset = offset;
+	log->allocated = 0;
+	if (log->synced_size > offset)
+		log->synced_size = offset;
+	/*
+	 * The blocks written after the truncation point won't
+	 * match the index entries pointing past it.
+	 */
+	if (log->index_fd >= 0 && log->index_offset > offset)
+		xlog_index_drop(log);
+	return 0;
+}
+
 static int
 sync_cb(eio_req *req)
 {
@@ -1510,6 +1967,8 @@ void
 xlog_discard(struct xlog *l)
 {
 	if (l->fd >= 0) {
+		if (l->index_fd >= 0)
+			xlog_index_drop(l);
 		close(l->fd);
 		l->fd = -1;
 		xlog_free(l);
@@ -1533,6 +1992,23 @@ enum {
 	XLOG_READ_AHEAD_MAX = 8 * 1024 * 1024,
 };
 
+/**
+ * Ask the kernel to start reading the next chunk of the file while
+ * we are busy decompressing and decoding the data we've already read
+ * so that the next pread() doesn't have to wait for the disk.
+ */
+static inline void
+xlog_cursor_read_ahead(struct xlog_cursor *cursor)
+{
+#ifdef HAVE_POSIX_FADVISE
+	if (posix_fadvise(cursor->fd, cursor->read_offset,
+			  cursor->read_ahead, POSIX_FADV_WILLNEED) != 0)
+		say_syserror("posix_fadvise, fd=%i", cursor->fd);
+#else
+	(void)cursor;
+#endif /* HAVE_POSIX_FADVISE */
+}
+
 /**
  * Ensure that at least count bytes are in read buffer
  *
@@ -1592,6 +2068,9 @@ xlog_cursor_ensure(struct xlog_cursor *cursor, size_t count)
 		cursor->read_ahead = XLOG_READ_AHEAD_MIN;
 	}
 	cursor->read_offset += readen;
+	/* There's nothing to prefetch if we've reached the end. */
+	if (!cursor->need_rbuf_shrink)
+		xlog_cursor_read_ahead(cursor);
 	return ibuf_used(&cursor->rbuf) >= count ? 0: 1;
 }
 
@@ -1755,7 +2234,8 @@ xlog_tx_decode(const char *data, const char *data_end,
 
 	/* Decompress zstd rows */
 	assert(fixheader.magic == zrow_marker);
-	ZSTD_initDStream(zdctx);
+	/* Keep the dictionary referenced by the context, if any. */
+	ZSTD_DCtx_reset(zdctx, ZSTD_reset_session_only);
 	int rc = xlog_cursor_decompress(&rows, rows_end, &data, data_end,
 					zdctx);
 	if (rc < 0) {
@@ -1803,14 +2283,12 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 	}
 	data_end = rpos + fixheader.len;
 
-	ibuf_create(&tx_cursor->rows, &cord()->slabc,
-		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	ibuf_reset(&tx_cursor->rows);
 	if (fixheader.magic == row_marker) {
 		void *dst = ibuf_alloc(&tx_cursor->rows, fixheader.len);
 		if (dst == NULL) {
 			diag_set(OutOfMemory, fixheader.len,
 				 "runtime", "xlog rows buffer");
-			ibuf_destroy(&tx_cursor->rows);
 			return -1;
 		}
 		memcpy(dst, rpos, fixheader.len);
@@ -1821,21 +2299,23 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 	};
 
 	assert(fixheader.magic == zrow_marker);
-	ZSTD_initDStream(zdctx);
+	/* Keep the dictionary referenced by the cursor, if any. */
+	ZSTD_DCtx_reset(zdctx, ZSTD_reset_session_only);
 	int rc;
 	do {
 		if (ibuf_reserve(&tx_cursor->rows,
 				 XLOG_TX_AUTOCOMMIT_THRESHOLD) == NULL) {
 			diag_set(OutOfMemory, XLOG_TX_AUTOCOMMIT_THRESHOLD,
 				  "runtime", "xlog output buffer");
-			ibuf_destroy(&tx_cursor->rows);
 			return -1;
 		}
 	} while ((rc = xlog_cursor_decompress(&tx_cursor->rows.wpos,
 					      tx_cursor->rows.end, &rpos,
 					      data_end, zdctx)) == 1);
-	if (rc != 0)
+	if (rc != 0) {
+		ibuf_reset(&tx_cursor->rows);
 		return -1;
+	}
 
 	*data = rpos;
 	assert(*data <= data_end);
@@ -1878,7 +2358,7 @@ int
 xlog_tx_cursor_destroy(struct xlog_tx_cursor *tx_cursor)
 {
 	assert(tx_cursor->rows.slabc == &cord()->slabc);
-	ibuf_destroy(&tx_cursor->rows);
+	ibuf_reset(&tx_cursor->rows);
 	return 0;
 }
 
@@ -2017,6 +2497,155 @@ xlog_cursor_next(struct xlog_cursor *cursor,
 	return 0;
 }
 
+/**
+ * Loads the zstd dictionary stored in the first tx block of the
+ * file opened by a cursor, see xlog_write_dictionary().
+ */
+static int
+xlog_cursor_load_dictionary(struct xlog_cursor *i)
+{
+	assert(i->state == XLOG_CURSOR_ACTIVE);
+	assert(i->zddict == NULL);
+	struct xrow_header row;
+	int rc = xlog_cursor_next_tx(i);
+	if (rc == 0)
+		rc = xlog_cursor_next_row(i, &row);
+	if (rc < 0)
+		return -1;
+	if (rc > 0 || row.type != XLOG_DICTIONARY || row.bodycnt != 1)
+		goto error;
+	const char *data = row.body[0].iov_base;
+	const char *data_end = data + row.body[0].iov_len;
+	if (mp_check_exact(&data, data_end) != 0)
+		goto error;
+	data = row.body[0].iov_base;
+	if (mp_typeof(*data) != MP_MAP || mp_decode_map(&data) != 1 ||
+	    mp_typeof(*data) != MP_UINT ||
+	    mp_decode_uint(&data) != IPROTO_DATA ||
+	    mp_typeof(*data) != MP_BIN)
+		goto error;
+	uint32_t size;
+	const char *dictionary = mp_decode_bin(&data, &size);
+	if (ZDICT_getDictID(dictionary, size) != i->meta.dictionary_id)
+		goto error;
+	i->zddict = ZSTD_createDDict(dictionary, size);
+	if (i->zddict == NULL) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "failed to create dictionary");
+		return -1;
+	}
+	size_t zrc = ZSTD_DCtx_refDDict(i->zdctx, i->zddict);
+	if (ZSTD_isError(zrc)) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 ZSTD_getErrorName(zrc));
+		return -1;
+	}
+	return 0;
+error:
+	diag_set(XlogError, "%s: failed to read compression dictionary",
+		 i->name);
+	return -1;
+}
+
+enum {
+	/** Max size of a sparse tx block index we are ready to read. */
+	XLOG_INDEX_SIZE_MAX = 4 * 1024 * 1024,
+};
+
+/**
+ * Reads the sparse tx block index of the xlog file opened by
+ * a cursor and returns the offset of the last indexed block
+ * preceded only by rows with vclock less than or equal to
+ * @vclock, or 0 if there's no such block. Stops at the first
+ * malformed entry, which may be incomplete if the index is
+ * being written concurrently.
+ */
+static off_t
+xlog_cursor_find_index_offset(struct xlog_cursor *i,
+			      const struct vclock *vclock)
+{
+	const char *path = xlog_index_filename(i->name);
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return 0;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0 ||
+	    st.st_size > XLOG_INDEX_SIZE_MAX) {
+		close(fd);
+		return 0;
+	}
+	off_t offset = 0;
+	struct vclock entry_vclock;
+	char *buf = xmalloc(st.st_size + 1);
+	char *line = buf;
+	char *eol;
+	ssize_t size = fio_pread(fd, buf, st.st_size, 0);
+	close(fd);
+	if (size <= 0)
+		goto out;
+	buf[size] = '\0';
+	eol = strchr(line, '\n');
+	if (eol == NULL || strncmp(line, "VClock: ", 8) != 0)
+		goto out;
+	*eol = '\0';
+	vclock_create(&entry_vclock);
+	if (vclock_from_string(&entry_vclock, line + 8) != 0 ||
+	    vclock_compare(&entry_vclock, &i->meta.vclock) != 0) {
+		say_warn("xlog index '%s' doesn't match the file", path);
+		goto out;
+	}
+	for (line = eol + 1; (eol = strchr(line, '\n')) != NULL;
+	     line = eol + 1) {
+		*eol = '\0';
+		char *end;
+		errno = 0;
+		long long entry_offset = strtoll(line, &end, 10);
+		if (errno != 0 || end == line || *end != ' ' ||
+		    entry_offset <= offset)
+			break;
+		vclock_create(&entry_vclock);
+		if (vclock_from_string(&entry_vclock, end + 1) != 0)
+			break;
+		/* Entries are sorted so the rest can't match either. */
+		if (vclock_compare(&entry_vclock, vclock) > 0)
+			break;
+		offset = entry_offset;
+	}
+out:
+	free(buf);
+	return offset;
+}
+
+void
+xlog_cursor_seek_index(struct xlog_cursor *i, const struct vclock *vclock)
+{
+	assert(i->state == XLOG_CURSOR_ACTIVE);
+	if (i->fd < 0)
+		return;
+	off_t offset = xlog_cursor_find_index_offset(i, vclock);
+	if (offset <= xlog_cursor_pos(i))
+		return;
+	/*
+	 * The block may be still being written or the index may
+	 * be stale so check that there's a tx block at the offset.
+	 * The block itself is verified by the checksum on read.
+	 */
+	char magic[sizeof(log_magic_t)];
+	if (fio_pread(i->fd, magic, sizeof(magic), offset) != sizeof(magic) ||
+	    (load_u32(magic) != row_marker && load_u32(magic) != zrow_marker))
+		return;
+	say_verbose("%s: skipping %lld bytes using the index", i->name,
+		    (long long)(offset - xlog_cursor_pos(i)));
+	ibuf_reset(&i->rbuf);
+	i->read_offset = offset;
+	i->read_ahead = XLOG_READ_AHEAD_MIN;
+	/*
+	 * Sequential read-ahead is tied to the previous position,
+	 * so prefetch the data we've jumped to explicitly.
+	 */
+	xlog_cursor_read_ahead(i);
+}
+
 int
 xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 {
@@ -2025,6 +2654,13 @@ xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 	i->read_ahead = XLOG_READ_AHEAD_MIN;
 	ibuf_create(&i->rbuf, &cord()->slabc,
 		    XLOG_TX_AUTOCOMMIT_THRESHOLD << 1);
+	ibuf_create(&i->tx_cursor.rows, &cord()->slabc,
+		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
+#ifdef HAVE_POSIX_FADVISE
+	/* The file is read sequentially, let the kernel know. */
+	if (posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL) != 0)
+		say_syserror("posix_fadvise, fd=%i", fd);
+#endif /* HAVE_POSIX_FADVISE */
 
 	ssize_t rc;
 	/*
@@ -2051,8 +2687,16 @@ xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 		goto error;
 	}
 	i->state = XLOG_CURSOR_ACTIVE;
+	if (i->meta.dictionary_id != 0 &&
+	    xlog_cursor_load_dictionary(i) != 0)
+		goto error_dictionary;
 	return 0;
+error_dictionary:
+	ZSTD_freeDStream(i->zdctx);
+	ZSTD_freeDDict(i->zddict);
+	i->state = XLOG_CURSOR_NEW;
 error:
+	ibuf_destroy(&i->tx_cursor.rows);
 	ibuf_destroy(&i->rbuf);
 	return -1;
 }
@@ -2081,6 +2725,8 @@ xlog_cursor_openmem(struct xlog_cursor *i, const char *data, size_t size,
 	i->fd = -1;
 	ibuf_create(&i->rbuf, &cord()->slabc,
 		    XLOG_TX_AUTOCOMMIT_THRESHOLD << 1);
+	ibuf_create(&i->tx_cursor.rows, &cord()->slabc,
+		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
 
 	void *dst = ibuf_alloc(&i->rbuf, size);
 	if (dst == NULL) {
@@ -2108,8 +2754,16 @@ xlog_cursor_openmem(struct xlog_cursor *i, const char *data, size_t size,
 		goto error;
 	}
 	i->state = XLOG_CURSOR_ACTIVE;
+	if (i->meta.dictionary_id != 0 &&
+	    xlog_cursor_load_dictionary(i) != 0)
+		goto error_dictionary;
 	return 0;
+error_dictionary:
+	ZSTD_freeDStream(i->zdctx);
+	ZSTD_freeDDict(i->zddict);
+	i->state = XLOG_CURSOR_NEW;
 error:
+	ibuf_destroy(&i->tx_cursor.rows);
 	ibuf_destroy(&i->rbuf);
 	return -1;
 }
@@ -2122,9 +2776,11 @@ xlog_cursor_close(struct xlog_cursor *i, bool reuse_fd)
 		close(i->fd);
 	assert(i->rbuf.slabc == &cord()->slabc);
 	ibuf_destroy(&i->rbuf);
-	if (i->state == XLOG_CURSOR_TX)
-		xlog_tx_cursor_destroy(&i->tx_cursor);
+	assert(i->tx_cursor.rows.slabc == &cord()->slabc);
+	ibuf_destroy(&i->tx_cursor.rows);
 	ZSTD_freeDStream(i->zdctx);
+	ZSTD_freeDDict(i->zddict);
+	i->zddict = NULL;
 	i->state = (i->state == XLOG_CURSOR_EOF ?
 		    XLOG_CURSOR_EOF_CLOSED : XLOG_CURSOR_CLOSED);
 	/*
@@ -2216,6 +2872,7 @@ xlog_remove_file_async(const char *filename, unsigned flags)
 	assert(grp_alloc_size(&all) == 0);
 	coio_task_create(&task->base, xlog_remove_file_cb,
 			 xlog_remove_file_done_cb);
+	coio_task_set_pri(&task->base, COIO_PRI_META);
 	coio_task_post(&task->base);
 	return true;
 }
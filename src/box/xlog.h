@@ -56,6 +56,14 @@ extern "C" {
 struct xlog_opts {
 	/** Write rate limit, in bytes per second. */
 	uint64_t rate_limit;
+	/**
+	 * If this flag is set, the write rate is also limited by
+	 * xlog_adaptive_rate_limit.
+	 *
+	 * This option is useful for memtx snapshots and vinyl run
+	 * files, which compete with WAL writes for disk bandwidth.
+	 */
+	bool rate_limit_is_adaptive;
 	/** Sync interval, in bytes. */
 	uint64_t sync_interval;
 	/**
@@ -86,6 +94,15 @@ struct xlog_opts {
 
 extern const struct xlog_opts xlog_opts_default;
 
+/**
+ * Write rate limit, in bytes per second, applied to xlog files
+ * with xlog_opts::rate_limit_is_adaptive set. Zero means no limit.
+ * It's adjusted by the WAL thread to keep the WAL write latency
+ * below the target and read by writers running in other threads,
+ * so it must be accessed with atomic operations.
+ */
+extern uint64_t xlog_adaptive_rate_limit;
+
 /* {{{ log dir */
 
 /**
@@ -111,6 +128,12 @@ enum log_suffix { NONE, INPROGRESS };
  */
 #define inprogress_suffix ".inprogress"
 
+/**
+ * Suffix added to path of xlog files to get the name of
+ * the sidecar file storing the sparse tx block index.
+ */
+#define xlog_index_suffix ".index"
+
 /**
  * A handle for a data directory with write ahead logs, snapshots,
  * vylogs.
@@ -165,6 +188,13 @@ struct xdir {
 	char dirname[PATH_MAX];
 	/** Snapshots or xlogs */
 	enum xdir_type type;
+	/**
+	 * Zstd compression dictionary used for new files or NULL,
+	 * see xdir_set_dictionary().
+	 */
+	char *dictionary;
+	/** Size of the compression dictionary. */
+	size_t dictionary_size;
 };
 
 /**
@@ -180,6 +210,19 @@ xdir_create(struct xdir *dir, const char *dirname, enum xdir_type type,
 void
 xdir_destroy(struct xdir *dir);
 
+/**
+ * Set the zstd dictionary used for compressing new files
+ * created in the directory. The directory takes ownership of
+ * the dictionary, which must be allocated with malloc(). Pass
+ * NULL to stop using a dictionary.
+ *
+ * The dictionary is stored in each file so that the file can
+ * be read without it. Files compressed with a dictionary can't
+ * be read by Tarantool versions that don't support it.
+ */
+void
+xdir_set_dictionary(struct xdir *dir, char *dictionary, size_t size);
+
 /**
  * Scan or re-scan a directory and update directory
  * index with all log files (or snapshots) in the directory.
@@ -331,6 +374,12 @@ struct xlog_meta {
 	 * directory for missing WALs.
 	 */
 	struct vclock prev_vclock;
+	/**
+	 * Text file header: id of the zstd dictionary used for
+	 * compressing tx blocks or 0. The dictionary itself is
+	 * stored in the first tx block of the file.
+	 */
+	uint32_t dictionary_id;
 };
 
 /**
@@ -413,8 +462,73 @@ struct xlog {
 	uint64_t synced_size;
 	/** Time when xlog wast synced last time */
 	double sync_time;
+	/**
+	 * Sparse tx block index file handle, -1 if the index
+	 * isn't maintained for this file.
+	 */
+	int index_fd;
+	/** Offset of the last block added to the index. */
+	off_t index_offset;
+	/**
+	 * Zstd dictionary used for compression or NULL, see
+	 * xlog_write_dictionary().
+	 */
+	ZSTD_CDict *zcdict;
+	/**
+	 * If set, samples of written tx blocks are collected here
+	 * for training a compression dictionary.
+	 */
+	struct xlog_dict_samples *dict_samples;
+};
+
+enum {
+	/** Max number of samples for dictionary training. */
+	XLOG_DICT_SAMPLE_COUNT_MAX = 8192,
+	/** Max size of a sample for dictionary training. */
+	XLOG_DICT_SAMPLE_SIZE_MAX = 16 * 1024,
+	/** Max total size of samples for dictionary training. */
+	XLOG_DICT_SAMPLES_SIZE_MAX = 1024 * 1024,
+	/** Max size of a trained dictionary. */
+	XLOG_DICT_SIZE_MAX = 32 * 1024,
 };
 
+/** Samples of xlog tx blocks for training a compression dictionary. */
+struct xlog_dict_samples {
+	/** Concatenated samples. */
+	char *data;
+	/** Total size of the samples. */
+	size_t size;
+	/** Number of the samples. */
+	unsigned count;
+	/** Sizes of the samples. */
+	size_t sizes[XLOG_DICT_SAMPLE_COUNT_MAX];
+};
+
+/** Allocate an empty sample set. Never fails. */
+struct xlog_dict_samples *
+xlog_dict_samples_new(void);
+
+/** Free a sample set. */
+void
+xlog_dict_samples_delete(struct xlog_dict_samples *samples);
+
+/** Return true if there are enough samples to train a dictionary. */
+static inline bool
+xlog_dict_samples_are_enough(const struct xlog_dict_samples *samples)
+{
+	return samples->size >= XLOG_DICT_SAMPLES_SIZE_MAX / 4;
+}
+
+/**
+ * Train a zstd dictionary. This function may take a while so
+ * it's supposed to be called from a coio thread. On success,
+ * returns a dictionary allocated with malloc().
+ *
+ * @retval NULL if error, check diag
+ */
+char *
+xlog_dict_train(const struct xlog_dict_samples *samples, size_t *size);
+
 /**
  * Touch xdir snapshot file.
  *
@@ -446,6 +560,61 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * A preallocated empty file that can be turned into a new xlog
+ * file so that the xlog writer doesn't have to wait for the file
+ * creation and disk space allocation.
+ */
+struct xlog_spare {
+	/** File handle, -1 if there's no spare file. */
+	int fd;
+	/** Size of disk space preallocated for the file. */
+	size_t allocated;
+	/** File name. */
+	char filename[PATH_MAX];
+};
+
+static inline void
+xlog_spare_clear(struct xlog_spare *spare)
+{
+	spare->fd = -1;
+	spare->allocated = 0;
+}
+
+/**
+ * Returns the name of the spare file of an xlog directory.
+ * The name has the .inprogress suffix so the file is ignored
+ * by readers and removed along with other temporary files.
+ */
+const char *
+xdir_spare_filename(struct xdir *dir);
+
+/**
+ * Create a spare file and preallocate @a len bytes of disk space
+ * for it. This function may block so it's supposed to be called
+ * from a coio thread.
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+xlog_spare_create(struct xlog_spare *spare, const char *filename,
+		  int flags, size_t len);
+
+/** Close and remove a spare file, if any. */
+void
+xlog_spare_destroy(struct xlog_spare *spare);
+
+/**
+ * Same as xdir_create_xlog(), but use the given spare file for
+ * the new xlog if it's ready. If the spare file can't be used,
+ * it is destroyed and a new file is created as usual.
+ */
+int
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock,
+			    struct xlog_spare *spare);
+
 /**
  * Create new xlog writer based on fd.
  * @param fd            file descriptor
@@ -512,6 +681,17 @@ xlog_fallocate(struct xlog *log, size_t size);
 ssize_t
 xlog_write_row(struct xlog *log, const struct xrow_header *packet);
 
+/**
+ * Write a row encoded with xrow_header_encode() without sync to
+ * xlog. Used by the WAL writer, which keeps encoded rows in memory
+ * for relays.
+ *
+ * @retval count of writen bytes
+ * @retval -1 for error
+ */
+ssize_t
+xlog_write_encoded_row(struct xlog *log, const char *data, size_t len);
+
 /**
  * Prevent xlog row buffer offloading, should be use
  * at transaction start to write transaction in one xlog tx
@@ -541,6 +721,39 @@ xlog_tx_rollback(struct xlog *log);
 ssize_t
 xlog_flush(struct xlog *log);
 
+/**
+ * Flush the data written to the xlog file so far to the storage
+ * device with fdatasync().
+ *
+ * Returns 0 on success. On failure, sets diag and returns -1.
+ */
+int
+xlog_sync_data(struct xlog *log);
+
+/**
+ * Discard all data written to the xlog file after @offset, which
+ * must not exceed the current write position, along with rows
+ * buffered but not written yet.
+ *
+ * Returns 0 on success. On failure, sets diag and returns -1.
+ */
+int
+xlog_truncate(struct xlog *log, off_t offset);
+
+/**
+ * Add the current write position to the sparse tx block index
+ * if index_step bytes have been written since the last indexed
+ * block. Must be called before writing a new tx with @vclock
+ * set to the vclock of all rows written to the file so far.
+ * Does nothing if the row buffer isn't empty, because then
+ * the next row doesn't start a new block.
+ *
+ * An index write error isn't fatal: it is logged and the index
+ * is dropped so that readers fall back on a sequential scan.
+ */
+void
+xlog_index_add(struct xlog *log, const struct vclock *vclock);
+
 /**
  * Closes an xlog object.
  *
@@ -607,7 +820,10 @@ xlog_discard(struct xlog *l);
  */
 struct xlog_tx_cursor
 {
-	/** rows buffer */
+	/**
+	 * rows buffer, must be created by the caller; it is reused
+	 * by all transactions read with the cursor
+	 */
 	struct ibuf rows;
 	/** tx size */
 	size_t size;
@@ -627,8 +843,8 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *cursor,
 		      ZSTD_DStream *zdctx);
 
 /**
- * Destroy xlog tx cursor and free all associated memory
- * including parsed xrows
+ * Destroy xlog tx cursor and discard all parsed xrows.
+ * The rows buffer memory is kept for the next transaction.
  */
 int
 xlog_tx_cursor_destroy(struct xlog_tx_cursor *tx_cursor);
@@ -732,6 +948,8 @@ struct xlog_cursor {
 	struct xlog_tx_cursor tx_cursor;
 	/** ZSTD context for decompression */
 	ZSTD_DStream *zdctx;
+	/** ZSTD dictionary for decompression or NULL */
+	ZSTD_DDict *zddict;
 };
 
 /**
@@ -858,6 +1076,16 @@ xlog_cursor_next(struct xlog_cursor *cursor,
 int
 xlog_cursor_find_tx_magic(struct xlog_cursor *i);
 
+/**
+ * Skip tx blocks that contain only rows with vclock less than
+ * or equal to @vclock using the sparse tx block index written
+ * along with the file, see xlog_opts::index_step. Must be called
+ * right after the cursor is opened. Does nothing if there's no
+ * index or it doesn't match the file.
+ */
+void
+xlog_cursor_seek_index(struct xlog_cursor *i, const struct vclock *vclock);
+
 /**
  * Cursor xlog position
  *
@@ -1791,6 +1791,53 @@ xrow_decode_begin(const struct xrow_header *row, struct begin_request *request)
 	return -1;
 }
 
+int
+xrow_decode_wait_vclock(const struct xrow_header *row, struct vclock *vclock,
+			double *timeout)
+{
+	if (row->header == NULL)
+		return 0;
+	int rc = 0;
+	const char *d = row->header;
+	uint32_t map_size = mp_decode_map(&d);
+	for (uint32_t i = 0; i < map_size; ++i) {
+		/* Key types are checked by xrow_header_decode(). */
+		uint64_t key = mp_decode_uint(&d);
+		switch (key) {
+		case IPROTO_WAIT_VCLOCK: {
+			rc = 1;
+			vclock_create(vclock);
+			uint32_t size = mp_decode_map(&d);
+			for (uint32_t j = 0; j < size; j++) {
+				if (mp_typeof(*d) != MP_UINT)
+					goto bad_msgpack;
+				uint64_t id = mp_decode_uint(&d);
+				if (id >= VCLOCK_MAX || mp_typeof(*d) != MP_UINT)
+					goto bad_msgpack;
+				uint64_t lsn = mp_decode_uint(&d);
+				if (lsn > INT64_MAX)
+					goto bad_msgpack;
+				/* vclock[0] is local to every instance. */
+				if (id != 0)
+					vclock_reset(vclock, id, lsn);
+			}
+			break;
+		}
+		case IPROTO_TIMEOUT:
+			*timeout = mp_decode_double(&d);
+			break;
+		default:
+			mp_next(&d);
+			break;
+		}
+	}
+	return rc;
+
+bad_msgpack:
+	xrow_on_decode_err(row, ER_INVALID_MSGPACK, "packet header");
+	return -1;
+}
+
 void
 xrow_encode_vote(struct xrow_header *row)
 {
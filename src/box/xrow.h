@@ -1013,6 +1013,22 @@ struct begin_request {
 int
 xrow_decode_begin(const struct xrow_header *row, struct begin_request *request);
 
+/**
+ * Decode IPROTO_WAIT_VCLOCK and IPROTO_TIMEOUT from the header of
+ * a request. @a timeout is left untouched if the header doesn't
+ * have IPROTO_TIMEOUT.
+ * @param row Decoded request header.
+ * @param[out] vclock Vclock the request must wait for.
+ * @param[out] timeout Timeout of the wait.
+ *
+ * @retval  1 The header has IPROTO_WAIT_VCLOCK.
+ * @retval  0 The header doesn't have IPROTO_WAIT_VCLOCK.
+ * @retval -1 Format error.
+ */
+int
+xrow_decode_wait_vclock(const struct xrow_header *row, struct vclock *vclock,
+			double *timeout);
+
 /**
  * Update vclock with the next LSN value for given replica id.
  * The function will cause panic if the next LSN happens to be
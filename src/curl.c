@@ -41,8 +41,9 @@
  * Process events
  */
 static void
-curl_multi_process(CURLM *multi, curl_socket_t sockfd, int events)
+curl_multi_process(struct curl_env *env, curl_socket_t sockfd, int events)
 {
+	CURLM *multi = env->multi;
 	/*
 	 * Notify curl about events
 	 */
@@ -84,6 +85,12 @@ curl_multi_process(CURLM *multi, curl_socket_t sockfd, int events)
 		curl_easy_getinfo(easy, CURLINFO_PRIVATE, (void *) &request);
 		request->code = (int) code;
 		request->in_progress = false;
+		long num_connects = 0;
+		curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &num_connects);
+		if (num_connects > 0)
+			env->stat.connections_created += num_connects;
+		else if (code == CURLE_OK)
+			env->stat.connections_reused++;
 #ifndef NDEBUG
 		struct errinj *errinj = errinj(ERRINJ_HTTP_RESPONSE_ADD_WAIT,
 					       ERRINJ_BOOL);
@@ -108,7 +115,7 @@ curl_timer_cb(struct ev_loop *loop, struct ev_timer *watcher, int revents)
 	struct curl_env *env = (struct curl_env *) watcher->data;
 
 	say_debug("curl %p: event timer", env);
-	curl_multi_process(env->multi, CURL_SOCKET_TIMEOUT, 0);
+	curl_multi_process(env, CURL_SOCKET_TIMEOUT, 0);
 }
 
 /**
@@ -165,7 +172,7 @@ curl_sock_cb(struct ev_loop *loop, struct ev_io *watcher, int revents)
 	say_debug("curl %p: event fd=%d %s", env, fd, evstr[revents]);
 	const int action = ((revents & EV_READ  ? CURL_POLL_IN  : 0) |
 			    (revents & EV_WRITE ? CURL_POLL_OUT : 0));
-	curl_multi_process(env->multi, fd, action);
+	curl_multi_process(env, fd, action);
 }
 
 /**
@@ -221,8 +228,46 @@ curl_multi_sock_cb(CURL *easy, curl_socket_t fd, int what, void *envp,
 }
 
 
+/**
+ * Share handle with the DNS cache and the TLS session cache used by
+ * all environments, see curl_env_create(). All of them live in the
+ * tx thread so no locking callbacks are needed.
+ */
+static CURLSH *curl_share;
+/** Number of environments using curl_share. */
+static int curl_share_refs;
+
+/** Reference curl_share, creating it if needed. */
+static int
+curl_share_ref(void)
+{
+	if (curl_share_refs++ > 0)
+		return 0;
+	curl_share = curl_share_init();
+	if (curl_share == NULL) {
+		curl_share_refs = 0;
+		diag_set(OutOfMemory, 0, "curl", "share");
+		return -1;
+	}
+	curl_share_setopt(curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(curl_share, CURLSHOPT_SHARE,
+			  CURL_LOCK_DATA_SSL_SESSION);
+	return 0;
+}
+
+static void
+curl_share_unref(void)
+{
+	assert(curl_share_refs > 0);
+	if (--curl_share_refs > 0)
+		return;
+	curl_share_cleanup(curl_share);
+	curl_share = NULL;
+}
+
 int
-curl_env_create(struct curl_env *env, long max_conns, long max_total_conns)
+curl_env_create(struct curl_env *env, long max_conns, long max_total_conns,
+		long max_host_conns)
 {
 	memset(env, 0, sizeof(*env));
 	mempool_create(&env->sock_pool, &cord()->slabc,
@@ -247,9 +292,19 @@ curl_env_create(struct curl_env *env, long max_conns, long max_total_conns)
 	curl_multi_setopt(env->multi, CURLMOPT_MAXCONNECTS, max_conns);
 #if LIBCURL_VERSION_NUM >= 0x071e00
 	curl_multi_setopt(env->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, max_total_conns);
+	curl_multi_setopt(env->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+			  max_host_conns);
 #else
 	(void) max_total_conns;
+	(void) max_host_conns;
 #endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/* Multiplex HTTP/2 requests to the same host. */
+	curl_multi_setopt(env->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+	if (curl_share_ref() != 0)
+		goto error_exit;
+	env->is_share_referenced = true;
 
 	return 0;
 
@@ -264,6 +319,8 @@ curl_env_destroy(struct curl_env *env)
 	assert(env);
 	if (env->multi != NULL)
 		curl_multi_cleanup(env->multi);
+	if (env->is_share_referenced)
+		curl_share_unref();
 
 	mempool_destroy(&env->sock_pool);
 }
@@ -316,6 +373,14 @@ curl_request_start(struct curl_request *curl_request, struct curl_env *env)
 {
 	CURLMcode mcode;
 	curl_request->in_progress = true;
+	curl_easy_setopt(curl_request->easy, CURLOPT_SHARE, curl_share);
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/*
+	 * Wait for a connection which may be multiplexed instead of
+	 * opening a new one while another request is connecting.
+	 */
+	curl_easy_setopt(curl_request->easy, CURLOPT_PIPEWAIT, 1L);
+#endif
 	mcode = curl_multi_add_handle(env->multi, curl_request->easy);
 	curl_diag_set_merror(mcode);
 
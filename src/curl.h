@@ -46,6 +46,10 @@ struct curl_stat {
 	uint64_t sockets_added;
 	uint64_t sockets_deleted;
 	uint64_t active_requests;
+	/** Number of connections established by requests. */
+	uint64_t connections_created;
+	/** Number of requests served by a cached connection. */
+	uint64_t connections_reused;
 };
 
 /**
@@ -60,6 +64,8 @@ struct curl_env {
 	struct ev_timer timer_event;
 	/** Statistics. */
 	struct curl_stat stat;
+	/** Set if the environment references the shared caches. */
+	bool is_share_referenced;
 };
 
 /**
@@ -96,13 +102,23 @@ struct curl_request {
 
 /**
  * @brief Create a new CURL environment
+ *
+ * The DNS cache and the TLS session cache are shared by all
+ * environments so that a new connection to a known host needs
+ * neither a name lookup nor a full TLS handshake. HTTP/2 requests
+ * to the same host are multiplexed over one connection.
+ *
  * @param env pointer to a structure to initialize
  * @param max_conn The maximum number of entries in connection cache
+ * @param max_total_conns The maximum number of active connections
+ * @param max_host_conns The maximum number of active connections
+ *        to a single host
  * @retval 0 on success
  * @retval -1 on error, check diag
  */
 int
-curl_env_create(struct curl_env *env, long max_conns, long max_total_conns);
+curl_env_create(struct curl_env *env, long max_conns, long max_total_conns,
+		long max_host_conns);
 
 /**
  * Destroy HTTP client environment
@@ -131,13 +131,15 @@ curl_easy_header_cb(char *buffer, size_t size, size_t nitems, void *ctx)
 }
 
 int
-httpc_env_create(struct httpc_env *env, int max_conns, int max_total_conns)
+httpc_env_create(struct httpc_env *env, int max_conns, int max_total_conns,
+		 int max_host_conns)
 {
 	memset(env, 0, sizeof(*env));
 	mempool_create(&env->req_pool, &cord()->slabc,
 			sizeof(struct httpc_request));
 
-	return curl_env_create(&env->curl_env, max_conns, max_total_conns);
+	return curl_env_create(&env->curl_env, max_conns, max_total_conns,
+			       max_host_conns);
 }
 
 void
@@ -205,6 +207,18 @@ httpc_request_new(struct httpc_env *env, const char *method,
 			 curl_easy_header_cb);
 	curl_easy_setopt(req->curl_request.easy, CURLOPT_NOPROGRESS, 1L);
 	curl_easy_setopt(req->curl_request.easy, CURLOPT_NOSIGNAL, 1L);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+	/*
+	 * Negotiate HTTP/2 over TLS if libcurl supports it, so
+	 * that requests to the same host share one connection.
+	 * It's the default since libcurl 7.62.0.
+	 */
+	if ((curl_version_info(CURLVERSION_NOW)->features &
+	     CURL_VERSION_HTTP2) != 0) {
+		curl_easy_setopt(req->curl_request.easy, CURLOPT_HTTP_VERSION,
+				 (long)CURL_HTTP_VERSION_2TLS);
+	}
+#endif
 
 	ibuf_create(&req->send, &cord()->slabc, 1);
 
@@ -72,11 +72,15 @@ struct httpc_env {
  * @brief Creates  new HTTP client environment
  * @param env pointer to a structure to initialize
  * @param max_conn The maximum number of entries in connection cache
+ * @param max_total_conns The maximum number of active connections
+ * @param max_host_conns The maximum number of active connections
+ *        to a single host
  * @retval 0 on success
  * @retval -1 on error, check diag
  */
 int
-httpc_env_create(struct httpc_env *ctx, int max_conns, int max_total_conns);
+httpc_env_create(struct httpc_env *ctx, int max_conns, int max_total_conns,
+		 int max_host_conns);
 
 /**
  * Destroy HTTP client environment
@@ -376,6 +376,7 @@ tt_bitset_iterator_first_page(struct tt_bitset_iterator *it)
 
 	/* Rewind all conjunctions to first positions */
 	for (size_t c = 0; c < it->size; c++) {
+		it->conjs[c].page_first_pos = 0;
 		tt_bitset_iterator_conj_rewind(&it->conjs[c], 0);
 	}
 
@@ -432,3 +433,17 @@ tt_bitset_iterator_next(struct tt_bitset_iterator *it)
 		tt_bitset_iterator_next_page(it);
 	}
 }
+
+size_t
+tt_bitset_iterator_count(struct tt_bitset_iterator *it)
+{
+	assert(it != NULL);
+
+	size_t result = 0;
+	for (tt_bitset_iterator_first_page(it);
+	     it->page->first_pos != SIZE_MAX;
+	     tt_bitset_iterator_next_page(it)) {
+		result += tt_bitset_page_count(it->page);
+	}
+	return result;
+}
@@ -136,6 +136,21 @@ tt_bitset_iterator_rewind(struct tt_bitset_iterator *it);
 size_t
 tt_bitset_iterator_next(struct tt_bitset_iterator *it);
 
+/**
+ * @brief Count positions where the expression evaluates to true.
+ *
+ * The result is evaluated page by page and the bits of each page are
+ * counted with popcount, which is much faster than calling
+ * @link bitset_iterator_next @endlink for each position.
+ * @param it bitset iterator
+ * @return the number of positions in the result set
+ * @note The iterator is rewound to the start position first and
+ * must be rewound again to be used after this call.
+ * @see @link bitset_iterator_init @endlink
+ */
+size_t
+tt_bitset_iterator_count(struct tt_bitset_iterator *it);
+
 #if defined(__cplusplus)
 }
 #endif /* defined(__cplusplus) */
@@ -80,6 +80,12 @@ coll_icu_cmp(const char *s, size_t slen, const char *t, size_t tlen,
 	     const struct coll *coll)
 {
 	assert(coll->collator != NULL);
+	/*
+	 * Byte-equal strings are equal under any collation, so
+	 * exact key lookups don't need to go to ICU.
+	 */
+	if (slen == tlen && memcmp(s, t, slen) == 0)
+		return 0;
 
 	UErrorCode status = U_ZERO_ERROR;
 
@@ -33,6 +33,9 @@
 #include <limits.h>
 #include "fiber.h"
 #include "trigger.h"
+#include "clock.h"
+#include "tweaks.h"
+#include "usdt.h"
 
 /**
  * Cord interconnect.
@@ -156,11 +159,12 @@ cpipe_destroy(struct cpipe *pipe)
 	 * delivered.
 	 */
 	tt_pthread_mutex_lock(&endpoint->mutex);
-	/* Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
+	/* Flush input and add the pipe shutdown message as the last one. */
+	stailq_add_tail_entry(&pipe->input, poison, msg.fifo);
+	cbus_endpoint_push(endpoint, stailq_first(&pipe->input),
+			   stailq_last(&pipe->input));
+	stailq_create(&pipe->input);
 	pipe->n_input = 0;
-	/* Add the pipe shutdown message as the last one. */
-	stailq_add_tail_entry(&endpoint->output, poison, msg.fifo);
 	/* Count statistics */
 	rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 	/*
@@ -204,6 +208,51 @@ cbus_destroy(struct cbus *bus)
 	rmean_delete(bus->stats);
 }
 
+/**
+ * Max time the consumer of an endpoint polls its queue before
+ * blocking, see cbus_endpoint_enable_busy_poll().
+ */
+static double cbus_busy_poll_timeout = 0;
+TWEAK_DOUBLE(cbus_busy_poll_timeout);
+
+static void
+cbus_endpoint_poll_cb(ev_loop *loop, struct ev_prepare *watcher, int events)
+{
+	(void)events;
+	struct cbus_endpoint *endpoint = (struct cbus_endpoint *)watcher->data;
+	double timeout = cbus_busy_poll_timeout;
+	/*
+	 * Poll only if the loop is going to block and messages have
+	 * been fetched since the last poll, so an idle consumer gives
+	 * up after one unsuccessful poll.
+	 */
+	if (timeout <= 0 || ev_pending_count(loop) > 0 ||
+	    endpoint->fetch_count == endpoint->poll_fetch_count)
+		return;
+	endpoint->poll_fetch_count = endpoint->fetch_count;
+	pm_atomic_store(&endpoint->is_polling, true);
+	double deadline = clock_monotonic() + timeout;
+	bool is_empty;
+	while ((is_empty = cbus_endpoint_is_empty(endpoint)) &&
+	       clock_monotonic() < deadline);
+	pm_atomic_store(&endpoint->is_polling, false);
+	/*
+	 * A producer may have seen the flag set and skipped the
+	 * wakeup after we checked the queue last time, so check it
+	 * again after clearing the flag, see cpipe_flush_cb().
+	 */
+	pm_atomic_thread_fence(pm_memory_order_seq_cst);
+	if (!is_empty || !cbus_endpoint_is_empty(endpoint))
+		ev_feed_event(loop, &endpoint->async, EV_CUSTOM);
+}
+
+void
+cbus_endpoint_enable_busy_poll(struct cbus_endpoint *endpoint)
+{
+	assert(endpoint->consumer == loop());
+	ev_prepare_start(endpoint->consumer, &endpoint->poll);
+}
+
 /**
  * Join a new endpoint (message consumer) to the bus. The endpoint
  * must have a unique name. Wakes up all producers (@sa cpipe_create())
@@ -225,7 +274,14 @@ cbus_endpoint_create(struct cbus_endpoint *endpoint, const char *name,
 	endpoint->n_pipes = 0;
 	fiber_cond_create(&endpoint->cond);
 	tt_pthread_mutex_init(&endpoint->mutex, NULL);
-	stailq_create(&endpoint->output);
+	endpoint->queue_stub.next.value = NULL;
+	endpoint->queue_head = &endpoint->queue_stub;
+	endpoint->queue_tail = &endpoint->queue_stub;
+	endpoint->is_polling = false;
+	endpoint->fetch_count = 0;
+	endpoint->poll_fetch_count = 0;
+	ev_prepare_init(&endpoint->poll, cbus_endpoint_poll_cb);
+	endpoint->poll.data = endpoint;
 	ev_async_init(&endpoint->async,
 		      (void (*)(ev_loop *, struct ev_async *, int)) fetch_cb);
 	endpoint->async.data = fetch_data;
@@ -259,7 +315,7 @@ cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 	while (true) {
 		if (process_cb)
 			process_cb(endpoint);
-		if (endpoint->n_pipes == 0 && stailq_empty(&endpoint->output))
+		if (endpoint->n_pipes == 0 && cbus_endpoint_is_empty(endpoint))
 			break;
 		 fiber_cond_wait(&endpoint->cond);
 	}
@@ -271,6 +327,7 @@ cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 	tt_pthread_mutex_lock(&endpoint->mutex);
 	tt_pthread_mutex_unlock(&endpoint->mutex);
 	tt_pthread_mutex_destroy(&endpoint->mutex);
+	ev_prepare_stop(endpoint->consumer, &endpoint->poll);
 	ev_async_stop(endpoint->consumer, &endpoint->async);
 	fiber_cond_destroy(&endpoint->cond);
 	TRASH(endpoint);
@@ -288,8 +345,6 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 		return;
 
 	trigger_run(&pipe->on_flush, pipe);
-	/* Trigger task processing when the queue becomes non-empty. */
-	bool output_was_empty;
 
 	/*
 	 * We need to set a thread cancellation guard, because
@@ -302,17 +357,23 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 	int old_cancel_state;
 	tt_pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_cancel_state);
 
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	output_was_empty = stailq_empty(&endpoint->output);
 	/** Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-
+	cbus_endpoint_push(endpoint, stailq_first(&pipe->input),
+			   stailq_last(&pipe->input));
+	stailq_create(&pipe->input);
 	pipe->n_input = 0;
-	if (output_was_empty) {
+
+	/*
+	 * The producer can't tell if the consumer has already
+	 * fetched the previous messages, so the consumer is always
+	 * notified unless it's polling the queue. The notification
+	 * is cheap if it's pending. The fence pairs with the one in
+	 * cbus_endpoint_poll_cb().
+	 */
+	pm_atomic_thread_fence(pm_memory_order_seq_cst);
+	if (!pm_atomic_load(&endpoint->is_polling)) {
 		/* Count statistics */
 		rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
-
 		ev_async_send(endpoint->consumer, &endpoint->async);
 	}
 
@@ -370,6 +431,7 @@ cmsg_deliver(struct cmsg *msg)
 	 * on the last hop.
 	 */
 	struct cpipe *pipe = msg->hop->pipe;
+	USDT_PROBE(cbus_deliver, msg, msg->hop->f);
 	msg->hop->f(msg);
 	cmsg_dispatch(pipe, msg);
 }
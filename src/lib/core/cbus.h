@@ -36,6 +36,8 @@
 #include "small/rlist.h"
 #include "salad/stailq.h"
 
+#include <pmatomic.h>
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -255,14 +257,41 @@ struct cbus_endpoint {
 	char name[FIBER_NAME_MAX];
 	/** Member of cbus->endpoints */
 	struct rlist in_cbus;
-	/** The lock around the pipe. */
+	/**
+	 * The lock held while sending the pipe shutdown message,
+	 * so that the endpoint isn't destroyed before the sender
+	 * is done with it.
+	 */
 	pthread_mutex_t mutex;
-	/** A queue with incoming messages. */
-	struct stailq output;
+	/**
+	 * A queue with incoming messages. It's an intrusive lock-free
+	 * queue with many producers and a single consumer: producers
+	 * atomically swap queue_head with the last message they push
+	 * and then link the previous head to the first one, while the
+	 * consumer takes messages starting from queue_tail. A message
+	 * can't leave the queue until it has a successor, so the stub
+	 * is pushed after the last message when the consumer needs it.
+	 */
+	struct stailq_entry *queue_head;
+	/** The oldest message in the queue or the stub. */
+	struct stailq_entry *queue_tail;
+	/** A dummy entry keeping the queue non-empty. */
+	struct stailq_entry queue_stub;
 	/** Consumer cord loop */
 	ev_loop *consumer;
 	/** Async to notify the consumer */
 	ev_async async;
+	/**
+	 * Set while the consumer busy polls the queue, so producers
+	 * don't need to notify it, see cbus_endpoint_enable_busy_poll().
+	 */
+	bool is_polling;
+	/** Number of fetches that got messages. */
+	uint64_t fetch_count;
+	/** Value of fetch_count when the queue was last polled. */
+	uint64_t poll_fetch_count;
+	/** Watcher busy polling the queue before the loop blocks. */
+	ev_prepare poll;
 	/** Count of connected pipes */
 	uint32_t n_pipes;
 	/** Condition for endpoint destroy */
@@ -270,14 +299,86 @@ struct cbus_endpoint {
 };
 
 /**
- * Fetch incomming messages to output
+ * Return a pointer to the link of a queue entry for atomic access.
+ * The link is packed, but entries are embedded at the start of
+ * messages, so it's aligned.
+ */
+static inline struct stailq_entry **
+cbus_queue_link(struct stailq_entry *entry)
+{
+	return (struct stailq_entry **)(void *)&entry->next;
+}
+
+/**
+ * Append a list of linked messages from @a first to @a last to
+ * the queue of an endpoint. Can be called from any thread.
+ */
+static inline void
+cbus_endpoint_push(struct cbus_endpoint *endpoint, struct stailq_entry *first,
+		   struct stailq_entry *last)
+{
+	last->next.value = NULL;
+	struct stailq_entry *prev = pm_atomic_exchange_explicit(
+		&endpoint->queue_head, last, pm_memory_order_acq_rel);
+	/*
+	 * Until the previous head is linked, the consumer sees the
+	 * queue end at it. It is woken up after this anyway.
+	 */
+	pm_atomic_store_explicit(cbus_queue_link(prev), first,
+				 pm_memory_order_release);
+}
+
+/**
+ * Fetch incomming messages to output. Must be called from the
+ * consumer cord only.
  */
 static inline void
 cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output)
 {
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	stailq_concat(output, &endpoint->output);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
+	struct stailq_entry *stub = &endpoint->queue_stub;
+	struct stailq_entry *tail = endpoint->queue_tail;
+	while (true) {
+		struct stailq_entry *next = pm_atomic_load_explicit(
+			cbus_queue_link(tail), pm_memory_order_acquire);
+		if (tail == stub) {
+			if (next == NULL)
+				break;
+			tail = next;
+			continue;
+		}
+		if (next == NULL) {
+			/*
+			 * The tail is the last linked message. If it is
+			 * the head, push the stub after it to take it
+			 * out of the queue. Otherwise a producer hasn't
+			 * linked its messages to the tail yet, and they
+			 * are fetched when the producer wakes us up.
+			 */
+			if (pm_atomic_load_explicit(&endpoint->queue_head,
+					pm_memory_order_acquire) != tail)
+				break;
+			cbus_endpoint_push(endpoint, stub, stub);
+			next = pm_atomic_load_explicit(
+				cbus_queue_link(tail), pm_memory_order_acquire);
+			if (next == NULL)
+				break;
+		}
+		stailq_add_tail(output, tail);
+		tail = next;
+	}
+	if (tail != endpoint->queue_tail)
+		endpoint->fetch_count++;
+	endpoint->queue_tail = tail;
+}
+
+/** Check if an endpoint has no incoming messages. */
+static inline bool
+cbus_endpoint_is_empty(struct cbus_endpoint *endpoint)
+{
+	struct stailq_entry *stub = &endpoint->queue_stub;
+	return endpoint->queue_tail == stub &&
+	       pm_atomic_load_explicit(&endpoint->queue_head,
+				       pm_memory_order_acquire) == stub;
 }
 
 /** Initialize the global singleton bus. */
@@ -299,6 +400,18 @@ int
 cbus_endpoint_create(struct cbus_endpoint *endpoint, const char *name,
 		     void (*fetch_cb)(ev_loop *, struct ev_watcher *, int), void *fetch_data);
 
+/**
+ * Make the consumer of an endpoint busy poll its queue for up to
+ * the cbus_busy_poll_timeout tweak seconds before its event loop
+ * blocks, if the previous loop iteration fetched messages. While
+ * the consumer polls, producers don't wake it up, which saves the
+ * wakeup latency when messages come often, at the cost of the CPU
+ * time spent polling. The polling is disabled if the tweak is 0,
+ * which is the default. Must be called from the consumer cord.
+ */
+void
+cbus_endpoint_enable_busy_poll(struct cbus_endpoint *endpoint);
+
 /**
  * One round for message fetch and deliver */
 void
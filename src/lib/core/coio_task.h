@@ -53,6 +53,22 @@ void coio_init(void);
 void coio_enable(void);
 void coio_shutdown(void);
 
+/**
+ * Priorities of coio tasks. Queued tasks with a higher priority
+ * are executed first, so that short tasks blocking a fiber don't
+ * wait behind long ones.
+ */
+enum coio_pri {
+	/** Syncing and copying files. */
+	COIO_PRI_BULK = EIO_PRI_MIN,
+	/** Reading and writing files and other tasks. */
+	COIO_PRI_DEFAULT = EIO_PRI_DEFAULT,
+	/** File system metadata: open, stat, rename, unlink, etc. */
+	COIO_PRI_META = EIO_PRI_MAX / 2,
+	/** Name resolution. */
+	COIO_PRI_DNS = EIO_PRI_MAX,
+};
+
 struct coio_task;
 
 typedef ssize_t (*coio_call_cb)(va_list ap);
@@ -97,6 +113,16 @@ void
 coio_task_create(struct coio_task *task, coio_task_cb func,
 		 coio_task_cb on_timeout);
 
+/**
+ * Set the priority of a coio task. The priority is
+ * COIO_PRI_DEFAULT unless set.
+ */
+static inline void
+coio_task_set_pri(struct coio_task *task, enum coio_pri pri)
+{
+	task->base.pri = pri;
+}
+
 /**
  * Destroy coio task.
  *
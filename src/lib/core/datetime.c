@@ -7,6 +7,7 @@
 #include <math.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <time.h>
@@ -203,6 +204,17 @@ datetime_ev_now(struct datetime *now)
 	now->tzindex = 0;
 }
 
+/** Write @a value as @a width decimal digits padded with zeros. */
+static inline char *
+dt_put_digits(char *buf, int value, int width)
+{
+	for (int i = width - 1; i >= 0; i--) {
+		buf[i] = '0' + value % 10;
+		value /= 10;
+	}
+	return buf + width;
+}
+
 /**
  * NB! buf may be NULL, and we should handle it gracefully, returning
  * calculated length of output string
@@ -228,6 +240,47 @@ datetime_to_string(const struct datetime *date, char *buf, ssize_t len)
 	second = rd_seconds % 60;
 	nanosec = date->nsec;
 
+	/*
+	 * Fast path for the common case: the output fits in the buffer
+	 * and contains only fixed width fields, so it can be written in
+	 * one pass without snprintf.
+	 */
+	if (buf != NULL && tzindex == 0 &&
+	    len >= (ssize_t)sizeof("YYYY-MM-DDThh:mm:ss.nnnnnnnnn+hhmm") &&
+	    year >= 0 && year <= 9999 && abs(offset) < 100 * 60) {
+		char *p = buf;
+		p = dt_put_digits(p, year, 4);
+		*p++ = '-';
+		p = dt_put_digits(p, month, 2);
+		*p++ = '-';
+		p = dt_put_digits(p, day, 2);
+		*p++ = 'T';
+		p = dt_put_digits(p, hour, 2);
+		*p++ = ':';
+		p = dt_put_digits(p, minute, 2);
+		*p++ = ':';
+		p = dt_put_digits(p, second, 2);
+		if (nanosec != 0) {
+			*p++ = '.';
+			if (nanosec % 1000000 == 0)
+				p = dt_put_digits(p, nanosec / 1000000, 3);
+			else if (nanosec % 1000 == 0)
+				p = dt_put_digits(p, nanosec / 1000, 6);
+			else
+				p = dt_put_digits(p, nanosec, 9);
+		}
+		if (offset == 0) {
+			*p++ = 'Z';
+		} else {
+			*p++ = offset < 0 ? '-' : '+';
+			offset = abs(offset);
+			p = dt_put_digits(p, offset / 60, 2);
+			p = dt_put_digits(p, offset % 60, 2);
+		}
+		*p = '\0';
+		return p - buf;
+	}
+
 	size_t sz = 0;
 	SNPRINT(sz, snprintf, buf, len, "%04d-%02d-%02dT%02d:%02d:%02d",
 		year, month, day, hour, minute, second);
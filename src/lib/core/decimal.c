@@ -36,6 +36,7 @@
 #include "lib/msgpuck/msgpuck.h"
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <float.h> /* DBL_DIG */
 #include <math.h> /* isnan(), isinf(). */
 #include "trivia/util.h"
@@ -531,3 +532,95 @@ decimal_unpack(const char **data, uint32_t len, decimal_t *dec)
 	}
 	return res;
 }
+
+/**
+ * Decode the scale of a packed decimal and point \a bcd to its
+ * BCD digits. Return -1 if the encoding is unexpected.
+ */
+static int
+decimal_packed_split(const char *data, uint32_t len, int64_t *scale,
+		     const char **bcd, uint32_t *bcd_len)
+{
+	const char *end = data + len;
+	enum mp_type type = mp_typeof(*data);
+	if (type == MP_UINT) {
+		if (mp_check_uint(data, end) > 0)
+			return -1;
+		uint64_t value = mp_decode_uint(&data);
+		if (value > INT64_MAX)
+			return -1;
+		*scale = (int64_t)value;
+	} else if (type == MP_INT) {
+		if (mp_check_int(data, end) > 0)
+			return -1;
+		*scale = mp_decode_int(&data);
+	} else {
+		return -1;
+	}
+	if (data == end)
+		return -1;
+	/* The sign nibble is 0xA - 0xF. */
+	if ((end[-1] & 0x0f) < 0x0a)
+		return -1;
+	/* Skip leading zeros, they don't affect the value. */
+	while (data < end - 1 && *data == 0)
+		data++;
+	*bcd = data;
+	*bcd_len = end - data;
+	return 0;
+}
+
+/** Check if packed decimal digits are negative (and non-zero). */
+static bool
+decimal_packed_is_neg(const char *bcd, uint32_t bcd_len)
+{
+	uint8_t last = bcd[bcd_len - 1];
+	uint8_t sign = last & 0x0f;
+	/* Zero is never negative. Leading zeros are skipped. */
+	if (bcd_len == 1 && (last >> 4) == 0)
+		return false;
+	return sign == 0x0b || sign == 0x0d;
+}
+
+int
+decimal_compare_packed(const char *lhs, uint32_t lhs_len,
+		       const char *rhs, uint32_t rhs_len, int *result)
+{
+	int64_t lhs_scale, rhs_scale;
+	const char *lhs_bcd, *rhs_bcd;
+	uint32_t lhs_bcd_len, rhs_bcd_len;
+	if (decimal_packed_split(lhs, lhs_len, &lhs_scale,
+				 &lhs_bcd, &lhs_bcd_len) != 0 ||
+	    decimal_packed_split(rhs, rhs_len, &rhs_scale,
+				 &rhs_bcd, &rhs_bcd_len) != 0 ||
+	    lhs_scale != rhs_scale)
+		return -1;
+	bool lhs_is_neg = decimal_packed_is_neg(lhs_bcd, lhs_bcd_len);
+	bool rhs_is_neg = decimal_packed_is_neg(rhs_bcd, rhs_bcd_len);
+	if (lhs_is_neg != rhs_is_neg) {
+		*result = lhs_is_neg ? -1 : 1;
+		return 0;
+	}
+	/*
+	 * With the leading zeros skipped, a longer number has a
+	 * greater magnitude. The numbers of the same length are
+	 * compared digit by digit, which is what memcmp() does with
+	 * BCD, except the sign nibble in the last byte.
+	 */
+	int cmp;
+	if (lhs_bcd_len != rhs_bcd_len) {
+		cmp = lhs_bcd_len < rhs_bcd_len ? -1 : 1;
+	} else {
+		cmp = memcmp(lhs_bcd, rhs_bcd, lhs_bcd_len - 1);
+		if (cmp == 0) {
+			uint8_t lhs_last = lhs_bcd[lhs_bcd_len - 1];
+			uint8_t rhs_last = rhs_bcd[rhs_bcd_len - 1];
+			lhs_last >>= 4;
+			rhs_last >>= 4;
+			cmp = (lhs_last > rhs_last) - (lhs_last < rhs_last);
+		}
+		cmp = (cmp > 0) - (cmp < 0);
+	}
+	*result = lhs_is_neg ? -cmp : cmp;
+	return 0;
+}
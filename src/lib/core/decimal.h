@@ -282,6 +282,21 @@ decimal_pack(char *data, const decimal_t *dec);
 decimal_t *
 decimal_unpack(const char **data, uint32_t len, decimal_t *dec);
 
+/**
+ * Compare two decimals in the packed representation of sizes
+ * \a lhs_len and \a rhs_len without unpacking them. Only the
+ * values of the same scale can be compared this way, which is
+ * the common case for the values of one field.
+ *
+ * @retval 0 on success, the result (-1, 0, 1) is stored in
+ *         \a result.
+ * @retval -1 if the values have different scales or the encoding
+ *         is unexpected, and they need to be unpacked to compare.
+ */
+int
+decimal_compare_packed(const char *lhs, uint32_t lhs_len,
+		       const char *rhs, uint32_t rhs_len, int *result);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -191,6 +191,12 @@ evio_service_entry_accept_cb(ev_loop *loop, ev_io *watcher, int events)
 			break;
 		entry->service->on_accept(entry->service, &io,
 					  (struct sockaddr *)&addr, addrlen);
+		/*
+		 * Leave the rest of the backlog to other services
+		 * attached to the socket if the callback paused us.
+		 */
+		if (!ev_is_active(watcher))
+			return;
 		/* Must be moved by the callback. */
 		assert(!iostream_is_initialized(&io));
 	}
@@ -497,6 +503,23 @@ evio_service_detach(struct evio_service *service)
 	service->entries = NULL;
 }
 
+void
+evio_service_pause(struct evio_service *service)
+{
+	for (int i = 0; i < service->entry_count; i++)
+		ev_io_stop(service->loop, &service->entries[i].ev);
+}
+
+void
+evio_service_resume(struct evio_service *service)
+{
+	for (int i = 0; i < service->entry_count; i++) {
+		struct evio_service_entry *entry = &service->entries[i];
+		if (entry->ev.fd >= 0)
+			ev_io_start(service->loop, &entry->ev);
+	}
+}
+
 /** Listen on bound socket. */
 static int
 evio_service_listen(struct evio_service *service)
@@ -127,6 +127,18 @@ evio_service_stop(struct evio_service *service);
 void
 evio_service_attach(struct evio_service *dst, const struct evio_service *src);
 
+/**
+ * Stop accepting new connections on an attached service without
+ * detaching it. Other services attached to the same sockets go on
+ * accepting connections.
+ */
+void
+evio_service_pause(struct evio_service *service);
+
+/** Resume accepting new connections after evio_service_pause(). */
+void
+evio_service_resume(struct evio_service *service);
+
 /**
  * Reload service URIs.
  *
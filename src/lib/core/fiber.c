@@ -38,6 +38,10 @@
 #include <string.h>
 #include <pmatomic.h>
 #include <tarantool_ev.h>
+#include <ctype.h>
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP)
+#include <sched.h>
+#endif
 
 #include "assoc.h"
 #include "memory.h"
@@ -46,6 +50,8 @@
 #include "clock.h"
 #include "tt_sigaction.h"
 #include "tt_static.h"
+#include "tweaks.h"
+#include "usdt.h"
 
 extern void cord_on_yield(void);
 
@@ -340,6 +346,13 @@ enum {
 	FIBER_STACK_SIZE_WATERMARK = 65536,
 };
 
+/**
+ * Max total stack size of dead fibers with a custom stack size
+ * cached for reuse in each cord, in bytes.
+ */
+static int fiber_stack_cache_size = 16 * 1024 * 1024;
+TWEAK_INT(fiber_stack_cache_size);
+
 /** Default fiber attributes */
 static const struct fiber_attr fiber_attr_default = {
        .stack_size = FIBER_STACK_SIZE_DEFAULT,
@@ -439,6 +452,9 @@ fiber_on_stop(struct fiber *f)
 static void
 fiber_recycle(struct fiber *fiber);
 
+static void
+cord_apply_affinity(void);
+
 static void
 fiber_stack_recycle(struct fiber *fiber);
 
@@ -509,6 +525,7 @@ fiber_call_impl(struct fiber *callee)
 	if (cord_is_main())
 		cord_reset_slice(callee);
 
+	USDT_PROBE(fiber_switch, caller->fid, callee->fid);
 	ASAN_START_SWITCH_FIBER(asan_state, 1,
 				callee->stack,
 				callee->stack_size);
@@ -797,6 +814,7 @@ fiber_yield_impl(MAYBE_UNUSED bool will_switch_back)
 	cord->fiber = callee;
 	callee->flags = (callee->flags & ~FIBER_IS_READY) | FIBER_IS_RUNNING;
 
+	USDT_PROBE(fiber_switch, caller->fid, callee->fid);
 	ASAN_START_SWITCH_FIBER(asan_state, will_switch_back, callee->stack,
 				callee->stack_size);
 	coro_transfer(&caller->ctx, &callee->ctx);
@@ -983,6 +1001,50 @@ fiber_reset(struct fiber *fiber)
 	clock_stat_reset(&fiber->clock_stat);
 }
 
+/**
+ * Put a dead fiber with a custom stack size to the cache for reuse
+ * and evict the least recently used fibers from the cache if its
+ * size exceeds the limit. The fiber must fit in the cache alone,
+ * so it's never evicted here, which is important because it may
+ * be the current fiber.
+ */
+static void
+cord_cache_custom_stack_fiber(struct cord *cord, struct fiber *fiber)
+{
+	assert(fiber->stack_size <= (size_t)fiber_stack_cache_size);
+	rlist_move_entry(&cord->dead_custom_stack, fiber, link);
+	cord->dead_custom_stack_size += fiber->stack_size;
+	while (cord->dead_custom_stack_size >
+	       (size_t)fiber_stack_cache_size) {
+		struct fiber *f = rlist_last_entry(&cord->dead_custom_stack,
+						   struct fiber, link);
+		assert(f != fiber);
+		cord->dead_custom_stack_size -= f->stack_size;
+		fiber_delete(cord, f);
+	}
+}
+
+/**
+ * Take a dead fiber with the given custom stack size from the cache.
+ * Returns NULL if there's no such fiber.
+ */
+static struct fiber *
+cord_reuse_custom_stack_fiber(struct cord *cord, size_t stack_size)
+{
+	struct fiber *fiber;
+	rlist_foreach_entry(fiber, &cord->dead_custom_stack, link) {
+		if (fiber->attr_stack_size != stack_size)
+			continue;
+		assert(fiber_is_dead(fiber));
+		assert(cord->dead_custom_stack_size >= fiber->stack_size);
+		cord->dead_custom_stack_size -= fiber->stack_size;
+		cord->custom_stack_reuse_count++;
+		rlist_move_entry(&cord->alive, fiber, link);
+		return fiber;
+	}
+	return NULL;
+}
+
 /** Destroy an active fiber and prepare it for reuse or delete it. */
 static void
 fiber_recycle(struct fiber *fiber)
@@ -1011,6 +1073,8 @@ fiber_recycle(struct fiber *fiber)
 	region_free(&fiber->gc);
 	if (fiber_is_reusable(fiber->flags)) {
 		rlist_move_entry(&cord()->dead, fiber, link);
+	} else if (fiber->stack_size <= (size_t)fiber_stack_cache_size) {
+		cord_cache_custom_stack_fiber(cord(), fiber);
 	} else {
 		cord_add_garbage(cord(), fiber);
 	}
@@ -1449,6 +1513,7 @@ fiber_stack_create(struct fiber *fiber, const struct fiber_attr *fiber_attr,
 		return -1;
 	}
 
+	fiber->attr_stack_size = fiber_attr->stack_size;
 	fiber_stack_watermark_create(fiber, fiber_attr);
 	return 0;
 }
@@ -1488,6 +1553,10 @@ fiber_new_ex(const char *name, const struct fiber_attr *fiber_attr,
 		fiber = rlist_first_entry(&cord->dead, struct fiber, link);
 		rlist_move_entry(&cord->alive, fiber, link);
 		assert(fiber_is_dead(fiber));
+	} else if (!fiber_is_reusable(fiber_attr->flags) &&
+		   (fiber = cord_reuse_custom_stack_fiber(
+				cord, fiber_attr->stack_size)) != NULL) {
+		/* Reused a fiber with the same custom stack size. */
 	} else {
 		fiber = (struct fiber *)
 			mempool_alloc(&cord->fiber_mempool);
@@ -1612,6 +1681,8 @@ fiber_delete_all(struct cord *cord)
 	cord_collect_garbage(cord);
 	cord_delete_fibers_in_list(cord, &cord->alive);
 	cord_delete_fibers_in_list(cord, &cord->dead);
+	cord_delete_fibers_in_list(cord, &cord->dead_custom_stack);
+	cord->dead_custom_stack_size = 0;
 	cord_delete_fibers_in_list(cord, &cord->ready);
 }
 
@@ -1758,6 +1829,9 @@ cord_create(struct cord *cord, const char *name)
 	rlist_create(&cord->alive);
 	rlist_create(&cord->ready);
 	rlist_create(&cord->dead);
+	rlist_create(&cord->dead_custom_stack);
+	cord->dead_custom_stack_size = 0;
+	cord->custom_stack_reuse_count = 0;
 	cord->garbage = NULL;
 	cord->fiber_registry = mh_i64ptr_new();
 
@@ -1791,6 +1865,7 @@ cord_create(struct cord *cord, const char *name)
 		fiber_top_init();
 	}
 	cord_set_name(name);
+	cord_apply_affinity();
 
 	trigger_init_in_thread();
 #if ENABLE_ASAN
@@ -1912,14 +1987,19 @@ void *cord_thread_func(void *p)
 	return res;
 }
 
-int
-cord_start(struct cord *cord, const char *name, void *(*f)(void *), void *arg)
+/**
+ * Start a cord with the event loop created with the given libev flags.
+ */
+static int
+cord_start_with_loop_flags(struct cord *cord, const char *name,
+			   void *(*f)(void *), void *arg,
+			   unsigned int loop_flags)
 {
 	int res = -1;
 	struct cord_thread_arg ct_arg = { cord, name, f, arg, false,
 		PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
 	tt_pthread_mutex_lock(&ct_arg.start_mutex);
-	cord->loop = ev_loop_new(EVFLAG_AUTO | EVFLAG_ALLOCFD);
+	cord->loop = ev_loop_new(loop_flags | EVFLAG_ALLOCFD);
 	if (cord->loop == NULL) {
 		diag_set(OutOfMemory, 0, "ev_loop_new", "ev_loop");
 		goto end;
@@ -1946,6 +2026,12 @@ cord_start(struct cord *cord, const char *name, void *(*f)(void *), void *arg)
 	return res;
 }
 
+int
+cord_start(struct cord *cord, const char *name, void *(*f)(void *), void *arg)
+{
+	return cord_start_with_loop_flags(cord, name, f, arg, EVFLAG_AUTO);
+}
+
 int
 cord_join(struct cord *cord)
 {
@@ -2105,7 +2191,8 @@ cord_costart_thread_func(void *arg)
 }
 
 int
-cord_costart(struct cord *cord, const char *name, fiber_func f, void *arg)
+cord_costart_with_loop_flags(struct cord *cord, const char *name,
+			     fiber_func f, void *arg, unsigned int loop_flags)
 {
 	/** Must be allocated to avoid races. */
 	struct costart_ctx *ctx = (struct costart_ctx *) malloc(sizeof(*ctx));
@@ -2116,13 +2203,163 @@ cord_costart(struct cord *cord, const char *name, fiber_func f, void *arg)
 	}
 	ctx->run = f;
 	ctx->arg = arg;
-	if (cord_start(cord, name, cord_costart_thread_func, ctx) == -1) {
+	if (cord_start_with_loop_flags(cord, name, cord_costart_thread_func,
+				       ctx, loop_flags) == -1) {
 		free(ctx);
 		return -1;
 	}
 	return 0;
 }
 
+int
+cord_costart(struct cord *cord, const char *name, fiber_func f, void *arg)
+{
+	return cord_costart_with_loop_flags(cord, name, f, arg, EVFLAG_AUTO);
+}
+
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP)
+
+enum {
+	/** Max number of cord name prefixes with an affinity set. */
+	CORD_AFFINITY_MAX = 16,
+};
+
+/** CPUs to bind threads of cords with names with the prefix to. */
+struct cord_affinity {
+	char name_prefix[FIBER_NAME_MAX];
+	cpu_set_t cpus;
+};
+
+static struct cord_affinity cord_affinity[CORD_AFFINITY_MAX];
+static int cord_affinity_count;
+static pthread_mutex_t cord_affinity_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** Parse a list of CPU numbers and ranges, like "0-3,8". */
+static int
+cord_parse_affinity(const char *str, cpu_set_t *cpus)
+{
+	CPU_ZERO(cpus);
+	const char *p = str;
+	do {
+		char *end;
+		if (!isdigit((unsigned char)*p))
+			goto error;
+		unsigned long first = strtoul(p, &end, 10);
+		unsigned long last = first;
+		p = end;
+		if (*p == '-') {
+			p++;
+			if (!isdigit((unsigned char)*p))
+				goto error;
+			last = strtoul(p, &end, 10);
+			p = end;
+		}
+		if (last < first || last >= CPU_SETSIZE)
+			goto error;
+		for (unsigned long cpu = first; cpu <= last; cpu++)
+			CPU_SET(cpu, cpus);
+	} while (*p++ == ',');
+	if (p[-1] != '\0')
+		goto error;
+	return 0;
+error:
+	diag_set(IllegalParams, "invalid CPU list '%s'", str);
+	return -1;
+}
+
+/**
+ * Bind the current cord thread to the CPUs set for the longest
+ * prefix of its name, if any.
+ */
+static void
+cord_apply_affinity(void)
+{
+	const struct cord_affinity *affinity = NULL;
+	size_t prefix_len = 0;
+	tt_pthread_mutex_lock(&cord_affinity_mutex);
+	for (int i = 0; i < cord_affinity_count; i++) {
+		const char *prefix = cord_affinity[i].name_prefix;
+		size_t len = strlen(prefix);
+		if (len >= prefix_len &&
+		    strncmp(cord()->name, prefix, len) == 0) {
+			affinity = &cord_affinity[i];
+			prefix_len = len;
+		}
+	}
+	if (affinity != NULL) {
+		int rc = pthread_setaffinity_np(pthread_self(),
+						sizeof(affinity->cpus),
+						&affinity->cpus);
+		if (rc != 0) {
+			errno = rc;
+			say_syserror("failed to set CPU affinity of "
+				     "thread '%s'", cord()->name);
+		}
+	}
+	tt_pthread_mutex_unlock(&cord_affinity_mutex);
+}
+
+int
+cord_check_affinity(const char *cpus)
+{
+	cpu_set_t set;
+	return cord_parse_affinity(cpus, &set);
+}
+
+int
+cord_set_affinity(const char *name_prefix, const char *cpus)
+{
+	cpu_set_t set;
+	if (cord_parse_affinity(cpus, &set) != 0)
+		return -1;
+	tt_pthread_mutex_lock(&cord_affinity_mutex);
+	struct cord_affinity *affinity = NULL;
+	for (int i = 0; i < cord_affinity_count; i++) {
+		if (strcmp(cord_affinity[i].name_prefix, name_prefix) == 0)
+			affinity = &cord_affinity[i];
+	}
+	if (affinity == NULL) {
+		if (cord_affinity_count == CORD_AFFINITY_MAX) {
+			tt_pthread_mutex_unlock(&cord_affinity_mutex);
+			diag_set(IllegalParams, "too many thread names with "
+				 "CPU affinity, max is %d", CORD_AFFINITY_MAX);
+			return -1;
+		}
+		affinity = &cord_affinity[cord_affinity_count++];
+		snprintf(affinity->name_prefix, sizeof(affinity->name_prefix),
+			 "%s", name_prefix);
+	}
+	affinity->cpus = set;
+	tt_pthread_mutex_unlock(&cord_affinity_mutex);
+	cord_apply_affinity();
+	return 0;
+}
+
+#else /* !defined(HAVE_PTHREAD_SETAFFINITY_NP) */
+
+static void
+cord_apply_affinity(void)
+{
+}
+
+int
+cord_check_affinity(const char *cpus)
+{
+	(void)cpus;
+	diag_set(IllegalParams, "CPU affinity is not supported "
+		 "by the system");
+	return -1;
+}
+
+int
+cord_set_affinity(const char *name_prefix, const char *cpus)
+{
+	(void)name_prefix;
+	return cord_check_affinity(cpus);
+}
+
+#endif /* !defined(HAVE_PTHREAD_SETAFFINITY_NP) */
+
 void
 cord_set_name(const char *name)
 {
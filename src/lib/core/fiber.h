@@ -621,6 +621,8 @@ struct fiber {
 #endif
 	/** Coro stack size. */
 	size_t stack_size;
+	/** Stack size requested in the attributes of the fiber. */
+	size_t attr_stack_size;
 	/** Fiber's custom slice if fiber has it, zero otherwise. */
 	struct fiber_slice max_slice;
 	/** Valgrind stack id. */
@@ -779,6 +781,18 @@ struct cord {
 	struct rlist ready;
 	/** A cache of dead fibers for reuse */
 	struct rlist dead;
+	/**
+	 * A cache of dead fibers with a custom stack size for reuse,
+	 * most recently used first, so that fibers with small or big
+	 * stacks don't need to allocate and protect a new stack.
+	 * The total stack size of the cached fibers is limited by
+	 * the fiber_stack_cache_size tweak.
+	 */
+	struct rlist dead_custom_stack;
+	/** Total stack size of fibers in the dead_custom_stack cache. */
+	size_t dead_custom_stack_size;
+	/** Number of fibers with a custom stack taken from the cache. */
+	int64_t custom_stack_reuse_count;
 	/**
 	 * Latest dead fiber which couldn't be reused and waits for its
 	 * deletion. A fiber can't be reused if it is somehow non-standard. For
@@ -888,6 +902,14 @@ cord_start(struct cord *cord, const char *name,
 int
 cord_costart(struct cord *cord, const char *name, fiber_func f, void *arg);
 
+/**
+ * Like cord_costart(), but the cord event loop is created with the
+ * given libev flags (EVFLAG_* and EVBACKEND_*) instead of EVFLAG_AUTO.
+ */
+int
+cord_costart_with_loop_flags(struct cord *cord, const char *name,
+			     fiber_func f, void *arg, unsigned int loop_flags);
+
 /**
  * Yield until \a cord has terminated.
  *
@@ -923,6 +945,25 @@ cord_join(struct cord *cord);
 void
 cord_set_name(const char *name);
 
+/**
+ * Check a list of CPU numbers and ranges, like "0-3,8", for
+ * cord_set_affinity(). Returns 0 if the list is valid, otherwise
+ * sets diag and returns -1.
+ */
+int
+cord_check_affinity(const char *cpus);
+
+/**
+ * Bind the threads of cords with names starting with the given
+ * prefix to the given list of CPUs, see cord_check_affinity().
+ * The binding applies to the calling cord, if its name matches,
+ * and to all cords started afterwards. On NUMA systems it keeps
+ * the memory first touched by a cord local to its CPUs.
+ * Returns 0 on success, otherwise sets diag and returns -1.
+ */
+int
+cord_set_affinity(const char *name_prefix, const char *cpus);
+
 static inline const char *
 cord_name(struct cord *cord)
 {
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include "msgpuck.h"
 #include "tt_compression.h"
 #include <trivia/util.h>
 
@@ -42,25 +43,53 @@ mp_decompress(const char **src, char *dst, size_t dst_size)
         return 0;
 }
 
+/**
+ * Layout of MP_COMPRESSION extension data used by the memtx engine:
+ *
+ *   MP_UINT compression type (enum compression_type)
+ *   MP_UINT id of the compression dictionary, 0 if none was used
+ *   MP_UINT size of the original MsgPack value
+ *   compressed MsgPack value
+ *
+ * Decodes the header of the extension data. Returns 0 on success,
+ * -1 if the data is malformed.
+ */
+static inline int
+mp_decode_compression_header(const char **data, const char *end,
+			     uint64_t *type, uint64_t *dict_id,
+			     uint64_t *raw_size)
+{
+	uint64_t *values[] = {type, dict_id, raw_size};
+	for (size_t i = 0; i < lengthof(values); i++) {
+		if (*data >= end || mp_typeof(**data) != MP_UINT ||
+		    mp_check_uint(*data, end) > 0)
+			return -1;
+		*values[i] = mp_decode_uint(data);
+	}
+	return 0;
+}
+
 static inline int
 mp_snprint_compression(char *buf, int size, const char **data, uint32_t len)
 {
-        (void)buf;
-        (void)size;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
+	const char *end = *data + len;
+	uint64_t type, dict_id, raw_size;
+	int rc = mp_decode_compression_header(data, end, &type, &dict_id,
+					      &raw_size);
+	*data = end;
+	if (rc != 0 || type >= compression_type_MAX)
+		return snprintf(buf, size, "<compressed %u bytes>", len);
+	return snprintf(buf, size, "<compressed %s %llu bytes>",
+			compression_type_strs[type],
+			(unsigned long long)raw_size);
 }
 
 static inline int
 mp_fprint_compression(FILE *file, const char **data, uint32_t len)
 {
-        (void)file;
-        (void)data;
-        (void)len;
-        unreachable();
-        return -1;
+	char buf[64];
+	int rc = mp_snprint_compression(buf, sizeof(buf), data, len);
+	return fprintf(file, "%s", buf) < 0 ? -1 : rc;
 }
 
 #if defined(__cplusplus)
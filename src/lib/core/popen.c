@@ -26,6 +26,12 @@
 
 #define POPEN_WAIT_LEADERSHIP_DELAY 0.01
 
+/** Max amount of data moved by one splice() call. */
+#define POPEN_SPLICE_CHUNK (64 * 1024)
+
+/** How many chunks popen_splice_timeout() moves between yields. */
+#define POPEN_SPLICE_CHUNKS_PER_YIELD 16
+
 /* A mapping to find popens by their pids in a signal handler */
 static struct mh_i32ptr_t *popen_pids_map = NULL;
 
@@ -464,6 +470,131 @@ popen_read_timeout(struct popen_handle *handle, void *buf,
 				       timeout);
 }
 
+/**
+ * Move data between a child's peer and @a fd with timeout until
+ * EOF is read from the source.
+ *
+ * The data is moved by the kernel with splice() and never copied
+ * to the user space.
+ *
+ * When @a flags has POPEN_FLAG_FD_STDIN set, the data is read from
+ * @a fd and written to the child's stdin. Otherwise it is read from
+ * the child's stdout or stderr and written to @a fd. Exactly one of
+ * the flags must be set. @a fd may be a file, a socket or a pipe,
+ * it is not closed by the function.
+ *
+ * Yield until the data is available for read or may be written.
+ *
+ * Returns amount of moved bytes at success, otherwise returns -1
+ * and set a diag.
+ *
+ * Possible errors:
+ *
+ * - IllegalParams: a parameter check fails:
+ *   - flags: none or several of stdin, stdout, stderr are set.
+ *   - handle: handle does not support the requested IO operation.
+ *   - handle: attempt to operate on a closed fd.
+ *   - the platform does not support splice().
+ * - SystemError: an IO error occurs at splice().
+ * - TimedOut: @a timeout quota is exceeded.
+ * - FiberIsCancelled: cancelled by an outside code.
+ *
+ * Like with popen_write_timeout(), some data may be moved before
+ * an error occurs.
+ */
+ssize_t
+popen_splice_timeout(struct popen_handle *handle, int fd,
+		     unsigned int flags, ev_tstamp timeout)
+{
+	assert(handle != NULL);
+
+	int idx;
+	flags &= POPEN_FLAG_FD_STDIN | POPEN_FLAG_FD_STDOUT |
+		 POPEN_FLAG_FD_STDERR;
+	switch (flags) {
+	case POPEN_FLAG_FD_STDIN:
+		idx = STDIN_FILENO;
+		break;
+	case POPEN_FLAG_FD_STDOUT:
+		idx = STDOUT_FILENO;
+		break;
+	case POPEN_FLAG_FD_STDERR:
+		idx = STDERR_FILENO;
+		break;
+	default:
+		diag_set(IllegalParams, "popen: exactly one of stdin, "
+			 "stdout and stderr must be set");
+		return -1;
+	}
+
+	if (popen_may_io(handle, idx, flags) != 0)
+		return -1;
+
+#if TARGET_OS_LINUX
+	int pipe_fd = handle->ios[idx].fd;
+	bool to_child = idx == STDIN_FILENO;
+	int src = to_child ? fd : pipe_fd;
+	int dst = to_child ? pipe_fd : fd;
+
+	say_debug("popen: %d: splice idx [%s:%d] fds %d -> %d "
+		  "timeout %.9g", handle->pid, stdX_str(idx), idx,
+		  src, dst, timeout);
+
+	ev_tstamp start, delay;
+	coio_timeout_init(&start, &delay, timeout);
+	ssize_t total = 0;
+	unsigned int chunks = 0;
+	while (true) {
+		ssize_t rc = splice(src, NULL, dst, NULL, POPEN_SPLICE_CHUNK,
+				    SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (rc == 0)
+			return total;
+		if (rc > 0) {
+			total += rc;
+			/* Don't starve other fibers on a fast source. */
+			if (++chunks % POPEN_SPLICE_CHUNKS_PER_YIELD != 0)
+				continue;
+			fiber_sleep(0);
+		} else if (errno == EINTR) {
+			continue;
+		} else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			diag_set(SystemError, "popen: splice failed");
+			return -1;
+		} else {
+			if (delay <= 0) {
+				diag_set(TimedOut);
+				return -1;
+			}
+			/*
+			 * EAGAIN means that either end would block. Wait
+			 * for the pipe if it isn't ready, else for @a fd.
+			 */
+			struct pollfd pfd = {
+				.fd = pipe_fd,
+				.events = to_child ? POLLOUT : POLLIN,
+			};
+			if (poll(&pfd, 1, 0) > 0)
+				coio_wait(fd, to_child ? EV_READ : EV_WRITE,
+					  delay);
+			else
+				coio_wait(pipe_fd, to_child ? EV_WRITE : EV_READ,
+					  delay);
+		}
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			return -1;
+		}
+		coio_timeout_update(&start, &delay);
+	}
+#else /* !TARGET_OS_LINUX */
+	(void)fd;
+	(void)timeout;
+	diag_set(IllegalParams, "popen: splice is not supported "
+		 "on this platform");
+	return -1;
+#endif /* !TARGET_OS_LINUX */
+}
+
 /**
  * Close parent's ends of std* fds.
  *
@@ -181,6 +181,10 @@ popen_read_timeout(struct popen_handle *handle, void *buf,
 		   size_t count, unsigned int flags,
 		   ev_tstamp timeout);
 
+extern ssize_t
+popen_splice_timeout(struct popen_handle *handle, int fd,
+		     unsigned int flags, ev_tstamp timeout);
+
 extern int
 popen_shutdown(struct popen_handle *handle, unsigned int flags);
 
@@ -0,0 +1,237 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+#include "core/sampler.h"
+
+#ifdef ENABLE_FIBER_SAMPLER
+
+#include <assert.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "core/fiber.h"
+#include "diag.h"
+#include "trivia/util.h"
+#include "tt_pthread.h"
+
+#ifndef sigev_notify_thread_id
+# define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+#if defined(__x86_64__)
+# define SAMPLER_CONTEXT_PC(uc) ((void *)(uc)->uc_mcontext.gregs[REG_RIP])
+# define SAMPLER_CONTEXT_FP(uc) ((void **)(uc)->uc_mcontext.gregs[REG_RBP])
+#elif defined(__aarch64__)
+# define SAMPLER_CONTEXT_PC(uc) ((void *)(uc)->uc_mcontext.pc)
+# define SAMPLER_CONTEXT_FP(uc) ((void **)(uc)->uc_mcontext.regs[29])
+#endif
+
+static struct {
+	/** Preallocated sample buffer. */
+	struct sampler_sample *samples;
+	/** Number of samples stored in the buffer. */
+	volatile int sample_count;
+	/** Number of samples dropped because the buffer was full. */
+	int64_t dropped_count;
+	/** Timer sending SIGPROF to the profiled thread. */
+	timer_t timer;
+	/** SIGPROF action set before the profiler was started. */
+	struct sigaction old_action;
+	/**
+	 * Stack of the profiled thread, used for unwinding the
+	 * scheduler fiber, which doesn't have a stack of its own.
+	 */
+	const char *thread_stack;
+	/** Size of the stack of the profiled thread. */
+	size_t thread_stack_size;
+	/** True if the profiler is running. */
+	bool is_running;
+} sampler;
+
+/**
+ * Collect the stack of the interrupted code by following the frame
+ * pointer chain. It's the only async-signal-safe way to unwind the
+ * stack, so the frames of code compiled without frame pointers are
+ * missed. Every frame pointer is checked to lie on the fiber stack
+ * above the previous one before it's dereferenced.
+ */
+static void
+sampler_collect_stack(struct backtrace *bt, const ucontext_t *uc,
+		      const char *stack, size_t stack_size)
+{
+	int count = 0;
+	bt->frames[count++].ip = SAMPLER_CONTEXT_PC(uc);
+	void **fp = SAMPLER_CONTEXT_FP(uc);
+	while (count < BACKTRACE_FRAME_COUNT_MAX &&
+	       (const char *)fp >= stack &&
+	       (const char *)(fp + 2) <= stack + stack_size &&
+	       (uintptr_t)fp % sizeof(*fp) == 0) {
+		void *ip = fp[1];
+		if (ip == NULL)
+			break;
+		bt->frames[count++].ip = ip;
+		void **next_fp = (void **)fp[0];
+		if (next_fp <= fp)
+			break;
+		fp = next_fp;
+	}
+	bt->frame_count = count;
+}
+
+static void
+sampler_signal_cb(int signo, siginfo_t *info, void *context)
+{
+	(void)signo;
+	(void)info;
+	int i = sampler.sample_count;
+	if (i >= SAMPLER_SAMPLE_COUNT_MAX) {
+		sampler.dropped_count++;
+		return;
+	}
+	struct sampler_sample *sample = &sampler.samples[i];
+	struct fiber *f = fiber();
+	sample->fid = f->fid;
+	if (f->stack != NULL) {
+		sampler_collect_stack(&sample->bt, context, f->stack,
+				      f->stack_size);
+	} else {
+		sampler_collect_stack(&sample->bt, context,
+				      sampler.thread_stack,
+				      sampler.thread_stack_size);
+	}
+	/* Publish the sample only after it is written. */
+	__atomic_signal_fence(__ATOMIC_RELEASE);
+	sampler.sample_count = i + 1;
+}
+
+int
+sampler_start(double interval)
+{
+	assert(interval > 0);
+	if (sampler.is_running)
+		sampler_stop();
+	/*
+	 * Don't override a SIGPROF handler set by another profiler,
+	 * e.g. LuaJIT sysprof: it would stop working silently.
+	 */
+	struct sigaction old_action;
+	if (sigaction(SIGPROF, NULL, &old_action) != 0) {
+		diag_set(SystemError, "failed to get SIGPROF handler");
+		return -1;
+	}
+	if ((old_action.sa_flags & SA_SIGINFO) != 0 ||
+	    (old_action.sa_handler != SIG_DFL &&
+	     old_action.sa_handler != SIG_IGN)) {
+		diag_set(IllegalParams, "SIGPROF is used by another profiler");
+		return -1;
+	}
+	if (sampler.samples == NULL) {
+		sampler.samples = malloc(SAMPLER_SAMPLE_COUNT_MAX *
+					 sizeof(*sampler.samples));
+		if (sampler.samples == NULL) {
+			diag_set(OutOfMemory, SAMPLER_SAMPLE_COUNT_MAX *
+				 sizeof(*sampler.samples), "malloc",
+				 "sampler.samples");
+			return -1;
+		}
+	}
+	sampler.sample_count = 0;
+	sampler.dropped_count = 0;
+	void *thread_stack;
+	tt_pthread_attr_getstack(pthread_self(), &thread_stack,
+				 &sampler.thread_stack_size);
+	sampler.thread_stack = thread_stack;
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = sampler_signal_cb;
+	action.sa_flags = SA_RESTART | SA_SIGINFO;
+	sigemptyset(&action.sa_mask);
+	if (sigaction(SIGPROF, &action, &sampler.old_action) != 0) {
+		diag_set(SystemError, "failed to set SIGPROF handler");
+		return -1;
+	}
+	struct sigevent event;
+	memset(&event, 0, sizeof(event));
+	event.sigev_notify = SIGEV_THREAD_ID;
+	event.sigev_signo = SIGPROF;
+	event.sigev_notify_thread_id = syscall(SYS_gettid);
+	if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event,
+			 &sampler.timer) != 0) {
+		diag_set(SystemError, "failed to create sampler timer");
+		goto fail_restore_action;
+	}
+	struct itimerspec spec;
+	spec.it_interval.tv_sec = (time_t)interval;
+	spec.it_interval.tv_nsec = (interval - (time_t)interval) * 1e9;
+	if (spec.it_interval.tv_sec == 0 && spec.it_interval.tv_nsec == 0)
+		spec.it_interval.tv_nsec = 1;
+	spec.it_value = spec.it_interval;
+	if (timer_settime(sampler.timer, 0, &spec, NULL) != 0) {
+		diag_set(SystemError, "failed to start sampler timer");
+		goto fail_delete_timer;
+	}
+	sampler.is_running = true;
+	return 0;
+fail_delete_timer:
+	timer_delete(sampler.timer);
+fail_restore_action:
+	sigaction(SIGPROF, &sampler.old_action, NULL);
+	return -1;
+}
+
+void
+sampler_stop(void)
+{
+	if (!sampler.is_running)
+		return;
+	/*
+	 * A signal sent before the timer is deleted may be still
+	 * pending. Block and discard it before restoring the old
+	 * action, which may be the default one killing the process.
+	 */
+	sigset_t set, old_set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGPROF);
+	pthread_sigmask(SIG_BLOCK, &set, &old_set);
+	timer_delete(sampler.timer);
+	struct timespec timeout = {0, 0};
+	while (sigtimedwait(&set, NULL, &timeout) == SIGPROF)
+		;
+	sigaction(SIGPROF, &sampler.old_action, NULL);
+	pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+	sampler.is_running = false;
+}
+
+bool
+sampler_is_running(void)
+{
+	return sampler.is_running;
+}
+
+int64_t
+sampler_dropped_count(void)
+{
+	return sampler.dropped_count;
+}
+
+void
+sampler_foreach(sampler_sample_f cb, void *arg)
+{
+	int count = sampler.sample_count;
+	__atomic_signal_fence(__ATOMIC_ACQUIRE);
+	for (int i = 0; i < count; i++)
+		cb(&sampler.samples[i], arg);
+}
+
+#endif /* ENABLE_FIBER_SAMPLER */
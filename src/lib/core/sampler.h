@@ -0,0 +1,91 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include "trivia/config.h"
+
+#if defined(ENABLE_BACKTRACE) && defined(__linux__) && \
+    (defined(__x86_64__) || defined(__aarch64__))
+# define ENABLE_FIBER_SAMPLER 1
+#endif
+
+#ifdef ENABLE_FIBER_SAMPLER
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "core/backtrace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Sampling profiler of the native stacks of fibers. When started,
+ * it interrupts the calling thread with SIGPROF each time the thread
+ * consumes the given amount of CPU time and records the stack and
+ * the fiber that was running. Since the timer counts CPU time of the
+ * thread, an idle thread isn't interrupted at all.
+ *
+ * Samples are stored in a buffer preallocated on start, so nothing
+ * is allocated in the signal handler. When the buffer is full, new
+ * samples are dropped and counted. The signal handler only follows
+ * the frame pointer chain of the interrupted code, so frames of code
+ * compiled without frame pointers are missing from the samples.
+ *
+ * The profiler uses SIGPROF so it can't work together with other
+ * profilers relying on the same signal, like LuaJIT sysprof. It
+ * refuses to start if a SIGPROF handler is already set.
+ */
+
+enum {
+	/** Maximal number of samples stored by the profiler. */
+	SAMPLER_SAMPLE_COUNT_MAX = 10000,
+};
+
+/** Stack of a fiber captured by the profiler. */
+struct sampler_sample {
+	/** Id of the fiber that was running. */
+	uint64_t fid;
+	/** Native stack, the innermost frame first. */
+	struct backtrace bt;
+};
+
+/**
+ * Start sampling the current thread every @a interval seconds of its
+ * CPU time. The samples collected by the previous run are discarded.
+ * Returns 0 on success, -1 on error (diag is set).
+ */
+int
+sampler_start(double interval);
+
+/** Stop sampling. The collected samples are kept. */
+void
+sampler_stop(void);
+
+/** Check if the profiler is running. */
+bool
+sampler_is_running(void);
+
+/** Number of samples dropped because the buffer was full. */
+int64_t
+sampler_dropped_count(void);
+
+typedef void
+(*sampler_sample_f)(const struct sampler_sample *sample, void *arg);
+
+/**
+ * Call @a cb for each collected sample. May be called while the
+ * profiler is running, from the profiled thread only.
+ */
+void
+sampler_foreach(sampler_sample_f cb, void *arg);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* ENABLE_FIBER_SAMPLER */
@@ -47,6 +47,7 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
+#include <poll.h>
 #include <coio_task.h>
 
 pid_t log_pid = 0;
@@ -672,6 +673,8 @@ log_create(struct log *log, const char *init_str, int nonblock)
 	log->format_func = say_format_plain;
 	log->level = S_INFO;
 	log->rotating_threads = 0;
+	log->async = NULL;
+	log->dropped = 0;
 	tt_pthread_mutex_init(&log->rotate_mutex, NULL);
 	tt_pthread_cond_init(&log->rotate_cond, NULL);
 	setvbuf(stderr, NULL, _IONBF, 0);
@@ -765,6 +768,25 @@ say_logger_init(const char *init_str, int level, int nonblock,
 	panic("failed to initialize logging subsystem");
 }
 
+int
+say_logger_start_async(void)
+{
+	assert(say_logger_initialized());
+	return log_start_async(log_default);
+}
+
+void
+say_logger_flush(void)
+{
+	log_async_flush(log_default);
+}
+
+void
+say_logger_stat(uint64_t *dropped, size_t *pending)
+{
+	log_async_stat(log_default, dropped, pending);
+}
+
 int
 say_set_background(void)
 {
@@ -1046,6 +1068,261 @@ safe_write(int fd, const char *buf, int size)
 	return write(fd, buf, MIN(size, SAY_BUF_LEN_MAX - 1));
 }
 
+/** {{{ Asynchronous writer */
+
+enum {
+	/** Size of the buffer of an asynchronous log writer. */
+	LOG_ASYNC_BUF_SIZE = 1024 * 1024,
+};
+
+/**
+ * Asynchronous log writer: a ring buffer of formatted messages
+ * drained by a dedicated thread, see log_start_async().
+ */
+struct log_async {
+	/** The ring buffer. */
+	char *buf;
+	/**
+	 * Offsets of the first byte not written to the log output
+	 * and of the end of the last queued message. The offsets grow
+	 * monotonically and are wrapped by the buffer size on access.
+	 */
+	size_t rpos;
+	size_t wpos;
+	/** Set when the thread is supposed to exit. */
+	bool is_stopped;
+	/** Protects all members above. */
+	pthread_mutex_t mutex;
+	/** Signaled when a message is queued or the writer stops. */
+	pthread_cond_t write_cond;
+	/** Signaled when the thread frees some space in the buffer. */
+	pthread_cond_t space_cond;
+	/** The thread writing the buffer to the log output. */
+	pthread_t thread;
+	/** The log written by the thread. */
+	struct log *log;
+	/** Link in log_async_list. */
+	struct rlist in_async_list;
+};
+
+/** Asynchronous writers of all logs, see log_async_atfork_child(). */
+static RLIST_HEAD(log_async_list);
+
+/**
+ * Write data to a log output. If the output is non-blocking,
+ * wait until it's writable rather than drop the data, because
+ * the caller is the writer thread, which may block.
+ */
+static void
+log_async_write_fd(int fd, const char *data, size_t size)
+{
+	while (size > 0) {
+		ssize_t r = write(fd, data, size);
+		if (r >= 0) {
+			data += r;
+			size -= r;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+			(void)poll(&pfd, 1, -1);
+		} else if (errno != EINTR) {
+			return;
+		}
+	}
+}
+
+static void *
+log_async_f(void *arg)
+{
+	struct log *log = arg;
+	struct log_async *async = log->async;
+	tt_pthread_mutex_lock(&async->mutex);
+	while (true) {
+		while (async->rpos == async->wpos && !async->is_stopped)
+			tt_pthread_cond_wait(&async->write_cond,
+					     &async->mutex);
+		if (async->rpos == async->wpos)
+			break;
+		size_t begin = async->rpos % LOG_ASYNC_BUF_SIZE;
+		size_t size = MIN(async->wpos - async->rpos,
+				  LOG_ASYNC_BUF_SIZE - begin);
+		tt_pthread_mutex_unlock(&async->mutex);
+		log_async_write_fd(log->fd, async->buf + begin, size);
+		tt_pthread_mutex_lock(&async->mutex);
+		async->rpos += size;
+		tt_pthread_cond_broadcast(&async->space_cond);
+	}
+	tt_pthread_mutex_unlock(&async->mutex);
+	return NULL;
+}
+
+/**
+ * Queue a message for writing by the asynchronous writer. If there
+ * isn't enough space in the buffer, drop the message if the log
+ * is non-blocking, otherwise wait for the writer to free space.
+ */
+static void
+log_async_write(struct log *log, const char *data, size_t size)
+{
+	struct log_async *async = log->async;
+	assert(size < LOG_ASYNC_BUF_SIZE);
+	tt_pthread_mutex_lock(&async->mutex);
+	while (LOG_ASYNC_BUF_SIZE - (async->wpos - async->rpos) < size) {
+		if (log->nonblock) {
+			tt_pthread_mutex_unlock(&async->mutex);
+			pm_atomic_fetch_add(&log->dropped, 1);
+			return;
+		}
+		tt_pthread_cond_wait(&async->space_cond, &async->mutex);
+	}
+	size_t begin = async->wpos % LOG_ASYNC_BUF_SIZE;
+	size_t head = MIN(size, LOG_ASYNC_BUF_SIZE - begin);
+	memcpy(async->buf + begin, data, head);
+	memcpy(async->buf, data + head, size - head);
+	async->wpos += size;
+	tt_pthread_cond_signal(&async->write_cond);
+	tt_pthread_mutex_unlock(&async->mutex);
+}
+
+/** Wait until all queued messages are written to the log output. */
+static void
+log_async_flush(struct log *log)
+{
+	struct log_async *async = log->async;
+	if (async == NULL)
+		return;
+	tt_pthread_mutex_lock(&async->mutex);
+	while (async->rpos != async->wpos)
+		tt_pthread_cond_wait(&async->space_cond, &async->mutex);
+	tt_pthread_mutex_unlock(&async->mutex);
+}
+
+static void
+log_async_stat(struct log *log, uint64_t *dropped, size_t *pending)
+{
+	*dropped = pm_atomic_load(&log->dropped);
+	*pending = 0;
+	struct log_async *async = log->async;
+	if (async == NULL)
+		return;
+	tt_pthread_mutex_lock(&async->mutex);
+	*pending = async->wpos - async->rpos;
+	tt_pthread_mutex_unlock(&async->mutex);
+}
+
+/** Free an asynchronous writer which thread isn't running. */
+static void
+log_async_delete(struct log_async *async)
+{
+	assert(async->log->async == async);
+	async->log->async = NULL;
+	rlist_del_entry(async, in_async_list);
+	tt_pthread_cond_destroy(&async->space_cond);
+	tt_pthread_cond_destroy(&async->write_cond);
+	tt_pthread_mutex_destroy(&async->mutex);
+	free(async->buf);
+	free(async);
+}
+
+/**
+ * Called before fork(). Keep the writers locked until the fork is
+ * done so that the child gets their buffers in a consistent state.
+ * Don't wait for queued messages to be written: the log may be a
+ * pipe that nobody reads.
+ */
+static void
+log_async_atfork_prepare(void)
+{
+	struct log_async *async;
+	rlist_foreach_entry(async, &log_async_list, in_async_list)
+		tt_pthread_mutex_lock(&async->mutex);
+}
+
+/** Called in the parent after fork(). */
+static void
+log_async_atfork_parent(void)
+{
+	struct log_async *async;
+	rlist_foreach_entry(async, &log_async_list, in_async_list)
+		tt_pthread_mutex_unlock(&async->mutex);
+}
+
+/**
+ * Called in the child after fork(), e.g. on daemonizing. Threads
+ * don't survive fork(), so restart the writers. Messages queued
+ * before the fork are dropped, because the parent writes them. If
+ * a writer can't be restarted, its log falls back to synchronous
+ * writes.
+ */
+static void
+log_async_atfork_child(void)
+{
+	struct log_async *async, *tmp;
+	rlist_foreach_entry_safe(async, &log_async_list, in_async_list,
+				 tmp) {
+		async->rpos = async->wpos;
+		tt_pthread_mutex_init(&async->mutex, NULL);
+		tt_pthread_cond_init(&async->write_cond, NULL);
+		tt_pthread_cond_init(&async->space_cond, NULL);
+		if (tt_pthread_create(&async->thread, NULL, log_async_f,
+				      async->log) != 0)
+			log_async_delete(async);
+	}
+}
+
+int
+log_start_async(struct log *log)
+{
+	static bool is_atfork_set;
+	if (log->async != NULL)
+		return 0;
+	if (log->type != SAY_LOGGER_FILE && log->type != SAY_LOGGER_PIPE &&
+	    log->type != SAY_LOGGER_STDERR)
+		return 0;
+	if (!is_atfork_set) {
+		tt_pthread_atfork(log_async_atfork_prepare,
+				  log_async_atfork_parent,
+				  log_async_atfork_child);
+		is_atfork_set = true;
+	}
+	struct log_async *async = xmalloc(sizeof(*async));
+	async->buf = xmalloc(LOG_ASYNC_BUF_SIZE);
+	async->rpos = 0;
+	async->wpos = 0;
+	async->is_stopped = false;
+	tt_pthread_mutex_init(&async->mutex, NULL);
+	tt_pthread_cond_init(&async->write_cond, NULL);
+	tt_pthread_cond_init(&async->space_cond, NULL);
+	async->log = log;
+	log->async = async;
+	rlist_add_tail_entry(&log_async_list, async, in_async_list);
+	if (tt_pthread_create(&async->thread, NULL, log_async_f, log) != 0) {
+		log_async_delete(async);
+		diag_set(SystemError, "failed to start log writer thread");
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Stop the asynchronous writer of a log, if any, after writing all
+ * queued messages. Further messages are written synchronously.
+ */
+static void
+log_stop_async(struct log *log)
+{
+	struct log_async *async = log->async;
+	if (async == NULL)
+		return;
+	tt_pthread_mutex_lock(&async->mutex);
+	async->is_stopped = true;
+	tt_pthread_cond_signal(&async->write_cond);
+	tt_pthread_mutex_unlock(&async->mutex);
+	tt_pthread_join(async->thread, NULL);
+	log_async_delete(async);
+}
+
+/** }}} Asynchronous writer */
+
 /**
  * Common part of say_default() and say_from_lua().
  */
@@ -1125,14 +1402,24 @@ log_write_flightrec_from_lua(int level, const char *filename, int line, ...)
  * File and pipe logger
  */
 static void
-write_to_file(struct log *log, int total)
+write_to_file(struct log *log, int level, int total)
 {
 	assert(log->type == SAY_LOGGER_FILE ||
 	       log->type == SAY_LOGGER_PIPE ||
 	       log->type == SAY_LOGGER_STDERR);
 	assert(total >= 0);
+	if (log->async != NULL) {
+		if (level != S_FATAL) {
+			log_async_write(log, say_buf,
+					MIN(total, SAY_BUF_LEN_MAX - 1));
+			return;
+		}
+		/* The process is about to die, write everything now. */
+		log_async_flush(log);
+	}
 	ssize_t r = safe_write(log->fd, say_buf, total);
-	(void) r;                               /* silence gcc warning */
+	if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		pm_atomic_fetch_add(&log->dropped, 1);
 }
 
 /**
@@ -1314,6 +1601,7 @@ void
 log_destroy(struct log *log)
 {
 	assert(log != NULL);
+	log_stop_async(log);
 	tt_pthread_mutex_lock(&log->rotate_mutex);
 	while(log->rotating_threads > 0)
 		tt_pthread_cond_wait(&log->rotate_cond, &log->rotate_mutex);
@@ -1372,12 +1660,20 @@ log_vsay(struct log *log, int level, bool check_level, const char *module,
 	switch (log->type) {
 	case SAY_LOGGER_FILE:
 	case SAY_LOGGER_PIPE:
-		write_to_file(log, total);
+		write_to_file(log, level, total);
 		break;
 	case SAY_LOGGER_STDERR:
+		/*
+		 * The callbacks are useless if the message is written
+		 * later by the asynchronous writer.
+		 */
+		if (log->async != NULL) {
+			write_to_file(log, level, total);
+			break;
+		}
 		if (before_stderr_callback != NULL)
 			before_stderr_callback();
-		write_to_file(log, total);
+		write_to_file(log, level, total);
 		if (after_stderr_callback != NULL)
 			after_stderr_callback();
 		break;
@@ -151,6 +151,7 @@ enum syslog_facility {
 };
 
 struct log;
+struct log_async;
 
 typedef int (*log_format_func_t)(struct log *log, char *buf, int len, int level,
 				 const char *module, const char *filename,
@@ -191,6 +192,13 @@ struct log {
 	pthread_cond_t rotate_cond;
 	enum syslog_facility syslog_facility;
 	struct rlist in_log_list;
+	/** Asynchronous writer or NULL, see log_start_async(). */
+	struct log_async *async;
+	/**
+	 * Number of messages dropped because the log output
+	 * couldn't keep up. Updated atomically.
+	 */
+	uint64_t dropped;
 };
 
 /**
@@ -207,6 +215,25 @@ log_create(struct log *log, const char *init_str, int nonblock);
 void
 log_destroy(struct log *log);
 
+/**
+ * Start writing a log in a separate thread. Messages are copied
+ * to a buffer and written by the thread so that a slow log output
+ * doesn't stall the caller. If the buffer is full, a message is
+ * dropped if the log is non-blocking, otherwise the caller waits
+ * for the thread to free some space. Fatal messages are written
+ * synchronously after the buffer is flushed.
+ *
+ * Only file, pipe and stderr loggers can be asynchronous. For other
+ * loggers the function does nothing. The writer is restarted in
+ * the child process after fork(), so the log may be made
+ * asynchronous before daemonizing.
+ *
+ * @return 0 on success, -1 on system error, the error is saved in
+ * the diagnostics area
+ */
+int
+log_start_async(struct log *log);
+
 /** A utility function to handle va_list from different varargs functions. */
 int
 log_vsay(struct log *log, int level, bool check_level, const char *module,
@@ -338,6 +365,28 @@ say_set_background(void);
 bool
 say_logger_initialized(void);
 
+/**
+ * Make the default logger asynchronous, see log_start_async().
+ * Should be called after say_logger_init.
+ */
+int
+say_logger_start_async(void);
+
+/**
+ * Wait until the asynchronous writer of the default logger writes
+ * all queued messages.
+ */
+void
+say_logger_flush(void);
+
+/**
+ * Get statistics of the default logger: the number of dropped
+ * messages and the size of messages waiting to be written by the
+ * asynchronous writer, in bytes.
+ */
+void
+say_logger_stat(uint64_t *dropped, size_t *pending);
+
 /** Free default logger */
 void
 say_logger_free(void);
@@ -0,0 +1,31 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+/**
+ * User-level statically defined tracing (USDT) probes. A probe is
+ * compiled to a single nop instruction and a note in the ELF file
+ * describing its location and arguments. Tracers like bpftrace,
+ * SystemTap or perf attach to probes by name, so unlike function
+ * symbols the probes are stable between releases. The probes are
+ * listed in tools/usdt/README.md.
+ *
+ * All probes belong to the "tarantool" provider, e.g.:
+ *
+ *   bpftrace -e 'usdt:./tarantool:tarantool:wal_write_done { ... }'
+ *
+ * Arguments must be integers or pointers. They are computed even
+ * when no tracer is attached, so they should be cheap.
+ */
+
+#include "trivia/config.h"
+
+#if defined(ENABLE_USDT)
+# include <sys/sdt.h>
+# define USDT_PROBE(name, ...) STAP_PROBEV(tarantool, name, ##__VA_ARGS__)
+#else /* !defined(ENABLE_USDT) */
+# define USDT_PROBE(name, ...) do {} while (0)
+#endif /* !defined(ENABLE_USDT) */
@@ -117,6 +117,61 @@ csv_setopt(struct csv *csv, int opt, ...)
 	va_end(args);
 }
 
+/**
+ * Return the end of a run of ordinary characters starting at @a p,
+ * i.e. the first character which may change the parser state. In
+ * quotes it's only the quote character, so memchr() is used, which
+ * scans the input a word or a vector register at a time.
+ */
+static inline const char *
+csv_skip_ordinary(const struct csv *csv, const char *p, const char *end,
+		  bool in_quotes)
+{
+	if (in_quotes) {
+		const char *q = memchr(p, csv->quote_char, end - p);
+		return q != NULL ? q : end;
+	}
+	for (; p != end; p++) {
+		char c = *p;
+		if (c == csv->delimiter || c == csv->quote_char ||
+		    c == '\n' || c == '\r' || c == ' ')
+			break;
+	}
+	return p;
+}
+
+/**
+ * Copy a run of ordinary characters starting at @a p to the field
+ * buffer in one go instead of going through the state machine for
+ * each of them.
+ * @return the last copied character or NULL on memory error.
+ */
+static const char *
+csv_copy_ordinary(struct csv *csv, const char *p, const char *end,
+		  bool in_quotes)
+{
+	const char *q = csv_skip_ordinary(csv, p + 1, end, in_quotes);
+	size_t len = q - p;
+	size_t used = csv->bufp - csv->buf;
+	if (csv->buf_len < used + len + 1) {
+		size_t new_size = csv->buf_len;
+		while (new_size < used + len + 1)
+			new_size *= 2;
+		char *new_buf = (char *)csv->realloc(csv->buf, new_size);
+		if (new_buf == NULL) {
+			csv->error_status = CSV_ER_MEMORY_ERROR;
+			return NULL;
+		}
+		csv->buf_len = new_size;
+		csv->bufp = new_buf + used;
+		csv->buf = new_buf;
+	}
+	memcpy(csv->bufp, p, len);
+	csv->bufp += len;
+	csv->prev_symbol = q[-1];
+	return q - 1;
+}
+
 /**
   * both of methods (emitting and iterating) are implementing by one function
   * firstonly == true means iteration method.
@@ -205,8 +260,12 @@ csv_parse_impl(struct csv *csv, const char *s, const char *end, bool firstonly)
 
 			} else if (*p == csv->quote_char) {
 				csv->state = CSV_QUOTE_OPENING;
-			} else {
+			} else if (*p == ' ') {
 				*csv->bufp++ = *p;
+			} else {
+				p = csv_copy_ordinary(csv, p, end, false);
+				if (p == NULL)
+					return NULL;
 			}
 
 			if (*p == ' ') {
@@ -250,7 +309,9 @@ csv_parse_impl(struct csv *csv, const char *s, const char *end, bool firstonly)
 			if (*p == csv->quote_char) {
 				csv->state = CSV_QUOTE_CLOSING;
 			} else {
-				*csv->bufp++ = *p;
+				p = csv_copy_ordinary(csv, p, end, true);
+				if (p == NULL)
+					return NULL;
 			}
 			break;
 		case CSV_NEWFIELD:
@@ -37,6 +37,7 @@
 #include <assert.h>
 #include <stdio.h> /* printf */
 #include "small/matras.h"
+#include "trivia/util.h"
 
 /* {{{ BPS-tree description */
 /**
@@ -175,6 +176,8 @@
  * bool bps_tree_view_iterator_next(view, itr);
  * bool bps_tree_iterator_prev(tree, itr);
  * bool bps_tree_view_iterator_prev(view, itr);
+ * size_t bps_tree_iterator_distance(tree, itr1, itr2);
+ * size_t bps_tree_view_iterator_distance(view, itr1, itr2);
  */
 /* }}} */
 
@@ -314,6 +317,25 @@
  * #define BPS_BLOCK_LINEAR_SEARCH
  */
 
+/**
+ * Optional functions that enable interpolation search of a key in
+ * a block. BPS_TREE_KEY_INTERPOLATION_HINT(key, arg) and
+ * BPS_TREE_ELEM_INTERPOLATION_HINT(elem, arg) must return uint64_t
+ * values that don't decrease along with the elements (and keys) order,
+ * or UINT64_MAX if there's no such value. If both are defined, the
+ * tree guesses the position of a key in a block from the hints of the
+ * first and the last elements of the block, checks the guess with a
+ * couple of comparisons and falls back on binary search in the whole
+ * block if the guess turns out to be wrong. It makes lookups touch
+ * only one or two cache lines per block if the hints are distributed
+ * uniformly, e.g. if the keys are generated by a sequence.
+ */
+#if defined(BPS_TREE_KEY_INTERPOLATION_HINT) != \
+    defined(BPS_TREE_ELEM_INTERPOLATION_HINT)
+#error "BPS_TREE_KEY_INTERPOLATION_HINT and \
+BPS_TREE_ELEM_INTERPOLATION_HINT must be defined together"
+#endif
+
 /**
  * A switch that enables collection of executions of different
  * branches of code. Used only for debug purposes, I hope you
@@ -432,6 +454,9 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_iterator_prev_impl _bps_tree(iterator_prev)
 #define bps_tree_iterator_prev _api_name(iterator_prev)
 #define bps_tree_view_iterator_prev _api_name(view_iterator_prev)
+#define bps_tree_iterator_distance_impl _bps_tree(iterator_distance)
+#define bps_tree_iterator_distance _api_name(iterator_distance)
+#define bps_tree_view_iterator_distance _api_name(view_iterator_distance)
 #define bps_tree_debug_check _api_name(debug_check)
 #define bps_tree_print _api_name(print)
 #define bps_tree_debug_check_internal_functions \
@@ -449,6 +474,8 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_restore_block _bps_tree(restore_block)
 #define bps_tree_root _bps_tree(root)
 #define bps_tree_touch_block _bps_tree(touch_block)
+#define bps_tree_prefetch_block _bps_tree(prefetch_block)
+#define bps_tree_interpolate_key _bps_tree(interpolate_key)
 #define bps_tree_find_ins_point_key _bps_tree(find_ins_point_key)
 #define bps_tree_find_ins_point_elem _bps_tree(find_ins_point_elem)
 #define bps_tree_find_after_ins_point_key _bps_tree(find_after_ins_point_key)
@@ -1059,6 +1086,38 @@ static inline bool
 bps_tree_view_iterator_prev(const struct bps_tree_view *view,
 			    struct bps_tree_iterator *itr);
 
+/**
+ * @brief Count elements between two iterators: from the element pointed
+ *  by the first iterator (inclusive) to the element pointed by the second
+ *  one (exclusive). An invalid second iterator stands for the end of the
+ *  tree. The second iterator must not precede the first one.
+ *  Whole leaves are skipped without looking at the elements so the
+ *  complexity is O(count / BPS_TREE_name_MAX_COUNT_IN_LEAF).
+ * @param tree - pointer to a tree
+ * @param itr1 - pointer to the first tree iterator
+ * @param itr2 - pointer to the second tree iterator
+ * @return - number of elements between the iterators
+ */
+static inline size_t
+bps_tree_iterator_distance(const struct bps_tree *tree,
+			   struct bps_tree_iterator *itr1,
+			   struct bps_tree_iterator *itr2);
+
+/**
+ * @brief Count elements between two iterators: from the element pointed
+ *  by the first iterator (inclusive) to the element pointed by the second
+ *  one (exclusive). An invalid second iterator stands for the end of the
+ *  tree. The second iterator must not precede the first one.
+ * @param view - pointer to a tree view
+ * @param itr1 - pointer to the first tree view iterator
+ * @param itr2 - pointer to the second tree view iterator
+ * @return - number of elements between the iterators
+ */
+static inline size_t
+bps_tree_view_iterator_distance(const struct bps_tree_view *view,
+				struct bps_tree_iterator *itr1,
+				struct bps_tree_iterator *itr2);
+
 #ifndef BPS_TREE_NO_DEBUG
 
 /**
@@ -1536,6 +1595,20 @@ bps_tree_restore_block(const struct bps_tree_common *tree,
 						   tree->view, id);
 }
 
+/**
+ * @brief Prefetch a whole block into the CPU cache.
+ * Binary search in a block touches its cache lines in an order that
+ * can't be predicted by the hardware prefetcher, so loading the lines
+ * in parallel is cheaper than taking a cache miss on each search step.
+ */
+static inline void
+bps_tree_prefetch_block(const struct bps_block *block)
+{
+	const char *ptr = (const char *)block;
+	for (size_t i = 0; i < BPS_TREE_BLOCK_SIZE; i += CACHELINE_SIZE)
+		prefetch(ptr + i, 0);
+}
+
 /**
  * @brief Get a pointer to block by it's ID.
  */
@@ -1583,6 +1656,68 @@ bps_tree_random(const struct bps_tree *t, size_t rnd)
 	return leaf->elems + pos;
 }
 
+#ifdef BPS_TREE_KEY_INTERPOLATION_HINT
+/**
+ * @brief Narrow down the range of a sorted array to search the key in
+ * by guessing the key position from the interpolation hints.
+ * The array is split by a predicate that is false for elements < key
+ * and true for elements > key. For elements equal to the key it's
+ * false if @a after is set and true otherwise. On return the first
+ * element for which the predicate is true is within [*begin, *end]
+ * and *end is either the end of the array or an element for which
+ * the predicate is true.
+ * @param tree - pointer to a tree
+ * @param arr - array of elements
+ * @param size - size of the array
+ * @param key - key to find
+ * @param after - predicate switch, see above
+ * @param begin - receives the beginning of the range
+ * @param end - receives the end of the range
+ * @param exact - set to true if an element equal to the key was met
+ */
+static inline void
+bps_tree_interpolate_key(const struct bps_tree_common *tree,
+			 bps_tree_elem_t *arr, size_t size,
+			 bps_tree_key_t key, bool after,
+			 bps_tree_elem_t **begin, bps_tree_elem_t **end,
+			 bool *exact)
+{
+	/* Max distance between the guessed and the checked positions. */
+	enum { WINDOW = 2 };
+	*begin = arr;
+	*end = arr + size;
+	if (size <= 4 * WINDOW)
+		return;
+	uint64_t k = BPS_TREE_KEY_INTERPOLATION_HINT(key, tree->arg);
+	if (k == UINT64_MAX)
+		return;
+	uint64_t lo = BPS_TREE_ELEM_INTERPOLATION_HINT(arr[0], tree->arg);
+	uint64_t hi = BPS_TREE_ELEM_INTERPOLATION_HINT(arr[size - 1],
+						       tree->arg);
+	if (lo == UINT64_MAX || hi == UINT64_MAX || k <= lo || k >= hi)
+		return;
+	size_t guess = (size_t)((double)(k - lo) / (double)(hi - lo) *
+				(double)(size - 1));
+	size_t left = guess > WINDOW ? guess - WINDOW : 0;
+	size_t right = MIN(guess + WINDOW, size - 1);
+	int res = BPS_TREE_COMPARE_KEY(arr[left], key, tree->arg);
+	if (res == 0)
+		*exact = true;
+	if (res > 0 || (res == 0 && !after)) {
+		*end = arr + left;
+		return;
+	}
+	*begin = arr + left + 1;
+	res = BPS_TREE_COMPARE_KEY(arr[right], key, tree->arg);
+	if (res == 0)
+		*exact = true;
+	if (res > 0 || (res == 0 && !after))
+		*end = arr + right;
+	else
+		*begin = arr + right + 1;
+}
+#endif /* BPS_TREE_KEY_INTERPOLATION_HINT */
+
 /**
  * @brief Find the lowest element in sorted array that is >= than the key
  * @param tree - pointer to a tree
@@ -1600,6 +1735,10 @@ bps_tree_find_ins_point_key(const struct bps_tree_common *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_KEY_INTERPOLATION_HINT
+	bps_tree_interpolate_key(tree, arr, size, key, false,
+				 &begin, &end, exact);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -1691,6 +1830,10 @@ bps_tree_find_after_ins_point_key(const struct bps_tree_common *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_KEY_INTERPOLATION_HINT
+	bps_tree_interpolate_key(tree, arr, size, key, true,
+				 &begin, &end, exact);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -1970,6 +2113,7 @@ bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
 		return res;
 	}
 	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_prefetch_block(block);
 	bps_tree_block_id_t block_id = tree->root_id;
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
@@ -1979,6 +2123,7 @@ bps_tree_lower_bound_impl(const struct bps_tree_common *tree,
 						  key, exact);
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 	}
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
@@ -2035,6 +2180,7 @@ bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
 		return res;
 	}
 	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_prefetch_block(block);
 	bps_tree_block_id_t block_id = tree->root_id;
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
@@ -2046,6 +2192,7 @@ bps_tree_upper_bound_impl(const struct bps_tree_common *tree,
 			*exact = true;
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 	}
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
@@ -2104,6 +2251,7 @@ bps_tree_lower_bound_elem_impl(const struct bps_tree_common *tree,
 		return res;
 	}
 	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_prefetch_block(block);
 	bps_tree_block_id_t block_id = tree->root_id;
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
@@ -2113,6 +2261,7 @@ bps_tree_lower_bound_elem_impl(const struct bps_tree_common *tree,
 						   key, exact);
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 	}
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
@@ -2170,6 +2319,7 @@ bps_tree_upper_bound_elem_impl(const struct bps_tree_common *tree,
 		return res;
 	}
 	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_prefetch_block(block);
 	bps_tree_block_id_t block_id = tree->root_id;
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
@@ -2181,6 +2331,7 @@ bps_tree_upper_bound_elem_impl(const struct bps_tree_common *tree,
 			*exact = true;
 		block_id = inner->child_ids[pos];
 		block = bps_tree_restore_block(tree, block_id);
+		bps_tree_prefetch_block(block);
 	}
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
@@ -2416,6 +2567,59 @@ bps_tree_view_iterator_prev(const struct bps_tree_view *view,
 	return bps_tree_iterator_prev_impl(&view->common, itr);
 }
 
+/**
+ * @brief Count elements between two iterators: from the element pointed
+ *  by the first iterator (inclusive) to the element pointed by the second
+ *  one (exclusive). An invalid second iterator stands for the end of the
+ *  tree. The second iterator must not precede the first one.
+ * @param tree - pointer to a tree
+ * @param itr1 - pointer to the first tree iterator
+ * @param itr2 - pointer to the second tree iterator
+ * @return - number of elements between the iterators
+ */
+static inline size_t
+bps_tree_iterator_distance_impl(const struct bps_tree_common *tree,
+				struct bps_tree_iterator *itr1,
+				struct bps_tree_iterator *itr2)
+{
+	struct bps_leaf *leaf = bps_tree_get_leaf_safe(tree, itr1);
+	if (!leaf)
+		return 0;
+	/* Normalize the position, the iterator may become invalid. */
+	bps_tree_get_leaf_safe(tree, itr2);
+	size_t result = 0;
+	bps_tree_block_id_t block_id = itr1->block_id;
+	bps_tree_pos_t pos = itr1->pos;
+	while (block_id != itr2->block_id) {
+		result += leaf->header.size - pos;
+		block_id = leaf->next_id;
+		if (block_id == (bps_tree_block_id_t)(-1))
+			return result;
+		leaf = (struct bps_leaf *)bps_tree_restore_block(tree,
+								 block_id);
+		pos = 0;
+	}
+	if (itr2->pos > pos)
+		result += itr2->pos - pos;
+	return result;
+}
+
+static inline size_t
+bps_tree_iterator_distance(const struct bps_tree *tree,
+			   struct bps_tree_iterator *itr1,
+			   struct bps_tree_iterator *itr2)
+{
+	return bps_tree_iterator_distance_impl(&tree->common, itr1, itr2);
+}
+
+static inline size_t
+bps_tree_view_iterator_distance(const struct bps_tree_view *view,
+				struct bps_tree_iterator *itr1,
+				struct bps_tree_iterator *itr2)
+{
+	return bps_tree_iterator_distance_impl(&view->common, itr1, itr2);
+}
+
 /**
  * @brief Find the first element that is equal to the key (comparator returns 0)
  * @param tree - pointer to a tree
@@ -2428,6 +2632,7 @@ bps_tree_find_impl(const struct bps_tree_common *tree, bps_tree_key_t key)
 	if (tree->root_id == (bps_tree_block_id_t)(-1))
 		return 0;
 	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_prefetch_block(block);
 	bool exact = false;
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
@@ -2436,6 +2641,7 @@ bps_tree_find_impl(const struct bps_tree_common *tree, bps_tree_key_t key)
 						  inner->header.size - 1,
 						  key, &exact);
 		block = bps_tree_restore_block(tree, inner->child_ids[pos]);
+		bps_tree_prefetch_block(block);
 	}
 
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
@@ -6517,6 +6723,9 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_iterator_prev_impl
 #undef bps_tree_iterator_prev
 #undef bps_tree_view_iterator_prev
+#undef bps_tree_iterator_distance_impl
+#undef bps_tree_iterator_distance
+#undef bps_tree_view_iterator_distance
 #undef bps_tree_debug_check
 #undef bps_tree_print
 #undef bps_tree_debug_check_internal_functions
@@ -6533,6 +6742,8 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_restore_block
 #undef bps_tree_root
 #undef bps_tree_touch_block
+#undef bps_tree_prefetch_block
+#undef bps_tree_interpolate_key
 #undef bps_tree_find_ins_point_key
 #undef bps_tree_find_ins_point_elem
 #undef bps_tree_find_after_ins_point_key
@@ -0,0 +1,828 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "hnsw.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "trivia/util.h"
+
+enum {
+	/** Max level of a node. */
+	HNSW_MAX_LEVEL = 16,
+	/** Min number of node slots to allocate. */
+	HNSW_MIN_CAPACITY = 64,
+	/** Min number of deleted nodes to free in bulk. */
+	HNSW_PURGE_MIN = 64,
+};
+
+/** Id of a missing node. */
+#define HNSW_NONE UINT32_MAX
+
+struct hnsw_node {
+	/** Data attached to the vector, NULL if the node is deleted. */
+	void *data;
+	/** Top level of the node. */
+	uint32_t level;
+	/**
+	 * Vector of dimension coordinates followed by the link lists
+	 * of levels from 0 to level. A link list of a level is the
+	 * number of links followed by ids of the linked nodes, space
+	 * is reserved for 2 * m links on level 0 and m links on the
+	 * other levels.
+	 */
+	float vector[0];
+};
+
+/** A node found by a search along with its distance from the query. */
+struct hnsw_candidate {
+	float distance;
+	uint32_t id;
+};
+
+struct hnsw_data_node {
+	void *data;
+	uint32_t id;
+};
+
+#define mh_name _hnsw_data
+#define mh_key_t void *
+#define mh_node_t struct hnsw_data_node
+#define mh_arg_t int
+#if UINTPTR_MAX == 0xffffffff
+#define mh_hash_key(a, arg) ((uintptr_t)(a))
+#else
+#define mh_hash_key(a, arg) ((uint32_t)(((uintptr_t)(a)) >> 33 ^ \
+					 ((uintptr_t)(a)) ^ \
+					 ((uintptr_t)(a)) << 11))
+#endif
+#define mh_hash(a, arg) mh_hash_key((a)->data, arg)
+#define mh_cmp(a, b, arg) ((a)->data != (b)->data)
+#define mh_cmp_key(a, b, arg) ((a) != (b)->data)
+#define MH_SOURCE 1
+#include "salad/mhash.h"
+
+/* {{{ Distance functions */
+
+#if defined(__AVX__)
+static inline float
+hnsw_sum_ps(__m256 v)
+{
+	float buf[8];
+	_mm256_storeu_ps(buf, v);
+	return buf[0] + buf[1] + buf[2] + buf[3] +
+	       buf[4] + buf[5] + buf[6] + buf[7];
+}
+#elif defined(__SSE2__)
+static inline float
+hnsw_sum_ps(__m128 v)
+{
+	float buf[4];
+	_mm_storeu_ps(buf, v);
+	return buf[0] + buf[1] + buf[2] + buf[3];
+}
+#endif
+
+/*
+ * The kernels below process two SIMD words per iteration with separate
+ * accumulators so that additions don't wait for each other.
+ */
+
+static float
+hnsw_dot(const float *a, const float *b, uint32_t dimension)
+{
+	uint32_t i = 0;
+	float sum = 0;
+#if defined(__AVX__)
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	for (; i + 16 <= dimension; i += 16) {
+		acc0 = _mm256_add_ps(acc0,
+				     _mm256_mul_ps(_mm256_loadu_ps(a + i),
+						   _mm256_loadu_ps(b + i)));
+		acc1 = _mm256_add_ps(acc1,
+				     _mm256_mul_ps(_mm256_loadu_ps(a + i + 8),
+						   _mm256_loadu_ps(b + i + 8)));
+	}
+	sum = hnsw_sum_ps(_mm256_add_ps(acc0, acc1));
+#elif defined(__SSE2__)
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	for (; i + 8 <= dimension; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),
+						   _mm_loadu_ps(b + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+						   _mm_loadu_ps(b + i + 4)));
+	}
+	sum = hnsw_sum_ps(_mm_add_ps(acc0, acc1));
+#endif
+	for (; i < dimension; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+/** Squared Euclidean distance. */
+static float
+hnsw_l2_squared(const float *a, const float *b, uint32_t dimension)
+{
+	uint32_t i = 0;
+	float sum = 0;
+#if defined(__AVX__)
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	for (; i + 16 <= dimension; i += 16) {
+		__m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i),
+					  _mm256_loadu_ps(b + i));
+		__m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8),
+					  _mm256_loadu_ps(b + i + 8));
+		acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(d0, d0));
+		acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(d1, d1));
+	}
+	sum = hnsw_sum_ps(_mm256_add_ps(acc0, acc1));
+#elif defined(__SSE2__)
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	for (; i + 8 <= dimension; i += 8) {
+		__m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i),
+				       _mm_loadu_ps(b + i));
+		__m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4),
+				       _mm_loadu_ps(b + i + 4));
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+	}
+	sum = hnsw_sum_ps(_mm_add_ps(acc0, acc1));
+#endif
+	for (; i < dimension; i++) {
+		float d = a[i] - b[i];
+		sum += d * d;
+	}
+	return sum;
+}
+
+static float
+hnsw_l1(const float *a, const float *b, uint32_t dimension)
+{
+	uint32_t i = 0;
+	float sum = 0;
+#if defined(__AVX__)
+	__m256 sign = _mm256_set1_ps(-0.0f);
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	for (; i + 16 <= dimension; i += 16) {
+		__m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i),
+					  _mm256_loadu_ps(b + i));
+		__m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8),
+					  _mm256_loadu_ps(b + i + 8));
+		acc0 = _mm256_add_ps(acc0, _mm256_andnot_ps(sign, d0));
+		acc1 = _mm256_add_ps(acc1, _mm256_andnot_ps(sign, d1));
+	}
+	sum = hnsw_sum_ps(_mm256_add_ps(acc0, acc1));
+#elif defined(__SSE2__)
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	for (; i + 8 <= dimension; i += 8) {
+		__m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i),
+				       _mm_loadu_ps(b + i));
+		__m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4),
+				       _mm_loadu_ps(b + i + 4));
+		acc0 = _mm_add_ps(acc0, _mm_andnot_ps(sign, d0));
+		acc1 = _mm_add_ps(acc1, _mm_andnot_ps(sign, d1));
+	}
+	sum = hnsw_sum_ps(_mm_add_ps(acc0, acc1));
+#endif
+	for (; i < dimension; i++)
+		sum += fabsf(a[i] - b[i]);
+	return sum;
+}
+
+/**
+ * Distance between two vectors stored in the graph. It preserves the
+ * order of the metric, but L2 distance isn't square rooted.
+ */
+static inline float
+hnsw_distance(const struct hnsw *hnsw, const float *a, const float *b)
+{
+	switch (hnsw->metric) {
+	case HNSW_METRIC_L2:
+		return hnsw_l2_squared(a, b, hnsw->dimension);
+	case HNSW_METRIC_L1:
+		return hnsw_l1(a, b, hnsw->dimension);
+	case HNSW_METRIC_COSINE:
+		/* Vectors are normalized, see hnsw_normalize(). */
+		return 1 - hnsw_dot(a, b, hnsw->dimension);
+	case HNSW_METRIC_DOT:
+		return -hnsw_dot(a, b, hnsw->dimension);
+	default:
+		unreachable();
+		return 0;
+	}
+}
+
+/**
+ * Copy a vector to be stored in the graph or used as a query. For
+ * the cosine distance the vector is normalized so that the distance
+ * can be calculated with a single dot product.
+ */
+static void
+hnsw_normalize(const struct hnsw *hnsw, const float *src, float *dst)
+{
+	memcpy(dst, src, hnsw->dimension * sizeof(*dst));
+	if (hnsw->metric != HNSW_METRIC_COSINE)
+		return;
+	float norm = sqrtf(hnsw_dot(dst, dst, hnsw->dimension));
+	if (norm == 0)
+		return;
+	for (uint32_t i = 0; i < hnsw->dimension; i++)
+		dst[i] /= norm;
+}
+
+/* }}} Distance functions */
+
+/* {{{ Nodes */
+
+static inline uint32_t
+hnsw_max_links(const struct hnsw *hnsw, uint32_t level)
+{
+	return level == 0 ? 2 * hnsw->m : hnsw->m;
+}
+
+static inline size_t
+hnsw_node_size(const struct hnsw *hnsw, uint32_t level)
+{
+	return sizeof(struct hnsw_node) +
+	       hnsw->dimension * sizeof(float) +
+	       ((2 * hnsw->m + 1) + level * (hnsw->m + 1)) * sizeof(uint32_t);
+}
+
+/** Link list of a node on a level: number of links, then link ids. */
+static inline uint32_t *
+hnsw_node_links(const struct hnsw *hnsw, struct hnsw_node *node,
+		uint32_t level)
+{
+	assert(level <= node->level);
+	uint32_t *links = (uint32_t *)(node->vector + hnsw->dimension);
+	if (level == 0)
+		return links;
+	return links + (2 * hnsw->m + 1) + (level - 1) * (hnsw->m + 1);
+}
+
+static inline float
+hnsw_node_distance(const struct hnsw *hnsw, uint32_t a, uint32_t b)
+{
+	return hnsw_distance(hnsw, hnsw->nodes[a]->vector,
+			     hnsw->nodes[b]->vector);
+}
+
+/**
+ * Generate a random level of a new node: a node reaches level l with
+ * probability m^-l.
+ */
+static uint32_t
+hnsw_random_level(struct hnsw *hnsw)
+{
+	/* xorshift64* */
+	hnsw->rng ^= hnsw->rng >> 12;
+	hnsw->rng ^= hnsw->rng << 25;
+	hnsw->rng ^= hnsw->rng >> 27;
+	uint64_t r = hnsw->rng * 2685821657736338717ULL;
+	double u = ((r >> 11) + 0.5) / 9007199254740992.0;
+	double level = -log(u) * hnsw->level_mult;
+	return level < HNSW_MAX_LEVEL ? (uint32_t)level : HNSW_MAX_LEVEL;
+}
+
+/**
+ * Make sure there's room for a new node in the node array and the
+ * scratch arrays sized by the number of nodes.
+ */
+static int
+hnsw_reserve(struct hnsw *hnsw)
+{
+	if (hnsw->free_id_count > 0 || hnsw->node_count < hnsw->node_capacity)
+		return 0;
+	uint32_t capacity = MAX(hnsw->node_capacity * 2,
+				(uint32_t)HNSW_MIN_CAPACITY);
+	struct hnsw_node **nodes = (struct hnsw_node **)
+		realloc(hnsw->nodes, capacity * sizeof(*nodes));
+	if (nodes == NULL)
+		return -1;
+	hnsw->nodes = nodes;
+	uint32_t *free_ids = (uint32_t *)
+		realloc(hnsw->free_ids, capacity * sizeof(*free_ids));
+	if (free_ids == NULL)
+		return -1;
+	hnsw->free_ids = free_ids;
+	uint32_t *visited = (uint32_t *)
+		realloc(hnsw->visited, capacity * sizeof(*visited));
+	if (visited == NULL)
+		return -1;
+	memset(visited + hnsw->node_capacity, 0,
+	       (capacity - hnsw->node_capacity) * sizeof(*visited));
+	hnsw->visited = visited;
+	/* Every node visited by a search is pushed to a heap once. */
+	struct hnsw_candidate *candidates = (struct hnsw_candidate *)
+		realloc(hnsw->candidates, capacity * sizeof(*candidates));
+	if (candidates == NULL)
+		return -1;
+	hnsw->candidates = candidates;
+	struct hnsw_candidate *results = (struct hnsw_candidate *)
+		realloc(hnsw->results, capacity * sizeof(*results));
+	if (results == NULL)
+		return -1;
+	hnsw->results = results;
+	hnsw->node_capacity = capacity;
+	return 0;
+}
+
+/* }}} Nodes */
+
+/* {{{ Search */
+
+static void
+hnsw_heap_push(struct hnsw_candidate *heap, uint32_t *size,
+	       float distance, uint32_t id)
+{
+	uint32_t i = (*size)++;
+	while (i > 0) {
+		uint32_t parent = (i - 1) / 2;
+		if (heap[parent].distance <= distance)
+			break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i].distance = distance;
+	heap[i].id = id;
+}
+
+static struct hnsw_candidate
+hnsw_heap_pop(struct hnsw_candidate *heap, uint32_t *size)
+{
+	assert(*size > 0);
+	struct hnsw_candidate top = heap[0];
+	uint32_t n = --*size;
+	if (n == 0)
+		return top;
+	struct hnsw_candidate last = heap[n];
+	uint32_t i = 0;
+	while (true) {
+		uint32_t child = 2 * i + 1;
+		if (child >= n)
+			break;
+		if (child + 1 < n &&
+		    heap[child + 1].distance < heap[child].distance)
+			child++;
+		if (last.distance <= heap[child].distance)
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = last;
+	return top;
+}
+
+static int
+hnsw_candidate_cmp(const void *a, const void *b)
+{
+	float da = ((const struct hnsw_candidate *)a)->distance;
+	float db = ((const struct hnsw_candidate *)b)->distance;
+	return da < db ? -1 : da > db;
+}
+
+/** Start a new search: forget the nodes visited by previous ones. */
+static void
+hnsw_visit_begin(struct hnsw *hnsw)
+{
+	if (++hnsw->visit_mark == 0) {
+		memset(hnsw->visited, 0,
+		       hnsw->node_capacity * sizeof(*hnsw->visited));
+		hnsw->visit_mark = 1;
+	}
+}
+
+/**
+ * Best-first search of the ef nodes nearest to the query on a level
+ * starting from the entry node. If live_only is set, deleted nodes
+ * are traversed but not included in the result. The result is left
+ * in the result heap, which is a max-heap (distances are negated).
+ * Returns the number of the found nodes.
+ */
+static uint32_t
+hnsw_search_level(struct hnsw *hnsw, const float *query, uint32_t entry,
+		  uint32_t ef, uint32_t level, bool live_only)
+{
+	struct hnsw_candidate *candidates = hnsw->candidates;
+	struct hnsw_candidate *results = hnsw->results;
+	uint32_t candidate_count = 0;
+	uint32_t result_count = 0;
+	hnsw_visit_begin(hnsw);
+	hnsw->visited[entry] = hnsw->visit_mark;
+	struct hnsw_node *node = hnsw->nodes[entry];
+	float distance = hnsw_distance(hnsw, query, node->vector);
+	hnsw_heap_push(candidates, &candidate_count, distance, entry);
+	if (!live_only || node->data != NULL)
+		hnsw_heap_push(results, &result_count, -distance, entry);
+	while (candidate_count > 0) {
+		struct hnsw_candidate c = hnsw_heap_pop(candidates,
+							&candidate_count);
+		if (result_count == ef && c.distance > -results[0].distance)
+			break;
+		const uint32_t *links = hnsw_node_links(hnsw, hnsw->nodes[c.id],
+							level);
+		for (uint32_t i = 1; i <= links[0]; i++) {
+			uint32_t id = links[i];
+			if (hnsw->visited[id] == hnsw->visit_mark)
+				continue;
+			hnsw->visited[id] = hnsw->visit_mark;
+			node = hnsw->nodes[id];
+			distance = hnsw_distance(hnsw, query, node->vector);
+			if (result_count == ef &&
+			    distance >= -results[0].distance)
+				continue;
+			hnsw_heap_push(candidates, &candidate_count,
+				       distance, id);
+			if (live_only && node->data == NULL)
+				continue;
+			hnsw_heap_push(results, &result_count, -distance, id);
+			if (result_count > ef)
+				hnsw_heap_pop(results, &result_count);
+		}
+	}
+	return result_count;
+}
+
+/**
+ * Move the nodes found by hnsw_search_level() to an array sorted by
+ * distance, nearest first.
+ */
+static void
+hnsw_sort_results(struct hnsw *hnsw, uint32_t count,
+		  struct hnsw_candidate *sorted)
+{
+	while (count > 0) {
+		struct hnsw_candidate c = hnsw_heap_pop(hnsw->results, &count);
+		c.distance = -c.distance;
+		sorted[count] = c;
+	}
+}
+
+/** Descend from the top level to the given one with greedy search. */
+static uint32_t
+hnsw_descend(struct hnsw *hnsw, const float *query, uint32_t level)
+{
+	uint32_t entry = hnsw->entry;
+	for (uint32_t l = hnsw->max_level; l > level; l--) {
+		hnsw_search_level(hnsw, query, entry, 1, l, false);
+		entry = hnsw->results[0].id;
+	}
+	return entry;
+}
+
+/* }}} Search */
+
+/* {{{ Linking */
+
+/**
+ * Select up to max_count neighbors of a node out of candidates sorted
+ * by distance from it (heuristic from algorithm 4 of the paper): a
+ * candidate is linked only if it's closer to the node than to all the
+ * already selected neighbors, so links go in different directions
+ * rather than to a single dense cluster. The selected candidates are
+ * moved to the beginning of the array. Returns their number.
+ */
+static uint32_t
+hnsw_select_neighbors(struct hnsw *hnsw, struct hnsw_candidate *candidates,
+		      uint32_t count, uint32_t max_count)
+{
+	uint32_t selected = 0;
+	for (uint32_t i = 0; i < count && selected < max_count; i++) {
+		struct hnsw_candidate c = candidates[i];
+		bool good = true;
+		for (uint32_t j = 0; j < selected; j++) {
+			if (hnsw_node_distance(hnsw, c.id,
+					       candidates[j].id) < c.distance) {
+				good = false;
+				break;
+			}
+		}
+		if (good)
+			candidates[selected++] = c;
+	}
+	return selected;
+}
+
+/**
+ * Rebuild the link list of a node on a level out of the candidates
+ * stored in the selection buffer.
+ */
+static void
+hnsw_relink(struct hnsw *hnsw, uint32_t id, uint32_t level, uint32_t count)
+{
+	struct hnsw_candidate *buf = hnsw->select;
+	qsort(buf, count, sizeof(*buf), hnsw_candidate_cmp);
+	count = hnsw_select_neighbors(hnsw, buf, count,
+				      hnsw_max_links(hnsw, level));
+	uint32_t *links = hnsw_node_links(hnsw, hnsw->nodes[id], level);
+	links[0] = count;
+	for (uint32_t i = 0; i < count; i++)
+		links[i + 1] = buf[i].id;
+}
+
+/** Add a link from one node to another, pruning the links if full. */
+static void
+hnsw_add_link(struct hnsw *hnsw, uint32_t from, uint32_t to, uint32_t level)
+{
+	uint32_t *links = hnsw_node_links(hnsw, hnsw->nodes[from], level);
+	if (links[0] < hnsw_max_links(hnsw, level)) {
+		links[++links[0]] = to;
+		return;
+	}
+	struct hnsw_candidate *buf = hnsw->select;
+	uint32_t count = 0;
+	for (uint32_t i = 1; i <= links[0]; i++) {
+		buf[count].id = links[i];
+		buf[count].distance = hnsw_node_distance(hnsw, from, links[i]);
+		count++;
+	}
+	buf[count].id = to;
+	buf[count].distance = hnsw_node_distance(hnsw, from, to);
+	count++;
+	hnsw_relink(hnsw, from, level, count);
+}
+
+/**
+ * Remove the link from a node to a deleted node. The node is relinked
+ * to the best of its remaining links and the live links of the deleted
+ * node so that the part of the graph reachable through the deleted
+ * node stays reachable.
+ */
+static void
+hnsw_unlink(struct hnsw *hnsw, uint32_t from, uint32_t deleted,
+	    uint32_t level)
+{
+	struct hnsw_node *node = hnsw->nodes[from];
+	uint32_t *links = hnsw_node_links(hnsw, node, level);
+	uint32_t i = 1;
+	while (i <= links[0] && links[i] != deleted)
+		i++;
+	if (i > links[0])
+		return;
+	links[i] = links[links[0]--];
+	if (node->data == NULL)
+		return;
+	struct hnsw_candidate *buf = hnsw->select;
+	uint32_t count = 0;
+	for (i = 1; i <= links[0]; i++) {
+		buf[count].id = links[i];
+		buf[count].distance = hnsw_node_distance(hnsw, from, links[i]);
+		count++;
+	}
+	const uint32_t *deleted_links =
+		hnsw_node_links(hnsw, hnsw->nodes[deleted], level);
+	for (i = 1; i <= deleted_links[0]; i++) {
+		uint32_t id = deleted_links[i];
+		if (id == from || hnsw->nodes[id]->data == NULL)
+			continue;
+		uint32_t j = 1;
+		while (j <= links[0] && links[j] != id)
+			j++;
+		if (j <= links[0])
+			continue;
+		buf[count].id = id;
+		buf[count].distance = hnsw_node_distance(hnsw, from, id);
+		count++;
+	}
+	hnsw_relink(hnsw, from, level, count);
+}
+
+/** Remove all links to deleted nodes and free them. */
+static void
+hnsw_purge(struct hnsw *hnsw)
+{
+	for (uint32_t id = 0; id < hnsw->node_count; id++) {
+		struct hnsw_node *node = hnsw->nodes[id];
+		if (node == NULL || node->data == NULL)
+			continue;
+		for (uint32_t l = 0; l <= node->level; l++) {
+			uint32_t *links = hnsw_node_links(hnsw, node, l);
+			uint32_t count = 0;
+			for (uint32_t i = 1; i <= links[0]; i++) {
+				if (hnsw->nodes[links[i]]->data != NULL)
+					links[++count] = links[i];
+			}
+			links[0] = count;
+		}
+	}
+	hnsw->entry = HNSW_NONE;
+	hnsw->max_level = 0;
+	for (uint32_t id = 0; id < hnsw->node_count; id++) {
+		struct hnsw_node *node = hnsw->nodes[id];
+		if (node == NULL)
+			continue;
+		if (node->data == NULL) {
+			hnsw->node_bsize -= hnsw_node_size(hnsw, node->level);
+			free(node);
+			hnsw->nodes[id] = NULL;
+			hnsw->free_ids[hnsw->free_id_count++] = id;
+			continue;
+		}
+		if (hnsw->entry == HNSW_NONE || node->level > hnsw->max_level) {
+			hnsw->entry = id;
+			hnsw->max_level = node->level;
+		}
+	}
+	hnsw->deleted_count = 0;
+}
+
+/* }}} Linking */
+
+/* {{{ API definition */
+
+int
+hnsw_create(struct hnsw *hnsw, uint32_t dimension, enum hnsw_metric metric,
+	    uint32_t m, uint32_t ef_construction)
+{
+	assert(dimension > 0 && dimension <= HNSW_MAX_DIMENSION);
+	assert(metric < hnsw_metric_MAX);
+	assert(m >= 2);
+	memset(hnsw, 0, sizeof(*hnsw));
+	hnsw->dimension = dimension;
+	hnsw->metric = metric;
+	hnsw->m = m;
+	hnsw->ef_construction = MAX(ef_construction, 1);
+	hnsw->level_mult = 1 / log(m);
+	hnsw->entry = HNSW_NONE;
+	hnsw->rng = 0x9E3779B97F4A7C15ULL;
+	/* Links of two nodes on level 0 may be merged by hnsw_unlink(). */
+	hnsw->select = (struct hnsw_candidate *)
+		malloc((4 * m + 1) * sizeof(*hnsw->select));
+	hnsw->query = (float *)malloc(dimension * sizeof(*hnsw->query));
+	if (hnsw->select == NULL || hnsw->query == NULL) {
+		free(hnsw->select);
+		free(hnsw->query);
+		return -1;
+	}
+	hnsw->data_to_id = mh_hnsw_data_new();
+	return 0;
+}
+
+void
+hnsw_destroy(struct hnsw *hnsw)
+{
+	for (uint32_t id = 0; id < hnsw->node_count; id++)
+		free(hnsw->nodes[id]);
+	mh_hnsw_data_delete(hnsw->data_to_id);
+	free(hnsw->nodes);
+	free(hnsw->free_ids);
+	free(hnsw->visited);
+	free(hnsw->candidates);
+	free(hnsw->results);
+	free(hnsw->select);
+	free(hnsw->query);
+}
+
+int
+hnsw_insert(struct hnsw *hnsw, const float *vector, void *data)
+{
+	assert(data != NULL);
+	assert(mh_hnsw_data_find(hnsw->data_to_id, data, 0) ==
+	       mh_end(hnsw->data_to_id));
+	if (hnsw_reserve(hnsw) != 0)
+		return -1;
+	uint32_t level = hnsw_random_level(hnsw);
+	size_t size = hnsw_node_size(hnsw, level);
+	struct hnsw_node *node = (struct hnsw_node *)malloc(size);
+	if (node == NULL)
+		return -1;
+	node->data = data;
+	node->level = level;
+	hnsw_normalize(hnsw, vector, node->vector);
+	for (uint32_t l = 0; l <= level; l++)
+		hnsw_node_links(hnsw, node, l)[0] = 0;
+
+	uint32_t id = hnsw->free_id_count > 0 ?
+		      hnsw->free_ids[--hnsw->free_id_count] :
+		      hnsw->node_count++;
+	hnsw->nodes[id] = node;
+	hnsw->node_bsize += size;
+	hnsw->size++;
+	struct hnsw_data_node entry = {data, id};
+	mh_hnsw_data_put(hnsw->data_to_id, &entry, NULL, 0);
+
+	if (hnsw->size == 1) {
+		/*
+		 * The graph is empty or has only deleted nodes, which
+		 * can't be linked to, so start it anew from this node.
+		 */
+		hnsw->entry = id;
+		hnsw->max_level = level;
+		return 0;
+	}
+	uint32_t start = hnsw_descend(hnsw, node->vector, level);
+	struct hnsw_candidate *found = hnsw->candidates;
+	for (uint32_t l = MIN(level, hnsw->max_level) + 1; l-- > 0; ) {
+		uint32_t count = hnsw_search_level(hnsw, node->vector, start,
+						   hnsw->ef_construction, l,
+						   false);
+		hnsw_sort_results(hnsw, count, found);
+		start = found[0].id;
+		/* Deleted nodes are only good for passing through. */
+		uint32_t live_count = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			if (hnsw->nodes[found[i].id]->data != NULL)
+				found[live_count++] = found[i];
+		}
+		count = hnsw_select_neighbors(hnsw, found, live_count,
+					      hnsw->m);
+		uint32_t *links = hnsw_node_links(hnsw, node, l);
+		links[0] = count;
+		for (uint32_t i = 0; i < count; i++)
+			links[i + 1] = found[i].id;
+		for (uint32_t i = 0; i < count; i++)
+			hnsw_add_link(hnsw, found[i].id, id, l);
+	}
+	if (level > hnsw->max_level) {
+		hnsw->entry = id;
+		hnsw->max_level = level;
+	}
+	return 0;
+}
+
+bool
+hnsw_delete(struct hnsw *hnsw, void *data)
+{
+	mh_int_t k = mh_hnsw_data_find(hnsw->data_to_id, data, 0);
+	if (k == mh_end(hnsw->data_to_id))
+		return false;
+	uint32_t id = mh_hnsw_data_node(hnsw->data_to_id, k)->id;
+	mh_hnsw_data_del(hnsw->data_to_id, k, 0);
+	struct hnsw_node *node = hnsw->nodes[id];
+	node->data = NULL;
+	hnsw->size--;
+	hnsw->deleted_count++;
+	for (uint32_t l = 0; l <= node->level; l++) {
+		const uint32_t *links = hnsw_node_links(hnsw, node, l);
+		for (uint32_t i = 1; i <= links[0]; i++)
+			hnsw_unlink(hnsw, links[i], id, l);
+	}
+	if (hnsw->deleted_count >= HNSW_PURGE_MIN &&
+	    hnsw->deleted_count > hnsw->size)
+		hnsw_purge(hnsw);
+	return true;
+}
+
+uint32_t
+hnsw_search(struct hnsw *hnsw, const float *query, uint32_t k, uint32_t ef,
+	    struct hnsw_neighbor *result)
+{
+	if (hnsw->entry == HNSW_NONE || k == 0)
+		return 0;
+	hnsw_normalize(hnsw, query, hnsw->query);
+	uint32_t start = hnsw_descend(hnsw, hnsw->query, 0);
+	uint32_t count = hnsw_search_level(hnsw, hnsw->query, start,
+					   MAX(ef, k), 0, true);
+	struct hnsw_candidate *found = hnsw->candidates;
+	hnsw_sort_results(hnsw, count, found);
+	count = MIN(count, k);
+	for (uint32_t i = 0; i < count; i++) {
+		float distance = found[i].distance;
+		if (hnsw->metric == HNSW_METRIC_L2)
+			distance = sqrtf(distance);
+		result[i].distance = distance;
+		result[i].data = hnsw->nodes[found[i].id]->data;
+	}
+	return count;
+}
+
+void *
+hnsw_next(const struct hnsw *hnsw, uint32_t *pos)
+{
+	for (; *pos < hnsw->node_count; (*pos)++) {
+		struct hnsw_node *node = hnsw->nodes[*pos];
+		if (node != NULL && node->data != NULL)
+			return hnsw->nodes[(*pos)++]->data;
+	}
+	return NULL;
+}
+
+size_t
+hnsw_bsize(const struct hnsw *hnsw)
+{
+	return hnsw->node_bsize + mh_hnsw_data_memsize(hnsw->data_to_id) +
+	       hnsw->node_capacity * (sizeof(*hnsw->nodes) +
+				      sizeof(*hnsw->free_ids) +
+				      sizeof(*hnsw->visited) +
+				      2 * sizeof(*hnsw->candidates));
+}
+
+/* }}} API definition */
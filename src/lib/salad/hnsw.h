@@ -0,0 +1,214 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+/*
+ * Hierarchical navigable small world graph:
+ *  Malkov, Yu. A.; Yashunin, D. A. (2016),
+ *  "Efficient and robust approximate nearest neighbor search using
+ *  Hierarchical Navigable Small World graphs"
+ *  https://arxiv.org/abs/1603.09320
+ *
+ * The graph stores fixed-dimension float vectors, each attached to an
+ * opaque non-NULL data pointer, and finds vectors approximately nearest
+ * to a query. Every node is present on level 0 and, with exponentially
+ * decreasing probability, on upper levels. A search greedily descends
+ * from the top level to level 0, where it runs a best-first search
+ * with a queue of size ef: the greater ef is, the better the recall and
+ * the slower the search.
+ *
+ * A deleted node stays in the graph as a tombstone so that searches
+ * still can pass through it, and its neighbors are relinked to each
+ * other. Tombstones are freed in bulk when there are more of them than
+ * live nodes.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/** Max vector dimension. */
+	HNSW_MAX_DIMENSION = 4096,
+	/** Default max number of links of a node on an upper level. */
+	HNSW_DEFAULT_M = 16,
+	/** Default size of the search queue used on insertion. */
+	HNSW_DEFAULT_EF_CONSTRUCTION = 128,
+};
+
+enum hnsw_metric {
+	/** Euclidean distance. */
+	HNSW_METRIC_L2,
+	/** Manhattan distance. */
+	HNSW_METRIC_L1,
+	/** One minus cosine similarity. */
+	HNSW_METRIC_COSINE,
+	/** Negated dot product. */
+	HNSW_METRIC_DOT,
+	hnsw_metric_MAX,
+};
+
+struct hnsw_node;
+struct hnsw_candidate;
+struct mh_hnsw_data_t;
+
+/** A search result. */
+struct hnsw_neighbor {
+	/** Distance from the query. */
+	float distance;
+	/** Data attached to the found vector. */
+	void *data;
+};
+
+struct hnsw {
+	/** Number of coordinates of a vector. */
+	uint32_t dimension;
+	/** Distance function. */
+	enum hnsw_metric metric;
+	/**
+	 * Max number of links of a node on a level above 0, nodes
+	 * may have twice as many links on level 0.
+	 */
+	uint32_t m;
+	/** Size of the search queue used on insertion. */
+	uint32_t ef_construction;
+	/** Level generation factor, 1 / ln(m). */
+	double level_mult;
+	/** Nodes by id, NULL for a free id. */
+	struct hnsw_node **nodes;
+	/** Number of used ids, i.e. max id + 1. */
+	uint32_t node_count;
+	/** Allocated size of the nodes and scratch arrays. */
+	uint32_t node_capacity;
+	/** Stack of free ids below node_count. */
+	uint32_t *free_ids;
+	uint32_t free_id_count;
+	/** Number of live nodes. */
+	uint32_t size;
+	/** Number of deleted nodes that haven't been freed yet. */
+	uint32_t deleted_count;
+	/** Id of the node the searches start from or UINT32_MAX. */
+	uint32_t entry;
+	/** Top level of the entry node. */
+	uint32_t max_level;
+	/** Map: data -> node id. */
+	struct mh_hnsw_data_t *data_to_id;
+	/** Memory used by the nodes. */
+	size_t node_bsize;
+	/** State of the random level generator. */
+	uint64_t rng;
+	/** Scratch: visit marks of nodes by id. */
+	uint32_t *visited;
+	/** Scratch: mark of the nodes visited by the current search. */
+	uint32_t visit_mark;
+	/** Scratch: candidate and result heaps of a search. */
+	struct hnsw_candidate *candidates;
+	struct hnsw_candidate *results;
+	/** Scratch: buffer for neighbor selection. */
+	struct hnsw_candidate *select;
+	/** Scratch: normalized query vector. */
+	float *query;
+};
+
+/* {{{ API declaration */
+
+/**
+ * Initialize an empty graph
+ *
+ * @param hnsw - structure to initialize
+ * @param dimension - vector dimension, in [1, HNSW_MAX_DIMENSION]
+ * @param metric - distance function
+ * @param m - max number of links of a node on an upper level, >= 2
+ * @param ef_construction - size of the search queue used on insertion
+ * @return 0 - OK, -1 - memory error
+ */
+int
+hnsw_create(struct hnsw *hnsw, uint32_t dimension, enum hnsw_metric metric,
+	    uint32_t m, uint32_t ef_construction);
+
+/**
+ * Free all resources of the graph
+ *
+ * @param hnsw - the graph
+ */
+void
+hnsw_destroy(struct hnsw *hnsw);
+
+/**
+ * Insert a vector into the graph
+ *
+ * @param hnsw - the graph
+ * @param vector - array of dimension coordinates, copied
+ * @param data - non-NULL data attached to the vector, must not be
+ *  present in the graph
+ * @return 0 - OK, -1 - memory error, the graph is left unchanged
+ */
+int
+hnsw_insert(struct hnsw *hnsw, const float *vector, void *data);
+
+/**
+ * Delete the vector with the given data from the graph
+ *
+ * @param hnsw - the graph
+ * @param data - data passed to hnsw_insert()
+ * @return true - the vector was deleted, false - not found
+ */
+bool
+hnsw_delete(struct hnsw *hnsw, void *data);
+
+/**
+ * Find the vectors approximately nearest to the query
+ *
+ * @param hnsw - the graph
+ * @param query - array of dimension coordinates
+ * @param k - max number of vectors to find
+ * @param ef - size of the search queue, increased to k if less
+ * @param[out] result - array of k elements, filled with the found
+ *  vectors in the order of increasing distance from the query
+ * @return number of the found vectors
+ */
+uint32_t
+hnsw_search(struct hnsw *hnsw, const float *query, uint32_t k, uint32_t ef,
+	    struct hnsw_neighbor *result);
+
+/**
+ * Iterate over all vectors of the graph in no particular order
+ *
+ * @param hnsw - the graph
+ * @param[in,out] pos - iteration position, 0 at start
+ * @return data of the next vector or NULL at the end
+ */
+void *
+hnsw_next(const struct hnsw *hnsw, uint32_t *pos);
+
+/**
+ * Number of vectors in the graph
+ *
+ * @param hnsw - the graph
+ */
+static inline uint32_t
+hnsw_size(const struct hnsw *hnsw)
+{
+	return hnsw->size;
+}
+
+/**
+ * Memory used by the graph, in bytes
+ *
+ * @param hnsw - the graph
+ */
+size_t
+hnsw_bsize(const struct hnsw *hnsw);
+
+/* }}} API declaration */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
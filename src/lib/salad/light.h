@@ -297,6 +297,16 @@ static inline uint32_t
 LIGHT(view_find_key)(const struct LIGHT(view) *v, uint32_t hash,
 		     LIGHT_KEY_TYPE data);
 
+/**
+ * @brief Prefetch the hash table slot where a record with the given
+ *  hash is looked up first. Used to hide memory latency when several
+ *  lookups are done at once.
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to prefetch
+ */
+static inline void
+LIGHT(prefetch)(const struct LIGHT(core) *ht, uint32_t hash);
+
 /**
  * @brief Insert a record with given hash and value
  * @param ht - pointer to a hash table struct
@@ -640,6 +650,16 @@ LIGHT(view_find_key)(const struct LIGHT(view) *v, uint32_t hash,
 	return LIGHT(find_key_impl)(&v->common, hash, key);
 }
 
+static inline void
+LIGHT(prefetch)(const struct LIGHT(core) *htab, uint32_t hash)
+{
+	const struct LIGHT(common) *ht = &htab->common;
+	if (ht->count == 0)
+		return;
+	uint32_t slot = LIGHT(slot)(ht, hash);
+	__builtin_prefetch(LIGHT(get_record)(ht, slot), 0);
+}
+
 /**
  * @brief Replace a record with given hash and value
  * @param htab - pointer to a hash table struct
@@ -0,0 +1,228 @@
+/*
+ * *No header guard*: the header is allowed to be included twice
+ * with different sets of defines.
+ */
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+/*
+ * Loser tree (tournament tree) for k-way merging.
+ *
+ * The tree is built over a fixed set of values, which are usually
+ * cursors over sorted sequences. The value at the top of the tree
+ * is the minimal one. After the top value is advanced, the tree is
+ * fixed by replaying the matches on the path from the top value's
+ * leaf to the root, which takes at most ceil(log2(N)) comparisons,
+ * while restoring a binary heap after an update of its top takes up
+ * to 2 * log2(N) comparisons. A value can't be added to the tree
+ * after it's built, but the top value can be removed from it.
+ *
+ * Usage:
+ *
+ * #define LOSER_TREE_NAME my_tree
+ * #define LOSER_TREE_LESS(tree, a, b) my_value_less(a, b)
+ * #define loser_tree_value_t struct my_value
+ * #include "salad/loser_tree.h"
+ *
+ * struct loser_tree tree;
+ * my_tree_create(&tree);
+ * if (my_tree_build(&tree, values, count) != 0)
+ *	...
+ * struct my_value *value;
+ * while ((value = my_tree_top(&tree)) != NULL) {
+ *	if (my_value_next(value))
+ *		my_tree_update_top(&tree);
+ *	else
+ *		my_tree_pop(&tree);
+ * }
+ * my_tree_destroy(&tree);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#ifndef LOSER_TREE_NAME
+#error "LOSER_TREE_NAME must be defined"
+#endif
+
+/**
+ * Comparator. Takes three arguments: a pointer to the loser_tree
+ * structure and two pointers to loser_tree_value_t. Returns true
+ * if the first value is less than the second one.
+ */
+#ifndef LOSER_TREE_LESS
+#error "LOSER_TREE_LESS must be defined"
+#endif
+
+/** Type of values stored in the tree. */
+#ifndef loser_tree_value_t
+#error "loser_tree_value_t must be defined"
+#endif
+
+#ifndef CONCAT3
+#define CONCAT3_R(a, b, c) a##b##c
+#define CONCAT3(a, b, c) CONCAT3_R(a, b, c)
+#endif
+
+#define LOSER_TREE(name) CONCAT3(LOSER_TREE_NAME, _, name)
+
+#ifndef LOSER_TREE_STRUCTURES
+#define LOSER_TREE_STRUCTURES
+
+struct loser_tree {
+	/**
+	 * Values being merged, one per leaf. A value removed from
+	 * the tree is replaced with NULL, which loses all matches.
+	 */
+	void **leaves;
+	/**
+	 * Match results. nodes[0] is the leaf index of the overall
+	 * winner while nodes[i] for i > 0 is the leaf index of the
+	 * loser of the match played at internal node i. Children of
+	 * internal node i are nodes 2 * i and 2 * i + 1, where nodes
+	 * with numbers >= size stand for leaves (node size + j is
+	 * leaf j).
+	 */
+	uint32_t *nodes;
+	/** Number of leaves. */
+	uint32_t size;
+};
+
+#endif /* LOSER_TREE_STRUCTURES */
+
+/** Initialize an empty tree. */
+static inline void
+LOSER_TREE(create)(struct loser_tree *tree)
+{
+	tree->leaves = NULL;
+	tree->nodes = NULL;
+	tree->size = 0;
+}
+
+/** Free memory allocated for a tree and make it empty. */
+static inline void
+LOSER_TREE(destroy)(struct loser_tree *tree)
+{
+	free(tree->leaves);
+	LOSER_TREE(create)(tree);
+}
+
+/**
+ * Return true if the value stored in the leaf @a a is less than
+ * the value stored in the leaf @a b. A removed value is greater
+ * than any other value.
+ */
+static inline bool
+LOSER_TREE(leaf_less)(struct loser_tree *tree, uint32_t a, uint32_t b)
+{
+	loser_tree_value_t *value_a = (loser_tree_value_t *)tree->leaves[a];
+	loser_tree_value_t *value_b = (loser_tree_value_t *)tree->leaves[b];
+	if (value_a == NULL)
+		return false;
+	if (value_b == NULL)
+		return true;
+	return LOSER_TREE_LESS(tree, value_a, value_b);
+}
+
+/**
+ * Build a tree over the given array of values. The tree must be
+ * empty. Returns 0 on success, -1 on memory allocation error.
+ */
+static inline int
+LOSER_TREE(build)(struct loser_tree *tree, loser_tree_value_t **values,
+		  uint32_t count)
+{
+	assert(tree->size == 0);
+	if (count == 0)
+		return 0;
+	/*
+	 * Leaves, match results, and winners of the matches
+	 * played at internal nodes, needed only while building.
+	 */
+	size_t size = count * (sizeof(*tree->leaves) +
+			       2 * sizeof(*tree->nodes));
+	void **leaves = (void **)malloc(size);
+	if (leaves == NULL)
+		return -1;
+	uint32_t *nodes = (uint32_t *)(leaves + count);
+	uint32_t *winners = nodes + count;
+	for (uint32_t i = 0; i < count; i++)
+		leaves[i] = values[i];
+	tree->leaves = leaves;
+	tree->nodes = nodes;
+	tree->size = count;
+	for (uint32_t node = count - 1; node > 0; node--) {
+		uint32_t left = 2 * node;
+		uint32_t right = 2 * node + 1;
+		left = left >= count ? left - count : winners[left];
+		right = right >= count ? right - count : winners[right];
+		if (LOSER_TREE(leaf_less)(tree, right, left)) {
+			winners[node] = right;
+			nodes[node] = left;
+		} else {
+			winners[node] = left;
+			nodes[node] = right;
+		}
+	}
+	nodes[0] = count > 1 ? winners[1] : 0;
+	return 0;
+}
+
+/**
+ * Return the minimal value stored in a tree or NULL if the tree
+ * is empty.
+ */
+static inline loser_tree_value_t *
+LOSER_TREE(top)(struct loser_tree *tree)
+{
+	if (tree->size == 0)
+		return NULL;
+	return (loser_tree_value_t *)tree->leaves[tree->nodes[0]];
+}
+
+/**
+ * Replay the matches on the path from the given leaf to the root.
+ */
+static inline void
+LOSER_TREE(replay)(struct loser_tree *tree, uint32_t leaf)
+{
+	uint32_t *nodes = tree->nodes;
+	uint32_t winner = leaf;
+	for (uint32_t node = (leaf + tree->size) / 2; node > 0; node /= 2) {
+		uint32_t loser = nodes[node];
+		if (LOSER_TREE(leaf_less)(tree, loser, winner)) {
+			nodes[node] = winner;
+			winner = loser;
+		}
+	}
+	nodes[0] = winner;
+}
+
+/** Fix a tree after the top value was changed. */
+static inline void
+LOSER_TREE(update_top)(struct loser_tree *tree)
+{
+	assert(LOSER_TREE(top)(tree) != NULL);
+	LOSER_TREE(replay)(tree, tree->nodes[0]);
+}
+
+/** Remove the top value from a tree. */
+static inline void
+LOSER_TREE(pop)(struct loser_tree *tree)
+{
+	assert(LOSER_TREE(top)(tree) != NULL);
+	uint32_t leaf = tree->nodes[0];
+	tree->leaves[leaf] = NULL;
+	LOSER_TREE(replay)(tree, leaf);
+}
+
+#undef LOSER_TREE
+#undef LOSER_TREE_NAME
+#undef LOSER_TREE_LESS
+#undef loser_tree_value_t
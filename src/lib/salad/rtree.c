@@ -1056,6 +1056,211 @@ rtree_remove(struct rtree *tree, const struct rtree_rect *rect, record_t obj)
 	return true;
 }
 
+/*------------------------------------------------------------------------- */
+/* R-tree bulk loading */
+/*------------------------------------------------------------------------- */
+
+static struct rtree_page_branch *
+rtree_bulk_entry_get(const struct rtree *tree, char *entries, size_t i)
+{
+	return (struct rtree_page_branch *)
+		(entries + i * tree->page_branch_size);
+}
+
+/* Doubled center of the rectangle of a branch along an axis */
+static coord_t
+rtree_bulk_entry_center2(const struct rtree *tree, char *entries, size_t i,
+			 unsigned axis)
+{
+	struct rtree_page_branch *b = rtree_bulk_entry_get(tree, entries, i);
+	return b->rect.coords[axis * 2] + b->rect.coords[axis * 2 + 1];
+}
+
+static void
+rtree_bulk_entry_swap(const struct rtree *tree, char *entries,
+		      size_t i, size_t j)
+{
+	struct rtree_page_branch tmp;
+	size_t size = tree->page_branch_size;
+	memcpy(&tmp, entries + i * size, size);
+	memcpy(entries + i * size, entries + j * size, size);
+	memcpy(entries + j * size, &tmp, size);
+}
+
+/*
+ * Reorder entries [lo, hi) so that the k-th entry is the one that would
+ * be there if the entries were sorted by center along the axis, entries
+ * before it are not greater and entries after it are not less (Hoare's
+ * selection algorithm).
+ */
+static void
+rtree_bulk_select(const struct rtree *tree, char *entries,
+		  ssize_t lo, ssize_t hi, ssize_t k, unsigned axis)
+{
+	while (hi - lo > 1) {
+		coord_t pivot = rtree_bulk_entry_center2(tree, entries,
+							 lo + (hi - lo) / 2,
+							 axis);
+		ssize_t i = lo, j = hi - 1;
+		while (i <= j) {
+			while (rtree_bulk_entry_center2(tree, entries,
+							i, axis) < pivot)
+				i++;
+			while (rtree_bulk_entry_center2(tree, entries,
+							j, axis) > pivot)
+				j--;
+			if (i <= j)
+				rtree_bulk_entry_swap(tree, entries, i++, j--);
+		}
+		if (k <= j)
+			hi = j + 1;
+		else if (k >= i)
+			lo = i;
+		else
+			return;
+	}
+}
+
+/*
+ * Reorder entries [lo, hi) so that none of the entries of each chunk
+ * (counting from lo) is greater along the axis than the entries of the
+ * next chunks. The entries of a chunk are not sorted.
+ */
+static void
+rtree_bulk_partition(const struct rtree *tree, char *entries,
+		     size_t lo, size_t hi, size_t chunk, unsigned axis)
+{
+	size_t chunks = (hi - lo + chunk - 1) / chunk;
+	if (chunks <= 1)
+		return;
+	size_t mid = lo + chunks / 2 * chunk;
+	rtree_bulk_select(tree, entries, lo, hi, mid, axis);
+	rtree_bulk_partition(tree, entries, lo, mid, chunk, axis);
+	rtree_bulk_partition(tree, entries, mid, hi, chunk, axis);
+}
+
+/* Smallest number the power of which is not less than value */
+static size_t
+rtree_bulk_root(size_t value, unsigned power)
+{
+	for (size_t root = 1; ; root++) {
+		size_t p = 1;
+		for (unsigned i = 0; i < power && p < value; i++)
+			p *= root;
+		if (p >= value)
+			return root;
+	}
+}
+
+/*
+ * Sort-Tile-Recursive: split entries [lo, hi) into slabs along the
+ * axis, then split each slab into slabs along the next axis and so on,
+ * so that each page_max_fill consecutive entries are close to each
+ * other and can be packed into a page.
+ */
+static void
+rtree_bulk_tile(const struct rtree *tree, char *entries,
+		size_t lo, size_t hi, unsigned axis)
+{
+	size_t fill = tree->page_max_fill;
+	size_t pages = (hi - lo + fill - 1) / fill;
+	if (pages <= 1)
+		return;
+	if (axis + 1 == tree->dimension) {
+		rtree_bulk_partition(tree, entries, lo, hi, fill, axis);
+		return;
+	}
+	size_t slabs = rtree_bulk_root(pages, tree->dimension - axis);
+	size_t slab = fill * ((pages + slabs - 1) / slabs);
+	rtree_bulk_partition(tree, entries, lo, hi, slab, axis);
+	for (size_t i = lo; i < hi; i += slab) {
+		size_t end = i + slab < hi ? i + slab : hi;
+		rtree_bulk_tile(tree, entries, i, end, axis + 1);
+	}
+}
+
+/*
+ * Pack tiled entries into pages of a tree level and replace them with
+ * branches pointing to the pages. Return the number of pages.
+ */
+static size_t
+rtree_bulk_pack(struct rtree *tree, char *entries, size_t count)
+{
+	size_t fill = tree->page_max_fill;
+	size_t pages = (count + fill - 1) / fill;
+	size_t offset = 0;
+	for (size_t i = 0; i < pages; i++) {
+		size_t n = fill;
+		size_t rest = count - offset;
+		if (i + 2 == pages && rest - fill < tree->page_min_fill) {
+			/* Don't leave the last page underfilled */
+			n = rest - rest / 2;
+		} else if (i + 1 == pages) {
+			n = rest;
+		}
+		struct rtree_page *page = rtree_page_alloc(tree);
+		page->n = n;
+		memcpy(page->data, rtree_bulk_entry_get(tree, entries, offset),
+		       n * tree->page_branch_size);
+		offset += n;
+		/* Entry i has been either copied or already replaced */
+		struct rtree_page_branch *b =
+			rtree_bulk_entry_get(tree, entries, i);
+		b->data.page = page;
+		rtree_page_cover(tree, page, &b->rect);
+	}
+	assert(offset == count);
+	tree->n_pages += pages;
+	return pages;
+}
+
+size_t
+rtree_bulk_entry_size(const struct rtree *tree)
+{
+	return tree->page_branch_size;
+}
+
+void
+rtree_bulk_entry_set(const struct rtree *tree, void *entry,
+		     const struct rtree_rect *rect, record_t obj)
+{
+	struct rtree_page_branch *b = (struct rtree_page_branch *)entry;
+	b->data.record = obj;
+	rtree_rect_copy(&b->rect, rect, tree->dimension);
+}
+
+size_t
+rtree_bulk_load_page_count(const struct rtree *tree, size_t count)
+{
+	size_t fill = tree->page_max_fill;
+	size_t total = 0;
+	while (count > 0) {
+		count = (count + fill - 1) / fill;
+		total += count;
+		if (count == 1)
+			break;
+	}
+	return total;
+}
+
+void
+rtree_bulk_load(struct rtree *tree, void *entries, size_t count)
+{
+	assert(tree->root == NULL);
+	if (count == 0)
+		return;
+	size_t n = count;
+	do {
+		rtree_bulk_tile(tree, (char *)entries, 0, n, 0);
+		n = rtree_bulk_pack(tree, (char *)entries, n);
+		tree->height++;
+	} while (n > 1);
+	assert(tree->height <= RTREE_MAX_HEIGHT);
+	tree->root = rtree_bulk_entry_get(tree, (char *)entries, 0)->data.page;
+	tree->n_records = count;
+	tree->version++;
+}
+
 bool
 rtree_search(const struct rtree *tree, const struct rtree_rect *rect,
 	     enum spatial_search_op op, struct rtree_iterator *itr)
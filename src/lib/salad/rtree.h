@@ -284,6 +284,46 @@ rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj);
 bool
 rtree_remove(struct rtree *tree, const struct rtree_rect *rect, record_t obj);
 
+/**
+ * @brief Size of an element of the array taken by rtree_bulk_load()
+ * @param tree - pointer to a tree
+ */
+size_t
+rtree_bulk_entry_size(const struct rtree *tree);
+
+/**
+ * @brief Initialize an element of the array taken by rtree_bulk_load()
+ * @param tree - pointer to a tree
+ * @param entry - pointer to the element, rtree_bulk_entry_size() bytes
+ * @param rect - rectangle of the record
+ * @param obj - record
+ */
+void
+rtree_bulk_entry_set(const struct rtree *tree, void *entry,
+		     const struct rtree_rect *rect, record_t obj);
+
+/**
+ * @brief Number of pages rtree_bulk_load() allocates for a number
+ *  of records, so that the caller can make sure the allocation succeeds
+ * @param tree - pointer to a tree
+ * @param count - number of records
+ */
+size_t
+rtree_bulk_load_page_count(const struct rtree *tree, size_t count);
+
+/**
+ * @brief Build a tree from an array of records at once
+ * The records are packed into pages with Sort-Tile-Recursive algorithm,
+ * which is much faster than inserting them one by one and produces
+ * fully packed pages with little overlap. The tree must be empty.
+ * @param tree - pointer to a tree
+ * @param entries - array of elements initialized with
+ *  rtree_bulk_entry_set(), it is reordered and overwritten
+ * @param count - number of elements in the array
+ */
+void
+rtree_bulk_load(struct rtree *tree, void *entries, size_t count);
+
 /**
  * @brief Size of memory used by tree
  * @param tree - pointer to a tree
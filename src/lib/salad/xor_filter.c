@@ -0,0 +1,217 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+
+#include "xor_filter.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+enum {
+	/* Number of slots allocated for a filter regardless of its size. */
+	XOR_FILTER_EXTRA_SLOTS = 32,
+	/* Max number of attempts to build a filter with different seeds. */
+	XOR_FILTER_MAX_ATTEMPTS = 100,
+	/* Padding of the table, see xor_filter_get(). */
+	XOR_FILTER_TABLE_PADDING = 2,
+};
+
+/** Set of keys mapped to a slot while the filter is being built. */
+struct xor_filter_set {
+	/* Xor of all keys mapped to the slot. */
+	uint64_t mask;
+	/* Number of keys mapped to the slot. */
+	uint32_t count;
+};
+
+/** Key assigned to a slot, in the order of assignment. */
+struct xor_filter_assignment {
+	uint64_t key;
+	uint32_t slot;
+};
+
+static int
+xor_filter_cmp_hash(const void *a, const void *b)
+{
+	uint32_t h1 = *(const uint32_t *)a;
+	uint32_t h2 = *(const uint32_t *)b;
+	return h1 < h2 ? -1 : h1 > h2;
+}
+
+/** Xor a fingerprint into a slot, see xor_filter_get(). */
+static void
+xor_filter_xor(struct xor_filter *filter, uint32_t slot, uint32_t fingerprint)
+{
+	uint64_t bit = (uint64_t)slot * filter->fingerprint_bits;
+	unsigned char *p = filter->table + bit / CHAR_BIT;
+	uint32_t word = fingerprint << (bit % CHAR_BIT);
+	p[0] ^= word;
+	p[1] ^= word >> 8;
+	p[2] ^= word >> 16;
+}
+
+/**
+ * Try to map each key to a slot that no other key maps to once the
+ * keys assigned before it are removed ("peeling"). Returns the number
+ * of assigned keys, which equals the number of keys on success.
+ */
+static uint32_t
+xor_filter_peel(const struct xor_filter *filter, const uint32_t *hashes,
+		uint32_t count, struct xor_filter_set *sets, uint32_t *queue,
+		struct xor_filter_assignment *stack)
+{
+	uint32_t slot_count = 3 * filter->block_length;
+	memset(sets, 0, slot_count * sizeof(*sets));
+	for (uint32_t i = 0; i < count; i++) {
+		uint64_t key = xor_filter_key(filter, hashes[i]);
+		for (int j = 0; j < 3; j++) {
+			struct xor_filter_set *set =
+				&sets[xor_filter_slot(filter, key, j)];
+			set->mask ^= key;
+			set->count++;
+		}
+	}
+	uint32_t queue_size = 0;
+	for (uint32_t i = 0; i < slot_count; i++) {
+		if (sets[i].count == 1)
+			queue[queue_size++] = i;
+	}
+	uint32_t stack_size = 0;
+	while (queue_size > 0) {
+		uint32_t slot = queue[--queue_size];
+		if (sets[slot].count == 0)
+			continue;
+		uint64_t key = sets[slot].mask;
+		stack[stack_size].key = key;
+		stack[stack_size].slot = slot;
+		stack_size++;
+		for (int j = 0; j < 3; j++) {
+			uint32_t other = xor_filter_slot(filter, key, j);
+			struct xor_filter_set *set = &sets[other];
+			set->mask ^= key;
+			if (--set->count == 1)
+				queue[queue_size++] = other;
+		}
+	}
+	return stack_size;
+}
+
+int
+xor_filter_create(struct xor_filter *filter, const uint32_t *hashes,
+		  uint32_t count, double false_positive_rate)
+{
+	memset(filter, 0, sizeof(*filter));
+	/* Peeling never succeeds if there are duplicates, drop them. */
+	uint32_t *unique = malloc((count + 1) * sizeof(*unique));
+	if (unique == NULL)
+		return -1;
+	memcpy(unique, hashes, count * sizeof(*unique));
+	qsort(unique, count, sizeof(*unique), xor_filter_cmp_hash);
+	uint32_t unique_count = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (unique_count == 0 || unique[unique_count - 1] != unique[i])
+			unique[unique_count++] = unique[i];
+	}
+
+	int bits = ceil(-log2(false_positive_rate));
+	if (bits < 1)
+		bits = 1;
+	if (bits > XOR_FILTER_FINGERPRINT_BITS_MAX)
+		bits = XOR_FILTER_FINGERPRINT_BITS_MAX;
+	filter->fingerprint_bits = bits;
+	uint64_t slot_count = XOR_FILTER_EXTRA_SLOTS +
+			      (uint64_t)ceil(1.23 * unique_count);
+	filter->block_length = slot_count / 3 + 1;
+	slot_count = 3 * filter->block_length;
+
+	size_t table_size = xor_filter_store_size(filter);
+	filter->table = calloc(table_size + XOR_FILTER_TABLE_PADDING, 1);
+	struct xor_filter_set *sets = malloc(slot_count * sizeof(*sets));
+	uint32_t *queue = malloc(slot_count * sizeof(*queue));
+	struct xor_filter_assignment *stack =
+		malloc((unique_count + 1) * sizeof(*stack));
+	int rc = -1;
+	if (filter->table == NULL || sets == NULL || queue == NULL ||
+	    stack == NULL)
+		goto out;
+	for (int attempt = 0; attempt < XOR_FILTER_MAX_ATTEMPTS; attempt++) {
+		/* Any sequence of distinct seeds will do. */
+		filter->seed = attempt * 2654435761U;
+		if (xor_filter_peel(filter, unique, unique_count,
+				    sets, queue, stack) == unique_count) {
+			rc = 0;
+			break;
+		}
+	}
+	if (rc != 0)
+		goto out;
+	/*
+	 * Assign fingerprints in the reverse order of peeling: when a key
+	 * is processed, its slot isn't used by any key processed before,
+	 * so it can be set to make the xor of the key slots match the key
+	 * fingerprint.
+	 */
+	for (uint32_t i = unique_count; i-- > 0; ) {
+		uint64_t key = stack[i].key;
+		uint32_t f = xor_filter_fingerprint(filter, key);
+		for (int j = 0; j < 3; j++)
+			f ^= xor_filter_get(filter,
+					    xor_filter_slot(filter, key, j));
+		xor_filter_xor(filter, stack[i].slot, f);
+	}
+out:
+	free(stack);
+	free(queue);
+	free(sets);
+	free(unique);
+	if (rc != 0) {
+		free(filter->table);
+		filter->table = NULL;
+	}
+	return rc;
+}
+
+void
+xor_filter_destroy(struct xor_filter *filter)
+{
+	free(filter->table);
+}
+
+double
+xor_filter_fpr(const struct xor_filter *filter)
+{
+	return ldexp(1, -filter->fingerprint_bits);
+}
+
+size_t
+xor_filter_store_size(const struct xor_filter *filter)
+{
+	uint64_t bits = 3ULL * filter->block_length * filter->fingerprint_bits;
+	return (bits + CHAR_BIT - 1) / CHAR_BIT;
+}
+
+char *
+xor_filter_store(const struct xor_filter *filter, char *table)
+{
+	size_t store_size = xor_filter_store_size(filter);
+	memcpy(table, filter->table, store_size);
+	return table + store_size;
+}
+
+int
+xor_filter_load_table(struct xor_filter *filter, const char *table)
+{
+	size_t size = xor_filter_store_size(filter);
+	filter->table = malloc(size + XOR_FILTER_TABLE_PADDING);
+	if (filter->table == NULL)
+		return -1;
+	memcpy(filter->table, table, size);
+	memset(filter->table + size, 0, XOR_FILTER_TABLE_PADDING);
+	return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2026, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+/*
+ * Static xor filter:
+ *  Graf, Thomas Mueller; Lemire, Daniel (2020),
+ *  "Xor Filters: Faster and Smaller Than Bloom and Cuckoo Filters"
+ *  https://arxiv.org/abs/1912.08258
+ *
+ * The filter is built at once from a set of hashes and can't be
+ * updated after that. It stores a fingerprint_bits fingerprint per
+ * slot, and there are about 1.23 slots per value, while a bloom
+ * filter with the same false positive rate needs about 1.44 bits
+ * per value per each bit of a fingerprint. A lookup reads three
+ * fingerprints and checks if their xor matches the fingerprint of
+ * the value.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <limits.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/* Max number of bits in a fingerprint. */
+	XOR_FILTER_FINGERPRINT_BITS_MAX = 16,
+};
+
+/**
+ * Xor filter data structure
+ */
+struct xor_filter {
+	/* Number of slots in each of the three blocks of the table. */
+	uint32_t block_length;
+	/* Number of bits in a fingerprint. */
+	uint16_t fingerprint_bits;
+	/* Seed used to derive slots and fingerprints from a hash. */
+	uint32_t seed;
+	/* Packed fingerprints, three blocks of block_length each. */
+	unsigned char *table;
+};
+
+/* {{{ API declaration */
+
+/**
+ * Allocate and build a xor filter for the given set of hashes
+ *
+ * @param filter - structure to initialize
+ * @param hashes - hashes of the values, may contain duplicates
+ * @param count - number of hashes
+ * @param false_positive_rate - desired false positive rate
+ * @return 0 - OK, -1 - memory error
+ */
+int
+xor_filter_create(struct xor_filter *filter, const uint32_t *hashes,
+		  uint32_t count, double false_positive_rate);
+
+/**
+ * Free resources of the xor filter
+ *
+ * @param filter - the xor filter
+ */
+void
+xor_filter_destroy(struct xor_filter *filter);
+
+/**
+ * Query for presence of a value in the data set
+ * @param filter - the xor filter
+ * @param hash - hash of the value
+ * @return true - the value could be in data set; false - the value is
+ *  definitively not in data set
+ */
+static bool
+xor_filter_maybe_has(const struct xor_filter *filter, uint32_t hash);
+
+/**
+ * Return the expected false positive rate of a xor filter.
+ * @param filter - the xor filter
+ * @return - expected false positive rate
+ */
+double
+xor_filter_fpr(const struct xor_filter *filter);
+
+/**
+ * Calculate size of a buffer that is needed for storing filter table
+ * @param filter - the xor filter to store
+ * @return - Exact size
+ */
+size_t
+xor_filter_store_size(const struct xor_filter *filter);
+
+/**
+ * Store xor filter table to the given buffer
+ * Other struct xor_filter members must be stored manually.
+ * @param filter - the xor filter to store
+ * @param table - buffer to store to
+ * #return - end of written buffer
+ */
+char *
+xor_filter_store(const struct xor_filter *filter, char *table);
+
+/**
+ * Allocate table and load it from given buffer.
+ * Other struct xor_filter members must be loaded manually.
+ *
+ * @param filter - structure to load to
+ * @param table - data to load
+ * @return 0 - OK, -1 - memory error
+ */
+int
+xor_filter_load_table(struct xor_filter *filter, const char *table);
+
+/* }}} API declaration */
+
+/* {{{ API definition */
+
+/** Mix a hash with a seed into a 64-bit key (murmur3 finalizer). */
+static inline uint64_t
+xor_filter_key(const struct xor_filter *filter, uint32_t hash)
+{
+	uint64_t h = (uint64_t)hash << 32 | filter->seed;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+/** Map the lower 32 bits of a value to [0, n) without division. */
+static inline uint32_t
+xor_filter_reduce(uint64_t value, uint32_t n)
+{
+	return ((value & UINT32_MAX) * n) >> 32;
+}
+
+/** Return the i-th (0, 1, 2) slot of a key. */
+static inline uint32_t
+xor_filter_slot(const struct xor_filter *filter, uint64_t key, int i)
+{
+	uint64_t rot = i == 0 ? key : key << (21 * i) | key >> (64 - 21 * i);
+	return xor_filter_reduce(rot, filter->block_length) +
+	       i * filter->block_length;
+}
+
+/** Return the fingerprint of a key. */
+static inline uint32_t
+xor_filter_fingerprint(const struct xor_filter *filter, uint64_t key)
+{
+	return (uint32_t)(key ^ (key >> 32)) &
+	       ((1U << filter->fingerprint_bits) - 1);
+}
+
+/**
+ * Return the fingerprint stored in a slot. A fingerprint takes at
+ * most XOR_FILTER_FINGERPRINT_BITS_MAX + CHAR_BIT - 1 bits starting
+ * from a byte boundary so it's loaded from three bytes. The table is
+ * padded so that it's safe to read them for the last slot.
+ */
+static inline uint32_t
+xor_filter_get(const struct xor_filter *filter, uint32_t slot)
+{
+	uint64_t bit = (uint64_t)slot * filter->fingerprint_bits;
+	const unsigned char *p = filter->table + bit / CHAR_BIT;
+	uint32_t word = p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16;
+	return (word >> (bit % CHAR_BIT)) &
+	       ((1U << filter->fingerprint_bits) - 1);
+}
+
+static inline bool
+xor_filter_maybe_has(const struct xor_filter *filter, uint32_t hash)
+{
+	uint64_t key = xor_filter_key(filter, hash);
+	uint32_t f = xor_filter_fingerprint(filter, key);
+	f ^= xor_filter_get(filter, xor_filter_slot(filter, key, 0));
+	f ^= xor_filter_get(filter, xor_filter_slot(filter, key, 1));
+	f ^= xor_filter_get(filter, xor_filter_slot(filter, key, 2));
+	return f == 0;
+}
+
+/* }}} API definition */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -187,6 +187,12 @@ enum {
 	 * members.
 	 */
 	INDIRECT_PING_COUNT = 2,
+	/**
+	 * Upper bound of the local health multiplier. The ack
+	 * timeout of an instance with the worst health is this
+	 * number + 1 times bigger than the configured value.
+	 */
+	LOCAL_HEALTH_MAX = 8,
 };
 
 /** Calculate UUID hash to use as a member table key. */
@@ -478,6 +484,17 @@ struct swim {
 	heap_t wait_ack_heap;
 	/** Generator of ack checking events. */
 	struct ev_timer wait_ack_tick;
+	/**
+	 * Local health multiplier from the Lifeguard extension of
+	 * SWIM. It grows when this instance learns that the others
+	 * suspect it, and decreases on each received ACK. A slow
+	 * instance, which can't process ACKs in time, should not
+	 * accuse the healthy members of being dead, so its ack
+	 * timeout is multiplied by local health + 1. It makes the
+	 * problems of one instance less likely to be spread over
+	 * the cluster as false failure detections.
+	 */
+	int local_health;
 	/** GC state saying how to remove dead members. */
 	enum swim_gc_mode gc_mode;
 	/**
@@ -552,7 +569,8 @@ swim_wait_ack(struct swim *swim, struct swim_member *member,
 	      bool was_ping_indirect)
 {
 	if (heap_node_is_stray(&member->in_wait_ack_heap)) {
-		double timeout = swim->wait_ack_tick.repeat;
+		double timeout = swim->wait_ack_tick.repeat *
+				 (swim->local_health + 1);
 		/*
 		 * Direct ping is two trips: PING + ACK.
 		 * Indirect ping is four trips: PING,
@@ -1584,9 +1602,13 @@ swim_upsert_member(struct swim *swim, const struct swim_member_def *def,
 		/*
 		 * In the cluster a gossip exists that this
 		 * instance is not alive. Refute this information
-		 * with a bigger incarnation.
+		 * with a bigger incarnation. Being suspected also
+		 * means that this instance probably is too slow,
+		 * so it becomes less eager to suspect the others.
 		 */
 		self->incarnation.version++;
+		if (swim->local_health < LOCAL_HEALTH_MAX)
+			++swim->local_health;
 		swim_on_member_update(swim, self, SWIM_EV_NEW_VERSION);
 	}
 	return 0;
@@ -1702,8 +1724,11 @@ swim_process_failure_detection(struct swim *swim, const char **pos,
 		break;
 	case SWIM_FD_MSG_ACK:
 		member->unacknowledged_pings = 0;
-		if (! heap_node_is_stray(&member->in_wait_ack_heap))
+		if (! heap_node_is_stray(&member->in_wait_ack_heap)) {
 			wait_ack_heap_delete(&swim->wait_ack_heap, member);
+			if (swim->local_health > 0)
+				--swim->local_health;
+		}
 		break;
 	default:
 		unreachable();
@@ -2184,6 +2209,12 @@ swim_broadcast(struct swim *swim, int port)
 	return 0;
 }
 
+int
+swim_local_health(const struct swim *swim)
+{
+	return swim->local_health;
+}
+
 int
 swim_size(const struct swim *swim)
 {
@@ -173,6 +173,15 @@ swim_probe_member(struct swim *swim, const char *uri);
 int
 swim_broadcast(struct swim *swim, int port);
 
+/**
+ * Get the local health multiplier of the instance. It is 0 when
+ * the instance is healthy and grows each time the instance has
+ * to refute its suspicion. The ack timeout is multiplied by
+ * local health + 1.
+ */
+int
+swim_local_health(const struct swim *swim);
+
 /** Get SWIM member table size. */
 int
 swim_size(const struct swim *swim);
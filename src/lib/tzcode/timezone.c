@@ -91,31 +91,32 @@ timezone_name(int64_t index)
 	return zones_unsorted[index].name;
 }
 
-/** lookaside values we reuse across parser calls */
-static timezone_t prev_tz;
-static char prev_zonename[DT_TO_STRING_BUFSIZE];
+/**
+ * Olson timezones loaded so far, indexed by zone id. Aliases share
+ * the id with the zone they refer to, so they share the entry, too.
+ * Zones are loaded lazily and kept until exit so that working with
+ * several zones at once doesn't reload their transition tables.
+ */
+static timezone_t tz_cache[MAX_TZINDEX];
 
 static timezone_t
-timezone_alloc(const char * zonename)
+timezone_alloc(int16_t id, const char *zonename)
 {
 	assert(zonename != NULL);
-	if (prev_zonename[0] != '\0' && strcmp(prev_zonename, zonename) == 0)
-		return prev_tz;
-	if (prev_tz != NULL)
-		tzfree(prev_tz);
-	prev_tz = tzalloc(zonename);
-	assert(strlen(zonename) < lengthof(prev_zonename));
-	strlcpy(prev_zonename, zonename, sizeof prev_zonename);
-	return prev_tz;
+	assert(id >= 0 && id < MAX_TZINDEX);
+	if (tz_cache[id] == NULL)
+		tz_cache[id] = tzalloc(zonename);
+	return tz_cache[id];
 }
 
 static void __attribute__((destructor))
 timezone_free(void)
 {
-	if (prev_tz != NULL) {
-		tzfree(prev_tz);
-		prev_tz = NULL;
-		prev_zonename[0] = '\0';
+	for (size_t i = 0; i < lengthof(tz_cache); i++) {
+		if (tz_cache[i] != NULL) {
+			tzfree(tz_cache[i]);
+			tz_cache[i] = NULL;
+		}
 	}
 }
 
@@ -182,7 +183,7 @@ timezone_tm_lookup(const char *str, size_t len,
 		tm->tm_isdst = !!(found->flags & TZ_DST);
 		return rc;
 	}
-	timezone_t tz = timezone_alloc(str);
+	timezone_t tz = timezone_alloc(found->id, str);
 	if (tz == NULL)
 		return 0;
 	struct datetime date = {.epoch = 0};
@@ -211,7 +212,7 @@ timezone_epoch_lookup(const char *str, size_t len, time_t base,
 		return rc;
 	}
 	timezone_t tz = NULL;
-	tz = timezone_alloc(str);
+	tz = timezone_alloc(found->id, str);
 	if (tz == NULL)
 		return 0;
 	struct tnt_tm tm = {.tm_epoch = 0};
@@ -229,7 +230,7 @@ timezone_tzindex_lookup(int16_t tzindex, struct tnt_tm *tm)
 	if (tzindex == 0)
 		return false;
 
-	timezone_t tz = timezone_alloc(timezone_name(tzindex));
+	timezone_t tz = timezone_alloc(tzindex, timezone_name(tzindex));
 	if (tz == NULL)
 		return false;
 	time_t epoch = (int64_t)tm->tm_epoch;
@@ -39,6 +39,8 @@
 #include "crc32.h"
 
 #define PBKDF2_MAX_DIGEST_SIZE 128
+/** Initial CRC32 value used by digest.crc32(), see CRC32.crc_begin. */
+#define CRC32_BEGIN 0xFFFFFFFFU
 
 static ssize_t
 digest_pbkdf2_f(va_list ap)
@@ -76,6 +78,49 @@ lua_pbkdf2(lua_State *L)
 	return 1;
 }
 
+/**
+ * digest.crc32_batch(keys[, bucket_count]) - calculate CRC32 of each
+ * string in the array. If bucket_count is given, the result for each
+ * key is converted to a bucket id in range [1, bucket_count] the same
+ * way vshard does it: crc32(key) % bucket_count + 1.
+ */
+static int
+lua_crc32_batch(lua_State *L)
+{
+	if (lua_type(L, 1) != LUA_TTABLE)
+		return luaL_error(L, "Usage: digest.crc32_batch(keys"
+				  "[, bucket_count])");
+	uint32_t bucket_count = 0;
+	if (!lua_isnoneornil(L, 2)) {
+		lua_Integer count = luaL_checkinteger(L, 2);
+		if (count <= 0 || count > UINT32_MAX)
+			return luaL_error(L, "bucket_count must be a positive "
+					  "number");
+		bucket_count = count;
+	}
+	int len = lua_objlen(L, 1);
+	lua_createtable(L, len, 0);
+	for (int i = 1; i <= len; i++) {
+		lua_rawgeti(L, 1, i);
+		size_t size;
+		const char *str = NULL;
+		if (lua_type(L, -1) == LUA_TSTRING ||
+		    lua_type(L, -1) == LUA_TNUMBER)
+			str = lua_tolstring(L, -1, &size);
+		if (str == NULL)
+			return luaL_error(L, "digest.crc32_batch: key #%d "
+					  "must be a string", i);
+		uint32_t crc = crc32_calc(CRC32_BEGIN, str, size);
+		lua_pop(L, 1);
+		if (bucket_count != 0)
+			lua_pushinteger(L, crc % bucket_count + 1);
+		else
+			lua_pushinteger(L, crc);
+		lua_rawseti(L, -2, i);
+	}
+	return 1;
+}
+
 /* CRC32 internal {{{ */
 
 int
@@ -157,6 +202,7 @@ tarantool_lua_digest_init(struct lua_State *L)
 {
 	static const struct luaL_Reg lua_digest_methods [] = {
 		{"pbkdf2", lua_pbkdf2},
+		{"crc32_batch", lua_crc32_batch},
 		{NULL, NULL}
 	};
 	lua_getfield(L, LUA_REGISTRYINDEX, "_PRELOAD");
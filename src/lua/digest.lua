@@ -250,6 +250,10 @@ local m = {
         return builtin.crc32_calc(tonumber(crc), str, string.len(str))
     end,
 
+    crc32_batch = function(keys, bucket_count)
+        return internal.crc32_batch(keys, bucket_count)
+    end,
+
     guava = function(state, buckets)
         return builtin.guava(state, buckets)
     end,
@@ -34,6 +34,7 @@
 #include "lua/utils.h"
 #include "lua/serializer.h"
 #include "lua/backtrace.h"
+#include "core/sampler.h"
 #include "tt_static.h"
 
 #include <lua.h>
@@ -339,6 +340,83 @@ lbox_fiber_top_disable(struct lua_State *L)
 	return 0;
 }
 
+#ifdef ENABLE_FIBER_SAMPLER
+static int
+lbox_fiber_prof_enable(struct lua_State *L)
+{
+	double interval = 0.01;
+	if (!lua_isnoneornil(L, 1)) {
+		interval = luaL_checknumber(L, 1);
+		if (interval <= 0) {
+			luaL_error(L, "fiber.prof_enable(): interval must be "
+				      "positive");
+		}
+	}
+	if (sampler_start(interval) != 0)
+		return luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_fiber_prof_disable(struct lua_State *L)
+{
+	(void)L;
+	sampler_stop();
+	return 0;
+}
+
+/**
+ * Account a sample in the table on top of the Lua stack. The key is
+ * the semicolon-separated list of frames starting with the fiber
+ * name, as expected by flame graph tools. The signal handler records
+ * only the fiber id, so the name is looked up here. Samples of dead
+ * fibers are attributed to "fiber <id>".
+ */
+static void
+lbox_fiber_prof_entry(const struct sampler_sample *sample, void *arg)
+{
+	struct lua_State *L = (struct lua_State *)arg;
+	luaL_Buffer b;
+	luaL_buffinit(L, &b);
+	struct fiber *f = fiber_find(sample->fid);
+	if (f != NULL) {
+		luaL_addstring(&b, fiber_name(f));
+	} else {
+		luaL_addstring(&b, tt_sprintf("fiber %llu",
+				(unsigned long long)sample->fid));
+	}
+	for (int i = sample->bt.frame_count - 1; i >= 0; i--) {
+		uintptr_t offset;
+		const char *name =
+			backtrace_frame_resolve(&sample->bt.frames[i], &offset);
+		luaL_addchar(&b, ';');
+		luaL_addstring(&b, name != NULL ? name : "??");
+	}
+	luaL_pushresult(&b);
+	lua_pushvalue(L, -1);
+	lua_rawget(L, -3);
+	lua_Integer count = lua_tointeger(L, -1);
+	lua_pop(L, 1);
+	lua_pushinteger(L, count + 1);
+	lua_rawset(L, -3);
+}
+
+static int
+lbox_fiber_prof(struct lua_State *L)
+{
+	lua_newtable(L);
+	lua_pushliteral(L, "dropped");
+	luaL_pushint64(L, sampler_dropped_count());
+	lua_settable(L, -3);
+
+	lua_pushliteral(L, "samples");
+	lua_newtable(L);
+	sampler_foreach(lbox_fiber_prof_entry, L);
+	lua_settable(L, -3);
+	return 1;
+}
+#endif /* ENABLE_FIBER_SAMPLER */
+
 #ifdef ENABLE_BACKTRACE
 bool
 lbox_do_backtrace(struct lua_State *L, int index)
@@ -991,6 +1069,11 @@ static const struct luaL_Reg fiberlib[] = {
 	{"top", lbox_fiber_top},
 	{"top_enable", lbox_fiber_top_enable},
 	{"top_disable", lbox_fiber_top_disable},
+#ifdef ENABLE_FIBER_SAMPLER
+	{"prof", lbox_fiber_prof},
+	{"prof_enable", lbox_fiber_prof_enable},
+	{"prof_disable", lbox_fiber_prof_disable},
+#endif /* ENABLE_FIBER_SAMPLER */
 #ifdef ENABLE_BACKTRACE
 	{"parent_backtrace_enable", lbox_fiber_parent_backtrace_enable},
 	{"parent_backtrace_disable", lbox_fiber_parent_backtrace_disable},
@@ -79,6 +79,8 @@ end
 --
 --  max_connections -  Maximum number of entries in the connection cache
 --  max_total_connections -  Maximum number of active connections
+--  max_host_connections -  Maximum number of active connections to
+--                          a single host
 --
 --  Returns:
 --  curl object or raise error()
@@ -90,8 +92,10 @@ local http_new = function(opts)
 
     opts.max_connections = opts.max_connections or -1
     opts.max_total_connections = opts.max_total_connections or 0
+    opts.max_host_connections = opts.max_host_connections or 0
 
-    local curl = driver.new(opts.max_connections, opts.max_total_connections)
+    local curl = driver.new(opts.max_connections, opts.max_total_connections,
+                            opts.max_host_connections)
     return setmetatable({
         curl = curl,
         encoders = table.copy(encoders),
@@ -716,6 +720,12 @@ curl_mt = {
         --  failed_requests - this is a total number of requests which have
         --      failed (included systeme erros, curl errors, HTTP
         --      errors and so on)
+        --
+        --  connections_created - this is a total number of connections
+        --      established by requests
+        --
+        --  connections_reused - this is a total number of requests
+        --      served by a cached (kept alive) connection
         --  }
         --  or error()
         --
@@ -24,6 +24,9 @@ ffi.cdef[[
     extern bool
     say_logger_initialized(void);
 
+    extern int
+    say_logger_start_async(void);
+
     extern void
     say_from_lua(int level, const char *module, const char *filename, int line,
                  const char *format, ...);
@@ -123,6 +126,7 @@ end
 local default_cfg = {
     log             = nil,
     nonblock        = nil,
+    async           = false,
     level           = S_INFO,
     modules         = nil,
     format          = fmt_num2str[ffi.C.SF_PLAIN],
@@ -136,6 +140,7 @@ local log_cfg = table.copy(default_cfg)
 local log2box_keys = {
     ['log']             = 'log',
     ['nonblock']        = 'log_nonblock',
+    ['async']           = 'log_async',
     ['level']           = 'log_level',
     ['modules']         = 'log_modules',
     ['format']          = 'log_format',
@@ -324,6 +329,7 @@ Ratelimit.log_crit = log_ratelimited_closure(S_CRIT)
 local option_types = {
     log = 'string',
     nonblock = 'boolean',
+    async = 'boolean',
     level = 'number, string',
     modules = 'table',
     format = 'string',
@@ -390,6 +396,9 @@ local function log_check_cfg(cfg)
         if log_cfg.nonblock ~= cfg.nonblock then
             box.error(box.error.RELOAD_CFG, 'log_nonblock');
         end
+        if log_cfg.async ~= cfg.async then
+            box.error(box.error.RELOAD_CFG, 'log_async');
+        end
     end
 
     local cfg_C = log_C_cfg(cfg)
@@ -452,6 +461,9 @@ local function log_configure(self, cfg, box_api)
     local cfg_C = log_C_cfg(cfg)
     ffi.C.say_logger_init(cfg_C.log, cfg_C.level,
                           cfg_C.nonblock, cfg_C.format)
+    if cfg.async and ffi.C.say_logger_start_async() ~= 0 then
+        box.error()
+    end
     log_initialized = true
 
     for o in pairs(option_types) do
@@ -460,8 +472,9 @@ local function log_configure(self, cfg, box_api)
 
     box_cfg_update()
 
-    log_debug("log.cfg({log=%s, level=%s, nonblock=%s, format=%s})",
-              cfg.log, cfg.level, cfg.nonblock, cfg.format)
+    log_debug("log.cfg({log=%s, level=%s, nonblock=%s, async=%s, " ..
+              "format=%s})", cfg.log, cfg.level, cfg.nonblock, cfg.async,
+              cfg.format)
 end
 
 local compat_warning_said = false
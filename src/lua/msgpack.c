@@ -55,6 +55,7 @@
 
 #include "cord_buf.h"
 #include <fiber.h>
+#include <lua-cjson/lua_cjson.h>
 
 /**
  * Lua object that stores raw msgpack data and implements methods for decoding
@@ -77,12 +78,18 @@ struct luamp_object {
 	/** Pointer to the end of msgpack data. */
 	const char *data_end;
 	/**
-	 * Upon first indexation the MsgPack data is completely decoded,
-	 * pushed to Lua stack and referenced: the Lua stack reference is saved
-	 * to this field.
-	 * Initially set to `LUA_NOREF`.
+	 * Reference to a Lua table that caches values decoded on indexation
+	 * by the indexation key. Only the requested value is decoded, not
+	 * the whole MsgPack data. Initially set to `LUA_NOREF`.
 	 */
 	int decoded_ref;
+	/**
+	 * Position of an array item in the MsgPack data and its index
+	 * (starting from 1) used to look up the next item without skipping
+	 * all the preceding items. Valid only if cursor_index > 0.
+	 */
+	const char *cursor;
+	uint32_t cursor_index;
 	/**
 	 * Context used for decoding the MsgPack data. Default initialized.
 	 */
@@ -214,6 +221,49 @@ translate_map_key_field(struct luaL_field *field, uint32_t hash,
 	}
 }
 
+/**
+ * Encodes a scalar array item lying on the top of the Lua stack
+ * directly, bypassing luaL_tofield() and the recursive call. Returns
+ * false if the item isn't a plain string, finite number, boolean or nil,
+ * in which case the caller must fall back to the generic path. Tuples
+ * passed to space:insert() and friends consist mostly of such items.
+ */
+static inline bool
+luamp_encode_array_item_fast(struct lua_State *L, struct mpstream *stream)
+{
+	switch (lua_type(L, -1)) {
+	case LUA_TSTRING: {
+		size_t len;
+		const char *str = lua_tolstring(L, -1, &len);
+		mpstream_encode_strn(stream, str, len);
+		return true;
+	}
+	case LUA_TNUMBER: {
+		double num = lua_tonumber(L, -1);
+		double intpart;
+		if (!isfinite(num))
+			return false;
+		if (modf(num, &intpart) != 0.0)
+			mpstream_encode_double(stream, num);
+		else if (num >= 0 && num < exp2(64))
+			mpstream_encode_uint(stream, (uint64_t)num);
+		else if (num >= -exp2(63) && num < exp2(63))
+			mpstream_encode_int(stream, (int64_t)num);
+		else
+			mpstream_encode_double(stream, num);
+		return true;
+	}
+	case LUA_TBOOLEAN:
+		mpstream_encode_bool(stream, lua_toboolean(L, -1));
+		return true;
+	case LUA_TNIL:
+		mpstream_encode_nil(stream);
+		return true;
+	default:
+		return false;
+	}
+}
+
 int
 luamp_encode_with_ctx_r(struct lua_State *L,
 			struct luaL_serializer *cfg,
@@ -320,6 +370,10 @@ luamp_encode_with_ctx_r(struct lua_State *L,
 		mpstream_encode_array(stream, size);
 		for (uint32_t i = 0; i < size; i++) {
 			lua_rawgeti(L, top, i + 1);
+			if (luamp_encode_array_item_fast(L, stream)) {
+				lua_pop(L, 1);
+				continue;
+			}
 			if (luaL_tofield(L, cfg, top + 1, field) < 0)
 				goto error;
 			if (luamp_encode_with_ctx_r(
@@ -418,6 +472,170 @@ luamp_encode_with_ctx(struct lua_State *L, struct luaL_serializer *cfg,
 	return rc;
 }
 
+/*
+ * Map shape cache.
+ *
+ * Objects encoded as maps usually come in batches with the same keys
+ * in the same order (a shape), e.g. results of tuple:tomap() or rows
+ * returned over the network. For a shape seen before, the decoder
+ * duplicates a template table that already has all the keys and sets
+ * values by key strings interned once, so the keys aren't hashed and
+ * interned and the table isn't rehashed for every decoded map.
+ */
+enum {
+	/** Number of entries in the map shape cache. */
+	LUAMP_MAP_SHAPE_CACHE_SIZE = 64,
+	/** Min number of keys in a map to look it up in the cache. */
+	LUAMP_MAP_SHAPE_KEYS_MIN = 4,
+	/** Max number of keys in a map to look it up in the cache. */
+	LUAMP_MAP_SHAPE_KEYS_MAX = 64,
+};
+
+/** Map shape cache entry. */
+struct luamp_map_shape {
+	/** Lua state owning the references, NULL if unused. */
+	global_State *g;
+	/** Hash of the keys. */
+	uint32_t hash;
+	/** Number of keys. */
+	uint32_t size;
+	/** Reference to the array of the key strings or LUA_NOREF. */
+	int keys_ref;
+	/** Reference to the template table or LUA_NOREF. */
+	int template_ref;
+};
+
+static struct luamp_map_shape luamp_map_shapes[LUAMP_MAP_SHAPE_CACHE_SIZE];
+
+/**
+ * Calculate the hash of the keys of a map with @a size entries
+ * starting at @a data. Returns 0 if not all the keys are strings.
+ */
+static uint32_t
+luamp_map_shape_hash(const char *data, uint32_t size)
+{
+	uint32_t h = MH_STRN_HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+	for (uint32_t i = 0; i < size; i++) {
+		if (mp_typeof(*data) != MP_STR)
+			return 0;
+		uint32_t len;
+		const char *key = mp_decode_str(&data, &len);
+		PMurHash32_Process(&h, &carry, key, len);
+		/* Hash the length, too, so that {ab, c} != {a, bc}. */
+		PMurHash32_Process(&h, &carry, &len, sizeof(len));
+		total_size += len + sizeof(len);
+		mp_next(&data);
+	}
+	h = PMurHash32_Result(h, carry, total_size);
+	return h != 0 ? h : 1;
+}
+
+/** Release the references of a shape cache entry and reset it. */
+static void
+luamp_map_shape_reset(struct lua_State *L, struct luamp_map_shape *shape,
+		      uint32_t hash, uint32_t size)
+{
+	if (shape->g != NULL) {
+		assert(shape->g == G(L));
+		luaL_unref(L, LUA_REGISTRYINDEX, shape->keys_ref);
+		luaL_unref(L, LUA_REGISTRYINDEX, shape->template_ref);
+	}
+	shape->g = G(L);
+	shape->hash = hash;
+	shape->size = size;
+	shape->keys_ref = LUA_NOREF;
+	shape->template_ref = LUA_NOREF;
+}
+
+/**
+ * Create the array of key strings and the template table of
+ * a shape from a map starting at @a data.
+ */
+static void
+luamp_map_shape_create(struct lua_State *L, struct luamp_map_shape *shape,
+		       const char *data)
+{
+	lua_createtable(L, shape->size, 0);
+	lua_createtable(L, 0, shape->size);
+	for (uint32_t i = 0; i < shape->size; i++) {
+		uint32_t len;
+		const char *key = mp_decode_str(&data, &len);
+		lua_pushlstring(L, key, len);
+		lua_pushvalue(L, -1);
+		lua_rawseti(L, -4, i + 1);
+		lua_pushboolean(L, true);
+		lua_rawset(L, -3);
+		mp_next(&data);
+	}
+	shape->template_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	shape->keys_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+/**
+ * Decode a map with @a size entries starting at @a data using the
+ * shape cache. Returns 0 and pushes the table on success. Returns
+ * -1 and leaves the stack and @a data intact if the shape of the
+ * map isn't cached.
+ */
+static int
+luamp_decode_map_shape(struct lua_State *L, struct luaL_serializer *cfg,
+		       const char **data, uint32_t size, struct mp_ctx *ctx)
+{
+	uint32_t hash = luamp_map_shape_hash(*data, size);
+	if (hash == 0)
+		return -1;
+	struct luamp_map_shape *shape =
+		&luamp_map_shapes[hash % LUAMP_MAP_SHAPE_CACHE_SIZE];
+	if (shape->g != NULL && shape->g != G(L))
+		return -1;
+	if (shape->g == NULL || shape->hash != hash || shape->size != size) {
+		/*
+		 * Only remember the shape when seeing it for the first
+		 * time so that maps with unique keys don't pay for the
+		 * template creation.
+		 */
+		luamp_map_shape_reset(L, shape, hash, size);
+		return -1;
+	}
+	if (shape->keys_ref == LUA_NOREF)
+		luamp_map_shape_create(L, shape, *data);
+	/*
+	 * Keep the keys and the template on the stack: decoding of
+	 * nested maps may evict the entry.
+	 */
+	lua_rawgeti(L, LUA_REGISTRYINDEX, shape->keys_ref);
+	int keys_idx = lua_gettop(L);
+	/* Check the keys in case of a hash collision. */
+	const char *p = *data;
+	for (uint32_t i = 0; i < size; i++) {
+		uint32_t len;
+		const char *key = mp_decode_str(&p, &len);
+		lua_rawgeti(L, keys_idx, i + 1);
+		size_t cached_len;
+		const char *cached = lua_tolstring(L, -1, &cached_len);
+		lua_pop(L, 1);
+		if (cached_len != len || memcmp(cached, key, len) != 0) {
+			lua_pop(L, 1);
+			return -1;
+		}
+		mp_next(&p);
+	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, shape->template_ref);
+	luaT_duptable(L, -1);
+	lua_replace(L, -2);
+	for (uint32_t i = 0; i < size; i++) {
+		/* Skip the key, it's the same as the cached one. */
+		mp_next(data);
+		lua_rawgeti(L, keys_idx, i + 1);
+		luamp_decode_with_ctx(L, cfg, data, ctx);
+		lua_rawset(L, -3);
+	}
+	lua_remove(L, keys_idx);
+	return 0;
+}
+
 void
 luamp_decode_with_ctx(struct lua_State *L, struct luaL_serializer *cfg,
 		      const char **data, struct mp_ctx *ctx)
@@ -479,11 +697,15 @@ luamp_decode_with_ctx(struct lua_State *L, struct luaL_serializer *cfg,
 	case MP_MAP:
 	{
 		uint32_t size = mp_decode_map(data);
-		lua_createtable(L, 0, size);
-		for (uint32_t i = 0; i < size; i++) {
-			luamp_decode_with_ctx(L, cfg, data, ctx);
-			luamp_decode_with_ctx(L, cfg, data, ctx);
-			lua_settable(L, -3);
+		if (size < LUAMP_MAP_SHAPE_KEYS_MIN ||
+		    size > LUAMP_MAP_SHAPE_KEYS_MAX ||
+		    luamp_decode_map_shape(L, cfg, data, size, ctx) != 0) {
+			lua_createtable(L, 0, size);
+			for (uint32_t i = 0; i < size; i++) {
+				luamp_decode_with_ctx(L, cfg, data, ctx);
+				luamp_decode_with_ctx(L, cfg, data, ctx);
+				lua_settable(L, -3);
+			}
 		}
 		if (cfg->decode_save_metatables)
 			luaL_setmaphint(L, -1);
@@ -769,6 +991,8 @@ luamp_new_object(struct lua_State *L, size_t data_len)
 	obj->data = (char *)obj + sizeof(*obj);
 	obj->data_end = obj->data + data_len;
 	obj->decoded_ref = LUA_NOREF;
+	obj->cursor = NULL;
+	obj->cursor_index = 0;
 	mp_ctx_create_default(&obj->ctx, NULL);
 	luaL_getmetatable(L, luamp_object_typename);
 	lua_setmetatable(L, -2);
@@ -902,6 +1126,18 @@ luamp_object_decode(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Encodes the data stored in a msgpack object as JSON and pushes it to
+ * Lua stack. Takes a msgpack object as the only argument.
+ */
+static int
+luamp_object_tojson(struct lua_State *L)
+{
+	struct luamp_object *obj = luamp_check_object(L, 1);
+	luaL_json_encode_mp(L, obj->data);
+	return 1;
+}
+
 /**
  * Creates an iterator over a msgpack object and pushes it to Lua stack.
  * Takes a msgpack object as the only argument.
@@ -921,10 +1157,80 @@ luamp_object_iterator(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Looks up an item of the MsgPack array stored in a msgpack object by
+ * the Lua key at the given stack index. Returns a pointer to the item or
+ * NULL if the key isn't a valid array index.
+ */
+static const char *
+luamp_object_find_array_item(struct lua_State *L, struct luamp_object *obj,
+			     int key_idx)
+{
+	if (lua_type(L, key_idx) != LUA_TNUMBER)
+		return NULL;
+	const char *data = obj->data;
+	uint32_t size = mp_decode_array(&data);
+	double key = lua_tonumber(L, key_idx);
+	if (!(key >= 1 && key <= size) || key != (uint32_t)key)
+		return NULL;
+	uint32_t index = key;
+	if (obj->cursor_index == 0 || obj->cursor_index > index) {
+		obj->cursor = data;
+		obj->cursor_index = 1;
+	}
+	for (; obj->cursor_index < index; obj->cursor_index++)
+		mp_next(&obj->cursor);
+	return obj->cursor;
+}
+
+/**
+ * Looks up a value of the MsgPack map stored in a msgpack object by
+ * the Lua key at the given stack index. A MsgPack key matches the Lua key
+ * if it is decoded to an equal Lua value. If there are several matching
+ * keys, the last one wins, like on decoding of the whole map. Returns
+ * a pointer to the value or NULL if not found.
+ */
+static const char *
+luamp_object_find_map_value(struct lua_State *L, struct luamp_object *obj,
+			    int key_idx)
+{
+	int key_type = lua_type(L, key_idx);
+	size_t key_len = 0;
+	const char *key_str = NULL;
+	if (key_type == LUA_TSTRING)
+		key_str = lua_tolstring(L, key_idx, &key_len);
+	const char *found = NULL;
+	const char *data = obj->data;
+	uint32_t size = mp_decode_map(&data);
+	for (uint32_t i = 0; i < size; i++) {
+		bool match = false;
+		enum mp_type type = mp_typeof(*data);
+		if (type == MP_STR) {
+			uint32_t len;
+			const char *str = mp_decode_str(&data, &len);
+			match = key_str != NULL && len == key_len &&
+				memcmp(str, key_str, len) == 0;
+		} else if (type == MP_ARRAY || type == MP_MAP ||
+			   type == MP_EXT || key_type == LUA_TSTRING) {
+			/* Can't be equal to the key. */
+			mp_next(&data);
+		} else {
+			luamp_decode_with_ctx(L, obj->cfg, &data, &obj->ctx);
+			match = lua_rawequal(L, key_idx, -1);
+			lua_pop(L, 1);
+		}
+		if (match)
+			found = data;
+		mp_next(&data);
+	}
+	return found;
+}
+
 /**
  * Takes a `msgpack.object` and an indexation key as the arguments, indexes
  * the MsgPack stored in the `msgpack.object` and pushes the result to Lua stack
- * or, if the MsgPack data type is not indexable, pushes nil.
+ * or, if the MsgPack data type is not indexable, pushes nil. Only the indexed
+ * value is decoded. Decoded values are cached in the object.
  */
 static int
 luamp_object_get(struct lua_State *L)
@@ -933,37 +1239,56 @@ luamp_object_get(struct lua_State *L)
 	enum mp_type type = mp_typeof(*obj->data);
 	if (type != MP_MAP && type != MP_ARRAY)
 		return luaL_error(L, "not an array or map");
+	lua_settop(L, 2);
 	if (obj->decoded_ref == LUA_NOREF) {
-		const char *data = obj->data;
-		luamp_decode_with_ctx(L, obj->cfg, &data, &obj->ctx);
-		assert(data == obj->data_end);
+		lua_newtable(L);
 		obj->decoded_ref = luaL_ref(L, LUA_REGISTRYINDEX);
 	}
-	/* Pushes the decoded MsgPack data on top of the stack. */
+	/* Pushes the cache of decoded values on top of the stack. */
 	lua_rawgeti(L, LUA_REGISTRYINDEX, obj->decoded_ref);
-	/* Pushes the indexing key on top of the stack. */
-	lua_pushvalue(L, -2);
-	/* Indexes the decoded MsgPack data and pops the key. */
-	lua_rawget(L, -2);
-	if (!lua_isnil(L, -1) || obj->ctx.translation == NULL ||
-	    lua_type(L, -3) != LUA_TSTRING)
+	int cache_idx = lua_gettop(L);
+	if (lua_isnil(L, 2)) {
+		lua_pushnil(L);
+		return 1;
+	}
+	lua_pushvalue(L, 2);
+	lua_rawget(L, cache_idx);
+	if (!lua_isnil(L, -1))
+		return 1;
+	lua_pop(L, 1);
+	const char *value = type == MP_ARRAY ?
+		luamp_object_find_array_item(L, obj, 2) :
+		luamp_object_find_map_value(L, obj, 2);
+	if (value == NULL && obj->ctx.translation != NULL &&
+	    lua_type(L, 2) == LUA_TSTRING) {
+		size_t len;
+		const char *alias = lua_tolstring(L, 2, &len);
+		struct mh_strnu32_key_t key = {
+			.str = alias,
+			.len = len,
+			.hash = lua_hashstring(L, 2),
+		};
+		mh_int_t k = mh_strnu32_find(obj->ctx.translation, &key, NULL);
+		if (k != mh_end(obj->ctx.translation)) {
+			struct mh_strnu32_node_t *node =
+				mh_strnu32_node(obj->ctx.translation, k);
+			luaL_pushuint64(L, node->val);
+			value = type == MP_ARRAY ?
+				luamp_object_find_array_item(L, obj,
+							     lua_gettop(L)) :
+				luamp_object_find_map_value(L, obj,
+							    lua_gettop(L));
+			lua_pop(L, 1);
+		}
+	}
+	if (value == NULL) {
+		lua_pushnil(L);
 		return 1;
-
-	size_t len;
-	const char *alias = lua_tolstring(L, -3, &len);
-	struct mh_strnu32_key_t key = {
-		.str = alias,
-		.len = len,
-		.hash = lua_hashstring(L, -3),
-	};
-	mh_int_t k = mh_strnu32_find(obj->ctx.translation, &key, NULL);
-	if (k != mh_end(obj->ctx.translation)) {
-		lua_pop(L, 1);
-		struct mh_strnu32_node_t *node =
-			mh_strnu32_node(obj->ctx.translation, k);
-		luaL_pushuint64(L, node->val);
-		lua_rawget(L, -2);
 	}
+	luamp_decode_with_ctx(L, obj->cfg, &value, &obj->ctx);
+	lua_pushvalue(L, 2);
+	lua_pushvalue(L, -2);
+	lua_rawset(L, cache_idx);
 	return 1;
 }
 
@@ -1210,6 +1535,7 @@ luaopen_msgpack(lua_State *L)
 		{ "__index", luamp_object_index },
 		{ "__autocomplete", luamp_object_autocomplete },
 		{ "decode", luamp_object_decode },
+		{ "tojson", luamp_object_tojson },
 		{ "iterator", luamp_object_iterator },
 		{ "get", luamp_object_get },
 		{ NULL, NULL }
@@ -1862,6 +1862,132 @@ lbox_popen_write(struct lua_State *L)
 	return luaT_error(L);
 }
 
+/**
+ * Move data between a child peer and a file descriptor.
+ *
+ * @param handle        a handle of a child process
+ * @param fd            a file descriptor, number
+ * @param opts          an options table
+ * @param opts.stdin    whether to move data from @a fd to stdin,
+ *                      boolean (default: false)
+ * @param opts.stdout   whether to move data from stdout to @a fd,
+ *                      boolean (default: true)
+ * @param opts.stderr   whether to move data from stderr to @a fd,
+ *                      boolean (default: false)
+ * @param opts.timeout  time quota in seconds
+ *                      (default: 100 years)
+ *
+ * Move the data until EOF is read from the source. The data
+ * is moved by the kernel and doesn't pass through Lua strings,
+ * so it is the way to stream large amounts of data between a
+ * child and a file (fio handle's `fh`) or a socket (`s:fd()`).
+ * Only one of the std* options may be set. The function is
+ * available on Linux only.
+ *
+ * Example:
+ *
+ *  | local fio = require('fio')
+ *  | local popen = require('popen')
+ *  |
+ *  | local f = fio.open('dump.zst', {'O_WRONLY', 'O_CREAT'}, 420)
+ *  | local ph = popen.shell('zstd -c dump', 'r')
+ *  | ph:splice(f.fh)
+ *  | ph:close()
+ *  | f:close()
+ *
+ * Raise an error on incorrect parameters or when the fiber is
+ * cancelled:
+ *
+ * - IllegalParams:    incorrect type or value of a parameter.
+ * - IllegalParams:    called on a closed handle.
+ * - IllegalParams:    several std* options are set.
+ * - IllegalParams:    a requested IO operation is not supported
+ *                     by the handle (std* is not piped).
+ * - IllegalParams:    attempt to operate on a closed file
+ *                     descriptor.
+ * - IllegalParams:    the platform does not support splice.
+ * - FiberIsCancelled: cancelled by an outside code.
+ *
+ * Return amount of moved bytes on success.
+ *
+ * Return `nil, err` on a failure. Possible reasons:
+ *
+ * - SystemError: an IO error occurs at splice().
+ * - TimedOut:    @a timeout quota is exceeded.
+ */
+static int
+lbox_popen_splice(struct lua_State *L)
+{
+	struct popen_handle *handle;
+	bool is_closed;
+	unsigned int flags = POPEN_FLAG_NONE;
+	ev_tstamp timeout = TIMEOUT_INFINITY;
+
+	/* Extract handle and fd. */
+	if ((handle = luaT_check_popen_handle(L, 1, &is_closed)) == NULL ||
+	    lua_type(L, 2) != LUA_TNUMBER)
+		goto usage;
+	int fd = lua_tointeger(L, 2);
+	if (fd < 0)
+		goto usage;
+	if (is_closed)
+		return luaT_popen_handle_closed_error(L);
+
+	/* Extract options. */
+	if (!lua_isnoneornil(L, 3)) {
+		if (lua_type(L, 3) != LUA_TTABLE)
+			goto usage;
+
+		static const struct {
+			const char *name;
+			unsigned int flag;
+		} std_opts[] = {
+			{"stdin",	POPEN_FLAG_FD_STDIN	},
+			{"stdout",	POPEN_FLAG_FD_STDOUT	},
+			{"stderr",	POPEN_FLAG_FD_STDERR	},
+		};
+		for (size_t i = 0; i < lengthof(std_opts); i++) {
+			lua_getfield(L, 3, std_opts[i].name);
+			if (!lua_isnil(L, -1)) {
+				if (lua_type(L, -1) != LUA_TBOOLEAN)
+					goto usage;
+				if (lua_toboolean(L, -1) != 0)
+					flags |= std_opts[i].flag;
+			}
+			lua_pop(L, 1);
+		}
+
+		lua_getfield(L, 3, "timeout");
+		if (!lua_isnil(L, -1) &&
+		    (timeout = luaT_check_timeout(L, -1)) < 0.0)
+			goto usage;
+		lua_pop(L, 1);
+	}
+
+	/* Move data from stdout by default. */
+	if (flags == POPEN_FLAG_NONE)
+		flags = POPEN_FLAG_FD_STDOUT;
+
+	ssize_t rc = popen_splice_timeout(handle, fd, flags, timeout);
+	if (rc < 0) {
+		struct error *e = diag_last_error(diag_get());
+		if (e->type == &type_IllegalParams ||
+		    e->type == &type_FiberIsCancelled)
+			return luaT_error(L);
+		return luaT_push_nil_and_error(L);
+	}
+	lua_pushinteger(L, rc);
+	return 1;
+
+usage:
+	diag_set(IllegalParams, "Bad params, use: ph:splice(fd[, {"
+		 "stdin = <boolean>, "
+		 "stdout = <boolean>, "
+		 "stderr = <boolean>, "
+		 "timeout = <number>}])");
+	return luaT_error(L);
+}
+
 /**
  * Close parent's ends of std* fds.
  *
@@ -2470,6 +2596,7 @@ tarantool_lua_popen_init(struct lua_State *L)
 		{"wait",		lbox_popen_wait,	},
 		{"read",		lbox_popen_read,	},
 		{"write",		lbox_popen_write,	},
+		{"splice",		lbox_popen_splice,	},
 		{"shutdown",		lbox_popen_shutdown,	},
 		{"info",		lbox_popen_info,	},
 		{"close",		lbox_popen_close,	},
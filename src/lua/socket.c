@@ -52,6 +52,9 @@
 #include <coio.h> /* coio_wait() */
 #include <coio_task.h> /* coio_getaddrinfo() */
 #include <fiber.h>
+#include <small/ibuf.h>
+#include "cord_buf.h"
+#include "trivia/util.h"
 #include "lua/utils.h"
 #include "lua/fiber.h"
 
@@ -1022,6 +1025,198 @@ lbox_socket_pushsockopt(lua_State *L, const struct lbox_sockopt_reg *reg)
 	}
 }
 
+/** Limits of the batch calls, checked in Lua. */
+enum {
+	/** Max number of datagrams per batch call. */
+	SOCKET_BATCH_SIZE_MAX = 1024,
+	/** Max buffer size per datagram in recvfrom_batch. */
+	SOCKET_BATCH_RECV_SIZE_MAX = 65536,
+};
+
+#if TARGET_OS_DARWIN
+/*
+ * Mac OS doesn't have recvmmsg() and sendmmsg(), so they're emulated
+ * by receiving and sending datagrams one by one.
+ */
+
+/** A replacement of struct mmsghdr for the fallback implementation. */
+struct mmsghdr {
+	struct msghdr msg_hdr;
+	unsigned int msg_len;
+};
+
+/** recvmmsg() fallback receiving datagrams one by one. */
+static int
+recvmmsg(int fh, struct mmsghdr *msgs, unsigned int count, int flags,
+	 struct timespec *timeout)
+{
+	assert(timeout == NULL);
+	(void)timeout;
+	unsigned int i;
+	for (i = 0; i < count; i++) {
+		ssize_t rc = recvmsg(fh, &msgs[i].msg_hdr, flags);
+		if (rc < 0) {
+			if (i > 0 && (errno == EAGAIN ||
+				      errno == EWOULDBLOCK))
+				break;
+			return -1;
+		}
+		msgs[i].msg_len = rc;
+	}
+	return i;
+}
+
+/** sendmmsg() fallback sending datagrams one by one. */
+static int
+sendmmsg(int fh, struct mmsghdr *msgs, unsigned int count, int flags)
+{
+	unsigned int i;
+	for (i = 0; i < count; i++) {
+		ssize_t rc = sendmsg(fh, &msgs[i].msg_hdr, flags);
+		if (rc < 0) {
+			if (i > 0 && (errno == EAGAIN ||
+				      errno == EWOULDBLOCK))
+				break;
+			return -1;
+		}
+		msgs[i].msg_len = rc;
+	}
+	return i;
+}
+#endif /* TARGET_OS_DARWIN */
+
+/**
+ * internal.recvfrom_batch(fd, count, size, flags) - receive up to
+ * count datagrams of at most size bytes each in one call. Returns
+ * an array of datagrams and an array of their source addresses or
+ * nil on error (errno is set).
+ */
+static int
+lbox_socket_recvfrom_batch(struct lua_State *L)
+{
+	int fh = lua_tointeger(L, 1);
+	int count = lua_tointeger(L, 2);
+	int size = lua_tointeger(L, 3);
+	int flags = lua_tointeger(L, 4);
+	assert(count > 0 && count <= SOCKET_BATCH_SIZE_MAX);
+	assert(size >= 0 && size <= SOCKET_BATCH_RECV_SIZE_MAX);
+
+	/*
+	 * The buffer is a cord buffer, so it's put back on the next
+	 * yield even if pushing the results raises a Lua error.
+	 */
+	struct ibuf *ibuf = cord_ibuf_take();
+	/*
+	 * Allocate everything at once: ibuf_alloc() may reallocate
+	 * the buffer and invalidate the pointers returned earlier.
+	 * Put the structs first to keep them aligned.
+	 */
+	size_t addrs_size = count * sizeof(struct sockaddr_storage);
+	size_t msgs_size = count * sizeof(struct mmsghdr);
+	size_t iov_size = count * sizeof(struct iovec);
+	size_t data_size = (size_t)count * size;
+	char *buf = ibuf_alloc(ibuf, addrs_size + msgs_size + iov_size +
+			       data_size);
+	if (buf == NULL) {
+		cord_ibuf_put(ibuf);
+		errno = ENOMEM;
+		lua_pushnil(L);
+		return 1;
+	}
+	struct sockaddr_storage *addrs = (struct sockaddr_storage *)buf;
+	struct mmsghdr *msgs = (struct mmsghdr *)(buf + addrs_size);
+	struct iovec *iov = (struct iovec *)(buf + addrs_size + msgs_size);
+	char *data = buf + addrs_size + msgs_size + iov_size;
+	memset(msgs, 0, msgs_size);
+	for (int i = 0; i < count; i++) {
+		iov[i].iov_base = data + (size_t)i * size;
+		iov[i].iov_len = size;
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &addrs[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+	}
+	int rc = recvmmsg(fh, msgs, count, flags, NULL);
+	if (rc < 0) {
+		cord_ibuf_put(ibuf);
+		lua_pushnil(L);
+		return 1;
+	}
+	lua_createtable(L, rc, 0);
+	lua_createtable(L, rc, 0);
+	for (int i = 0; i < rc; i++) {
+		/* msg_len is the full length of a truncated datagram. */
+		lua_pushlstring(L, iov[i].iov_base,
+				MIN(msgs[i].msg_len, (unsigned int)size));
+		lua_rawseti(L, -3, i + 1);
+		lbox_socket_push_addr(L, msgs[i].msg_hdr.msg_name,
+				      msgs[i].msg_hdr.msg_namelen);
+		lua_rawseti(L, -2, i + 1);
+	}
+	cord_ibuf_put(ibuf);
+	return 2;
+}
+
+/**
+ * internal.sendto_batch(fd, host, port, datagrams, flags) - send
+ * an array of datagrams to the same destination in one call.
+ * Returns the number of sent datagrams or nil on error (errno is
+ * set). Less than #datagrams may be sent if the socket buffer is
+ * full.
+ */
+static int
+lbox_socket_sendto_batch(struct lua_State *L)
+{
+	int fh = lua_tointeger(L, 1);
+	const char *host = lua_tostring(L, 2);
+	const char *port = lua_tostring(L, 3);
+	int count = lua_objlen(L, 4);
+	int flags = lua_tointeger(L, 5);
+	assert(count > 0 && count <= SOCKET_BATCH_SIZE_MAX);
+
+	struct sockaddr_storage addr;
+	socklen_t addr_len = sizeof(addr);
+	if (lbox_socket_local_resolve(host, port, (struct sockaddr *)&addr,
+				      &addr_len) != 0) {
+		lua_pushnil(L);
+		return 1;
+	}
+	struct ibuf *ibuf = cord_ibuf_take();
+	/* One allocation, see lbox_socket_recvfrom_batch(). */
+	size_t msgs_size = count * sizeof(struct mmsghdr);
+	size_t iov_size = count * sizeof(struct iovec);
+	char *buf = ibuf_alloc(ibuf, msgs_size + iov_size);
+	if (buf == NULL) {
+		cord_ibuf_put(ibuf);
+		errno = ENOMEM;
+		lua_pushnil(L);
+		return 1;
+	}
+	struct mmsghdr *msgs = (struct mmsghdr *)buf;
+	struct iovec *iov = (struct iovec *)(buf + msgs_size);
+	memset(msgs, 0, msgs_size);
+	for (int i = 0; i < count; i++) {
+		lua_rawgeti(L, 4, i + 1);
+		size_t len;
+		/* The strings are anchored by the datagrams table. */
+		iov[i].iov_base = (void *)lua_tolstring(L, -1, &len);
+		iov[i].iov_len = len;
+		lua_pop(L, 1);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &addr;
+		msgs[i].msg_hdr.msg_namelen = addr_len;
+	}
+	int rc = sendmmsg(fh, msgs, count, flags);
+	cord_ibuf_put(ibuf);
+	if (rc < 0) {
+		lua_pushnil(L);
+		return 1;
+	}
+	lua_pushinteger(L, rc);
+	return 1;
+}
+
 void
 tarantool_lua_socket_init(struct lua_State *L)
 {
@@ -1031,6 +1226,8 @@ tarantool_lua_socket_init(struct lua_State *L)
 		{ "name",		lbox_socket_soname	},
 		{ "peer",		lbox_socket_peername	},
 		{ "recvfrom",		lbox_socket_recvfrom	},
+		{ "recvfrom_batch",	lbox_socket_recvfrom_batch	},
+		{ "sendto_batch",	lbox_socket_sendto_batch	},
 		{ "accept",		lbox_socket_accept	},
 		{ NULL,			NULL			}
 	};
@@ -903,6 +903,50 @@ local function socket_recvfrom(self, size, flags)
     return res, from
 end
 
+-- Max number of datagrams per recvfrom_batch/sendto_batch call.
+local SOCKET_BATCH_SIZE_MAX = 1024
+-- Default buffer size per datagram for recvfrom_batch.
+local SOCKET_BATCH_RECV_SIZE = 2048
+-- Max buffer size per datagram for recvfrom_batch.
+local SOCKET_BATCH_RECV_SIZE_MAX = 65536
+
+local function check_batch_count(count, method)
+    if type(count) ~= 'number' or count ~= math.floor(count) or
+       count < 1 or count > SOCKET_BATCH_SIZE_MAX then
+        error(string.format('socket.%s: count must be an integer ' ..
+                            'in range [1, %d]', method,
+                            SOCKET_BATCH_SIZE_MAX))
+    end
+end
+
+-- Receives up to count datagrams in one system call. Returns an
+-- array of datagrams and an array of their source addresses. Each
+-- datagram is truncated to size bytes.
+local function socket_recvfrom_batch(self, count, size, flags)
+    local fd = check_socket(self)
+    check_batch_count(count, 'recvfrom_batch')
+    local iflags = get_iflags(internal.SEND_FLAGS, flags)
+    if iflags == nil then
+        self._errno = boxerrno.EINVAL
+        return nil
+    end
+    size = size or SOCKET_BATCH_RECV_SIZE
+    if type(size) ~= 'number' or size ~= math.floor(size) or
+       size < 0 or size > SOCKET_BATCH_RECV_SIZE_MAX then
+        error(string.format('socket.recvfrom_batch: size must be an ' ..
+                            'integer in range [0, %d]',
+                            SOCKET_BATCH_RECV_SIZE_MAX))
+    end
+
+    self._errno = nil
+    local res, from = internal.recvfrom_batch(fd, count, size, iflags)
+    if res == nil then
+        self._errno = boxerrno()
+        return nil
+    end
+    return res, from
+end
+
 local function socket_sendto(self, host, port, octets, flags)
     local fd = check_socket(self)
     local iflags = get_iflags(internal.SEND_FLAGS, flags)
@@ -934,6 +978,39 @@ local function socket_sendto(self, host, port, octets, flags)
     return tonumber(res)
 end
 
+-- Sends an array of datagrams to the same destination in one
+-- system call. Returns the number of sent datagrams, it may be less
+-- than the array length if the socket buffer is full.
+local function socket_sendto_batch(self, host, port, datagrams, flags)
+    local fd = check_socket(self)
+    if type(datagrams) ~= 'table' then
+        error('Usage: socket:sendto_batch(host, port, datagrams[, flags])')
+    end
+    local iflags = get_iflags(internal.SEND_FLAGS, flags)
+    if iflags == nil then
+        self._errno = boxerrno.EINVAL
+        return nil
+    end
+    self._errno = nil
+    if #datagrams == 0 then
+        return 0
+    end
+    check_batch_count(#datagrams, 'sendto_batch')
+    for i = 1, #datagrams do
+        if type(datagrams[i]) ~= 'string' then
+            error(string.format('socket.sendto_batch: datagram #%d ' ..
+                                'must be a string', i))
+        end
+    end
+    local res = internal.sendto_batch(fd, tostring(host), tostring(port),
+                                      datagrams, iflags)
+    if res == nil then
+        self._errno = boxerrno()
+        return nil
+    end
+    return res
+end
+
 local function check_socket_args(domain, stype, proto)
     local idomain = get_ivalue(internal.DOMAIN, domain)
     if idomain == nil then
@@ -1317,6 +1394,8 @@ socket_mt   = {
         recv = socket_recv;
         recvfrom = socket_recvfrom;
         sendto = socket_sendto;
+        recvfrom_batch = socket_recvfrom_batch;
+        sendto_batch = socket_sendto_batch;
         name = socket_name;
         peer = socket_peer;
         fd = socket_fd;
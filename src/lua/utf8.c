@@ -28,6 +28,7 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <string.h>
 #include <unicode/ucasemap.h>
 #include <unicode/uchar.h>
 #include "coll/coll.h"
@@ -146,6 +147,27 @@ utf8_convert_offset(int offset, size_t len)
 	return len + offset + 1;
 }
 
+/**
+ * Skip ASCII characters in @a str starting from @a pos, but not
+ * further than @a end. The string is scanned word by word so that
+ * long ASCII runs don't go through the UTF-8 decoder.
+ * @return Position of the first non-ASCII byte or @a end.
+ */
+static inline int
+utf8_skip_ascii(const char *str, int pos, int end)
+{
+	while (pos + (int)sizeof(uint64_t) <= end) {
+		uint64_t word;
+		memcpy(&word, str + pos, sizeof(word));
+		if ((word & 0x8080808080808080ULL) != 0)
+			break;
+		pos += sizeof(uint64_t);
+	}
+	while (pos < end && (unsigned char)str[pos] < 0x80)
+		pos++;
+	return pos;
+}
+
 /**
  * Calculate length of a UTF8 string. Length here is symbol count.
  * Works like utf8.len in Lua 5.3. Can take negative offsets. A
@@ -181,6 +203,12 @@ utf8_len(struct lua_State *L)
 	if (end_pos > start_pos) {
 		UChar32 c;
 		while (start_pos < end_pos) {
+			int next_pos = utf8_skip_ascii(str, start_pos,
+						       end_pos);
+			result += next_pos - start_pos;
+			start_pos = next_pos;
+			if (start_pos >= end_pos)
+				break;
 			++result;
 			U8_NEXT(str, start_pos, len, c);
 			if (c == U_SENTINEL) {
@@ -143,6 +143,17 @@ luaL_pushcdata(struct lua_State *L, uint32_t ctypeid)
 	return cdataptr(cd);
 }
 
+void
+luaT_duptable(struct lua_State *L, int idx)
+{
+	TValue *o = index2adr(L, idx);
+	assert(tvistab(o));
+	GCtab *t = lj_tab_dup(L, tabV(o));
+	settabV(L, L->top, t);
+	incr_top(L);
+	lj_gc_check(L);
+}
+
 void
 luaT_pushvclock(struct lua_State *L, const struct vclock *vclock)
 {
@@ -195,6 +195,15 @@ luaL_iscdata(struct lua_State *L, int idx);
 LUA_API void *
 luaL_pushcdata(struct lua_State *L, uint32_t ctypeid);
 
+/**
+ * Push a copy of the table at @a idx onto the stack. The copy is
+ * made with lj_tab_dup(), so it has the same keys and values and
+ * the same sizes of the array and hash parts as the original, but
+ * no metatable.
+ */
+void
+luaT_duptable(struct lua_State *L, int idx);
+
 /**
  * @brief Checks whether the function argument idx is a cdata
  * @param L Lua State
@@ -544,6 +544,8 @@ tarantool_atexit(void)
 		return;
 
 	free_rl_state();
+	/* Don't lose messages queued by the asynchronous logger. */
+	say_logger_flush();
 }
 
 static void
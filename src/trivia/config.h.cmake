@@ -71,6 +71,11 @@
  * showing fiber call stack.
  */
 #cmakedefine ENABLE_BACKTRACE 1
+/*
+ * Defined if configured with ENABLE_USDT (static tracing probes,
+ * see lib/core/usdt.h).
+ */
+#cmakedefine ENABLE_USDT 1
 /*
  * Defined if configured with ABORT_ON_LEAK.
  */
@@ -99,6 +104,7 @@
 #define MAP_ANONYMOUS MAP_ANON
 #endif
 #cmakedefine HAVE_MADV_DONTNEED 1
+#cmakedefine HAVE_MADV_HUGEPAGE 1
 /*
  * Defined if O_DSYNC mode exists for open(2).
  */
@@ -218,6 +224,8 @@
 
 #cmakedefine HAVE_PTHREAD_GET_STACKSIZE_NP 1
 #cmakedefine HAVE_PTHREAD_GET_STACKADDR_NP 1
+/** pthread_setaffinity_np(pthread_self(), size, cpus) - Linux */
+#cmakedefine HAVE_PTHREAD_SETAFFINITY_NP 1
 
 #cmakedefine HAVE_SETPROCTITLE 1
 #cmakedefine HAVE_SETPROGNAME 1
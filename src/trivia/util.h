@@ -674,6 +674,44 @@ json_escape_char(char c)
 	return json_char2escape[(unsigned char)c];
 }
 
+/**
+ * Returns the length of the longest prefix of @a data of size @a len
+ * that doesn't contain characters that should be escaped when encoded
+ * in JSON. Checks eight characters at a time.
+ */
+static inline size_t
+json_escape_prefix_len(const char *data, size_t len)
+{
+	extern bool json_escape_forward_slash;
+	const uint64_t ones = 0x0101010101010101ULL;
+	const uint64_t quote = ones * '"';
+	const uint64_t backslash = ones * '\\';
+	const uint64_t del = ones * 0x7f;
+	const uint64_t slash = ones * '/';
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+		uint64_t w;
+		memcpy(&w, data + i, sizeof(w));
+		/*
+		 * The high bit of a byte of the mask may be set only if
+		 * the word has a control character, a quote, a backslash
+		 * or a DEL, see "Determine if a word has a byte less than
+		 * n" in Bit Twiddling Hacks.
+		 */
+		uint64_t mask = (w - ones * 0x20) & ~w;
+		mask |= ((w ^ quote) - ones) & ~(w ^ quote);
+		mask |= ((w ^ backslash) - ones) & ~(w ^ backslash);
+		mask |= ((w ^ del) - ones) & ~(w ^ del);
+		if (json_escape_forward_slash)
+			mask |= ((w ^ slash) - ones) & ~(w ^ slash);
+		if ((mask & (ones * 0x80)) != 0)
+			break;
+	}
+	while (i < len && json_escape_char(data[i]) == NULL)
+		i++;
+	return i;
+}
+
 /**
  * Escape special characters in @a data to @a buf
  */
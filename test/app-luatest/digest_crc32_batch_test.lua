@@ -0,0 +1,34 @@
+local digest = require('digest')
+local t = require('luatest')
+
+local g = t.group()
+
+g.test_crc32_batch = function()
+    local keys = {'', 'a', 'abc', 'tarantool', 12345}
+    local crcs = digest.crc32_batch(keys)
+    t.assert_equals(#crcs, #keys)
+    for i, key in ipairs(keys) do
+        t.assert_equals(crcs[i], digest.crc32(tostring(key)))
+    end
+    t.assert_equals(digest.crc32_batch({}), {})
+end
+
+g.test_crc32_batch_bucket_id = function()
+    local keys = {}
+    for i = 1, 1000 do
+        keys[i] = 'key' .. i
+    end
+    local bucket_ids = digest.crc32_batch(keys, 3000)
+    for i, key in ipairs(keys) do
+        t.assert_equals(bucket_ids[i], digest.crc32(key) % 3000 + 1)
+    end
+end
+
+g.test_crc32_batch_errors = function()
+    t.assert_error_msg_contains('Usage: digest.crc32_batch',
+                                digest.crc32_batch, 'abc')
+    t.assert_error_msg_contains('key #2 must be a string',
+                                digest.crc32_batch, {'a', {}})
+    t.assert_error_msg_contains('bucket_count must be a positive number',
+                                digest.crc32_batch, {'a'}, 0)
+end
@@ -0,0 +1,105 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        t.skip_if(fiber.prof_enable == nil, 'requires fiber profiler')
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        require('fiber').prof_disable()
+    end)
+end)
+
+-- Check that the profiler samples the stacks of a busy fiber.
+g.test_prof = function(cg)
+    cg.server:exec(function()
+        local clock = require('clock')
+        local fiber = require('fiber')
+        fiber.prof_enable(0.001)
+        local done = fiber.cond()
+        local f = fiber.new(function()
+            local deadline = clock.thread() + 0.2
+            while clock.thread() < deadline do
+                local s = 0
+                for i = 1, 1000 do
+                    s = s + i
+                end
+            end
+            done:wait()
+        end)
+        f:set_joinable(true)
+        f:name('prof_busy')
+        fiber.yield()
+        fiber.prof_disable()
+
+        -- Names are looked up when the profile is read, so keep
+        -- the fiber alive until then.
+        local prof = fiber.prof()
+        t.assert_equals(prof.dropped, 0)
+        local total = 0
+        for stack, count in pairs(prof.samples) do
+            if stack:startswith('prof_busy;') then
+                total = total + count
+            end
+        end
+        t.assert_gt(total, 0)
+
+        -- The samples are kept after the profiler is stopped.
+        t.assert_equals(fiber.prof(), prof)
+
+        -- Samples of a dead fiber are attributed to its id.
+        local prefix = 'fiber ' .. f:id() .. ';'
+        done:signal()
+        f:join()
+        local dead_total = 0
+        for stack, count in pairs(fiber.prof().samples) do
+            if stack:startswith(prefix) then
+                dead_total = dead_total + count
+            end
+        end
+        t.assert_equals(dead_total, total)
+    end)
+end
+
+-- Check the interval argument validation.
+g.test_invalid = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        t.assert_error_msg_contains('interval must be positive',
+                                    fiber.prof_enable, 0)
+        t.assert_error_msg_contains('number expected',
+                                    fiber.prof_enable, 'foo')
+    end)
+end
+
+-- Check that the profiler doesn't take SIGPROF over from sysprof.
+g.test_sysprof = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local ok = misc.sysprof.start({mode = 'D'})
+        t.skip_if(not ok, 'requires sysprof')
+        local res, err = pcall(fiber.prof_enable)
+        misc.sysprof.stop()
+        t.assert_not(res)
+        t.assert_str_contains(tostring(err),
+                              'SIGPROF is used by another profiler')
+        -- Works once sysprof is stopped.
+        fiber.prof_enable()
+        fiber.prof_disable()
+    end)
+end
@@ -97,6 +97,19 @@ g.test_http_client = function(cg)
     t.assert_equals(r.status, 200, 'request')
 end
 
+g.test_connection_stat = function(cg)
+    local url, opts = cg.url, cg.opts
+    local http = client.new({max_host_connections = 1})
+    for _ = 1, 5 do
+        t.assert_equals(http:get(url, opts).status, 200)
+    end
+    -- Every request either opens a connection or reuses a kept
+    -- alive one.
+    local st = http:stat()
+    t.assert_equals(st.connections_created + st.connections_reused, 5)
+    t.assert_ge(st.connections_created, 1)
+end
+
 g.test_follow_location = function(cg)
     -- gh-4119: specify whether to follow 'Location' header
     local url, opts = cg.url, cg.opts
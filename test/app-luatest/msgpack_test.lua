@@ -472,6 +472,24 @@ g.test_object_get = function()
     mp = msgpack.object_from_raw('\x81\xd0\x01\xc3')
     t.assert(mp:get(1))
 
+    -- Checks that the last of duplicate keys wins, like on decoding.
+    mp = msgpack.object_from_raw('\x82\x01\x02\x01\x03')
+    t.assert_equals(mp:get(1), 3)
+
+    -- Checks that array items are looked up correctly in any order and
+    -- that decoded values are cached.
+    local big_array = {}
+    for i = 1, 100 do
+        big_array[i] = {i}
+    end
+    mp = msgpack.object(big_array)
+    for _, i in ipairs({50, 51, 100, 1, 2, 99, 50}) do
+        t.assert_equals(mp:get(i), {i})
+    end
+    t.assert_is(mp:get(10), mp:get(10))
+    t.assert_equals(mp:get(101), nil)
+    t.assert_equals(mp:decode(), big_array)
+
     mp = msgpack.object(1)
     t.assert_error_msg_content_equals('not an array or map',
                                       function() return mp:get(1)  end)
@@ -815,3 +833,46 @@ g_error_details.test_error_details = function(cg)
         },
     })
 end
+
+-- Checks decoding of maps of the same shape that go through the map
+-- shape cache.
+g.test_decode_map_shape = function()
+    for i = 1, 100 do
+        local obj = {
+            id = i,
+            name = 'name' .. i,
+            value = i % 2 == 0 and box.NULL or i / 2,
+            tags = {'a', 'b', i},
+            nested = {a = i, b = i + 1, c = i + 2, d = {i}},
+        }
+        t.assert_equals(msgpack.decode(msgpack.encode(obj)), obj)
+    end
+    local cases = {
+        -- Same keys in a different order.
+        {'\x84\xa1a\x01\xa1b\x02\xa1c\x03\xa1d\x04',
+         {a = 1, b = 2, c = 3, d = 4}},
+        {'\x84\xa1d\x04\xa1c\x03\xa1b\x02\xa1a\x01',
+         {a = 1, b = 2, c = 3, d = 4}},
+        -- Duplicate keys: the last value wins.
+        {'\x84\xa1a\x01\xa1b\x02\xa1a\x03\xa1c\x04',
+         {a = 3, b = 2, c = 4}},
+        -- Keys that differ only in the split between neighbours.
+        {'\x84\xa2ab\x01\xa1c\x02\xa1d\x03\xa1e\x04',
+         {ab = 1, c = 2, d = 3, e = 4}},
+        {'\x84\xa1a\x01\xa2bc\x02\xa1d\x03\xa1e\x04',
+         {a = 1, bc = 2, d = 3, e = 4}},
+    }
+    for _ = 1, 3 do
+        for _, case in ipairs(cases) do
+            t.assert_equals(msgpack.decode(case[1]), case[2])
+        end
+    end
+    -- The decoded tables are independent.
+    local encoded = msgpack.encode({k1 = 1, k2 = 2, k3 = 3, k4 = 4})
+    local a = msgpack.decode(encoded)
+    local b = msgpack.decode(encoded)
+    a.k1 = 10
+    a.k5 = 5
+    t.assert_equals(b, {k1 = 1, k2 = 2, k3 = 3, k4 = 4})
+    t.assert_equals(msgpack.decode(encoded), {k1 = 1, k2 = 2, k3 = 3, k4 = 4})
+end
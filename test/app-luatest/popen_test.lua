@@ -58,3 +58,52 @@ g.test_inherit_fds = function()
     t.assert_equals(ffi.string(ibuf.rpos, #msg), msg)
     ibuf:recycle()
 end
+
+g.test_splice = function()
+    t.skip_if(jit.os ~= 'Linux', 'splice is Linux specific')
+    local fio = require('fio')
+    local dir = fio.tempdir()
+    local expected = {}
+    for i = 1, 100000 do
+        expected[i] = tostring(i)
+    end
+    expected = table.concat(expected, '\n') .. '\n'
+    local function read_file(path)
+        local f = fio.open(path)
+        local data = f:read()
+        f:close()
+        return data
+    end
+
+    -- stdout -> file.
+    local path = fio.pathjoin(dir, 'out')
+    local f = fio.open(path, {'O_WRONLY', 'O_CREAT'}, tonumber('644', 8))
+    local ph = popen.shell('seq 1 100000', 'r')
+    t.assert_equals(ph:splice(f.fh), #expected)
+    t.assert_equals(ph:wait().exit_code, 0)
+    ph:close()
+    f:close()
+    t.assert_equals(read_file(path), expected)
+
+    -- file -> stdin.
+    local copy = fio.pathjoin(dir, 'copy')
+    f = fio.open(path)
+    ph = popen.shell('cat > ' .. copy, 'w')
+    t.assert_equals(ph:splice(f.fh, {stdin = true}), #expected)
+    ph:shutdown({stdin = true})
+    t.assert_equals(ph:wait().exit_code, 0)
+    ph:close()
+    f:close()
+    t.assert_equals(read_file(copy), expected)
+
+    ph = popen.shell('true', 'r')
+    t.assert_error_msg_contains('Bad params, use: ph:splice(fd',
+                                ph.splice, ph, 'foo')
+    t.assert_error_msg_contains('exactly one of stdin, stdout and stderr',
+                                ph.splice, ph, 1,
+                                {stdout = true, stderr = true})
+    t.assert_error_msg_contains('does not support the requested IO',
+                                ph.splice, ph, 1, {stdin = true})
+    ph:close()
+    fio.rmtree(dir)
+end
@@ -82,3 +82,50 @@ g.test_socketpair = function()
     t.assert(s1:close())
     t.assert(s2:close())
 end
+
+g.test_batch_udp = function()
+    local s1 = socket('AF_INET', 'SOCK_DGRAM', 'udp')
+    local s2 = socket('AF_INET', 'SOCK_DGRAM', 'udp')
+    t.assert(s1:bind('127.0.0.1', 0))
+    t.assert(s2:bind('127.0.0.1', 0))
+    local port = s1:name().port
+
+    local datagrams = {}
+    for i = 1, 100 do
+        datagrams[i] = string.rep(tostring(i % 10), i)
+    end
+    t.assert_equals(s2:sendto_batch('127.0.0.1', port, datagrams), 100)
+    t.assert_equals(s2:sendto_batch('127.0.0.1', port, {}), 0)
+
+    local received = {}
+    while #received < 100 do
+        t.assert(s1:readable(1))
+        local data, from = s1:recvfrom_batch(64, 50)
+        t.assert(data)
+        t.assert_equals(#from, #data)
+        for i = 1, #data do
+            t.assert_equals(from[i].port, s2:name().port)
+            table.insert(received, data[i])
+        end
+    end
+    for i = 1, 100 do
+        -- Datagrams longer than the buffer size are truncated.
+        t.assert_equals(received[i], datagrams[i]:sub(1, 50))
+    end
+
+    -- No datagrams.
+    t.assert_equals(s1:recvfrom_batch(10), nil)
+    t.assert_equals(s1:errno(), errno.EAGAIN)
+
+    t.assert_error_msg_contains('count must be an integer',
+                                s1.recvfrom_batch, s1, 0)
+    t.assert_error_msg_contains('size must be an integer',
+                                s1.recvfrom_batch, s1, 10, -1)
+    t.assert_error_msg_contains('size must be an integer',
+                                s1.recvfrom_batch, s1, 10, 1e9)
+    t.assert_error_msg_contains('datagram #2 must be a string',
+                                s2.sendto_batch, s2, '127.0.0.1', port,
+                                {'a', 1})
+    s1:close()
+    s2:close()
+end
@@ -3192,6 +3192,139 @@ test_box_session_id(struct lua_State *L)
 
 /* }}} Helpers for current session identifier Lua/C API test cases */
 
+/* {{{ Helpers for `box_space_on_replace` Lua/C API test cases */
+
+/** Number of times space_on_replace_f() was called. */
+static int space_on_replace_count;
+
+/**
+ * Counts calls. Fails if the new tuple has the second field equal to
+ * the trigger argument.
+ */
+static int
+space_on_replace_f(void *arg, box_tuple_t *old_tuple, box_tuple_t *new_tuple)
+{
+	(void)old_tuple;
+	space_on_replace_count++;
+	const char *field = new_tuple != NULL ?
+			    box_tuple_field(new_tuple, 1) : NULL;
+	if (field != NULL && mp_typeof(*field) == MP_UINT &&
+	    mp_decode_uint(&field) == *(uint32_t *)arg) {
+		box_error_set(__FILE__, __LINE__, 10, "trigger failed");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_box_space_on_replace_set(struct lua_State *L)
+{
+	static uint32_t fail_value;
+	fail_unless(lua_gettop(L) == 2);
+	uint32_t space_id = luaL_checkinteger(L, 1);
+	fail_value = luaL_checkinteger(L, 2);
+	space_on_replace_count = 0;
+	lua_pushboolean(L, box_space_on_replace(space_id, &fail_value,
+						space_on_replace_f,
+						NULL) == 0);
+	return 1;
+}
+
+static int
+test_box_space_on_replace_reset(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	uint32_t space_id = luaL_checkinteger(L, 1);
+	lua_pushboolean(L, box_space_on_replace(space_id, NULL, NULL,
+						space_on_replace_f) == 0);
+	return 1;
+}
+
+static int
+test_box_space_on_replace_count(struct lua_State *L)
+{
+	lua_pushinteger(L, space_on_replace_count);
+	return 1;
+}
+
+/* }}} Helpers for `box_space_on_replace` Lua/C API test cases */
+
+/* {{{ Helpers for `box_read_view` Lua/C API test cases */
+
+static int
+test_box_read_view_open(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	box_read_view_t *rv = box_read_view_open(luaL_checkstring(L, 1));
+	fail_unless(rv != NULL);
+	lua_pushlightuserdata(L, rv);
+	return 1;
+}
+
+static int
+test_box_read_view_close(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 1);
+	box_read_view_close((box_read_view_t *)lua_touserdata(L, 1));
+	return 0;
+}
+
+/**
+ * Returns the number of tuples stored in the primary index of a space
+ * in a read view or nil if the space isn't in the read view.
+ */
+static int
+test_box_read_view_count(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 2);
+	box_read_view_t *rv = (box_read_view_t *)lua_touserdata(L, 1);
+	uint32_t space_id = luaL_checkinteger(L, 2);
+	box_read_view_iterator_t *it;
+	if (box_read_view_iterator_all(rv, space_id, 0, &it) != 0)
+		return 0;
+	int count = 0;
+	const char *data;
+	uint32_t size;
+	do {
+		fail_unless(box_read_view_iterator_next_raw(it, &data,
+							    &size) == 0);
+		if (data != NULL) {
+			fail_unless(mp_typeof(*data) == MP_ARRAY);
+			count++;
+		}
+	} while (data != NULL);
+	box_read_view_iterator_free(it);
+	lua_pushinteger(L, count);
+	return 1;
+}
+
+/**
+ * Takes an iterator step, closes the read view, and checks that
+ * the next iterator step fails.
+ */
+static int
+test_box_read_view_close_iterator(struct lua_State *L)
+{
+	fail_unless(lua_gettop(L) == 2);
+	box_read_view_t *rv = (box_read_view_t *)lua_touserdata(L, 1);
+	uint32_t space_id = luaL_checkinteger(L, 2);
+	box_read_view_iterator_t *it;
+	fail_unless(box_read_view_iterator_all(rv, space_id, 0, &it) == 0);
+	const char *data;
+	uint32_t size;
+	fail_unless(box_read_view_iterator_next_raw(it, &data, &size) == 0);
+	fail_unless(data != NULL);
+	box_read_view_close(rv);
+	fail_unless(box_read_view_iterator_next_raw(it, &data, &size) != 0);
+	box_error_t *e = box_error_last();
+	fail_unless(strcmp(box_error_message(e), "read view is closed") == 0);
+	box_read_view_iterator_free(it);
+	lua_pushboolean(L, true);
+	return 1;
+}
+
+/* }}} Helpers for `box_read_view` Lua/C API test cases */
+
 /* {{{ Helpers for `box_iproto_send` Lua/C API test cases */
 
 static int
@@ -3412,6 +3545,14 @@ luaopen_module_api(lua_State *L)
 		{"box_iproto_send", test_box_iproto_send},
 		{"box_iproto_override_set", test_box_iproto_override_set},
 		{"box_iproto_override_reset", test_box_iproto_override_reset},
+		{"box_space_on_replace_set", test_box_space_on_replace_set},
+		{"box_space_on_replace_reset", test_box_space_on_replace_reset},
+		{"box_space_on_replace_count", test_box_space_on_replace_count},
+		{"box_read_view_open", test_box_read_view_open},
+		{"box_read_view_close", test_box_read_view_close},
+		{"box_read_view_count", test_box_read_view_count},
+		{"box_read_view_close_iterator",
+		 test_box_read_view_close_iterator},
 		{NULL, NULL}
 	};
 	luaL_register(L, "module_api", lib);
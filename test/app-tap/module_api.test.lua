@@ -670,8 +670,62 @@ local function test_box_ibuf(test, module)
     test:ok(module.box_ibuf(require('buffer').ibuf()), "box_ibuf API")
 end
 
+local function test_box_space_on_replace(test, module)
+    test:plan(8)
+
+    local s = box.schema.space.create('test_on_replace')
+    s:create_index('pk')
+    test:ok(module.box_space_on_replace_set(s.id, 13), 'trigger is set')
+    s:insert({1, 1})
+    s:replace({1, 2})
+    s:delete({1})
+    test:is(module.box_space_on_replace_count(), 3, 'trigger is called')
+    local ok, err = pcall(s.insert, s, {2, 13})
+    test:ok(not ok and err.message == 'trigger failed',
+            'trigger error is raised')
+    test:is(s:get({2}), nil, 'statement is rolled back')
+    s:alter({name = 'test_on_replace_renamed'})
+    s:insert({3, 3})
+    test:is(module.box_space_on_replace_count(), 5,
+            'trigger is kept on alter')
+    test:ok(module.box_space_on_replace_reset(s.id), 'trigger is deleted')
+    s:insert({4, 4})
+    test:is(module.box_space_on_replace_count(), 5,
+            'trigger is not called after deletion')
+    test:ok(not module.box_space_on_replace_reset(s.id),
+            'deleting a missing trigger fails')
+    s:drop()
+end
+
+local function test_box_read_view(test, module)
+    test:plan(7)
+
+    local s = box.schema.space.create('test_read_view')
+    s:create_index('pk')
+    for i = 1, 3 do
+        s:insert({i})
+    end
+    local rv = module.box_read_view_open('test_c')
+    s:insert({4})
+    s:delete({1})
+    test:is(module.box_read_view_count(rv, s.id), 3,
+            'changes done after open are not visible')
+    test:is(module.box_read_view_count(rv, 0), nil,
+            'missing space is not in the read view')
+    local list = box.read_view.list()
+    test:is(#list, 1, 'read view is listed')
+    test:is(list[1].name, 'test_c', 'read view name')
+    local ok, err = pcall(list[1].close, list[1])
+    test:ok(not ok and err:match('read view is busy') ~= nil,
+            'read view opened from C is not closed from Lua')
+    test:ok(module.box_read_view_close_iterator(rv, s.id),
+            'iterator is invalidated on close')
+    test:is(#box.read_view.list(), 0, 'read view is closed')
+    s:drop()
+end
+
 require('tap').test("module_api", function(test)
-    test:plan(50)
+    test:plan(52)
     local status, module = pcall(require, 'module_api')
     test:is(status, true, "module")
     test:ok(status, "module is loaded")
@@ -709,6 +763,8 @@ require('tap').test("module_api", function(test)
     test:test("box_iproto_send", test_box_iproto_send, module)
     test:test("box_iproto_override", test_box_iproto_override, module)
     test:test("box_ibuf", test_box_ibuf, module)
+    test:test("box_space_on_replace", test_box_space_on_replace, module)
+    test:test("box_read_view", test_box_read_view, module)
 
     space:drop()
 end)
@@ -206,7 +206,7 @@ test:test("strip", function(test)
 end)
 
 test:test("unicode", function(test)
-    test:plan(104)
+    test:plan(107)
     local str = 'хеЛлоу вОрЛд ё Ё я Я э Э ъ Ъ hElLo WorLd 1234 i I İ 勺#☢༺'
     local upper_res = 'ХЕЛЛОУ ВОРЛД Ё Ё Я Я Э Э Ъ Ъ HELLO WORLD 1234 I I İ 勺#☢༺'
     local lower_res = 'хеллоу ворлд ё ё я я э э ъ ъ hello world 1234 i i i̇ 勺#☢༺'
@@ -271,6 +271,11 @@ test:test("unicode", function(test)
     test:is(utf8.len(s, 3, 3), 1, "end in the middle on the same symbol as start")
     _, err = utf8.len('a\xF4')
     test:is(err, 2, "invalid unicode in the middle of the string")
+    s = string.rep('a', 37)
+    test:is(utf8.len(s .. '☢' .. s), 75, 'len works on long ascii runs')
+    test:is(utf8.len(s .. '☢' .. s, 30, 45), 14, 'ascii runs with offsets')
+    _, err = utf8.len(s .. '\xF4' .. s)
+    test:is(err, 38, 'invalid unicode after a long ascii run')
 
     local chars = {}
     local codes = {}
@@ -3,7 +3,7 @@ local t = require('luatest')
 
 local g = t.group("invalid compression type", t.helpers.matrix({
     engine = {'memtx', 'vinyl'},
-    compression = {'zstd', 'lz4'}
+    compression = {'lz4', 'zlib'}
 }))
 
 g.before_all(function(cg)
@@ -54,6 +54,56 @@ g.after_test('test_invalid_compression_type_during_setting_format', function(cg)
     end)
 end)
 
+g = t.group("zstd compression in vinyl")
+
+g.before_all(function(cg)
+    cg.server = server:new({alias = 'master'})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:stop()
+end)
+
+g.test_zstd_compression_during_space_creation = function(cg)
+    t.tarantool.skip_if_enterprise()
+    cg.server:exec(function()
+        local format = {{
+            name = 'x', type = 'unsigned', compression = 'zstd'
+        }}
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support compression",
+            box.schema.space.create, 'T', {engine = 'vinyl', format = format})
+    end)
+end
+
+g.before_test('test_zstd_compression_during_setting_format', function(cg)
+    cg.server:exec(function()
+        box.schema.space.create('space', {engine = 'vinyl'})
+    end)
+end)
+
+g.test_zstd_compression_during_setting_format = function(cg)
+    t.tarantool.skip_if_enterprise()
+    cg.server:exec(function()
+        local format = {{
+            name = 'x', type = 'unsigned', compression = 'zstd'
+        }}
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support compression",
+            box.space.space.format, box.space.space, format)
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support compression",
+            box.space.space.alter, box.space.space, {format = format})
+    end)
+end
+
+g.after_test('test_zstd_compression_during_setting_format', function(cg)
+    cg.server:exec(function()
+        box.space.space:drop()
+    end)
+end)
+
 g = t.group("none compression", t.helpers.matrix({
     engine = {'memtx', 'vinyl'},
 }))
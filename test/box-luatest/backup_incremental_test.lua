@@ -0,0 +1,140 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_each(function(cg)
+    cg.server = server:new({
+        box_cfg = {checkpoint_count = 1, wal_cleanup_delay = 0},
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.space.create('test'):create_index('pk')
+        box.schema.space.create('test_vinyl', {engine = 'vinyl'})
+        box.space.test_vinyl:create_index('pk')
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:drop()
+end)
+
+local function last_checkpoint(cg)
+    return cg.server:exec(function()
+        local checkpoints = box.info.gc().checkpoints
+        return checkpoints[#checkpoints].signature
+    end)
+end
+
+local function insert(cg, first, last)
+    cg.server:exec(function(first, last)
+        for i = first, last do
+            box.space.test:insert({i})
+            box.space.test_vinyl:insert({i})
+        end
+    end, {first, last})
+end
+
+-- Copies backup files preserving their paths relative to the data
+-- directories of the server.
+local function copy(cg, files, dir)
+    cg.server:exec(function(files, dir)
+        local fio = require('fio')
+        for _, path in ipairs(files) do
+            local src_dir
+            if path:endswith('.xlog') then
+                src_dir = box.cfg.wal_dir
+            elseif path:endswith('.snap') then
+                src_dir = box.cfg.memtx_dir
+            else
+                src_dir = box.cfg.vinyl_dir
+            end
+            t.assert_equals(path:sub(1, #src_dir), src_dir)
+            local dst = fio.pathjoin(dir, path:sub(#src_dir + 2))
+            t.assert(fio.mktree(fio.dirname(dst)))
+            t.assert(fio.copyfile(path, dst))
+        end
+    end, {files, dir})
+end
+
+-- Checks that an incremental backup applied on top of a full backup
+-- restores the data.
+g.test_incremental = function(cg)
+    local dir = fio.tempdir()
+    insert(cg, 1, 10)
+    cg.server:exec(function() box.snapshot() end)
+    local token = last_checkpoint(cg)
+    local files = cg.server:exec(function()
+        return box.backup.start()
+    end)
+    copy(cg, files, dir)
+    cg.server:exec(function() box.backup.stop() end)
+
+    insert(cg, 11, 20)
+    cg.server:exec(function() box.snapshot() end)
+    insert(cg, 21, 30)
+    cg.server:exec(function() box.snapshot() end)
+    files = cg.server:exec(function(token)
+        return box.backup.start({since = token})
+    end, {token})
+    t.assert_not_equals(files, {})
+    -- The WAL files are pinned until the backup is stopped.
+    cg.server:exec(function()
+        box.space.test:insert({31})
+        box.snapshot()
+    end)
+    copy(cg, files, dir)
+    cg.server:exec(function() box.backup.stop() end)
+    for _, path in ipairs(files) do
+        t.assert(path:endswith('.xlog'), path)
+    end
+
+    local restored = server:new({alias = 'restored', datadir = dir})
+    restored:start()
+    restored:exec(function()
+        for _, name in ipairs({'test', 'test_vinyl'}) do
+            local s = box.space[name]
+            t.assert_equals(s:count(), 30, name)
+            t.assert_equals(s:get(30), {30}, name)
+        end
+    end)
+    restored:drop()
+    fio.rmtree(dir)
+end
+
+g.test_errors = function(cg)
+    insert(cg, 1, 10)
+    cg.server:exec(function() box.snapshot() end)
+    local token = last_checkpoint(cg)
+    cg.server:exec(function(token)
+        -- The last WAL file written before the checkpoint may be
+        -- returned, because it isn't known where it ends.
+        for _, path in ipairs(box.backup.start({since = token})) do
+            t.assert(path:endswith('.xlog'), path)
+        end
+        box.backup.stop()
+        t.assert_error_covers({
+            type = 'ClientError',
+            name = 'INCREMENTAL_BACKUP',
+            message = "Can't make incremental backup: " ..
+                      "the token is newer than the checkpoint",
+        }, box.backup.start, {since = token + 1})
+        t.assert_error_msg_equals("invalid backup token",
+                                  box.backup.start, {since = -1})
+    end, {token})
+    insert(cg, 11, 20)
+    cg.server:exec(function() box.snapshot() end)
+    insert(cg, 21, 30)
+    cg.server:exec(function() box.snapshot() end)
+    t.helpers.retrying({}, function()
+        cg.server:exec(function(token)
+            t.assert_error_covers({
+                type = 'ClientError',
+                name = 'INCREMENTAL_BACKUP',
+                message = "Can't make incremental backup: " ..
+                          "WAL files written after the token were removed",
+            }, box.backup.start, 0, {since = token})
+        end, {token})
+    end)
+end
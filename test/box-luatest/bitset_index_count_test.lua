@@ -0,0 +1,46 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {type = 'bitset', parts = {2, 'unsigned'},
+                              unique = false})
+        box.begin()
+        for i = 1, 10000 do
+            s:insert({i, i % 64})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that count() of a bitset index returns the same number of
+-- tuples as select() for all iterator types and multi-bit keys.
+g.test_count = function(cg)
+    cg.server:exec(function()
+        local sk = box.space.test.index.sk
+        for _, iterator in ipairs({'EQ', 'BITS_ALL_SET', 'BITS_ANY_SET',
+                                   'BITS_ALL_NOT_SET'}) do
+            for _, key in ipairs({0, 1, 5, 12, 48, 63, 64, 65}) do
+                local opts = {iterator = iterator}
+                t.assert_equals(sk:count(key, opts),
+                                #sk:select(key, opts),
+                                iterator .. ' ' .. key)
+            end
+        end
+        t.assert_equals(sk:count(), 10000)
+        t.assert_error_msg_content_equals(
+            "Index 'sk' (BITSET) of space 'test' (memtx) does not support " ..
+            "requested iterator type",
+            sk.count, sk, 1, {iterator = 'GT'})
+    end)
+end
@@ -0,0 +1,48 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+        box.schema.user.grant('guest', 'read,write', 'space', 'test')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        require('internal.tweaks').cbus_busy_poll_timeout = 0
+        box.space.test:truncate()
+    end)
+end)
+
+-- Check that requests are served while tx busy polls its endpoint,
+-- both under load and after it becomes idle.
+g.test_busy_poll = function(cg)
+    cg.server:exec(function()
+        local tweaks = require('internal.tweaks')
+        t.assert_equals(tweaks.cbus_busy_poll_timeout, 0)
+        tweaks.cbus_busy_poll_timeout = 0.001
+    end)
+    local conn = require('net.box').connect(cg.server.net_box_uri)
+    local futures = {}
+    for i = 1, 1000 do
+        table.insert(futures, conn.space.test:insert({i}, {is_async = true}))
+    end
+    for i, future in ipairs(futures) do
+        t.assert_equals(future:wait_result(), {i})
+    end
+    t.assert_equals(conn.space.test:count(), 1000)
+    -- Let tx go idle and check it still wakes up on a request.
+    require('fiber').sleep(0.01)
+    t.assert_equals(conn.space.test:get(500), {500})
+    conn:close()
+end
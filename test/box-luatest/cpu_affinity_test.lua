@@ -0,0 +1,57 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    local cpus
+    local f = fio.open('/proc/self/status', {'O_RDONLY'})
+    if f ~= nil then
+        cpus = f:read():match('Cpus_allowed_list:%s*(%S+)')
+        f:close()
+    end
+    t.skip_if(jit.os ~= 'Linux' or cpus == nil or
+              (cpus ~= '0' and not cpus:match('^0[-,]')),
+              'CPU 0 is not available')
+    cg.server = server:new({
+        box_cfg = {cpu_affinity = 'tx=0;wal=0'},
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+-- Check that the threads are bound to the configured CPUs.
+g.test_cpu_affinity = function(cg)
+    cg.server:exec(function()
+        local fio = require('fio')
+        local function cpus_allowed(dir)
+            local f = fio.open(dir .. '/status', {'O_RDONLY'})
+            local status = f:read()
+            f:close()
+            return status:match('Cpus_allowed_list:%s*(%S+)')
+        end
+        t.assert_equals(box.cfg.cpu_affinity, 'tx=0;wal=0')
+        t.assert_equals(cpus_allowed('/proc/self'), '0')
+        local wal_cpus
+        for _, dir in ipairs(fio.glob('/proc/self/task/*')) do
+            local f = fio.open(dir .. '/comm', {'O_RDONLY'})
+            if f ~= nil then
+                local name = f:read():gsub('%s+$', '')
+                f:close()
+                if name == 'wal' then
+                    wal_cpus = cpus_allowed(dir)
+                end
+            end
+        end
+        t.assert_equals(wal_cpus, '0')
+        t.assert_error_msg_contains(
+            "Can't set option 'cpu_affinity' dynamically",
+            box.cfg, {cpu_affinity = 'tx=1'})
+    end)
+end
@@ -0,0 +1,131 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg({expiration_rate = 10000})
+        for _, name in ipairs({'test', 'other'}) do
+            if box.space[name] ~= nil then
+                box.space[name]:drop()
+            end
+        end
+    end)
+end)
+
+g.test_options = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {'id', 'unsigned'}, {'exp', 'number'}, {'str', 'string'},
+        }
+        local s = box.schema.space.create('test', {
+            format = format, ttl_field = 'exp',
+        })
+        t.assert_equals(s.ttl_field, 2)
+        s:alter({ttl_field = 1})
+        t.assert_equals(s.ttl_field, 1)
+        s:alter({ttl_field = false})
+        t.assert_equals(s.ttl_field, nil)
+        s:drop()
+
+        t.assert_error_msg_content_equals(
+            "Failed to create space 'test': " ..
+            "ttl_field must refer to a numeric field",
+            box.schema.space.create, 'test',
+            {format = format, ttl_field = 'str'})
+        t.assert_error_msg_content_equals(
+            "Illegal parameters, ttl_field 'foo' is not found in the format",
+            box.schema.space.create, 'test',
+            {format = format, ttl_field = 'foo'})
+        t.assert_error_msg_content_equals(
+            "Illegal parameters, " ..
+            "ttl_field must be a positive integer or a field name",
+            box.schema.space.create, 'test', {ttl_field = 0})
+        t.assert_error_msg_content_equals(
+            "Incorrect value for option 'expiration_rate': " ..
+            "the value must be greater than or equal to 0",
+            box.cfg, {expiration_rate = -1})
+    end)
+end
+
+g.test_expiration = function(cg)
+    for _, engine in ipairs({'memtx', 'vinyl'}) do
+        cg.server:exec(function(engine)
+            local fiber = require('fiber')
+            local s = box.schema.space.create('test', {
+                engine = engine, ttl_field = 2,
+            })
+            s:create_index('pk')
+            s:create_index('exp', {parts = {2, 'number', is_nullable = true},
+                                   unique = false})
+            local stat = box.stat.expiration()
+            local now = fiber.time()
+            for i = 1, 10 do
+                s:insert({i, now - i})
+            end
+            s:insert({11, now + 3600})
+            s:insert({12, box.NULL})
+            t.helpers.retrying({}, function()
+                t.assert_equals(s:select({}, {fullscan = true}),
+                                {{11, now + 3600}, {12, box.NULL}})
+            end)
+            t.assert_ge(box.stat.expiration().expired - stat.expired, 10)
+            t.assert_ge(box.stat.expiration().batches - stat.batches, 1)
+            s:drop()
+        end, {engine})
+    end
+end
+
+-- Check that a space without a suitable index is left alone.
+g.test_no_index = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('other', {ttl_field = 2})
+        s:create_index('pk')
+        s:insert({1, 0})
+        local s2 = box.schema.space.create('test', {ttl_field = 2})
+        s2:create_index('pk')
+        s2:create_index('exp', {parts = {2, 'unsigned'}, unique = false})
+        s2:insert({1, 0})
+        t.helpers.retrying({}, function()
+            t.assert_equals(s2:select(), {})
+        end)
+        fiber.sleep(0.1)
+        t.assert_equals(s:select(), {{1, 0}})
+    end)
+end
+
+-- Check that the number of deleted tuples per second is limited.
+g.test_rate = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.cfg({expiration_rate = 50})
+        local s = box.schema.space.create('test', {ttl_field = 2})
+        s:create_index('pk')
+        s:create_index('exp', {parts = {2, 'unsigned'}, unique = false})
+        box.begin()
+        for i = 1, 200 do
+            s:insert({i, 0})
+        end
+        box.commit()
+        t.helpers.retrying({}, function()
+            t.assert_lt(s:len(), 200)
+        end)
+        fiber.sleep(1)
+        t.assert_gt(s:len(), 0)
+        box.cfg({expiration_rate = 0})
+        t.helpers.retrying({}, function()
+            t.assert_equals(s:len(), 0)
+        end)
+    end)
+end
@@ -7,7 +7,7 @@ local g = t.group()
 -- Please update them, if you changed the relevant structures.
 local SIZE_OF_STMT = 136
 -- Size of story with one link (for spaces with 1 index).
-local SIZE_OF_STORY = 144
+local SIZE_OF_STORY = 120
 -- Size of tuple with 2 number fields
 local SIZE_OF_TUPLE = 9
 -- Size of xrow for tuples with 2 number fields
@@ -45,12 +45,19 @@ local function table_values_are_zeros(table)
     return true
 end
 
+-- GC counters change on every GC step, so they are checked separately.
+local function tx_stat(server)
+    local stat = server:eval('return box.stat.memtx.tx()')
+    stat.mvcc.gc = nil
+    return stat
+end
+
 local function tx_gc(server, steps, related_changes)
     server:eval('box.internal.memtx_tx_gc(' .. steps .. ')')
     if related_changes then
         table_apply_change(current_stat, related_changes)
     end
-    t.assert_equals(server:eval('return box.stat.memtx.tx()'), current_stat)
+    t.assert_equals(tx_stat(server), current_stat)
 end
 
 local function tx_step(server, txn_name, op, related_changes)
@@ -58,7 +65,7 @@ local function tx_step(server, txn_name, op, related_changes)
     if related_changes then
         table_apply_change(current_stat, related_changes)
     end
-    t.assert_equals(server:eval('return box.stat.memtx.tx()'), current_stat)
+    t.assert_equals(tx_stat(server), current_stat)
 end
 
 g.before_each(function()
@@ -74,7 +81,7 @@ g.before_each(function()
     -- Clear txm before test
     g.server:eval('box.internal.memtx_tx_gc(100)')
     -- CREATING CURRENT STAT
-    current_stat = g.server:eval('return box.stat.memtx.tx()')
+    current_stat = tx_stat(g.server)
     -- Check if txm use no memory
     t.assert(table_values_are_zeros(current_stat))
 end)
@@ -234,7 +241,7 @@ g.test_read_view = function()
     g.server:eval('s:replace{1, 1}')
     g.server:eval('s:replace{2, 1}')
     g.server:eval('box.internal.memtx_tx_gc(10)')
-    t.assert(table_values_are_zeros(g.server:eval('return box.stat.memtx.tx()')))
+    t.assert(table_values_are_zeros(tx_stat(g.server)))
     g.server:eval('tx1("s:get(1)")')
     g.server:eval('tx2("s:replace{1, 2}")')
     g.server:eval('tx2("s:replace{2, 2}")')
@@ -281,7 +288,7 @@ g.test_read_view_with_empty_space = function()
     g.server:eval('s:replace{1, 1}')
     g.server:eval('s:replace{2, 1}')
     g.server:eval('box.internal.memtx_tx_gc(10)')
-    t.assert(table_values_are_zeros(g.server:eval('return box.stat.memtx.tx()')))
+    t.assert(table_values_are_zeros(tx_stat(g.server)))
     g.server:eval('tx1("s:get(1)")')
     g.server:eval('tx2("s:delete(1)")')
     g.server:eval('tx2("s:delete(2)")')
@@ -359,7 +366,7 @@ g.test_conflict = function()
     g.server:eval('tx1 = txn_proxy.new()')
     g.server:eval('tx2 = txn_proxy.new()')
     g.server:eval('box.internal.memtx_tx_gc(10)')
-    local stat = g.server:eval('return box.stat.memtx.tx()')
+    local stat = tx_stat(g.server)
     t.assert(table_values_are_zeros(stat))
 
     -- Test that monitoring shows hole point tracker.
@@ -482,3 +489,62 @@ g.test_gh_8448_box_stat_memtx_func = function()
         t.assert_equals(box.stat.memtx().tx, box.stat.memtx.tx())
     end)
 end
+
+-- Check GC statistics and that stories retained for a read view are
+-- collected in bulk once the read view is closed.
+g.test_gc = function()
+    g.server:eval('tx = txn_proxy.new()')
+    g.server:eval('tx:begin()')
+    g.server:eval('tx("s:get(1)")')
+    g.server:exec(function()
+        local s = box.space.test
+        for i = 1, 100 do
+            s:replace({i, 1})
+        end
+        box.internal.memtx_tx_gc(1000)
+        local stat = box.stat.memtx.tx().mvcc
+        t.assert_ge(stat.gc.steps, 900)
+        t.assert_ge(stat.gc.lag, 100)
+        t.assert_equals(stat.gc.pending, 0)
+        t.assert_ge(stat.tuples.read_view.stories.count, 100)
+    end)
+    t.assert_equals(g.server:eval('return tx:commit()'), '')
+    g.server:exec(function()
+        t.helpers.retrying({}, function()
+            local stat = box.stat.memtx.tx().mvcc
+            t.assert_equals(stat.tuples.read_view.stories.count, 0)
+            t.assert_equals(stat.gc.pending, 0)
+            t.assert_equals(stat.gc.lag, 0)
+            t.assert_ge(stat.gc.reclaimed, 100)
+        end)
+    end)
+end
+
+-- Check that reading the same gap again doesn't allocate a new tracker.
+g.test_tracker_repeated_read = function()
+    g.server:eval('s:replace{1, 0}')
+    g.server:eval('s:replace{9, 0}')
+    g.server:eval('h = box.schema.space.create("h")')
+    g.server:eval('h:create_index("pk", {type = "hash"})')
+    g.server:eval('tx1 = txn_proxy.new()')
+    g.server:eval('tx2 = txn_proxy.new()')
+    g.server:eval('tx1:begin()')
+    g.server:eval('tx1("s:select{5}")')
+    g.server:eval('tx1("h:select{}")')
+    local trackers = tx_stat(g.server).mvcc.trackers.total
+    t.assert_gt(trackers, 0)
+    for _ = 1, 10 do
+        g.server:eval('tx1("s:select{5}")')
+        g.server:eval('tx1("h:select{}")')
+    end
+    t.assert_equals(tx_stat(g.server).mvcc.trackers.total, trackers)
+    -- The gap is still tracked.
+    g.server:eval('tx2:begin()')
+    g.server:eval('tx2("s:replace{5, 0}")')
+    g.server:eval('tx2:commit()')
+    g.server:eval('tx1("s:replace{0, 0}")')
+    t.assert_equals(g.server:eval('return tx1:commit()'), {{
+        error = "Transaction has been aborted by conflict"
+    }})
+    g.server:eval('h:drop()')
+end
@@ -35,6 +35,7 @@ local reference_table = {
         TSN = 0x08,
         FLAGS = 0x09,
         STREAM_ID = 0x0a,
+        WAIT_VCLOCK = 0x0b,
         SPACE_ID = 0x10,
         INDEX_ID = 0x11,
         LIMIT = 0x12,
@@ -85,6 +86,7 @@ local reference_table = {
         SPACE_NAME = 0x5e,
         INDEX_NAME = 0x5f,
         TUPLE_FORMATS = 0x60,
+        COMPRESSED_BODY = 0x61,
     },
 
     -- `iproto_metadata_key` enumeration.
@@ -165,7 +167,7 @@ local reference_table = {
     },
 
     -- `IPROTO_CURRENT_VERSION` constant
-    protocol_version = 7,
+    protocol_version = 9,
 
     -- `feature_id` enumeration
     protocol_features = {
@@ -179,6 +181,8 @@ local reference_table = {
         dml_tuple_extension = true,
         call_ret_tuple_extension = true,
         call_arg_tuple_extension = true,
+        response_compression = true,
+        wait_vclock = true,
     },
     feature = {
         streams = 0,
@@ -191,6 +195,8 @@ local reference_table = {
         dml_tuple_extension = 7,
         call_ret_tuple_extension = 8,
         call_arg_tuple_extension = 9,
+        response_compression = 10,
+        wait_vclock = 11,
     },
 }
 
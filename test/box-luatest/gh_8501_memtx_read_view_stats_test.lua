@@ -58,7 +58,9 @@ g.test_memtx_read_view_stats = function(cg)
         t.assert_equals(stat4.data.read_view, data_size)
         t.assert_equals(stat4.data.garbage, 0)
 
-        -- Complete the snapshot.
+        -- Complete the snapshot. Disable background garbage collection
+        -- to check that garbage is collected on allocation.
+        box.error.injection.set('ERRINJ_MEMTX_DELAY_GC', true)
         box.error.injection.set('ERRINJ_SNAP_WRITE_DELAY', false)
         t.assert(f:join())
         local stat5 = box.stat.memtx()
@@ -73,7 +75,47 @@ g.test_memtx_read_view_stats = function(cg)
         gc()
         local stat6 = box.stat.memtx()
         t.assert_equals(stat6, stat2)
+        box.error.injection.set('ERRINJ_MEMTX_DELAY_GC', false)
 
         s:drop()
     end)
 end
+
+-- Checks that tuples pinned by a read view are freed in background
+-- once the read view is closed.
+g.test_memtx_read_view_garbage_collected_in_background = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+        box.begin()
+        for i = 1, 10000 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        box.commit()
+
+        box.error.injection.set('ERRINJ_SNAP_WRITE_DELAY', true)
+        local f = fiber.new(box.snapshot)
+        f:set_joinable(true)
+        fiber.yield()
+        s:truncate()
+        -- Wait for the old index to be freed by the gc fiber.
+        t.helpers.retrying({}, function()
+            t.assert_gt(box.stat.memtx().data.read_view, 10000 * 100)
+        end)
+        -- Closing the read view turns the pinned tuples into garbage.
+        -- Nothing is allocated below so only the gc fiber can free it.
+        box.error.injection.set('ERRINJ_MEMTX_DELAY_GC', true)
+        box.error.injection.set('ERRINJ_SNAP_WRITE_DELAY', false)
+        t.assert(f:join())
+        t.assert_equals(box.stat.memtx().data.read_view, 0)
+        t.assert_gt(box.stat.memtx().data.garbage, 10000 * 100)
+        fiber.sleep(0.1)
+        t.assert_gt(box.stat.memtx().data.garbage, 10000 * 100)
+        box.error.injection.set('ERRINJ_MEMTX_DELAY_GC', false)
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.stat.memtx().data.garbage, 0)
+        end)
+        s:drop()
+    end)
+end
@@ -0,0 +1,269 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_ddl = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {type = 'hnsw', dimension = 4,
+                                         distance = 'cosine'})
+        t.assert_equals(sk.type, 'HNSW')
+        t.assert_equals(sk.unique, false)
+        t.assert_equals(sk.dimension, 4)
+        t.assert_equals(sk.parts[1].fieldno, 2)
+        t.assert_equals(sk.parts[1].type, 'array')
+        sk:drop()
+        local function check(opts, msg)
+            opts.type = 'hnsw'
+            t.assert_error_msg_content_equals(
+                "Can't create or modify index 'sk' in space 'test': " .. msg,
+                s.create_index, s, 'sk', opts)
+        end
+        check({parts = {{2, 'array'}, {3, 'array'}}},
+              'HNSW index key can not be multipart')
+        check({parts = {2, 'array'}, unique = true},
+              'HNSW index can not be unique')
+        check({parts = {2, 'unsigned'}},
+              'HNSW index field type must be ARRAY')
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'sk' in space 'test': " ..
+            "RTREE index distance must be EUCLID or MANHATTAN",
+            s.create_index, s, 'sk', {type = 'rtree', distance = 'dot'})
+        t.assert_error_msg_content_equals(
+            "Index 'sk' (HNSW) of space 'test' (memtx) does not support " ..
+            "dimension (0): must belong to range [1, 4096]",
+            s.create_index, s, 'sk', {type = 'hnsw', dimension = 0})
+        t.assert_error_msg_content_equals(
+            "Wrong index options: distance must be one of 'euclid', " ..
+            "'manhattan', 'cosine' or 'dot'",
+            s.create_index, s, 'sk', {type = 'hnsw', distance = 'foo'})
+    end)
+end
+
+g.test_vinyl = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        t.assert_error_msg_content_equals(
+            "Unsupported index type supplied for index 'sk' in space 'test'",
+            s.create_index, s, 'sk', {type = 'hnsw'})
+    end)
+end
+
+g.test_vector_validation = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {type = 'hnsw', dimension = 3})
+        t.assert_error_msg_content_equals(
+            "HNSW: Field must be an array of 3 numbers",
+            s.insert, s, {1, {1, 2}})
+        t.assert_error_msg_content_equals(
+            "Tuple field 3 type does not match one required by " ..
+            "operation: expected number, got string",
+            s.insert, s, {1, {1, 2, 'x'}})
+        t.assert_equals(s:count(), 0)
+        t.assert_equals(sk:len(), 0)
+        s:insert({1, {1, 2, 3}})
+        t.assert_error_msg_content_equals(
+            "HNSW: Key must be an array of 3 numbers",
+            sk.select, sk, {{1, 2}}, {iterator = 'neighbor'})
+        t.assert_error_msg_content_equals(
+            "Index 'sk' (HNSW) of space 'test' (memtx) does not support " ..
+            "requested iterator type",
+            sk.select, sk, {1, 2, 3}, {iterator = 'eq'})
+        t.assert_equals(sk:select({1, 2, 3}, {iterator = 'neighbor'}),
+                        {{1, {1, 2, 3}}})
+        t.assert_equals(sk:select({{1, 2, 3}}, {iterator = 'neighbor'}),
+                        {{1, {1, 2, 3}}})
+    end)
+end
+
+-- Check that the found neighbors agree with a brute force search.
+g.test_search = function(cg)
+    cg.server:exec(function()
+        local DIMENSION = 8
+        local COUNT = 500
+        local K = 10
+        local function distance(metric, a, b)
+            local sum, aa, bb = 0, 0, 0
+            for i = 1, DIMENSION do
+                if metric == 'euclid' then
+                    sum = sum + (a[i] - b[i]) ^ 2
+                elseif metric == 'manhattan' then
+                    sum = sum + math.abs(a[i] - b[i])
+                else
+                    sum = sum + a[i] * b[i]
+                    aa = aa + a[i] ^ 2
+                    bb = bb + b[i] ^ 2
+                end
+            end
+            if metric == 'euclid' then
+                return math.sqrt(sum)
+            elseif metric == 'cosine' then
+                return 1 - sum / math.sqrt(aa * bb)
+            elseif metric == 'dot' then
+                return -sum
+            end
+            return sum
+        end
+        local function random_vector()
+            local v = {}
+            for i = 1, DIMENSION do
+                v[i] = math.random() * 2 - 1
+            end
+            return v
+        end
+        math.randomseed(42)
+        for _, metric in ipairs({'euclid', 'manhattan', 'cosine', 'dot'}) do
+            local s = box.schema.space.create('test')
+            s:create_index('pk')
+            local sk = s:create_index('sk', {type = 'hnsw',
+                                             dimension = DIMENSION,
+                                             distance = metric})
+            local vectors = {}
+            for i = 1, COUNT do
+                vectors[i] = random_vector()
+                s:insert({i, vectors[i]})
+            end
+            t.assert_equals(sk:len(), COUNT)
+            local hits = 0
+            for _ = 1, 20 do
+                local query = random_vector()
+                local expected = {}
+                for i = 1, COUNT do
+                    table.insert(expected, distance(metric, query,
+                                                    vectors[i]))
+                end
+                table.sort(expected)
+                local threshold = expected[K] + 1e-5
+                local found = sk:select(query, {iterator = 'neighbor',
+                                                limit = K})
+                t.assert_equals(#found, K)
+                local prev = -math.huge
+                for _, tuple in ipairs(found) do
+                    local d = distance(metric, query, vectors[tuple[1]])
+                    t.assert_ge(d, prev - 1e-5)
+                    prev = d
+                    if d <= threshold then
+                        hits = hits + 1
+                    end
+                end
+            end
+            t.assert_ge(hits / (20 * K), 0.9, metric)
+            -- A full scan returns (almost) every tuple and only once.
+            local seen = {}
+            local seen_count = 0
+            for _, tuple in sk:pairs(random_vector(),
+                                     {iterator = 'neighbor'}) do
+                t.assert_equals(seen[tuple[1]], nil)
+                seen[tuple[1]] = true
+                seen_count = seen_count + 1
+            end
+            t.assert_ge(seen_count, COUNT * 0.95)
+            t.assert_equals(sk:count(), COUNT)
+            s:drop()
+        end
+    end)
+end
+
+g.test_replace_delete = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {type = 'hnsw', dimension = 2})
+        s:insert({1, {0, 0}})
+        s:insert({2, {10, 10}})
+        s:insert({3, {20, 20}})
+        local function ids(key, limit)
+            local res = {}
+            for _, tuple in sk:pairs(key, {iterator = 'neighbor'}) do
+                table.insert(res, tuple[1])
+                if #res == limit then
+                    break
+                end
+            end
+            return res
+        end
+        t.assert_equals(ids({1, 1}), {1, 2, 3})
+        s:replace({1, {30, 30}})
+        t.assert_equals(ids({1, 1}), {2, 3, 1})
+        s:delete(2)
+        t.assert_equals(ids({1, 1}), {3, 1})
+        t.assert_equals(sk:len(), 2)
+
+        box.begin()
+        s:replace({3, {100, 100}})
+        s:insert({4, {2, 2}})
+        t.assert_equals(ids({1, 1}), {4, 1, 3})
+        box.rollback()
+        t.assert_equals(ids({1, 1}), {3, 1})
+        t.assert_equals(sk:len(), 2)
+    end)
+end
+
+-- Check that an iterator survives changes of the index.
+g.test_iterator_stability = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {type = 'hnsw', dimension = 1})
+        for i = 1, 200 do
+            s:insert({i, {i}})
+        end
+        local res = {}
+        for _, tuple in sk:pairs({0}, {iterator = 'neighbor'}) do
+            table.insert(res, tuple[1])
+            s:delete(tuple[1] + 1)
+        end
+        t.assert_equals(#res, 100)
+        for i, id in ipairs(res) do
+            t.assert_equals(id, 2 * i - 1)
+        end
+        t.assert_equals(sk:len(), 100)
+    end)
+end
+
+-- Check that an HNSW index is rebuilt on recovery.
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {type = 'hnsw', dimension = 2,
+                              distance = 'manhattan'})
+        s:insert({1, {0, 0}})
+        s:insert({2, {5, 5}})
+        box.snapshot()
+        s:insert({3, {1, 2}})
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local sk = box.space.test.index.sk
+        t.assert_equals(sk.dimension, 2)
+        t.assert_equals(sk:len(), 3)
+        local res = {}
+        for _, tuple in sk:pairs({0, 0}, {iterator = 'neighbor'}) do
+            table.insert(res, tuple[1])
+        end
+        t.assert_equals(res, {1, 3, 2})
+    end)
+end
@@ -0,0 +1,55 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.master = server:new({alias = 'master'})
+    cg.master:start()
+    cg.master:exec(function()
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+    end)
+    -- The standby doesn't get WAL directory events so it can find a new
+    -- WAL file only by rescanning the directory on timeout.
+    cg.standby = server:new({
+        alias = 'standby',
+        workdir = cg.master.workdir,
+        box_cfg = {hot_standby = true, wal_dir_rescan_delay = 0.1},
+        env = {ERRINJ_HOT_STANDBY_SKIP_DIR_EVENT = 'true'},
+    })
+    cg.standby_log = fio.pathjoin(cg.standby.workdir,
+                                  cg.standby.alias .. '.log')
+    cg.standby:start({wait_until_ready = false})
+    t.helpers.retrying({}, function()
+        t.assert(cg.standby:grep_log("Entering hot standby mode",
+                                     nil, {filename = cg.standby_log}))
+    end)
+end)
+
+g.after_all(function(cg)
+    if cg.standby ~= nil then
+        pcall(cg.standby.stop, cg.standby)
+    end
+    if cg.master ~= nil then
+        cg.master:drop()
+    end
+end)
+
+-- Checks that a hot standby instance that has read the EOF marker of
+-- the current WAL file finds the next one without a directory event.
+g.test_rescan_on_timeout = function(cg)
+    local xlog = cg.master:exec(function()
+        box.space.test:insert({1})
+        box.snapshot()
+        local signature = box.info.signature
+        box.space.test:insert({2})
+        return string.format('%020d.xlog', signature)
+    end)
+    t.helpers.retrying({}, function()
+        t.assert(cg.standby:grep_log("recover from `.*" .. xlog,
+                                     nil, {filename = cg.standby_log}))
+    end)
+end
@@ -0,0 +1,81 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('index_get_batch', {
+    {engine = 'memtx', index_type = 'TREE'},
+    {engine = 'memtx', index_type = 'HASH'},
+    {engine = 'vinyl', index_type = 'TREE'},
+})
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function(engine, index_type)
+        local s = box.schema.create_space('test', {engine = engine})
+        s:create_index('primary', {type = index_type})
+        s:create_index('secondary', {type = index_type,
+                                     parts = {{2, 'string'}, {3, 'unsigned'}}})
+        s:create_index('nonunique', {type = 'TREE', unique = false,
+                                     parts = {3, 'unsigned'}})
+        for i = 1, 100 do
+            s:insert({i, 'k' .. i, i % 10})
+        end
+    end, {cg.params.engine, cg.params.index_type})
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_get_batch = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:get_batch({}), {})
+        t.assert_equals(s:get_batch({1, {2}, 200, 3}),
+                        {{1, 'k1', 1}, {2, 'k2', 2}, nil, {3, 'k3', 3}})
+        t.assert_equals(s.index.secondary:get_batch({{'k5', 5}, {'k6', 5}}),
+                        {{5, 'k5', 5}})
+        local keys = {}
+        for i = 1, 100 do
+            keys[i] = 101 - i
+        end
+        local res = s:get_batch(keys)
+        t.assert_equals(#res, 100)
+        for i = 1, 100 do
+            t.assert_equals(res[i], s:get(keys[i]))
+        end
+    end)
+end
+
+g.test_get_batch_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_error_msg_equals(
+            "Usage: index:get_batch({key1, key2, ...})",
+            s.get_batch, s, 1)
+        t.assert_error_msg_content_equals(
+            "Get() doesn't support partial keys and non-unique indexes",
+            s.index.nonunique.get_batch, s.index.nonunique, {1})
+        t.assert_error_msg_content_equals(
+            "Invalid key part count in an exact match (expected 2, got 1)",
+            s.index.secondary.get_batch, s.index.secondary, {{'k1', 1}, 'k2'})
+        t.assert_error_msg_content_equals(
+            "Supplied key type of part 0 does not match index part type: " ..
+            "expected unsigned",
+            s.get_batch, s, {1, 'x'})
+    end)
+end
+
+-- Check that keys looked up in a batch are tracked by the transaction.
+g.test_get_batch_in_txn = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.begin()
+        t.assert_equals(s:get_batch({1, 200}), {{1, 'k1', 1}})
+        s:insert({200, 'k200', 0})
+        t.assert_equals(s:get_batch({1, 200}),
+                        {{1, 'k1', 1}, {200, 'k200', 0}})
+        box.rollback()
+        t.assert_equals(s:get_batch({200}), {})
+    end)
+end
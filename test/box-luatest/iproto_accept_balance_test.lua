@@ -0,0 +1,64 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+-- Must be in sync with IPROTO_ACCEPT_IMBALANCE_MAX.
+local IMBALANCE_MAX = 4
+local THREAD_COUNT = 4
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {iproto_threads = THREAD_COUNT}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Returns the number of connections served by each IPROTO thread.
+local function thread_connections(server)
+    return server:exec(function(thread_count)
+        local res = {}
+        for i = 1, thread_count do
+            table.insert(res, box.stat.net.thread[i].CONNECTIONS.current)
+        end
+        return res
+    end, {THREAD_COUNT})
+end
+
+-- Checks that new connections are spread evenly among IPROTO threads.
+g.test_balance = function(cg)
+    local fiber = require('fiber')
+    local conns = {}
+    local fibers = {}
+    for _ = 1, 100 do
+        local f = fiber.new(function()
+            table.insert(conns, net.connect(cg.server.net_box_uri))
+        end)
+        f:set_joinable(true)
+        table.insert(fibers, f)
+    end
+    for _, f in ipairs(fibers) do
+        f:join()
+    end
+    for _, c in ipairs(conns) do
+        t.assert_equals(c:ping(), true)
+    end
+    t.helpers.retrying({}, function()
+        local counts = thread_connections(cg.server)
+        local total = 0
+        for _, count in ipairs(counts) do
+            total = total + count
+        end
+        -- The connection used by the test server object counts, too.
+        t.assert_ge(total, #conns)
+        local min = math.min(unpack(counts))
+        local max = math.max(unpack(counts))
+        t.assert_le(max - min, IMBALANCE_MAX + 1, counts)
+    end)
+    for _, c in ipairs(conns) do
+        c:close()
+    end
+end
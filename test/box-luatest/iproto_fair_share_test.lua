@@ -0,0 +1,65 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+local NET_MSG_MAX = 64
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {net_msg_max = NET_MSG_MAX}})
+    cg.server:start()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        rawset(_G, 'cond', fiber.cond())
+        rawset(_G, 'wait', function()
+            _G.cond:wait()
+        end)
+        rawset(_G, 'in_progress', function()
+            return box.stat.net().REQUESTS_IN_PROGRESS.current
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that a client pipelining requests can't take up all
+-- net_msg_max while another client has requests in progress.
+g.test_fair_share = function(cg)
+    local polite = net.connect(cg.server.net_box_uri)
+    local greedy = net.connect(cg.server.net_box_uri)
+    local polite_futures = {}
+    for _ = 1, 4 do
+        table.insert(polite_futures,
+                     polite:call('wait', {}, {is_async = true}))
+    end
+    local greedy_futures = {}
+    for _ = 1, NET_MSG_MAX * 4 do
+        table.insert(greedy_futures,
+                     greedy:call('wait', {}, {is_async = true}))
+    end
+    t.helpers.retrying({}, function()
+        t.assert(cg.server:grep_log('fair share of net_msg_max is reached'))
+    end)
+    -- The greedy client doesn't use up all the messages.
+    t.assert_le(cg.server:exec(function() return _G.in_progress() end),
+                NET_MSG_MAX / 2 + 8)
+    t.assert_equals(polite:ping(), true)
+    t.helpers.retrying({}, function()
+        cg.server:exec(function() _G.cond:broadcast() end)
+        for _, f in ipairs(polite_futures) do
+            t.assert(f:is_ready())
+        end
+        for _, f in ipairs(greedy_futures) do
+            t.assert(f:is_ready())
+        end
+    end)
+    for _, f in ipairs(greedy_futures) do
+        local _, err = f:result()
+        t.assert_equals(err, nil)
+    end
+    polite:close()
+    greedy:close()
+end
@@ -0,0 +1,64 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('iproto_io_backend', {
+    {io_backend = 'auto'},
+    {io_backend = 'epoll'},
+    {io_backend = 'io_uring'},
+})
+
+g.before_all(function(cg)
+    t.skip_if(cg.params.io_backend ~= 'auto' and jit.os ~= 'Linux',
+              'Linux only')
+    cg.server = server:new({box_cfg = {
+        iproto_threads = 2,
+        iproto_io_backend = cg.params.io_backend,
+    }})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+g.test_requests = function(cg)
+    local conns = {}
+    for _ = 1, 10 do
+        local c = net.connect(cg.server.net_box_uri)
+        t.assert_equals(c:ping(), true)
+        t.assert_equals(c:eval('return box.cfg.iproto_io_backend'),
+                        cg.params.io_backend)
+        table.insert(conns, c)
+    end
+    for i, c in ipairs(conns) do
+        t.assert_equals(c:eval('return ...', {string.rep('x', i * 1000)}),
+                        string.rep('x', i * 1000))
+        c:close()
+    end
+    cg.server:exec(function(io_backend)
+        t.assert_error_msg_equals(
+            "Can't set option 'iproto_io_backend' dynamically",
+            box.cfg, {iproto_io_backend = io_backend == 'auto' and
+                                          'epoll' or 'auto'})
+    end, {cg.params.io_backend})
+end
+
+local g_invalid = t.group('iproto_io_backend_invalid')
+
+g_invalid.after_each(function(cg)
+    cg.server:drop()
+end)
+
+g_invalid.test_invalid = function(cg)
+    cg.server = server:new({box_cfg = {iproto_io_backend = 'foo'}})
+    cg.server:start({wait_until_ready = false})
+    t.helpers.retrying({}, function()
+        t.assert(cg.server:grep_log(
+            "Incorrect value for option 'iproto_io_backend': the value " ..
+            "must be one of the following strings: 'auto', 'epoll', " ..
+            "'io_uring'"))
+    end)
+end
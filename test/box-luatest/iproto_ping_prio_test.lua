@@ -0,0 +1,50 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        rawset(_G, 'cond', fiber.cond())
+        rawset(_G, 'wait', function()
+            _G.cond:wait()
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that pings outside streams are answered while other requests
+-- are in progress and that pings in streams are still ordered with
+-- other stream requests.
+g.test_ping = function(cg)
+    local conn = net.connect(cg.server.net_box_uri)
+    for _ = 1, 100 do
+        t.assert_equals(conn:ping(), true)
+    end
+    local fiber = require('fiber')
+    local stream = conn:new_stream()
+    local future = stream:call('wait', {}, {is_async = true})
+    local stream_ping_done = false
+    local f = fiber.new(function()
+        t.assert_equals(stream:ping(), true)
+        stream_ping_done = true
+    end)
+    f:set_joinable(true)
+    for _ = 1, 10 do
+        t.assert_equals(conn:ping(), true)
+    end
+    t.assert_not(future:is_ready())
+    t.assert_not(stream_ping_done)
+    cg.server:exec(function() _G.cond:broadcast() end)
+    t.assert_equals(future:wait_result(), {})
+    t.assert(f:join())
+    t.assert(stream_ping_done)
+    conn:close()
+end
@@ -0,0 +1,90 @@
+local buffer = require('buffer')
+local msgpack = require('msgpack')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, string.rep('x', 1000)})
+        end
+        rawset(_G, 'get_data', function(count)
+            return box.space.test:select({}, {limit = count})
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Returns the number of bytes sent by the server while executing
+-- the given function.
+local function bytes_sent(cg, f)
+    local function sent()
+        return cg.server:exec(function()
+            return box.stat.net().SENT.total
+        end)
+    end
+    local before = sent()
+    f()
+    return sent() - before
+end
+
+g.test_feature = function(cg)
+    local conn = net.connect(cg.server.net_box_uri)
+    t.assert(conn.peer_protocol_features.response_compression)
+    conn:close()
+end
+
+-- Checks that big responses are compressed only for connections that
+-- enabled compression and that they are decoded correctly.
+g.test_compression = function(cg)
+    local expected = cg.server:exec(function()
+        return box.space.test:select()
+    end)
+    local plain = net.connect(cg.server.net_box_uri)
+    local compressed = net.connect(cg.server.net_box_uri,
+                                   {response_compression = true})
+    local size_plain = bytes_sent(cg, function()
+        t.assert_equals(plain.space.test:select(), expected)
+    end)
+    local size_compressed = bytes_sent(cg, function()
+        t.assert_equals(compressed.space.test:select(), expected)
+    end)
+    t.assert_lt(size_compressed * 10, size_plain)
+
+    size_plain = bytes_sent(cg, function()
+        t.assert_equals(plain:call('get_data'), expected)
+    end)
+    size_compressed = bytes_sent(cg, function()
+        t.assert_equals(compressed:call('get_data'), expected)
+    end)
+    t.assert_lt(size_compressed * 10, size_plain)
+
+    -- Decompressed data is written to a user-provided buffer.
+    local ibuf = buffer.ibuf()
+    compressed.space.test:select({}, {buffer = ibuf, skip_header = true})
+    t.assert_equals(msgpack.decode(ibuf.rpos, ibuf:size()), expected)
+    ibuf:recycle()
+
+    -- Small responses aren't compressed. Allow for a few bytes of
+    -- difference in the size of the box.stat.net() response.
+    size_plain = bytes_sent(cg, function()
+        t.assert_equals(plain:call('get_data', {1}), {expected[1]})
+    end)
+    size_compressed = bytes_sent(cg, function()
+        t.assert_equals(compressed:call('get_data', {1}), {expected[1]})
+    end)
+    t.assert_almost_equals(size_compressed, size_plain, 8)
+
+    plain:close()
+    compressed:close()
+end
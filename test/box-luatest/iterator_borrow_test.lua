@@ -0,0 +1,84 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('iterator_borrow', {{engine = 'memtx'}, {engine = 'vinyl'}})
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.space.create('test', {engine = engine})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        for i = 1, 100 do
+            s:insert({i, i % 10, string.rep('x', i)})
+        end
+    end, {cg.params.engine})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+-- Check that pairs() with the borrow option returns the same tuples
+-- as pairs() without it.
+g.test_borrow = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        for _, args in ipairs({
+            {}, {50, {iterator = 'ge'}}, {50, {iterator = 'lt'}},
+        }) do
+            local key, opts = unpack(args)
+            local expected = s:pairs(key, opts):totable()
+            local borrow_opts = table.copy(opts or {})
+            borrow_opts.borrow = true
+            local result = {}
+            for _, tuple in s:pairs(key, borrow_opts) do
+                t.assert(box.tuple.is(tuple))
+                table.insert(result, tuple:totable())
+            end
+            t.assert_equals(result, expected)
+        end
+        local fields = s.index.sk:pairs({5}, {borrow = true})
+            :map(function(tuple) return tuple[1] end):totable()
+        t.assert_equals(fields, {5, 15, 25, 35, 45, 55, 65, 75, 85, 95})
+    end)
+end
+
+-- Check that a borrowed tuple stays valid until the next iteration
+-- step even if it's deleted from the space and that iterators that
+-- weren't iterated till the end don't leak tuples.
+g.test_borrow_delete = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local count = 0
+        for _, tuple in s:pairs({}, {borrow = true}) do
+            s:delete(tuple[1])
+            collectgarbage()
+            t.assert_equals(tuple[3], string.rep('x', tuple[1]))
+            count = count + 1
+        end
+        t.assert_equals(count, 100)
+        t.assert_equals(s:count(), 0)
+        s:insert({1, 1, 'x'})
+        for _ = 1, 10 do
+            for _, tuple in s:pairs({}, {borrow = true}) do
+                t.assert_equals(tuple, {1, 1, 'x'})
+                break
+            end
+        end
+        collectgarbage()
+        collectgarbage()
+        s:delete({1})
+        t.assert_equals(s:select(), {})
+    end)
+end
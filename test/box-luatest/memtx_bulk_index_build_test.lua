@@ -0,0 +1,125 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', false)
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Check that changes made while a non-unique secondary index is being
+-- built make it to the index.
+g.test_concurrent_dml = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, i % 10})
+        end
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', true)
+        local f = fiber.new(s.create_index, s, 'sk',
+                            {parts = {2, 'unsigned'}, unique = false})
+        f:set_joinable(true)
+        fiber.yield()
+        s:delete({1})
+        s:replace({2, 20})
+        s:insert({200, 20})
+        box.begin()
+        s:delete({3})
+        s:insert({300, 30})
+        box.rollback()
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', false)
+        t.assert_equals({f:join()}, {true, s.index.sk})
+        t.assert_equals(s.index.sk:count(), 100)
+        t.assert_equals(s.index.sk:select({20}), {{2, 20}, {200, 20}})
+        t.assert_equals(s.index.sk:count({1}), 9)
+        t.assert_equals(s.index.sk:count({3}), 10)
+        t.assert_equals(s.index.sk:count({30}), 0)
+        for _, tuple in s:pairs() do
+            t.assert_equals(s.index.sk:count({tuple[2], tuple[1]}), 1)
+        end
+    end)
+end
+
+-- Check that a failure to build an index in bulk is handled.
+g.test_invalid_tuple = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, i})
+        end
+        s:insert({101, 'x'})
+        t.assert_error_msg_contains(
+            "Tuple field 2 type does not match one required by operation",
+            s.create_index, s, 'sk',
+            {parts = {2, 'unsigned'}, unique = false})
+        t.assert_equals(s.index.sk, nil)
+        s:delete({101})
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        t.assert_equals(s.index.sk:count(), 100)
+    end)
+end
+
+-- Check that a functional index is built in bulk too.
+g.test_func_index = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        box.schema.func.create('double', {
+            body = [[function(tuple)
+                if tuple[2] == 666 then
+                    error('unlucky')
+                end
+                return {tuple[2] * 2}
+            end]],
+            is_deterministic = true,
+            is_sandboxed = true,
+        })
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, i % 10})
+        end
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', true)
+        local f = fiber.new(s.create_index, s, 'sk',
+                            {parts = {1, 'unsigned'}, unique = false,
+                             func = 'double'})
+        f:set_joinable(true)
+        fiber.yield()
+        s:delete({1})
+        s:replace({2, 20})
+        s:insert({200, 20})
+        box.error.injection.set('ERRINJ_BUILD_INDEX_DELAY', false)
+        t.assert_equals({f:join()}, {true, s.index.sk})
+        t.assert_equals(s.index.sk:count(), 100)
+        t.assert_equals(s.index.sk:select({40}), {{2, 20}, {200, 20}})
+        t.assert_equals(s.index.sk:count({2}), 9)
+        s.index.sk:drop()
+
+        s:insert({101, 666})
+        t.assert_error_msg_contains(
+            "Failed to build a key for functional index 'sk' of space " ..
+            "'test': can't evaluate function",
+            s.create_index, s, 'sk',
+            {parts = {1, 'unsigned'}, unique = false, func = 'double'})
+        t.assert_equals(s.index.sk, nil)
+        s:drop()
+        box.schema.func.drop('double')
+    end)
+end
@@ -0,0 +1,50 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_dirty_rows = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('primary')
+        local temp = box.schema.create_space('temp', {temporary = true})
+        temp:create_index('primary')
+        box.snapshot()
+        t.assert_equals(box.stat.memtx().checkpoint.dirty_rows, 0)
+        for i = 1, 10 do
+            s:insert({i})
+            temp:insert({i})
+        end
+        s:delete({1})
+        s:replace({2, 2})
+        t.assert_equals(box.stat.memtx().checkpoint.dirty_rows, 12)
+        box.snapshot()
+        t.assert_equals(box.stat.memtx().checkpoint.dirty_rows, 0)
+        s:drop()
+        temp:drop()
+    end)
+end
+
+g.test_restart = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('primary')
+        box.snapshot()
+        s:insert({1})
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        -- Only rows recovered from WAL are not checkpointed.
+        t.assert_equals(box.stat.memtx().checkpoint.dirty_rows, 1)
+        box.space.test:drop()
+    end)
+end
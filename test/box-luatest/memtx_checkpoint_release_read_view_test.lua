@@ -0,0 +1,52 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that the read view of a space is released as soon as the space
+-- is written to the snapshot so that changes to the space made while
+-- the other spaces are being written don't copy its index blocks.
+g.test_release_written_space = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local a = box.schema.create_space('a')
+        a:create_index('pk')
+        a:insert({1})
+        local b = box.schema.create_space('b')
+        b:create_index('pk')
+        b:insert({1})
+        t.assert_lt(a.id, b.id)
+        t.assert_equals(box.stat.memtx().index.read_view, 0)
+
+        -- Block the checkpoint before writing space 'b'.
+        box.error.injection.set('ERRINJ_SNAP_WRITE_SPACE_DELAY', b.id)
+        local f = fiber.new(box.snapshot)
+        f:set_joinable(true)
+        fiber.yield()
+        -- Copies of the index blocks of space 'a' made before its read
+        -- view is released are freed along with it.
+        t.helpers.retrying({}, function()
+            a:replace({1})
+            t.assert_equals(box.stat.memtx().index.read_view, 0)
+        end)
+        -- The read view of space 'b' is still open.
+        b:replace({1})
+        t.assert_gt(box.stat.memtx().index.read_view, 0)
+
+        box.error.injection.set('ERRINJ_SNAP_WRITE_SPACE_DELAY', -1)
+        t.assert(f:join())
+        t.assert_equals(box.stat.memtx().index.read_view, 0)
+        a:drop()
+        b:drop()
+    end)
+end
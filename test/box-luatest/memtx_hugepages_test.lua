@@ -0,0 +1,46 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {memtx_use_hugepages = true},
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that memtx works with the arena backed by huge pages and
+-- that their usage is reported in box.slab.info().
+g.test_hugepages = function(cg)
+    local used = cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_use_hugepages, true)
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.begin()
+        for i = 1, 10000 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        box.commit()
+        t.assert_equals(s:count(), 10000)
+        t.assert_equals(s:get(5000)[1], 5000)
+        s:drop()
+        return box.slab.info().arena_hugepages_used
+    end)
+    if used == nil then
+        -- Transparent huge pages aren't supported by the system.
+        t.assert(cg.server:grep_log(
+            'memtx arena falls back to regular pages'))
+    else
+        t.assert_ge(used, 0)
+    end
+    t.assert_error_msg_contains(
+        "Can't set option 'memtx_use_hugepages' dynamically",
+        cg.server.exec, cg.server, function()
+            box.cfg{memtx_use_hugepages = false}
+        end)
+end
@@ -0,0 +1,124 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('read_only_txn', {
+    {memtx_use_mvcc_engine = true},
+    {memtx_use_mvcc_engine = false},
+})
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {
+        memtx_use_mvcc_engine = cg.params.memtx_use_mvcc_engine,
+    }})
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.rollback()
+        box.space.test:truncate()
+    end)
+end)
+
+g.test_option = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_contains(
+            "options parameter 'read_only' should be of type boolean",
+            box.begin, {read_only = 1})
+        t.assert_not(box.is_in_txn())
+        box.begin({read_only = false})
+        box.space.test:replace({1, 1})
+        box.commit()
+        box.begin({read_only = true})
+        t.assert_equals(box.space.test:get(1), {1, 1})
+        box.commit()
+    end)
+end
+
+g.test_write = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:replace({1, 1})
+        local msg = 'Read-only transaction does not support data modification'
+        box.begin({read_only = true})
+        t.assert_error_msg_equals(msg, s.replace, s, {2, 2})
+        t.assert_error_msg_equals(msg, s.delete, s, {1})
+        t.assert_error_msg_equals(msg, s.update, s, {1}, {{'=', 2, 2}})
+        t.assert_equals(s:select(), {{1, 1}})
+        box.commit()
+        t.assert_equals(s:select(), {{1, 1}})
+    end)
+end
+
+g.test_repeatable_read = function(cg)
+    t.skip_if(not cg.params.memtx_use_mvcc_engine, 'needs MVCC')
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        for i = 1, 10 do
+            s:replace({i, i % 3})
+        end
+        local stat = box.stat.memtx.tx().mvcc.trackers
+        box.begin({read_only = true})
+        t.assert_equals(s:count(), 10)
+        t.assert_equals(#s.index.sk:select({1}), 4)
+        t.assert_equals(s:get(5), {5, 2})
+        fiber.new(function()
+            s:replace({11, 1})
+            s:delete({5})
+        end):join()
+        t.assert_equals(s:count(), 10)
+        t.assert_equals(#s.index.sk:select({1}), 4)
+        t.assert_equals(s:get(5), {5, 2})
+        t.assert_equals(s:get(11), nil)
+        -- Reads aren't tracked in a read-only transaction.
+        t.assert_equals(box.stat.memtx.tx().mvcc.trackers, stat)
+        box.commit()
+        t.assert_equals(s:count(), 10)
+        t.assert_equals(s:get(5), nil)
+        t.assert_equals(s:get(11), {11, 1})
+    end)
+end
+
+-- Checks that a read-only transaction that saw a prepared change is
+-- aborted if the change is rolled back.
+g.test_prepared_rollback = function(cg)
+    t.skip_if(not cg.params.memtx_use_mvcc_engine, 'needs MVCC')
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        s:replace({1, 1})
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        local f = fiber.new(function()
+            box.begin()
+            s:replace({1, 2})
+            s:replace({2, 2})
+            s:delete({1})
+            s:replace({3, 3})
+            box.commit()
+        end)
+        f:set_joinable(true)
+        fiber.yield()
+        box.begin({read_only = true, txn_isolation = 'read-committed'})
+        t.assert_equals(s:select(), {{2, 2}, {3, 3}})
+        t.assert_equals(s:get(1), nil)
+        box.error.injection.set('ERRINJ_WAL_WRITE', true)
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+        local ok = f:join()
+        t.assert_not(ok)
+        box.error.injection.set('ERRINJ_WAL_WRITE', false)
+        t.assert_error_msg_content_equals(
+            'Transaction has been aborted by conflict', box.commit)
+        t.assert_equals(s:select(), {{1, 1}})
+    end)
+end
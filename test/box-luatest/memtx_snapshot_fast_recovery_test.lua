@@ -0,0 +1,78 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {{2, 'string'}}, unique = false})
+        local seq = box.schema.space.create('seq')
+        seq:create_index('pk', {sequence = true})
+        local trig = box.schema.space.create('trig')
+        trig:create_index('pk')
+        box.begin()
+        for i = 1, 1000 do
+            s:insert({i, tostring(i % 10)})
+            seq:insert({box.NULL, i})
+            trig:insert({i})
+        end
+        box.commit()
+        box.snapshot()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that a space is recovered from a snapshot the same way
+-- regardless of whether rows bypass the transaction machinery.
+g.test_recovery = function(cg)
+    local function stat()
+        return cg.server:exec(function()
+            local s = box.space.test
+            return {
+                len = s:len(), bsize = s:bsize(),
+                sk_len = s.index.sk:len(), seq_len = box.space.seq:len(),
+            }
+        end)
+    end
+    local before = stat()
+    cg.server:restart()
+    t.assert_equals(stat(), before)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:get(7), {7, '7'})
+        t.assert_equals(#s.index.sk:select('7'), 100)
+        t.assert_equals(box.space.seq:insert({box.NULL, 0}), {1001, 0})
+    end)
+end
+
+-- Checks that rows of a space with recovery triggers still go through
+-- a transaction and fire the triggers, while rows of the other spaces
+-- are loaded directly and counted in the space stats.
+g.test_recovery_triggers = function(cg)
+    local run_before_cfg = [[
+        local trigger = require('trigger')
+        rawset(_G, 'test_count', 0)
+        trigger.set('box.space.trig.on_recovery_replace', 'test_trigger',
+                    function()
+            rawset(_G, 'test_count', rawget(_G, 'test_count') + 1)
+        end)
+    ]]
+    cg.server:restart({
+        env = {['TARANTOOL_RUN_BEFORE_BOX_CFG'] = run_before_cfg},
+    })
+    cg.server:exec(function()
+        t.assert_equals(rawget(_G, 'test_count'), 1000)
+        t.assert_equals(box.space.trig:len(), 1000)
+        t.assert_equals(box.space.test:len(), 1000)
+        local stat = box.stat.space()
+        t.assert_equals(stat.trig.insert, 1000)
+        t.assert_equals(stat.test.insert, 1000)
+    end)
+end
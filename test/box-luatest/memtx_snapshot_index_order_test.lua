@@ -0,0 +1,119 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+local xlog = require('xlog')
+
+local g = t.group()
+
+g.before_each(function(cg)
+    cg.server = server:new({
+        box_cfg = {memtx_snapshot_index_order = true},
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk1', {parts = {{2, 'unsigned'}}})
+        s:create_index('sk2', {parts = {{3, 'string'}}, unique = false})
+        s:create_index('sk3', {parts = {{2, 'unsigned'}}, hint = false})
+        s:create_index('hash', {type = 'hash', parts = {{2, 'unsigned'}}})
+        s:create_index('mk', {parts = {{4, 'unsigned', path = '[*]'}},
+                              unique = false})
+        box.begin()
+        for i = 1, 100000 do
+            s:insert({i, (i * 7919) % 100003, tostring(i % 1000), {i, i + 1}})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:drop()
+end)
+
+local function snapshot(cg)
+    local name = cg.server:exec(function()
+        box.snapshot()
+        local checkpoints = box.info.gc().checkpoints
+        local lsn = checkpoints[#checkpoints].signature
+        return string.format('%020d.snap', lsn)
+    end)
+    return fio.pathjoin(cg.server.workdir, name)
+end
+
+-- Returns the number of index order rows by index id.
+local function count_index_order_rows(path)
+    local count = {}
+    for _, row in xlog.pairs(path) do
+        if row.HEADER.type == 'INDEXORDER' then
+            local index_id = row.BODY[0x11]
+            count[index_id] = (count[index_id] or 0) + 1
+        end
+    end
+    return count
+end
+
+local function check_indexes(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:len(), 100000)
+        for _, name in ipairs({'sk1', 'sk2', 'sk3', 'hash'}) do
+            t.assert_equals(s.index[name]:len(), 100000, name)
+            for _, tuple in s.index[name]:pairs() do
+                t.assert_equals(s:get(tuple[1]), tuple)
+            end
+        end
+        t.assert_equals(s.index.mk:len(), 200000)
+        for _, name in ipairs({'sk1', 'sk3'}) do
+            local prev
+            for _, tuple in s.index[name]:pairs() do
+                if prev ~= nil then
+                    t.assert_lt(prev[2], tuple[2])
+                end
+                prev = tuple
+            end
+        end
+    end)
+end
+
+g.test_index_order = function(cg)
+    -- The order is written only for the secondary tree indexes that
+    -- store one entry per tuple.
+    t.assert_equals(count_index_order_rows(snapshot(cg)),
+                    {[1] = 2, [2] = 2, [3] = 2})
+    cg.server:restart()
+    check_indexes(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.sk1:get(7919), {1, 7919, '1', {1, 2}})
+        t.assert_equals(#s.index.sk2:select('1'), 100)
+    end)
+end
+
+g.test_stale_index_order = function(cg)
+    snapshot(cg)
+    cg.server:exec(function()
+        -- Change the space after the snapshot so that the order
+        -- stored in it doesn't match the primary key on recovery.
+        local s = box.space.test
+        s:replace({1, 100003, '1', {1, 2}})
+        s:delete(2)
+        s:insert({2, 100004, '2', {2, 3}})
+    end)
+    cg.server:restart()
+    check_indexes(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.sk1:max(), {2, 100004, '2', {2, 3}})
+        t.assert_equals(s.index.sk1:get(7919), nil)
+    end)
+end
+
+g.test_disabled = function(cg)
+    cg.server:exec(function()
+        box.cfg{memtx_snapshot_index_order = false}
+    end)
+    t.assert_equals(count_index_order_rows(snapshot(cg)), {})
+    cg.server:restart()
+    check_indexes(cg)
+end
@@ -0,0 +1,90 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+-- Number of rows in the test space. The snapshot is a few times bigger
+-- than a batch read by the snapshot reader thread in one go.
+local ROW_COUNT = 5000
+
+g.before_each(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.checksum = cg.server:exec(function(row_count)
+        local digest = require('digest')
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.begin()
+        for i = 1, row_count do
+            -- Random data is not compressed.
+            s:insert({i, digest.urandom(512)})
+        end
+        box.commit()
+        box.snapshot()
+        local crc = digest.crc32.new()
+        for _, tuple in s:pairs() do
+            crc:update(tuple[2])
+        end
+        return crc:result()
+    end, {ROW_COUNT})
+    cg.snap = cg.server:exec(function()
+        local fio = require('fio')
+        local snap = string.format('%020d.snap', box.info.signature)
+        return fio.pathjoin(box.cfg.memtx_dir, snap)
+    end)
+    cg.snap = fio.pathjoin(cg.server.workdir, cg.snap)
+end)
+
+g.after_each(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that a snapshot read in several batches is recovered in full.
+g.test_recovery = function(cg)
+    cg.server:restart()
+    cg.server:exec(function(row_count, checksum)
+        local digest = require('digest')
+        local s = box.space.test
+        t.assert_equals(s:len(), row_count)
+        local crc = digest.crc32.new()
+        for i, tuple in s:pairs() do
+            t.assert_equals(tuple[1], i)
+            crc:update(tuple[2])
+        end
+        t.assert_equals(crc:result(), checksum)
+    end, {ROW_COUNT, cg.checksum})
+end
+
+-- Checks that a corrupted transaction block in the middle of a snapshot
+-- fails recovery unless force_recovery is set, in which case the block
+-- is skipped and the rest of the snapshot is recovered.
+g.test_corrupted_block = function(cg)
+    cg.server:stop()
+    local f = fio.open(cg.snap, {'O_RDWR'})
+    t.assert(f ~= nil)
+    local size = f:stat().size
+    t.assert(f:pwrite(string.rep('\0', 64), math.floor(size / 2)))
+    f:close()
+
+    local s = cg.server
+    local log = fio.pathjoin(s.workdir, s.alias .. '.log')
+    s:start({wait_until_ready = false})
+    t.helpers.retrying({}, function()
+        t.assert(s:grep_log("can't initialize storage", nil,
+                            {filename = log}))
+        t.assert_not(s.process:is_alive())
+    end)
+    s:stop()
+
+    s.box_cfg = {force_recovery = true}
+    s:start()
+    s:exec(function(row_count)
+        local s = box.space.test
+        t.assert_gt(s:len(), 0)
+        t.assert_lt(s:len(), row_count)
+        t.assert_equals(s:get(1)[1], 1)
+        t.assert_equals(s:get(row_count)[1], row_count)
+        s:replace({1})
+    end, {ROW_COUNT})
+end
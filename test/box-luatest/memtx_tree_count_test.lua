@@ -0,0 +1,80 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({
+    memtx_use_mvcc_engine = {false, true},
+    hint = {false, true},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {memtx_use_mvcc_engine = cg.params.memtx_use_mvcc_engine},
+    })
+    cg.server:start()
+    cg.server:exec(function(hint)
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {hint = hint})
+        s:create_index('sk', {parts = {{2, 'unsigned'}, {3, 'unsigned'}},
+                              unique = false, hint = hint})
+        box.begin()
+        for i = 1, 10000 do
+            s:insert({i, i % 100, i % 7})
+        end
+        box.commit()
+    end, {cg.params.hint})
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that index:count() matches the number of tuples returned by
+-- index:select() for all the range iterator types.
+g.test_count = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local keys = {
+            {}, {0}, {1}, {50}, {99}, {100}, {50, 0}, {50, 3}, {50, 10},
+        }
+        local iterators = {'EQ', 'REQ', 'ALL', 'LT', 'LE', 'GE', 'GT'}
+        for _, key in ipairs(keys) do
+            for _, it in ipairs(iterators) do
+                local opts = {iterator = it}
+                local msg = string.format('key %s, iterator %s',
+                                          table.concat(key, ','), it)
+                t.assert_equals(s.index.sk:count(key, opts),
+                                #s.index.sk:select(key, opts), msg)
+            end
+        end
+        for _, key in ipairs({{0}, {1}, {5000}, {10000}, {10001}}) do
+            for _, it in ipairs(iterators) do
+                local opts = {iterator = it}
+                t.assert_equals(s.index.pk:count(key, opts),
+                                #s.index.pk:select(key, opts))
+            end
+        end
+        t.assert_equals(s.index.sk:count({50}), 100)
+        t.assert_equals(s.index.sk:count({50}, {iterator = 'GE'}), 5000)
+        t.assert_equals(s.index.pk:count({5000}, {iterator = 'LT'}), 4999)
+    end)
+end
+
+-- Checks the count after deletions that free the tree leaves.
+g.test_count_after_delete = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        box.begin()
+        for i = 2001, 4000 do
+            s:delete(i)
+        end
+        box.commit()
+        t.assert_equals(s.index.pk:count({1}, {iterator = 'GE'}), 8000)
+        t.assert_equals(s.index.pk:count({5000}, {iterator = 'LE'}), 3000)
+        t.assert_equals(s.index.sk:count({50}), 80)
+        box.begin()
+        for i = 2001, 4000 do
+            s:insert({i, i % 100, i % 7})
+        end
+        box.commit()
+    end)
+end
@@ -0,0 +1,125 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_enterprise()
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, name in ipairs({'test', 'plain'}) do
+            if box.space[name] ~= nil then
+                box.space[name]:drop()
+            end
+        end
+    end)
+end)
+
+-- Check that compressed fields are returned intact by all kinds
+-- of requests and take less memory than uncompressed ones.
+g.test_compression = function(cg)
+    cg.server:exec(function()
+        local json = require('json')
+        local statuses = {'pending', 'processing', 'shipped', 'delivered'}
+        local function doc(i)
+            return json.encode({
+                id = i,
+                status = statuses[i % #statuses + 1],
+                customer = {name = 'customer' .. i % 100, country = 'NL'},
+            })
+        end
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'doc', type = 'string', compression = 'zstd'},
+            {name = 'note', type = 'any', compression = 'zstd',
+             is_nullable = true},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        local plain = box.schema.space.create('plain')
+        plain:create_index('pk')
+        box.begin()
+        for i = 1, 20000 do
+            s:insert({i, doc(i)})
+            plain:insert({i, doc(i)})
+        end
+        box.commit()
+        t.assert_lt(s:bsize(), plain:bsize())
+
+        t.assert_equals(s:get(1), {1, doc(1)})
+        t.assert_equals(s:get(20000), {20000, doc(20000)})
+        t.assert_equals(s:select({100}, {iterator = 'ge', limit = 2}),
+                        {{100, doc(100)}, {101, doc(101)}})
+        local count = 0
+        for _, tuple in s:pairs() do
+            t.assert_equals(tuple[2], doc(tuple[1]))
+            count = count + 1
+        end
+        t.assert_equals(count, 20000)
+
+        -- Short fields aren't compressed.
+        t.assert_equals(s:replace({1, 'short', 'x'}), {1, 'short', 'x'})
+        t.assert_equals(s:get(1), {1, 'short', 'x'})
+        local note = {key = string.rep('value', 10)}
+        t.assert_equals(s:update(2, {{'=', 3, note}}), {2, doc(2), note})
+        t.assert_equals(s:get(2), {2, doc(2), note})
+        s:upsert({3, 'none'}, {{'=', 2, doc(30)}})
+        t.assert_equals(s:get(3), {3, doc(30)})
+        t.assert_equals(s:delete(4), {4, doc(4)})
+        t.assert_equals(s:get(4), nil)
+
+        -- Compressed fields can't be indexed.
+        t.assert_error_msg_content_equals(
+            "Indexed field does not support compression",
+            s.create_index, s, 'tk', {parts = {'doc'}})
+    end)
+end
+
+-- Check that compressed spaces are recovered from a snapshot.
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        local format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'data', type = 'string', compression = 'zstd'},
+        }
+        local s = box.schema.space.create('test', {format = format})
+        s:create_index('pk')
+        box.begin()
+        for i = 1, 1000 do
+            s:insert({i, string.rep('data' .. i, 10)})
+        end
+        box.commit()
+        box.snapshot()
+        s:replace({1, string.rep('wal', 10)})
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:count(), 1000)
+        t.assert_equals(s:get(1), {1, string.rep('wal', 10)})
+        for i = 2, 1000 do
+            t.assert_equals(s:get(i), {i, string.rep('data' .. i, 10)})
+        end
+    end)
+end
+
+-- Check that compression is rejected by vinyl.
+g.test_vinyl = function(cg)
+    cg.server:exec(function()
+        local format = {{name = 'x', type = 'string', compression = 'zstd'}}
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support compression",
+            box.schema.space.create, 'test',
+            {engine = 'vinyl', format = format})
+    end)
+end
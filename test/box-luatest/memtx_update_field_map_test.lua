@@ -0,0 +1,90 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Check updates of non-indexed fields, which reuse the field map
+-- of the old tuple.
+g.test_update_non_indexed = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'name', type = 'string'},
+            {name = 'counter', type = 'unsigned'},
+            {name = 'data', type = 'any', is_nullable = true},
+        }})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {'name'}, unique = false})
+        s:insert({1, 'a', 0})
+        s:insert({2, 'b', 0, {x = 1}})
+        for _ = 1, 300 do
+            s:update(1, {{'+', 'counter', 1}})
+            s:upsert({2, 'b', 0}, {{'+', 3, 2}})
+        end
+        t.assert_equals(s:get(1), {1, 'a', 300})
+        t.assert_equals(s:get(2), {2, 'b', 600, {x = 1}})
+        t.assert_equals(s.index.sk:select('a'), {{1, 'a', 300}})
+        t.assert_equals(s:update(2, {{'=', '[4].x', 'long value'}}),
+                        {2, 'b', 600, {x = 'long value'}})
+        t.assert_equals(s.index.sk:select('b'),
+                        {{2, 'b', 600, {x = 'long value'}}})
+
+        -- Changed fields are still validated.
+        t.assert_error_msg_content_equals(
+            "Tuple field 3 (counter) type does not match one required " ..
+            "by operation: expected unsigned, got integer",
+            s.update, s, 1, {{'-', 'counter', 301}})
+        t.assert_error_msg_content_equals(
+            "Tuple field 3 (counter) type does not match one required " ..
+            "by operation: expected unsigned, got string",
+            s.update, s, 1, {{'=', 'counter', 'x'}})
+        t.assert_equals(s:get(1), {1, 'a', 300})
+
+        -- Updates of indexed fields and field count changes.
+        t.assert_equals(s:update(1, {{'=', 'name', 'c'}}), {1, 'c', 300})
+        t.assert_equals(s.index.sk:select('c'), {{1, 'c', 300}})
+        t.assert_equals(s:update(1, {{'!', 4, 'x'}}), {1, 'c', 300, 'x'})
+        t.assert_equals(s:update(1, {{'#', 4, 1}}), {1, 'c', 300})
+    end)
+end
+
+-- Check that field constraints are checked on updates of
+-- non-indexed fields.
+g.test_update_constraint = function(cg)
+    cg.server:exec(function()
+        box.schema.func.create('positive', {
+            language = 'LUA', is_deterministic = true,
+            body = 'function(x) return x > 0 end',
+        })
+        local s = box.schema.space.create('test', {format = {
+            {name = 'id', type = 'unsigned'},
+            {name = 'value', type = 'number', constraint = 'positive'},
+        }})
+        s:create_index('pk')
+        s:insert({1, 1})
+        t.assert_equals(s:update(1, {{'+', 2, 1.5}}), {1, 2.5})
+        t.assert_error_msg_content_equals(
+            "Check constraint 'positive' failed for field '2 (value)'",
+            s.update, s, 1, {{'-', 2, 10}})
+        t.assert_equals(s:get(1), {1, 2.5})
+        s:drop()
+        box.schema.func.drop('positive')
+    end)
+end
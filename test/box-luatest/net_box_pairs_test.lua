@@ -0,0 +1,87 @@
+local fun = require('fun')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        for i = 1, 1000 do
+            s:insert({i, i % 10})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.conn = net.connect(cg.server.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+end)
+
+-- Collects the tuples returned by an iterator into an array.
+local function collect(...)
+    return fun.iter(...):map(function(tuple)
+        return tuple:totable()
+    end):totable()
+end
+
+g.test_pairs = function(cg)
+    local s = cg.conn.space.test
+    local expected = cg.server:exec(function()
+        return box.space.test:select()
+    end)
+    for _, batch_size in ipairs({1, 7, 100, 1000, 2000}) do
+        local res = {}
+        for _, tuple in s:pairs(nil, {batch_size = batch_size}) do
+            table.insert(res, tuple)
+        end
+        t.assert_equals(res, expected)
+    end
+    t.assert_equals(#s:pairs():totable(), 1000)
+    t.assert_equals(collect(s.index.pk:pairs({995}, {iterator = 'gt'})),
+                    {{996, 6}, {997, 7}, {998, 8}, {999, 9}, {1000, 0}})
+    t.assert_equals(collect(s.index.pk:pairs({5}, {iterator = 'le',
+                                                   batch_size = 2})),
+                    {{5, 5}, {4, 4}, {3, 3}, {2, 2}, {1, 1}})
+    t.assert_equals(collect(s:pairs({995}, {iterator = 'ge',
+                                            after = {997}})),
+                    {{998, 8}, {999, 9}, {1000, 0}})
+    t.assert_equals(#s.index.sk:pairs({3}, {batch_size = 7}):totable(), 100)
+    t.assert_equals(collect(s:pairs({2000})), {})
+    t.assert_equals(collect(s:pairs({1000}, {batch_size = 1})), {{1000, 0}})
+end
+
+g.test_errors = function(cg)
+    local s = cg.conn.space.test
+    t.assert_error_msg_content_equals(
+        "Illegal parameters, unexpected option 'limit'",
+        s.pairs, s, nil, {limit = 10})
+    t.assert_error_msg_content_equals(
+        "batch_size must be a positive integer",
+        s.pairs, s, nil, {batch_size = 0})
+    cg.server:exec(function()
+        box.schema.create_space('test2'):create_index('pk')
+    end)
+    t.helpers.retrying({}, function()
+        cg.conn:ping()
+        t.assert_not_equals(cg.conn.space.test2, nil)
+    end)
+    s = cg.conn.space.test2
+    cg.server:exec(function()
+        box.space.test2:drop()
+    end)
+    local gen, param, state = s:pairs()
+    t.assert_error_msg_contains("does not exist", gen, param, state)
+end
@@ -0,0 +1,101 @@
+local fiber = require('fiber')
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        rawset(_G, 'cond', fiber.cond())
+        rawset(_G, 'wait', function()
+            _G.cond:wait()
+            return box.session.id()
+        end)
+        rawset(_G, 'echo', function(...)
+            return ...
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_invalid_options = function(cg)
+    t.assert_error_msg_content_equals(
+        "Illegal parameters, options parameter 'size' should be of type " ..
+        "number", net.pool, cg.server.net_box_uri, {size = 'foo'})
+    t.assert_error_msg_content_equals(
+        "pool size must be a positive integer",
+        net.pool, cg.server.net_box_uri, {size = 0})
+end
+
+-- Checks that requests are sent over the least loaded connection.
+g.test_balance = function(cg)
+    local pool = net.pool(cg.server.net_box_uri, {size = 3})
+    t.assert(pool:is_connected())
+    t.assert_equals(#pool.connections, 3)
+    local futures = {}
+    for i = 1, 3 do
+        futures[i] = pool:call('wait', {}, {is_async = true})
+    end
+    for i = 1, 3 do
+        t.assert_equals(pool.connections[i]._transport:
+                        inprogress_request_count(), 1)
+    end
+    t.assert_equals(pool:call('echo', {1, 2}), {1, 2})
+    t.assert_equals(pool:eval('return ...', {3}), 3)
+    cg.server:exec(function()
+        _G.cond:broadcast()
+    end)
+    local results = net.wait_all(futures)
+    local sessions = {}
+    for i = 1, 3 do
+        sessions[results[i][1]] = true
+    end
+    t.assert_equals(require('fun').length(sessions), 3)
+    pool:close()
+    t.assert_not(pool:is_connected())
+end
+
+g.test_wait_all = function(cg)
+    local conn = net.connect(cg.server.net_box_uri)
+    local futures = {}
+    for i = 1, 10 do
+        futures[i] = conn:call('echo', {i}, {is_async = true})
+    end
+    local results = net.wait_all(futures, 10)
+    for i = 1, 10 do
+        t.assert_equals(results[i], {i})
+    end
+    t.assert_equals(net.wait_all({}), {})
+
+    -- An error is returned if any of the requests fails.
+    futures = {
+        conn:call('echo', {1}, {is_async = true}),
+        conn:call('no_such_function', {}, {is_async = true}),
+    }
+    local res, err = net.wait_all(futures)
+    t.assert_equals(res, nil)
+    t.assert_equals(err.message, "Procedure 'no_such_function' is not " ..
+                    "defined")
+
+    -- The timeout is shared by all the requests.
+    futures = {
+        conn:call('wait', {}, {is_async = true}),
+        conn:call('wait', {}, {is_async = true}),
+    }
+    local start = fiber.clock()
+    res, err = net.wait_all(futures, 0.1)
+    t.assert_lt(fiber.clock() - start, 1)
+    t.assert_equals(res, nil)
+    t.assert_equals(err.type, 'TimedOut')
+    cg.server:exec(function()
+        _G.cond:broadcast()
+    end)
+    conn:close()
+end
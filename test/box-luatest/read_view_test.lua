@@ -4,19 +4,133 @@ local t = require('luatest')
 local g = t.group()
 
 g.before_all(function(cg)
+    t.tarantool.skip_if_enterprise()
     cg.server = server:new({alias = 'master'})
     cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {
+            format = {{'id', 'unsigned'}, {'value', 'string'}},
+        })
+        s:create_index('pk')
+        s:create_index('sk', {type = 'hash', parts = {'value'}})
+        s:create_index('bitset', {type = 'bitset', parts = {'value'}})
+        for i = 1, 10 do
+            s:insert({i, tostring(i)})
+        end
+    end)
 end)
 
 g.after_all(function(cg)
-    cg.server:stop()
+    if cg.server ~= nil then
+        cg.server:drop()
+    end
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        for _, rv in ipairs(box.read_view.list()) do
+            rv:close()
+        end
+    end)
 end)
 
+-- Checks that a read view isn't affected by changes done after it was open.
 g.test_read_view = function(cg)
-    t.tarantool.skip_if_enterprise()
     cg.server:exec(function()
+        local s = box.space.test
+        local rv = box.read_view.open({name = 'test'})
+        t.assert_equals(rv.name, 'test')
+        t.assert_equals(rv.is_system, false)
+        t.assert_equals(rv.status, 'open')
+        t.assert_equals(rv.vclock, box.info.vclock)
+        t.assert_is(box.read_view.list()[1], rv)
+        s:delete(1)
+        s:replace({2, 'two'})
+        s:insert({11, '11'})
+        local rv_s = rv.space.test
+        t.assert_is(rv.space[s.id], rv_s)
+        t.assert_is(rv_s.index.pk, rv_s.index[0])
+        t.assert_equals(rv_s.index.sk.type, 'HASH')
+        t.assert_equals(rv_s.index.bitset, nil)
+        local expected = {}
+        for i = 1, 10 do
+            table.insert(expected, {i, tostring(i)})
+        end
+        t.assert_equals(rv_s:select(), expected)
+        t.assert_equals(rv_s:select({}, {limit = 2, offset = 3}),
+                        {{4, '4'}, {5, '5'}})
+        t.assert_equals(rv_s:pairs():map(function(tuple)
+            return tuple.value
+        end):totable(), require('fun').iter(expected):map(function(tuple)
+            return tuple[2]
+        end):totable())
+        t.assert_items_equals(rv_s.index.sk:select(), expected)
+        t.assert_equals(s:select(nil, {limit = 2}), {{2, 'two'}, {3, '3'}})
+        rv:close()
+        t.assert_equals(rv.status, 'closed')
+        t.assert_equals(box.read_view.list(), {})
+        t.assert_error_msg_equals('read view is closed', rv.close, rv)
+    end)
+end
+
+-- Checks that closing a read view invalidates its iterators.
+g.test_close_iterator = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        t.assert_equals(rv.name, 'unknown')
+        local gen, param, state = rv.space.test:pairs()
+        local _, tuple = gen(param, state)
+        t.assert_equals(tuple, {2, 'two'})
+        rv:close()
+        t.assert_error_msg_equals('read view is closed', gen, param, state)
+        t.assert_error_msg_equals('read view is closed',
+                                  rv.space.test.select, rv.space.test)
+    end)
+end
+
+-- Checks that a read view is closed when the read view object is garbage
+-- collected but not while an iterator over it is in use.
+g.test_gc = function(cg)
+    cg.server:exec(function()
+        box.read_view.open({name = 'unused'})
+        local gen, param, state = box.read_view.open({
+            name = 'iterated',
+        }).space.test:pairs()
+        -- A read view handle is freed in the next cycle after the read view
+        -- object, because it's stored in a weak-keyed table.
+        collectgarbage()
+        collectgarbage()
+        t.assert_equals(#box.read_view.list(), 1)
+        t.assert_equals(box.read_view.list()[1].name, 'iterated')
+        local _, tuple = gen(param, state)
+        t.assert_not_equals(tuple, nil)
+        gen, param, state = nil, nil, nil -- luacheck: no unused
+        collectgarbage()
+        collectgarbage()
+        t.assert_equals(box.read_view.list(), {})
+    end)
+end
+
+-- Checks errors raised on unsupported read view usage.
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        local rv_s = rv.space.test
+        t.assert_error_msg_equals(
+            "Community edition does not support read view lookup by key",
+            rv_s.select, rv_s, {1})
+        t.assert_error_msg_equals(
+            "Community edition does not support " ..
+            "read view iterator other than ALL",
+            rv_s.index.pk.pairs, rv_s.index.pk, nil, {iterator = 'GE'})
+        t.assert_error_msg_equals(
+            'Use space:select(...) instead of space.select(...)',
+            rv_s.select)
         t.assert_error_msg_equals(
-            "Community edition does not support read view",
-            function() box.read_view.open() end)
+            'Use index:pairs(...) instead of index.pairs(...)',
+            rv_s.index.pk.pairs)
+        t.assert_error_msg_contains(
+            "Illegal parameters, options parameter 'name' should be " ..
+            "of type string", box.read_view.open, {name = 1})
     end)
 end
@@ -0,0 +1,112 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.sequence.test ~= nil then
+            box.sequence.test:drop()
+        end
+    end)
+end)
+
+g.test_cache = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {cache = 10})
+        local lsn = box.info.lsn
+        for i = 1, 20 do
+            t.assert_equals(seq:next(), i)
+        end
+        -- The values are persisted on the 1st and 11th calls.
+        t.assert_equals(box.info.lsn - lsn, 2)
+        t.assert_equals(seq:current(), 20)
+        t.assert_equals(box.space._sequence_data:get(seq.id), {seq.id, 21})
+    end)
+    -- The reserved values are skipped on recovery from WAL.
+    cg.server:restart()
+    cg.server:exec(function()
+        local seq = box.sequence.test
+        t.assert_equals(seq:current(), 21)
+        t.assert_equals(seq:next(), 22)
+        for i = 23, 25 do
+            t.assert_equals(seq:next(), i)
+        end
+        box.snapshot()
+    end)
+    -- The reserved values are skipped on recovery from snapshot.
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.sequence.test:next(), 33)
+    end)
+end
+
+g.test_limit = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {
+            cache = 10, max = 5, cycle = true,
+        })
+        for i = 1, 5 do
+            t.assert_equals(seq:next(), i)
+        end
+        t.assert_equals(box.space._sequence_data:get(seq.id), {seq.id, 5})
+        t.assert_equals(seq:next(), 1)
+        t.assert_equals(box.space._sequence_data:get(seq.id), {seq.id, 5})
+        seq:alter({step = -1, min = -5, max = -1, start = -1})
+        seq:reset()
+        for i = 1, 5 do
+            t.assert_equals(seq:next(), -i)
+        end
+        t.assert_equals(box.space._sequence_data:get(seq.id), {seq.id, -5})
+    end)
+end
+
+g.test_rollback = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {cache = 10})
+        box.begin()
+        t.assert_equals(seq:next(), 1)
+        box.rollback()
+        t.assert_equals(box.space._sequence_data:get(seq.id), nil)
+        -- The reservation is persisted again.
+        local lsn = box.info.lsn
+        t.assert_equals(seq:next(), 2)
+        t.assert_equals(box.info.lsn - lsn, 1)
+        t.assert_equals(box.space._sequence_data:get(seq.id), {seq.id, 12})
+    end)
+end
+
+-- Checks that the reserved values aren't generated until the
+-- reservation is committed.
+g.test_reserve_on_commit = function(cg)
+    cg.server:exec(function()
+        local seq = box.schema.sequence.create('test', {cache = 10})
+        box.begin()
+        t.assert_equals(seq:next(), 1)
+        -- The reservation isn't committed, so the value is persisted.
+        t.assert_equals(seq:next(), 2)
+        t.assert_equals(box.space._sequence_data:get(seq.id), {seq.id, 12})
+        box.commit()
+        local lsn = box.info.lsn
+        t.assert_equals(seq:next(), 3)
+        t.assert_equals(box.info.lsn, lsn)
+        t.assert_equals(box.space._sequence_data:get(seq.id), {seq.id, 12})
+    end)
+end
+
+g.test_invalid = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Failed to create sequence 'test': cache must be non-negative",
+            box.schema.sequence.create, 'test', {cache = -1})
+    end)
+end
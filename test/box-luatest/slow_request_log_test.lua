@@ -0,0 +1,62 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.schema.user.grant('guest', 'super')
+        rawset(_G, 'slow_call', function()
+            require('fiber').sleep(0.2)
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg({too_long_threshold = 0.5})
+    end)
+end)
+
+-- Check that a slow DML request is logged with its space, index,
+-- iterator and key.
+g.test_dml = function(cg)
+    cg.server:exec(function()
+        box.cfg({too_long_threshold = 0})
+    end)
+    local conn = net.connect(cg.server.net_box_uri)
+    conn.space.test:select({42}, {iterator = 'GE'})
+    conn:close()
+    t.helpers.retrying({}, function()
+        local space_id = cg.server:exec(function()
+            return box.space.test.id
+        end)
+        t.assert(cg.server:grep_log(
+            'too long SELECT request: space ' .. space_id .. ', index 0, ' ..
+            'iterator GE, key %[42%]'))
+    end)
+end
+
+-- Check that a slow call is logged with the number of yields.
+g.test_call = function(cg)
+    cg.server:exec(function()
+        box.cfg({too_long_threshold = 0.1})
+    end)
+    local conn = net.connect(cg.server.net_box_uri)
+    conn:call('slow_call')
+    conn:close()
+    t.helpers.retrying({}, function()
+        t.assert(cg.server:grep_log(
+            'too long CALL request: queue [0-9.]+ sec, exec [0-9.]+ sec, ' ..
+            '[1-9][0-9]* yields'))
+    end)
+end
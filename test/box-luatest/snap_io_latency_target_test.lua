@@ -0,0 +1,65 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {snap_io_latency_target = 0.01}})
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.create_space('test'):create_index('primary')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.snap_io_latency_target, 0.01)
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'snap_io_latency_target': " ..
+            "value must be >= 0",
+            box.cfg, {snap_io_latency_target = -1})
+        t.assert_equals(box.cfg.snap_io_latency_target, 0.01)
+        local info = box.info.snap_io
+        t.assert_equals(info.latency_target, 0.01)
+        t.assert_gt(info.rate_limit, 0)
+
+        box.cfg{snap_io_latency_target = 0}
+        t.assert_equals(box.info.snap_io,
+                        {latency_target = 0, wal_latency = 0,
+                         rate_limit = 0})
+        box.cfg{snap_io_latency_target = 0.01}
+        t.assert_equals(box.info.snap_io.latency_target, 0.01)
+        -- A checkpoint works with the limit.
+        box.space.test:insert({1})
+        box.snapshot()
+    end)
+end
+
+-- Checks that the rate limit goes down when WAL writes are slow and
+-- goes back up when they are fast.
+g.test_adaptive = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        local max_rate = box.info.snap_io.rate_limit
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        local f = fiber.new(s.replace, s, {2})
+        f:set_joinable(true)
+        fiber.sleep(0.1)
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+        t.assert_equals(f:join(), true)
+        local rate
+        t.helpers.retrying({}, function()
+            rate = box.info.snap_io.rate_limit
+            t.assert_lt(rate, max_rate)
+        end)
+        t.helpers.retrying({}, function()
+            t.assert_gt(box.info.snap_io.rate_limit, rate)
+        end)
+    end)
+end
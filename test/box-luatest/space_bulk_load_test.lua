@@ -0,0 +1,110 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('space_bulk_load', t.helpers.matrix({
+    engine = {'memtx', 'vinyl'},
+}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.create_space('test', {engine = engine})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}})
+        s:create_index('nk', {parts = {3, 'string'}, unique = false})
+    end, {cg.params.engine})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+g.test_invalid_args = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_error_msg_equals(
+            "Illegal parameters, source should be a table or a function",
+            s.bulk_load, s, 1)
+        t.assert_error_msg_equals(
+            "Illegal parameters, options parameter 'batch_size' " ..
+            "should be positive",
+            s.bulk_load, s, {}, {batch_size = 0})
+        s:insert({1, 1, 'a'})
+        t.assert_error_msg_equals(
+            "Illegal parameters, space is not empty",
+            s.bulk_load, s, {})
+        s:delete({1})
+        box.begin()
+        t.assert_error_msg_equals(
+            "Operation is not permitted when there is an active transaction ",
+            s.bulk_load, s, {})
+        box.rollback()
+    end)
+end
+
+g.test_load = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local i = 0
+        s:bulk_load(function()
+            i = i + 1
+            if i <= 1000 then
+                return {i, 1000 - i, tostring(i % 10)}
+            end
+        end, {batch_size = 100})
+        t.assert_equals(s:count(), 1000)
+        t.assert_equals(s.index.sk:count(), 1000)
+        t.assert_equals(s.index.nk:count('7'), 100)
+        t.assert_equals(s.index.sk:get(0), {1000, 0, '0'})
+        t.assert_equals(s.index.sk.id, 1)
+        t.assert_equals(s.index.nk.id, 2)
+        t.assert_equals(s.index.nk.unique, false)
+    end)
+end
+
+g.test_failure = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_error_msg_contains(
+            "Duplicate key exists in unique index \"sk\"",
+            s.bulk_load, s, {{1, 1, 'a'}, {2, 2, 'b'}, {3, 1, 'c'}},
+            {batch_size = 2})
+        t.assert_equals(s:select(), {})
+        t.assert_equals(s.index.sk.id, 1)
+        t.assert_equals(s.index.nk.id, 2)
+        t.assert_error_msg_contains(
+            "Duplicate key exists in unique index \"pk\"",
+            s.bulk_load, s, {{1, 1, 'a'}, {1, 2, 'b'}})
+        t.assert_equals(s:select(), {})
+        s:bulk_load({{1, 1, 'a'}, {2, 2, 'b'}})
+        t.assert_equals(s.index.sk:select(), {{1, 1, 'a'}, {2, 2, 'b'}})
+    end)
+end
+
+g.test_source_error = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local i = 0
+        t.assert_error_msg_equals('source error', s.bulk_load, s, function()
+            i = i + 1
+            if i > 10 then
+                error('source error', 0)
+            end
+            return {i, i, tostring(i)}
+        end, {batch_size = 3})
+        t.assert_equals(s:select(), {})
+        t.assert_equals(s.index.sk.id, 1)
+        t.assert_equals(s.index.nk.id, 2)
+        t.assert_equals(s.index.nk.unique, false)
+    end)
+end
@@ -0,0 +1,42 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks spaces with ids below and above the dense cache threshold.
+g.test_space_ids = function(cg)
+    for _, id in ipairs({600, 4095, 4096, 4097, 100000}) do
+        cg.server:exec(function(id)
+            local s = box.schema.space.create('test' .. id, {id = id})
+            s:create_index('pk')
+            s:insert({id})
+            t.assert_equals(box.space[id]:get(id), {id})
+            s:truncate()
+            t.assert_equals(box.space[id]:select(), {})
+            s:rename('renamed' .. id)
+        end, {id})
+        -- Requests over iproto look up the space by id.
+        local conn = require('net.box').connect(cg.server.net_box_uri)
+        conn.space['renamed' .. id]:insert({id})
+        t.assert_equals(conn.space['renamed' .. id]:get(id), {id})
+        local space = conn.space['renamed' .. id]
+        cg.server:exec(function(id)
+            t.assert_equals(box.space[id]:select(), {{id}})
+            box.space[id]:drop()
+            t.assert_equals(box.space[id], nil)
+        end, {id})
+        t.assert_error_msg_content_equals(
+            string.format("Space '%d' does not exist", id),
+            space.get, space, id)
+        conn:close()
+    end
+end
@@ -0,0 +1,96 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.schema.space.create('test', {format = {
+            {'id', 'unsigned'},
+            {'name', 'string'},
+            {'balance', 'decimal', is_nullable = true},
+            {'rate', 'number', is_nullable = true},
+            {'active', 'boolean', is_nullable = true},
+        }})
+        box.space.test:create_index('pk')
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+local function write_file(cg, content)
+    local path = fio.pathjoin(cg.server.workdir, 'import.csv')
+    local f = fio.open(path, {'O_CREAT', 'O_WRONLY', 'O_TRUNC'},
+                       tonumber('644', 8))
+    f:write(content)
+    f:close()
+    return path
+end
+
+g.test_import = function(cg)
+    local path = write_file(cg, 'id,name,balance,rate,active\n' ..
+                                '1,foo,10.50,1.5,true\n' ..
+                                '2,"bar, baz",-3,2,false\n' ..
+                                '\n' ..
+                                '3,"multi\nline ""quoted""",,,\n')
+    cg.server:exec(function(path)
+        local decimal = require('decimal')
+        local s = box.space.test
+        t.assert_equals(s:import_csv(path, {skip_header = true,
+                                            batch_size = 2}), 3)
+        t.assert_equals(s:select(), {
+            {1, 'foo', decimal.new('10.50'), 1.5, true},
+            {2, 'bar, baz', decimal.new(-3), 2, false},
+            {3, 'multi\nline "quoted"', box.NULL, box.NULL, box.NULL},
+        })
+    end, {path})
+end
+
+g.test_delimiter = function(cg)
+    local path = write_file(cg, "1;'a;b'\n2;c\n")
+    cg.server:exec(function(path)
+        local s = box.space.test
+        t.assert_equals(s:import_csv(path, {delimiter = ';', quote = "'"}),
+                        2)
+        t.assert_equals(s:select(), {{1, 'a;b'}, {2, 'c'}})
+    end, {path})
+end
+
+g.test_errors = function(cg)
+    local path = write_file(cg, '1,a\n2,b\nx,c\n')
+    cg.server:exec(function(path)
+        local s = box.space.test
+        t.assert_error_msg_equals(
+            "Failed to import CSV at line 3: " ..
+            "can't convert field 1 'x' to unsigned",
+            s.import_csv, s, path, {batch_size = 1})
+        -- The batches inserted before the error are kept.
+        t.assert_equals(s:select(), {{1, 'a'}, {2, 'b'}})
+        t.assert_error_msg_contains("Duplicate key exists",
+                                    s.import_csv, s, path)
+        t.assert_error_msg_contains("failed to open file",
+                                    s.import_csv, s, path .. '.missing')
+        t.assert_error_msg_equals(
+            "Illegal parameters, options parameter 'delimiter' " ..
+            "should be a single character",
+            s.import_csv, s, path, {delimiter = ';;'})
+        t.assert_error_msg_equals(
+            "Illegal parameters, options parameter 'batch_size' " ..
+            "should be a positive integer",
+            s.import_csv, s, path, {batch_size = 0})
+    end, {path})
+end
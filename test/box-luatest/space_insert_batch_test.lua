@@ -0,0 +1,83 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('space_insert_batch', {
+    {engine = 'memtx'},
+    {engine = 'vinyl'},
+})
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine)
+        local s = box.schema.create_space('test', {engine = engine})
+        s:create_index('primary')
+        s:create_index('secondary', {parts = {2, 'string'}})
+    end, {cg.params.engine})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+    end)
+end)
+
+g.test_insert_batch = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:insert_batch({}), nil)
+        local tuples = {}
+        for i = 1, 100 do
+            tuples[i] = {i, 'k' .. i}
+        end
+        tuples[101] = box.tuple.new({101, 'k101'})
+        s:insert_batch(tuples)
+        t.assert_equals(s:count(), 101)
+        t.assert_equals(s:get(50), {50, 'k50'})
+        t.assert_equals(s.index.secondary:get('k101'), {101, 'k101'})
+
+        s:replace_batch({{1, 'x1'}, {200, 'x200'}})
+        t.assert_equals(s:get(1), {1, 'x1'})
+        t.assert_equals(s:get(200), {200, 'x200'})
+        t.assert_equals(s:count(), 102)
+    end)
+end
+
+-- Check that a failed batch is rolled back as a whole.
+g.test_insert_batch_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:insert({1, 'k1'})
+        t.assert_error_msg_equals(
+            "Usage: space:insert_batch({tuple1, tuple2, ...})",
+            s.insert_batch, s, 1)
+        t.assert_error_msg_content_equals(
+            "Duplicate key exists in unique index \"primary\" in space " ..
+            "\"test\" with old tuple - [1, \"k1\"] and new tuple - " ..
+            "[1, \"k3\"]",
+            s.insert_batch, s, {{2, 'k2'}, {1, 'k3'}})
+        t.assert_error_msg_content_equals(
+            "Illegal parameters, tuple must be an array",
+            s.replace_batch, s, {{2, 'k2'}, 3})
+        t.assert_equals(s:select(), {{1, 'k1'}})
+
+        -- In a transaction only the batch is rolled back.
+        box.begin()
+        s:insert({2, 'k2'})
+        t.assert_error_msg_content_equals(
+            "Duplicate key exists in unique index \"secondary\" in space " ..
+            "\"test\" with old tuple - [1, \"k1\"] and new tuple - " ..
+            "[4, \"k1\"]",
+            s.insert_batch, s, {{3, 'k3'}, {4, 'k1'}})
+        s:insert_batch({{5, 'k5'}})
+        box.commit()
+        t.assert_equals(s:select(), {{1, 'k1'}, {2, 'k2'}, {5, 'k5'}})
+    end)
+end
@@ -0,0 +1,170 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {sequence = true})
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_take_ack_release = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:insert({box.NULL, 10})
+        s:insert({box.NULL, 20})
+        s:insert({box.NULL, 30})
+        t.assert_equals(s:take(0), {1, 10})
+        t.assert_equals(s:take(0), {2, 20})
+        t.assert_equals(s:release(1), {1, 10})
+        t.assert_equals(s:take(0), {1, 10})
+        t.assert_equals(s:take(0), {3, 30})
+        t.assert_equals(s:take(0), nil)
+        t.assert_equals(s:ack({2}), {2, 20})
+        t.assert_equals(s:select(), {{1, 10}, {3, 30}})
+
+        local msg = "Tuple is not taken from space 'test'"
+        t.assert_error_msg_equals(msg, s.ack, s, 2)
+        t.assert_error_msg_equals(msg, s.release, s, 4)
+        s:release(1)
+        t.assert_error_msg_equals(msg, s.ack, s, 1)
+
+        -- A replaced tuple stops being taken.
+        t.assert_equals(s:take(0), {1, 10})
+        s:replace({1, 11})
+        t.assert_error_msg_equals(msg, s.ack, s, 1)
+        t.assert_equals(s:take(0), {1, 11})
+
+        -- Alter keeps the taken tuples.
+        s:alter({name = 'test2'})
+        t.assert_equals(s:take(0), nil)
+        t.assert_equals(s:ack(1), {1, 11})
+        s:alter({name = 'test'})
+    end)
+end
+
+g.test_rollback = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:insert({box.NULL, 10})
+        s:insert({box.NULL, 20})
+        -- A take is undone on rollback.
+        box.begin()
+        t.assert_equals(s:take(0), {1, 10})
+        box.rollback()
+        t.assert_equals(s:take(0), {1, 10})
+        -- An ack is undone on rollback, the tuple stays taken.
+        box.begin()
+        t.assert_equals(s:ack(1), {1, 10})
+        box.rollback()
+        t.assert_equals(s:take(0), {2, 20})
+        t.assert_equals(s:take(0), nil)
+        t.assert_equals(s:release(1), {1, 10})
+        -- A rolled back insert doesn't become ready.
+        box.begin()
+        s:insert({box.NULL, 30})
+        box.rollback()
+        t.assert_equals(s:take(0), {1, 10})
+        t.assert_equals(s:take(0), nil)
+    end)
+end
+
+g.test_disconnect = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        for i = 1, 3 do
+            s:insert({box.NULL, i})
+        end
+        t.assert_equals(s:take(0), {1, 1})
+    end)
+    local conn = require('net.box').connect(cg.server.net_box_uri)
+    local take = 'return box.space.test:take(0)'
+    t.assert_equals(conn:eval(take), {2, 2})
+    t.assert_equals(conn:eval(take), {3, 3})
+    conn:close()
+    -- The tuples taken by the closed session are ready again.
+    cg.server:exec(function()
+        local s = box.space.test
+        t.helpers.retrying({}, function()
+            t.assert_equals(s:take(0), {2, 2})
+        end)
+        t.assert_equals(s:take(0), {3, 3})
+        t.assert_equals(s:take(0), nil)
+    end)
+end
+
+g.test_wait = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        local result
+        local f = fiber.new(function()
+            result = s:take(10)
+        end)
+        f:set_joinable(true)
+        fiber.sleep(0.01)
+        t.assert_equals(f:status(), 'suspended')
+        s:insert({box.NULL, 1})
+        t.assert_equals({f:join()}, {true})
+        t.assert_equals(result, {1, 1})
+
+        -- Release wakes up a waiter.
+        f = fiber.new(function()
+            result = s:take(10)
+        end)
+        f:set_joinable(true)
+        fiber.sleep(0.01)
+        s:release(1)
+        t.assert_equals({f:join()}, {true})
+        t.assert_equals(result, {1, 1})
+
+        -- Timeout.
+        local start = fiber.clock()
+        t.assert_equals(s:take(0.1), nil)
+        t.assert_ge(fiber.clock() - start, 0.1)
+
+        -- Drop wakes up a waiter.
+        f = fiber.new(function()
+            return s:take(10)
+        end)
+        f:set_joinable(true)
+        fiber.sleep(0.01)
+        s:drop()
+        local ok, err = f:join()
+        t.assert_not(ok)
+        t.assert_equals(err.code, box.error.NO_SUCH_SPACE)
+    end)
+end
+
+g.test_unsupported = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('vinyl', {engine = 'vinyl'})
+        s:create_index('pk')
+        t.assert_error_msg_equals(
+            "vinyl does not support queue operations", s.take, s, 0)
+        s:drop()
+        t.assert_error_msg_content_equals(
+            "Illegal parameters, timeout should be a number",
+            box.space.test.take, box.space.test, 'foo')
+    end)
+end
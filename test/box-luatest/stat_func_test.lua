@@ -0,0 +1,57 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.func.create('test_sum', {
+            language = 'LUA',
+            body = 'function(a, b) return a + b end',
+        })
+        box.schema.func.create('test_error', {
+            language = 'LUA',
+            body = 'function() error("test") end',
+        })
+        box.schema.user.grant('guest', 'execute', 'universe')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that box.stat.func() counts calls of functions registered
+-- in _func made from Lua and over IPROTO.
+g.test_stat_func = function(cg)
+    cg.server:exec(function()
+        box.stat.reset()
+        local stat = box.stat.func()
+        t.assert_equals(stat.test_sum, {calls = 0})
+        t.assert_equals(stat.test_error, {calls = 0})
+        t.assert_equals(box.func.test_sum:call({1, 2}), 3)
+        t.assert_equals(box.func.test_sum:call({3, 4}), 7)
+        t.assert_error_msg_contains('test', box.func.test_error.call,
+                                    box.func.test_error)
+        stat = box.stat.func()
+        t.assert_equals(stat.test_sum, {calls = 2})
+        t.assert_equals(stat.test_error, {calls = 1})
+    end)
+    local conn = require('net.box').connect(cg.server.net_box_uri)
+    t.assert_equals(conn:call('test_sum', {5, 6}), 11)
+    t.assert_error_msg_contains('test', conn.call, conn, 'test_error')
+    conn:close()
+    cg.server:exec(function()
+        local stat = box.stat.func()
+        t.assert_equals(stat.test_sum, {calls = 3})
+        t.assert_equals(stat.test_error, {calls = 2})
+        -- Functions that aren't registered in _func aren't counted.
+        rawset(_G, 'test_global', function() return 1 end)
+        t.assert_equals(box.stat.func().test_global, nil)
+        box.stat.reset()
+        t.assert_equals(box.stat.func().test_sum, {calls = 0})
+        t.assert_equals(box.stat.func().test_error, {calls = 0})
+    end)
+end
@@ -0,0 +1,49 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        rawset(_G, 'test_sleep', function(timeout)
+            require('fiber').sleep(timeout)
+        end)
+        box.schema.user.grant('guest', 'execute', 'universe')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that box.stat.latency() reports latency of IPROTO requests
+-- by request type and processing stage.
+g.test_stat_latency = function(cg)
+    cg.server:exec(function()
+        box.stat.reset()
+        local stat = box.stat.latency()
+        for _, name in ipairs({'SELECT', 'INSERT', 'CALL', 'EVAL'}) do
+            t.assert_equals(stat[name].queue.max, 0, name)
+            t.assert_equals(stat[name].exec.max, 0, name)
+        end
+    end)
+    local conn = net.connect(cg.server.net_box_uri)
+    conn:call('test_sleep', {0.1})
+    conn:eval('return 1')
+    conn:close()
+    cg.server:exec(function()
+        local stat = box.stat.latency()
+        t.assert_ge(stat.CALL.exec.max, 0.1)
+        t.assert_ge(stat.CALL.exec.p99, 0.1)
+        t.assert_lt(stat.EVAL.exec.max, 0.1)
+        t.assert_equals(stat.INSERT.exec.max, 0)
+        -- Local calls aren't accounted.
+        rawget(_G, 'test_sleep')(0.2)
+        t.assert_lt(box.stat.latency().CALL.exec.max, 0.2)
+        box.stat.reset()
+        t.assert_equals(box.stat.latency().CALL.exec.max, 0)
+    end)
+end
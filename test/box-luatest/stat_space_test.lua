@@ -0,0 +1,65 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that box.stat.space() counts requests executed by a space.
+g.test_dml = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:truncate()
+        box.stat.reset()
+        s:insert({1, 1})
+        s:insert({2, 1})
+        s:replace({1, 2})
+        s:update({1}, {{'=', 2, 3}})
+        s:upsert({3, 3}, {{'=', 2, 4}})
+        s:delete({2})
+        local stat = box.stat.space().test
+        t.assert_covers(stat, {
+            insert = 2, replace = 1, update = 1, upsert = 1, delete = 1,
+        })
+        box.stat.reset()
+        t.assert_covers(box.stat.space().test, {
+            insert = 0, replace = 0, update = 0, upsert = 0, delete = 0,
+        })
+    end)
+end
+
+-- Check that box.stat.space() counts lookups in indexes.
+g.test_lookup = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        s:truncate()
+        for i = 1, 5 do
+            s:insert({i, i % 2})
+        end
+        box.stat.reset()
+        s:get(1)
+        s.index.pk:min()
+        s:select({2}, {iterator = 'GE'})
+        s:select({2}, {iterator = 'GE', offset = 1, limit = 1})
+        for _ in s.index.sk:pairs({1}) do end
+        local stat = box.stat.space().test.index
+        t.assert_equals(stat.pk, {get = 1, select = 3, scan = 6})
+        t.assert_equals(stat.sk, {get = 0, select = 1, scan = 3})
+        box.stat.reset()
+        stat = box.stat.space().test.index
+        t.assert_equals(stat.pk, {get = 0, select = 0, scan = 0})
+        t.assert_equals(stat.sk, {get = 0, select = 0, scan = 0})
+    end)
+end
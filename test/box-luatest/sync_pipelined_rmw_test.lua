@@ -0,0 +1,91 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            memtx_use_mvcc_engine = true,
+            replication_synchro_quorum = 1,
+            replication_synchro_timeout = 1000,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        box.ctl.promote()
+        local s = box.schema.space.create('test', {is_sync = true})
+        s:create_index('pk')
+        s:insert({1, 0})
+        -- Starts the given number of read-modify-write transactions
+        -- updating the same key while the limbo can't collect the
+        -- quorum and waits for all of them to be prepared.
+        rawset(_G, 'start_increments', function(count)
+            local fiber = require('fiber')
+            box.cfg({replication_synchro_quorum = 2})
+            local fibers = {}
+            for i = 1, count do
+                fibers[i] = fiber.new(function()
+                    box.atomic({txn_isolation = 'read-committed'}, function()
+                        local tuple = box.space.test:get(1)
+                        box.space.test:replace({1, tuple[2] + 1})
+                    end)
+                end)
+                fibers[i]:set_joinable(true)
+            end
+            t.helpers.retrying({}, function()
+                t.assert_equals(box.info.synchro.queue.len, count)
+            end)
+            return fibers
+        end)
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_test('test_cascading_rollback', function(cg)
+    cg.server:exec(function()
+        box.cfg({replication_synchro_timeout = 1000})
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg({replication_synchro_quorum = 1})
+    end)
+end)
+
+-- Check that transactions updating a key changed by a transaction
+-- waiting for the quorum are prepared on top of it instead of
+-- waiting for its confirmation and are confirmed all at once.
+g.test_pipelined_commit = function(cg)
+    cg.server:exec(function()
+        local fibers = _G.start_increments(10)
+        box.cfg({replication_synchro_quorum = 1})
+        for _, f in ipairs(fibers) do
+            t.assert_equals({f:join()}, {true})
+        end
+        t.assert_equals(box.space.test:get(1), {1, 10})
+        t.assert_equals(box.info.synchro.queue.len, 0)
+    end)
+end
+
+-- Check that dependent transactions are rolled back together with
+-- the transaction they were prepared on top of.
+g.test_cascading_rollback = function(cg)
+    cg.server:exec(function()
+        local old = box.space.test:get(1)
+        local fibers = _G.start_increments(10)
+        box.cfg({replication_synchro_timeout = 0.01})
+        for _, f in ipairs(fibers) do
+            local ok, err = f:join()
+            t.assert_not(ok)
+            t.assert_items_include({box.error.SYNC_QUORUM_TIMEOUT,
+                                    box.error.SYNC_ROLLBACK}, {err.code})
+        end
+        t.assert_equals(box.space.test:get(1), old)
+        t.assert_equals(box.info.synchro.queue.len, 0)
+    end)
+end
@@ -0,0 +1,201 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_ddl = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {type = 'text'})
+        t.assert_equals(sk.type, 'TEXT')
+        t.assert_equals(sk.unique, false)
+        t.assert_equals(sk.parts[1].fieldno, 2)
+        t.assert_equals(sk.parts[1].type, 'string')
+        sk:drop()
+        local function check(opts, msg)
+            opts.type = 'text'
+            t.assert_error_msg_content_equals(
+                "Can't create or modify index 'sk' in space 'test': " .. msg,
+                s.create_index, s, 'sk', opts)
+        end
+        check({parts = {{2, 'string'}, {3, 'string'}}},
+              'TEXT index key can not be multipart')
+        check({parts = {2, 'string'}, unique = true},
+              'TEXT index can not be unique')
+        check({parts = {2, 'unsigned'}},
+              'TEXT index field type must be STRING')
+        check({parts = {{'[2][*]', 'string'}}},
+              'TEXT index cannot be multikey')
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "primary key must be unique",
+            s.create_index, s, 'pk', {type = 'text', unique = false})
+    end)
+end
+
+g.test_vinyl = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        t.assert_error_msg_content_equals(
+            "Unsupported index type supplied for index 'sk' in space 'test'",
+            s.create_index, s, 'sk', {type = 'text'})
+    end)
+end
+
+g.test_search = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {type = 'text'})
+        s:insert({1, 'The quick brown fox'})
+        s:insert({2, 'jumps over the lazy dog'})
+        s:insert({3, 'quick, quick: the dog!'})
+        s:insert({4, ''})
+        local function ids(key)
+            local res = {}
+            for _, tuple in sk:pairs(key) do
+                table.insert(res, tuple[1])
+            end
+            table.sort(res)
+            return res
+        end
+        t.assert_equals(ids('quick'), {1, 3})
+        t.assert_equals(ids('dog'), {2, 3})
+        t.assert_equals(ids('quick dog'), {3})
+        t.assert_equals(ids('  dog, QUICK'), {})
+        t.assert_equals(ids('cat'), {})
+        t.assert_equals(ids('quick cat'), {})
+        t.assert_equals(ids(''), {})
+        t.assert_equals(ids('!?'), {})
+        t.assert_equals(#sk:select(), 4)
+        t.assert_equals(sk:count('quick'), 2)
+        t.assert_equals(sk:count(), 4)
+        t.assert_equals(sk:len(), 4)
+        t.assert(sk:bsize() > 0)
+
+        s:replace({3, 'lazy cat'})
+        t.assert_equals(ids('quick'), {1})
+        t.assert_equals(ids('lazy'), {2, 3})
+        t.assert_equals(ids('cat'), {3})
+        s:delete(2)
+        t.assert_equals(ids('lazy'), {3})
+        t.assert_equals(ids('dog'), {})
+        s:update(1, {{'=', 2, 'lazy fox'}})
+        t.assert_equals(ids('lazy'), {1, 3})
+
+        box.begin()
+        s:replace({5, 'lazy dog'})
+        s:delete(1)
+        t.assert_equals(ids('lazy'), {3, 5})
+        box.rollback()
+        t.assert_equals(ids('lazy'), {1, 3})
+        t.assert_equals(ids('dog'), {})
+
+        t.assert_error_msg_content_equals(
+            "Index 'sk' (TEXT) of space 'test' (memtx) does not support " ..
+            "requested iterator type",
+            sk.select, sk, 'lazy', {iterator = 'GE'})
+    end)
+end
+
+g.test_collation = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {
+            type = 'text',
+            parts = {2, 'string', collation = 'unicode_ci'},
+        })
+        s:insert({1, 'Hello World'})
+        s:insert({2, 'HELLO there'})
+        s:insert({3, 'Привет, мир'})
+        s:insert({4, 'МИР'})
+        local function ids(key)
+            local res = {}
+            for _, tuple in sk:pairs(key) do
+                table.insert(res, tuple[1])
+            end
+            table.sort(res)
+            return res
+        end
+        t.assert_equals(ids('hello'), {1, 2})
+        t.assert_equals(ids('world HELLO'), {1})
+        t.assert_equals(ids('мир'), {3, 4})
+        t.assert_equals(ids('привет МИР'), {3})
+    end)
+end
+
+-- Check that an iterator survives changes of the index.
+g.test_iterator_stability = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local sk = s:create_index('sk', {type = 'text'})
+        for i = 1, 1000 do
+            s:insert({i, 'foo bar' .. (i % 2) .. ' w' .. i})
+        end
+        local count = 0
+        for _, tuple in sk:pairs('foo bar0') do
+            t.assert_equals(tuple[1] % 2, 0)
+            count = count + 1
+            s:delete(tuple[1])
+            s:delete(tuple[1] + 1)
+        end
+        t.assert(count > 0)
+        t.assert_equals(sk:count('foo'), 1000 - 2 * count)
+        t.assert_equals(sk:count('bar0') + sk:count('bar1'),
+                        1000 - 2 * count)
+        for _, tuple in sk:pairs('foo') do
+            s:delete(tuple[1])
+        end
+        t.assert_equals(sk:len(), 0)
+        t.assert_equals(sk:count('foo'), 0)
+    end)
+end
+
+-- Check that a TEXT index is rebuilt on recovery.
+g.test_recovery = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {type = 'text'})
+        s:insert({1, 'alpha beta'})
+        s:insert({2, 'beta gamma'})
+        box.snapshot()
+        s:insert({3, 'gamma delta'})
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local sk = box.space.test.index.sk
+        local function ids(key)
+            local res = {}
+            for _, tuple in sk:pairs(key) do
+                table.insert(res, tuple[1])
+            end
+            table.sort(res)
+            return res
+        end
+        t.assert_equals(ids('beta'), {1, 2})
+        t.assert_equals(ids('gamma'), {2, 3})
+        t.assert_equals(sk:len(), 3)
+    end)
+end
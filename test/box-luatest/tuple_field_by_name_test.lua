@@ -0,0 +1,51 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that tuple fields of all kinds are accessed by name the same
+-- way as by number.
+g.test_field_by_name = function(cg)
+    cg.server:exec(function()
+        local decimal = require('decimal')
+        local uuid = require('uuid')
+        local varbinary = require('varbinary')
+        local names = {'uint', 'int', 'big', 'dbl', 'str', 'bool', 'null',
+                       'bin', 'dec', 'uuid', 'arr', 'map'}
+        local format = {}
+        for _, name in ipairs(names) do
+            table.insert(format, {name = name, type = 'any'})
+        end
+        local u = uuid.new()
+        local tuple = box.tuple.new({
+            1, -1, 2ULL^60, 1.5, 'abc', true, box.NULL,
+            varbinary.new('bin'), decimal.new('1.5'), u,
+            {1, {2}}, {a = {b = 1}},
+        }, {format = format})
+        for i, name in ipairs(names) do
+            t.assert_equals(type(tuple[name]), type(tuple[i]), name)
+            t.assert_equals(tuple[name], tuple[i], name)
+        end
+        t.assert_equals(tuple.big, 2ULL^60)
+        t.assert_equals(tuple.null, box.NULL)
+        t.assert(varbinary.is(tuple.bin))
+        t.assert_equals(tuple.dec, decimal.new('1.5'))
+        t.assert_equals(tuple.uuid, u)
+        t.assert_equals(tuple['arr[2][1]'], 2)
+        t.assert_equals(tuple['map.a.b'], 1)
+        t.assert_equals(tuple['[5]'], 'abc')
+        t.assert_equals(tuple.map, {a = {b = 1}})
+        t.assert_equals(tuple.no_such_field, nil)
+        t.assert_equals(tuple.bsize, box.tuple.bsize)
+    end)
+end
+
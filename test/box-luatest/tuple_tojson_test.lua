@@ -0,0 +1,71 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that tuple:tojson() and msgpack.object:tojson() produce the
+-- same JSON as json.encode() of the decoded value.
+g.test_tojson = function(cg)
+    cg.server:exec(function()
+        local json = require('json')
+        local msgpack = require('msgpack')
+        local decimal = require('decimal')
+        local uuid = require('uuid')
+        local values = {
+            {},
+            {1, -1, 0, 2^53, -2^53, 18446744073709551615ULL,
+             -9223372036854775807LL, 1.5, 1e18, 1e300, -0.25},
+            {'', 'abc', 'a"b\\c/d', 'line\nfeed\ttab\r\0end',
+             string.rep('x', 100) .. '\1' .. string.rep('y', 7) .. '\127',
+             'привет мир', string.rep('long string ', 100)},
+            {true, false, box.NULL, msgpack.NULL},
+            {{1, {2, {3}}}, {a = 1, b = {c = 'd'}}, {[1] = 'one', [-2] = 2}},
+            {decimal.new('1.25'), uuid.fromstr(
+                'f6423bdf-b49e-4913-b361-0740c9702e4b'),
+             require('datetime').new({year = 2024, month = 1, day = 1})},
+        }
+        for _, v in ipairs(values) do
+            local expected = json.encode(v)
+            t.assert_equals(box.tuple.new(v):tojson(), expected)
+            t.assert_equals(box.tuple.tojson(box.tuple.new(v)), expected)
+            t.assert_equals(msgpack.object(v):tojson(), expected)
+        end
+        t.assert_equals(msgpack.object('str'):tojson(), '"str"')
+        t.assert_equals(msgpack.object(42):tojson(), '42')
+        t.assert_error_msg_content_equals(
+            'table key must be a number or string', function()
+                msgpack.object({[1.5] = 1}):tojson()
+            end)
+    end)
+end
+
+-- Check that tojson() respects the json serializer options.
+g.test_tojson_cfg = function(cg)
+    cg.server:exec(function()
+        local json = require('json')
+        local msgpack = require('msgpack')
+        local deep = {1, {2, {3, {4}}}}
+        json.cfg({encode_max_depth = 2, encode_deep_as_nil = true})
+        t.assert_equals(box.tuple.new(deep):tojson(), json.encode(deep))
+        t.assert_equals(box.tuple.new(deep):tojson(), '[1,[2,null]]')
+        json.cfg({encode_deep_as_nil = false})
+        t.assert_error_msg_content_equals('Too high nest level', function()
+            box.tuple.new(deep):tojson()
+        end)
+        json.cfg({encode_max_depth = 128})
+        t.assert_equals(msgpack.object({pi = math.pi}):tojson(),
+                        json.encode({pi = math.pi}))
+        json.cfg({encode_number_precision = 3})
+        t.assert_equals(msgpack.object({math.pi}):tojson(), '[3.14]')
+        json.cfg({encode_number_precision = 14})
+    end)
+end
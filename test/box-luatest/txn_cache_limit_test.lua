@@ -0,0 +1,48 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that transactions freed above the txn cache limit are
+-- destroyed correctly.
+g.test_over_cache_limit = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        -- More than the cache size limit.
+        local count = 2000
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        local fibers = {}
+        for i = 1, count do
+            local f = fiber.new(function()
+                box.space.test:replace{i}
+            end)
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        fiber.yield()
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+        for _, f in ipairs(fibers) do
+            t.assert((f:join()))
+        end
+        t.assert_equals(box.space.test:count(), count)
+        -- The cached transactions are still usable.
+        for i = 1, count do
+            box.space.test:delete{i}
+        end
+        t.assert_equals(box.space.test:count(), 0)
+    end)
+end
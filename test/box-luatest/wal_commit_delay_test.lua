@@ -0,0 +1,78 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {wal_commit_delay = 100}})
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('primary')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:truncate()
+    end)
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.wal_commit_delay, 100)
+        t.assert_error_msg_equals(
+            "Incorrect value for option 'wal_commit_delay': " ..
+            "value must be >= 0",
+            box.cfg, {wal_commit_delay = -1})
+        t.assert_equals(box.cfg.wal_commit_delay, 100)
+    end)
+end
+
+-- Check that a commit isn't delayed if the WAL thread is idle.
+g.test_idle = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        local start = fiber.clock()
+        for i = 1, 10 do
+            s:insert({i})
+        end
+        t.assert_lt(fiber.clock() - start, 10)
+        t.assert_equals(s:count(), 10)
+    end)
+end
+
+-- Check that commits held back while the WAL thread is busy are sent
+-- to it as soon as it's done with the previous batch.
+g.test_busy = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        local fibers = {}
+        local function insert(i)
+            local f = fiber.new(s.insert, s, {i})
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        insert(1)
+        fiber.yield()
+        for i = 2, 10 do
+            insert(i)
+        end
+        fiber.yield()
+        local start = fiber.clock()
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+        for _, f in ipairs(fibers) do
+            t.assert_equals(f:join(), true)
+        end
+        t.assert_lt(fiber.clock() - start, 10)
+        t.assert_equals(s:count(), 10)
+    end)
+end
@@ -0,0 +1,83 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+local xlog = require('xlog')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {wal_compression_dictionary = true},
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.space.create('test'):create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function last_xlog(cg)
+    local files = fio.glob(fio.pathjoin(cg.server.workdir, '*.xlog'))
+    table.sort(files)
+    return files[#files]
+end
+
+local function xlog_meta(path)
+    local f = fio.open(path, {'O_RDONLY'})
+    local meta = f:read(512)
+    f:close()
+    return meta
+end
+
+-- Inserts small transactions with similar content.
+local function fill(cg, first, count)
+    cg.server:exec(function(first, count)
+        local s = box.space.test
+        for i = first, first + count - 1 do
+            s:insert({i, 'name' .. i, {city = 'city' .. i % 10,
+                                       street = 'street' .. i % 100}})
+        end
+    end, {first, count})
+end
+
+-- Checks that new WAL files are compressed with a dictionary trained
+-- on the previous ones and can be read back.
+g.test_dictionary = function(cg)
+    local count = 0
+    t.helpers.retrying({timeout = 60}, function()
+        fill(cg, count + 1, 5000)
+        count = count + 5000
+        cg.server:exec(function() box.snapshot() end)
+        fill(cg, count + 1, 1)
+        count = count + 1
+        t.assert_str_contains(xlog_meta(last_xlog(cg)), 'Dictionary: ')
+    end)
+    fill(cg, count + 1, 1000)
+    count = count + 1000
+    local rows = 0
+    for _, row in xlog.pairs(last_xlog(cg)) do
+        t.assert_equals(row.HEADER.type, 'INSERT')
+        rows = rows + 1
+    end
+    t.assert_equals(rows, 1001)
+    cg.server:restart()
+    cg.server:exec(function(count)
+        local s = box.space.test
+        t.assert_equals(s:len(), count)
+        t.assert_equals(s:get(count)[2], 'name' .. count)
+    end, {count})
+end
+
+-- Checks that new WAL files aren't compressed with the dictionary
+-- after the option is disabled.
+g.test_disable = function(cg)
+    cg.server:exec(function()
+        box.cfg{wal_compression_dictionary = false}
+        box.snapshot()
+        box.space.test:replace({1})
+    end)
+    t.assert_not_str_contains(xlog_meta(last_xlog(cg)), 'Dictionary: ')
+end
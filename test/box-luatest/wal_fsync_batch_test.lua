@@ -0,0 +1,57 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server = server:new({box_cfg = {wal_mode = 'fsync'}})
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test')
+        s:create_index('primary')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that a batch that failed to be synced to disk is rolled back
+-- as a whole and doesn't make it to the WAL.
+g.test_sync_failure = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+        s:insert({1})
+        local lsn = box.info.lsn
+        box.error.injection.set('ERRINJ_WAL_SYNC_DATA', true)
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        local results = {}
+        local fibers = {}
+        for i = 2, 4 do
+            local f = fiber.new(function()
+                results[i] = {pcall(s.insert, s, {i})}
+            end)
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        fiber.yield()
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+        for _, f in ipairs(fibers) do
+            f:join()
+        end
+        box.error.injection.set('ERRINJ_WAL_SYNC_DATA', false)
+        for i = 2, 4 do
+            t.assert_equals(results[i][1], false)
+        end
+        t.assert_equals(box.info.lsn, lsn)
+        t.assert_equals(s:select(), {{1}})
+        s:insert({5})
+        t.assert_equals(box.info.lsn, lsn + 1)
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.space.test:select(), {{1}, {5}})
+    end)
+end
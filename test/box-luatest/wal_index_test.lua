@@ -0,0 +1,106 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_each(function(cg)
+    cg.master = server:new({
+        alias = 'master',
+        box_cfg = {log_level = 'verbose', checkpoint_count = 1},
+    })
+    cg.master:start()
+    cg.master:exec(function()
+        box.schema.space.create('test'):create_index('pk')
+    end)
+    cg.replica = server:new({
+        alias = 'replica',
+        box_cfg = {replication = cg.master.net_box_uri},
+    })
+    cg.replica:start()
+end)
+
+g.after_each(function(cg)
+    cg.replica:drop()
+    cg.master:drop()
+end)
+
+-- Inserts rows of about 1 KB each, 10 rows per transaction. The data
+-- is random so that the WAL size doesn't depend on compression.
+local function fill(cg, first, count)
+    cg.master:exec(function(first, count)
+        local digest = require('digest')
+        local s = box.space.test
+        for i = first, first + count - 1, 10 do
+            box.begin()
+            for j = i, i + 9 do
+                s:insert({j, digest.urandom(1000)})
+            end
+            box.commit()
+        end
+    end, {first, count})
+end
+
+local function index_files(cg)
+    return fio.glob(fio.pathjoin(cg.master.workdir, '*.xlog.index'))
+end
+
+local function check_replica(cg, count)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function(count)
+        local s = box.space.test
+        t.assert_equals(s:len(), count)
+        for i = 1, count do
+            t.assert_equals(s:get(i)[1], i)
+        end
+    end, {count})
+end
+
+-- Checks that a relay skips the part of a WAL file already applied
+-- by the replica using the index.
+g.test_relay_seek = function(cg)
+    fill(cg, 1, 3000)
+    check_replica(cg, 3000)
+    t.assert_equals(#index_files(cg), 1)
+    cg.replica:stop()
+    fill(cg, 3001, 100)
+    cg.replica:start()
+    check_replica(cg, 3100)
+    t.assert(cg.master:grep_log('skipping %d+ bytes using the index'))
+end
+
+-- Checks that a broken index is ignored.
+g.test_broken_index = function(cg)
+    fill(cg, 1, 3000)
+    check_replica(cg, 3000)
+    cg.replica:stop()
+    fill(cg, 3001, 100)
+    local files = index_files(cg)
+    t.assert_equals(#files, 1)
+    local f = fio.open(files[1], {'O_RDWR'})
+    local content = f:read()
+    -- Make the entries point to the middle of tx blocks.
+    content = content:gsub('\n(%d+) ', function(offset)
+        return '\n' .. (tonumber(offset) + 1) .. ' '
+    end)
+    f:pwrite(content, 0)
+    f:close()
+    cg.replica:start()
+    check_replica(cg, 3100)
+    t.assert_not(cg.master:grep_log('skipping %d+ bytes using the index'))
+end
+
+-- Checks that the index is removed along with the WAL file.
+g.test_gc = function(cg)
+    fill(cg, 1, 3000)
+    check_replica(cg, 3000)
+    t.assert_equals(#index_files(cg), 1)
+    cg.master:exec(function()
+        box.snapshot()
+        box.space.test:insert({3001})
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    t.helpers.retrying({}, function()
+        t.assert_equals(index_files(cg), {})
+    end)
+end
@@ -0,0 +1,57 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.schema.space.create('test'):create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function spare_path(cg)
+    return fio.pathjoin(cg.server.workdir, 'spare.xlog.inprogress')
+end
+
+local function last_xlog(cg)
+    local files = fio.glob(fio.pathjoin(cg.server.workdir, '*.xlog'))
+    table.sort(files)
+    return files[#files]
+end
+
+-- Checks that a new WAL file is created from the spare one prepared
+-- in background on the previous rotation.
+g.test_spare = function(cg)
+    cg.server:exec(function()
+        box.space.test:insert({1})
+        box.snapshot()
+        box.space.test:insert({2})
+    end)
+    local stat
+    t.helpers.retrying({}, function()
+        stat = fio.stat(spare_path(cg))
+        t.assert_not_equals(stat, nil)
+    end)
+    cg.server:exec(function()
+        box.snapshot()
+        box.space.test:insert({3})
+    end)
+    t.assert_equals(fio.stat(last_xlog(cg)).inode, stat.inode)
+    -- The next spare file is prepared after rotation.
+    t.helpers.retrying({}, function()
+        local new_stat = fio.stat(spare_path(cg))
+        t.assert_not_equals(new_stat, nil)
+        t.assert_not_equals(new_stat.inode, stat.inode)
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.space.test:select(), {{1}, {2}, {3}})
+    end)
+end
@@ -169,6 +169,7 @@ g.test_defaults = function()
                 server = box.NULL,
             },
             nonblock = false,
+            async = false,
             level = 5,
             format = 'plain',
         },
@@ -180,6 +181,7 @@ g.test_defaults = function()
             },
             count = 2,
             snap_io_rate_limit = box.NULL,
+            snap_io_latency_target = box.NULL,
         },
         iproto = {
             listen = box.NULL,
@@ -189,6 +191,7 @@ g.test_defaults = function()
                 sharding = box.NULL,
             },
             threads = 1,
+            io_backend = 'auto',
             net_msg_max = 768,
             readahead = 16320,
         },
@@ -200,12 +203,14 @@ g.test_defaults = function()
             username = box.NULL,
             work_dir = box.NULL,
             pid_file = 'var/run/{{ instance_name }}/tarantool.pid',
+            cpu_affinity = box.NULL,
         },
         vinyl = {
             dir = 'var/lib/{{ instance_name }}',
             max_tuple_size = 1048576,
             bloom_fpr = 0.05,
             page_size = 8192,
+            page_cache = 0,
             range_size = box.NULL,
             run_count_per_level = 2,
             run_size_ratio = 3.5,
@@ -222,6 +227,7 @@ g.test_defaults = function()
             hot_standby = false,
             mode = box.NULL,
             txn_timeout = 3153600000,
+            expiration_rate = 10000,
             txn_isolation = 'best-effort',
             use_mvcc_engine = false,
         },
@@ -247,7 +253,9 @@ g.test_defaults = function()
             max_size = 268435456,
             dir_rescan_delay = 2,
             queue_max_size = 16777216,
+            commit_delay = 0,
             cleanup_delay = 14400,
+            compression_dictionary = false,
         },
         console = {
             enabled = true,
@@ -261,6 +269,8 @@ g.test_defaults = function()
             min_tuple_size = 16,
             max_tuple_size = 1048576,
             sort_threads = box.NULL,
+            use_hugepages = false,
+            snapshot_index_order = false,
         },
         config = {
             reload = 'auto',
@@ -144,6 +144,7 @@ g.test_process = function()
             username = 'two',
             work_dir = 'three',
             pid_file = 'four',
+            cpu_affinity = 'tx=0',
         },
     }
     instance_config:validate(iconfig)
@@ -157,6 +158,7 @@ g.test_process = function()
         username = box.NULL,
         work_dir = box.NULL,
         pid_file = 'var/run/{{ instance_name }}/tarantool.pid',
+        cpu_affinity = box.NULL,
     }
     local res = instance_config:apply_default({}).process
     t.assert_equals(res, exp)
@@ -226,6 +228,7 @@ g.test_log = function()
                 server = 'five',
             },
             nonblock = true,
+            async = true,
             level = 'debug',
             format = 'json',
             modules = {
@@ -264,6 +267,7 @@ g.test_log = function()
             server = box.NULL,
         },
         nonblock = false,
+        async = false,
         level = 5,
         format = 'plain',
     }
@@ -281,6 +285,7 @@ g.test_iproto = function()
                 sharding = 'four',
             },
             threads = 1,
+            io_backend = 'io_uring',
             net_msg_max = 1,
             readahead = 1,
         },
@@ -296,6 +301,7 @@ g.test_iproto = function()
             sharding = box.NULL,
         },
         threads = 1,
+        io_backend = 'auto',
         net_msg_max = 768,
         readahead = 16320,
     }
@@ -615,6 +621,7 @@ g.test_database = function()
             hot_standby = true,
             mode = 'ro',
             txn_timeout = 1,
+            expiration_rate = 100,
             txn_isolation = 'best-effort',
             use_mvcc_engine = true,
         },
@@ -661,6 +668,7 @@ g.test_database = function()
         hot_standby = false,
         mode = box.NULL,
         txn_timeout = 3153600000,
+        expiration_rate = 10000,
         txn_isolation = 'best-effort',
         use_mvcc_engine = false,
     }
@@ -694,6 +702,8 @@ g.test_memtx = function()
             min_tuple_size = 1,
             max_tuple_size = 1,
             sort_threads = 1,
+            use_hugepages = true,
+            snapshot_index_order = true,
         },
     }
     instance_config:validate(iconfig)
@@ -707,6 +717,8 @@ g.test_memtx = function()
         min_tuple_size = 16,
         max_tuple_size = 1048576,
         sort_threads = box.NULL,
+        use_hugepages = false,
+        snapshot_index_order = false,
     }
     local res = instance_config:apply_default({}).memtx
     t.assert_equals(res, exp)
@@ -719,6 +731,7 @@ g.test_vinyl = function()
             max_tuple_size = 1,
             bloom_fpr = 0.1,
             page_size = 123,
+            page_cache = 12,
             range_size = 321,
             run_count_per_level = 11,
             run_size_ratio = 1.15,
@@ -738,6 +751,7 @@ g.test_vinyl = function()
         max_tuple_size = 1048576,
         bloom_fpr = 0.05,
         page_size = 8192,
+        page_cache = 0,
         range_size = box.NULL,
         run_count_per_level = 2,
         run_size_ratio = 3.5,
@@ -761,7 +775,9 @@ g.test_wal = function()
             max_size = 1,
             dir_rescan_delay = 1,
             queue_max_size = 1,
+            commit_delay = 1,
             cleanup_delay = 1,
+            compression_dictionary = true,
         },
     }
     instance_config:validate(iconfig)
@@ -773,7 +789,9 @@ g.test_wal = function()
         max_size = 268435456,
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
+        commit_delay = 0,
         cleanup_delay = 14400,
+        compression_dictionary = false,
     }
     local res = instance_config:apply_default({}).wal
     t.assert_equals(res, exp)
@@ -788,6 +806,7 @@ g.test_wal_enterprise = function()
             max_size = 1,
             dir_rescan_delay = 1,
             queue_max_size = 1,
+            commit_delay = 1,
             cleanup_delay = 1,
             ext = {
                 old = true,
@@ -810,7 +829,9 @@ g.test_wal_enterprise = function()
         max_size = 268435456,
         dir_rescan_delay = 2,
         queue_max_size = 16777216,
+        commit_delay = 0,
         cleanup_delay = 14400,
+        compression_dictionary = false,
     }
     local res = instance_config:apply_default({}).wal
     t.assert_equals(res, exp)
@@ -826,6 +847,7 @@ g.test_snapshot = function()
             },
             count = 1,
             snap_io_rate_limit = 1,
+            snap_io_latency_target = 1,
         },
     }
     instance_config:validate(iconfig)
@@ -839,6 +861,7 @@ g.test_snapshot = function()
         },
         count = 2,
         snap_io_rate_limit = box.NULL,
+        snap_io_latency_target = box.NULL,
     }
     local res = instance_config:apply_default({}).snapshot
     t.assert_equals(res, exp)
@@ -0,0 +1,143 @@
+local t = require('luatest')
+local cluster = require('luatest.replica_set')
+local server = require('luatest.server')
+
+local g = t.group('linearizable-lease')
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.cluster = cluster:new({})
+    local box_cfg = {
+        replication = {
+            server.build_listen_uri('server_1', cg.cluster.id),
+            server.build_listen_uri('server_2', cg.cluster.id),
+            server.build_listen_uri('server_3', cg.cluster.id),
+        },
+        election_mode = 'voter',
+        election_fencing_mode = 'strict',
+        replication_timeout = 0.5,
+        memtx_use_mvcc_engine = true,
+    }
+    cg.servers = {}
+    for i = 1, 3 do
+        cg.servers[i] = cg.cluster:build_and_add_server({
+            alias = 'server_' .. i,
+            box_cfg = box_cfg,
+        })
+    end
+    cg.cluster:start()
+    cg.cluster:wait_for_fullmesh()
+    cg.leader = cg.servers[1]
+    cg.leader:exec(function()
+        box.cfg({election_mode = 'manual'})
+        box.ctl.promote()
+        box.ctl.wait_rw()
+        box.schema.space.create('sync', {is_sync = true})
+        box.space.sync:create_index('pk')
+        box.space.sync:insert({1})
+    end)
+    cg.servers[2]:wait_for_vclock_of(cg.leader)
+    cg.servers[3]:wait_for_vclock_of(cg.leader)
+end)
+
+g.after_all(function(cg)
+    if cg.cluster ~= nil then
+        cg.cluster:drop()
+    end
+end)
+
+g.after_each(function(cg)
+    cg.leader:exec(function()
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', false)
+        box.error.injection.set('ERRINJ_TXN_LIMBO_BEGIN_DELAY', false)
+        box.cfg({election_fencing_mode = 'strict'})
+    end)
+end)
+
+-- Check that the leader holding the lease serves linearizable reads
+-- without asking the replicas for their vclocks.
+g.test_lease = function(cg)
+    cg.leader:exec(function()
+        t.assert_equals(box.info.synchro.queue.owner, box.info.id)
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', true)
+        box.begin({txn_isolation = 'linearizable', timeout = 0.1})
+        t.assert_equals(box.space.sync:get(1), {1})
+        box.commit()
+    end)
+end
+
+-- Check that without strict fencing the leader doesn't rely on the lease.
+g.test_no_lease = function(cg)
+    cg.leader:exec(function()
+        box.cfg({election_fencing_mode = 'soft'})
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', true)
+        t.assert_error_covers({type = 'TimedOut'}, box.begin,
+                              {txn_isolation = 'linearizable', timeout = 0.1})
+    end)
+end
+
+-- Check that the lease ends when another instance takes over the limbo
+-- with a manual promote and is obtained again with a new promote.
+g.test_manual_promote = function(cg)
+    cg.servers[2]:exec(function()
+        box.cfg({election_mode = 'manual'})
+        box.ctl.promote()
+        box.ctl.wait_rw()
+    end)
+    cg.leader:exec(function(id)
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.synchro.queue.owner, id)
+        end)
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', true)
+        t.assert_error_covers({type = 'TimedOut'}, box.begin,
+                              {txn_isolation = 'linearizable', timeout = 0.1})
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', false)
+        box.ctl.promote()
+        box.ctl.wait_rw()
+    end, {cg.servers[2]:get_instance_id()})
+    cg.servers[2]:exec(function()
+        box.cfg({election_mode = 'voter'})
+    end)
+    cg.leader:exec(function()
+        t.assert_equals(box.info.synchro.queue.owner, box.info.id)
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', true)
+        box.begin({txn_isolation = 'linearizable', timeout = 0.1})
+        t.assert_equals(box.space.sync:get(1), {1})
+        box.commit()
+    end)
+end
+
+-- Check that the lease ends on a term bump even if the instance keeps
+-- the limbo and is elected again, until it writes PROMOTE in the new term.
+g.test_term_bump = function(cg)
+    cg.leader:exec(function()
+        local fiber = require('fiber')
+        local term = box.info.election.term
+        -- Resign, which keeps the limbo, and start an election in a new
+        -- term with the PROMOTE write delayed.
+        box.cfg({election_mode = 'voter'})
+        t.helpers.retrying({}, function()
+            t.assert_not_equals(box.info.election.state, 'leader')
+        end)
+        box.cfg({election_mode = 'manual'})
+        box.error.injection.set('ERRINJ_TXN_LIMBO_BEGIN_DELAY', true)
+        fiber.create(box.ctl.promote)
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.election.state, 'leader')
+        end)
+        t.assert_gt(box.info.election.term, term)
+        t.assert_equals(box.info.synchro.queue.owner, box.info.id)
+        t.assert_equals(box.info.synchro.queue.term, term)
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', true)
+        t.assert_error_covers({type = 'TimedOut'}, box.begin,
+                              {txn_isolation = 'linearizable', timeout = 0.1})
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', false)
+        box.error.injection.set('ERRINJ_TXN_LIMBO_BEGIN_DELAY', false)
+        box.ctl.wait_rw()
+        t.assert_equals(box.info.synchro.queue.term, box.info.election.term)
+        box.error.injection.set('ERRINJ_RELAY_FROM_TX_DELAY', true)
+        box.begin({txn_isolation = 'linearizable', timeout = 0.1})
+        t.assert_equals(box.space.sync:get(1), {1})
+        box.commit()
+    end)
+end
@@ -0,0 +1,59 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.master = server:new({alias = 'master'})
+    cg.master:start()
+    cg.master:exec(function()
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+    end)
+    cg.replica = server:new({
+        alias = 'replica',
+        box_cfg = {replication = {cg.master.net_box_uri}},
+    })
+    cg.replica:start()
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica:drop()
+    cg.master:drop()
+end)
+
+local function downstream(cg)
+    local id = cg.replica:get_instance_id()
+    return cg.master:exec(function(id)
+        return box.info.replication[id].downstream
+    end, {id})
+end
+
+-- Check that the relay sends many rows with a few socket writes and
+-- reports the write statistics in box.info.replication.
+g.test_batching = function(cg)
+    local before = downstream(cg)
+    t.assert_equals(before.status, 'follow')
+    t.assert_gt(before.bytes_sent, 0)
+    t.assert_gt(before.writes, 0)
+    cg.master:exec(function()
+        box.begin()
+        for i = 1, 1000 do
+            box.space.test:replace({i, string.rep('x', 100)})
+        end
+        box.commit()
+        for i = 1, 100 do
+            box.space.test:replace({i})
+        end
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.space.test:count(), 1000)
+        t.assert_equals(box.space.test:get(1), {1})
+        t.assert_equals(box.space.test:get(101), {101, string.rep('x', 100)})
+    end)
+    local after = downstream(cg)
+    t.assert_gt(after.bytes_sent - before.bytes_sent, 100 * 1000)
+    t.assert_lt(after.writes - before.writes, 200)
+end
@@ -0,0 +1,155 @@
+local t = require('luatest')
+local cluster = require('luatest.replica_set')
+local server = require('luatest.server')
+
+local g = t.group('synchro-confirm-batching')
+
+g.before_each(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.cluster = cluster:new({})
+    local box_cfg = {
+        replication = {
+            server.build_listen_uri('master', cg.cluster.id),
+            server.build_listen_uri('replica', cg.cluster.id),
+        },
+        replication_synchro_quorum = 2,
+        replication_synchro_timeout = 1000,
+        replication_timeout = 0.1,
+    }
+    cg.master = cg.cluster:build_and_add_server({
+        alias = 'master',
+        box_cfg = box_cfg,
+    })
+    cg.replica = cg.cluster:build_and_add_server({
+        alias = 'replica',
+        box_cfg = box_cfg,
+    })
+    cg.cluster:start()
+    cg.cluster:wait_for_fullmesh()
+    cg.master:exec(function()
+        box.ctl.promote()
+        box.ctl.wait_rw()
+        box.schema.space.create('sync', {is_sync = true})
+        box.space.sync:create_index('pk')
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_each(function(cg)
+    if cg.cluster ~= nil then
+        cg.cluster:drop()
+    end
+end)
+
+--
+-- Commits three synchronous transactions on the master so that the CONFIRM
+-- of the first one is blocked in WAL while the replica acks the other two.
+-- Returns the LSN of the first transaction.
+--
+local function block_first_confirm(cg)
+    return cg.master:exec(function(replica_id)
+        local fiber = require('fiber')
+        local s = box.space.sync
+        local function acked_lsn()
+            local vclock = box.info.replication[replica_id].downstream.vclock
+            return vclock[box.info.id] or 0
+        end
+        local fibers = {}
+        rawset(_G, 'test_fibers', fibers)
+        local function insert(key)
+            local f = fiber.new(s.insert, s, {key})
+            f:set_joinable(true)
+            table.insert(fibers, f)
+        end
+        -- Quorum 3 is unreachable so the transaction is acked by the replica
+        -- but isn't confirmed.
+        box.cfg({replication_synchro_quorum = 3})
+        local lsn = box.info.lsn + 1
+        insert(1)
+        t.helpers.retrying({}, function()
+            t.assert_equals(acked_lsn(), lsn)
+        end)
+        t.assert_equals(box.info.synchro.queue.len, 1)
+        -- Write two more transactions, but don't send them to the replica.
+        box.error.injection.set('ERRINJ_RELAY_SEND_DELAY', true)
+        insert(2)
+        insert(3)
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.info.lsn, lsn + 2)
+        end)
+        -- Lower the quorum to start writing the CONFIRM of the first
+        -- transaction and block the write.
+        box.error.injection.set('ERRINJ_WAL_DELAY', true)
+        local write_count = box.error.injection.get('ERRINJ_WAL_WRITE_COUNT')
+        fiber.create(box.cfg, {replication_synchro_quorum = 2})
+        t.helpers.retrying({}, function()
+            t.assert_gt(box.error.injection.get('ERRINJ_WAL_WRITE_COUNT'),
+                        write_count)
+        end)
+        -- Let the replica ack the other transactions.
+        box.error.injection.set('ERRINJ_RELAY_SEND_DELAY', false)
+        t.helpers.retrying({}, function()
+            t.assert_equals(acked_lsn(), lsn + 2)
+        end)
+        t.assert_equals(box.info.synchro.queue.len, 3)
+        return lsn
+    end, {cg.replica:get_instance_id()})
+end
+
+--
+-- Waits for the transactions started by block_first_confirm() and checks
+-- that they all were committed.
+--
+local function check_committed(cg)
+    cg.master:exec(function()
+        for i, f in ipairs(rawget(_G, 'test_fibers')) do
+            t.assert_equals({f:join()}, {true, {i}})
+        end
+        t.assert_equals(box.info.synchro.queue.len, 0)
+        t.assert_equals(box.space.sync:select(), {{1}, {2}, {3}})
+    end)
+    cg.replica:wait_for_vclock_of(cg.master)
+    cg.replica:exec(function()
+        t.assert_equals(box.info.synchro.queue.len, 0)
+        t.assert_equals(box.space.sync:select(), {{1}, {2}, {3}})
+    end)
+end
+
+-- Checks that quorums gathered while a CONFIRM is being written are
+-- confirmed by a single CONFIRM after the write.
+g.test_coalesce = function(cg)
+    local lsn = block_first_confirm(cg)
+    cg.master:exec(function()
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+    end)
+    check_committed(cg)
+    cg.master:exec(function(lsn)
+        -- Three transactions and two CONFIRMs.
+        t.assert_equals(box.info.lsn, lsn + 4)
+    end, {lsn})
+end
+
+-- Checks that a quorum dropped because the limbo changed hands while
+-- a CONFIRM was being written doesn't leave the transactions hanging.
+-- They are finished by the PROMOTE of the new limbo owner.
+g.test_promote = function(cg)
+    local lsn = block_first_confirm(cg)
+    cg.replica:exec(function()
+        box.cfg({replication_synchro_timeout = 1})
+        box.ctl.promote()
+        t.assert_equals(box.info.synchro.queue.owner, box.info.id)
+    end)
+    cg.master:exec(function()
+        -- The PROMOTE is blocked in WAL after the first CONFIRM.
+        t.helpers.retrying({}, function()
+            t.assert(box.info.synchro.queue.busy)
+        end)
+        box.error.injection.set('ERRINJ_WAL_DELAY', false)
+    end)
+    check_committed(cg)
+    cg.master:exec(function(lsn, replica_id)
+        t.assert_equals(box.info.synchro.queue.owner, replica_id)
+        -- Three transactions and one CONFIRM.
+        t.assert_equals(box.info.lsn, lsn + 3)
+    end, {lsn, cg.replica:get_instance_id()})
+end
@@ -0,0 +1,96 @@
+local net = require('net.box')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.master = server:new({alias = 'master'})
+    cg.master:start()
+    cg.master:exec(function()
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+        box.schema.user.grant('guest', 'read', 'space', 'test')
+    end)
+    cg.replica = server:new({
+        alias = 'replica',
+        box_cfg = {replication = {cg.master.net_box_uri}},
+    })
+    cg.replica:start()
+    cg.replica:wait_for_vclock_of(cg.master)
+end)
+
+g.after_all(function(cg)
+    cg.replica:drop()
+    cg.master:drop()
+end)
+
+g.before_each(function(cg)
+    cg.conn = net.connect(cg.replica.net_box_uri)
+end)
+
+g.after_each(function(cg)
+    cg.conn:close()
+    cg.replica:exec(function(uri)
+        box.cfg({replication = {uri}})
+    end, {cg.master.net_box_uri})
+end)
+
+local function insert(cg, id)
+    return cg.master:exec(function(id)
+        box.space.test:insert({id})
+        return box.info.vclock
+    end, {id})
+end
+
+local function pause_replication(cg)
+    cg.replica:exec(function()
+        box.cfg({replication = {}})
+    end)
+end
+
+-- Check that a request with wait_vclock is processed only after
+-- the replica receives the rows up to the given vclock.
+g.test_wait_vclock = function(cg)
+    local vclock = insert(cg, 1)
+    t.assert_equals(cg.conn.space.test:get(1, {wait_vclock = vclock}), {1})
+
+    pause_replication(cg)
+    vclock = insert(cg, 2)
+    t.assert_equals(cg.conn.space.test:get(2), nil)
+    local future = cg.conn.space.test:get(2, {
+        is_async = true, wait_vclock = vclock,
+    })
+    require('fiber').sleep(0.1)
+    t.assert_not(future:is_ready())
+    cg.replica:exec(function(uri)
+        box.cfg({replication = {uri}})
+    end, {cg.master.net_box_uri})
+    t.assert_equals(future:wait_result(), {2})
+end
+
+-- Check that a request fails if the replica doesn't reach the given
+-- vclock in time.
+g.test_timeout = function(cg)
+    pause_replication(cg)
+    local vclock = insert(cg, 3)
+    local space = cg.conn.space.test
+    t.assert_error_covers({type = 'TimedOut'}, space.get, space, 3,
+                          {wait_vclock = vclock, timeout = 0.1})
+    -- The connection is still usable.
+    t.assert_equals(cg.conn:ping(), true)
+end
+
+-- Check that an invalid wait_vclock is rejected by the client.
+g.test_invalid = function(cg)
+    local space = cg.conn.space.test
+    for _, vclock in ipairs({{foo = 1}, {[1] = -1}, {[1] = 1.5}, {[32] = 1}}) do
+        t.assert_error_covers({
+            type = 'IllegalParams',
+            message = 'wait_vclock must be a table mapping replica ids ' ..
+                      'to LSNs',
+        }, space.get, space, 1, {wait_vclock = vclock})
+    end
+    t.assert_error_msg_contains("should be of type table",
+                                space.get, space, 1, {wait_vclock = 1})
+end
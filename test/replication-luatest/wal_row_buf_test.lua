@@ -0,0 +1,89 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group('wal_row_buf', {
+    {buf_size = 16 * 1024 * 1024},
+    {buf_size = 4096},
+    {buf_size = 0},
+})
+
+g.before_all(function(cg)
+    cg.master = server:new({alias = 'master'})
+    cg.master:start()
+    cg.master:exec(function(buf_size)
+        require('internal.tweaks').wal_row_buf_size = buf_size
+        box.schema.space.create('test')
+        box.space.test:create_index('pk')
+        box.schema.space.create('loc', {is_local = true})
+        box.space.loc:create_index('pk')
+    end, {cg.params.buf_size})
+    cg.replicas = {}
+    for i = 1, 3 do
+        cg.replicas[i] = server:new({
+            alias = 'replica' .. i,
+            box_cfg = {
+                replication = {cg.master.net_box_uri},
+                replication_anon = i == 3,
+                read_only = i == 3,
+            },
+        })
+        cg.replicas[i]:start()
+    end
+end)
+
+g.after_all(function(cg)
+    for _, replica in ipairs(cg.replicas) do
+        replica:drop()
+    end
+    cg.master:drop()
+end)
+
+local function write(cg, first, last)
+    cg.master:exec(function(first, last)
+        for i = first, last do
+            box.begin()
+            box.space.test:replace({i, string.rep('x', i % 100)})
+            box.space.loc:replace({i})
+            box.space.test:replace({-i})
+            box.commit()
+        end
+    end, {first, last})
+end
+
+local function check(cg, replica)
+    replica:wait_for_vclock_of(cg.master)
+    local expected = cg.master:exec(function()
+        return box.space.test:select()
+    end)
+    replica:exec(function(expected)
+        t.assert_equals(box.space.test:select(), expected)
+        t.assert_equals(box.space.loc:count(), 0)
+    end, {expected})
+end
+
+-- Check that replicas receive rows both when they follow the master
+-- and when they lag behind it so that the rows they need aren't
+-- in the WAL row buffer anymore.
+g.test_replication = function(cg)
+    write(cg, 1, 1000)
+    for _, replica in ipairs(cg.replicas) do
+        check(cg, replica)
+    end
+    cg.replicas[1]:stop()
+    write(cg, 1001, 2000)
+    cg.master:exec(function() box.snapshot() end)
+    write(cg, 2001, 3000)
+    cg.replicas[1]:start()
+    for _, replica in ipairs(cg.replicas) do
+        check(cg, replica)
+    end
+    -- Rotate WAL while the replicas follow the master.
+    for i = 1, 3 do
+        write(cg, 3000 + i * 100, 3000 + i * 100 + 99)
+        cg.master:exec(function() box.snapshot() end)
+    end
+    for _, replica in ipairs(cg.replicas) do
+        check(cg, replica)
+        replica:assert_follows_upstream(1)
+    end
+end
@@ -0,0 +1,78 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+    end)
+end)
+
+-- Check that ANALYZE makes the planner pick the index by the
+-- selectivity of the searched value rather than by the default
+-- estimates.
+g.test_skewed_index = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT);]])
+        box.execute([[CREATE INDEX ta ON t(a);]])
+        box.execute([[CREATE INDEX tb ON t(b);]])
+        -- Most rows have a = 1 while each value of b occurs
+        -- 10 times, so an unique value of a is more selective.
+        box.begin()
+        for i = 1, 1000 do
+            box.space.t:insert({i, i <= 990 and 1 or i, i % 100})
+        end
+        box.commit()
+        local function plan(sql)
+            local rows = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+            local details = {}
+            for _, row in ipairs(rows) do
+                table.insert(details, row[4])
+            end
+            return table.concat(details, '\n')
+        end
+        local sql_frequent = [[SELECT id FROM t WHERE a = 1 AND b = 5;]]
+        local sql_rare = [[SELECT id FROM t WHERE a = 995 AND b = 95;]]
+        local _, err = box.execute([[ANALYZE t;]])
+        t.assert_equals(err, nil)
+        t.assert_str_contains(plan(sql_frequent), 'INDEX TB')
+        t.assert_str_contains(plan(sql_rare), 'INDEX TA')
+        local res = box.execute(sql_frequent)
+        t.assert_equals(#res.rows, 10)
+        res = box.execute(sql_rare)
+        t.assert_equals(res.rows, {{995}})
+        -- Range estimation uses the samples as well.
+        res = box.execute([[SELECT COUNT(*) FROM t WHERE a > 990;]])
+        t.assert_equals(res.rows, {{10}})
+        t.assert_str_contains(plan([[SELECT id FROM t WHERE a > 1;]]),
+                              'INDEX TA')
+    end)
+end
+
+-- Check ANALYZE of all tables and of missing or empty tables.
+g.test_analyze_all = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        local _, err = box.execute([[ANALYZE;]])
+        t.assert_equals(err, nil)
+        for i = 1, 100 do
+            box.space.t:insert({i, i % 3})
+        end
+        _, err = box.execute([[ANALYZE;]])
+        t.assert_equals(err, nil)
+        local res = box.execute([[SELECT COUNT(*) FROM t WHERE id < 50;]])
+        t.assert_equals(res.rows, {{49}})
+        _, err = box.execute([[ANALYZE no_such_table;]])
+        t.assert_equals(err.message, "Space 'NO_SUCH_TABLE' does not exist")
+    end)
+end
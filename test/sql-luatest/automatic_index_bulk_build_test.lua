@@ -0,0 +1,73 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t1 (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, b INT);]])
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.t1:truncate()
+        box.space.t2:truncate()
+    end)
+end)
+
+local JOIN = [[SELECT t1.id, t2.id FROM t1, t2 WHERE t1.a = t2.b
+               ORDER BY t1.id, t2.id;]]
+
+-- Check that an automatic index filled in the bulk build mode
+-- returns all matching rows including duplicate keys.
+g.test_join = function(cg)
+    cg.server:exec(function(join)
+        local plan = box.execute('EXPLAIN QUERY PLAN ' .. join).rows
+        local details = {}
+        for _, row in ipairs(plan) do
+            table.insert(details, row[4])
+        end
+        t.assert_str_contains(table.concat(details, '\n'), 'AUTOMATIC')
+        local t1 = box.space.t1
+        local t2 = box.space.t2
+        box.begin()
+        for i = 1, 1000 do
+            t1:insert({i, i % 100})
+            t2:insert({i, i % 7 == 0 and box.NULL or (1000 - i) % 50})
+        end
+        box.commit()
+        local expected = {}
+        for i = 1, 1000 do
+            for j = 1, 1000 do
+                if j % 7 ~= 0 and i % 100 == (1000 - j) % 50 then
+                    table.insert(expected, {i, j})
+                end
+            end
+        end
+        local res, err = box.execute(join)
+        t.assert_equals(err, nil)
+        t.assert_equals(#res.rows, #expected)
+        t.assert_equals(res.rows, expected)
+    end, {JOIN})
+end
+
+-- Check joins with an empty inner table.
+g.test_join_empty = function(cg)
+    cg.server:exec(function(join)
+        for i = 1, 10 do
+            box.space.t1:insert({i, i})
+        end
+        local res, err = box.execute(join)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {})
+    end, {JOIN})
+end
@@ -0,0 +1,60 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check comparison of integers and strings, which are compared
+-- without the generic type dispatch.
+g.test_int_and_str = function(cg)
+    cg.server:exec(function()
+        local cases = {
+            {'-1 < 1', true}, {'1 < -1', false}, {'-2 < -1', true},
+            {'-1 = -1', true}, {'18446744073709551615 > 1', true},
+            {'-9223372036854775808 < 0', true}, {'0 >= -1', true},
+            {'1 <> 1', false}, {'2 <= 2', true},
+            {"'a' < 'b'", true}, {"'ab' > 'a'", true}, {"'a' < 'ab'", true},
+            {"'' = ''", true}, {"'b' <= 'ab'", false}, {"'abc' <> 'abd'", true},
+            {"'A' = 'a' COLLATE \"unicode_ci\"", true},
+            {"'A' = 'a'", false}, {'1 < 1.5', true}, {'-1 = -1e0', true},
+        }
+        for _, case in ipairs(cases) do
+            local res, err = box.execute('SELECT ' .. case[1] .. ';')
+            t.assert_equals(err, nil, case[1])
+            t.assert_equals(res.rows, {{case[2]}}, case[1])
+        end
+        local _, err = box.execute([[SELECT 1 < 'a';]])
+        t.assert_equals(err.message,
+                        "Type mismatch: can not convert string('a') to number")
+    end)
+end
+
+-- Check comparisons with column values in a WHERE clause.
+g.test_where = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, s STRING);]])
+        for i = -50, 50 do
+            box.execute([[INSERT INTO t VALUES (?, ?, ?);]],
+                        {i, i % 10, tostring(i)})
+        end
+        local res = box.execute([[SELECT COUNT(*) FROM SEQSCAN t
+                                  WHERE a > ? AND id < ? AND s >= '3';]],
+                                {4, 10})
+        local count = 0
+        for i = -50, 9 do
+            if i % 10 > 4 and tostring(i) >= '3' then
+                count = count + 1
+            end
+        end
+        t.assert_equals(res.rows, {{count}})
+        box.execute([[DROP TABLE t;]])
+    end)
+end
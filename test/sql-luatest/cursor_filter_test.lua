@@ -0,0 +1,141 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+        box.execute([[DROP TABLE IF EXISTS s;]])
+    end)
+end)
+
+-- Check that comparisons of columns of a fully scanned table are
+-- pushed down into the cursor and give the same result.
+g.test_full_scan = function(cg)
+    cg.server:exec(function()
+        local function opcodes(sql)
+            local res = {}
+            for _, row in ipairs(box.execute('EXPLAIN ' .. sql).rows) do
+                res[row[2]] = true
+            end
+            return res
+        end
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, s STRING,
+                                      c SCALAR, d ANY);]])
+        box.begin()
+        for i = 1, 100 do
+            local a = i % 10 == 0 and box.NULL or i % 20
+            local c = i % 2 == 0 and i or tostring(i)
+            box.space.t:insert({i, a, tostring(i), c, i})
+        end
+        box.commit()
+        local sql = [[SELECT COUNT(*) FROM SEQSCAN t WHERE a > ? AND s <> ?;]]
+        t.assert(opcodes(sql).CursorFilter)
+        local res = box.execute(sql, {15, '19'})
+        t.assert_equals(res.rows, {{19}})
+        -- A comparison with NULL is never true.
+        res = box.execute(sql, {box.NULL, '19'})
+        t.assert_equals(res.rows, {{0}})
+        -- Values of different types are compared by the VDBE.
+        res = box.execute([[SELECT COUNT(*) FROM SEQSCAN t WHERE c > 50;]])
+        t.assert_equals(res.rows, {{75}})
+        local _, err = box.execute([[SELECT * FROM SEQSCAN t WHERE a > 'a';]])
+        t.assert_equals(err.message,
+                        "Type mismatch: can not convert string('a') to number")
+        -- ANY values can't be compared, so the error isn't hidden.
+        sql = [[SELECT * FROM SEQSCAN t WHERE d = 1;]]
+        t.assert_equals(opcodes(sql).CursorFilter, nil)
+        _, err = box.execute(sql)
+        t.assert_str_contains(err.message, 'comparable type')
+        -- Collations are taken into account.
+        box.execute([[CREATE TABLE s (id INT PRIMARY KEY,
+                                      s STRING COLLATE "unicode_ci");]])
+        box.execute([[INSERT INTO s VALUES (1, 'a'), (2, 'A'), (3, 'b');]])
+        res = box.execute([[SELECT id FROM SEQSCAN s WHERE s = 'a';]])
+        t.assert_equals(res.rows, {{1}, {2}})
+    end)
+end
+
+-- Check that a comparison with a column of an outer table is pushed
+-- down into the cursor of an inner table and is updated for each row
+-- of the outer table.
+g.test_join = function(cg)
+    cg.server:exec(function()
+        local function opcodes(sql)
+            local res = {}
+            for _, row in ipairs(box.execute('EXPLAIN ' .. sql).rows) do
+                res[row[2]] = true
+            end
+            return res
+        end
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE TABLE s (id INT PRIMARY KEY, b INT);]])
+        for i = 1, 20 do
+            box.execute([[INSERT INTO t VALUES (?, ?);]], {i, i % 5})
+            box.execute([[INSERT INTO s VALUES (?, ?);]], {i, i % 4})
+        end
+        local sql = [[SELECT t.id, s.id FROM SEQSCAN t, SEQSCAN s
+                      WHERE s.b < t.a ORDER BY t.id, s.id;]]
+        t.assert(opcodes(sql).CursorFilter)
+        local expected = {}
+        for i = 1, 20 do
+            for j = 1, 20 do
+                if j % 4 < i % 5 then
+                    table.insert(expected, {i, j})
+                end
+            end
+        end
+        t.assert_equals(box.execute(sql).rows, expected)
+    end)
+end
+
+-- Check that an ON term of a LEFT JOIN doesn't filter out the rows
+-- of the left table and that the filters are set again when the
+-- cursor is reopened for each row of an outer query.
+g.test_left_join_and_subquery = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE TABLE s (id INT PRIMARY KEY, b INT);]])
+        for i = 1, 10 do
+            box.execute([[INSERT INTO t VALUES (?, ?);]], {i, i % 3})
+            box.execute([[INSERT INTO s VALUES (?, ?);]], {i, i % 4})
+        end
+        local sql = [[SELECT t.id, s.id FROM SEQSCAN t
+                      LEFT JOIN SEQSCAN s ON t.a = 1 AND s.b = 2
+                      ORDER BY t.id, s.id;]]
+        local expected = {}
+        for i = 1, 10 do
+            if i % 3 == 1 then
+                for j = 1, 10 do
+                    if j % 4 == 2 then
+                        table.insert(expected, {i, j})
+                    end
+                end
+            else
+                table.insert(expected, {i, box.NULL})
+            end
+        end
+        t.assert_equals(box.execute(sql).rows, expected)
+
+        sql = [[SELECT id FROM SEQSCAN t WHERE EXISTS
+                (SELECT * FROM SEQSCAN s WHERE s.b = t.a AND s.id > 8)
+                ORDER BY id;]]
+        expected = {}
+        for i = 1, 10 do
+            if i % 3 == 9 % 4 or i % 3 == 10 % 4 then
+                table.insert(expected, {i})
+            end
+        end
+        t.assert_equals(box.execute(sql).rows, expected)
+    end)
+end
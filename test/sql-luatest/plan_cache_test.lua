@@ -0,0 +1,118 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        for i = 1, 10 do
+            box.execute([[INSERT INTO t VALUES (?, ?);]], {i, i * 10})
+        end
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        -- Flush the plan cache.
+        box.cfg({sql_cache_size = 0})
+        box.cfg({sql_cache_size = 5 * 1024 * 1024})
+    end)
+end)
+
+-- Check that a plan is reused by subsequent executions with
+-- different arguments.
+g.test_reuse = function(cg)
+    cg.server:exec(function()
+        local stat = box.info.sql().plan_cache
+        t.assert_equals(stat.stmt_count, 0)
+        t.assert_equals(stat.size, 0)
+        local sql = [[SELECT a FROM t WHERE id > ? ORDER BY id;]]
+        local res, err = box.execute(sql, {8})
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{90}, {100}})
+        res, err = box.execute(sql, {9})
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{100}})
+        t.assert_equals(res.metadata, {{name = 'A', type = 'integer'}})
+        local new_stat = box.info.sql().plan_cache
+        t.assert_equals(new_stat.stmt_count, 1)
+        t.assert_gt(new_stat.size, 0)
+        t.assert_equals(new_stat.misses - stat.misses, 1)
+        t.assert_equals(new_stat.hits - stat.hits, 1)
+        -- Statements that don't return rows aren't cached.
+        box.execute([[UPDATE t SET a = a WHERE id = 1;]])
+        t.assert_equals(box.info.sql().plan_cache.stmt_count, 1)
+        -- Invalid arguments don't break the cached statement.
+        _, err = box.execute(sql, {'abc'})
+        t.assert_not_equals(err, nil)
+        res, err = box.execute(sql, {9})
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{100}})
+    end)
+end
+
+-- Check that a cached plan is recompiled after a schema change.
+g.test_schema_change = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, a INT);]])
+        box.execute([[INSERT INTO t2 VALUES (1, 10);]])
+        local sql = [[SELECT * FROM t2;]]
+        local res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(#res.metadata, 2)
+        box.execute([[ALTER TABLE t2 ADD COLUMN b INT;]])
+        local stat = box.info.sql().plan_cache
+        res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(#res.metadata, 3)
+        t.assert_equals(res.metadata[3].name, 'B')
+        t.assert_equals(box.info.sql().plan_cache.misses - stat.misses, 1)
+        box.execute([[DROP TABLE t2;]])
+    end)
+end
+
+-- Check that a plan isn't reused with different session settings.
+g.test_session_settings = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT COUNT(*) FROM t WHERE a > 0;]]
+        local res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{10}})
+        box.execute([[SET SESSION "sql_seq_scan" = false;]])
+        _, err = box.execute(sql)
+        t.assert_not_equals(err, nil)
+        t.assert_str_contains(err.message, 'Scanning is not allowed')
+    end)
+end
+
+-- Check that the plan cache is limited by sql_cache_size.
+g.test_size_limit = function(cg)
+    cg.server:exec(function()
+        box.cfg({sql_cache_size = 0})
+        local res, err = box.execute([[SELECT a FROM t WHERE id = 1;]])
+        t.assert_equals(err, nil)
+        t.assert_equals(res.rows, {{10}})
+        t.assert_equals(box.info.sql().plan_cache.stmt_count, 0)
+        box.cfg({sql_cache_size = 5 * 1024 * 1024})
+        for i = 1, 100 do
+            box.execute(string.format([[SELECT a FROM t WHERE id = %d;]], i))
+        end
+        local stat = box.info.sql().plan_cache
+        t.assert_equals(stat.stmt_count, 100)
+        box.cfg({sql_cache_size = math.floor(stat.size / 2)})
+        stat = box.info.sql().plan_cache
+        t.assert_lt(stat.stmt_count, 100)
+        t.assert_le(stat.size, box.cfg.sql_cache_size)
+        -- The most recently used statements are kept.
+        box.execute([[SELECT a FROM t WHERE id = 100;]])
+        t.assert_equals(box.info.sql().plan_cache.hits - stat.hits, 1)
+    end)
+end
@@ -0,0 +1,87 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT);]])
+        box.begin()
+        for i = 1, 1000 do
+            box.space.t:insert({i, (i * 7919) % 101, i % 7})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that ORDER BY with LIMIT and OFFSET returns the same rows
+-- as a slice of the fully sorted result.
+g.test_limit_offset = function(cg)
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        local orders = {'a, id', 'a DESC, id', 'b, a DESC, id DESC',
+                        'b DESC, a, id'}
+        for _, order in ipairs(orders) do
+            local sql = 'SELECT id, a, b FROM t ORDER BY ' .. order
+            local all = box.execute(sql).rows
+            t.assert_equals(#all, 1000)
+            for _, limit in ipairs({1, 10, 999, 1000, 5000}) do
+                for _, offset in ipairs({0, 1, 500, 1000}) do
+                    local res = box.execute(sql .. ' LIMIT ? OFFSET ?',
+                                            {limit, offset}).rows
+                    local expected = {}
+                    for i = offset + 1, math.min(offset + limit, 1000) do
+                        table.insert(expected, all[i])
+                    end
+                    t.assert_equals(res, expected, order)
+                end
+            end
+        end
+    end)
+end
+
+-- Check that rows with equal sorting keys are returned in the
+-- order they were fetched, like without LIMIT.
+g.test_ties = function(cg)
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        local sql = 'SELECT id FROM t ORDER BY b'
+        local all = box.execute(sql).rows
+        local res = box.execute(sql .. ' LIMIT 300').rows
+        t.assert_equals(#res, 300)
+        for i = 1, 300 do
+            t.assert_equals(res[i], all[i])
+        end
+        res = box.execute(sql .. ' LIMIT 7 OFFSET 140').rows
+        for i = 1, 7 do
+            t.assert_equals(res[i], all[140 + i])
+        end
+    end)
+end
+
+-- Check ORDER BY with LIMIT when a prefix of the sorting key is
+-- provided by an index.
+g.test_partial_sort = function(cg)
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, a INT, b INT);]])
+        box.execute([[CREATE INDEX t2b ON t2(b);]])
+        box.execute([[INSERT INTO t2 SELECT * FROM t;]])
+        local sql = 'SELECT id, a FROM t2 ORDER BY b, a DESC, id'
+        local plan = box.execute('EXPLAIN QUERY PLAN ' .. sql).rows
+        t.assert_str_contains(plan[#plan][4], 'USE TEMP B-TREE FOR RIGHT')
+        local all = box.execute(sql).rows
+        local res = box.execute(sql .. ' LIMIT 250 OFFSET 25').rows
+        t.assert_equals(#res, 250)
+        for i = 1, 250 do
+            t.assert_equals(res[i], all[25 + i])
+        end
+        box.execute([[DROP TABLE t2;]])
+    end)
+end
@@ -0,0 +1,65 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that fields of consecutive rows are fetched correctly in
+-- any order, including fields beyond the 64th one.
+g.test_wide_row_field_access = function(cg)
+    cg.server:exec(function()
+        box.execute([[SET SESSION "sql_seq_scan" = true;]])
+        local format = {}
+        for i = 1, 100 do
+            format[i] = {'C' .. i, 'integer', is_nullable = i > 1}
+        end
+        local s = box.schema.space.create('T', {format = format})
+        s:create_index('pk')
+        for i = 1, 10 do
+            local tuple = {}
+            -- Rows of different length.
+            for j = 1, 60 + i * 4 do
+                tuple[j] = i * 1000 + j
+            end
+            s:insert(tuple)
+        end
+        local sql = [[SELECT c90, c2, c70, c64, c65, c1, c100, c63
+                      FROM t ORDER BY c1;]]
+        local res, err = box.execute(sql)
+        t.assert_equals(err, nil)
+        local expected = {}
+        for i = 1, 10 do
+            local row = {}
+            local len = 60 + i * 4
+            for k, j in ipairs({90, 2, 70, 64, 65, 1, 100, 63}) do
+                row[k] = j <= len and i * 1000 + j or nil
+            end
+            expected[i] = row
+        end
+        for i = 1, 10 do
+            for k = 1, 8 do
+                if expected[i][k] == nil then
+                    t.assert(res.rows[i][k] == nil)
+                else
+                    t.assert_equals(res.rows[i][k], expected[i][k])
+                end
+            end
+        end
+        res, err = box.execute([[SELECT SUM(c70) FROM t WHERE c66 > 0;]])
+        t.assert_equals(err, nil)
+        local sum = 0
+        for i = 3, 10 do
+            sum = sum + i * 1000 + 70
+        end
+        t.assert_equals(res.rows, {{sum}})
+        s:drop()
+    end)
+end
@@ -46,8 +46,8 @@ execute([[SET SESSION "sql_seq_scan" = true;]])
 
 -- Check default cache statistics.
 --
-box.info.sql()
-box.info:sql()
+box.info.sql().cache
+box.info:sql().cache
 
 -- Test local interface and basic capabilities of prepared statements.
 --
@@ -477,6 +477,58 @@ void test_disjunction()
 	footer();
 }
 
+static
+void test_count()
+{
+	header();
+
+	enum { BITSETS_SIZE = 4 };
+
+	struct tt_bitset **bitsets = bitsets_create(BITSETS_SIZE);
+
+	for (size_t i = 0; i < NUMS_SIZE; i++) {
+		tt_bitset_set(bitsets[i % BITSETS_SIZE], NUMS[i]);
+		if (i % 3 == 0)
+			tt_bitset_set(bitsets[(i + 1) % BITSETS_SIZE], NUMS[i]);
+	}
+
+	/* (b0 & ~b1) | b2 | (b3 & b0) */
+	struct tt_bitset_expr expr;
+	tt_bitset_expr_create(&expr, realloc);
+	fail_unless(tt_bitset_expr_add_conj(&expr) == 0);
+	fail_unless(tt_bitset_expr_add_param(&expr, 0, false) == 0);
+	fail_unless(tt_bitset_expr_add_param(&expr, 1, true) == 0);
+	fail_unless(tt_bitset_expr_add_conj(&expr) == 0);
+	fail_unless(tt_bitset_expr_add_param(&expr, 2, false) == 0);
+	fail_unless(tt_bitset_expr_add_conj(&expr) == 0);
+	fail_unless(tt_bitset_expr_add_param(&expr, 3, false) == 0);
+	fail_unless(tt_bitset_expr_add_param(&expr, 0, false) == 0);
+
+	struct tt_bitset_iterator it;
+	tt_bitset_iterator_create(&it, realloc);
+	fail_unless(
+		tt_bitset_iterator_init(&it, &expr, bitsets, BITSETS_SIZE) == 0);
+	tt_bitset_expr_destroy(&expr);
+
+	size_t count = 0;
+	while (tt_bitset_iterator_next(&it) != SIZE_MAX)
+		count++;
+	fail_unless(count > 0);
+	fail_unless(tt_bitset_iterator_count(&it) == count);
+
+	tt_bitset_iterator_rewind(&it);
+	size_t count2 = 0;
+	while (tt_bitset_iterator_next(&it) != SIZE_MAX)
+		count2++;
+	fail_unless(count2 == count);
+
+	tt_bitset_iterator_destroy(&it);
+
+	bitsets_destroy(bitsets, BITSETS_SIZE);
+
+	footer();
+}
+
 int main(void)
 {
 	setbuf(stdout, NULL);
@@ -492,6 +544,7 @@ int main(void)
 	test_not_empty();
 	test_not_last();
 	test_disjunction();
+	test_count();
 
 	return 0;
 }
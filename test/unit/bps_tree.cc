@@ -115,6 +115,17 @@ static int compare_key(const elem_t &a, long b)
 #define bps_tree_key_t uint32_t
 #define bps_tree_arg_t int
 #include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+
+/* same as approx, but with interpolation search in blocks */
+#define BPS_TREE_NAME interp
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE 16*1024
+#define BPS_TREE_KEY_INTERPOLATION_HINT(key, arg) ((uint64_t)(key))
+#define BPS_TREE_ELEM_INTERPOLATION_HINT(elem, arg) ((elem) >> 32)
+#include "salad/bps_tree.h"
 
 #define bps_insert_and_check(tree_name, tree, elem, replaced) \
 {\
@@ -838,6 +849,68 @@ approximate_count()
 	footer();
 }
 
+static void
+interpolation_search_test()
+{
+	header();
+	srand(0);
+
+	approx ref;
+	approx_create(&ref, 0, extent_alloc, extent_free, &extents_count,
+		      NULL);
+	interp tree;
+	interp_create(&tree, 0, extent_alloc, extent_free, &extents_count,
+		      NULL);
+
+	/*
+	 * A sequence with gaps and runs of equal keys, so that guesses
+	 * made from block boundaries are sometimes exact, sometimes
+	 * a bit off and sometimes totally wrong.
+	 */
+	const uint32_t max_key = 20000;
+	for (uint32_t key = 1; key < max_key; key++) {
+		int r = rand() % 10;
+		if (r == 0)
+			continue;
+		if (r == 1)
+			key += rand() % 500;
+		uint64_t dup_count = r == 2 ? rand() % 50 : 1;
+		for (uint64_t j = 0; j < dup_count; j++) {
+			uint64_t elem = ((uint64_t)key << 32) | j;
+			approx_insert(&ref, elem, NULL, NULL);
+			interp_insert(&tree, elem, NULL, NULL);
+		}
+	}
+	fail_unless(approx_size(&ref) == interp_size(&tree));
+
+	for (uint32_t key = 0; key < max_key + 1000; key++) {
+		bool ref_exact, exact;
+		approx_iterator ref_itr = approx_lower_bound(&ref, key,
+							     &ref_exact);
+		interp_iterator itr = interp_lower_bound(&tree, key, &exact);
+		fail_unless(exact == ref_exact);
+		fail_unless(approx_iterator_is_invalid(&ref_itr) ==
+			    interp_iterator_is_invalid(&itr));
+		if (!interp_iterator_is_invalid(&itr))
+			fail_unless(*approx_iterator_get_elem(&ref, &ref_itr) ==
+				    *interp_iterator_get_elem(&tree, &itr));
+
+		ref_itr = approx_upper_bound(&ref, key, &ref_exact);
+		itr = interp_upper_bound(&tree, key, &exact);
+		fail_unless(exact == ref_exact);
+		fail_unless(approx_iterator_is_invalid(&ref_itr) ==
+			    interp_iterator_is_invalid(&itr));
+		if (!interp_iterator_is_invalid(&itr))
+			fail_unless(*approx_iterator_get_elem(&ref, &ref_itr) ==
+				    *interp_iterator_get_elem(&tree, &itr));
+	}
+
+	interp_destroy(&tree);
+	approx_destroy(&ref);
+
+	footer();
+}
+
 static void
 insert_get_iterator()
 {
@@ -937,6 +1010,7 @@ main(void)
 	printing_test();
 	white_box_test();
 	approximate_count();
+	interpolation_search_test();
 	if (extents_count != 0)
 		fail("memory leak!", "true");
 	insert_get_iterator();
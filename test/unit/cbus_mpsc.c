@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "memory.h"
+#include "fiber.h"
+#include "cbus.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+/**
+ * Test the lock-free endpoint queue with many producers and a single
+ * consumer: every producer thread pushes a sequence of numbered messages
+ * to the main thread, which checks that nothing is lost and that the
+ * messages of each producer are delivered in the order they were sent.
+ */
+
+/** Number of producer threads in the many producers test. */
+enum { PRODUCER_COUNT = 8 };
+
+/** Number of messages sent by each producer in the many producers test. */
+enum { MSG_COUNT = 10000 };
+
+/** How long the consumer waits for messages before giving up. */
+static const double consume_timeout = 10.0;
+
+struct test_msg {
+	struct cmsg base;
+	/** Id of the producer that sent the message. */
+	int producer;
+	/** Sequence number of the message in the producer stream. */
+	int seq;
+};
+
+struct producer {
+	struct cord cord;
+	/** Producer id, an index in the producers array. */
+	int id;
+	/** Number of messages to send. */
+	int msg_count;
+	/** Messages to send. */
+	struct test_msg *msgs;
+};
+
+static struct producer producers[PRODUCER_COUNT];
+
+/** Sequence number of the next expected message of each producer. */
+static int next_seq[PRODUCER_COUNT];
+
+/** Number of messages delivered out of the producer order. */
+static int reordered_count;
+
+/** Total number of delivered messages. */
+static int received_count;
+
+static void
+test_msg_f(struct cmsg *base)
+{
+	struct test_msg *msg = (struct test_msg *)base;
+	if (msg->seq != next_seq[msg->producer])
+		reordered_count++;
+	next_seq[msg->producer] = msg->seq + 1;
+	received_count++;
+}
+
+static const struct cmsg_hop test_msg_route[] = {
+	{test_msg_f, NULL},
+};
+
+static int
+producer_f(va_list ap)
+{
+	struct producer *p = va_arg(ap, struct producer *);
+	struct cpipe pipe;
+	cpipe_create(&pipe, "consumer");
+	for (int i = 0; i < p->msg_count; i++) {
+		struct test_msg *msg = &p->msgs[i];
+		cmsg_init(&msg->base, test_msg_route);
+		msg->producer = p->id;
+		msg->seq = i;
+		cpipe_push(&pipe, &msg->base);
+		/* Flush the messages in batches of different sizes. */
+		if (i % (p->id + 1) == 0)
+			fiber_sleep(0);
+	}
+	/* Flushes the rest of the messages with the pipe shutdown message. */
+	cpipe_destroy(&pipe);
+	return 0;
+}
+
+static void
+producer_start(struct producer *p, int id, int msg_count)
+{
+	p->id = id;
+	p->msg_count = msg_count;
+	p->msgs = xcalloc(msg_count, sizeof(*p->msgs));
+	char name[FIBER_NAME_MAX];
+	snprintf(name, sizeof(name), "producer_%d", id);
+	fail_if(cord_costart(&p->cord, name, producer_f, p) != 0);
+}
+
+static void
+producer_join(struct producer *p)
+{
+	fail_if(cord_join(&p->cord) != 0);
+	free(p->msgs);
+}
+
+/**
+ * Delivers messages until @a count messages are received in total.
+ * Returns false if no message arrives for consume_timeout.
+ */
+static bool
+consume(struct cbus_endpoint *endpoint, int count)
+{
+	while (true) {
+		cbus_process(endpoint);
+		if (received_count >= count)
+			return true;
+		if (fiber_yield_timeout(consume_timeout))
+			return false;
+	}
+}
+
+/**
+ * A single message is the head of the queue and has no successor, so
+ * the consumer has to push the stub after it to take it.
+ */
+static void
+test_single_message(struct cbus_endpoint *endpoint)
+{
+	plan(4);
+	ok(cbus_endpoint_is_empty(endpoint), "queue is empty");
+	producer_start(&producers[0], 0, 1);
+	ok(consume(endpoint, 1), "message is delivered");
+	producer_join(&producers[0]);
+	/* Deliver the pipe shutdown message. */
+	cbus_process(endpoint);
+	ok(cbus_endpoint_is_empty(endpoint), "queue is empty");
+	is(next_seq[0], 1, "message is delivered once");
+	next_seq[0] = 0;
+	received_count = 0;
+	check_plan();
+}
+
+static void
+test_many_producers(struct cbus_endpoint *endpoint)
+{
+	plan(5);
+	for (int i = 0; i < PRODUCER_COUNT; i++)
+		producer_start(&producers[i], i, MSG_COUNT);
+	ok(consume(endpoint, PRODUCER_COUNT * MSG_COUNT),
+	   "messages are delivered");
+	for (int i = 0; i < PRODUCER_COUNT; i++)
+		producer_join(&producers[i]);
+	/* Deliver the pipe shutdown messages. */
+	cbus_process(endpoint);
+	ok(cbus_endpoint_is_empty(endpoint), "queue is empty");
+	is(received_count, PRODUCER_COUNT * MSG_COUNT,
+	   "no message is lost or duplicated");
+	int incomplete_count = 0;
+	for (int i = 0; i < PRODUCER_COUNT; i++) {
+		if (next_seq[i] != MSG_COUNT)
+			incomplete_count++;
+	}
+	is(incomplete_count, 0, "every producer stream is delivered");
+	is(reordered_count, 0, "every producer stream is delivered in order");
+	check_plan();
+}
+
+static int
+consumer_f(va_list ap)
+{
+	(void)ap;
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, "consumer", fiber_schedule_cb,
+			     fiber());
+	test_single_message(&endpoint);
+	test_many_producers(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+int
+main(void)
+{
+	header();
+	plan(2);
+
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	cbus_init();
+
+	struct fiber *consumer = fiber_new("consumer", consumer_f);
+	fail_if(consumer == NULL);
+	fiber_wakeup(consumer);
+	ev_run(loop(), 0);
+
+	cbus_free();
+	fiber_free();
+	memory_free();
+
+	int rc = check_plan();
+	footer();
+	return rc;
+}
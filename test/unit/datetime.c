@@ -164,6 +164,9 @@ tostring_datetime_test(void)
 		{"1970-01-01T00:00:00.123456789Z",  0, 123456789,    0},
 		{"1970-01-01T00:00:00.123456Z",     0, 123456000,    0},
 		{"1970-01-01T00:00:00.123Z",        0, 123000000,    0},
+		{"1970-01-01T00:00:00.000001Z",     0,      1000,    0},
+		{"1970-01-01T00:00:00.000000001Z",  0,         1,    0},
+		{"0001-01-01T00:00:00Z",  -62135596800,        0,    0},
 		{"1973-11-29T21:33:09Z",    123456789,         0,    0},
 		{"2013-10-28T17:51:56Z",   1382982716,         0,    0},
 		{"9999-12-31T23:59:59Z", 253402300799,         0,    0},
@@ -172,7 +175,7 @@ tostring_datetime_test(void)
 	};
 	size_t index;
 
-	plan(17);
+	plan(20);
 	for (index = 0; index < lengthof(tests); index++) {
 		struct datetime date = {
 			tests[index].secs,
@@ -347,6 +347,53 @@ test_to_int(void)
 	return check_plan();
 }
 
+static void
+test_compare_packed_one(const char *lhs, const char *rhs, bool is_fast)
+{
+	decimal_t lhs_dec, rhs_dec;
+	char lhs_buf[32], rhs_buf[32];
+	decimal_from_string(&lhs_dec, lhs);
+	decimal_from_string(&rhs_dec, rhs);
+	uint32_t lhs_len = decimal_pack(lhs_buf, &lhs_dec) - lhs_buf;
+	uint32_t rhs_len = decimal_pack(rhs_buf, &rhs_dec) - rhs_buf;
+	int result;
+	int rc = decimal_compare_packed(lhs_buf, lhs_len, rhs_buf, rhs_len,
+					&result);
+	if (is_fast) {
+		ok(rc == 0 && result == decimal_compare(&lhs_dec, &rhs_dec),
+		   "decimal_compare_packed(%s, %s)", lhs, rhs);
+	} else {
+		is(rc, -1, "decimal_compare_packed(%s, %s) needs unpacking",
+		   lhs, rhs);
+	}
+}
+
+static void
+test_compare_packed(void)
+{
+	plan(14);
+	header();
+
+	test_compare_packed_one("0", "0", true);
+	test_compare_packed_one("0", "-0", true);
+	test_compare_packed_one("1", "2", true);
+	test_compare_packed_one("10", "9", true);
+	test_compare_packed_one("-10", "-9", true);
+	test_compare_packed_one("-1", "1", true);
+	test_compare_packed_one("-1", "0", true);
+	test_compare_packed_one("100.25", "100.25", true);
+	test_compare_packed_one("100.25", "100.52", true);
+	test_compare_packed_one("-100.25", "-100.52", true);
+	test_compare_packed_one("12345678901234567890.12", "9.99", true);
+	test_compare_packed_one("99999999999999999999999999999999999999",
+				"-99999999999999999999999999999999999999", true);
+	test_compare_packed_one("1.5", "1.50", false);
+	test_compare_packed_one("1e10", "1", false);
+
+	footer();
+	check_plan();
+}
+
 static int
 mp_fprint_ext_test(FILE *file, const char **data, int depth)
 {
@@ -410,7 +457,7 @@ test_mp_print(void)
 int
 main(void)
 {
-	plan(312);
+	plan(313);
 
 	dectest(314, 271, uint64, uint64_t);
 	dectest(65535, 23456, uint64, uint64_t);
@@ -476,6 +523,7 @@ main(void)
 
 	test_mp_decimal();
 	test_mp_print();
+	test_compare_packed();
 
 	test_strtodec("15.e", 'e', success);
 	test_strtodec("15.e+", 'e', success);
@@ -2,6 +2,7 @@
 #include "fiber.h"
 #include "trivia/util.h"
 #include "errinj.h"
+#include "tweaks.h"
 
 #define UNIT_TAP_COMPATIBLE 1
 #include "unit.h"
@@ -35,11 +36,22 @@ main_f(va_list ap)
 
 	header();
 #ifdef NDEBUG
-	plan(1);
+	plan(4);
 #else
-	plan(11);
+	plan(14);
 #endif
 
+	/*
+	 * Disable caching of fibers with a custom stack size so that
+	 * they are deleted on exit. It's checked in the end.
+	 */
+	struct tweak *cache_size_tweak = tweak_find("fiber_stack_cache_size");
+	assert(cache_size_tweak != NULL);
+	struct tweak_value cache_size;
+	tweak_get(cache_size_tweak, &cache_size);
+	struct tweak_value no_cache = {.type = TWEAK_VALUE_INT, .ival = 0};
+	tweak_set(cache_size_tweak, &no_cache);
+
 	/*
 	 * gh-9026. Stack size crafted to be close to 64k so we should
 	 * hit red zone around stack when writing watermark if bug is not
@@ -137,6 +149,37 @@ main_f(va_list ap)
 	ok(fiber_count_total() == fiber_count, "fiber is deleted");
 #endif /* ifndef NDEBUG */
 
+	/*
+	 * Check that dead fibers with a custom stack size are reused
+	 * by fibers with the same stack size.
+	 */
+	tweak_set(cache_size_tweak, &cache_size);
+	fiber_attr_delete(fiber_attr);
+	fiber_attr = fiber_attr_new();
+	fiber_attr_setstacksize(fiber_attr, default_attr.stack_size * 2);
+	int64_t reuse_count = cord()->custom_stack_reuse_count;
+	fiber = fiber_new_ex("test_cache", fiber_attr, noop_f);
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber);
+	fiber_join(fiber);
+	fiber_count = fiber_count_total();
+	fiber = fiber_new_ex("test_cache", fiber_attr, noop_f);
+	ok(fiber_count_total() == fiber_count &&
+	   cord()->custom_stack_reuse_count == reuse_count + 1,
+	   "custom stack: reused");
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber);
+	fiber_join(fiber);
+	fiber_attr_setstacksize(fiber_attr, default_attr.stack_size * 4);
+	fiber = fiber_new_ex("test_cache", fiber_attr, noop_f);
+	ok(fiber_count_total() == fiber_count + 1 &&
+	   cord()->custom_stack_reuse_count == reuse_count + 1,
+	   "custom stack: other size not reused");
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber);
+	fiber_join(fiber);
+	ok(cord()->dead_custom_stack_size > 0, "custom stack: cached");
+
 	fiber_attr_delete(fiber_attr);
 	ev_break(loop(), EVBREAK_ALL);
 
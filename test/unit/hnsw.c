@@ -0,0 +1,229 @@
+#include "salad/hnsw.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trivia/util.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+enum {
+	DIMENSION = 24,
+	VECTOR_COUNT = 2000,
+	QUERY_COUNT = 100,
+	K = 10,
+	EF = 64,
+};
+
+static float vectors[VECTOR_COUNT][DIMENSION];
+static bool is_deleted[VECTOR_COUNT];
+
+static void
+random_vector(float *v)
+{
+	for (int i = 0; i < DIMENSION; i++)
+		v[i] = (float)rand() / RAND_MAX * 2 - 1;
+}
+
+static float
+distance(enum hnsw_metric metric, const float *a, const float *b)
+{
+	float sum = 0, aa = 0, bb = 0;
+	for (int i = 0; i < DIMENSION; i++) {
+		switch (metric) {
+		case HNSW_METRIC_L2:
+			sum += (a[i] - b[i]) * (a[i] - b[i]);
+			break;
+		case HNSW_METRIC_L1:
+			sum += fabsf(a[i] - b[i]);
+			break;
+		default:
+			sum += a[i] * b[i];
+			aa += a[i] * a[i];
+			bb += b[i] * b[i];
+			break;
+		}
+	}
+	switch (metric) {
+	case HNSW_METRIC_L2:
+		return sqrtf(sum);
+	case HNSW_METRIC_COSINE:
+		return 1 - sum / sqrtf(aa * bb);
+	case HNSW_METRIC_DOT:
+		return -sum;
+	default:
+		return sum;
+	}
+}
+
+/** Find the distance of the k-th nearest live vector by brute force. */
+static float
+kth_distance(enum hnsw_metric metric, const float *query, int k)
+{
+	float best[K];
+	int count = 0;
+	for (int i = 0; i < VECTOR_COUNT; i++) {
+		if (is_deleted[i])
+			continue;
+		float d = distance(metric, query, vectors[i]);
+		int j = count < k ? count++ : k;
+		if (j == k && d >= best[k - 1])
+			continue;
+		if (j == k)
+			j--;
+		while (j > 0 && best[j - 1] > d) {
+			best[j] = best[j - 1];
+			j--;
+		}
+		best[j] = d;
+	}
+	return best[count - 1];
+}
+
+/**
+ * Run random queries and return the fraction of the found vectors
+ * that are among the true K nearest ones. Fail if a deleted vector
+ * is found or the result isn't sorted.
+ */
+static double
+recall(struct hnsw *hnsw, enum hnsw_metric metric, bool *is_valid)
+{
+	struct hnsw_neighbor result[K];
+	int hits = 0;
+	*is_valid = true;
+	for (int q = 0; q < QUERY_COUNT; q++) {
+		float query[DIMENSION];
+		random_vector(query);
+		uint32_t count = hnsw_search(hnsw, query, K, EF, result);
+		if (count != K)
+			*is_valid = false;
+		float threshold = kth_distance(metric, query, K);
+		for (uint32_t i = 0; i < count; i++) {
+			float (*v)[DIMENSION] = (float (*)[DIMENSION])
+				result[i].data;
+			if (is_deleted[v - vectors])
+				*is_valid = false;
+			if (i > 0 && result[i].distance <
+				     result[i - 1].distance)
+				*is_valid = false;
+			if (distance(metric, query, *v) <=
+			    threshold + fabsf(threshold) * 1e-5 + 1e-6)
+				hits++;
+		}
+	}
+	return (double)hits / (QUERY_COUNT * K);
+}
+
+static void
+test_search(enum hnsw_metric metric)
+{
+	plan(3);
+	header();
+
+	struct hnsw hnsw;
+	fail_if(hnsw_create(&hnsw, DIMENSION, metric, HNSW_DEFAULT_M,
+			    HNSW_DEFAULT_EF_CONSTRUCTION) != 0);
+	for (int i = 0; i < VECTOR_COUNT; i++) {
+		random_vector(vectors[i]);
+		is_deleted[i] = false;
+		fail_if(hnsw_insert(&hnsw, vectors[i], vectors[i]) != 0);
+	}
+	is(hnsw_size(&hnsw), VECTOR_COUNT, "size");
+	bool is_valid;
+	double r = recall(&hnsw, metric, &is_valid);
+	ok(is_valid, "search result is valid");
+	ok(r > 0.9, "recall of metric %d is good", (int)metric);
+	hnsw_destroy(&hnsw);
+
+	footer();
+	check_plan();
+}
+
+static void
+test_delete(void)
+{
+	plan(11);
+	header();
+
+	struct hnsw hnsw;
+	fail_if(hnsw_create(&hnsw, DIMENSION, HNSW_METRIC_L2, HNSW_DEFAULT_M,
+			    HNSW_DEFAULT_EF_CONSTRUCTION) != 0);
+	for (int i = 0; i < VECTOR_COUNT; i++) {
+		random_vector(vectors[i]);
+		is_deleted[i] = false;
+		fail_if(hnsw_insert(&hnsw, vectors[i], vectors[i]) != 0);
+	}
+	/* Delete a third of the vectors, not enough to free them. */
+	bool found = true;
+	for (int i = 0; i < VECTOR_COUNT; i += 3) {
+		is_deleted[i] = true;
+		found = found && hnsw_delete(&hnsw, vectors[i]);
+	}
+	ok(found, "deleted vectors are found");
+	ok(!hnsw_delete(&hnsw, vectors[0]), "deleted vector can't be found");
+	is(hnsw_size(&hnsw), VECTOR_COUNT - (VECTOR_COUNT + 2) / 3, "size");
+	bool is_valid;
+	double r = recall(&hnsw, HNSW_METRIC_L2, &is_valid);
+	ok(is_valid && r > 0.9, "search after delete");
+
+	/* Delete more to free the deleted vectors. */
+	for (int i = 1; i < VECTOR_COUNT; i += 3) {
+		is_deleted[i] = true;
+		hnsw_delete(&hnsw, vectors[i]);
+	}
+	r = recall(&hnsw, HNSW_METRIC_L2, &is_valid);
+	ok(is_valid && r > 0.9, "search after purge");
+
+	/* Reinsert the deleted vectors. */
+	for (int i = 0; i < VECTOR_COUNT; i++) {
+		if (!is_deleted[i])
+			continue;
+		is_deleted[i] = false;
+		fail_if(hnsw_insert(&hnsw, vectors[i], vectors[i]) != 0);
+	}
+	is(hnsw_size(&hnsw), VECTOR_COUNT, "size after reinsert");
+	r = recall(&hnsw, HNSW_METRIC_L2, &is_valid);
+	ok(is_valid && r > 0.9, "search after reinsert");
+
+	uint32_t pos = 0;
+	int count = 0;
+	while (hnsw_next(&hnsw, &pos) != NULL)
+		count++;
+	is(count, VECTOR_COUNT, "iteration");
+
+	/* Delete everything. */
+	for (int i = 0; i < VECTOR_COUNT; i++) {
+		is_deleted[i] = true;
+		hnsw_delete(&hnsw, vectors[i]);
+	}
+	is(hnsw_size(&hnsw), 0, "empty");
+	struct hnsw_neighbor result[K];
+	is(hnsw_search(&hnsw, vectors[0], K, EF, result), 0,
+	   "search in empty graph");
+	fail_if(hnsw_insert(&hnsw, vectors[0], vectors[0]) != 0);
+	ok(hnsw_search(&hnsw, vectors[1], K, EF, result) == 1 &&
+	   result[0].data == vectors[0], "search after reinsert into empty");
+	hnsw_destroy(&hnsw);
+
+	footer();
+	check_plan();
+}
+
+int
+main(void)
+{
+	plan(5);
+	header();
+
+	srand(42);
+	test_search(HNSW_METRIC_L2);
+	test_search(HNSW_METRIC_L1);
+	test_search(HNSW_METRIC_COSINE);
+	test_search(HNSW_METRIC_DOT);
+	test_delete();
+
+	footer();
+	return check_plan();
+}
@@ -1367,10 +1367,83 @@ test_tuple_compare_sequential_no_optional_parts_unique(bool ascending_key,
 	check_plan();
 }
 
+/**
+ * Checks precompiled comparators of integer and double key parts
+ * on values of different MsgPack types.
+ */
+static void
+test_tuple_compare_numeric(void)
+{
+	plan(16);
+	header();
+
+	struct key_def *def_int = test_key_def_new(
+		"[{%s%u%s%s}]", "field", 0, "type", "integer");
+	struct key_def *def_double = test_key_def_new(
+		"[{%s%u%s%s}]", "field", 0, "type", "double");
+	struct key_def *def_uint_int = test_key_def_new(
+		"[{%s%u%s%s}{%s%u%s%s}]", "field", 0, "type", "unsigned",
+		"field", 1, "type", "integer");
+	struct key_def *def_str_double = test_key_def_new(
+		"[{%s%u%s%s}{%s%u%s%s}]", "field", 0, "type", "string",
+		"field", 1, "type", "double");
+	struct {
+		struct key_def *def;
+		struct tuple *a;
+		struct tuple *b;
+		int expected;
+	} cases[] = {
+		{def_int, test_tuple_new("[%d]", -5),
+		 test_tuple_new("[%u]", 3), -1},
+		{def_int, test_tuple_new("[%u]", 3),
+		 test_tuple_new("[%d]", -5), 1},
+		{def_int, test_tuple_new("[%d]", -5),
+		 test_tuple_new("[%d]", -7), 1},
+		{def_int, test_tuple_new("[%u]", 10),
+		 test_tuple_new("[%u]", 10), 0},
+		{def_double, test_tuple_new("[%lf]", -1.5),
+		 test_tuple_new("[%lf]", 0.5), -1},
+		{def_double, test_tuple_new("[%lf]", 2.5),
+		 test_tuple_new("[%f]", 2.5f), 0},
+		{def_uint_int, test_tuple_new("[%u%d]", 1, -1),
+		 test_tuple_new("[%u%u]", 1, 1), -1},
+		{def_str_double, test_tuple_new("[%s%lf]", "a", 3.0),
+		 test_tuple_new("[%s%lf]", "a", 2.0), 1},
+	};
+	for (size_t i = 0; i < lengthof(cases); i++) {
+		struct key_def *def = cases[i].def;
+		struct tuple *a = cases[i].a;
+		struct tuple *b = cases[i].b;
+		int rc = tuple_compare(a, HINT_NONE, b, HINT_NONE, def);
+		rc = rc < 0 ? -1 : rc > 0;
+		is(rc, cases[i].expected, "tuple_compare(%s, %s)",
+		   tuple_str(a), tuple_str(b));
+		size_t region_svp = region_used(&fiber()->gc);
+		const char *key = tuple_extract_key(b, def, MULTIKEY_NONE,
+						    NULL);
+		uint32_t part_count = mp_decode_array(&key);
+		rc = tuple_compare_with_key(a, HINT_NONE, key, part_count,
+					    HINT_NONE, def);
+		rc = rc < 0 ? -1 : rc > 0;
+		is(rc, cases[i].expected, "tuple_compare_with_key(%s, %s)",
+		   tuple_str(a), tuple_str(b));
+		region_truncate(&fiber()->gc, region_svp);
+		tuple_delete(a);
+		tuple_delete(b);
+	}
+	key_def_delete(def_int);
+	key_def_delete(def_double);
+	key_def_delete(def_uint_int);
+	key_def_delete(def_str_double);
+
+	footer();
+	check_plan();
+}
+
 static int
 test_main(void)
 {
-	plan(50);
+	plan(51);
 	header();
 
 	test_func_compare();
@@ -1423,6 +1496,7 @@ test_main(void)
 	test_key_compare_singlepart(true, false);
 	test_key_compare_singlepart(false, true);
 	test_key_compare_singlepart(false, false);
+	test_tuple_compare_numeric();
 
 	footer();
 	return check_plan();
@@ -0,0 +1,123 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+struct test_source {
+	/** Sorted array of values. */
+	uint32_t *values;
+	/** Number of values. */
+	uint32_t count;
+	/** Current position. */
+	uint32_t pos;
+};
+
+static bool
+test_source_less(const struct test_source *a, const struct test_source *b)
+{
+	return a->values[a->pos] < b->values[b->pos];
+}
+
+#define LOSER_TREE_NAME test_tree
+#define LOSER_TREE_LESS(tree, a, b) test_source_less(a, b)
+#define loser_tree_value_t struct test_source
+#include "salad/loser_tree.h"
+
+static int
+cmp_uint32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+	return x < y ? -1 : x > y;
+}
+
+static void
+test_empty(void)
+{
+	plan(2);
+	header();
+
+	struct loser_tree tree;
+	test_tree_create(&tree);
+	ok(test_tree_top(&tree) == NULL, "top of an empty tree");
+	is(test_tree_build(&tree, NULL, 0), 0, "build an empty tree");
+	test_tree_destroy(&tree);
+
+	footer();
+	check_plan();
+}
+
+/**
+ * Merge @a source_count sorted sequences of random length with
+ * the tree and check that the result is sorted and nothing is lost.
+ */
+static void
+test_merge(uint32_t source_count)
+{
+	plan(3);
+	header();
+
+	struct test_source *sources = calloc(source_count, sizeof(*sources));
+	struct test_source **ptrs = calloc(source_count, sizeof(*ptrs));
+	uint32_t total_count = 0;
+	for (uint32_t i = 0; i < source_count; i++) {
+		struct test_source *src = &sources[i];
+		src->count = 1 + rand() % 100;
+		src->values = calloc(src->count, sizeof(*src->values));
+		for (uint32_t j = 0; j < src->count; j++)
+			src->values[j] = rand() % 1000;
+		qsort(src->values, src->count, sizeof(*src->values),
+		      cmp_uint32);
+		ptrs[i] = src;
+		total_count += src->count;
+	}
+
+	struct loser_tree tree;
+	test_tree_create(&tree);
+	is(test_tree_build(&tree, ptrs, source_count), 0, "build");
+
+	uint32_t count = 0;
+	uint32_t prev = 0;
+	bool is_sorted = true;
+	struct test_source *src;
+	while ((src = test_tree_top(&tree)) != NULL) {
+		uint32_t value = src->values[src->pos];
+		if (value < prev)
+			is_sorted = false;
+		prev = value;
+		count++;
+		if (++src->pos < src->count)
+			test_tree_update_top(&tree);
+		else
+			test_tree_pop(&tree);
+	}
+	ok(is_sorted, "merged values are sorted");
+	is(count, total_count, "all values are merged");
+
+	test_tree_destroy(&tree);
+	for (uint32_t i = 0; i < source_count; i++)
+		free(sources[i].values);
+	free(ptrs);
+	free(sources);
+
+	footer();
+	check_plan();
+}
+
+int
+main(void)
+{
+	plan(7);
+	srand(time(NULL));
+	test_empty();
+	test_merge(1);
+	test_merge(2);
+	test_merge(3);
+	test_merge(7);
+	test_merge(16);
+	test_merge(100);
+	return check_plan();
+}
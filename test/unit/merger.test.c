@@ -63,6 +63,39 @@ merge_source_array_new(bool even)
 	return &source->base;
 }
 
+/**
+ * Create an array source of tuples [values[0]], [values[1]], ...
+ */
+static struct merge_source *
+merge_source_array_new_uint(const uint64_t *values, uint32_t count)
+{
+	static struct merge_source_vtab merge_source_array_vtab = {
+		.destroy = merge_source_array_destroy,
+		.next = merge_source_array_next,
+	};
+
+	struct merge_source_array *source = malloc(
+		sizeof(struct merge_source_array));
+	assert(source != NULL);
+
+	merge_source_create(&source->base, &merge_source_array_vtab);
+
+	source->tuples = malloc(sizeof(struct tuple *) * count);
+	assert(source->tuples != NULL || count == 0);
+	struct tuple_format *format = tuple_format_runtime;
+	for (uint32_t i = 0; i < count; ++i) {
+		char data[16];
+		char *end = mp_encode_array(data, 1);
+		end = mp_encode_uint(end, values[i]);
+		source->tuples[i] = tuple_new(format, data, end);
+		tuple_ref(source->tuples[i]);
+	}
+	source->tuple_count = count;
+	source->cur = 0;
+
+	return &source->base;
+}
+
 /* Virtual methods */
 
 static void
@@ -246,10 +279,70 @@ test_merger(struct tuple_format *format)
 	return check_plan();
 }
 
+/**
+ * Check a merger of a number of sources that isn't a power of two,
+ * including empty ones.
+ */
+int
+test_merger_many_sources(bool reverse)
+{
+	plan(3);
+	header();
+
+	enum { source_count = 7, values_per_source = 5 };
+	struct merge_source *sources[source_count];
+	for (uint32_t i = 0; i < source_count; ++i) {
+		/* Source 3 is empty. */
+		uint32_t count = i == 3 ? 0 : values_per_source;
+		uint64_t values[values_per_source];
+		for (uint32_t j = 0; j < count; ++j) {
+			uint32_t k = reverse ? count - j - 1 : j;
+			values[j] = k * source_count + i;
+		}
+		sources[i] = merge_source_array_new_uint(values, count);
+	}
+
+	struct key_def *key_def = key_def_new(&key_part_unsigned, 1, 0);
+	struct merge_source *merger = merger_new(key_def, sources,
+						 source_count, reverse);
+	key_def_delete(key_def);
+
+	uint32_t tuple_count = 0;
+	bool is_sorted = true;
+	uint64_t prev = 0;
+	struct tuple *tuple = NULL;
+	while (true) {
+		int rc = merge_source_next(merger, NULL, &tuple);
+		(void) rc;
+		assert(rc == 0);
+		if (tuple == NULL)
+			break;
+		const char *field = tuple_field(tuple, 0);
+		uint64_t value = mp_decode_uint(&field);
+		if (tuple_count > 0 && (reverse ? value > prev : value < prev))
+			is_sorted = false;
+		prev = value;
+		++tuple_count;
+		tuple_unref(tuple);
+	}
+	is(tuple_count, (source_count - 1) * values_per_source,
+	   "merger of many sources: tuple count");
+	ok(is_sorted, "merger of many sources: order");
+	int rc = merge_source_next(merger, NULL, &tuple);
+	ok(rc == 0 && tuple == NULL, "merger of many sources: is empty");
+
+	merge_source_unref(merger);
+	for (uint32_t i = 0; i < source_count; ++i)
+		merge_source_unref(sources[i]);
+
+	footer();
+	return check_plan();
+}
+
 int
 test_basic()
 {
-	plan(4);
+	plan(6);
 	header();
 
 	struct key_def *key_def = key_def_new(&key_part_integer, 1, 0);
@@ -260,6 +353,8 @@ test_basic()
 	test_array_source(format);
 	test_merger(NULL);
 	test_merger(format);
+	test_merger_many_sources(false);
+	test_merger_many_sources(true);
 
 	key_def_delete(key_def);
 	tuple_format_unref(format);
@@ -299,12 +299,84 @@ neighbor_test()
 	footer();
 }
 
+static void
+bulk_load_test()
+{
+	header();
+
+	const size_t test_count = 10000;
+	struct rtree_rect *arr = (struct rtree_rect *)
+		calloc(test_count, sizeof(*arr));
+	for (size_t i = 0; i < test_count; i++) {
+		coord_t x = i % 100, y = i / 100;
+		rtree_set2d(&arr[i], x, y, x + 0.5, y + 0.5);
+	}
+
+	for (size_t count = 0; count <= test_count;
+	     count = count < 100 ? count + 1 : count * 10) {
+		struct rtree tree;
+		rtree_init(&tree, 2, RTREE_EUCLID, extent_size,
+			   extent_alloc, extent_free, &page_count, NULL);
+		size_t entry_size = rtree_bulk_entry_size(&tree);
+		char *entries = (char *)malloc(count * entry_size + 1);
+		for (size_t i = 0; i < count; i++) {
+			rtree_bulk_entry_set(&tree, entries + i * entry_size,
+					     &arr[i], (record_t)(i + 1));
+		}
+		rtree_bulk_load(&tree, entries, count);
+		free(entries);
+
+		if (rtree_number_of_records(&tree) != count) {
+			fail("Tree count mismatch", "true");
+		}
+		if (rtree_used_size(&tree) != tree.page_size *
+		    rtree_bulk_load_page_count(&tree, count)) {
+			fail("Page count mismatch", "true");
+		}
+		struct rtree_iterator iterator;
+		rtree_iterator_init(&iterator);
+		for (size_t i = 0; i < count; i++) {
+			if (!rtree_search(&tree, &arr[i], SOP_EQUALS,
+					  &iterator)) {
+				fail("element in tree", "false");
+			}
+			record_t rec = rtree_iterator_next(&iterator);
+			if (rec != (record_t)(i + 1)) {
+				fail("right search result", "true");
+			}
+			if (rtree_iterator_next(&iterator)) {
+				fail("single search result", "true");
+			}
+		}
+		for (size_t i = 0; i < count; i += 2) {
+			if (!rtree_remove(&tree, &arr[i], (record_t)(i + 1))) {
+				fail("delete element in tree", "false");
+			}
+		}
+		for (size_t i = 0; i < count; i += 2)
+			rtree_insert(&tree, &arr[i], (record_t)(i + 1));
+		for (size_t i = 0; i < count; i++) {
+			if (!rtree_remove(&tree, &arr[i], (record_t)(i + 1))) {
+				fail("delete element in tree", "false");
+			}
+		}
+		if (rtree_number_of_records(&tree) != 0) {
+			fail("Tree count mismatch", "true");
+		}
+		rtree_iterator_destroy(&iterator);
+		rtree_destroy(&tree);
+	}
+	free(arr);
+
+	footer();
+}
 
 int
 main(void)
 {
 	simple_check();
 	neighbor_test();
+	bulk_load_test();
 	if (page_count != 0) {
 		fail("memory leak!", "true");
 	}
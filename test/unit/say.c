@@ -170,7 +170,7 @@ int main()
 	fiber_init(fiber_c_invoke);
 	say_logger_init("/dev/null", S_INFO, 0, "plain");
 
-	plan(36);
+	plan(38);
 
 #define PARSE_LOGGER_TYPE(input, rc) \
 	ok(parse_logger_type(input) == rc, "%s", input)
@@ -279,6 +279,26 @@ int main()
 	coio_shutdown();
 	log_destroy(&test_log);
 
+	/* Test the asynchronous writer. */
+	char async_filename[30];
+	sprintf(async_filename, "%s/2.log", tmp_dir);
+	log_create(&test_log, async_filename, false);
+	log_set_format(&test_log, say_format_plain);
+	ok(log_start_async(&test_log) == 0, "log_start_async");
+	for (int i = 0; i < 1000; i++)
+		log_say(&test_log, 0, NULL, 0, NULL, "message %d", i);
+	log_destroy(&test_log);
+	FILE *async_fd = fopen(async_filename, "r");
+	int async_lines = 0;
+	while (async_fd != NULL && fgets(line, len, async_fd) != NULL) {
+		if (strstr(line, "message ") != NULL)
+			async_lines++;
+	}
+	if (async_fd != NULL)
+		fclose(async_fd);
+	ok(async_lines == 1000, "async log lines");
+	unlink(async_filename);
+
 	const char *level_str = say_log_level_str(S_DEBUG);
 	ok(strcmp("DEBUG", say_log_level_str(S_DEBUG)) == 0,
 	   "level string is %s", level_str);
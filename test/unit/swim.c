@@ -399,6 +399,31 @@ swim_test_refute(void)
 	swim_finish_test();
 }
 
+static void
+swim_test_local_health(void)
+{
+	swim_start_test(3);
+	struct swim_cluster *cluster = swim_cluster_new(2);
+	swim_cluster_set_ack_timeout(cluster, 1);
+	struct swim *s2 = swim_cluster_member(cluster, 1);
+
+	swim_cluster_add_link(cluster, 0, 1);
+	is(swim_local_health(s2), 0, "S2 is healthy at start");
+	swim_cluster_set_drop(cluster, 1, 100);
+	fail_if(swim_cluster_wait_status(cluster, 0, 1,
+					 MEMBER_SUSPECTED, 4) != 0);
+	swim_cluster_set_drop(cluster, 1, 0);
+	fail_if(swim_cluster_wait_incarnation(cluster, 1, 1, 0, 1, 1) != 0);
+	is(swim_local_health(s2), 1, "S2 health is worse after it refuted "\
+	   "its suspicion");
+	swim_run_for(3);
+	is(swim_local_health(s2), 0, "and is restored after S2 receives "\
+	   "an ACK");
+
+	swim_cluster_delete(cluster);
+	swim_finish_test();
+}
+
 static void
 swim_test_too_big_packet(void)
 {
@@ -1095,7 +1120,7 @@ swim_test_member_by_uuid(void)
 static int
 main_f(va_list ap)
 {
-	swim_start_test(23);
+	swim_start_test(24);
 
 	(void) ap;
 	fakeev_init();
@@ -1109,6 +1134,7 @@ main_f(va_list ap)
 	swim_test_basic_failure_detection();
 	swim_test_probe();
 	swim_test_refute();
+	swim_test_local_health();
 	swim_test_basic_gossip();
 	swim_test_too_big_packet();
 	swim_test_undead();
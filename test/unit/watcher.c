@@ -1,3 +1,4 @@
+#include <limits.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <string.h>
@@ -542,11 +543,67 @@ test_value(void)
 	footer();
 }
 
+/**
+ * Checks that all watchers registered for a key run on update even if there
+ * are more of them than the worker fiber runs without yielding and that
+ * updates done while the watchers are pending are coalesced.
+ */
+static void
+test_many_watchers(void)
+{
+	header();
+	plan(4);
+
+	enum { WATCHER_COUNT = 2500 };
+	struct test_watcher *w = xcalloc(WATCHER_COUNT, sizeof(*w));
+	for (int i = 0; i < WATCHER_COUNT; i++) {
+		test_watcher_create(&w[i]);
+		test_watcher_register(&w[i], "foo");
+	}
+	int total = 0;
+	for (int i = 0; i < 10 && total < WATCHER_COUNT; i++) {
+		fiber_sleep(0);
+		total = 0;
+		for (int j = 0; j < WATCHER_COUNT; j++)
+			total += w[j].run_count;
+	}
+	is(total, WATCHER_COUNT, "all watchers run on register");
+
+	test_broadcast("foo", "v1");
+	test_broadcast("foo", "v2");
+	fiber_sleep(0);
+	test_broadcast("foo", "v3");
+	for (int i = 0; i < 10; i++)
+		fiber_sleep(0);
+	int min_run_count = INT_MAX;
+	int max_run_count = 0;
+	bool value_ok = true;
+	for (int i = 0; i < WATCHER_COUNT; i++) {
+		min_run_count = MIN(min_run_count, w[i].run_count);
+		max_run_count = MAX(max_run_count, w[i].run_count);
+		if (!test_watcher_value_equal(&w[i], "v3"))
+			value_ok = false;
+	}
+	ok(min_run_count >= 2, "all watchers run on update");
+	ok(max_run_count <= 3, "updates are coalesced");
+	ok(value_ok, "all watchers see the latest value");
+
+	for (int i = 0; i < WATCHER_COUNT; i++) {
+		test_watcher_unregister(&w[i]);
+		test_watcher_destroy(&w[i]);
+	}
+	free(w);
+	test_broadcast("foo", NULL);
+
+	check_plan();
+	footer();
+}
+
 static int
 main_f(va_list ap)
 {
 	header();
-	plan(9);
+	plan(10);
 	box_watcher_init();
 	test_basic();
 	test_async();
@@ -556,6 +613,7 @@ main_f(va_list ap)
 	test_ack_unregistered();
 	test_parallel();
 	test_value();
+	test_many_watchers();
 	test_free(); /* must be last */
 	test_result = check_plan();
 	footer();
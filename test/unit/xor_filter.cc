@@ -0,0 +1,116 @@
+#include "salad/xor_filter.h"
+#include <unordered_set>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+uint32_t h(uint32_t i)
+{
+	return i * 2654435761;
+}
+
+void
+simple_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	uint32_t error_count = 0;
+	uint32_t fp_rate_too_big = 0;
+	for (double p = 0.001; p < 0.5; p *= 1.3) {
+		uint64_t tests = 0;
+		uint64_t false_positive = 0;
+		for (uint32_t count = 1000; count <= 10000; count *= 2) {
+			unordered_set<uint32_t> check;
+			vector<uint32_t> hashes;
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t val = rand() % (count * 10);
+				check.insert(val);
+				hashes.push_back(h(val));
+			}
+			struct xor_filter filter;
+			if (xor_filter_create(&filter, hashes.data(), count,
+					      p) != 0)
+				abort();
+			for (uint32_t i = 0; i < count * 10; i++) {
+				bool has = check.find(i) != check.end();
+				bool filter_possible =
+					xor_filter_maybe_has(&filter, h(i));
+				tests++;
+				if (has && !filter_possible)
+					error_count++;
+				if (!has && filter_possible)
+					false_positive++;
+			}
+			xor_filter_destroy(&filter);
+		}
+		double fp_rate = (double)false_positive / tests;
+		if (fp_rate > p + 0.001)
+			fp_rate_too_big++;
+	}
+	cout << "error_count = " << error_count << endl;
+	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
+}
+
+void
+store_load_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	srand(time(0));
+	uint32_t error_count = 0;
+	for (double p = 0.01; p < 0.5; p *= 1.5) {
+		for (uint32_t count = 0; count <= 10000; count += 1000) {
+			vector<uint32_t> hashes;
+			for (uint32_t i = 0; i < count; i++)
+				hashes.push_back(h(i * 2));
+			struct xor_filter filter;
+			if (xor_filter_create(&filter, hashes.data(), count,
+					      p) != 0)
+				abort();
+			vector<char> buf(xor_filter_store_size(&filter));
+			char *end = xor_filter_store(&filter, buf.data());
+			if (end != buf.data() + buf.size())
+				error_count++;
+			struct xor_filter loaded = filter;
+			if (xor_filter_load_table(&loaded, buf.data()) != 0)
+				abort();
+			xor_filter_destroy(&filter);
+			for (uint32_t i = 0; i < count; i++) {
+				if (!xor_filter_maybe_has(&loaded, h(i * 2)))
+					error_count++;
+			}
+			xor_filter_destroy(&loaded);
+		}
+	}
+	cout << "error_count = " << error_count << endl;
+}
+
+void
+size_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	uint32_t count = 100000;
+	vector<uint32_t> hashes;
+	for (uint32_t i = 0; i < count; i++)
+		hashes.push_back(h(i));
+	/* Duplicates are ignored. */
+	for (uint32_t i = 0; i < count; i++)
+		hashes.push_back(h(i));
+	struct xor_filter filter;
+	if (xor_filter_create(&filter, hashes.data(), hashes.size(),
+			      1. / 32) != 0)
+		abort();
+	double bits_per_value =
+		(double)xor_filter_store_size(&filter) * 8 / count;
+	cout << "fingerprint_bits = " << filter.fingerprint_bits << endl;
+	cout << "bits_per_value_ok = " << (bits_per_value < 6.5) << endl;
+	xor_filter_destroy(&filter);
+}
+
+int
+main(void)
+{
+	simple_test();
+	store_load_test();
+	size_test();
+}
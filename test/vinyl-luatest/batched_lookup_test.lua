@@ -0,0 +1,63 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            vinyl_cache = 0,
+            vinyl_page_cache = 1024 * 1024,
+            vinyl_page_size = 1024,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk', {bloom_fpr = 1})
+        s:create_index('sk1', {parts = {2, 'unsigned'}, bloom_fpr = 1})
+        s:create_index('sk2', {parts = {3, 'unsigned'}, bloom_fpr = 1})
+        for i = 1, 100 do
+            s:insert({i * 2, i * 2, i * 2, string.rep('x', 100)})
+        end
+        box.snapshot()
+    end)
+    -- Restart to drop the page cache.
+    cg.server:restart()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that pages needed to check uniqueness in all indexes are
+-- read in one batch and then looked up in the page cache.
+g.test_prefetch = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local function pages_read()
+            local count = 0
+            for _, name in ipairs({'pk', 'sk1', 'sk2'}) do
+                count = count + s.index[name]:stat().disk.iterator.read.pages
+            end
+            return count
+        end
+        local hit = box.stat.vinyl().page_cache.hit
+        local pages = pages_read()
+        s:insert({101, 101, 101})
+        t.assert_equals(pages_read() - pages, 3)
+        t.assert_equals(box.stat.vinyl().page_cache.hit - hit, 3)
+
+        t.assert_error_msg_contains(
+            'Duplicate key exists in unique index "sk2"',
+            s.insert, s, {103, 103, 100})
+        t.assert_error_msg_contains(
+            'Duplicate key exists in unique index "pk"',
+            s.insert, s, {100, 105, 105})
+        s:replace({100, 107, 107})
+        t.assert_equals(s:get(100), {100, 107, 107})
+        t.assert_equals(s.index.sk1:get(100), nil)
+        t.assert_equals(s.index.sk2:get(107), {100, 107, 107})
+        t.assert_equals(s:count(), 101)
+    end)
+end
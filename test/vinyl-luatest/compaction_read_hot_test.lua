@@ -0,0 +1,73 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    -- One dump worker and one compaction worker.
+    cg.server = server:new({box_cfg = {vinyl_write_threads = 2}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Checks that of two LSM trees with equal compaction priority the one
+-- that is read more is compacted first.
+g.test_read_hot_first = function(cg)
+    local ids = cg.server:exec(function()
+        local ids = {}
+        for _, name in ipairs({'busy', 'cold', 'hot'}) do
+            local s = box.schema.create_space(name, {engine = 'vinyl'})
+            s:create_index('pk', {run_count_per_level = 10})
+            for i = 1, 100 do
+                s:replace({i})
+            end
+            ids[name] = s.id
+        end
+        box.snapshot()
+        for _, name in ipairs({'busy', 'cold', 'hot'}) do
+            for i = 1, 100 do
+                box.space[name]:replace({i, i})
+            end
+        end
+        box.snapshot()
+        for _, name in ipairs({'busy', 'cold', 'hot'}) do
+            t.assert_equals(box.space[name].index.pk:stat().run_count, 2)
+        end
+        -- Each lookup probes both runs of the range.
+        for i = 1, 100 do
+            t.assert_equals(box.space.hot:get(i), {i, i})
+        end
+        -- Occupy the compaction worker so that the other two compaction
+        -- tasks are queued.
+        box.error.injection.set('ERRINJ_VY_COMPACTION_DELAY', true)
+        box.space.busy.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(box.stat.vinyl().scheduler.tasks_inprogress, 1)
+        end)
+        box.space.cold.index.pk:compact()
+        box.space.hot.index.pk:compact()
+        box.error.injection.set('ERRINJ_VY_COMPACTION_DELAY', false)
+        t.helpers.retrying({}, function()
+            for _, name in ipairs({'busy', 'cold', 'hot'}) do
+                local stat = box.space[name].index.pk:stat()
+                t.assert_equals(stat.disk.compaction.count, 1)
+            end
+        end)
+        return ids
+    end)
+    local log = fio.pathjoin(cg.server.workdir, cg.server.alias .. '.log')
+    local data = fio.open(log):read()
+    local function started(id)
+        local pos = data:find(string.format('%d/0: started compacting', id),
+                              1, true)
+        t.assert(pos ~= nil)
+        return pos
+    end
+    t.assert_lt(started(ids.busy), started(ids.hot))
+    t.assert_lt(started(ids.hot), started(ids.cold))
+end
@@ -0,0 +1,78 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {vinyl_defer_deletes = true}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Check that primary index compaction doesn't generate deferred
+-- DELETEs for tuples which secondary keys weren't changed.
+g.test_noop = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        local pk = s:create_index('pk', {run_count_per_level = 10})
+        local i1 = s:create_index('i1', {parts = {2, 'unsigned'},
+                                         unique = false,
+                                         run_count_per_level = 10})
+        local i2 = s:create_index('i2', {parts = {3, 'unsigned'},
+                                         run_count_per_level = 10})
+        for i = 1, 10 do
+            s:replace({i, i, i, 'a'})
+        end
+        box.snapshot()
+        -- Secondary keys aren't changed.
+        for i = 1, 4 do
+            s:replace({i, i, i, 'b'})
+        end
+        -- Only one of secondary keys is changed.
+        for i = 5, 7 do
+            s:replace({i, i * 10, i, 'b'})
+        end
+        -- The tuple is deleted.
+        for i = 8, 10 do
+            s:delete({i})
+        end
+        box.snapshot()
+        t.assert_equals(i1:stat().rows, 17)
+        t.assert_equals(i2:stat().rows, 17)
+        pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(pk:stat().disk.compaction.count, 1)
+        end)
+        -- 10 old REPLACEs + 7 new REPLACEs + 6 deferred DELETEs.
+        t.assert_equals(i1:stat().rows, 23)
+        t.assert_equals(i2:stat().rows, 23)
+        local expected = {
+            {1, 1, 1, 'b'}, {2, 2, 2, 'b'}, {3, 3, 3, 'b'}, {4, 4, 4, 'b'},
+            {5, 50, 5, 'b'}, {6, 60, 6, 'b'}, {7, 70, 7, 'b'},
+        }
+        t.assert_equals(pk:select(), expected)
+        t.assert_equals(i2:select(), expected)
+        box.snapshot()
+        i1:compact()
+        i2:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(i1:stat().disk.compaction.count, 1)
+            t.assert_equals(i2:stat().disk.compaction.count, 1)
+        end)
+        t.assert_equals(i1:stat().rows, 7)
+        t.assert_equals(i2:stat().rows, 7)
+        t.assert_equals(i1:select(), expected)
+        t.assert_equals(i2:select(), expected)
+    end)
+end
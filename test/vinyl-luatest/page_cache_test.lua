@@ -0,0 +1,77 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            vinyl_cache = 0,
+            vinyl_page_cache = 1024 * 1024,
+            vinyl_page_size = 1024,
+        },
+    })
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        box.snapshot()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_page_cache = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        local function pages_read()
+            return s.index.pk:stat().disk.iterator.read.pages
+        end
+        local st = box.stat.vinyl().page_cache
+        local pages = pages_read()
+        t.assert_equals(#s:select(), 100)
+        local page_count = pages_read() - pages
+        t.assert_gt(page_count, 1)
+        t.assert_gt(box.stat.vinyl().memory.page_cache, 0)
+
+        -- Pages are now read from the cache.
+        pages = pages_read()
+        t.assert_equals(#s:select(), 100)
+        t.assert_equals(s:get(50), {50, string.rep('x', 100)})
+        t.assert_equals(pages_read(), pages)
+        local st2 = box.stat.vinyl().page_cache
+        t.assert_ge(st2.hit - st.hit, page_count)
+        t.assert_gt(st2.lookup, st2.hit)
+
+        -- Shrinking the cache evicts pages.
+        box.cfg({vinyl_page_cache = 0})
+        t.assert_equals(box.stat.vinyl().memory.page_cache, 0)
+        t.assert_gt(box.stat.vinyl().page_cache.evict, st2.evict)
+        t.assert_equals(#s:select(), 100)
+        t.assert_equals(pages_read() - pages, page_count)
+        box.cfg({vinyl_page_cache = 1024 * 1024})
+    end)
+end
+
+-- Check that pages of a run are dropped from the cache when
+-- the run is deleted.
+g.test_run_delete = function(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(#s:select(), 100)
+        t.assert_gt(box.stat.vinyl().memory.page_cache, 0)
+        s:replace({1, 'y'})
+        box.snapshot()
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.pk:stat().run_count, 1)
+            t.assert_equals(box.stat.vinyl().memory.page_cache, 0)
+        end)
+        t.assert_equals(s:get(1), {1, 'y'})
+    end)
+end
@@ -0,0 +1,57 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            vinyl_cache = 0,
+            vinyl_page_cache = 1024 * 1024,
+            vinyl_page_size = 1024,
+        },
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that pages stored in the page cache at the time of the last
+-- checkpoint are read back into the cache after restart.
+g.test_warmup = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        box.snapshot()
+        t.assert_equals(#s:select(), 100)
+        t.assert_gt(box.stat.vinyl().memory.page_cache, 0)
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.helpers.retrying({}, function()
+            t.assert_gt(box.stat.vinyl().page_cache.warmup, 1)
+        end)
+        t.assert_gt(box.stat.vinyl().memory.page_cache, 0)
+        local pages = s.index.pk:stat().disk.iterator.read.pages
+        local hit = box.stat.vinyl().page_cache.hit
+        t.assert_equals(#s:select(), 100)
+        t.assert_equals(s.index.pk:stat().disk.iterator.read.pages, pages)
+        t.assert_gt(box.stat.vinyl().page_cache.hit, hit)
+    end)
+    -- No warmup if the page cache is disabled.
+    cg.server:restart({
+        box_cfg = {vinyl_cache = 0, vinyl_page_cache = 0},
+    })
+    cg.server:exec(function()
+        t.assert_equals(box.stat.vinyl().page_cache.warmup, 0)
+        t.assert_equals(box.stat.vinyl().memory.page_cache, 0)
+        t.assert_equals(box.space.test:count(), 100)
+    end)
+end
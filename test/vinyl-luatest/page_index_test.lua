@@ -0,0 +1,69 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk', {parts = {{1, 'string'}, {2, 'unsigned'}},
+                              page_size = 256, run_count_per_level = 10})
+        -- Keys of different length so that page min keys differ in size.
+        for i = 1, 1000 do
+            s:replace({string.rep('x', i % 20) .. i, i, i * 10})
+        end
+        box.snapshot()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function check(cg)
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.pk:stat().run_count, 1)
+        t.assert_gt(s.index.pk:stat().disk.pages, 10)
+        for i = 1, 1000 do
+            local key = string.rep('x', i % 20) .. i
+            t.assert_equals(s:get({key, i}), {key, i, i * 10})
+        end
+        local prev
+        local count = 0
+        for _, tuple in s:pairs({}, {iterator = 'GE'}) do
+            if prev ~= nil then
+                t.assert_lt(prev, tuple[1])
+            end
+            prev = tuple[1]
+            count = count + 1
+        end
+        t.assert_equals(count, 1000)
+        local res = s:select({'xx', 0}, {iterator = 'GE', limit = 1})
+        t.assert_equals(res[1][1], 'xx102')
+    end)
+end
+
+-- Checks that the page index of a run is searched correctly after the
+-- run is written, recovered from the index file and rebuilt from the
+-- data file.
+g.test_page_index = function(cg)
+    check(cg)
+    cg.server:restart()
+    check(cg)
+    local dir = cg.server:exec(function()
+        local fio = require('fio')
+        return fio.pathjoin(box.cfg.vinyl_dir,
+                            tostring(box.space.test.id), '0')
+    end)
+    cg.server:stop()
+    local files = fio.glob(fio.pathjoin(cg.server.workdir, dir, '*.index'))
+    t.assert_equals(#files, 1)
+    t.assert(fio.unlink(files[1]))
+    cg.server.box_cfg = {force_recovery = true}
+    cg.server:start()
+    check(cg)
+end
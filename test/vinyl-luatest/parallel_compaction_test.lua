@@ -0,0 +1,94 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {vinyl_write_threads = 4}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+-- Check that compaction of a big range is split in parts executed
+-- by different workers and the range is split by the part bounds.
+g.test_split = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk', {range_size = 64 * 1024, page_size = 1024,
+                              run_count_per_level = 10})
+        for _, v in ipairs({'a', 'b'}) do
+            for i = 1, 1000 do
+                s:replace({i, string.rep(v, 100)})
+            end
+            box.snapshot()
+        end
+        t.assert_equals(s.index.pk:stat().range_count, 1)
+        t.assert_equals(s.index.pk:stat().run_count, 2)
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.pk:stat().disk.compaction.count, 1)
+            t.assert_equals(s.index.pk:stat().range_count, 3)
+        end)
+        t.assert_equals(s.index.pk:stat().run_count, 3)
+        t.assert_equals(s.index.pk:stat().disk.compaction.output.rows, 1000)
+        t.assert_equals(s:count(), 1000)
+        for i = 1, 1000 do
+            t.assert_equals(s:get(i), {i, string.rep('b', 100)})
+        end
+    end)
+    t.assert(cg.server:grep_log('split in 3 parts'))
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.pk:stat().range_count, 3)
+        t.assert_equals(s.index.pk:stat().run_count, 3)
+        local res = s:select()
+        t.assert_equals(#res, 1000)
+        for i = 1, 1000 do
+            t.assert_equals(res[i], {i, string.rep('b', 100)})
+        end
+    end)
+end
+
+-- Check that a failure of any part of a split compaction fails
+-- the whole compaction.
+g.test_failure = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk', {range_size = 64 * 1024, page_size = 1024,
+                              run_count_per_level = 10})
+        for _, v in ipairs({'a', 'b'}) do
+            for i = 1, 1000 do
+                s:replace({i, string.rep(v, 100)})
+            end
+            box.snapshot()
+        end
+        box.error.injection.set('ERRINJ_VY_RUN_WRITE', true)
+        box.error.injection.set('ERRINJ_VY_SCHED_TIMEOUT', 0.01)
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_ge(box.stat.vinyl().scheduler.tasks_failed, 1)
+        end)
+        t.assert_equals(s.index.pk:stat().range_count, 1)
+        t.assert_equals(s.index.pk:stat().run_count, 2)
+        box.error.injection.set('ERRINJ_VY_RUN_WRITE', false)
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.pk:stat().disk.compaction.count, 1)
+            t.assert_equals(s.index.pk:stat().range_count, 3)
+        end)
+        box.error.injection.set('ERRINJ_VY_SCHED_TIMEOUT', 0)
+        t.assert_equals(s:count(), 1000)
+    end)
+end
@@ -0,0 +1,51 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- Check that the time spent waiting for memory quota is accounted
+-- to the indexes the waiting transaction writes to.
+g.test_throttle_stat = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s1 = box.schema.create_space('test1', {engine = 'vinyl'})
+        s1:create_index('pk')
+        s1:create_index('sk', {parts = {2, 'unsigned'}})
+        local s2 = box.schema.create_space('test2', {engine = 'vinyl'})
+        s2:create_index('pk')
+        s1:insert({1, 1})
+        s2:insert({1})
+        for _, index in ipairs({s1.index.pk, s1.index.sk, s2.index.pk}) do
+            t.assert_equals(index:stat().throttle, {count = 0, time = 0})
+        end
+        box.error.injection.set('ERRINJ_VY_QUOTA_DELAY', true)
+        local f = fiber.new(function()
+            box.begin()
+            s1:insert({2, 2})
+            s1:insert({3, 3})
+            box.commit()
+        end)
+        f:set_joinable(true)
+        fiber.sleep(0.1)
+        box.error.injection.set('ERRINJ_VY_QUOTA_DELAY', false)
+        t.assert_equals({f:join()}, {true})
+        for _, index in ipairs({s1.index.pk, s1.index.sk}) do
+            local stat = index:stat().throttle
+            t.assert_equals(stat.count, 1)
+            t.assert_gt(stat.time, 0)
+        end
+        t.assert_equals(s2.index.pk:stat().throttle, {count = 0, time = 0})
+        box.stat.reset()
+        t.assert_equals(s1.index.pk:stat().throttle, {count = 0, time = 0})
+    end)
+end
@@ -0,0 +1,71 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_option = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        t.assert_error_msg_equals(
+            "Wrong index options: compaction_strategy must be either " ..
+            "'leveled' or 'tiered'",
+            s.create_index, s, 'pk', {compaction_strategy = 'foo'})
+        local pk = s:create_index('pk')
+        t.assert_equals(pk.options.compaction_strategy, nil)
+        pk:alter({compaction_strategy = 'tiered'})
+        t.assert_equals(pk.options.compaction_strategy, 'tiered')
+        pk:alter({compaction_strategy = 'leveled'})
+        t.assert_equals(pk.options.compaction_strategy, nil)
+    end)
+end
+
+g.test_compaction = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('leveled', {run_count_per_level = 2})
+        s:create_index('tiered', {run_count_per_level = 2,
+                                  compaction_strategy = 'tiered'})
+        local function dump(n)
+            for i = n * 100 + 1, n * 100 + 100 do
+                s:insert({i})
+            end
+            box.snapshot()
+        end
+        -- The leveled strategy keeps one run at the last level so
+        -- two runs of the same size are compacted right away while
+        -- the tiered strategy waits for the tier to fill up.
+        dump(0)
+        dump(1)
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.leveled:stat().disk.compaction.count, 1)
+        end)
+        t.assert_equals(s.index.leveled:stat().run_count, 1)
+        t.assert_equals(s.index.tiered:stat().disk.compaction.count, 0)
+        t.assert_equals(s.index.tiered:stat().run_count, 2)
+        dump(2)
+        dump(3)
+        t.helpers.retrying({}, function()
+            t.assert_ge(s.index.tiered:stat().disk.compaction.count, 1)
+            t.assert_lt(s.index.tiered:stat().run_count, 4)
+        end)
+        t.assert_equals(s.index.tiered:count(), 400)
+        t.assert_equals(s.index.tiered:select({}, {limit = 1}), {{1}})
+    end)
+end
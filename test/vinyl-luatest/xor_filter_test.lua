@@ -0,0 +1,105 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({box_cfg = {vinyl_cache = 0}})
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_option = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        t.assert_error_msg_equals(
+            "Wrong index options: bloom_type must be either " ..
+            "'bloom' or 'xor'",
+            s.create_index, s, 'pk', {bloom_type = 'foo'})
+        local pk = s:create_index('pk')
+        t.assert_equals(pk.options.bloom_type, nil)
+        pk:alter({bloom_type = 'xor'})
+        t.assert_equals(pk.options.bloom_type, 'xor')
+        pk:alter({bloom_type = 'bloom'})
+        t.assert_equals(pk.options.bloom_type, nil)
+    end)
+end
+
+g.test_lookup = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk', {bloom_type = 'xor', bloom_fpr = 0.01})
+        s:create_index('sk', {parts = {2, 'unsigned', 3, 'unsigned'},
+                              bloom_type = 'xor'})
+        for i = 1, 1000 do
+            s:insert({i * 2, i % 10, i})
+        end
+        box.snapshot()
+        t.assert_gt(s.index.pk:stat().disk.bloom_size, 0)
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        local pk = s.index.pk
+        local sk = s.index.sk
+        -- No false negatives.
+        for i = 1, 1000 do
+            t.assert_equals(pk:get(i * 2), {i * 2, i % 10, i})
+            t.assert_equals(sk:get({i % 10, i}), {i * 2, i % 10, i})
+            t.assert_equals(#sk:select({i % 10}, {limit = 1}), 1)
+        end
+        -- Lookups of missing keys are mostly filtered out.
+        local bloom = pk:stat().disk.iterator.bloom
+        for i = 1, 1000 do
+            t.assert_equals(pk:get(i * 2 + 1), nil)
+        end
+        local hit = pk:stat().disk.iterator.bloom.hit - bloom.hit
+        local miss = pk:stat().disk.iterator.bloom.miss - bloom.miss
+        t.assert_equals(hit + miss, 1000)
+        t.assert_lt(miss, 100)
+    end)
+end
+
+-- Check that switching the filter type applies to new runs while
+-- the old ones keep working.
+g.test_switch = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        for i = 1, 100 do
+            s:insert({i})
+        end
+        box.snapshot()
+        s.index.pk:alter({bloom_type = 'xor'})
+        for i = 101, 200 do
+            s:insert({i})
+        end
+        box.snapshot()
+        t.assert_equals(s.index.pk:stat().run_count, 2)
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        for i = 1, 200 do
+            t.assert_equals(s:get(i), {i})
+        end
+        s.index.pk:compact()
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.pk:stat().run_count, 1)
+        end)
+        for i = 1, 200 do
+            t.assert_equals(s:get(i), {i})
+        end
+    end)
+end
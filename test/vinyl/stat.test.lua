@@ -77,6 +77,7 @@ function istat()
     st.latency = nil
     st.disk.dump.time = nil
     st.disk.compaction.time = nil
+    st.throttle = nil
     return st
 end;
 
@@ -93,6 +94,8 @@ function gstat()
     st.scheduler.dump_time = nil
     st.scheduler.compaction_time = nil
     st.memory.level0 = nil
+    st.memory.page_cache = nil
+    st.page_cache = nil
     return st
 end;
 
@@ -109,6 +112,11 @@ test_run:cmd("setopt delimiter ''");
 istat()
 gstat()
 box.stat.vinyl().memory.level0 == 0
+st = box.space.test.index.pk:stat().throttle
+st.count, st.time
+st = box.stat.vinyl().page_cache
+st.lookup, st.hit, st.evict, st.warmup
+box.stat.vinyl().memory.page_cache == 0
 
 --
 -- Index statistics.
@@ -616,6 +624,37 @@ box.commit()
 i:stat().txw.rows -- 0
 s:drop()
 
+--
+-- Page cache statistics.
+--
+box.cfg{vinyl_page_cache = 1024 * 1024}
+s = box.schema.space.create('test', {engine = 'vinyl'})
+i = s:create_index('pk')
+for k = 1, 10 do s:replace{k} end
+box.snapshot()
+st = box.stat.vinyl().page_cache
+-- The page is read from the disk and stored in the cache.
+s:get(1)
+gst = box.stat.vinyl()
+gst.page_cache.lookup - st.lookup -- 1
+gst.page_cache.hit - st.hit -- 0
+gst.memory.page_cache > 0
+-- The same page is found in the cache.
+s:get(2)
+gst = box.stat.vinyl()
+gst.page_cache.lookup - st.lookup -- 2
+gst.page_cache.hit - st.hit -- 1
+-- The page is evicted when the cache is disabled.
+box.cfg{vinyl_page_cache = 0}
+gst = box.stat.vinyl()
+gst.page_cache.evict - st.evict -- 1
+gst.memory.page_cache -- 0
+-- The counters are reset by box.stat.reset().
+box.stat.reset()
+st = box.stat.vinyl().page_cache
+st.lookup, st.hit, st.evict, st.warmup
+s:drop()
+
 test_run:cmd('switch default')
 test_run:cmd('stop server test')
 test_run:cmd('cleanup server test')
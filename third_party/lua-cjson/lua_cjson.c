@@ -49,6 +49,8 @@
 
 #include "lua/utils.h"
 #include "lua/serializer.h"
+#include "msgpuck.h"
+#include "lua/msgpack.h" /* luamp_decode() */
 #include "mp_extension_types.h" /* MP_DECIMAL, MP_UUID */
 #include "diag.h"
 #include "tt_static.h"
@@ -210,12 +212,17 @@ static void json_append_string(struct luaL_serializer *cfg, strbuf_t *json,
     strbuf_ensure_empty_length(json, len * 6 + 2);
 
     strbuf_append_char_unsafe(json, '\"');
-    for (i = 0; i < len; i++) {
+    i = 0;
+    while (i < len) {
+        /* Copy characters that don't need escaping in bulk. */
+        size_t n = json_escape_prefix_len(str + i, len - i);
+        strbuf_append_mem_unsafe(json, str + i, n);
+        i += n;
+        if (i == len)
+            break;
         escstr = json_escape_char(str[i]);
-        if (escstr)
-            strbuf_append_string(json, escstr);
-        else
-            strbuf_append_char_unsafe(json, str[i]);
+        strbuf_append_mem_unsafe(json, escstr, strlen(escstr));
+        i++;
     }
     strbuf_append_char_unsafe(json, '\"');
 }
@@ -292,6 +299,28 @@ static void json_append_number(struct luaL_serializer *cfg, strbuf_t *json,
     strbuf_extend_length(json, len);
 }
 
+/* Serialise a Lua table key at the given stack index followed by ':'. */
+static void json_append_key(lua_State *l, struct luaL_serializer *cfg,
+                            strbuf_t *json, int idx)
+{
+    struct luaL_field field;
+    luaL_checkfield(l, cfg, idx, &field);
+    if (field.type == MP_UINT) {
+        strbuf_append_char(json, '"');
+        json_append_uint(cfg, json, field.ival);
+        strbuf_append_mem(json, "\":", 2);
+    } else if (field.type == MP_INT) {
+        strbuf_append_char(json, '"');
+        json_append_int(cfg, json, field.ival);
+        strbuf_append_mem(json, "\":", 2);
+    } else if (field.type == MP_STR) {
+        json_append_string(cfg, json, field.sval.data, field.sval.len);
+        strbuf_append_char(json, ':');
+    } else {
+        luaL_error(l, "table key must be a number or string");
+    }
+}
+
 static void json_append_object(lua_State *l, struct luaL_serializer *cfg,
                                int current_depth, strbuf_t *json)
 {
@@ -309,22 +338,7 @@ static void json_append_object(lua_State *l, struct luaL_serializer *cfg,
         else
             comma = 1;
 
-    struct luaL_field field;
-    luaL_checkfield(l, cfg, -2, &field);
-    if (field.type == MP_UINT) {
-        strbuf_append_char(json, '"');
-        json_append_uint(cfg, json, field.ival);
-        strbuf_append_mem(json, "\":", 2);
-    } else if (field.type == MP_INT) {
-        strbuf_append_char(json, '"');
-        json_append_int(cfg, json, field.ival);
-        strbuf_append_mem(json, "\":", 2);
-    } else if (field.type == MP_STR) {
-        json_append_string(cfg, json, field.sval.data, field.sval.len);
-        strbuf_append_char(json, ':');
-    } else {
-        luaL_error(l, "table key must be a number or string");
-    }
+        json_append_key(l, cfg, json, -2);
 
         /* table, key, value */
         json_append_data(l, cfg, current_depth, json);
@@ -443,6 +457,99 @@ static int json_encode(lua_State *l) {
     return 1;
 }
 
+/* Serialise MsgPack data into JSON. Scalars other than numbers are
+ * appended directly, without creating Lua objects for them, while
+ * numbers and extensions are decoded to Lua values so that they are
+ * encoded exactly like json.encode() would do it. */
+static void json_append_mp(lua_State *l, struct luaL_serializer *cfg,
+                           int current_depth, strbuf_t *json,
+                           const char **data)
+{
+    uint32_t len, size, i;
+    const char *str;
+    switch (mp_typeof(**data)) {
+    case MP_UINT:
+        return json_append_uint(cfg, json, mp_decode_uint(data));
+    case MP_INT:
+        return json_append_int(cfg, json, mp_decode_int(data));
+    case MP_STR:
+        str = mp_decode_str(data, &len);
+        return json_append_string(cfg, json, str, len);
+    case MP_BIN:
+        str = mp_decode_bin(data, &len);
+        return json_append_string(cfg, json, str, len);
+    case MP_BOOL:
+        if (mp_decode_bool(data))
+            strbuf_append_mem(json, "true", 4);
+        else
+            strbuf_append_mem(json, "false", 5);
+        return;
+    case MP_NIL:
+        mp_decode_nil(data);
+        return json_append_nil(cfg, json);
+    case MP_ARRAY:
+        if (current_depth >= cfg->encode_max_depth) {
+            if (! cfg->encode_deep_as_nil)
+                luaL_error(l, "Too high nest level");
+            mp_next(data);
+            return json_append_nil(cfg, json);
+        }
+        size = mp_decode_array(data);
+        strbuf_append_char(json, '[');
+        for (i = 0; i < size; i++) {
+            if (i > 0)
+                strbuf_append_char(json, ',');
+            json_append_mp(l, cfg, current_depth + 1, json, data);
+        }
+        strbuf_append_char(json, ']');
+        return;
+    case MP_MAP:
+        if (current_depth >= cfg->encode_max_depth) {
+            if (! cfg->encode_deep_as_nil)
+                luaL_error(l, "Too high nest level");
+            mp_next(data);
+            return json_append_nil(cfg, json);
+        }
+        size = mp_decode_map(data);
+        strbuf_append_char(json, '{');
+        for (i = 0; i < size; i++) {
+            if (i > 0)
+                strbuf_append_char(json, ',');
+            if (mp_typeof(**data) == MP_STR) {
+                str = mp_decode_str(data, &len);
+                json_append_string(cfg, json, str, len);
+                strbuf_append_char(json, ':');
+            } else {
+                luamp_decode(l, luaL_msgpack_default, data);
+                json_append_key(l, cfg, json, -1);
+                lua_pop(l, 1);
+            }
+            json_append_mp(l, cfg, current_depth + 1, json, data);
+        }
+        strbuf_append_char(json, '}');
+        return;
+    default:
+        luamp_decode(l, luaL_msgpack_default, data);
+        json_append_data(l, cfg, current_depth, json);
+        lua_pop(l, 1);
+        return;
+    }
+}
+
+void
+luaL_json_encode_mp(lua_State *l, const char *data)
+{
+    strbuf_t encode_buf;
+    struct ibuf *ibuf = cord_ibuf_take();
+    strbuf_create(&encode_buf, STRBUF_DEFAULT_SIZE, ibuf);
+    json_append_mp(l, luaL_json_default, 0, &encode_buf, &data);
+    char *json = strbuf_string(&encode_buf, NULL);
+    lua_pushlstring(l, json, strbuf_length(&encode_buf));
+    /* See the comment in json_encode(). */
+    strbuf_destroy(&encode_buf);
+    cord_ibuf_put(ibuf);
+}
+
 /* ===== DECODING ===== */
 
 static void json_process_value(lua_State *l, json_parse_t *json,
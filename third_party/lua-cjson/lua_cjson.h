@@ -10,6 +10,15 @@ extern "C" {
 LUALIB_API  int
 luaopen_json(lua_State *L);
 
+/**
+ * Encodes the MsgPack value @a data as JSON with the options of the
+ * default json serializer and pushes the result onto the Lua stack.
+ * Unlike json.encode() of a decoded value, doesn't convert arrays,
+ * maps and strings to Lua objects. Raises a Lua error on failure.
+ */
+void
+luaL_json_encode_mp(lua_State *L, const char *data);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif